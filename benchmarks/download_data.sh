@@ -2,11 +2,25 @@
 #
 #  download_data.sh
 #
+#  Downloads OSM data files into $DATA_DIR.
+#
+#  When called with --fixtures only the pinned extracts used by the
+#  benchmark_suite target are downloaded. These are dated extracts, not
+#  the "latest" files, so results stay comparable between runs and
+#  machines. Update the dates here deliberately and together with any
+#  stored baselines.
+#
 
 cd $DATA_DIR
+
+if [ "$1" = "--fixtures" ]; then
+    curl --location --output 1_liechtenstein.osm.pbf https://download.geofabrik.de/europe/liechtenstein-240101.osm.pbf   # about   2 MB
+    curl --location --output 2_bremen.osm.pbf        https://download.geofabrik.de/europe/germany/bremen-240101.osm.pbf  # about  16 MB
+    exit 0
+fi
+
 curl --location --output 1_liechtenstein.osm.pbf https://download.geofabrik.de/europe/liechtenstein-latest.osm.pbf   # about   2 MB
 curl --location --output 2_bremen.osm.pbf        https://download.geofabrik.de/europe/germany/bremen-latest.osm.pbf  # about  16 MB
 curl --location --output 3_sachsen.osm.pbf       https://download.geofabrik.de/europe/germany/sachsen-latest.osm.pbf # about 160 MB
 curl --location --output 4_germany.osm.pbf       https://download.geofabrik.de/europe/germany-latest.osm.pbf         # about   3 GB
 curl --location --output 5_planet.osm.pbf        https://planet.osm.org/pbf/planet-latest.osm.pbf                    # about  35 GB
-
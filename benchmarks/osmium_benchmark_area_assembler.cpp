@@ -0,0 +1,282 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+/*
+
+  Benchmark for the area assembler.
+
+  Feeds the assembler synthetic multipolygons of controlled complexity:
+  simple way polygons, multipolygon relations with configurable numbers
+  of outer and inner rings, rings touching in a node, and
+  self-intersecting rings. For every scenario the assembly throughput
+  and the aggregated area_stats counters are reported, so regressions
+  in the ring matching show up both in the timing and in the case
+  counters.
+
+  Usage: osmium_benchmark_area_assembler [ITERATIONS [RINGS]]
+
+*/
+
+#include <osmium/area/assembler.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+constexpr const std::size_t buffer_size = 1024UL * 1024UL;
+
+struct scenario_result {
+    osmium::area::area_stats stats{};
+    std::uint64_t okay = 0;
+    std::uint64_t failed = 0;
+    double duration_ms = 0.0;
+};
+
+static void report(const char* name, const std::uint64_t iterations, const scenario_result& result) {
+    const double per_second = result.duration_ms > 0.0 ? static_cast<double>(iterations) / result.duration_ms * 1000.0 : 0.0;
+    std::cout << name
+              << " iterations=" << iterations
+              << " ok=" << result.okay
+              << " failed=" << result.failed
+              << " time_ms=" << result.duration_ms
+              << " areas_per_second=" << per_second
+              << "\n  stats:" << result.stats << "\n";
+}
+
+static scenario_result assemble_way(const osmium::Way& way, const std::uint64_t iterations) {
+    scenario_result result;
+    const osmium::area::AssemblerConfig config;
+    osmium::memory::Buffer out_buffer{buffer_size};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t n = 0; n < iterations; ++n) {
+        osmium::area::Assembler assembler{config};
+        if (assembler(way, out_buffer)) {
+            ++result.okay;
+        } else {
+            ++result.failed;
+        }
+        result.stats += assembler.stats();
+        out_buffer.clear();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    result.duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
+
+static scenario_result assemble_relation(const osmium::Relation& relation, const std::vector<const osmium::Way*>& members, const std::uint64_t iterations) {
+    scenario_result result;
+    const osmium::area::AssemblerConfig config;
+    osmium::memory::Buffer out_buffer{buffer_size};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t n = 0; n < iterations; ++n) {
+        osmium::area::Assembler assembler{config};
+        if (assembler(relation, members, out_buffer)) {
+            ++result.okay;
+        } else {
+            ++result.failed;
+        }
+        result.stats += assembler.stats();
+        out_buffer.clear();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    result.duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
+
+// A simple square as a closed way.
+static void benchmark_simple_way(const std::uint64_t iterations) {
+    osmium::memory::Buffer buffer{buffer_size};
+    const auto pos = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({
+            {1, {1.0, 1.0}},
+            {2, {1.0, 2.0}},
+            {3, {2.0, 2.0}},
+            {4, {2.0, 1.0}},
+            {1, {1.0, 1.0}}
+        })
+    );
+
+    report("simple_way", iterations, assemble_way(buffer.get<osmium::Way>(pos), iterations));
+}
+
+// A multipolygon relation with the given number of separate outer
+// rings, each split into two open ways so the assembler has to stitch
+// the segments together, and one inner ring inside each outer ring.
+static void benchmark_multipolygon(const std::uint64_t iterations, const std::uint64_t num_rings) {
+    osmium::memory::Buffer buffer{buffer_size};
+    std::vector<std::size_t> way_positions;
+    std::vector<member_type> members_attr;
+
+    osmium::object_id_type next_way_id = 1;
+    osmium::object_id_type next_node_id = 1;
+
+    for (std::uint64_t ring = 0; ring < num_rings; ++ring) {
+        const double x = static_cast<double>(ring) * 3.0;
+        const osmium::object_id_type n1 = next_node_id++;
+        const osmium::object_id_type n2 = next_node_id++;
+        const osmium::object_id_type n3 = next_node_id++;
+        const osmium::object_id_type n4 = next_node_id++;
+
+        // Outer ring as two open ways.
+        way_positions.push_back(osmium::builder::add_way(buffer,
+            _id(next_way_id),
+            _nodes({
+                {n1, {x,       1.0}},
+                {n2, {x,       2.0}},
+                {n3, {x + 1.0, 2.0}}
+            })
+        ));
+        members_attr.emplace_back(osmium::item_type::way, next_way_id++, "outer");
+
+        way_positions.push_back(osmium::builder::add_way(buffer,
+            _id(next_way_id),
+            _nodes({
+                {n3, {x + 1.0, 2.0}},
+                {n4, {x + 1.0, 1.0}},
+                {n1, {x,       1.0}}
+            })
+        ));
+        members_attr.emplace_back(osmium::item_type::way, next_way_id++, "outer");
+
+        // Inner ring as one closed way.
+        const osmium::object_id_type i1 = next_node_id++;
+        const osmium::object_id_type i2 = next_node_id++;
+        const osmium::object_id_type i3 = next_node_id++;
+        const osmium::object_id_type i4 = next_node_id++;
+        way_positions.push_back(osmium::builder::add_way(buffer,
+            _id(next_way_id),
+            _nodes({
+                {i1, {x + 0.3, 1.3}},
+                {i2, {x + 0.3, 1.7}},
+                {i3, {x + 0.7, 1.7}},
+                {i4, {x + 0.7, 1.3}},
+                {i1, {x + 0.3, 1.3}}
+            })
+        ));
+        members_attr.emplace_back(osmium::item_type::way, next_way_id++, "inner");
+    }
+
+    const auto rpos = osmium::builder::add_relation(buffer,
+        _id(1),
+        _tag("type", "multipolygon"),
+        _tag("natural", "water"),
+        _members(members_attr)
+    );
+
+    std::vector<const osmium::Way*> members;
+    members.reserve(way_positions.size());
+    for (const auto pos : way_positions) {
+        members.push_back(&buffer.get<osmium::Way>(pos));
+    }
+
+    const std::string name{"multipolygon_rings_" + std::to_string(num_rings)};
+    report(name.c_str(), iterations, assemble_relation(buffer.get<osmium::Relation>(rpos), members, iterations));
+}
+
+// An outer ring and an inner ring touching it in one node.
+static void benchmark_touching_rings(const std::uint64_t iterations) {
+    osmium::memory::Buffer buffer{buffer_size};
+    std::vector<std::size_t> way_positions;
+
+    way_positions.push_back(osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({
+            {1, {0.0, 0.0}},
+            {2, {0.0, 4.0}},
+            {3, {4.0, 4.0}},
+            {4, {4.0, 0.0}},
+            {1, {0.0, 0.0}}
+        })
+    ));
+
+    way_positions.push_back(osmium::builder::add_way(buffer,
+        _id(2),
+        _nodes({
+            {1, {0.0, 0.0}},
+            {5, {1.0, 0.5}},
+            {6, {0.5, 1.0}},
+            {1, {0.0, 0.0}}
+        })
+    ));
+
+    const auto rpos = osmium::builder::add_relation(buffer,
+        _id(1),
+        _tag("type", "multipolygon"),
+        _tag("natural", "water"),
+        _members({
+            {osmium::item_type::way, 1, "outer"},
+            {osmium::item_type::way, 2, "inner"}
+        })
+    );
+
+    const std::vector<const osmium::Way*> members{
+        &buffer.get<osmium::Way>(way_positions[0]),
+        &buffer.get<osmium::Way>(way_positions[1])
+    };
+
+    report("touching_rings", iterations, assemble_relation(buffer.get<osmium::Relation>(rpos), members, iterations));
+}
+
+// A self-intersecting ("bowtie") way. Assembly fails, this exercises
+// the intersection detection.
+static void benchmark_self_intersection(const std::uint64_t iterations) {
+    osmium::memory::Buffer buffer{buffer_size};
+    const auto pos = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({
+            {1, {0.0, 0.0}},
+            {2, {2.0, 2.0}},
+            {3, {2.0, 0.0}},
+            {4, {0.0, 2.0}},
+            {1, {0.0, 0.0}}
+        })
+    );
+
+    report("self_intersection", iterations, assemble_way(buffer.get<osmium::Way>(pos), iterations));
+}
+
+int main(int argc, char* argv[]) {
+    std::uint64_t iterations = 10000;
+    std::uint64_t num_rings = 8;
+
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [ITERATIONS [RINGS]]\n";
+        return 1;
+    }
+    if (argc > 1) {
+        iterations = static_cast<std::uint64_t>(std::atoll(argv[1])); // NOLINT(cert-err34-c)
+    }
+    if (argc > 2) {
+        num_rings = static_cast<std::uint64_t>(std::atoll(argv[2])); // NOLINT(cert-err34-c)
+    }
+
+    try {
+        benchmark_simple_way(iterations);
+        benchmark_multipolygon(iterations, num_rings);
+        benchmark_touching_rings(iterations);
+        benchmark_self_intersection(iterations);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+
+  Microbenchmarks for selected hot functions, based on Google Benchmark.
+
+  Unlike the osmium_benchmark_* programs which process whole OSM files,
+  these benchmarks measure single functions with statistical repetition,
+  so small regressions show up before a release. Build them by installing
+  google-benchmark and configuring with -DBUILD_BENCHMARKS=ON.
+
+  Run for instance with:
+
+  osmium_benchmark_micro --benchmark_repetitions=10
+
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/io/detail/string_table.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/tag.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::size_t batch_size = 100;
+
+void bm_buffer_add_commit(benchmark::State& state) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+
+    for (auto _ : state) {
+        buffer.clear();
+        for (std::size_t i = 0; i < batch_size; ++i) {
+            osmium::builder::add_node(buffer,
+                _id(static_cast<osmium::object_id_type>(i + 1)),
+                _location(8.1, 49.2),
+                _tag("highway", "primary"),
+                _tag("name", "Main Street"));
+        }
+        benchmark::DoNotOptimize(buffer.committed());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * batch_size);
+}
+
+void bm_tag_list_iteration(benchmark::State& state) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 64UL};
+    osmium::builder::add_node(buffer, _id(1),
+        _tag("highway", "primary"),
+        _tag("name", "Main Street"),
+        _tag("surface", "asphalt"),
+        _tag("lanes", "2"),
+        _tag("maxspeed", "50"),
+        _tag("oneway", "no"),
+        _tag("lit", "yes"),
+        _tag("sidewalk", "both"));
+
+    const auto& node = buffer.get<osmium::Node>(0);
+
+    for (auto _ : state) {
+        unsigned int sum = 0;
+        for (const auto& tag : node.tags()) {
+            sum += static_cast<unsigned char>(tag.key()[0]);
+            sum += static_cast<unsigned char>(tag.value()[0]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * node.tags().size());
+}
+
+void bm_location_conversion(benchmark::State& state) {
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < batch_size; ++i) {
+            const osmium::Location location{-170.0 + 3.456 * static_cast<double>(i),
+                                             -80.0 + 1.234 * static_cast<double>(i)};
+            sum += location.lon() + location.lat();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * batch_size);
+}
+
+void bm_varint_decode(benchmark::State& state) {
+    std::string data;
+    for (std::size_t i = 0; i < batch_size; ++i) {
+        // mix of 1-byte and multi-byte varints
+        uint64_t value = i * i * 12345ULL + i;
+        while (value >= 0x80U) {
+            data.push_back(static_cast<char>(value | 0x80U));
+            value >>= 7U;
+        }
+        data.push_back(static_cast<char>(value));
+    }
+
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        const char* begin = data.data();
+        const char* const end = data.data() + data.size();
+        while (begin != end) {
+            sum += protozero::decode_varint(&begin, end);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * batch_size);
+}
+
+void bm_string_table_add(benchmark::State& state) {
+    std::vector<std::string> strings;
+    strings.reserve(batch_size);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+        strings.push_back("some_tag_value_" + std::to_string(i));
+    }
+
+    for (auto _ : state) {
+        osmium::io::detail::StringTable table;
+        for (const auto& str : strings) {
+            benchmark::DoNotOptimize(table.add(str.c_str()));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * batch_size);
+}
+
+void bm_mercator_projection(benchmark::State& state) {
+    std::vector<osmium::Location> locations;
+    locations.reserve(batch_size);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+        locations.emplace_back(-170.0 + 3.456 * static_cast<double>(i),
+                                -80.0 + 1.234 * static_cast<double>(i));
+    }
+
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (const auto& location : locations) {
+            const auto coordinates = osmium::geom::lonlat_to_mercator(location);
+            sum += coordinates.x + coordinates.y;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * batch_size);
+}
+
+BENCHMARK(bm_buffer_add_commit);
+BENCHMARK(bm_tag_list_iteration);
+BENCHMARK(bm_location_conversion);
+BENCHMARK(bm_varint_decode);
+BENCHMARK(bm_string_table_add);
+BENCHMARK(bm_mercator_projection);
+
+} // anonymous namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,18 @@
+#!/bin/sh
+#
+#  run_benchmark_area_assembler.sh
+#
+
+set -e
+
+BENCHMARK_NAME=area_assembler
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+# This benchmark runs on synthetic data, no input files are needed.
+echo "# num mem time cpu_kernel cpu_user cpu_percent cmd options"
+for n in $OB_SEQ; do
+    $OB_TIME_CMD -f "$n $OB_TIME_FORMAT" $CMD 2>&1 >/dev/null | sed -e "s%$OB_DIR/%%"
+done
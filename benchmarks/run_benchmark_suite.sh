@@ -0,0 +1,137 @@
+#!/bin/sh
+#
+#  run_benchmark_suite.sh
+#
+#  Runs the benchmark suite over the data files in $DATA_DIR and writes
+#  machine-readable JSON results to stdout (redirect to a file to keep
+#  them). Each benchmark is run $SUITE_RUNS times (default 3) per data
+#  file; wall clock time, peak RSS, and, if perf(1) is usable, CPU
+#  cycles are recorded per run.
+#
+#  If $BASELINE_FILE points to the JSON output of an earlier run, the
+#  best wall times per benchmark/file are compared and the script fails
+#  if anything got more than $SUITE_TOLERANCE percent slower (default
+#  10), so the suite can be used as a go/no-go gate before an upgrade.
+#  The comparison report goes to stderr, stdout stays pure JSON.
+#
+#  Use download_data.sh --fixtures to fill $DATA_DIR with the pinned
+#  extracts, so baselines from different machines or dates compare the
+#  same work.
+#
+
+set -e
+
+if [ -z "$DATA_DIR" ]; then
+    echo "Please set DATA_DIR environment variable before running benchmark" >&2
+    exit 1
+fi
+
+OB_DIR=@CMAKE_BINARY_DIR@/benchmarks
+
+SUITE_RUNS=${SUITE_RUNS:-3}
+SUITE_TOLERANCE=${SUITE_TOLERANCE:-10}
+SUITE_BENCHMARKS="count count_tag mercator write_pbf"
+
+TIME_CMD=${TIME_CMD:-/usr/bin/time}
+
+if perf stat -e cycles -x, true >/dev/null 2>&1; then
+    HAVE_PERF=yes
+else
+    HAVE_PERF=no
+fi
+
+DATA_FILES=`find -L $DATA_DIR -mindepth 1 -maxdepth 1 -type f | sort`
+
+RESULTS=`mktemp`
+PERF_OUT=`mktemp`
+trap "rm -f $RESULTS $PERF_OUT" EXIT
+
+for name in $SUITE_BENCHMARKS; do
+    CMD=$OB_DIR/osmium_benchmark_$name
+    case $name in
+        write_pbf) EXTRA_ARGS=/dev/null ;;
+        *)         EXTRA_ARGS= ;;
+    esac
+    for data in $DATA_FILES; do
+        filename=`basename $data`
+        n=1
+        while [ $n -le $SUITE_RUNS ]; do
+            if [ $HAVE_PERF = yes ]; then
+                measured=`$TIME_CMD -f "%e %M" perf stat -e cycles -x, -o $PERF_OUT $CMD $data $EXTRA_ARGS 2>&1 >/dev/null | tail -1`
+                cycles=`grep ',cycles' $PERF_OUT | cut -d, -f1`
+            else
+                measured=`$TIME_CMD -f "%e %M" $CMD $data $EXTRA_ARGS 2>&1 >/dev/null | tail -1`
+                cycles=0
+            fi
+            echo "$name $filename $n $measured $cycles" >>$RESULTS
+            n=`expr $n + 1`
+        done
+    done
+done
+
+awk -v runs="$SUITE_RUNS" '
+    BEGIN {
+        print "{"
+        printf "  \"runs_per_benchmark\": %d,\n", runs
+        print "  \"results\": ["
+        sep = ""
+    }
+    {
+        printf "%s    {\"benchmark\": \"%s\", \"file\": \"%s\", \"run\": %d, \"wall_seconds\": %s, \"peak_rss_kbytes\": %s, \"cpu_cycles\": %s}", sep, $1, $2, $3, $4, $5, $6
+        sep = ",\n"
+    }
+    END {
+        print ""
+        print "  ]"
+        print "}"
+    }' $RESULTS
+
+if [ -n "$BASELINE_FILE" ]; then
+    awk -v tolerance="$SUITE_TOLERANCE" '
+        # First file: baseline JSON written by an earlier run.
+        FNR == NR {
+            if ($0 !~ /"benchmark"/) {
+                next
+            }
+            line = $0
+            gsub(/[",{}]/, "", line)
+            n = split(line, f, /[: ]+/)
+            key = ""
+            wall = 0
+            for (i = 1; i < n; i++) {
+                if (f[i] == "benchmark")    { bench = f[i + 1] }
+                if (f[i] == "file")         { key = bench " " f[i + 1] }
+                if (f[i] == "wall_seconds") { wall = f[i + 1] + 0 }
+            }
+            if (key != "" && (!(key in baseline) || wall < baseline[key])) {
+                baseline[key] = wall
+            }
+            next
+        }
+        # Second file: flat results of this run.
+        {
+            key = $1 " " $2
+            wall = $4 + 0
+            if (!(key in current) || wall < current[key]) {
+                current[key] = wall
+            }
+        }
+        END {
+            status = 0
+            for (key in current) {
+                if (!(key in baseline) || baseline[key] == 0) {
+                    printf "%s: no baseline\n", key | "cat 1>&2"
+                    continue
+                }
+                change = (current[key] - baseline[key]) / baseline[key] * 100
+                printf "%s: baseline %ss, now %ss (%+.1f%%)\n", key, baseline[key], current[key], change | "cat 1>&2"
+                if (change > tolerance) {
+                    status = 1
+                }
+            }
+            if (status) {
+                printf "FAILED: at least one benchmark regressed more than %s%%\n", tolerance | "cat 1>&2"
+            }
+            exit status
+        }' $BASELINE_FILE $RESULTS
+fi
@@ -35,6 +35,7 @@
 #      proj       - include if you want to use any of the Proj.4 functions
 #      sparsehash - include if you use the sparsehash index (deprecated!)
 #      lz4        - include support for LZ4 compression of PBF files
+#      zstd       - include support for Zstandard compressed files
 #
 #    You can check for success with something like this:
 #
@@ -165,6 +166,19 @@ if(Osmium_USE_XML)
     endif()
 endif()
 
+#----------------------------------------------------------------------
+# Component 'zstd'
+if(Osmium_USE_ZSTD)
+    find_package(Zstd REQUIRED)
+
+    list(APPEND OSMIUM_XML_LIBRARIES
+        ${ZSTD_LIBRARIES}
+    )
+    list(APPEND OSMIUM_INCLUDE_DIRS
+        ${ZSTD_INCLUDE_DIRS}
+    )
+endif()
+
 #----------------------------------------------------------------------
 list(APPEND OSMIUM_IO_LIBRARIES
     ${OSMIUM_PBF_LIBRARIES}
@@ -189,6 +203,14 @@ if(Osmium_USE_GEOS)
     else()
         message(WARNING "Osmium: GEOS library is required but not found, please install it or configure the paths.")
     endif()
+
+    # The GEOS C API (needed for osmium/geom/geos_c.hpp) lives in its own
+    # library.
+    find_path(GEOS_C_INCLUDE_DIR geos_c.h)
+    find_library(GEOS_C_LIBRARY NAMES geos_c)
+    if(GEOS_C_INCLUDE_DIR AND GEOS_C_LIBRARY)
+        SET(GEOS_C_FOUND 1)
+    endif()
 endif()
 
 #----------------------------------------------------------------------
@@ -0,0 +1,179 @@
+#ifndef OSMIUM_APPLY_PIPELINE_HPP
+#define OSMIUM_APPLY_PIPELINE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/util.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <initializer_list>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace detail {
+
+        using pipeline_queue_type = osmium::thread::Queue<osmium::memory::Buffer>;
+
+        enum : std::size_t {
+            pipeline_queue_size = 10
+        };
+
+        /**
+         * One pipeline stage: Pop buffers from the in queue, apply the
+         * handler to each, pass the buffer on to the out queue (if any).
+         * An invalid buffer marks the end of the data. If the handler
+         * throws, the exception is stored, the rest of the input is
+         * drained without calling the handler again, and the end marker
+         * is still passed on, so the other stages always finish.
+         */
+        template <typename THandler>
+        inline void run_pipeline_stage(pipeline_queue_type& in, pipeline_queue_type* out, THandler& handler, std::exception_ptr& error) {
+            osmium::thread::set_thread_name("_osmium_apply");
+
+            while (true) {
+                osmium::memory::Buffer buffer;
+                in.wait_and_pop(buffer);
+                if (!buffer) {
+                    break;
+                }
+                if (!error) {
+                    try {
+                        for (auto& item : buffer) {
+                            osmium::apply_item(item, handler);
+                        }
+                    } catch (...) {
+                        error = std::current_exception();
+                        continue;
+                    }
+                    if (out) {
+                        out->push(std::move(buffer));
+                    }
+                }
+            }
+
+            if (!error) {
+                try {
+                    osmium::apply_flush(handler);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+
+            if (out) {
+                out->push(osmium::memory::Buffer{});
+            }
+        }
+
+    } // namespace detail
+
+    /**
+     * Apply the handlers to all items read from the source, each handler
+     * running on its own thread. Buffers are handed from one handler stage
+     * to the next through bounded queues, so the stages of a handler chain
+     * (say filter -> transform -> write) overlap instead of running one
+     * after the other on a single core.
+     *
+     * The source must have a read() function returning an
+     * osmium::memory::Buffer that is invalid at the end of the data, like
+     * osmium::io::Reader does.
+     *
+     * In contrast to osmium::apply(), the handlers are taken by (non-const)
+     * reference and every handler sees each buffer after all handlers to
+     * the left of it are completely done with it. Handlers must not share
+     * mutable state with each other unless that state is thread-safe.
+     * flush() is called on every handler after it has seen all the data.
+     *
+     * If a handler or the source throws, the exception is rethrown here
+     * after all stages have been shut down cleanly. When several stages
+     * throw, the exception of the leftmost one is rethrown.
+     */
+    template <typename TSource, typename... THandlers>
+    inline void apply_pipelined(TSource& source, THandlers&... handlers) {
+        static_assert(sizeof...(THandlers) > 0, "Need at least one handler");
+
+        constexpr const std::size_t num_stages = sizeof...(THandlers);
+
+        std::vector<std::unique_ptr<detail::pipeline_queue_type>> queues;
+        queues.reserve(num_stages);
+        for (std::size_t i = 0; i < num_stages; ++i) {
+            queues.emplace_back(new detail::pipeline_queue_type{detail::pipeline_queue_size, "apply_pipeline"});
+        }
+
+        std::vector<std::exception_ptr> errors(num_stages);
+        std::vector<std::thread> threads;
+        threads.reserve(num_stages);
+
+        std::size_t stage = 0;
+        (void)std::initializer_list<int>{
+            (threads.emplace_back(detail::run_pipeline_stage<THandlers>,
+                                  std::ref(*queues[stage]),
+                                  stage + 1 < num_stages ? queues[stage + 1].get() : nullptr,
+                                  std::ref(handlers),
+                                  std::ref(errors[stage])),
+             ++stage, 0)...};
+
+        std::exception_ptr read_error;
+        try {
+            while (osmium::memory::Buffer buffer = source.read()) {
+                queues[0]->push(std::move(buffer));
+            }
+        } catch (...) {
+            read_error = std::current_exception();
+        }
+        queues[0]->push(osmium::memory::Buffer{}); // end marker
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        if (read_error) {
+            std::rethrow_exception(read_error);
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+} // namespace osmium
+
+#endif // OSMIUM_APPLY_PIPELINE_HPP
@@ -48,12 +48,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/tag.hpp>
 #include <osmium/osm/way.hpp>
-#include <osmium/tags/filter.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cstring>
-#include <functional>
 #include <iostream>
 #include <iterator>
 #include <map>
@@ -95,26 +93,49 @@ namespace osmium {
                 }
             }
 
-            struct MPFilter : public osmium::tags::KeyFilter {
+            /**
+             * Decides which tags count when looking for tags on
+             * multipolygon relations and their member ways. This is
+             * evaluated for every tag of every relation and closed inner
+             * way, so instead of scanning a rule list it dispatches on
+             * the first byte of the key and compares against the few
+             * ignored keys starting with that byte.
+             */
+            struct MPFilter {
+
+                using argument_type = const osmium::Tag&;
+                using result_type   = bool;
+                using iterator      = osmium::memory::CollectionFilterIterator<MPFilter, const osmium::Tag>;
+
+                static bool keep_key(const char* key) noexcept {
+                    switch (key[0]) {
+                        case 'c':
+                            return std::strcmp(key, "created_by") != 0;
+                        case 'n':
+                            return std::strcmp(key, "note") != 0;
+                        case 's':
+                            return std::strcmp(key, "source") != 0;
+                        case 't':
+                            return std::strcmp(key, "type") != 0 &&
+                                   std::strcmp(key, "test:id") != 0 &&
+                                   std::strcmp(key, "test:section") != 0;
+                        default:
+                            return true;
+                    }
+                }
 
-                MPFilter() : osmium::tags::KeyFilter(true) {
-                    add(false, "type");
-                    add(false, "created_by");
-                    add(false, "source");
-                    add(false, "note");
-                    add(false, "test:id");
-                    add(false, "test:section");
+                bool operator()(const osmium::Tag& tag) const noexcept {
+                    return keep_key(tag.key());
                 }
 
             }; // struct MPFilter
 
-            static const MPFilter& filter() noexcept {
-                static const MPFilter filter;
-                return filter;
+            static MPFilter filter() noexcept {
+                return MPFilter{};
             }
 
             void add_tags_to_area(osmium::builder::AreaBuilder& builder, const osmium::Relation& relation) {
-                const auto count = std::count_if(relation.tags().cbegin(), relation.tags().cend(), std::cref(filter()));
+                const auto count = std::count_if(relation.tags().cbegin(), relation.tags().cend(), filter());
 
                 if (debug()) {
                     std::cerr << "  found " << count << " tags on relation (without ignored ones)\n";
@@ -330,12 +351,12 @@ namespace osmium {
                     detail::for_each_member(relation, members, [this, &ways_that_should_be_areas, &area_tags](const osmium::RelationMember& member, const osmium::Way& way) {
                         if (!std::strcmp(member.role(), "inner")) {
                             if (!way.nodes().empty() && way.is_closed() && !way.tags().empty()) {
-                                const auto d = std::count_if(way.tags().cbegin(), way.tags().cend(), std::cref(filter()));
+                                const auto d = std::count_if(way.tags().cbegin(), way.tags().cend(), filter());
                                 if (d > 0) {
-                                    const osmium::tags::KeyFilter::iterator way_fi_begin(std::cref(filter()), way.tags().cbegin(), way.tags().cend());
-                                    const osmium::tags::KeyFilter::iterator way_fi_end(std::cref(filter()), way.tags().cend(), way.tags().cend());
-                                    const osmium::tags::KeyFilter::iterator area_fi_begin(std::cref(filter()), area_tags.cbegin(), area_tags.cend());
-                                    const osmium::tags::KeyFilter::iterator area_fi_end(std::cref(filter()), area_tags.cend(), area_tags.cend());
+                                    const MPFilter::iterator way_fi_begin(filter(), way.tags().cbegin(), way.tags().cend());
+                                    const MPFilter::iterator way_fi_end(filter(), way.tags().cend(), way.tags().cend());
+                                    const MPFilter::iterator area_fi_begin(filter(), area_tags.cbegin(), area_tags.cend());
+                                    const MPFilter::iterator area_fi_end(filter(), area_tags.cend(), area_tags.cend());
 #ifdef __cpp_lib_robust_nonmodifying_seq_ops
                                     if (!std::equal(way_fi_begin, way_fi_end, area_fi_begin, area_fi_end)) {
 #else
@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/area/assembler_config.hpp>
+#include <osmium/area/detail/monotonic_arena.hpp>
 #include <osmium/area/detail/node_ref_segment.hpp>
 #include <osmium/area/detail/proto_ring.hpp>
 #include <osmium/area/detail/segment_list.hpp>
@@ -66,7 +67,9 @@ namespace osmium {
 
         namespace detail {
 
-            using open_ring_its_type = std::list<std::list<ProtoRing>::iterator>;
+            using proto_rings_type = std::list<ProtoRing, ArenaAllocator<ProtoRing>>;
+
+            using open_ring_its_type = std::list<proto_rings_type::iterator, ArenaAllocator<proto_rings_type::iterator>>;
 
             struct location_to_ring_map {
                 osmium::Location location;
@@ -156,8 +159,14 @@ namespace osmium {
                 // List of segments (connection between two nodes)
                 SegmentList m_segment_list;
 
+                // All the small ring bookkeeping allocations are drawn from
+                // this arena which lives as long as this assembler, ie for
+                // one assembly. It must be declared before the containers
+                // using it so it outlives them.
+                MonotonicArena m_arena;
+
                 // The rings we are building from the segments
-                std::list<ProtoRing> m_rings;
+                proto_rings_type m_rings;
 
                 // All node locations
                 std::vector<slocation> m_locations;
@@ -427,7 +436,7 @@ namespace osmium {
                     }
                     segment->mark_direction_done();
 
-                    m_rings.emplace_back(segment);
+                    m_rings.emplace_back(segment, ArenaAllocator<NodeRefSegment*>{&m_arena});
                     ProtoRing* ring = &m_rings.back();
                     if (outer_ring) {
                         if (debug()) {
@@ -478,7 +487,7 @@ namespace osmium {
                         segment->reverse();
                     }
 
-                    m_rings.emplace_back(segment);
+                    m_rings.emplace_back(segment, ArenaAllocator<NodeRefSegment*>{&m_arena});
                     ProtoRing* ring = &m_rings.back();
 
                     const osmium::Location& first_location = node.location(m_segment_list);
@@ -942,7 +951,7 @@ namespace osmium {
                     if (there_are_open_rings()) {
                         ++m_stats.area_really_complex_case;
 
-                        open_ring_its_type open_ring_its;
+                        open_ring_its_type open_ring_its{ArenaAllocator<proto_rings_type::iterator>{&m_arena}};
                         for (auto it = m_rings.begin(); it != m_rings.end(); ++it) {
                             if (!it->closed()) {
                                 open_ring_its.push_back(it);
@@ -993,7 +1002,7 @@ namespace osmium {
 
             protected:
 
-                const std::list<ProtoRing>& rings() const noexcept {
+                const proto_rings_type& rings() const noexcept {
                     return m_rings;
                 }
 
@@ -1189,7 +1198,8 @@ namespace osmium {
 
                 explicit BasicAssembler(const config_type& config) :
                     m_config(config),
-                    m_segment_list(config.debug_level > 1) {
+                    m_segment_list(config.debug_level > 1),
+                    m_rings(ArenaAllocator<ProtoRing>{&m_arena}) {
 #ifdef OSMIUM_WITH_TIMER
                     init_header();
 #endif
@@ -1199,6 +1209,26 @@ namespace osmium {
                     return m_config;
                 }
 
+                /**
+                 * Reset all internal state so the assembler can be reused
+                 * for the next area, like Buffer::clear(). The memory
+                 * allocated for the internal data structures is kept, so
+                 * reusing an assembler instead of constructing a new one
+                 * for every area avoids most of the allocation work between
+                 * small multipolygons. The statistics are reset, too.
+                 */
+                void clear() {
+                    // The rings must go before the arena they are
+                    // allocated from is rewound.
+                    m_rings.clear();
+                    m_arena.reset();
+                    m_segment_list.clear();
+                    m_locations.clear();
+                    m_split_locations.clear();
+                    m_stats = area_stats{};
+                    m_num_members = 0;
+                }
+
                 bool debug() const noexcept {
                     return m_config.debug_level > 1;
                 }
@@ -0,0 +1,228 @@
+#ifndef OSMIUM_AREA_DETAIL_MONOTONIC_ARENA_HPP
+#define OSMIUM_AREA_DETAIL_MONOTONIC_ARENA_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace osmium {
+
+    namespace area {
+
+        namespace detail {
+
+            /**
+             * A simple monotonic memory arena. Memory is allocated in large
+             * chunks and handed out in small pieces that are never freed
+             * individually, only all at once when the arena is cleared or
+             * destroyed.
+             *
+             * The area assembler uses this for its ring bookkeeping which
+             * does many small, short-lived allocations per assembled
+             * multipolygon. All of them have the same lifetime, so they can
+             * come out of an arena that lives as long as one assembly.
+             */
+            class MonotonicArena {
+
+                enum : std::size_t {
+                    chunk_size = 16UL * 1024UL
+                };
+
+                std::vector<std::unique_ptr<unsigned char[]>> m_chunks{};
+
+                unsigned char* m_current = nullptr;
+
+                std::size_t m_remaining = 0;
+
+                void add_chunk(std::size_t size) {
+                    m_chunks.emplace_back(new unsigned char[size]);
+                    m_current = m_chunks.back().get();
+                    m_remaining = size;
+                }
+
+            public:
+
+                MonotonicArena() = default;
+
+                // Allocators keep a pointer to the arena, so it must stay
+                // where it is.
+                MonotonicArena(const MonotonicArena&) = delete;
+                MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+                MonotonicArena(MonotonicArena&&) = delete;
+                MonotonicArena& operator=(MonotonicArena&&) = delete;
+
+                ~MonotonicArena() noexcept = default;
+
+                /**
+                 * Get @code size @endcode bytes of memory aligned to
+                 * @code align @endcode. The memory stays valid until the
+                 * arena is cleared or destroyed.
+                 */
+                void* allocate(std::size_t size, std::size_t align) {
+                    assert(align > 0 && align <= alignof(std::max_align_t));
+                    const std::size_t misalign = reinterpret_cast<std::uintptr_t>(m_current) % align;
+                    const std::size_t padding = misalign == 0 ? 0 : align - misalign;
+
+                    if (size + padding > m_remaining) {
+                        // A fresh chunk from new[] is aligned for any
+                        // fundamental type, so no padding is needed.
+                        add_chunk(size > static_cast<std::size_t>(chunk_size) ? size : static_cast<std::size_t>(chunk_size));
+                    } else {
+                        m_current += padding;
+                        m_remaining -= padding;
+                    }
+
+                    unsigned char* ptr = m_current;
+                    m_current += size;
+                    m_remaining -= size;
+                    return ptr;
+                }
+
+                /**
+                 * Rewind the arena for reuse. The first chunk is kept and
+                 * handed out again, all other chunks are released. All
+                 * allocations made from the arena become invalid.
+                 */
+                void reset() {
+                    if (m_chunks.empty()) {
+                        return;
+                    }
+                    m_chunks.resize(1);
+                    m_current = m_chunks.front().get();
+                    // If the first chunk is an oversized one, only the first
+                    // chunk_size bytes of it are reused. That wastes a bit of
+                    // memory but saves us from keeping track of chunk sizes.
+                    m_remaining = chunk_size;
+                }
+
+                /**
+                 * Release all memory held by the arena. All allocations made
+                 * from it become invalid.
+                 */
+                void clear() {
+                    m_chunks.clear();
+                    m_current = nullptr;
+                    m_remaining = 0;
+                }
+
+                std::size_t num_chunks() const noexcept {
+                    return m_chunks.size();
+                }
+
+            }; // class MonotonicArena
+
+            /**
+             * Standard library allocator drawing from a MonotonicArena.
+             * Deallocation is a no-op, the memory is released when the arena
+             * goes away. A default-constructed allocator has no arena and
+             * falls back to the global operator new/delete, so containers
+             * using this allocator can still be default-constructed.
+             */
+            template <typename T>
+            class ArenaAllocator {
+
+                template <typename U>
+                friend class ArenaAllocator;
+
+                MonotonicArena* m_arena;
+
+            public:
+
+                using value_type      = T;
+                using pointer         = T*;
+                using const_pointer   = const T*;
+                using reference       = T&;
+                using const_reference = const T&;
+                using size_type       = std::size_t;
+                using difference_type = std::ptrdiff_t;
+
+                template <typename U>
+                struct rebind {
+                    using other = ArenaAllocator<U>;
+                };
+
+                ArenaAllocator() noexcept :
+                    m_arena(nullptr) {
+                }
+
+                explicit ArenaAllocator(MonotonicArena* arena) noexcept :
+                    m_arena(arena) {
+                }
+
+                template <typename U>
+                ArenaAllocator(const ArenaAllocator<U>& other) noexcept : // NOLINT(google-explicit-constructor, hicpp-explicit-conversions)
+                    m_arena(other.m_arena) {
+                }
+
+                T* allocate(std::size_t n) {
+                    if (m_arena) {
+                        return static_cast<T*>(m_arena->allocate(sizeof(T) * n, alignof(T)));
+                    }
+                    return static_cast<T*>(::operator new(sizeof(T) * n));
+                }
+
+                void deallocate(T* ptr, std::size_t /*n*/) noexcept {
+                    if (!m_arena) {
+                        ::operator delete(ptr);
+                    }
+                }
+
+                MonotonicArena* arena() const noexcept {
+                    return m_arena;
+                }
+
+            }; // class ArenaAllocator
+
+            template <typename T, typename U>
+            inline bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept {
+                return lhs.arena() == rhs.arena();
+            }
+
+            template <typename T, typename U>
+            inline bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept {
+                return !(lhs == rhs);
+            }
+
+        } // namespace detail
+
+    } // namespace area
+
+} // namespace osmium
+
+#endif // OSMIUM_AREA_DETAIL_MONOTONIC_ARENA_HPP
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/area/detail/monotonic_arena.hpp>
 #include <osmium/area/detail/node_ref_segment.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node_ref.hpp>
@@ -59,16 +60,18 @@ namespace osmium {
 
             public:
 
-                using segments_type = std::vector<NodeRefSegment*>;
+                using segments_type = std::vector<NodeRefSegment*, ArenaAllocator<NodeRefSegment*>>;
+
+                using inner_rings_type = std::vector<ProtoRing*, ArenaAllocator<ProtoRing*>>;
 
             private:
 
                 // Segments in this ring.
-                segments_type m_segments{};
+                segments_type m_segments;
 
                 // If this is an outer ring, these point to it's inner rings
                 // (if any).
-                std::vector<ProtoRing*> m_inner{};
+                inner_rings_type m_inner;
 
                 // The smallest segment. Will be kept current whenever a new
                 // segment is added to the ring.
@@ -90,7 +93,9 @@ namespace osmium {
 
             public:
 
-                explicit ProtoRing(NodeRefSegment* segment) noexcept :
+                explicit ProtoRing(NodeRefSegment* segment, const ArenaAllocator<NodeRefSegment*>& allocator = ArenaAllocator<NodeRefSegment*>{}) :
+                    m_segments(allocator),
+                    m_inner(allocator),
                     m_min_segment(segment)
 #ifdef OSMIUM_DEBUG_RING_NO
                     , m_num(next_num())
@@ -123,7 +128,7 @@ namespace osmium {
                     m_outer_ring = outer_ring;
                 }
 
-                const std::vector<ProtoRing*>& inner_rings() const noexcept {
+                const inner_rings_type& inner_rings() const noexcept {
                     return m_inner;
                 }
 
@@ -198,16 +203,30 @@ namespace osmium {
                 void join_forward(ProtoRing& other) {
                     m_segments.reserve(m_segments.size() + other.m_segments.size());
                     for (NodeRefSegment* segment : other.m_segments) {
-                        add_segment_back(segment);
+                        if (*segment < *m_min_segment) {
+                            m_min_segment = segment;
+                        }
+                        m_segments.push_back(segment);
+                        segment->set_ring(this);
                     }
+                    // The segments keep their orientation, so the sum of
+                    // their determinants is the sum of the other ring.
+                    m_sum += other.m_sum;
                 }
 
                 void join_backward(ProtoRing& other) {
                     m_segments.reserve(m_segments.size() + other.m_segments.size());
                     for (auto it = other.m_segments.rbegin(); it != other.m_segments.rend(); ++it) {
                         (*it)->reverse();
-                        add_segment_back(*it);
+                        if (**it < *m_min_segment) {
+                            m_min_segment = *it;
+                        }
+                        m_segments.push_back(*it);
+                        (*it)->set_ring(this);
                     }
+                    // All segments were reversed, which negates their
+                    // determinants, so subtract the sum of the other ring.
+                    m_sum -= other.m_sum;
                 }
 
                 void print(std::ostream& out) const {
@@ -44,12 +44,17 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <initializer_list>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <numeric>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -84,6 +89,19 @@ namespace osmium {
 
                 using slist_type = std::vector<NodeRefSegment>;
 
+                enum : std::size_t {
+                    // Threshold from which find_intersections() switches
+                    // from the pairwise sweep to the spatial grid index.
+                    min_segments_for_spatial_index = 100
+                };
+
+                enum : std::size_t {
+                    // Threshold up to which erase_duplicate_segments() finds
+                    // duplicates with a hash table instead of scanning the
+                    // sorted list.
+                    max_segments_for_hash_dedup = 1024
+                };
+
                 slist_type m_segments{};
 
                 bool m_debug;
@@ -113,7 +131,203 @@ namespace osmium {
                     });
                 }
 
+                /**
+                 * Check if the given segments intersect, report and count
+                 * the intersection if they do.
+                 */
+                uint32_t check_intersection(const NodeRefSegment& s1, const NodeRefSegment& s2, ProblemReporter* problem_reporter) const {
+                    assert(s1 != s2); // erase_duplicate_segments() should have made sure of that
+
+                    if (!y_range_overlap(s1, s2)) {
+                        return 0;
+                    }
+
+                    const osmium::Location intersection{calculate_intersection(s1, s2)};
+                    if (!intersection) {
+                        return 0;
+                    }
+
+                    if (m_debug) {
+                        std::cerr << "  segments " << s1 << " and " << s2 << " intersecting at " << intersection << "\n";
+                    }
+                    if (problem_reporter) {
+                        problem_reporter->report_intersection(s1.way()->id(), s1.first().location(), s1.second().location(),
+                                                              s2.way()->id(), s2.first().location(), s2.second().location(), intersection);
+                    }
+
+                    return 1;
+                }
+
+                /**
+                 * Find intersections by comparing all pairs of segments
+                 * overlapping in their x range. Used for small segment
+                 * lists where building the spatial grid isn't worth it.
+                 */
+                uint32_t find_intersections_pairwise(ProblemReporter* problem_reporter) const {
+                    uint32_t found_intersections = 0;
+
+                    for (auto it1 = m_segments.cbegin(); it1 != m_segments.cend() - 1; ++it1) {
+                        const NodeRefSegment& s1 = *it1;
+                        for (auto it2 = it1 + 1; it2 != m_segments.end(); ++it2) {
+                            const NodeRefSegment& s2 = *it2;
+
+                            if (outside_x_range(s2, s1)) {
+                                break;
+                            }
+
+                            found_intersections += check_intersection(s1, s2, problem_reporter);
+                        }
+                    }
+
+                    return found_intersections;
+                }
+
+                /**
+                 * Find intersections using a spatial grid over the bounding
+                 * box of all segments. Each segment is registered in all
+                 * grid cells its bounding box covers, only segments sharing
+                 * a cell are checked against each other. Each pair is
+                 * checked exactly once, in the cell containing the lower
+                 * left corner of the overlap of the bounding boxes.
+                 */
+                uint32_t find_intersections_grid(ProblemReporter* problem_reporter) const {
+                    struct bbox_type {
+                        int32_t min_x;
+                        int32_t max_x;
+                        int32_t min_y;
+                        int32_t max_y;
+                    };
+
+                    std::vector<bbox_type> bboxes;
+                    bboxes.reserve(m_segments.size());
+
+                    int32_t min_x = std::numeric_limits<int32_t>::max();
+                    int32_t max_x = std::numeric_limits<int32_t>::min();
+                    int32_t min_y = std::numeric_limits<int32_t>::max();
+                    int32_t max_y = std::numeric_limits<int32_t>::min();
+
+                    for (const NodeRefSegment& segment : m_segments) {
+                        // Segments are normalized, so first() <= second().
+                        const std::pair<int32_t, int32_t> mm_y = std::minmax(segment.first().location().y(), segment.second().location().y());
+                        const bbox_type bbox{segment.first().location().x(),
+                                             segment.second().location().x(),
+                                             mm_y.first,
+                                             mm_y.second};
+                        min_x = std::min(min_x, bbox.min_x);
+                        max_x = std::max(max_x, bbox.max_x);
+                        min_y = std::min(min_y, bbox.min_y);
+                        max_y = std::max(max_y, bbox.max_y);
+                        bboxes.push_back(bbox);
+                    }
+
+                    // Aim for about one segment per cell on average.
+                    const auto dim = static_cast<int64_t>(std::ceil(std::sqrt(static_cast<double>(m_segments.size()))));
+                    const int64_t extent_x = static_cast<int64_t>(max_x) - min_x + 1;
+                    const int64_t extent_y = static_cast<int64_t>(max_y) - min_y + 1;
+                    const int64_t cell_width  = (extent_x + dim - 1) / dim;
+                    const int64_t cell_height = (extent_y + dim - 1) / dim;
+                    const int64_t nx = (extent_x + cell_width  - 1) / cell_width;
+                    const int64_t ny = (extent_y + cell_height - 1) / cell_height;
+
+                    const auto cell_x = [&](const int32_t x) noexcept {
+                        return (static_cast<int64_t>(x) - min_x) / cell_width;
+                    };
+                    const auto cell_y = [&](const int32_t y) noexcept {
+                        return (static_cast<int64_t>(y) - min_y) / cell_height;
+                    };
+
+                    std::vector<std::vector<uint32_t>> cells(static_cast<std::size_t>(nx * ny));
+                    for (uint32_t n = 0; n < bboxes.size(); ++n) {
+                        const bbox_type& bbox = bboxes[n];
+                        for (int64_t cy = cell_y(bbox.min_y); cy <= cell_y(bbox.max_y); ++cy) {
+                            for (int64_t cx = cell_x(bbox.min_x); cx <= cell_x(bbox.max_x); ++cx) {
+                                cells[static_cast<std::size_t>(cy * nx + cx)].push_back(n);
+                            }
+                        }
+                    }
+
+                    uint32_t found_intersections = 0;
+
+                    for (int64_t cy = 0; cy < ny; ++cy) {
+                        for (int64_t cx = 0; cx < nx; ++cx) {
+                            const auto& cell = cells[static_cast<std::size_t>(cy * nx + cx)];
+                            for (std::size_t a = 0; a + 1 < cell.size(); ++a) {
+                                const bbox_type& b1 = bboxes[cell[a]];
+                                for (std::size_t b = a + 1; b < cell.size(); ++b) {
+                                    const bbox_type& b2 = bboxes[cell[b]];
+
+                                    const int32_t overlap_x = std::max(b1.min_x, b2.min_x);
+                                    const int32_t overlap_y = std::max(b1.min_y, b2.min_y);
+                                    if (overlap_x > std::min(b1.max_x, b2.max_x) ||
+                                        overlap_y > std::min(b1.max_y, b2.max_y)) {
+                                        continue;
+                                    }
+
+                                    // Only check this pair in the cell containing the
+                                    // lower left corner of the bounding box overlap,
+                                    // it is registered in other common cells, too.
+                                    if (cell_x(overlap_x) != cx || cell_y(overlap_y) != cy) {
+                                        continue;
+                                    }
+
+                                    found_intersections += check_intersection(m_segments[cell[a]], m_segments[cell[b]], problem_reporter);
+                                }
+                            }
+                        }
+                    }
+
+                    return found_intersections;
+                }
+
+                /**
+                 * Can the segments of this way be extracted with the bulk
+                 * fast path? Only if all locations are valid and no two
+                 * neighboring nodes have the same location, so there is
+                 * nothing to report and exactly size() - 1 segments come
+                 * out.
+                 */
+                static bool can_extract_segments_in_bulk(const osmium::WayNodeList& nodes) noexcept {
+                    const osmium::NodeRef* previous_nr = nullptr;
+                    for (const osmium::NodeRef& nr : nodes) {
+                        if (!nr.location().valid()) {
+                            return false;
+                        }
+                        if (previous_nr && previous_nr->location() == nr.location()) {
+                            return false;
+                        }
+                        previous_nr = &nr;
+                    }
+                    return true;
+                }
+
+                /**
+                 * Add one segment per pair of neighboring nodes. The vector
+                 * is sized once up front and then filled with a tight loop
+                 * without any of the per-segment reporting logic.
+                 *
+                 * @pre can_extract_segments_in_bulk(nodes)
+                 */
+                void extract_segments_in_bulk(const osmium::WayNodeList& nodes, const role_type role, const osmium::Way* way) {
+                    if (nodes.size() < 2) {
+                        return;
+                    }
+
+                    const std::size_t offset = m_segments.size();
+                    m_segments.resize(offset + nodes.size() - 1);
+                    NodeRefSegment* out = m_segments.data() + offset;
+
+                    const osmium::NodeRef* const end = nodes.cend();
+                    for (const osmium::NodeRef* nr = nodes.cbegin() + 1; nr != end; ++nr) {
+                        *out++ = NodeRefSegment{*(nr - 1), *nr, role, way};
+                    }
+                }
+
                 uint32_t extract_segments_from_way_impl(ProblemReporter* problem_reporter, uint64_t& duplicate_nodes, const osmium::Way& way, role_type role) {
+                    if (can_extract_segments_in_bulk(way.nodes())) {
+                        extract_segments_in_bulk(way.nodes(), role, &way);
+                        return 0;
+                    }
+
                     uint32_t invalid_locations = 0;
 
                     osmium::NodeRef previous_nr;
@@ -141,6 +355,140 @@ namespace osmium {
                     return invalid_locations;
                 }
 
+                /// Hash over the two end point locations of a segment.
+                struct segment_locations_hash {
+                    std::size_t operator()(const NodeRefSegment& segment) const noexcept {
+                        // FNV-1a over the four coordinates.
+                        uint64_t hash = 0xcbf29ce484222325ULL;
+                        for (const int32_t value : {segment.first().location().x(),
+                                                    segment.first().location().y(),
+                                                    segment.second().location().x(),
+                                                    segment.second().location().y()}) {
+                            hash ^= static_cast<uint32_t>(value);
+                            hash *= 0x100000001b3ULL;
+                        }
+                        return static_cast<std::size_t>(hash);
+                    }
+                }; // struct segment_locations_hash
+
+                /**
+                 * Count and report one removed pair of duplicate segments.
+                 */
+                void report_duplicate_pair(const NodeRefSegment& s1, const NodeRefSegment& s2, ProblemReporter* problem_reporter, uint64_t& duplicate_segments) const {
+                    if (m_debug) {
+                        std::cerr << "  erase duplicate segment: " << s1 << "\n";
+                    }
+
+                    // Only count and report duplicate segments if they
+                    // belong to the same way or if they don't both have
+                    // the role "inner". Those cases are definitely wrong.
+                    // If the duplicate segments belong to different
+                    // "inner" ways, they could be touching inner rings
+                    // which are perfectly okay. Note that for this check
+                    // the role has to be correct in the member data.
+                    if (s1.way() == s2.way() || !s1.role_inner() || !s2.role_inner()) {
+                        ++duplicate_segments;
+                        if (problem_reporter) {
+                            problem_reporter->report_duplicate_segment(s1.first(), s1.second());
+                        }
+                    }
+                }
+
+                /**
+                 * Count and report the overlaps in a group of identical
+                 * segments.
+                 */
+                void report_overlapping_group(const NodeRefSegment& segment, const std::size_t count, ProblemReporter* problem_reporter, uint64_t& overlapping_segments) const {
+                    const std::size_t overlaps = (count - 1) / 2;
+                    overlapping_segments += overlaps;
+                    if (problem_reporter) {
+                        for (std::size_t n = 0; n < overlaps; ++n) {
+                            problem_reporter->report_overlapping_segment(segment.first(), segment.second());
+                        }
+                    }
+                }
+
+                /**
+                 * Remove duplicate segments found with a hash table over the
+                 * segment locations. Does not need the list to be sorted.
+                 */
+                void erase_duplicate_segments_hash(ProblemReporter* problem_reporter, uint64_t& duplicate_segments, uint64_t& overlapping_segments) {
+                    std::unordered_map<NodeRefSegment, std::vector<uint32_t>, segment_locations_hash> groups;
+                    groups.reserve(m_segments.size());
+
+                    bool found_duplicates = false;
+                    for (uint32_t n = 0; n < static_cast<uint32_t>(m_segments.size()); ++n) {
+                        auto& group = groups[m_segments[n]];
+                        group.push_back(n);
+                        if (group.size() > 1) {
+                            found_duplicates = true;
+                        }
+                    }
+
+                    // The common case: nothing to remove.
+                    if (!found_duplicates) {
+                        return;
+                    }
+
+                    std::vector<bool> erase_segment(m_segments.size(), false);
+                    for (const auto& group : groups) {
+                        const auto& indexes = group.second;
+                        if (indexes.size() < 2) {
+                            continue;
+                        }
+                        for (std::size_t n = 0; n + 1 < indexes.size(); n += 2) {
+                            report_duplicate_pair(m_segments[indexes[n]], m_segments[indexes[n + 1]], problem_reporter, duplicate_segments);
+                            erase_segment[indexes[n]] = true;
+                            erase_segment[indexes[n + 1]] = true;
+                        }
+                        report_overlapping_group(m_segments[indexes.front()], indexes.size(), problem_reporter, overlapping_segments);
+                    }
+
+                    // Compact the survivors, keeping their relative order.
+                    std::size_t to = 0;
+                    for (std::size_t from = 0; from < m_segments.size(); ++from) {
+                        if (!erase_segment[from]) {
+                            if (to != from) {
+                                m_segments[to] = m_segments[from];
+                            }
+                            ++to;
+                        }
+                    }
+                    m_segments.resize(to);
+                }
+
+                /**
+                 * Remove duplicate segments by scanning for runs of equal
+                 * segments in a single pass. The list must be sorted.
+                 */
+                void erase_duplicate_segments_sorted(ProblemReporter* problem_reporter, uint64_t& duplicate_segments, uint64_t& overlapping_segments) {
+                    const std::size_t size = m_segments.size();
+                    std::size_t to = 0;
+                    std::size_t from = 0;
+                    while (from < size) {
+                        std::size_t run_end = from + 1;
+                        while (run_end < size && m_segments[run_end] == m_segments[from]) {
+                            ++run_end;
+                        }
+                        const std::size_t count = run_end - from;
+                        for (std::size_t n = from; n + 1 < run_end; n += 2) {
+                            report_duplicate_pair(m_segments[n], m_segments[n + 1], problem_reporter, duplicate_segments);
+                        }
+                        if (count > 1) {
+                            report_overlapping_group(m_segments[from], count, problem_reporter, overlapping_segments);
+                        }
+                        if (count % 2 == 1) {
+                            // The last segment of the run survives.
+                            if (to != run_end - 1) {
+                                m_segments[to] = m_segments[run_end - 1];
+                            }
+                            ++to;
+                        }
+                        from = run_end;
+                    }
+                    m_segments.resize(to);
+                }
+
             public:
 
                 explicit SegmentList(bool debug) noexcept :
@@ -165,6 +513,14 @@ namespace osmium {
                     return m_segments.empty();
                 }
 
+                /**
+                 * Remove all segments. The allocated memory is kept so the
+                 * list can be reused for the next assembly.
+                 */
+                void clear() noexcept {
+                    m_segments.clear();
+                }
+
                 using const_iterator = slist_type::const_iterator;
                 using iterator = slist_type::iterator;
 
@@ -271,45 +627,30 @@ namespace osmium {
                  * list and remove them. This will always remove pairs of the
                  * same segment. So if there are three, for instance, two will
                  * be removed and one will be left.
+                 *
+                 * For small lists duplicates are found with a hash table over
+                 * the segment locations, so this works without the list being
+                 * sorted. Above a size threshold it falls back to scanning
+                 * for adjacent duplicates and the list must be sorted. The
+                 * relative order of the remaining segments is kept either
+                 * way.
                  */
                 void erase_duplicate_segments(ProblemReporter* problem_reporter, uint64_t& duplicate_segments, uint64_t& overlapping_segments) {
-                    while (true) {
-                        auto it = std::adjacent_find(m_segments.begin(), m_segments.end());
-                        if (it == m_segments.end()) {
-                            break;
-                        }
-                        if (m_debug) {
-                            std::cerr << "  erase duplicate segment: " << *it << "\n";
-                        }
-
-                        // Only count and report duplicate segments if they
-                        // belong to the same way or if they don't both have
-                        // the role "inner". Those cases are definitely wrong.
-                        // If the duplicate segments belong to different
-                        // "inner" ways, they could be touching inner rings
-                        // which are perfectly okay. Note that for this check
-                        // the role has to be correct in the member data.
-                        if (it->way() == std::next(it)->way() || !it->role_inner() || !std::next(it)->role_inner()) {
-                            ++duplicate_segments;
-                            if (problem_reporter) {
-                                problem_reporter->report_duplicate_segment(it->first(), it->second());
-                            }
-                        }
-
-                        if (it + 2 != m_segments.end() && *it == *(it + 2)) {
-                            ++overlapping_segments;
-                            if (problem_reporter) {
-                                problem_reporter->report_overlapping_segment(it->first(), it->second());
-                            }
-                        }
-
-                        m_segments.erase(it, it + 2);
+                    if (m_segments.size() <= max_segments_for_hash_dedup) {
+                        erase_duplicate_segments_hash(problem_reporter, duplicate_segments, overlapping_segments);
+                    } else {
+                        erase_duplicate_segments_sorted(problem_reporter, duplicate_segments, overlapping_segments);
                     }
                 }
 
                 /**
                  * Find intersection between segments.
                  *
+                 * For small segment lists all pairs of segments overlapping
+                 * in their x range are compared. For larger lists a spatial
+                 * grid index over the segments is built first, so only
+                 * segments in the same grid cell have to be compared.
+                 *
                  * @param problem_reporter Any intersections found are
                  *                         reported to this object.
                  * @returns true if there are intersections.
@@ -319,36 +660,11 @@ namespace osmium {
                         return 0;
                     }
 
-                    uint32_t found_intersections = 0;
-
-                    for (auto it1 = m_segments.cbegin(); it1 != m_segments.cend() - 1; ++it1) {
-                        const NodeRefSegment& s1 = *it1;
-                        for (auto it2 = it1 + 1; it2 != m_segments.end(); ++it2) {
-                            const NodeRefSegment& s2 = *it2;
-
-                            assert(s1 != s2); // erase_duplicate_segments() should have made sure of that
-
-                            if (outside_x_range(s2, s1)) {
-                                break;
-                            }
-
-                            if (y_range_overlap(s1, s2)) {
-                                const osmium::Location intersection{calculate_intersection(s1, s2)};
-                                if (intersection) {
-                                    ++found_intersections;
-                                    if (m_debug) {
-                                        std::cerr << "  segments " << s1 << " and " << s2 << " intersecting at " << intersection << "\n";
-                                    }
-                                    if (problem_reporter) {
-                                        problem_reporter->report_intersection(s1.way()->id(), s1.first().location(), s1.second().location(),
-                                                                              s2.way()->id(), s2.first().location(), s2.second().location(), intersection);
-                                    }
-                                }
-                            }
-                        }
+                    if (m_segments.size() < min_segments_for_spatial_index) {
+                        return find_intersections_pairwise(problem_reporter);
                     }
 
-                    return found_intersections;
+                    return find_intersections_grid(problem_reporter);
                 }
 
             }; // class SegmentList
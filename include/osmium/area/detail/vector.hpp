@@ -36,9 +36,15 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node_ref.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# define OSMIUM_CROSS_PRODUCT_X86
+# include <immintrin.h>
+#endif
+
 namespace osmium {
 
     namespace area {
@@ -112,6 +118,75 @@ namespace osmium {
                 return out << '(' << v.x << ',' << v.y << ')';
             }
 
+            inline int64_t sum_of_cross_products_generic(const int32_t* ax, const int32_t* ay,
+                                                         const int32_t* bx, const int32_t* by,
+                                                         std::size_t count) noexcept {
+                int64_t sum = 0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    sum += static_cast<int64_t>(ax[i]) * by[i] -
+                           static_cast<int64_t>(ay[i]) * bx[i];
+                }
+                return sum;
+            }
+
+#ifdef OSMIUM_CROSS_PRODUCT_X86
+
+            __attribute__((target("avx2")))
+            inline int64_t sum_of_cross_products_avx2(const int32_t* ax, const int32_t* ay,
+                                                      const int32_t* bx, const int32_t* by,
+                                                      std::size_t count) noexcept {
+                __m256i acc = _mm256_setzero_si256();
+
+                std::size_t n = 0;
+                for (; n + 4 <= count; n += 4) {
+                    // Widen four 32 bit coordinates to the 64 bit lanes.
+                    // _mm256_mul_epi32() multiplies the (signed) low 32
+                    // bits of each lane into a full 64 bit product.
+                    const __m256i vax = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ax + n)));
+                    const __m256i vay = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ay + n)));
+                    const __m256i vbx = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bx + n)));
+                    const __m256i vby = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(by + n)));
+
+                    const __m256i det = _mm256_sub_epi64(_mm256_mul_epi32(vax, vby),
+                                                         _mm256_mul_epi32(vay, vbx));
+                    acc = _mm256_add_epi64(acc, det);
+                }
+
+                int64_t lanes[4];
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+
+                return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+                       sum_of_cross_products_generic(ax + n, ay + n, bx + n, by + n, count - n);
+            }
+
+            /**
+             * Compute the sum of the cross products (ax[i], ay[i]) x
+             * (bx[i], by[i]) over packed coordinate arrays. With the
+             * start coordinates of the segments of a ring in the a
+             * arrays and the stop coordinates in the b arrays this is
+             * the shoelace formula: twice the signed area of the ring.
+             */
+            inline int64_t sum_of_cross_products(const int32_t* ax, const int32_t* ay,
+                                                 const int32_t* bx, const int32_t* by,
+                                                 std::size_t count) noexcept {
+                using impl_type = int64_t (*)(const int32_t*, const int32_t*, const int32_t*, const int32_t*, std::size_t);
+                // Runtime CPU dispatch, decided once on first use.
+                static const impl_type impl = __builtin_cpu_supports("avx2")
+                                                  ? &sum_of_cross_products_avx2
+                                                  : &sum_of_cross_products_generic;
+                return impl(ax, ay, bx, by, count);
+            }
+
+#else
+
+            inline int64_t sum_of_cross_products(const int32_t* ax, const int32_t* ay,
+                                                 const int32_t* bx, const int32_t* by,
+                                                 std::size_t count) noexcept {
+                return sum_of_cross_products_generic(ax, ay, bx, by, count);
+            }
+
+#endif
+
         } // namespace detail
 
     } // namespace area
@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/area/stats.hpp>
+#include <osmium/osm/area.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/tag.hpp>
@@ -82,6 +83,30 @@ namespace osmium {
 
             osmium::TagsFilter m_filter;
 
+            // The assembler instance reused (via clear()) for all areas
+            // built by this manager. complete_relation() and after_way()
+            // are called from a single thread, so one instance is enough.
+            // Reusing it keeps the memory for the internal data structures
+            // alive between the many small multipolygons in typical input.
+            TAssembler m_assembler;
+
+            // Mapping from the compact sequential area ids handed out with
+            // use_compact_ids() back to the original area ids. The area
+            // with compact id n has its original id at index n - 1.
+            std::vector<osmium::object_id_type> m_original_ids{};
+
+            bool m_compact_ids = false;
+
+            // Replace the ids of all areas in the output buffer starting
+            // at the given offset with compact sequential ids and remember
+            // the original ids.
+            void assign_compact_ids(const std::size_t offset) {
+                for (auto it = this->buffer().template get_iterator<osmium::Area>(offset); it != this->buffer().template end<osmium::Area>(); ++it) {
+                    m_original_ids.push_back(it->id());
+                    it->set_id(static_cast<osmium::object_id_type>(m_original_ids.size()));
+                }
+            }
+
         public:
 
             /**
@@ -95,7 +120,8 @@ namespace osmium {
              */
             explicit MultipolygonManager(assembler_config_type assembler_config, osmium::TagsFilter filter = osmium::TagsFilter{true}) :
                 m_assembler_config(std::move(assembler_config)),
-                m_filter(std::move(filter)) {
+                m_filter(std::move(filter)),
+                m_assembler(m_assembler_config) {
             }
 
             /**
@@ -106,6 +132,38 @@ namespace osmium {
                 return m_stats;
             }
 
+            /**
+             * Give the areas built by this manager compact sequential ids
+             * (1, 2, 3, ...) instead of ids derived from the original way
+             * or relation ids (see object_id_to_area_id()), so per-area
+             * arrays indexed by area id stay dense. The original area ids
+             * are kept on the side and can be looked up with
+             * original_area_id().
+             *
+             * Note that Area::orig_id() and Area::from_way() are derived
+             * from the area id and don't work on areas with compact ids,
+             * use original_area_id() and area_id_to_object_id() instead.
+             *
+             * Call this before feeding any data into the manager.
+             */
+            void use_compact_ids(const bool enable = true) noexcept {
+                m_compact_ids = enable;
+            }
+
+            /**
+             * Get the original area id of the area with the given compact
+             * id (see use_compact_ids()).
+             *
+             * @returns The original area id or 0 if no area with this
+             *          compact id was built.
+             */
+            osmium::object_id_type original_area_id(const osmium::object_id_type compact_id) const noexcept {
+                if (compact_id < 1 || static_cast<std::size_t>(compact_id) > m_original_ids.size()) {
+                    return 0;
+                }
+                return m_original_ids[static_cast<std::size_t>(compact_id) - 1];
+            }
+
             /**
              * We are interested in all relations tagged with type=multipolygon
              * or type=boundary with at least one way member.
@@ -143,9 +201,13 @@ namespace osmium {
                 }
 
                 try {
-                    TAssembler assembler{m_assembler_config};
-                    assembler(relation, ways, this->buffer());
-                    m_stats += assembler.stats();
+                    m_assembler.clear();
+                    const std::size_t offset = this->buffer().committed();
+                    m_assembler(relation, ways, this->buffer());
+                    if (m_compact_ids) {
+                        assign_compact_ids(offset);
+                    }
+                    m_stats += m_assembler.stats();
                 } catch (const osmium::invalid_location&) {
                     // XXX ignore
                 }
@@ -170,9 +232,13 @@ namespace osmium {
                             return;
                         }
 
-                        TAssembler assembler{m_assembler_config};
-                        assembler(way, this->buffer());
-                        m_stats += assembler.stats();
+                        m_assembler.clear();
+                        const std::size_t offset = this->buffer().committed();
+                        m_assembler(way, this->buffer());
+                        if (m_compact_ids) {
+                            assign_compact_ids(offset);
+                        }
+                        m_stats += m_assembler.stats();
                         this->possibly_flush();
                     }
                 } catch (const osmium::invalid_location&) {
@@ -0,0 +1,351 @@
+#ifndef OSMIUM_AREA_MULTIPOLYGON_MANAGER_PARALLEL_HPP
+#define OSMIUM_AREA_MULTIPOLYGON_MANAGER_PARALLEL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/area/multipolygon_manager.hpp>
+#include <osmium/area/stats.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/relations/manager_util.hpp>
+#include <osmium/relations/relations_manager.hpp>
+#include <osmium/tags/taglist.hpp>
+#include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace area {
+
+        /**
+         * Variant of osmium::area::MultipolygonManager that runs the area
+         * assemblers for completed relations on a thread pool instead of
+         * on the calling thread. Because each assembler run is
+         * self-contained this parallelizes the longest part of the
+         * area-building pipeline. Results are merged back into the output
+         * buffer in the order the relations were completed, so the output
+         * is the same as with the single-threaded manager.
+         *
+         * Use it exactly like MultipolygonManager. The assembled areas
+         * show up in the output after the buffer has been flushed, so
+         * access stats() only after the second pass is done.
+         *
+         * @tparam TAssembler Multipolygon Assembler class.
+         * @pre The Ids of all objects must be unique in the input data.
+         */
+        template <typename TAssembler>
+        class MultipolygonManagerParallel : public osmium::relations::RelationsManager<MultipolygonManagerParallel<TAssembler>, false, true, false> {
+
+            using assembler_config_type = typename TAssembler::config_type;
+
+            struct assembly_result {
+                osmium::memory::Buffer buffer{};
+                area_stats stats{};
+            };
+
+            /**
+             * One assembler run on the thread pool. Owns copies of the
+             * relation and its member ways, because the originals are
+             * removed from the manager's stash as soon as the relation
+             * is completed.
+             */
+            class AssemblyTask {
+
+                const assembler_config_type& m_config;
+                osmium::memory::Buffer m_input;
+
+            public:
+
+                AssemblyTask(const assembler_config_type& config, const osmium::Relation& relation, const std::vector<const osmium::Way*>& ways) :
+                    m_config(config),
+                    m_input(initial_task_buffer_size, osmium::memory::Buffer::auto_grow::yes) {
+                    m_input.add_item(relation);
+                    m_input.commit();
+                    for (const osmium::Way* way : ways) {
+                        m_input.add_item(*way);
+                        m_input.commit();
+                    }
+                }
+
+                /**
+                 * Each pool thread keeps one assembler instance that is
+                 * cleared and reused for every task it runs, so the
+                 * internal data structures are not reallocated for every
+                 * small multipolygon. The instance is rebuilt if a task
+                 * with a different configuration arrives on the thread.
+                 */
+                TAssembler& thread_assembler() const {
+                    thread_local const assembler_config_type* assembler_config = nullptr;
+                    thread_local std::unique_ptr<TAssembler> assembler;
+                    if (assembler_config == &m_config && assembler) {
+                        assembler->clear();
+                    } else {
+                        assembler.reset(new TAssembler{m_config});
+                        assembler_config = &m_config;
+                    }
+                    return *assembler;
+                }
+
+                assembly_result operator()() {
+                    auto it = m_input.begin();
+                    assert(it->type() == osmium::item_type::relation);
+                    const auto& relation = static_cast<const osmium::Relation&>(*it);
+                    ++it;
+
+                    std::vector<const osmium::Way*> ways;
+                    for (; it != m_input.end(); ++it) {
+                        assert(it->type() == osmium::item_type::way);
+                        ways.push_back(&static_cast<const osmium::Way&>(*it));
+                    }
+
+                    assembly_result result;
+                    result.buffer = osmium::memory::Buffer{initial_task_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                    try {
+                        TAssembler& assembler = thread_assembler();
+                        assembler(relation, ways, result.buffer);
+                        result.stats = assembler.stats();
+                    } catch (const osmium::invalid_location&) {
+                        // XXX ignore
+                    }
+                    return result;
+                }
+
+            }; // class AssemblyTask
+
+            enum {
+                initial_task_buffer_size = 1024UL * 16UL
+            };
+
+            const assembler_config_type m_assembler_config;
+
+            area_stats m_stats;
+
+            osmium::TagsFilter m_filter;
+
+            osmium::thread::Pool& m_pool;
+
+            std::deque<std::future<assembly_result>> m_pending{};
+
+            std::size_t m_max_pending;
+
+            osmium::relations::SecondPassHandler<MultipolygonManagerParallel> m_parallel_handler_pass2;
+
+            void merge_result(assembly_result&& result) {
+                m_stats += result.stats;
+                if (result.buffer && result.buffer.committed() > 0) {
+                    this->buffer().add_buffer(result.buffer);
+                    this->buffer().commit();
+                }
+                this->possibly_flush();
+            }
+
+            void drain_one() {
+                assert(!m_pending.empty());
+                merge_result(m_pending.front().get());
+                m_pending.pop_front();
+            }
+
+            void drain_ready() {
+                while (!m_pending.empty() &&
+                       m_pending.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                    drain_one();
+                }
+            }
+
+            void drain_all() {
+                while (!m_pending.empty()) {
+                    drain_one();
+                }
+            }
+
+        public:
+
+            /**
+             * Construct a MultipolygonManagerParallel.
+             *
+             * @param assembler_config The configuration that will be given to
+             *                         any newly constructed area assembler.
+             * @param filter An optional filter specifying what tags are
+             *               needed on closed ways or multipolygon relations
+             *               to build the area.
+             * @param pool The thread pool the assemblers should run on.
+             */
+            explicit MultipolygonManagerParallel(assembler_config_type assembler_config,
+                                                 osmium::TagsFilter filter = osmium::TagsFilter{true},
+                                                 osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                m_assembler_config(std::move(assembler_config)),
+                m_filter(std::move(filter)),
+                m_pool(pool),
+                m_max_pending(static_cast<std::size_t>(pool.num_threads()) * 2),
+                m_parallel_handler_pass2(*this) {
+            }
+
+            MultipolygonManagerParallel(const MultipolygonManagerParallel&) = delete;
+            MultipolygonManagerParallel& operator=(const MultipolygonManagerParallel&) = delete;
+
+            MultipolygonManagerParallel(MultipolygonManagerParallel&&) = delete;
+            MultipolygonManagerParallel& operator=(MultipolygonManagerParallel&&) = delete;
+
+            ~MultipolygonManagerParallel() noexcept {
+                try {
+                    drain_all();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /**
+             * Return reference to second pass handler. This shadows the
+             * function in RelationsManager so the flush at the end of the
+             * second pass waits for all outstanding assembler runs.
+             */
+            osmium::relations::SecondPassHandler<MultipolygonManagerParallel>& handler(const std::function<void(osmium::memory::Buffer&&)>& callback = nullptr) {
+                this->set_callback(callback);
+                return m_parallel_handler_pass2;
+            }
+
+            /**
+             * Wait for all outstanding assembler runs and flush the output
+             * buffer. Called at the end of the second pass through the
+             * handler returned by handler().
+             */
+            void flush_output() {
+                drain_all();
+                osmium::relations::RelationsManagerBase::flush_output();
+            }
+
+            /**
+             * Access the aggregated statistics generated by the assemblers
+             * called from the manager. Only valid after the output has been
+             * flushed.
+             */
+            const area_stats& stats() const noexcept {
+                return m_stats;
+            }
+
+            /**
+             * We are interested in all relations tagged with type=multipolygon
+             * or type=boundary with at least one way member.
+             */
+            bool new_relation(const osmium::Relation& relation) const {
+                const char* type = relation.tags().get_value_by_key("type");
+
+                // ignore relations without "type" tag
+                if (type == nullptr) {
+                    return false;
+                }
+
+                if (((!std::strcmp(type, "multipolygon")) || (!std::strcmp(type, "boundary"))) && osmium::tags::match_any_of(relation.tags(), m_filter)) {
+                    return std::any_of(relation.members().cbegin(), relation.members().cend(), [](const RelationMember& member) {
+                        return member.type() == osmium::item_type::way;
+                    });
+                }
+
+                return false;
+            }
+
+            /**
+             * This is called when a relation is complete, ie. all members
+             * were found in the input. It hands the relation to an
+             * assembler running on the thread pool.
+             */
+            void complete_relation(const osmium::Relation& relation) {
+                std::vector<const osmium::Way*> ways;
+                ways.reserve(relation.members().size());
+                for (const auto& member : relation.members()) {
+                    if (member.ref() != 0) {
+                        ways.push_back(this->get_member_way(member.ref()));
+                        assert(ways.back() != nullptr);
+                    }
+                }
+
+                m_pending.push_back(m_pool.submit(AssemblyTask{m_assembler_config, relation, ways}));
+
+                // Merge whatever is already done and apply backpressure if
+                // the pool can not keep up.
+                drain_ready();
+                while (m_pending.size() > m_max_pending) {
+                    drain_one();
+                }
+            }
+
+            void after_way(const osmium::Way& way) {
+                // you need at least 4 nodes to make up a polygon
+                if (way.nodes().size() <= 3) {
+                    return;
+                }
+
+                try {
+                    if (!way.nodes().front().location() || !way.nodes().back().location()) {
+                        throw osmium::invalid_location{"invalid location"};
+                    }
+                    if (way.ends_have_same_location()) {
+                        if (way.tags().has_tag("area", "no")) {
+                            return;
+                        }
+
+                        if (osmium::tags::match_none_of(way.tags(), m_filter)) {
+                            return;
+                        }
+
+                        TAssembler assembler{m_assembler_config};
+                        assembler(way, this->buffer());
+                        m_stats += assembler.stats();
+                        this->possibly_flush();
+                    }
+                } catch (const osmium::invalid_location&) {
+                    // XXX ignore
+                }
+            }
+
+        }; // class MultipolygonManagerParallel
+
+    } // namespace area
+
+} // namespace osmium
+
+#endif // OSMIUM_AREA_MULTIPOLYGON_MANAGER_PARALLEL_HPP
@@ -0,0 +1,430 @@
+#ifndef OSMIUM_AREA_PROBLEM_REPORTER_BUFFERED_HPP
+#define OSMIUM_AREA_PROBLEM_REPORTER_BUFFERED_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/area/problem_reporter.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node_ref.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/util.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace area {
+
+        /**
+         * Decorator for any ProblemReporter that buffers the reported
+         * problems in a compact in-memory log and forwards them to the
+         * wrapped reporter on a background thread.
+         *
+         * Some reporters are expensive to call, the ProblemReporterOGR
+         * for instance creates OGR features which can stall the assembler
+         * on GDAL when problems are frequent. With this decorator the
+         * assembler only appends to an in-memory log, the expensive work
+         * happens on the background thread.
+         *
+         * Ways given to the report functions are copied into the log,
+         * because the originals do not live longer than the assembler run
+         * that reported them.
+         *
+         * The wrapped reporter is only ever called from the background
+         * thread, it does not have to be thread-safe. It must stay alive
+         * until this reporter is destroyed. Call flush() to make sure all
+         * buffered problems have been forwarded.
+         */
+        class ProblemReporterBuffered : public ProblemReporter {
+
+            enum class problem_kind {
+                duplicate_node,
+                touching_ring,
+                intersection,
+                duplicate_segment,
+                overlapping_segment,
+                ring_not_closed,
+                role_should_be_outer,
+                role_should_be_inner,
+                way_in_multiple_rings,
+                inner_with_same_tags,
+                invalid_location,
+                duplicate_way,
+                way
+            }; // enum class problem_kind
+
+            enum : std::size_t {
+                no_way = std::numeric_limits<std::size_t>::max()
+            };
+
+            enum : std::size_t {
+                initial_way_buffer_size = 1024UL * 16UL
+            };
+
+            /**
+             * One buffered report call plus the object context it was
+             * made in. The context has to be stored per entry, because
+             * set_object()/set_nodes() are non-virtual and can not be
+             * buffered themselves.
+             */
+            struct log_entry {
+                problem_kind kind = problem_kind::way;
+                osmium::item_type object_type = osmium::item_type::undefined;
+                osmium::object_id_type object_id = 0;
+                std::size_t nodes = 0;
+                osmium::object_id_type id1 = 0;
+                osmium::object_id_type id2 = 0;
+                osmium::Location locations[5];
+                std::size_t way_offset = no_way;
+            }; // struct log_entry
+
+            /// A batch of log entries and the ways they refer to.
+            struct batch_type {
+                std::vector<log_entry> entries{};
+                osmium::memory::Buffer ways{};
+            }; // struct batch_type
+
+            ProblemReporter* m_downstream;
+
+            batch_type m_batch{};
+
+            std::size_t m_max_entries_per_batch;
+
+            osmium::thread::Queue<batch_type> m_queue;
+
+            std::mutex m_mutex{};
+            std::condition_variable m_batch_done{};
+            std::size_t m_batches_submitted = 0;
+            std::size_t m_batches_completed = 0;
+            std::exception_ptr m_exception{};
+
+            std::thread m_thread;
+
+            void replay(const log_entry& entry, const osmium::memory::Buffer& ways) const {
+                m_downstream->set_object(entry.object_type, entry.object_id);
+                m_downstream->set_nodes(entry.nodes);
+                switch (entry.kind) {
+                    case problem_kind::duplicate_node:
+                        m_downstream->report_duplicate_node(entry.id1, entry.id2, entry.locations[0]);
+                        break;
+                    case problem_kind::touching_ring:
+                        m_downstream->report_touching_ring(entry.id1, entry.locations[0]);
+                        break;
+                    case problem_kind::intersection:
+                        m_downstream->report_intersection(entry.id1, entry.locations[0], entry.locations[1],
+                                                          entry.id2, entry.locations[2], entry.locations[3], entry.locations[4]);
+                        break;
+                    case problem_kind::duplicate_segment:
+                        m_downstream->report_duplicate_segment(osmium::NodeRef{entry.id1, entry.locations[0]},
+                                                               osmium::NodeRef{entry.id2, entry.locations[1]});
+                        break;
+                    case problem_kind::overlapping_segment:
+                        m_downstream->report_overlapping_segment(osmium::NodeRef{entry.id1, entry.locations[0]},
+                                                                 osmium::NodeRef{entry.id2, entry.locations[1]});
+                        break;
+                    case problem_kind::ring_not_closed:
+                        m_downstream->report_ring_not_closed(osmium::NodeRef{entry.id1, entry.locations[0]},
+                                                             entry.way_offset == static_cast<std::size_t>(no_way) ? nullptr : &ways.get<osmium::Way>(entry.way_offset));
+                        break;
+                    case problem_kind::role_should_be_outer:
+                        m_downstream->report_role_should_be_outer(entry.id1, entry.locations[0], entry.locations[1]);
+                        break;
+                    case problem_kind::role_should_be_inner:
+                        m_downstream->report_role_should_be_inner(entry.id1, entry.locations[0], entry.locations[1]);
+                        break;
+                    case problem_kind::way_in_multiple_rings:
+                        m_downstream->report_way_in_multiple_rings(ways.get<osmium::Way>(entry.way_offset));
+                        break;
+                    case problem_kind::inner_with_same_tags:
+                        m_downstream->report_inner_with_same_tags(ways.get<osmium::Way>(entry.way_offset));
+                        break;
+                    case problem_kind::invalid_location:
+                        m_downstream->report_invalid_location(entry.id1, entry.id2);
+                        break;
+                    case problem_kind::duplicate_way:
+                        m_downstream->report_duplicate_way(ways.get<osmium::Way>(entry.way_offset));
+                        break;
+                    case problem_kind::way:
+                        m_downstream->report_way(ways.get<osmium::Way>(entry.way_offset));
+                        break;
+                }
+            }
+
+            void run() {
+                osmium::thread::set_thread_name("_osmium_problem");
+
+                while (true) {
+                    batch_type batch;
+                    m_queue.wait_and_pop(batch);
+
+                    // An empty batch is the signal to shut down.
+                    const bool done = batch.entries.empty();
+
+                    if (!done && !m_exception) {
+                        try {
+                            for (const log_entry& entry : batch.entries) {
+                                replay(entry, batch.ways);
+                            }
+                        } catch (...) {
+                            const std::lock_guard<std::mutex> lock{m_mutex};
+                            m_exception = std::current_exception();
+                        }
+                    }
+
+                    {
+                        const std::lock_guard<std::mutex> lock{m_mutex};
+                        ++m_batches_completed;
+                    }
+                    m_batch_done.notify_all();
+
+                    if (done) {
+                        return;
+                    }
+                }
+            }
+
+            void submit_batch() {
+                {
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    ++m_batches_submitted;
+                }
+                m_queue.push(std::move(m_batch));
+                m_batch = batch_type{};
+            }
+
+            void wait_for_worker() {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                m_batch_done.wait(lock, [this]() {
+                    return m_batches_completed >= m_batches_submitted;
+                });
+                if (m_exception) {
+                    const std::exception_ptr exception = m_exception;
+                    m_exception = std::exception_ptr{};
+                    std::rethrow_exception(exception);
+                }
+            }
+
+            log_entry& add_entry(const problem_kind kind) {
+                log_entry entry{};
+                entry.kind = kind;
+                entry.object_type = m_object_type;
+                entry.object_id = m_object_id;
+                entry.nodes = m_nodes;
+                m_batch.entries.push_back(entry);
+                return m_batch.entries.back();
+            }
+
+            void possibly_submit() {
+                if (m_batch.entries.size() >= m_max_entries_per_batch) {
+                    submit_batch();
+                }
+            }
+
+            std::size_t add_way(const osmium::Way& way) {
+                if (!m_batch.ways) {
+                    m_batch.ways = osmium::memory::Buffer{initial_way_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                }
+                const std::size_t offset = m_batch.ways.committed();
+                m_batch.ways.add_item(way);
+                m_batch.ways.commit();
+                return offset;
+            }
+
+        public:
+
+            /**
+             * Construct a buffered problem reporter.
+             *
+             * @param downstream The reporter the problems are forwarded
+             *        to from the background thread. Must stay alive until
+             *        this reporter is destroyed.
+             * @param max_entries_per_batch Problems are handed to the
+             *        background thread in batches of at most this many
+             *        entries.
+             */
+            explicit ProblemReporterBuffered(ProblemReporter& downstream, std::size_t max_entries_per_batch = 1024) :
+                m_downstream(&downstream),
+                m_max_entries_per_batch(max_entries_per_batch > 0 ? max_entries_per_batch : 1),
+                m_queue(0, "problem_reporter"),
+                m_thread(&ProblemReporterBuffered::run, this) {
+            }
+
+            ProblemReporterBuffered(const ProblemReporterBuffered&) = delete;
+            ProblemReporterBuffered& operator=(const ProblemReporterBuffered&) = delete;
+
+            ProblemReporterBuffered(ProblemReporterBuffered&&) = delete;
+            ProblemReporterBuffered& operator=(ProblemReporterBuffered&&) = delete;
+
+            ~ProblemReporterBuffered() noexcept override {
+                try {
+                    if (!m_batch.entries.empty()) {
+                        submit_batch();
+                    }
+                    m_queue.push(batch_type{});
+                    m_thread.join();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /**
+             * Wait until all buffered problems have been forwarded to the
+             * wrapped reporter.
+             *
+             * @throws Whatever the wrapped reporter threw on the
+             *         background thread.
+             */
+            void flush() {
+                if (!m_batch.entries.empty()) {
+                    submit_batch();
+                }
+                wait_for_worker();
+            }
+
+            void report_duplicate_node(osmium::object_id_type node_id1, osmium::object_id_type node_id2, osmium::Location location) override {
+                log_entry& entry = add_entry(problem_kind::duplicate_node);
+                entry.id1 = node_id1;
+                entry.id2 = node_id2;
+                entry.locations[0] = location;
+                possibly_submit();
+            }
+
+            void report_touching_ring(osmium::object_id_type node_id, osmium::Location location) override {
+                log_entry& entry = add_entry(problem_kind::touching_ring);
+                entry.id1 = node_id;
+                entry.locations[0] = location;
+                possibly_submit();
+            }
+
+            void report_intersection(osmium::object_id_type way1_id, osmium::Location way1_seg_start, osmium::Location way1_seg_end,
+                                     osmium::object_id_type way2_id, osmium::Location way2_seg_start, osmium::Location way2_seg_end, osmium::Location intersection) override {
+                log_entry& entry = add_entry(problem_kind::intersection);
+                entry.id1 = way1_id;
+                entry.id2 = way2_id;
+                entry.locations[0] = way1_seg_start;
+                entry.locations[1] = way1_seg_end;
+                entry.locations[2] = way2_seg_start;
+                entry.locations[3] = way2_seg_end;
+                entry.locations[4] = intersection;
+                possibly_submit();
+            }
+
+            void report_duplicate_segment(const osmium::NodeRef& nr1, const osmium::NodeRef& nr2) override {
+                log_entry& entry = add_entry(problem_kind::duplicate_segment);
+                entry.id1 = nr1.ref();
+                entry.id2 = nr2.ref();
+                entry.locations[0] = nr1.location();
+                entry.locations[1] = nr2.location();
+                possibly_submit();
+            }
+
+            void report_overlapping_segment(const osmium::NodeRef& nr1, const osmium::NodeRef& nr2) override {
+                log_entry& entry = add_entry(problem_kind::overlapping_segment);
+                entry.id1 = nr1.ref();
+                entry.id2 = nr2.ref();
+                entry.locations[0] = nr1.location();
+                entry.locations[1] = nr2.location();
+                possibly_submit();
+            }
+
+            void report_ring_not_closed(const osmium::NodeRef& nr, const osmium::Way* way) override {
+                log_entry& entry = add_entry(problem_kind::ring_not_closed);
+                entry.id1 = nr.ref();
+                entry.locations[0] = nr.location();
+                if (way) {
+                    entry.way_offset = add_way(*way);
+                }
+                possibly_submit();
+            }
+
+            void report_role_should_be_outer(osmium::object_id_type way_id, osmium::Location seg_start, osmium::Location seg_end) override {
+                log_entry& entry = add_entry(problem_kind::role_should_be_outer);
+                entry.id1 = way_id;
+                entry.locations[0] = seg_start;
+                entry.locations[1] = seg_end;
+                possibly_submit();
+            }
+
+            void report_role_should_be_inner(osmium::object_id_type way_id, osmium::Location seg_start, osmium::Location seg_end) override {
+                log_entry& entry = add_entry(problem_kind::role_should_be_inner);
+                entry.id1 = way_id;
+                entry.locations[0] = seg_start;
+                entry.locations[1] = seg_end;
+                possibly_submit();
+            }
+
+            void report_way_in_multiple_rings(const osmium::Way& way) override {
+                add_entry(problem_kind::way_in_multiple_rings).way_offset = add_way(way);
+                possibly_submit();
+            }
+
+            void report_inner_with_same_tags(const osmium::Way& way) override {
+                add_entry(problem_kind::inner_with_same_tags).way_offset = add_way(way);
+                possibly_submit();
+            }
+
+            void report_invalid_location(osmium::object_id_type way_id, osmium::object_id_type node_id) override {
+                log_entry& entry = add_entry(problem_kind::invalid_location);
+                entry.id1 = way_id;
+                entry.id2 = node_id;
+                possibly_submit();
+            }
+
+            void report_duplicate_way(const osmium::Way& way) override {
+                add_entry(problem_kind::duplicate_way).way_offset = add_way(way);
+                possibly_submit();
+            }
+
+            void report_way(const osmium::Way& way) override {
+                add_entry(problem_kind::way).way_offset = add_way(way);
+                possibly_submit();
+            }
+
+        }; // class ProblemReporterBuffered
+
+    } // namespace area
+
+} // namespace osmium
+
+#endif // OSMIUM_AREA_PROBLEM_REPORTER_BUFFERED_HPP
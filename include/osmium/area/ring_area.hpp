@@ -0,0 +1,129 @@
+#ifndef OSMIUM_AREA_RING_AREA_HPP
+#define OSMIUM_AREA_RING_AREA_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/area/detail/vector.hpp>
+#include <osmium/osm/node_ref_list.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace osmium {
+
+    namespace area {
+
+        /**
+         * Compute twice the signed area of the ring described by the
+         * given list of node refs, in raw coordinate units (1e-7th of
+         * a degree). Positive for counterclockwise rings, negative for
+         * clockwise rings.
+         *
+         * This uses the shoelace formula evaluated with a vectorized
+         * kernel over batches of packed coordinates, much faster than
+         * summing segment by segment. If the first and last node do not
+         * have the same location, the ring is implicitly closed.
+         *
+         * All node locations must be set.
+         */
+        inline int64_t signed_area_sum(const osmium::NodeRefList& nodes) {
+            if (nodes.size() < 3) {
+                return 0;
+            }
+
+            enum : std::size_t {
+                batch_size = 256
+            };
+
+            int32_t ax[batch_size];
+            int32_t ay[batch_size];
+            int32_t bx[batch_size];
+            int32_t by[batch_size];
+
+            int64_t sum = 0;
+
+            const osmium::NodeRef* node_ref = nodes.cbegin();
+            std::size_t remaining = nodes.size() - 1;
+            while (remaining > 0) {
+                const std::size_t num = remaining < batch_size ? remaining : batch_size;
+
+                for (std::size_t i = 0; i < num; ++i) {
+                    ax[i] = node_ref[i].x();
+                    ay[i] = node_ref[i].y();
+                    bx[i] = node_ref[i + 1].x();
+                    by[i] = node_ref[i + 1].y();
+                }
+
+                sum += detail::sum_of_cross_products(ax, ay, bx, by, num);
+
+                node_ref += num;
+                remaining -= num;
+            }
+
+            if (nodes.front().location() != nodes.back().location()) {
+                const detail::vec a{nodes.back()};
+                const detail::vec b{nodes.front()};
+                sum += a * b;
+            }
+
+            return sum;
+        }
+
+        /**
+         * Is the ring described by the given list of node refs wound
+         * clockwise? Uses the same convention as the area assembler:
+         * degenerate rings with zero area count as clockwise.
+         *
+         * All node locations must be set.
+         */
+        inline bool is_clockwise(const osmium::NodeRefList& nodes) {
+            return signed_area_sum(nodes) <= 0;
+        }
+
+        /**
+         * Compute the signed area of the ring described by the given
+         * list of node refs, in square degrees. Positive for
+         * counterclockwise rings, negative for clockwise rings.
+         *
+         * All node locations must be set.
+         */
+        inline double signed_area(const osmium::NodeRefList& nodes) {
+            const auto precision = static_cast<double>(osmium::detail::coordinate_precision);
+            return static_cast<double>(signed_area_sum(nodes)) / 2 / (precision * precision);
+        }
+
+    } // namespace area
+
+} // namespace osmium
+
+#endif // OSMIUM_AREA_RING_AREA_HPP
@@ -52,6 +52,16 @@ namespace osmium {
         /**
          * Parent class for individual builder classes. Instantiate one of
          * its derived classes.
+         *
+         * The builders usually zero all padding bytes and the unused part
+         * of the user name area, so buffers never contain uninitialized
+         * memory no matter where the data came from. Code that only ever
+         * builds from already-validated input, like a file format decoder,
+         * can define OSMIUM_TRUSTED_BUILDERS to skip this zeroing; only
+         * the string terminators that are actually read are written then.
+         * The padding contents become unspecified, so raw buffer bytes
+         * are no longer reproducible. The macro must be set consistently
+         * in the whole program, best from the build system.
          */
         class Builder {
 
@@ -116,7 +126,11 @@ namespace osmium {
                 // always fit.
                 const auto padding = static_cast<osmium::memory::item_size_type>(osmium::memory::align_bytes - (size() % osmium::memory::align_bytes));
                 if (padding != osmium::memory::align_bytes) {
+#ifdef OSMIUM_TRUSTED_BUILDERS
+                    reserve_space(padding);
+#else
                     std::fill_n(reserve_space(padding), padding, 0);
+#endif
                     if (self) {
                         add_size(padding);
                     } else if (m_parent) {
@@ -199,6 +213,17 @@ namespace osmium {
                 return m_buffer;
             }
 
+            /**
+             * Make sure the buffer has room for at least the given number
+             * of additional bytes. Call this before a series of appends
+             * (like adding many tags) when the total size is known in
+             * advance, then the buffer will grow at most once instead of
+             * possibly several times.
+             */
+            void reserve(const std::size_t size) {
+                m_buffer.reserve(size);
+            }
+
             /**
              * Add a subitem to the object being built. This can be something
              * like a TagList or RelationMemberList.
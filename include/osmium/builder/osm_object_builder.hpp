@@ -44,6 +44,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/node_ref.hpp>
 #include <osmium/osm/object.hpp>
 #include <osmium/osm/relation.hpp>
+#include <osmium/osm/slim_node.hpp>
 #include <osmium/osm/tag.hpp>
 #include <osmium/osm/timestamp.hpp>
 #include <osmium/osm/types.hpp>
@@ -60,6 +61,7 @@ DEALINGS IN THE SOFTWARE.
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -170,6 +172,11 @@ namespace osmium {
         template <typename T>
         class NodeRefListBuilder : public Builder {
 
+            osmium::NodeRef m_last{};
+            std::size_t m_skipped = 0;
+            bool m_skip_duplicates = false;
+            bool m_have_last = false;
+
         public:
 
             explicit NodeRefListBuilder(osmium::memory::Buffer& buffer, Builder* parent = nullptr) :
@@ -192,7 +199,33 @@ namespace osmium {
                 add_padding();
             }
 
+            /**
+             * Drop consecutive duplicate node refs added to this list:
+             * refs with the same id as the one added before them, or with
+             * the same (valid) location, are skipped. Such zero-length
+             * segments are common in bad imports and make geometry
+             * factories throw or waste cycles. Call this before adding
+             * any node refs.
+             */
+            void skip_duplicates() noexcept {
+                m_skip_duplicates = true;
+            }
+
+            /// The number of node refs dropped because they were consecutive duplicates.
+            std::size_t duplicates_skipped() const noexcept {
+                return m_skipped;
+            }
+
             void add_node_ref(const NodeRef& node_ref) {
+                if (m_skip_duplicates) {
+                    if (m_have_last && (node_ref.ref() == m_last.ref() ||
+                                        (node_ref.location().valid() && node_ref.location() == m_last.location()))) {
+                        ++m_skipped;
+                        return;
+                    }
+                    m_have_last = true;
+                    m_last = node_ref;
+                }
                 new (reserve_space_for<osmium::NodeRef>()) osmium::NodeRef{node_ref};
                 add_size(sizeof(osmium::NodeRef));
             }
@@ -207,8 +240,54 @@ namespace osmium {
         using OuterRingBuilder   = NodeRefListBuilder<OuterRing>;
         using InnerRingBuilder   = NodeRefListBuilder<InnerRing>;
 
+        /**
+         * Add a stored envelope (osmium::WayEnvelope) to the way being
+         * built. The whole subitem is written by the constructor, so
+         * the builder is usually used as a temporary:
+         *
+         * @code
+         * osmium::builder::WayEnvelopeBuilder{way_builder, box};
+         * @endcode
+         */
+        class WayEnvelopeBuilder : public Builder {
+
+        public:
+
+            WayEnvelopeBuilder(osmium::memory::Buffer& buffer, Builder* parent, const osmium::Box& box) :
+                Builder(buffer, parent, sizeof(WayEnvelope)) {
+                new (&item()) WayEnvelope{};
+                static_cast<WayEnvelope&>(item()).set_box(box);
+            }
+
+            WayEnvelopeBuilder(Builder& parent, const osmium::Box& box) :
+                Builder(parent.buffer(), &parent, sizeof(WayEnvelope)) {
+                new (&item()) WayEnvelope{};
+                static_cast<WayEnvelope&>(item()).set_box(box);
+            }
+
+            WayEnvelopeBuilder(const WayEnvelopeBuilder&) = delete;
+            WayEnvelopeBuilder& operator=(const WayEnvelopeBuilder&) = delete;
+
+            WayEnvelopeBuilder(WayEnvelopeBuilder&&) = delete;
+            WayEnvelopeBuilder& operator=(WayEnvelopeBuilder&&) = delete;
+
+            ~WayEnvelopeBuilder() {
+                add_padding();
+            }
+
+        }; // class WayEnvelopeBuilder
+
         class RelationMemberListBuilder : public Builder {
 
+            /**
+             * Buffer offsets and lengths of the role strings added to
+             * this member list so far. Only used when role interning is
+             * enabled.
+             */
+            std::vector<std::pair<std::size_t, std::size_t>> m_interned_roles{};
+
+            bool m_intern_roles = false;
+
             /**
              * Add role to buffer.
              *
@@ -218,6 +297,18 @@ namespace osmium {
              * @param length Length of role (without \0 termination).
              */
             void add_role(osmium::RelationMember& member, const char* role, const std::size_t length) {
+                if (m_intern_roles) {
+                    const std::size_t member_offset = buffer().written() - sizeof(osmium::RelationMember);
+                    for (const auto& interned : m_interned_roles) {
+                        if (interned.second == length &&
+                            member_offset - interned.first <= std::numeric_limits<uint16_t>::max() &&
+                            std::memcmp(buffer().data() + interned.first, role, length) == 0) {
+                            member.set_role_reference(static_cast<uint16_t>(member_offset - interned.first));
+                            return;
+                        }
+                    }
+                    m_interned_roles.emplace_back(buffer().written(), length);
+                }
                 member.set_role_size(static_cast<osmium::string_size_type>(length) + 1);
                 add_size(append_with_zero(role, static_cast<osmium::memory::item_size_type>(length)));
                 add_padding(true);
@@ -245,6 +336,21 @@ namespace osmium {
                 add_padding();
             }
 
+            /**
+             * Enable role interning for this member list. When the same
+             * role appears again, later members store a small backwards
+             * reference to the first occurrence of the role string
+             * instead of another copy. RelationMember::role() resolves
+             * the reference transparently. With the handful of roles
+             * that real-world relations use, this shrinks large member
+             * lists considerably.
+             *
+             * Must be called before adding the first member.
+             */
+            void intern_roles() noexcept {
+                m_intern_roles = true;
+            }
+
             /**
              * Add a member to the relation.
              *
@@ -385,7 +491,11 @@ namespace osmium {
                 Builder(buffer, parent, sizeof(T) + min_size_for_user) {
                 new (&item()) T{};
                 add_size(min_size_for_user);
+#ifdef OSMIUM_TRUSTED_BUILDERS
+                object().data()[sizeof(T) + sizeof(string_size_type)] = '\0';
+#else
                 std::memset(object().data() + sizeof(T), 0, min_size_for_user);
+#endif
                 set_user_size(1);
             }
 
@@ -424,10 +534,17 @@ namespace osmium {
                 constexpr const auto available_space = min_size_for_user - sizeof(string_size_type) - 1;
                 if (length > available_space) {
                     const auto space_needed = osmium::memory::padded_length(length - available_space);
+#ifdef OSMIUM_TRUSTED_BUILDERS
+                    reserve_space(space_needed);
+#else
                     std::memset(reserve_space(space_needed), 0, space_needed);
+#endif
                     add_size(static_cast<uint32_t>(space_needed));
                 }
                 std::memcpy(object().data() + size_of_object, user, length);
+#ifdef OSMIUM_TRUSTED_BUILDERS
+                object().data()[size_of_object + length] = '\0';
+#endif
                 set_user_size(length + 1);
 
                 return static_cast<TDerived&>(*this);
@@ -458,6 +575,14 @@ namespace osmium {
                 return set_user(user.data(), static_cast<string_size_type>(user.size()));
             }
 
+            /**
+             * Set user name from another object. Uses the length stored
+             * in the source object, so no strlen() is needed.
+             */
+            TDerived& set_user(const osmium::OSMObject& source) {
+                return set_user(source.user(), static_cast<string_size_type>(source.user_size() - 1));
+            }
+
             OSMIUM_FORWARD(set_id)
             OSMIUM_FORWARD(set_visible)
             OSMIUM_FORWARD(set_deleted)
@@ -496,6 +621,37 @@ namespace osmium {
 
         }; // class NodeBuilder
 
+        class SlimNodeBuilder : public Builder {
+
+            using type = SlimNodeBuilder;
+
+        public:
+
+            explicit SlimNodeBuilder(osmium::memory::Buffer& buffer, Builder* parent = nullptr) :
+                Builder(buffer, parent, sizeof(SlimNode)) {
+                new (&item()) SlimNode{};
+            }
+
+            explicit SlimNodeBuilder(Builder& parent) :
+                Builder(parent.buffer(), &parent, sizeof(SlimNode)) {
+                new (&item()) SlimNode{};
+            }
+
+            /**
+             * Get a reference to the slim node being built.
+             *
+             * Note that this reference will be invalidated every time the
+             * buffer grows.
+             */
+            SlimNode& object() noexcept {
+                return static_cast<SlimNode&>(item());
+            }
+
+            OSMIUM_FORWARD(set_id)
+            OSMIUM_FORWARD(set_location)
+
+        }; // class SlimNodeBuilder
+
         class WayBuilder : public OSMObjectBuilder<WayBuilder, Way> {
 
             using type = WayBuilder;
@@ -559,7 +715,7 @@ namespace osmium {
                 set_timestamp(source.timestamp());
                 set_visible(source.visible());
                 set_uid(source.uid());
-                set_user(source.user());
+                set_user(source);
             }
 
         }; // class AreaBuilder
@@ -576,7 +732,11 @@ namespace osmium {
                 Builder(buffer, parent, sizeof(Changeset) + min_size_for_user) {
                 new (&item()) Changeset{};
                 add_size(min_size_for_user);
+#ifdef OSMIUM_TRUSTED_BUILDERS
+                object().data()[sizeof(Changeset)] = '\0';
+#else
                 std::memset(object().data() + sizeof(Changeset), 0, min_size_for_user);
+#endif
                 object().set_user_size(1);
             }
 
@@ -629,10 +789,17 @@ namespace osmium {
                 constexpr const auto available_space = min_size_for_user - 1;
                 if (length > available_space) {
                     const auto space_needed = osmium::memory::padded_length(length - available_space);
+#ifdef OSMIUM_TRUSTED_BUILDERS
+                    reserve_space(space_needed);
+#else
                     std::memset(reserve_space(space_needed), 0, space_needed);
+#endif
                     add_size(static_cast<uint32_t>(space_needed));
                 }
                 std::memcpy(object().data() + sizeof(Changeset), user, length);
+#ifdef OSMIUM_TRUSTED_BUILDERS
+                object().data()[sizeof(Changeset) + length] = '\0';
+#endif
                 object().set_user_size(length + 1);
 
                 return *this;
@@ -667,6 +834,20 @@ namespace osmium {
 
 #undef OSMIUM_FORWARD
 
+        /**
+         * Create a slim node (id and location only) in the buffer and
+         * commit the buffer.
+         *
+         * @returns The position in the buffer where the slim node starts.
+         */
+        inline std::size_t add_slim_node(osmium::memory::Buffer& buffer, osmium::object_id_type id, const osmium::Location& location) {
+            {
+                SlimNodeBuilder builder{buffer};
+                builder.set_id(id).set_location(location);
+            }
+            return buffer.commit();
+        }
+
     } // namespace builder
 
 } // namespace osmium
@@ -0,0 +1,336 @@
+#ifndef OSMIUM_EXTERNAL_SORT_HPP
+#define OSMIUM_EXTERNAL_SORT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/object_pointer_collection.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/object_comparisons.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/visitor.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Sorts OSM objects that do not fit into memory. Unlike
+     * osmium::ObjectPointerCollection, which needs all buffers resident
+     * before its sort() is called, this class holds only a bounded
+     * amount of buffer data: whenever the configured memory limit is
+     * reached, the objects collected so far are sorted and spilled to
+     * an (automatically removed) temporary file as one sorted run.
+     * sort() then merges all runs and hands the objects to an output
+     * iterator in sorted order, reading only one block per run at a
+     * time.
+     *
+     * @code
+     * osmium::ExternalSorter<> sorter{max_memory_bytes};
+     * while (osmium::memory::Buffer buffer = reader.read()) {
+     *     sorter.add(std::move(buffer));
+     * }
+     * sorter.sort(osmium::io::make_output_iterator(writer));
+     * @endcode
+     *
+     * The comparator defaults to osmium::object_order_type_id_version.
+     * The objects are written to the temporary files in the
+     * host-specific buffer format, so the runs can not be moved between
+     * machines, which does not matter for files that are removed on
+     * close anyway.
+     */
+    template <typename TCompare = osmium::object_order_type_id_version>
+    class ExternalSorter {
+
+        enum : std::size_t {
+            /// Default memory limit: 1 GByte of buffer data.
+            default_max_memory = 1024UL * 1024UL * 1024UL,
+
+            /// Write and read the runs in blocks of this size.
+            block_size = 1024UL * 1024UL
+        };
+
+        /**
+         * Reads one sorted run back, block by block. Only complete
+         * objects go into the current buffer, the bytes of an object
+         * straddling a block boundary are carried over into the next
+         * block.
+         */
+        class run_reader {
+
+            int m_fd;
+            osmium::memory::Buffer m_buffer{};
+            std::string m_partial{};
+            std::size_t m_pos = 0;
+
+            /// Read the next block. Returns false when the run is exhausted.
+            bool fill() {
+                std::size_t capacity = block_size;
+                while (true) {
+                    std::unique_ptr<unsigned char[]> data{new unsigned char[capacity]};
+                    std::size_t have = m_partial.size();
+                    std::memcpy(data.get(), m_partial.data(), have);
+
+                    while (have < capacity) {
+                        const auto nread = osmium::io::detail::reliable_read(m_fd, reinterpret_cast<char*>(data.get()) + have, static_cast<unsigned int>(capacity - have));
+                        if (nread == 0) {
+                            break;
+                        }
+                        have += static_cast<std::size_t>(nread);
+                    }
+
+                    if (have == 0) {
+                        return false;
+                    }
+
+                    std::size_t complete = 0;
+                    while (complete + sizeof(osmium::memory::Item) <= have) {
+                        const auto* item = reinterpret_cast<const osmium::memory::Item*>(data.get() + complete);
+                        if (complete + item->padded_size() > have) {
+                            break;
+                        }
+                        complete += item->padded_size();
+                    }
+
+                    if (complete == 0) {
+                        // a single object larger than the block,
+                        // try again with a bigger one
+                        m_partial.assign(reinterpret_cast<const char*>(data.get()), have);
+                        capacity *= 2;
+                        continue;
+                    }
+
+                    m_partial.assign(reinterpret_cast<const char*>(data.get()) + complete, have - complete);
+                    m_buffer = osmium::memory::Buffer{std::move(data), capacity, complete};
+                    m_pos = 0;
+                    return true;
+                }
+            }
+
+        public:
+
+            explicit run_reader(const int fd) :
+                m_fd(fd) {
+                fill();
+            }
+
+            /// Is there a current object?
+            bool valid() const noexcept {
+                return m_buffer && m_pos < m_buffer.committed();
+            }
+
+            const osmium::OSMObject& current() const {
+                return m_buffer.get<osmium::OSMObject>(m_pos);
+            }
+
+            /// Advance to the next object. Returns false at the end of the run.
+            bool advance() {
+                m_pos += current().padded_size();
+                if (m_pos < m_buffer.committed()) {
+                    return true;
+                }
+                m_buffer = osmium::memory::Buffer{};
+                return fill();
+            }
+
+        }; // class run_reader
+
+        std::vector<osmium::memory::Buffer> m_buffers{};
+        std::vector<int> m_run_fds{};
+        std::size_t m_max_memory;
+        std::size_t m_memory_used = 0;
+
+        /// Sort the buffers collected so far and write them out as one run.
+        void spill() {
+            if (m_buffers.empty()) {
+                return;
+            }
+
+            osmium::ObjectPointerCollection objects;
+            for (auto& buffer : m_buffers) {
+                osmium::apply(buffer, objects);
+            }
+            objects.sort(TCompare{});
+
+            const int fd = osmium::detail::create_tmp_file();
+            std::string block;
+            block.reserve(block_size);
+            for (const osmium::OSMObject& object : objects) {
+                block.append(reinterpret_cast<const char*>(&object), object.padded_size());
+                if (block.size() >= block_size) {
+                    osmium::io::detail::reliable_write(fd, block.data(), block.size());
+                    block.clear();
+                }
+            }
+            osmium::io::detail::reliable_write(fd, block.data(), block.size());
+
+            m_run_fds.push_back(fd);
+            m_buffers.clear();
+            m_memory_used = 0;
+        }
+
+        template <typename TOutputIterator>
+        void merge_runs(TOutputIterator& out) {
+            std::vector<run_reader> readers;
+            readers.reserve(m_run_fds.size());
+            for (const int fd : m_run_fds) {
+                osmium::file_seek(fd, 0);
+                readers.emplace_back(fd);
+            }
+
+            const TCompare compare{};
+            const auto heap_compare = [&readers, &compare](const std::size_t lhs, const std::size_t rhs) {
+                // std heaps are max-heaps, reverse for smallest-first
+                return compare(readers[rhs].current(), readers[lhs].current());
+            };
+
+            std::vector<std::size_t> heap;
+            heap.reserve(readers.size());
+            for (std::size_t i = 0; i < readers.size(); ++i) {
+                if (readers[i].valid()) {
+                    heap.push_back(i);
+                }
+            }
+            std::make_heap(heap.begin(), heap.end(), heap_compare);
+
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), heap_compare);
+                const std::size_t index = heap.back();
+                *out++ = readers[index].current();
+                if (readers[index].advance()) {
+                    std::push_heap(heap.begin(), heap.end(), heap_compare);
+                } else {
+                    heap.pop_back();
+                }
+            }
+        }
+
+    public:
+
+        /**
+         * Create an ExternalSorter.
+         *
+         * @param max_memory Maximum number of bytes of buffer data held
+         *                   in memory before a sorted run is spilled to
+         *                   a temporary file. The merge phase needs one
+         *                   block of about a megabyte per run on top of
+         *                   that.
+         */
+        explicit ExternalSorter(const std::size_t max_memory = default_max_memory) :
+            m_max_memory(max_memory) {
+        }
+
+        ExternalSorter(const ExternalSorter&) = delete;
+        ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+        ExternalSorter(ExternalSorter&&) = delete;
+        ExternalSorter& operator=(ExternalSorter&&) = delete;
+
+        ~ExternalSorter() noexcept {
+            for (const int fd : m_run_fds) {
+                try {
+                    osmium::io::detail::reliable_close(fd);
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+        }
+
+        /**
+         * Add a buffer of objects to be sorted. The buffer is moved into
+         * the sorter. If this brings the held memory over the limit, the
+         * objects collected so far are spilled to a temporary file.
+         */
+        void add(osmium::memory::Buffer&& buffer) {
+            if (!buffer || buffer.committed() == 0) {
+                return;
+            }
+            m_memory_used += buffer.capacity();
+            m_buffers.push_back(std::move(buffer));
+            if (m_memory_used >= m_max_memory) {
+                spill();
+            }
+        }
+
+        /// Number of sorted runs spilled to temporary files so far.
+        std::size_t runs() const noexcept {
+            return m_run_fds.size();
+        }
+
+        /**
+         * Sort all objects added so far and write them to the output
+         * iterator in the order given by the comparator. If everything
+         * fits into memory this is a plain in-memory sort, otherwise
+         * the spilled runs are k-way merged. Call this only once, the
+         * sorter is empty afterwards.
+         */
+        template <typename TOutputIterator>
+        void sort(TOutputIterator out) {
+            if (m_run_fds.empty()) {
+                // everything fits into memory
+                osmium::ObjectPointerCollection objects;
+                for (auto& buffer : m_buffers) {
+                    osmium::apply(buffer, objects);
+                }
+                objects.sort(TCompare{});
+                for (const osmium::OSMObject& object : objects) {
+                    *out++ = object;
+                }
+                m_buffers.clear();
+                m_memory_used = 0;
+                return;
+            }
+
+            spill();
+            merge_runs(out);
+
+            for (const int fd : m_run_fds) {
+                osmium::io::detail::reliable_close(fd);
+            }
+            m_run_fds.clear();
+        }
+
+    }; // class ExternalSorter
+
+} // namespace osmium
+
+#endif // OSMIUM_EXTERNAL_SORT_HPP
@@ -59,10 +59,12 @@ namespace osmium {
     class Relation;
     class RelationMemberList;
     class Segment;
+    class SlimNode;
     class Tag;
     class TagList;
     class Timestamp;
     class Way;
+    class WayEnvelope;
     class WayNodeList;
 
 } // namespace osmium
@@ -46,10 +46,13 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/way.hpp>
 #include <osmium/util/compatibility.hpp>
 
+#include <cassert>
 #include <cstddef>
+#include <iterator>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -132,6 +135,15 @@ namespace osmium {
                 return Coordinates{location.lon(), location.lat()};
             }
 
+            /**
+             * Overload for coordinates that have already been converted
+             * from a Location. Used by the trusted fast paths of the
+             * GeometryFactory.
+             */
+            Coordinates operator()(const Coordinates& coordinates) const noexcept {
+                return coordinates;
+            }
+
             static int epsg() noexcept {
                 return 4326;
             }
@@ -161,8 +173,108 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Add all points of an outer or inner ring to a multipolygon
+             * without checking the locations for validity. The locations
+             * are converted and projected in bulk and handed to the
+             * geometry implementation as one coordinate run if it has a
+             * multipolygon_add_locations() member function, otherwise one
+             * at a time.
+             *
+             * @pre All locations in the ring must be valid.
+             */
+            void add_points_trusted(const osmium::NodeRefList& nodes) {
+                convert_locations_trusted(nodes.cbegin(), nodes.cend(), use_nodes::unique);
+                project_coordinates(m_projection, m_coordinates.data(), m_coordinates.size(), 0);
+                add_ring_coordinates(m_impl, m_coordinates.data(), m_coordinates.size(), 0);
+            }
+
+            /**
+             * Convert the locations in the given range into coordinates
+             * without checking them for validity and store them in
+             * m_coordinates. With use_nodes::unique consecutive nodes
+             * with the same location are dropped by always writing the
+             * coordinates and only conditionally advancing the output
+             * pointer, so there is no branch per node.
+             */
+            template <typename TIter>
+            void convert_locations_trusted(TIter it, TIter end, use_nodes un) {
+                m_coordinates.clear();
+                m_coordinates.resize(static_cast<std::size_t>(std::distance(it, end)));
+                Coordinates* out = m_coordinates.data();
+
+                if (un == use_nodes::unique) {
+                    osmium::Location last_location;
+                    for (; it != end; ++it) {
+                        const osmium::Location location = it->location();
+                        assert(location.valid());
+                        *out = Coordinates{location.lon_without_check(), location.lat_without_check()};
+                        out += static_cast<std::size_t>(location != last_location);
+                        last_location = location;
+                    }
+                } else {
+                    for (; it != end; ++it, ++out) {
+                        const osmium::Location location = it->location();
+                        assert(location.valid());
+                        *out = Coordinates{location.lon_without_check(), location.lat_without_check()};
+                    }
+                }
+
+                m_coordinates.resize(static_cast<std::size_t>(out - m_coordinates.data()));
+            }
+
+            /**
+             * Project an array of coordinates in place. Uses the batch
+             * interface of the projection if there is one, otherwise the
+             * coordinates are projected one at a time.
+             */
+            template <typename TProj>
+            static auto project_coordinates(const TProj& projection, Coordinates* coordinates, std::size_t count, int) -> decltype(projection(coordinates, count), void()) {
+                projection(coordinates, count);
+            }
+
+            template <typename TProj>
+            static void project_coordinates(const TProj& projection, Coordinates* coordinates, std::size_t count, long) { // NOLINT(google-runtime-int)
+                for (std::size_t n = 0; n < count; ++n) {
+                    coordinates[n] = projection(coordinates[n]);
+                }
+            }
+
+            /**
+             * Tell the geometry implementation how large the multipolygon
+             * will be if it has a multipolygon_reserve() member function,
+             * do nothing otherwise.
+             */
+            template <typename TImpl>
+            static auto reserve_multipolygon(TImpl& impl, std::size_t num_polygons, std::size_t num_rings, std::size_t num_points, int) -> decltype(impl.multipolygon_reserve(num_polygons, num_rings, num_points), void()) {
+                impl.multipolygon_reserve(num_polygons, num_rings, num_points);
+            }
+
+            template <typename TImpl>
+            static void reserve_multipolygon(TImpl& /*impl*/, std::size_t /*num_polygons*/, std::size_t /*num_rings*/, std::size_t /*num_points*/, long) { // NOLINT(google-runtime-int)
+            }
+
+            /**
+             * Add a run of coordinates to the current multipolygon ring,
+             * in one go if the geometry implementation has a
+             * multipolygon_add_locations() member function, otherwise one
+             * coordinate at a time.
+             */
+            template <typename TImpl>
+            static auto add_ring_coordinates(TImpl& impl, const Coordinates* coordinates, std::size_t count, int) -> decltype(impl.multipolygon_add_locations(coordinates, count), void()) {
+                impl.multipolygon_add_locations(coordinates, count);
+            }
+
+            template <typename TImpl>
+            static void add_ring_coordinates(TImpl& impl, const Coordinates* coordinates, std::size_t count, long) { // NOLINT(google-runtime-int)
+                for (std::size_t n = 0; n < count; ++n) {
+                    impl.multipolygon_add_location(coordinates[n]);
+                }
+            }
+
             TProjection m_projection;
             TGeomImpl m_impl;
+            std::vector<Coordinates> m_coordinates{};
 
         public:
 
@@ -303,6 +415,56 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Create a linestring without checking the locations for
+             * validity.
+             *
+             * This is a fast path for the case where the caller can
+             * guarantee that all locations in the way node list are valid,
+             * for instance because they were set by a NodeLocationsForWays
+             * handler that was not told to ignore errors. The locations
+             * of the packed NodeRef array are converted in bulk, which
+             * allows projections with a batch interface (such as the
+             * MercatorProjection) to convert several coordinates at once,
+             * and the unique-locations filter runs without a branch per
+             * node.
+             *
+             * The projection must also be callable with a Coordinates
+             * argument. The IdentityProjection and the MercatorProjection
+             * are.
+             *
+             * @pre All locations in the way node list must be valid.
+             */
+            linestring_type create_linestring_trusted(const osmium::WayNodeList& wnl, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
+                if (dir == direction::forward) {
+                    convert_locations_trusted(wnl.cbegin(), wnl.cend(), un);
+                } else {
+                    convert_locations_trusted(wnl.crbegin(), wnl.crend(), un);
+                }
+
+                if (m_coordinates.size() < 2) {
+                    throw osmium::geometry_error{"need at least two points for linestring"};
+                }
+
+                project_coordinates(m_projection, m_coordinates.data(), m_coordinates.size(), 0);
+
+                linestring_start();
+                for (const auto& coordinates : m_coordinates) {
+                    m_impl.linestring_add_location(coordinates);
+                }
+                return linestring_finish(m_coordinates.size());
+            }
+
+            /// @copydoc create_linestring_trusted(const osmium::WayNodeList&, use_nodes, direction)
+            linestring_type create_linestring_trusted(const osmium::Way& way, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
+                try {
+                    return create_linestring_trusted(way.nodes(), un, dir);
+                } catch (osmium::geometry_error& e) {
+                    e.set_id("way", way.id());
+                    throw;
+                }
+            }
+
             /* Polygon */
 
             void polygon_start() {
@@ -418,6 +580,79 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Create a multipolygon without checking the locations for
+             * validity.
+             *
+             * This is a fast path for the case where the caller can
+             * guarantee that all locations in the area's rings are valid.
+             * The number of polygons, rings, and points is counted up
+             * front and handed to the geometry implementation so it can
+             * reserve the complete output in one allocation (the
+             * WKBFactoryImpl does). The locations of each ring are
+             * converted and projected in bulk as for
+             * create_linestring_trusted() and appended as one coordinate
+             * run per ring.
+             *
+             * The projection must also be callable with a Coordinates
+             * argument. The IdentityProjection and the MercatorProjection
+             * are.
+             *
+             * @pre All locations in the area's rings must be valid.
+             */
+            multipolygon_type create_multipolygon_trusted(const osmium::Area& area) {
+                try {
+                    std::size_t num_polygons = 0;
+                    std::size_t num_rings = 0;
+                    std::size_t num_points = 0;
+
+                    for (const auto& item : area) {
+                        if (item.type() == osmium::item_type::outer_ring) {
+                            ++num_polygons;
+                            ++num_rings;
+                            num_points += static_cast<const osmium::OuterRing&>(item).size();
+                        } else if (item.type() == osmium::item_type::inner_ring) {
+                            ++num_rings;
+                            num_points += static_cast<const osmium::InnerRing&>(item).size();
+                        }
+                    }
+
+                    // if there are no rings, this area is invalid
+                    if (num_rings == 0) {
+                        throw osmium::geometry_error{"invalid area"};
+                    }
+
+                    m_impl.multipolygon_start();
+                    reserve_multipolygon(m_impl, num_polygons, num_rings, num_points, 0);
+
+                    bool in_polygon = false;
+                    for (const auto& item : area) {
+                        if (item.type() == osmium::item_type::outer_ring) {
+                            const auto& ring = static_cast<const osmium::OuterRing&>(item);
+                            if (in_polygon) {
+                                m_impl.multipolygon_polygon_finish();
+                            }
+                            in_polygon = true;
+                            m_impl.multipolygon_polygon_start();
+                            m_impl.multipolygon_outer_ring_start();
+                            add_points_trusted(ring);
+                            m_impl.multipolygon_outer_ring_finish();
+                        } else if (item.type() == osmium::item_type::inner_ring) {
+                            const auto& ring = static_cast<const osmium::InnerRing&>(item);
+                            m_impl.multipolygon_inner_ring_start();
+                            add_points_trusted(ring);
+                            m_impl.multipolygon_inner_ring_finish();
+                        }
+                    }
+
+                    m_impl.multipolygon_polygon_finish();
+                    return m_impl.multipolygon_finish();
+                } catch (osmium::geometry_error& e) {
+                    e.set_id("area", area.id());
+                    throw;
+                }
+            }
+
         }; // class GeometryFactory
 
     } // namespace geom
@@ -0,0 +1,339 @@
+#ifndef OSMIUM_GEOM_GEOS_C_HPP
+#define OSMIUM_GEOM_GEOS_C_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * This file contains code for conversion of OSM geometries into GEOS
+ * geometries using the stable GEOS C API. Unlike the deprecated
+ * osmium/geom/geos.hpp, which uses the internal GEOS C++ API and only
+ * works up to GEOS 3.5, this works with all current GEOS versions.
+ *
+ * Coordinates are collected into a plain array and handed to GEOS in
+ * one bulk call per (line)string or ring, with newer GEOS versions this
+ * is a single memcpy inside GEOS.
+ *
+ * @attention If you include this file, you'll need to link with
+ *            `libgeos_c`.
+ */
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/factory.hpp>
+
+#include <geos_c.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Thrown when a GEOS C API function reports failure.
+     */
+    struct geos_c_geometry_error : public geometry_error {
+
+        explicit geos_c_geometry_error(const char* message) :
+            geometry_error(std::string{"geometry creation failed in GEOS library: "} + message) {
+        }
+
+    }; // struct geos_c_geometry_error
+
+    namespace geom {
+
+        /**
+         * Deleter for GEOS geometries created through a specific GEOS
+         * context. Used in the unique_ptrs returned from GEOSCFactory.
+         */
+        class GEOSCGeometryDeleter {
+
+            GEOSContextHandle_t m_context = nullptr;
+
+        public:
+
+            GEOSCGeometryDeleter() noexcept = default;
+
+            explicit GEOSCGeometryDeleter(GEOSContextHandle_t context) noexcept :
+                m_context(context) {
+            }
+
+            void operator()(GEOSGeometry* geometry) const noexcept {
+                if (geometry && m_context) {
+                    GEOSGeom_destroy_r(m_context, geometry);
+                }
+            }
+
+        }; // class GEOSCGeometryDeleter
+
+        /// A GEOS geometry with the deleter that knows its context.
+        using geos_c_geometry_type = std::unique_ptr<GEOSGeometry, GEOSCGeometryDeleter>;
+
+        namespace detail {
+
+            class GEOSCFactoryImpl {
+
+                GEOSContextHandle_t m_our_context = nullptr;
+                GEOSContextHandle_t m_context;
+                int m_srid;
+
+                // Interleaved x/y coordinates of the current (line)string
+                // or ring. Collected here and handed to GEOS in one bulk
+                // call instead of one call per point.
+                std::vector<double> m_coordinates{};
+
+                std::vector<GEOSGeometry*> m_rings{};
+                std::vector<GEOSGeometry*> m_polygons{};
+
+                static void destroy_all(GEOSContextHandle_t context, std::vector<GEOSGeometry*>& geometries) noexcept {
+                    for (auto* geometry : geometries) {
+                        GEOSGeom_destroy_r(context, geometry);
+                    }
+                    geometries.clear();
+                }
+
+                /**
+                 * Create a GEOS coordinate sequence from the collected
+                 * coordinates in one go.
+                 */
+                GEOSCoordSequence* create_coord_seq() {
+                    const auto num = static_cast<unsigned int>(m_coordinates.size() / 2);
+#if GEOS_VERSION_MAJOR > 3 || (GEOS_VERSION_MAJOR == 3 && GEOS_VERSION_MINOR >= 10)
+                    GEOSCoordSequence* sequence = GEOSCoordSeq_copyFromBuffer_r(m_context, m_coordinates.data(), num, 0, 0);
+                    if (!sequence) {
+                        throw osmium::geos_c_geometry_error{"creating coordinate sequence failed"};
+                    }
+#else
+                    GEOSCoordSequence* sequence = GEOSCoordSeq_create_r(m_context, num, 2);
+                    if (!sequence) {
+                        throw osmium::geos_c_geometry_error{"creating coordinate sequence failed"};
+                    }
+                    for (unsigned int i = 0; i < num; ++i) {
+# if GEOS_VERSION_MAJOR > 3 || (GEOS_VERSION_MAJOR == 3 && GEOS_VERSION_MINOR >= 8)
+                        GEOSCoordSeq_setXY_r(m_context, sequence, i, m_coordinates[i * 2], m_coordinates[i * 2 + 1]);
+# else
+                        GEOSCoordSeq_setX_r(m_context, sequence, i, m_coordinates[i * 2]);
+                        GEOSCoordSeq_setY_r(m_context, sequence, i, m_coordinates[i * 2 + 1]);
+# endif
+                    }
+#endif
+                    return sequence;
+                }
+
+                geos_c_geometry_type finish_geometry(GEOSGeometry* geometry, const char* message) const {
+                    if (!geometry) {
+                        throw osmium::geos_c_geometry_error{message};
+                    }
+                    GEOSSetSRID_r(m_context, geometry, m_srid);
+                    return geos_c_geometry_type{geometry, GEOSCGeometryDeleter{m_context}};
+                }
+
+            public:
+
+                using point_type        = geos_c_geometry_type;
+                using linestring_type   = geos_c_geometry_type;
+                using polygon_type      = geos_c_geometry_type;
+                using multipolygon_type = geos_c_geometry_type;
+                using ring_type         = geos_c_geometry_type;
+
+                /**
+                 * Constructor creating its own GEOS context.
+                 */
+                explicit GEOSCFactoryImpl(int srid) :
+                    m_our_context(GEOS_init_r()),
+                    m_context(m_our_context),
+                    m_srid(srid) {
+                }
+
+                /**
+                 * Constructor using the given GEOS context. The context
+                 * must stay valid as long as this factory and all the
+                 * geometries created with it are in use.
+                 */
+                explicit GEOSCFactoryImpl(int srid, GEOSContextHandle_t context) :
+                    m_context(context),
+                    m_srid(srid) {
+                }
+
+                GEOSCFactoryImpl(const GEOSCFactoryImpl&) = delete;
+                GEOSCFactoryImpl& operator=(const GEOSCFactoryImpl&) = delete;
+
+                GEOSCFactoryImpl(GEOSCFactoryImpl&&) = delete;
+                GEOSCFactoryImpl& operator=(GEOSCFactoryImpl&&) = delete;
+
+                ~GEOSCFactoryImpl() noexcept {
+                    destroy_all(m_context, m_rings);
+                    destroy_all(m_context, m_polygons);
+                    if (m_our_context) {
+                        GEOS_finish_r(m_our_context);
+                    }
+                }
+
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    GEOSCoordSequence* sequence = GEOSCoordSeq_create_r(m_context, 1, 2);
+                    if (!sequence) {
+                        throw osmium::geos_c_geometry_error{"creating coordinate sequence failed"};
+                    }
+#if GEOS_VERSION_MAJOR > 3 || (GEOS_VERSION_MAJOR == 3 && GEOS_VERSION_MINOR >= 8)
+                    GEOSCoordSeq_setXY_r(m_context, sequence, 0, xy.x, xy.y);
+#else
+                    GEOSCoordSeq_setX_r(m_context, sequence, 0, xy.x);
+                    GEOSCoordSeq_setY_r(m_context, sequence, 0, xy.y);
+#endif
+                    return finish_geometry(GEOSGeom_createPoint_r(m_context, sequence),
+                                           "creating point failed");
+                }
+
+                /* LineString */
+
+                void linestring_start() {
+                    m_coordinates.clear();
+                }
+
+                void linestring_add_location(const osmium::geom::Coordinates& xy) {
+                    m_coordinates.push_back(xy.x);
+                    m_coordinates.push_back(xy.y);
+                }
+
+                linestring_type linestring_finish(std::size_t /*num_points*/) {
+                    return finish_geometry(GEOSGeom_createLineString_r(m_context, create_coord_seq()),
+                                           "creating linestring failed");
+                }
+
+                /* Polygon */
+
+                void polygon_start() {
+                    m_coordinates.clear();
+                }
+
+                void polygon_add_location(const osmium::geom::Coordinates& xy) {
+                    m_coordinates.push_back(xy.x);
+                    m_coordinates.push_back(xy.y);
+                }
+
+                polygon_type polygon_finish(std::size_t /*num_points*/) {
+                    GEOSGeometry* shell = GEOSGeom_createLinearRing_r(m_context, create_coord_seq());
+                    if (!shell) {
+                        throw osmium::geos_c_geometry_error{"creating linear ring failed"};
+                    }
+                    return finish_geometry(GEOSGeom_createPolygon_r(m_context, shell, nullptr, 0),
+                                           "creating polygon failed");
+                }
+
+                /* MultiPolygon */
+
+                void multipolygon_start() {
+                    destroy_all(m_context, m_rings);
+                    destroy_all(m_context, m_polygons);
+                }
+
+                void multipolygon_polygon_start() {
+                    destroy_all(m_context, m_rings);
+                }
+
+                void multipolygon_polygon_finish() {
+                    GEOSGeometry* polygon = GEOSGeom_createPolygon_r(m_context,
+                                                                     m_rings.front(),
+                                                                     m_rings.data() + 1,
+                                                                     static_cast<unsigned int>(m_rings.size() - 1));
+                    // createPolygon took ownership of the rings whether it
+                    // succeeded or not
+                    m_rings.clear();
+                    if (!polygon) {
+                        throw osmium::geos_c_geometry_error{"creating polygon failed"};
+                    }
+                    m_polygons.push_back(polygon);
+                }
+
+                void multipolygon_outer_ring_start() {
+                    m_coordinates.clear();
+                }
+
+                void multipolygon_outer_ring_finish() {
+                    GEOSGeometry* ring = GEOSGeom_createLinearRing_r(m_context, create_coord_seq());
+                    if (!ring) {
+                        throw osmium::geos_c_geometry_error{"creating linear ring failed"};
+                    }
+                    m_rings.push_back(ring);
+                }
+
+                void multipolygon_inner_ring_start() {
+                    m_coordinates.clear();
+                }
+
+                void multipolygon_inner_ring_finish() {
+                    GEOSGeometry* ring = GEOSGeom_createLinearRing_r(m_context, create_coord_seq());
+                    if (!ring) {
+                        throw osmium::geos_c_geometry_error{"creating linear ring failed"};
+                    }
+                    m_rings.push_back(ring);
+                }
+
+                void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
+                    m_coordinates.push_back(xy.x);
+                    m_coordinates.push_back(xy.y);
+                }
+
+                multipolygon_type multipolygon_finish() {
+                    GEOSGeometry* multipolygon = GEOSGeom_createCollection_r(m_context,
+                                                                             GEOS_MULTIPOLYGON,
+                                                                             m_polygons.data(),
+                                                                             static_cast<unsigned int>(m_polygons.size()));
+                    // createCollection took ownership of the polygons
+                    // whether it succeeded or not
+                    m_polygons.clear();
+                    return finish_geometry(multipolygon, "creating multipolygon failed");
+                }
+
+            }; // class GEOSCFactoryImpl
+
+        } // namespace detail
+
+        /**
+         * Geometry factory building GEOS geometries through the stable
+         * GEOS C API. Use this instead of the deprecated GEOSFactory.
+         * The create_* functions return GEOS geometries wrapped in a
+         * unique_ptr that knows how to destroy them.
+         */
+        template <typename TProjection = IdentityProjection>
+        using GEOSCFactory = GeometryFactory<osmium::geom::detail::GEOSCFactoryImpl, TProjection>;
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_GEOS_C_HPP
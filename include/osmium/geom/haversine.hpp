@@ -102,6 +102,67 @@ namespace osmium {
                 return sum_length;
             }
 
+            /**
+             * Calculate the approximate distance in meters between two
+             * sets of coordinates.
+             *
+             * This uses the equirectangular approximation which needs
+             * only one trigonometric function call instead of the five
+             * the haversine formula needs. For the distances between
+             * consecutive way nodes typically found in OSM data the
+             * relative error is far below 0.01%. Coordinates that are
+             * too far apart for the approximation to hold fall back to
+             * the exact haversine formula.
+             *
+             * @pre @code c1.valid() && c2.valid() @endcode
+             */
+            inline double distance_fast(const osmium::geom::Coordinates& c1, const osmium::geom::Coordinates& c2) noexcept {
+                // Above this distance (in degrees, about 55km) the
+                // approximation error grows, use the exact formula.
+                constexpr const double max_span = 0.5;
+
+                if (std::fabs(c1.x - c2.x) > max_span || std::fabs(c1.y - c2.y) > max_span) {
+                    return distance(c1, c2);
+                }
+
+                const double x = deg_to_rad(c1.x - c2.x) * std::cos(deg_to_rad((c1.y + c2.y) * 0.5));
+                const double y = deg_to_rad(c1.y - c2.y);
+                return EARTH_RADIUS_IN_METERS * std::sqrt(x * x + y * y);
+            }
+
+            /**
+             * Calculate approximate length of way. See the coordinate
+             * version of distance_fast() for the accuracy trade-off.
+             */
+            inline double distance_fast(const osmium::WayNodeList& wnl) {
+                double sum_length = 0;
+
+                for (const auto* it = wnl.begin(); it != wnl.end(); ++it) {
+                    if (std::next(it) != wnl.end()) {
+                        sum_length += distance_fast(it->location(), std::next(it)->location());
+                    }
+                }
+
+                return sum_length;
+            }
+
+            /**
+             * Calculate approximate length of node list. See the
+             * coordinate version of distance_fast() for the accuracy
+             * trade-off.
+             */
+            inline double distance_fast(const osmium::NodeRefList& nrl) {
+                double sum_length = 0;
+
+                for (const auto* it = nrl.begin(); it != nrl.end(); ++it) {
+                    if (std::next(it) != nrl.end()) {
+                        sum_length += distance_fast(it->location(), std::next(it)->location());
+                    }
+                }
+
+                return sum_length;
+            }
+
         } // namespace haversine
 
     } // namespace geom
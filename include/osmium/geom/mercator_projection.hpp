@@ -38,8 +38,19 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/location.hpp>
 
 #include <cmath>
+#include <cstddef>
 #include <string>
 
+#ifndef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
+# if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define OSMIUM_MERCATOR_X86
+#  include <immintrin.h>
+# elif defined(__aarch64__) && defined(__ARM_NEON)
+#  define OSMIUM_MERCATOR_NEON
+#  include <arm_neon.h>
+# endif
+#endif
+
 namespace osmium {
 
     namespace geom {
@@ -94,6 +105,168 @@ namespace osmium {
                               -3.4554675198786337842e-4)  * lat +
                               -5.4367203601085991108e-4)  * lat + 1.0);
             }
+#endif
+
+            inline void lonlat_to_mercator_batch_generic(Coordinates* coordinates, std::size_t count) {
+                for (std::size_t n = 0; n < count; ++n) {
+                    coordinates[n].x = lon_to_x(coordinates[n].x);
+                    coordinates[n].y = lat_to_y(coordinates[n].y);
+                }
+            }
+
+#if defined(OSMIUM_MERCATOR_X86) || defined(OSMIUM_MERCATOR_NEON)
+
+            // The coefficients of the polynomial approximation from
+            // lat_to_y() above, for the vectorized Horner evaluation. The
+            // numerator polynomial is poly(lat) * lat, the denominator
+            // polynomial is poly(lat) * lat + 1.
+            struct lat_to_y_polynomial {
+
+                static const double* num() noexcept {
+                    static const double coefficients[10] = {
+                        -3.1112583378460085319e-23,
+                         2.0465852743943268009e-19,
+                         6.4905282018672673884e-18,
+                        -1.9685447939983315591e-14,
+                        -2.2022588158115104182e-13,
+                         5.1617537365509453239e-10,
+                         2.5380136069803016519e-9,
+                        -5.1448323697228488745e-6,
+                        -9.4888671473357768301e-6,
+                         1.7453292518154191887e-2
+                    };
+                    return coefficients;
+                }
+
+                static const double* den() noexcept {
+                    static const double coefficients[10] = {
+                        -1.9741136066814230637e-22,
+                        -1.258514031244679556e-20,
+                         4.8141483273572351796e-17,
+                         8.6876090870176172185e-16,
+                        -2.3298743439377541768e-12,
+                        -1.9300094785736130185e-11,
+                         4.3251609106864178231e-8,
+                         1.7301944508516974048e-7,
+                        -3.4554675198786337842e-4,
+                        -5.4367203601085991108e-4
+                    };
+                    return coefficients;
+                }
+
+            }; // struct lat_to_y_polynomial
+
+#endif
+
+#ifdef OSMIUM_MERCATOR_X86
+
+            __attribute__((target("avx2,fma")))
+            inline void lonlat_to_mercator_batch_avx2(Coordinates* coordinates, std::size_t count) {
+                const __m256d earth_radius = _mm256_set1_pd(earth_radius_for_epsg3857);
+                const __m256d lon_factor = _mm256_set1_pd(earth_radius_for_epsg3857 * osmium::geom::PI / 180.0);
+                const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+                const __m256d max_lat = _mm256_set1_pd(78.0);
+                const __m256d one = _mm256_set1_pd(1.0);
+
+                std::size_t n = 0;
+                for (; n + 4 <= count; n += 4) {
+                    const __m256d lat = _mm256_set_pd(coordinates[n + 3].y, coordinates[n + 2].y,
+                                                      coordinates[n + 1].y, coordinates[n].y);
+
+                    // Latitudes beyond +-78 degrees are outside the range
+                    // of the polynomial approximation, use the scalar
+                    // implementation for this group of coordinates.
+                    const __m256d out_of_range = _mm256_cmp_pd(_mm256_and_pd(lat, abs_mask), max_lat, _CMP_GT_OQ);
+                    if (_mm256_movemask_pd(out_of_range) != 0) {
+                        lonlat_to_mercator_batch_generic(coordinates + n, 4);
+                        continue;
+                    }
+
+                    const __m256d lon = _mm256_set_pd(coordinates[n + 3].x, coordinates[n + 2].x,
+                                                      coordinates[n + 1].x, coordinates[n].x);
+
+                    __m256d num = _mm256_set1_pd(lat_to_y_polynomial::num()[0]);
+                    __m256d den = _mm256_set1_pd(lat_to_y_polynomial::den()[0]);
+                    for (int i = 1; i < 10; ++i) {
+                        num = _mm256_fmadd_pd(num, lat, _mm256_set1_pd(lat_to_y_polynomial::num()[i]));
+                        den = _mm256_fmadd_pd(den, lat, _mm256_set1_pd(lat_to_y_polynomial::den()[i]));
+                    }
+                    num = _mm256_mul_pd(num, lat);
+                    den = _mm256_fmadd_pd(den, lat, one);
+
+                    const __m256d x = _mm256_mul_pd(lon, lon_factor);
+                    const __m256d y = _mm256_mul_pd(earth_radius, _mm256_div_pd(num, den));
+
+                    double xs[4];
+                    double ys[4];
+                    _mm256_storeu_pd(xs, x);
+                    _mm256_storeu_pd(ys, y);
+                    for (int i = 0; i < 4; ++i) {
+                        coordinates[n + i].x = xs[i];
+                        coordinates[n + i].y = ys[i];
+                    }
+                }
+
+                lonlat_to_mercator_batch_generic(coordinates + n, count - n);
+            }
+
+            inline void lonlat_to_mercator_batch(Coordinates* coordinates, std::size_t count) {
+                using impl_type = void (*)(Coordinates*, std::size_t);
+                // Runtime CPU dispatch, decided once on first use.
+                static const impl_type impl = (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+                                                  ? &lonlat_to_mercator_batch_avx2
+                                                  : &lonlat_to_mercator_batch_generic;
+                impl(coordinates, count);
+            }
+
+#elif defined(OSMIUM_MERCATOR_NEON)
+
+            inline void lonlat_to_mercator_batch(Coordinates* coordinates, std::size_t count) {
+                const float64x2_t earth_radius = vdupq_n_f64(earth_radius_for_epsg3857);
+                const float64x2_t lon_factor = vdupq_n_f64(earth_radius_for_epsg3857 * osmium::geom::PI / 180.0);
+                const float64x2_t max_lat = vdupq_n_f64(78.0);
+                const float64x2_t one = vdupq_n_f64(1.0);
+
+                std::size_t n = 0;
+                for (; n + 2 <= count; n += 2) {
+                    // Loads x into lane 0 and y into lane 1 of two registers.
+                    const float64x2x2_t xy = vld2q_f64(&coordinates[n].x);
+                    const float64x2_t lon = xy.val[0];
+                    const float64x2_t lat = xy.val[1];
+
+                    // Latitudes beyond +-78 degrees are outside the range
+                    // of the polynomial approximation, use the scalar
+                    // implementation for this pair of coordinates.
+                    const uint64x2_t out_of_range = vcgtq_f64(vabsq_f64(lat), max_lat);
+                    if (vgetq_lane_u64(out_of_range, 0) != 0 || vgetq_lane_u64(out_of_range, 1) != 0) {
+                        lonlat_to_mercator_batch_generic(coordinates + n, 2);
+                        continue;
+                    }
+
+                    float64x2_t num = vdupq_n_f64(lat_to_y_polynomial::num()[0]);
+                    float64x2_t den = vdupq_n_f64(lat_to_y_polynomial::den()[0]);
+                    for (int i = 1; i < 10; ++i) {
+                        num = vfmaq_f64(vdupq_n_f64(lat_to_y_polynomial::num()[i]), num, lat);
+                        den = vfmaq_f64(vdupq_n_f64(lat_to_y_polynomial::den()[i]), den, lat);
+                    }
+                    num = vmulq_f64(num, lat);
+                    den = vfmaq_f64(one, den, lat);
+
+                    float64x2x2_t result;
+                    result.val[0] = vmulq_f64(lon, lon_factor);
+                    result.val[1] = vmulq_f64(earth_radius, vdivq_f64(num, den));
+                    vst2q_f64(&coordinates[n].x, result);
+                }
+
+                lonlat_to_mercator_batch_generic(coordinates + n, count - n);
+            }
+
+#else
+
+            inline void lonlat_to_mercator_batch(Coordinates* coordinates, std::size_t count) {
+                lonlat_to_mercator_batch_generic(coordinates, count);
+            }
+
 #endif
 
             constexpr inline double x_to_lon(double x) {
@@ -104,6 +277,77 @@ namespace osmium {
                 return rad_to_deg(2 * std::atan(std::exp(y / earth_radius_for_epsg3857)) - osmium::geom::PI / 2);
             }
 
+            /**
+             * Precomputed table for the inverse projection. Stores the
+             * latitude and its first derivative at evenly spaced sample
+             * points over the whole mercator y range and evaluates the
+             * cubic Hermite interpolant between the two neighbouring
+             * sample points. Because function value and derivative are
+             * exact at the sample points, the interpolation error stays
+             * below one nanodegree everywhere, two orders of magnitude
+             * finer than the 100 nanodegree resolution of a stored
+             * Location. The table needs 64 kB which is built once on
+             * first use.
+             */
+            class y_to_lat_interpolation_table {
+
+                enum : std::size_t {
+                    table_size = 4096
+                };
+
+                double m_lat[table_size + 1];
+                double m_dlat[table_size + 1];
+
+                y_to_lat_interpolation_table() noexcept {
+                    const double step = 2 * max_coordinate_epsg3857 / table_size;
+                    for (std::size_t i = 0; i <= table_size; ++i) {
+                        const double y = -max_coordinate_epsg3857 + static_cast<double>(i) * step;
+                        m_lat[i] = y_to_lat(y);
+                        // d lat(y) / dy == rad_to_deg(1 / (R * cosh(y / R)))
+                        m_dlat[i] = rad_to_deg(1.0 / (earth_radius_for_epsg3857 * std::cosh(y / earth_radius_for_epsg3857)));
+                    }
+                }
+
+            public:
+
+                static const y_to_lat_interpolation_table& instance() {
+                    static const y_to_lat_interpolation_table table;
+                    return table;
+                }
+
+                double operator()(const double y) const noexcept {
+                    if (y < -max_coordinate_epsg3857 || y > max_coordinate_epsg3857) {
+                        return y_to_lat(y);
+                    }
+
+                    const double step = 2 * max_coordinate_epsg3857 / table_size;
+                    double position = (y + max_coordinate_epsg3857) / step;
+                    auto index = static_cast<std::size_t>(position);
+                    if (index >= table_size) {
+                        index = table_size - 1;
+                    }
+                    const double t = position - static_cast<double>(index);
+
+                    // cubic Hermite basis functions
+                    const double t2 = t * t;
+                    const double t3 = t2 * t;
+                    const double h00 =  2 * t3 - 3 * t2 + 1;
+                    const double h10 =      t3 - 2 * t2 + t;
+                    const double h01 = -2 * t3 + 3 * t2;
+                    const double h11 =      t3 -     t2;
+
+                    return h00 * m_lat[index] +
+                           h10 * step * m_dlat[index] +
+                           h01 * m_lat[index + 1] +
+                           h11 * step * m_dlat[index + 1];
+                }
+
+            }; // class y_to_lat_interpolation_table
+
+            inline double y_to_lat_with_table(const double y) {
+                return y_to_lat_interpolation_table::instance()(y);
+            }
+
         } // namespace detail
 
         /**
@@ -124,6 +368,21 @@ namespace osmium {
             return Coordinates{detail::lon_to_x(c.x), detail::lat_to_y(c.y)};
         }
 
+        /**
+         * Convert an array of coordinates from WGS84 lon/lat to web
+         * mercator, in place. This is faster than projecting the
+         * coordinates one at a time, because the polynomial approximation
+         * of the projection is evaluated for several coordinates at once
+         * using SIMD instructions where available.
+         *
+         * @pre All coordinates must be in valid range, longitude between
+         *      -180 and +180 degree, latitude between -MERCATOR_MAX_LAT
+         *      and MERCATOR_MAX_LAT.
+         */
+        inline void lonlat_to_mercator(Coordinates* coordinates, std::size_t count) {
+            detail::lonlat_to_mercator_batch(coordinates, count);
+        }
+
         /**
          * Convert the coordinates from web mercator to WGS84 lon/lat.
          *
@@ -135,12 +394,24 @@ namespace osmium {
             return Coordinates{detail::x_to_lon(c.x), detail::y_to_lat(c.y)};
         }
 
+        /**
+         * Should the inverse projection of a MercatorProjection use the
+         * precomputed interpolation table (faster, maximum error below
+         * one nanodegree) or the exact formula?
+         */
+        enum class inverse_table : bool {
+            no  = false,
+            yes = true
+        }; // enum class inverse_table
+
         /**
          * Functor that does projection from WGS84 (EPSG:4326) to "Web
          * Mercator" (EPSG:3857)
          */
         class MercatorProjection {
 
+            inverse_table m_inverse_table{inverse_table::no};
+
         public:
 
             // This is not "= default" on purpose because some compilers don't
@@ -150,6 +421,20 @@ namespace osmium {
             MercatorProjection() { // NOLINT(hicpp-use-equals-default, modernize-use-equals-default)
             }
 
+            /**
+             * Construct a projection choosing how the inverse projection
+             * is computed. With inverse_table::yes, inverse() looks the
+             * latitude up in a precomputed table and interpolates between
+             * the table entries instead of calling the exact formula with
+             * its atan() and exp(). That is several times faster and
+             * introduces an error of less than one nanodegree. Use this
+             * when decoding large amounts of mercator coordinates, for
+             * instance from vector tiles.
+             */
+            explicit MercatorProjection(inverse_table use_table) noexcept :
+                m_inverse_table(use_table) {
+            }
+
             /**
              * Do coordinate transformation.
              *
@@ -161,6 +446,47 @@ namespace osmium {
                 return Coordinates{detail::lon_to_x(location.lon()), detail::lat_to_y(location.lat())};
             }
 
+            /**
+             * Do coordinate transformation on coordinates that have
+             * already been converted from a Location.
+             *
+             * @pre Coordinates must be in valid range, longitude between
+             *      -180 and +180 degree, latitude between -MERCATOR_MAX_LAT
+             *      and MERCATOR_MAX_LAT.
+             */
+            Coordinates operator()(const Coordinates& coordinates) const {
+                return lonlat_to_mercator(coordinates);
+            }
+
+            /**
+             * Do coordinate transformation on an array of coordinates, in
+             * place, using the batch implementation. Used by the trusted
+             * fast paths of the GeometryFactory.
+             *
+             * @pre All coordinates must be in valid range, longitude
+             *      between -180 and +180 degree, latitude between
+             *      -MERCATOR_MAX_LAT and MERCATOR_MAX_LAT.
+             */
+            void operator()(Coordinates* coordinates, std::size_t count) const {
+                detail::lonlat_to_mercator_batch(coordinates, count);
+            }
+
+            /**
+             * Do the inverse coordinate transformation, from web mercator
+             * back to WGS84 lon/lat. Uses the precomputed interpolation
+             * table if the projection was constructed with
+             * inverse_table::yes.
+             *
+             * @pre Coordinates must be in valid range (x and y between
+             *      -/+20037508.34).
+             */
+            Coordinates inverse(const Coordinates& coordinates) const {
+                if (m_inverse_table == inverse_table::yes) {
+                    return Coordinates{detail::x_to_lon(coordinates.x), detail::y_to_lat_with_table(coordinates.y)};
+                }
+                return mercator_to_lonlat(coordinates);
+            }
+
             static int epsg() noexcept {
                 return 3857;
             }
@@ -175,4 +501,7 @@ namespace osmium {
 
 } // namespace osmium
 
+#undef OSMIUM_MERCATOR_X86
+#undef OSMIUM_MERCATOR_NEON
+
 #endif // OSMIUM_GEOM_MERCATOR_PROJECTION_HPP
@@ -56,6 +56,7 @@ DEALINGS IN THE SOFTWARE.
 # undef ACCEPT_USE_OF_DEPRECATED_PROJ_API_H
 #endif
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -130,6 +131,28 @@ namespace osmium {
             return c;
         }
 
+        /**
+         * Transform an array of coordinates from one CRS into another, in
+         * place, with a single call into the proj library. This amortizes
+         * the per-call setup cost of pj_transform() over all coordinates.
+         *
+         * Coordinates have to be in radians and are produced in radians.
+         *
+         * @throws osmium::projection_error if the projection fails
+         *
+         * @deprecated Only supports the old PROJ API.
+         */
+        inline OSMIUM_DEPRECATED void transform(const CRS& src, const CRS& dest, Coordinates* coordinates, std::size_t count) {
+            if (count == 0) {
+                return;
+            }
+            // x and y each have a stride of two doubles in the array
+            const int result = pj_transform(src.get(), dest.get(), static_cast<long>(count), 2, &coordinates->x, &coordinates->y, nullptr); // NOLINT(google-runtime-int)
+            if (result != 0) {
+                throw osmium::projection_error{std::string{"projection failed: "} + pj_strerrno(result)};
+            }
+        }
+
         /**
          * Functor that does projection from WGS84 (EPSG:4326) to the given
          * CRS.
@@ -196,6 +219,54 @@ namespace osmium {
                 return c;
             }
 
+            /**
+             * Do coordinate transformation on coordinates that have
+             * already been converted from a Location.
+             *
+             * @pre Coordinates must be in valid range (depends on
+             *      projection used).
+             */
+            Coordinates operator()(const Coordinates& coordinates) const {
+                Coordinates result{coordinates};
+                (*this)(&result, 1);
+                return result;
+            }
+
+            /**
+             * Do coordinate transformation on an array of coordinates, in
+             * place. The whole array is handed to the proj library in one
+             * call, so the per-call overhead of pj_transform() is paid
+             * only once per node list instead of once per node. Used by
+             * the trusted fast paths of the GeometryFactory.
+             *
+             * @pre All coordinates must be in valid range (depends on
+             *      projection used).
+             */
+            void operator()(Coordinates* coordinates, std::size_t count) const {
+                if (count == 0 || m_epsg == 4326) {
+                    return;
+                }
+
+                if (m_epsg == 3857) {
+                    detail::lonlat_to_mercator_batch(coordinates, count);
+                    return;
+                }
+
+                for (std::size_t n = 0; n < count; ++n) {
+                    coordinates[n].x = deg_to_rad(coordinates[n].x);
+                    coordinates[n].y = deg_to_rad(coordinates[n].y);
+                }
+
+                transform(m_crs_wgs84, m_crs_user, coordinates, count);
+
+                if (m_crs_user.is_latlong()) {
+                    for (std::size_t n = 0; n < count; ++n) {
+                        coordinates[n].x = rad_to_deg(coordinates[n].x);
+                        coordinates[n].y = rad_to_deg(coordinates[n].y);
+                    }
+                }
+            }
+
             int epsg() const noexcept {
                 return m_epsg;
             }
@@ -38,6 +38,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/location.hpp>
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 
 namespace osmium {
@@ -158,6 +159,44 @@ namespace osmium {
                 y = mercy_to_tiley(zoom, coordinates.y);
             }
 
+            /**
+             * Get the tile one zoom level up that contains this tile.
+             * This is just two bit shifts, much cheaper than computing the
+             * tile from the location again.
+             *
+             * @pre @code z > 0 @endcode
+             */
+            Tile parent() const noexcept {
+                assert(z > 0);
+                return Tile{z - 1, x >> 1U, y >> 1U};
+            }
+
+            /**
+             * Get the tile at the given (smaller or equal) zoom level that
+             * contains this tile. Use this to get the tiles in all zoom
+             * levels after computing the tile in the deepest zoom level
+             * once.
+             *
+             * @pre @code zoom <= z @endcode
+             */
+            Tile ancestor(uint32_t zoom) const noexcept {
+                assert(zoom <= z);
+                return Tile{zoom, x >> (z - zoom), y >> (z - zoom)};
+            }
+
+            /**
+             * Get one of the four children of this tile one zoom level
+             * down. Children are numbered 0 to 3: 0 is the top left, 1 the
+             * top right, 2 the bottom left, and 3 the bottom right child.
+             *
+             * @pre @code z < max_zoom && n < 4 @endcode
+             */
+            Tile child(uint32_t n) const noexcept {
+                assert(z < static_cast<uint32_t>(max_zoom));
+                assert(n < 4);
+                return Tile{z + 1, (x << 1U) | (n & 1U), (y << 1U) | (n >> 1U)};
+            }
+
             /**
              * Check whether this tile is valid. For a tile to be valid the
              * zoom level must be between 0 and 30 and the coordinates must
@@ -182,6 +221,64 @@ namespace osmium {
             return !(lhs == rhs);
         }
 
+        /**
+         * Compute the tiles at the given zoom level containing each of the
+         * given locations. This is faster than constructing the tiles one
+         * at a time, because the locations are projected to web mercator
+         * in one batch pass (which can use SIMD instructions) and the
+         * per-tile division is replaced by a multiplication with a factor
+         * computed once.
+         *
+         * For tiles in several zoom levels compute the tiles in the
+         * deepest zoom level with this function and use Tile::ancestor()
+         * for the other zoom levels.
+         *
+         * @param zoom Zoom level for all tiles.
+         * @param locations Pointer to an array of locations.
+         * @param count The number of locations in the array.
+         * @param tiles Pointer to an array with room for count tiles.
+         *
+         * @pre All locations must be valid and zoom <= 30.
+         */
+        inline void locations_to_tiles(uint32_t zoom, const osmium::Location* locations, std::size_t count, Tile* tiles) {
+            assert(zoom <= static_cast<uint32_t>(Tile::max_zoom));
+
+            enum : std::size_t {
+                batch_size = 256
+            };
+
+            const double factor = 1.0 / tile_extent_in_zoom(zoom);
+            const auto max_tile = static_cast<int32_t>(num_tiles_in_zoom(zoom) - 1);
+
+            Coordinates coordinates[batch_size];
+
+            while (count > 0) {
+                const std::size_t num = count < batch_size ? count : batch_size;
+
+                for (std::size_t i = 0; i < num; ++i) {
+                    assert(locations[i].valid());
+                    coordinates[i].x = locations[i].lon();
+                    coordinates[i].y = locations[i].lat();
+                }
+
+                lonlat_to_mercator(coordinates, num);
+
+                for (std::size_t i = 0; i < num; ++i) {
+                    tiles[i].z = zoom;
+                    tiles[i].x = static_cast<uint32_t>(detail::clamp<int32_t>(
+                        static_cast<int32_t>((coordinates[i].x + detail::max_coordinate_epsg3857) * factor),
+                        0, max_tile));
+                    tiles[i].y = static_cast<uint32_t>(detail::clamp<int32_t>(
+                        static_cast<int32_t>((detail::max_coordinate_epsg3857 - coordinates[i].y) * factor),
+                        0, max_tile));
+                }
+
+                locations += num;
+                tiles += num;
+                count -= num;
+            }
+        }
+
         /**
          * This defines an arbitrary order on tiles for use in std::map etc.
          */
@@ -0,0 +1,359 @@
+#ifndef OSMIUM_GEOM_TILE_EXPIRY_HPP
+#define OSMIUM_GEOM_TILE_EXPIRY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/geom/tile.hpp>
+#include <osmium/index/id_set.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node_ref_list.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        namespace detail {
+
+            /// Spread the bits of a 32 bit value over the even bit
+            /// positions of a 64 bit value.
+            inline uint64_t spread_bits(uint32_t value) noexcept {
+                uint64_t v = value;
+                v = (v | (v << 16U)) & 0x0000FFFF0000FFFFULL;
+                v = (v | (v <<  8U)) & 0x00FF00FF00FF00FFULL;
+                v = (v | (v <<  4U)) & 0x0F0F0F0F0F0F0F0FULL;
+                v = (v | (v <<  2U)) & 0x3333333333333333ULL;
+                v = (v | (v <<  1U)) & 0x5555555555555555ULL;
+                return v;
+            }
+
+            /// Collect the even bit positions of a 64 bit value into a
+            /// 32 bit value. The inverse of spread_bits().
+            inline uint32_t compact_bits(uint64_t value) noexcept {
+                uint64_t v = value & 0x5555555555555555ULL;
+                v = (v | (v >>  1U)) & 0x3333333333333333ULL;
+                v = (v | (v >>  2U)) & 0x0F0F0F0F0F0F0F0FULL;
+                v = (v | (v >>  4U)) & 0x00FF00FF00FF00FFULL;
+                v = (v | (v >>  8U)) & 0x0000FFFF0000FFFFULL;
+                v = (v | (v >> 16U)) & 0x00000000FFFFFFFFULL;
+                return static_cast<uint32_t>(v);
+            }
+
+            /**
+             * Encode the x and y coordinates of a tile into a single
+             * integer by interleaving their bits (Morton or "z-order"
+             * encoding). The encoding has two properties the expiry set
+             * relies on: the id of the parent tile is just the id shifted
+             * right by two bits, and tiles that are close together on the
+             * map get ids that are close together, so they end up in the
+             * same chunk of an IdSetDense.
+             */
+            inline uint64_t tile_to_morton(const Tile& tile) noexcept {
+                return (spread_bits(tile.x) << 1U) | spread_bits(tile.y);
+            }
+
+            /// Decode a Morton-encoded tile id. The inverse of tile_to_morton().
+            inline Tile morton_to_tile(uint32_t zoom, uint64_t id) noexcept {
+                return Tile{zoom, compact_bits(id >> 1U), compact_bits(id)};
+            }
+
+        } // namespace detail
+
+        /**
+         * A set of tiles to be re-rendered ("expired") because the objects
+         * in them changed, kept for a whole range of zoom levels at once.
+         *
+         * Feed the set the locations of all changed nodes and the segments
+         * of all changed ways. The set computes the affected tiles in the
+         * deepest zoom level and propagates them to all parent tiles up to
+         * the minimum zoom level. Every tile appears only once however
+         * often it was touched.
+         *
+         * Tiles are stored in one compact bitset (osmium::index::IdSetDense)
+         * per zoom level instead of a std::set<Tile>, so adding a tile that
+         * is already in the set does not allocate any memory.
+         */
+        class TileExpirySet {
+
+            // IdSetDense chunk size used for the tile bitsets. With the
+            // Morton encoding a chunk covers a square block of 256 x 256
+            // tiles using 8kB of memory, a good fit for the spatially
+            // clustered tiles of a typical change file.
+            enum : std::size_t {
+                tile_set_chunk_bits = 16U
+            };
+
+            using tile_set_type = osmium::index::IdSetDense<uint64_t, tile_set_chunk_bits>;
+
+            std::vector<tile_set_type> m_sets;
+            uint32_t m_min_zoom;
+            uint32_t m_max_zoom;
+
+            tile_set_type& set(uint32_t zoom) noexcept {
+                assert(zoom >= m_min_zoom && zoom <= m_max_zoom);
+                return m_sets[zoom - m_min_zoom];
+            }
+
+            const tile_set_type& set(uint32_t zoom) const noexcept {
+                assert(zoom >= m_min_zoom && zoom <= m_max_zoom);
+                return m_sets[zoom - m_min_zoom];
+            }
+
+            /**
+             * Add the tile with the given Morton id in the given zoom
+             * level and all its parents up to the minimum zoom level.
+             * Stops as soon as a parent is already in the set, because
+             * then all parents above it are in the set, too.
+             */
+            void add_with_parents(uint32_t zoom, uint64_t id) {
+                for (uint32_t z = zoom; z >= m_min_zoom; --z, id >>= 2U) {
+                    if (!set(z).check_and_set(id)) {
+                        break;
+                    }
+                    if (z == 0) {
+                        break;
+                    }
+                }
+            }
+
+            // The fractional tile coordinate of the given location in the
+            // maximum zoom level, clamped to the valid range.
+            Coordinates fractional_coordinates(const osmium::Location& location) const {
+                assert(location.valid());
+                const auto c = lonlat_to_mercator(location);
+                const double factor = 1.0 / tile_extent_in_zoom(m_max_zoom);
+                const double max = static_cast<double>(num_tiles_in_zoom(m_max_zoom));
+                const double x = (c.x + osmium::geom::detail::max_coordinate_epsg3857) * factor;
+                const double y = (osmium::geom::detail::max_coordinate_epsg3857 - c.y) * factor;
+                return Coordinates{geom::detail::clamp(x, 0.0, max),
+                                   geom::detail::clamp(y, 0.0, max)};
+            }
+
+            static uint32_t to_tile_coordinate(double value, uint32_t max_tile) noexcept {
+                const auto t = static_cast<int64_t>(std::floor(value));
+                if (t < 0) {
+                    return 0;
+                }
+                if (t > static_cast<int64_t>(max_tile)) {
+                    return max_tile;
+                }
+                return static_cast<uint32_t>(t);
+            }
+
+            // Add all tiles in the column (or, with swapped set to true,
+            // the row) "along" between the cross coordinates "from" and
+            // "to" in the maximum zoom level.
+            void add_column(uint32_t along, double from, double to, bool swapped) {
+                const uint32_t max_tile = num_tiles_in_zoom(m_max_zoom) - 1;
+                uint32_t a = to_tile_coordinate(from, max_tile);
+                uint32_t b = to_tile_coordinate(to, max_tile);
+                if (a > b) {
+                    std::swap(a, b);
+                }
+                for (uint32_t cross = a; cross <= b; ++cross) {
+                    const Tile tile = swapped ? Tile{m_max_zoom, cross, along}
+                                              : Tile{m_max_zoom, along, cross};
+                    add_with_parents(m_max_zoom, detail::tile_to_morton(tile));
+                }
+            }
+
+        public:
+
+            /**
+             * Create a tile expiry set for the given range of zoom levels.
+             *
+             * @pre @code min_zoom <= max_zoom && max_zoom <= 30 @endcode
+             */
+            explicit TileExpirySet(uint32_t min_zoom, uint32_t max_zoom) :
+                m_min_zoom(min_zoom),
+                m_max_zoom(max_zoom) {
+                assert(min_zoom <= max_zoom);
+                assert(max_zoom <= static_cast<uint32_t>(Tile::max_zoom));
+                m_sets.reserve(max_zoom - min_zoom + 1);
+                for (uint32_t z = min_zoom; z <= max_zoom; ++z) {
+                    m_sets.emplace_back();
+                }
+            }
+
+            uint32_t min_zoom() const noexcept {
+                return m_min_zoom;
+            }
+
+            uint32_t max_zoom() const noexcept {
+                return m_max_zoom;
+            }
+
+            /**
+             * Add the given tile and all its parent tiles up to the
+             * minimum zoom level.
+             *
+             * @pre @code tile.valid() && tile.z >= min_zoom() && tile.z <= max_zoom() @endcode
+             */
+            void add(const Tile& tile) {
+                assert(tile.valid());
+                assert(tile.z >= m_min_zoom && tile.z <= m_max_zoom);
+                add_with_parents(tile.z, detail::tile_to_morton(tile));
+            }
+
+            /**
+             * Add the tile containing the given location in the maximum
+             * zoom level and all its parent tiles. Call this for every
+             * changed node.
+             *
+             * @pre @code location.valid() @endcode
+             */
+            void add(const osmium::Location& location) {
+                add(Tile{m_max_zoom, location});
+            }
+
+            /**
+             * Add all tiles in the maximum zoom level that the line
+             * segment between the two locations passes through, and all
+             * their parent tiles.
+             *
+             * @pre @code from.valid() && to.valid() @endcode
+             */
+            void add_segment(const osmium::Location& from, const osmium::Location& to) {
+                Coordinates a = fractional_coordinates(from);
+                Coordinates b = fractional_coordinates(to);
+
+                // Walk along the axis with the larger extent and add, for
+                // each column the segment enters, all rows it covers in
+                // that column (or the other way around). This finds every
+                // tile the segment passes through.
+                const bool swapped = std::abs(b.y - a.y) > std::abs(b.x - a.x);
+                if (swapped) {
+                    std::swap(a.x, a.y);
+                    std::swap(b.x, b.y);
+                }
+                if (a.x > b.x) {
+                    std::swap(a, b);
+                }
+
+                const uint32_t max_tile = num_tiles_in_zoom(m_max_zoom) - 1;
+                const uint32_t first = to_tile_coordinate(a.x, max_tile);
+                const uint32_t last = to_tile_coordinate(b.x, max_tile);
+
+                if (first == last) {
+                    add_column(first, a.y, b.y, swapped);
+                    return;
+                }
+
+                const double slope = (b.y - a.y) / (b.x - a.x);
+                double prev_y = a.y;
+                for (uint32_t along = first; along <= last; ++along) {
+                    const double edge_x = std::min(static_cast<double>(along) + 1.0, b.x);
+                    const double edge_y = a.y + slope * (edge_x - a.x);
+                    add_column(along, prev_y, edge_y, swapped);
+                    prev_y = edge_y;
+                }
+            }
+
+            /**
+             * Add all tiles covered by the given way geometry. Nodes
+             * without a valid location are skipped.
+             */
+            void add(const osmium::NodeRefList& nodes) {
+                osmium::Location prev;
+                for (const auto& node_ref : nodes) {
+                    const osmium::Location location = node_ref.location();
+                    if (!location.valid()) {
+                        continue;
+                    }
+                    if (prev.valid()) {
+                        add_segment(prev, location);
+                    } else {
+                        add(location);
+                    }
+                    prev = location;
+                }
+            }
+
+            /// Is the given tile in the set?
+            bool contains(const Tile& tile) const noexcept {
+                assert(tile.z >= m_min_zoom && tile.z <= m_max_zoom);
+                return set(tile.z).get(detail::tile_to_morton(tile));
+            }
+
+            /// The number of tiles in the set in the given zoom level.
+            std::size_t size(uint32_t zoom) const noexcept {
+                return set(zoom).size();
+            }
+
+            /// Is the set empty?
+            bool empty() const noexcept {
+                for (const auto& s : m_sets) {
+                    if (!s.empty()) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /**
+             * Get all tiles in the set in the given zoom level. The tiles
+             * are deduplicated and sorted in z-order (Morton order), which
+             * keeps tiles that are close on the map close in the list.
+             */
+            std::vector<Tile> tiles(uint32_t zoom) const {
+                std::vector<Tile> result;
+                result.reserve(size(zoom));
+                for (const auto id : set(zoom)) {
+                    result.push_back(detail::morton_to_tile(zoom, id));
+                }
+                return result;
+            }
+
+            /// Remove all tiles from the set.
+            void clear() {
+                for (auto& s : m_sets) {
+                    s.clear();
+                }
+            }
+
+        }; // class TileExpirySet
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_TILE_EXPIRY_HPP
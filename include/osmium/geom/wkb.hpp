@@ -63,6 +63,17 @@ namespace osmium {
                 str.append(reinterpret_cast<const char*>(&data), sizeof(T));
             }
 
+            /**
+             * Append both coordinates in one go. WKB stores doubles in the
+             * byte order given in the geometry header, which is always the
+             * native one here, so the in-memory representation can be
+             * copied directly.
+             */
+            inline void str_push_coordinates(std::string& str, const osmium::geom::Coordinates& xy) {
+                static_assert(sizeof(Coordinates) == 2 * sizeof(double), "Coordinates must be two packed doubles");
+                str.append(reinterpret_cast<const char*>(&xy), sizeof(Coordinates));
+            }
+
             inline std::string convert_to_hex(const std::string& str) {
                 static const char* lookup_hex = "0123456789ABCDEF";
                 std::string out;
@@ -165,8 +176,7 @@ namespace osmium {
                 point_type make_point(const osmium::geom::Coordinates& xy) const {
                     std::string data;
                     header(data, wkbPoint, false);
-                    str_push(data, xy.x);
-                    str_push(data, xy.y);
+                    str_push_coordinates(data, xy);
 
                     if (m_out_type == out_type::hex) {
                         return convert_to_hex(data);
@@ -183,8 +193,7 @@ namespace osmium {
                 }
 
                 void linestring_add_location(const osmium::geom::Coordinates& xy) {
-                    str_push(m_data, xy.x);
-                    str_push(m_data, xy.y);
+                    str_push_coordinates(m_data, xy);
                 }
 
                 linestring_type linestring_finish(std::size_t num_points) {
@@ -211,8 +220,7 @@ namespace osmium {
                 }
 
                 void polygon_add_location(const osmium::geom::Coordinates& xy) {
-                    str_push(m_data, xy.x);
-                    str_push(m_data, xy.y);
+                    str_push_coordinates(m_data, xy);
                 }
 
                 polygon_type polygon_finish(std::size_t num_points) {
@@ -237,6 +245,20 @@ namespace osmium {
                     m_multipolygon_size_offset = header(m_data, wkbMultiPolygon, true);
                 }
 
+                /**
+                 * Reserve space for a complete multipolygon. Called after
+                 * multipolygon_start() by the trusted fast path of the
+                 * GeometryFactory with the counts computed up front from
+                 * the area, so the whole geometry is written with a
+                 * single allocation.
+                 */
+                void multipolygon_reserve(std::size_t num_polygons, std::size_t num_rings, std::size_t num_points) {
+                    const std::size_t header_size = sizeof(uint8_t) + sizeof(uint32_t) + (m_wkb_type == wkb_type::ewkb ? sizeof(uint32_t) : 0);
+                    m_data.reserve((num_polygons + 1) * (header_size + sizeof(uint32_t)) +
+                                   num_rings * sizeof(uint32_t) +
+                                   num_points * sizeof(Coordinates));
+                }
+
                 void multipolygon_polygon_start() {
                     ++m_polygons;
                     m_rings = 0;
@@ -270,11 +292,16 @@ namespace osmium {
                 }
 
                 void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
-                    str_push(m_data, xy.x);
-                    str_push(m_data, xy.y);
+                    str_push_coordinates(m_data, xy);
                     ++m_points;
                 }
 
+                /// Append a whole run of coordinates to the current ring in one copy.
+                void multipolygon_add_locations(const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                    m_data.append(reinterpret_cast<const char*>(coordinates), count * sizeof(Coordinates));
+                    m_points += static_cast<uint32_t>(count);
+                }
+
                 multipolygon_type multipolygon_finish() {
                     set_size(m_multipolygon_size_offset, m_polygons);
                     std::string data;
@@ -291,11 +318,223 @@ namespace osmium {
 
             }; // class WKBFactoryImpl
 
+            /**
+             * Like WKBFactoryImpl, but appends the geometries to a
+             * caller-supplied buffer instead of returning each geometry in
+             * a fresh std::string. After the buffer has grown to its
+             * working size no more allocations happen, no matter how many
+             * geometries are created with it.
+             *
+             * The create_* functions return the number of bytes appended
+             * to the buffer, the geometry starts that many bytes before
+             * the end of the buffer. The caller decides when to clear the
+             * buffer, so several geometries can be batched up in it.
+             *
+             * If geometry creation fails with an exception, a partly
+             * written geometry may be left at the end of the buffer;
+             * truncate the buffer to its previous size in that case.
+             *
+             * Only binary output is supported, there is no hex mode.
+             */
+            class WKBBufferFactoryImpl {
+
+                enum wkbGeometryType : uint32_t {
+                    wkbPoint               = 1,
+                    wkbLineString          = 2,
+                    wkbPolygon             = 3,
+                    wkbMultiPolygon        = 6,
+
+                    // SRID-presence flag (EWKB)
+                    wkbSRID                = 0x20000000
+                }; // enum wkbGeometryType
+
+                enum class wkb_byte_order_type : uint8_t {
+                    XDR = 0,         // Big Endian
+                    NDR = 1          // Little Endian
+                }; // enum class wkb_byte_order_type
+
+                std::string* m_buffer;
+                uint32_t m_points = 0;
+                int m_srid;
+                wkb_type m_wkb_type;
+
+                std::size_t m_geometry_offset = 0;
+                std::size_t m_linestring_size_offset = 0;
+                std::size_t m_polygons = 0;
+                std::size_t m_rings = 0;
+                std::size_t m_multipolygon_size_offset = 0;
+                std::size_t m_polygon_size_offset = 0;
+                std::size_t m_ring_size_offset = 0;
+
+                std::size_t header(wkbGeometryType type, bool add_length) const {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+                    str_push(*m_buffer, wkb_byte_order_type::NDR);
+#else
+                    str_push(*m_buffer, wkb_byte_order_type::XDR);
+#endif
+                    if (m_wkb_type == wkb_type::ewkb) {
+                        str_push(*m_buffer, type | wkbSRID);
+                        str_push(*m_buffer, m_srid);
+                    } else {
+                        str_push(*m_buffer, type);
+                    }
+                    const std::size_t offset = m_buffer->size();
+                    if (add_length) {
+                        str_push(*m_buffer, static_cast<uint32_t>(0));
+                    }
+                    return offset;
+                }
+
+                void set_size(const std::size_t offset, const std::size_t size) {
+                    if (size > std::numeric_limits<uint32_t>::max()) {
+                        throw geometry_error{"Too many points in geometry"};
+                    }
+                    const auto s = static_cast<uint32_t>(size);
+                    std::copy_n(reinterpret_cast<const char*>(&s), sizeof(uint32_t), &(*m_buffer)[offset]);
+                }
+
+                std::size_t geometry_size() const noexcept {
+                    return m_buffer->size() - m_geometry_offset;
+                }
+
+            public:
+
+                using point_type        = std::size_t;
+                using linestring_type   = std::size_t;
+                using polygon_type      = std::size_t;
+                using multipolygon_type = std::size_t;
+                using ring_type         = std::size_t;
+
+                explicit WKBBufferFactoryImpl(int srid, std::string& buffer, wkb_type wtype = wkb_type::wkb) :
+                    m_buffer(&buffer),
+                    m_srid(srid),
+                    m_wkb_type(wtype) {
+                }
+
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    const std::size_t offset = m_buffer->size();
+                    header(wkbPoint, false);
+                    str_push_coordinates(*m_buffer, xy);
+                    return m_buffer->size() - offset;
+                }
+
+                /* LineString */
+
+                void linestring_start() {
+                    m_geometry_offset = m_buffer->size();
+                    m_linestring_size_offset = header(wkbLineString, true);
+                }
+
+                void linestring_add_location(const osmium::geom::Coordinates& xy) {
+                    str_push_coordinates(*m_buffer, xy);
+                }
+
+                linestring_type linestring_finish(std::size_t num_points) {
+                    set_size(m_linestring_size_offset, num_points);
+                    return geometry_size();
+                }
+
+                /* Polygon */
+
+                void polygon_start() {
+                    m_geometry_offset = m_buffer->size();
+                    set_size(header(wkbPolygon, true), 1);
+                    m_ring_size_offset = m_buffer->size();
+                    str_push(*m_buffer, static_cast<uint32_t>(0));
+                }
+
+                void polygon_add_location(const osmium::geom::Coordinates& xy) {
+                    str_push_coordinates(*m_buffer, xy);
+                }
+
+                polygon_type polygon_finish(std::size_t num_points) {
+                    set_size(m_ring_size_offset, num_points);
+                    return geometry_size();
+                }
+
+                /* MultiPolygon */
+
+                void multipolygon_start() {
+                    m_geometry_offset = m_buffer->size();
+                    m_polygons = 0;
+                    m_multipolygon_size_offset = header(wkbMultiPolygon, true);
+                }
+
+                /// @copydoc WKBFactoryImpl::multipolygon_reserve()
+                void multipolygon_reserve(std::size_t num_polygons, std::size_t num_rings, std::size_t num_points) {
+                    const std::size_t header_size = sizeof(uint8_t) + sizeof(uint32_t) + (m_wkb_type == wkb_type::ewkb ? sizeof(uint32_t) : 0);
+                    m_buffer->reserve(m_geometry_offset +
+                                      (num_polygons + 1) * (header_size + sizeof(uint32_t)) +
+                                      num_rings * sizeof(uint32_t) +
+                                      num_points * sizeof(Coordinates));
+                }
+
+                void multipolygon_polygon_start() {
+                    ++m_polygons;
+                    m_rings = 0;
+                    m_polygon_size_offset = header(wkbPolygon, true);
+                }
+
+                void multipolygon_polygon_finish() {
+                    set_size(m_polygon_size_offset, m_rings);
+                }
+
+                void multipolygon_outer_ring_start() {
+                    ++m_rings;
+                    m_points = 0;
+                    m_ring_size_offset = m_buffer->size();
+                    str_push(*m_buffer, static_cast<uint32_t>(0));
+                }
+
+                void multipolygon_outer_ring_finish() {
+                    set_size(m_ring_size_offset, m_points);
+                }
+
+                void multipolygon_inner_ring_start() {
+                    ++m_rings;
+                    m_points = 0;
+                    m_ring_size_offset = m_buffer->size();
+                    str_push(*m_buffer, static_cast<uint32_t>(0));
+                }
+
+                void multipolygon_inner_ring_finish() {
+                    set_size(m_ring_size_offset, m_points);
+                }
+
+                void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
+                    str_push_coordinates(*m_buffer, xy);
+                    ++m_points;
+                }
+
+                /// Append a whole run of coordinates to the current ring in one copy.
+                void multipolygon_add_locations(const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                    m_buffer->append(reinterpret_cast<const char*>(coordinates), count * sizeof(Coordinates));
+                    m_points += static_cast<uint32_t>(count);
+                }
+
+                multipolygon_type multipolygon_finish() {
+                    set_size(m_multipolygon_size_offset, m_polygons);
+                    return geometry_size();
+                }
+
+            }; // class WKBBufferFactoryImpl
+
         } // namespace detail
 
         template <typename TProjection = IdentityProjection>
         using WKBFactory = GeometryFactory<osmium::geom::detail::WKBFactoryImpl, TProjection>;
 
+        /**
+         * Like WKBFactory, but appends the binary WKB geometries to a
+         * caller-supplied std::string buffer passed to the constructor.
+         * The create_* functions return the number of bytes appended. See
+         * detail::WKBBufferFactoryImpl for the details.
+         */
+        template <typename TProjection = IdentityProjection>
+        using WKBBufferFactory = GeometryFactory<osmium::geom::detail::WKBBufferFactoryImpl, TProjection>;
+
     } // namespace geom
 
 } // namespace osmium
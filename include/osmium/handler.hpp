@@ -44,8 +44,10 @@ namespace osmium {
     class OuterRing;
     class Relation;
     class RelationMemberList;
+    class SlimNode;
     class TagList;
     class Way;
+    class WayEnvelope;
     class WayNodeList;
 
     /**
@@ -90,12 +92,18 @@ namespace osmium {
             void changeset(const osmium::Changeset& /*changeset*/) const noexcept {
             }
 
+            void slim_node(const osmium::SlimNode& /*slim_node*/) const noexcept {
+            }
+
             void tag_list(const osmium::TagList& /*tag_list*/) const noexcept {
             }
 
             void way_node_list(const osmium::WayNodeList& /*way_node_list*/) const noexcept {
             }
 
+            void way_envelope(const osmium::WayEnvelope& /*way_envelope*/) const noexcept {
+            }
+
             void relation_member_list(const osmium::RelationMemberList& /*relation_member_list*/) const noexcept {
             }
 
@@ -34,6 +34,8 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
 #include <osmium/osm/node.hpp>
 #include <osmium/osm/object_comparisons.hpp>
 #include <osmium/osm/relation.hpp>
@@ -41,6 +43,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/way.hpp>
 #include <osmium/util/compatibility.hpp>
 
+#include <cstddef>
 #include <stdexcept>
 #include <string>
 
@@ -83,18 +86,41 @@ namespace osmium {
          * call the node(), way(), and relation() methods from your node(),
          * way(), and relations() handlers, respectively. An out_of_order_error
          * exception will be thrown when the input is not in order.
+         *
+         * If you have whole buffers anyway, calling buffer() once per
+         * buffer is cheaper than going through the apply() dispatch for
+         * every object.
          */
         class CheckOrder : public osmium::handler::Handler {
 
             osmium::object_id_type m_max_node_id = 0;
             osmium::object_id_type m_max_way_id = 0;
             osmium::object_id_type m_max_relation_id = 0;
+            std::size_t m_sample_rate = 1;
+            std::size_t m_sample_counter = 0;
             bool m_has_node = false;
             bool m_has_way = false;
             bool m_has_relation = false;
 
         public:
 
+            CheckOrder() noexcept = default;
+
+            /**
+             * Construct a CheckOrder handler that checks only every
+             * sample_rate-th object seen by buffer(). With a sample rate
+             * of n the check costs only 1/n-th, but an ordering problem
+             * confined to the objects in between can go unnoticed. The
+             * node(), way(), and relation() methods always check the
+             * object they are given.
+             *
+             * @param sample_rate Check every so-many-th object in
+             *        buffer(). 0 and 1 both mean "check every object".
+             */
+            explicit CheckOrder(const std::size_t sample_rate) noexcept :
+                m_sample_rate(sample_rate > 1 ? sample_rate : 1) {
+            }
+
             void node(const osmium::Node& node) {
                 if (m_has_way) {
                     throw out_of_order_error{"Found a node after a way.", node.id()};
@@ -151,6 +177,47 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Check a single OSM object, dispatching on its type. Objects
+             * that are not nodes, ways, or relations are ignored.
+             */
+            void check_object(const osmium::OSMObject& object) {
+                switch (object.type()) {
+                    case osmium::item_type::node:
+                        node(static_cast<const osmium::Node&>(object));
+                        break;
+                    case osmium::item_type::way:
+                        way(static_cast<const osmium::Way&>(object));
+                        break;
+                    case osmium::item_type::relation:
+                        relation(static_cast<const osmium::Relation&>(object));
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            /**
+             * Check all OSM objects in the given buffer in one loop
+             * without going through the apply() dispatch. If a sample
+             * rate was set in the constructor, only every so-many-th
+             * object is checked; the sample counter carries over from
+             * one buffer to the next.
+             */
+            void buffer(const osmium::memory::Buffer& buffer) {
+                if (m_sample_rate == 1) {
+                    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                        check_object(object);
+                    }
+                    return;
+                }
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    if (m_sample_counter++ % m_sample_rate == 0) {
+                        check_object(object);
+                    }
+                }
+            }
+
             osmium::object_id_type max_node_id() const noexcept {
                 return m_max_node_id;
             }
@@ -43,8 +43,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 
+#include <cstddef>
 #include <limits>
 #include <type_traits>
+#include <vector>
 
 namespace osmium {
 
@@ -76,12 +78,42 @@ namespace osmium {
 
         private:
 
+            /// Number of node refs looked up in the index at once.
+            enum : std::size_t {
+                batch_size = 64
+            };
+
+            /// Number of entries in the direct-mapped location cache.
+            /// Must be a power of two.
+            enum : std::size_t {
+                cache_size = 4096
+            };
+
+            /**
+             * One entry of the direct-mapped location cache. An id of 0
+             * marks an empty slot, 0 is not a valid node id.
+             */
+            struct cache_entry {
+                osmium::unsigned_object_id_type id = 0;
+                osmium::Location location{};
+            }; // struct cache_entry
+
             /// Object that handles the actual storage of the node locations (with positive IDs).
             TStoragePosIDs& m_storage_pos;
 
             /// Object that handles the actual storage of the node locations (with negative IDs).
             TStorageNegIDs& m_storage_neg;
 
+            /**
+             * Direct-mapped cache in front of the positive-id storage.
+             * Ways in typical OSM files share many nodes with nearby
+             * ways, junction nodes in road networks are referenced
+             * dozens of times, so a large part of the lookups can be
+             * answered from here without going to the full index.
+             * Mutable so lookups can fill it from const functions.
+             */
+            mutable std::vector<cache_entry> m_cache{cache_size};
+
             osmium::unsigned_object_id_type m_last_id = 0;
 
             bool m_ignore_errors = false;
@@ -95,6 +127,10 @@ namespace osmium {
                 return instance;
             }
 
+            cache_entry& cache_slot(const osmium::unsigned_object_id_type id) const noexcept {
+                return m_cache[id & (cache_size - 1)];
+            }
+
         public:
 
             explicit NodeLocationsForWays(TStoragePosIDs& storage_pos,
@@ -135,6 +171,10 @@ namespace osmium {
                 const auto id = node.id();
                 if (id >= 0) {
                     m_storage_pos.set(static_cast<osmium::unsigned_object_id_type>( id), node.location());
+                    cache_entry& entry = cache_slot(static_cast<osmium::unsigned_object_id_type>(id));
+                    if (entry.id == static_cast<osmium::unsigned_object_id_type>(id)) {
+                        entry.location = node.location();
+                    }
                 } else {
                     m_storage_neg.set(static_cast<osmium::unsigned_object_id_type>(-id), node.location());
                 }
@@ -145,7 +185,15 @@ namespace osmium {
              */
             osmium::Location get_node_location(const osmium::object_id_type id) const {
                 if (id >= 0) {
-                    return m_storage_pos.get_noexcept(static_cast<osmium::unsigned_object_id_type>(id));
+                    const auto pos_id = static_cast<osmium::unsigned_object_id_type>(id);
+                    cache_entry& entry = cache_slot(pos_id);
+                    if (entry.id == pos_id) {
+                        return entry.location;
+                    }
+                    const auto location = m_storage_pos.get_noexcept(pos_id);
+                    entry.id = pos_id;
+                    entry.location = location;
+                    return location;
                 }
                 return m_storage_neg.get_noexcept(static_cast<osmium::unsigned_object_id_type>(-id));
             }
@@ -153,6 +201,12 @@ namespace osmium {
             /**
              * Retrieve locations of all nodes in the way from storage and add
              * them to the way object.
+             *
+             * Node refs recently looked up are answered from the
+             * direct-mapped location cache, the rest is looked up in
+             * batches through Map::get_batch(), so the index can
+             * overlap the cache misses of the lookups. The rare
+             * negative ids take the one-by-one path.
              */
             void way(osmium::Way& way) {
                 if (m_must_sort) {
@@ -162,10 +216,43 @@ namespace osmium {
                     m_last_id = std::numeric_limits<osmium::unsigned_object_id_type>::max();
                 }
                 bool error = false;
-                for (auto& node_ref : way.nodes()) {
-                    node_ref.set_location(get_node_location(node_ref.ref()));
-                    if (!node_ref.location()) {
-                        error = true;
+                auto it = way.nodes().begin();
+                const auto end = way.nodes().end();
+                while (it != end) {
+                    osmium::unsigned_object_id_type ids[batch_size];
+                    osmium::NodeRef* refs[batch_size];
+                    std::size_t num = 0;
+                    for (; it != end && num < batch_size; ++it) {
+                        if (it->ref() >= 0) {
+                            const auto id = static_cast<osmium::unsigned_object_id_type>(it->ref());
+                            const cache_entry& entry = cache_slot(id);
+                            if (entry.id == id) {
+                                it->set_location(entry.location);
+                                if (!entry.location) {
+                                    error = true;
+                                }
+                                continue;
+                            }
+                            ids[num] = id;
+                            refs[num] = &*it;
+                            ++num;
+                        } else {
+                            it->set_location(m_storage_neg.get_noexcept(static_cast<osmium::unsigned_object_id_type>(-it->ref())));
+                            if (!it->location()) {
+                                error = true;
+                            }
+                        }
+                    }
+                    osmium::Location locations[batch_size];
+                    m_storage_pos.get_batch(ids, num, locations);
+                    for (std::size_t i = 0; i < num; ++i) {
+                        refs[i]->set_location(locations[i]);
+                        cache_entry& entry = cache_slot(ids[i]);
+                        entry.id = ids[i];
+                        entry.location = locations[i];
+                        if (!locations[i]) {
+                            error = true;
+                        }
                     }
                 }
                 if (!m_ignore_errors && error) {
@@ -181,6 +268,7 @@ namespace osmium {
             void clear() {
                 m_storage_pos.clear();
                 m_storage_neg.clear();
+                m_cache.assign(cache_size, cache_entry{});
             }
 
         }; // class NodeLocationsForWays
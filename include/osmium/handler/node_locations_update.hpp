@@ -0,0 +1,172 @@
+#ifndef OSMIUM_HANDLER_NODE_LOCATIONS_UPDATE_HPP
+#define OSMIUM_HANDLER_NODE_LOCATIONS_UPDATE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstddef>
+#include <type_traits>
+
+namespace osmium {
+
+    namespace handler {
+
+        /**
+         * Handler to apply the node changes from an OSM change file to an
+         * existing node location index. Created and modified nodes get
+         * their (new) location stored, deleted nodes get the invalid
+         * location stored which is how an unset entry looks in the index.
+         *
+         * Used on a file-backed dense index (such as DenseFileArray) this
+         * updates the index in place: only the pages holding changed ids
+         * are touched, so applying a change file to a planet-sized index
+         * is much cheaper than rebuilding it from a full planet pass.
+         *
+         * Apply a change file like this:
+         *
+         * @code
+         * osmium::io::Reader reader{"changes.osc.gz", osmium::osm_entity_bits::node};
+         * osmium::handler::NodeLocationsUpdate<index_type> updater{index};
+         * osmium::apply(reader, updater);
+         * @endcode
+         *
+         * The change file must be sorted so that the newest version of a
+         * node comes last, as is the case for the replication diffs; the
+         * last version seen wins.
+         *
+         * @tparam TStoragePosIDs Class that handles the actual storage of
+         *                        the node locations (for positive IDs). It
+         *                        must support the set(id, value) method.
+         * @tparam TStorageNegIDs Same but for negative IDs.
+         */
+        template <typename TStoragePosIDs, typename TStorageNegIDs = dummy_type>
+        class NodeLocationsUpdate : public osmium::handler::Handler {
+
+            template <typename T>
+            using based_on_map = std::is_base_of<osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>, T>;
+
+            static_assert(based_on_map<TStoragePosIDs>::value, "Index class must be derived from osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>");
+            static_assert(based_on_map<TStorageNegIDs>::value, "Index class must be derived from osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>");
+
+        public:
+
+            using index_pos_type = TStoragePosIDs;
+            using index_neg_type = TStorageNegIDs;
+
+        private:
+
+            /// Object that handles the actual storage of the node locations (with positive IDs).
+            TStoragePosIDs& m_storage_pos;
+
+            /// Object that handles the actual storage of the node locations (with negative IDs).
+            TStorageNegIDs& m_storage_neg;
+
+            std::size_t m_nodes_set = 0;
+
+            std::size_t m_nodes_deleted = 0;
+
+            // It is okay to have this static dummy instance, even when using several threads,
+            // because it is read-only.
+            static dummy_type& get_dummy() {
+                static dummy_type instance;
+                return instance;
+            }
+
+            void set(const osmium::object_id_type id, const osmium::Location location) {
+                if (id >= 0) {
+                    m_storage_pos.set(static_cast<osmium::unsigned_object_id_type>( id), location);
+                } else {
+                    m_storage_neg.set(static_cast<osmium::unsigned_object_id_type>(-id), location);
+                }
+            }
+
+        public:
+
+            explicit NodeLocationsUpdate(TStoragePosIDs& storage_pos,
+                                         TStorageNegIDs& storage_neg = get_dummy()) noexcept :
+                m_storage_pos(storage_pos),
+                m_storage_neg(storage_neg) {
+            }
+
+            NodeLocationsUpdate(const NodeLocationsUpdate&) = delete;
+            NodeLocationsUpdate& operator=(const NodeLocationsUpdate&) = delete;
+
+            NodeLocationsUpdate(NodeLocationsUpdate&&) noexcept = default;
+            NodeLocationsUpdate& operator=(NodeLocationsUpdate&&) noexcept = default;
+
+            ~NodeLocationsUpdate() noexcept = default;
+
+            TStoragePosIDs& storage_pos() noexcept {
+                return m_storage_pos;
+            }
+
+            TStorageNegIDs& storage_neg() noexcept {
+                return m_storage_neg;
+            }
+
+            /// Number of nodes that got a location stored.
+            std::size_t nodes_set() const noexcept {
+                return m_nodes_set;
+            }
+
+            /// Number of nodes that were removed from the index.
+            std::size_t nodes_deleted() const noexcept {
+                return m_nodes_deleted;
+            }
+
+            /**
+             * Update the location of the node in the storage.
+             */
+            void node(const osmium::Node& node) {
+                if (node.visible()) {
+                    set(node.id(), node.location());
+                    ++m_nodes_set;
+                } else {
+                    set(node.id(), osmium::Location{});
+                    ++m_nodes_deleted;
+                }
+            }
+
+        }; // class NodeLocationsUpdate
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_HANDLER_NODE_LOCATIONS_UPDATE_HPP
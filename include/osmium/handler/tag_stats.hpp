@@ -0,0 +1,275 @@
+#ifndef OSMIUM_HANDLER_TAG_STATS_HPP
+#define OSMIUM_HANDLER_TAG_STATS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/tag.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace handler {
+
+        /**
+         * Handler counting how often every tag key and every key/value
+         * combination appears in the data. The counts live in
+         * open-addressing hash tables owned by the handler, the strings
+         * in an append-only arena, so counting one tag is a hash lookup
+         * and an increment without any memory allocation in the common
+         * case and without any locking ever.
+         *
+         * @code
+         * osmium::io::Reader reader{infile};
+         * osmium::handler::TagStats stats;
+         * osmium::apply(reader, stats);
+         * stats.for_each_key([](const char* key, uint64_t count) {
+         *     std::cout << key << ' ' << count << '\n';
+         * });
+         * @endcode
+         *
+         * Because there are no locks there is also no shared state to
+         * fight over when the data is processed on several threads: give
+         * every thread its own TagStats and combine them with merge() at
+         * the end. Merging costs one pass over the smaller handler's
+         * distinct tags, not one synchronization per tag counted.
+         */
+        class TagStats : public osmium::handler::Handler {
+
+            /**
+             * Open-addressing hash table from strings to counts. The
+             * strings are interned in an arena, the table entries only
+             * hold the arena offset, so growing the table moves
+             * fixed-size entries and never touches the strings.
+             */
+            class counter_table {
+
+                struct entry_type {
+                    std::size_t hash = 0;
+                    std::size_t offset = 0; // arena offset + 1, 0 means "empty"
+                    std::uint32_t length = 0;
+                    std::uint64_t count = 0;
+                };
+
+                enum : std::size_t {
+                    initial_table_size = 1024
+                };
+
+                std::string m_arena{};
+                std::vector<entry_type> m_entries{};
+                std::size_t m_size = 0;
+
+                static std::size_t hash_bytes(const char* data, const std::size_t length) noexcept {
+                    // FNV-1a
+                    std::size_t hash = 14695981039346656037ULL;
+                    for (std::size_t i = 0; i < length; ++i) {
+                        hash ^= static_cast<unsigned char>(data[i]);
+                        hash *= 1099511628211ULL;
+                    }
+                    return hash;
+                }
+
+                const char* str(const entry_type& entry) const noexcept {
+                    return m_arena.data() + (entry.offset - 1);
+                }
+
+                void grow() {
+                    std::vector<entry_type> old_entries{std::move(m_entries)};
+                    m_entries.clear();
+                    m_entries.resize(old_entries.empty() ? initial_table_size : old_entries.size() * 2);
+                    for (const auto& entry : old_entries) {
+                        if (entry.offset != 0) {
+                            std::size_t index = entry.hash & (m_entries.size() - 1);
+                            while (m_entries[index].offset != 0) {
+                                index = (index + 1) & (m_entries.size() - 1);
+                            }
+                            m_entries[index] = entry;
+                        }
+                    }
+                }
+
+            public:
+
+                counter_table() {
+                    grow();
+                }
+
+                /**
+                 * Add count for the string [data, data + length). The
+                 * string may contain embedded \0 bytes.
+                 */
+                void add(const char* data, const std::size_t length, const std::uint64_t count) {
+                    // grow at 2/3 load so probe chains stay short
+                    if (m_size * 3 >= m_entries.size() * 2) {
+                        grow();
+                    }
+
+                    const std::size_t hash = hash_bytes(data, length);
+                    std::size_t index = hash & (m_entries.size() - 1);
+                    while (m_entries[index].offset != 0) {
+                        entry_type& entry = m_entries[index];
+                        if (entry.hash == hash && entry.length == length &&
+                            !std::memcmp(str(entry), data, length)) {
+                            entry.count += count;
+                            return;
+                        }
+                        index = (index + 1) & (m_entries.size() - 1);
+                    }
+
+                    entry_type& entry = m_entries[index];
+                    entry.hash = hash;
+                    entry.offset = m_arena.size() + 1;
+                    entry.length = static_cast<std::uint32_t>(length);
+                    entry.count = count;
+                    m_arena.append(data, length);
+                    m_arena += '\0';
+                    ++m_size;
+                }
+
+                std::uint64_t get(const char* data, const std::size_t length) const noexcept {
+                    const std::size_t hash = hash_bytes(data, length);
+                    std::size_t index = hash & (m_entries.size() - 1);
+                    while (m_entries[index].offset != 0) {
+                        const entry_type& entry = m_entries[index];
+                        if (entry.hash == hash && entry.length == length &&
+                            !std::memcmp(str(entry), data, length)) {
+                            return entry.count;
+                        }
+                        index = (index + 1) & (m_entries.size() - 1);
+                    }
+                    return 0;
+                }
+
+                std::size_t size() const noexcept {
+                    return m_size;
+                }
+
+                template <typename TFunc>
+                void for_each(TFunc&& func) const {
+                    for (const auto& entry : m_entries) {
+                        if (entry.offset != 0) {
+                            func(str(entry), entry.length, entry.count);
+                        }
+                    }
+                }
+
+            }; // class counter_table
+
+            counter_table m_keys{};
+            counter_table m_tags{};
+
+        public:
+
+            void osm_object(const osmium::OSMObject& object) {
+                for (const auto& tag : object.tags()) {
+                    const std::size_t key_length = std::strlen(tag.key());
+                    m_keys.add(tag.key(), key_length, 1);
+                    // key and value are stored adjacent in the tag, the
+                    // combined "key\0value" is counted in one go
+                    m_tags.add(tag.key(), key_length + 1 + std::strlen(tag.value()), 1);
+                }
+            }
+
+            /// Number of distinct keys seen.
+            std::size_t distinct_keys() const noexcept {
+                return m_keys.size();
+            }
+
+            /// Number of distinct key/value combinations seen.
+            std::size_t distinct_tags() const noexcept {
+                return m_tags.size();
+            }
+
+            /// How often the given key was seen.
+            std::uint64_t count(const char* key) const noexcept {
+                return m_keys.get(key, std::strlen(key));
+            }
+
+            /// How often the given key/value combination was seen.
+            std::uint64_t count(const char* key, const char* value) const {
+                std::string tag{key};
+                tag += '\0';
+                tag += value;
+                return m_tags.get(tag.data(), tag.size());
+            }
+
+            /**
+             * Call func(const char* key, std::uint64_t count) for every
+             * distinct key, in no particular order.
+             */
+            template <typename TFunc>
+            void for_each_key(TFunc&& func) const {
+                m_keys.for_each([&func](const char* data, const std::size_t /*length*/, const std::uint64_t count) {
+                    func(data, count);
+                });
+            }
+
+            /**
+             * Call func(const char* key, const char* value,
+             * std::uint64_t count) for every distinct key/value
+             * combination, in no particular order.
+             */
+            template <typename TFunc>
+            void for_each_tag(TFunc&& func) const {
+                m_tags.for_each([&func](const char* data, const std::size_t /*length*/, const std::uint64_t count) {
+                    func(data, data + std::strlen(data) + 1, count);
+                });
+            }
+
+            /**
+             * Add all counts from the other handler to this one. Use this
+             * to combine the per-thread handlers of a parallel run.
+             */
+            void merge(const TagStats& other) {
+                other.m_keys.for_each([this](const char* data, const std::size_t length, const std::uint64_t count) {
+                    m_keys.add(data, length, count);
+                });
+                other.m_tags.for_each([this](const char* data, const std::size_t length, const std::uint64_t count) {
+                    m_tags.add(data, length, count);
+                });
+            }
+
+        }; // class TagStats
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_HANDLER_TAG_STATS_HPP
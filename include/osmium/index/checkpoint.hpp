@@ -0,0 +1,312 @@
+#ifndef OSMIUM_INDEX_CHECKPOINT_HPP
+#define OSMIUM_INDEX_CHECKPOINT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when a checkpoint file can not be used, for
+     * instance because it has the wrong magic, an unknown version, or
+     * was written with different id/value types.
+     */
+    struct checkpoint_error : public std::runtime_error {
+
+        explicit checkpoint_error(const char* message) :
+            std::runtime_error(message) {
+        }
+
+        explicit checkpoint_error(const std::string& message) :
+            std::runtime_error(message) {
+        }
+
+    }; // struct checkpoint_error
+
+    namespace index {
+
+        /// How the entries in a checkpoint file are laid out.
+        enum class checkpoint_layout : uint32_t {
+
+            /// Values indexed by id, as written by Map::dump_as_array().
+            array = 1,
+
+            /// Sorted (id, value) pairs, as written by Map::dump_as_list().
+            list = 2
+
+        }; // enum class checkpoint_layout
+
+        namespace detail {
+
+            // The file starts with this header, the entries follow
+            // directly after it. All fields are in host byte order, a
+            // checkpoint file is not meant to move between architectures.
+            struct checkpoint_file_header {
+                char magic[8];
+                uint32_t version;
+                uint32_t layout;
+                uint32_t id_bytes;
+                uint32_t value_bytes;
+                uint64_t entry_count;
+            }; // struct checkpoint_file_header
+
+            static_assert(sizeof(checkpoint_file_header) == 32, "checkpoint_file_header must be 32 bytes");
+
+            inline const char* checkpoint_magic() noexcept {
+                return "OSMIDXCP";
+            }
+
+            enum {
+                checkpoint_version = 1
+            };
+
+            // An entry in a list layout checkpoint. Has the same layout as
+            // the elements the sparse maps write in dump_as_list().
+            template <typename TId, typename TValue>
+            struct checkpoint_list_entry {
+                TId id;
+                TValue value;
+            }; // struct checkpoint_list_entry
+
+        } // namespace detail
+
+        /**
+         * Write the contents of a map to a file as a checkpoint: a header
+         * with magic, version, and layout metadata followed by the raw
+         * entries. The file can later be opened with CheckpointIndex
+         * without rebuilding the map.
+         *
+         * The array layout stores one value per id and is compact for
+         * dense id ranges, the list layout stores sorted (id, value)
+         * pairs and is compact for sparse ones. The map must support the
+         * corresponding dump function (dump_as_array() or dump_as_list(),
+         * which needs the map to be sorted).
+         *
+         * @param map The map to write out.
+         * @param fd File descriptor to write to, starting at the current
+         *           file position.
+         * @param layout Entry layout to use.
+         * @throws checkpoint_error If the entries written do not match the
+         *         layout metadata (for instance a list entry type with
+         *         padding).
+         * @throws std::runtime_error If the map does not support the dump
+         *         function needed for the layout.
+         */
+        template <typename TId, typename TValue>
+        void write_checkpoint(osmium::index::map::Map<TId, TValue>& map, const int fd, const checkpoint_layout layout) {
+            detail::checkpoint_file_header header{};
+            std::memcpy(header.magic, detail::checkpoint_magic(), sizeof(header.magic));
+            header.version = detail::checkpoint_version;
+            header.layout = static_cast<uint32_t>(layout);
+            header.id_bytes = sizeof(TId);
+            header.value_bytes = sizeof(TValue);
+            header.entry_count = 0;
+
+            const auto start_offset = osmium::file_offset(fd);
+            osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+
+            if (layout == checkpoint_layout::array) {
+                map.dump_as_array(fd);
+            } else {
+                map.dump_as_list(fd);
+            }
+
+            const auto end_offset = osmium::file_offset(fd);
+            const auto payload_size = end_offset - start_offset - sizeof(header);
+            const std::size_t entry_size = layout == checkpoint_layout::array
+                                               ? sizeof(TValue)
+                                               : sizeof(detail::checkpoint_list_entry<TId, TValue>);
+            if (payload_size % entry_size != 0) {
+                throw checkpoint_error{"dumped entries do not match the checkpoint layout"};
+            }
+            header.entry_count = payload_size / entry_size;
+
+            // Re-write the header now that the entry count is known.
+            osmium::file_seek(fd, start_offset);
+            osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+            osmium::file_seek(fd, end_offset);
+        }
+
+        namespace map {
+
+            /**
+             * A read-only map backed by a checkpoint file written with
+             * osmium::index::write_checkpoint(). The constructor only
+             * checks the header and mmaps the file, so opening is
+             * instant regardless of the index size; pages are faulted
+             * in by the operating system as they are accessed.
+             *
+             * Both checkpoint layouts can be opened with this class. The
+             * id and value types must be the same ones the checkpoint was
+             * written with, this is checked against the header.
+             *
+             * Calling set() or clear() on this map throws.
+             */
+            template <typename TId, typename TValue>
+            class CheckpointIndex : public Map<TId, TValue> {
+
+                using entry_type = detail::checkpoint_list_entry<TId, TValue>;
+
+                osmium::util::MemoryMapping m_mapping;
+
+                std::size_t m_entry_count;
+
+                checkpoint_layout m_layout;
+
+                static std::size_t checked_size(const int fd) {
+                    const auto size = osmium::file_size(fd);
+                    if (size < sizeof(detail::checkpoint_file_header)) {
+                        throw checkpoint_error{"checkpoint file too short for header"};
+                    }
+                    return size;
+                }
+
+                const detail::checkpoint_file_header& header() const noexcept {
+                    return *m_mapping.get_addr<detail::checkpoint_file_header>();
+                }
+
+                const TValue* values() const noexcept {
+                    return reinterpret_cast<const TValue*>(m_mapping.get_addr<char>() + sizeof(detail::checkpoint_file_header));
+                }
+
+                const entry_type* entries() const noexcept {
+                    return reinterpret_cast<const entry_type*>(m_mapping.get_addr<char>() + sizeof(detail::checkpoint_file_header));
+                }
+
+            public:
+
+                explicit CheckpointIndex(const int fd) :
+                    m_mapping(checked_size(fd), osmium::util::MemoryMapping::mapping_mode::readonly, fd),
+                    m_entry_count(0),
+                    m_layout(checkpoint_layout::array) {
+                    const auto& h = header();
+
+                    if (std::memcmp(h.magic, detail::checkpoint_magic(), sizeof(h.magic)) != 0) {
+                        throw checkpoint_error{"not a checkpoint file (wrong magic)"};
+                    }
+                    if (h.version != detail::checkpoint_version) {
+                        throw checkpoint_error{"unknown checkpoint file version " + std::to_string(h.version)};
+                    }
+                    if (h.layout != static_cast<uint32_t>(checkpoint_layout::array) &&
+                        h.layout != static_cast<uint32_t>(checkpoint_layout::list)) {
+                        throw checkpoint_error{"unknown checkpoint file layout " + std::to_string(h.layout)};
+                    }
+                    if (h.id_bytes != sizeof(TId) || h.value_bytes != sizeof(TValue)) {
+                        throw checkpoint_error{"checkpoint file was written with different id or value type"};
+                    }
+                    m_layout = static_cast<checkpoint_layout>(h.layout);
+
+                    const std::size_t entry_size = m_layout == checkpoint_layout::array
+                                                       ? sizeof(TValue)
+                                                       : sizeof(entry_type);
+                    if (m_mapping.size() - sizeof(detail::checkpoint_file_header) < h.entry_count * entry_size) {
+                        throw checkpoint_error{"checkpoint file too short for the entries in its header"};
+                    }
+                    m_entry_count = static_cast<std::size_t>(h.entry_count);
+                }
+
+                CheckpointIndex(const CheckpointIndex&) = delete;
+                CheckpointIndex& operator=(const CheckpointIndex&) = delete;
+
+                CheckpointIndex(CheckpointIndex&&) noexcept = default;
+                CheckpointIndex& operator=(CheckpointIndex&&) noexcept = default;
+
+                ~CheckpointIndex() noexcept override = default;
+
+                checkpoint_layout layout() const noexcept {
+                    return m_layout;
+                }
+
+                void set(const TId /*id*/, const TValue /*value*/) final {
+                    throw std::runtime_error{"can't set value in read-only checkpoint index"};
+                }
+
+                TValue get(const TId id) const final {
+                    const auto value = get_noexcept(id);
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    if (m_layout == checkpoint_layout::array) {
+                        if (id >= m_entry_count) {
+                            return osmium::index::empty_value<TValue>();
+                        }
+                        return values()[id];
+                    }
+                    const auto* const begin = entries();
+                    const auto* const end = begin + m_entry_count;
+                    const auto* const it = std::lower_bound(begin, end, id,
+                                                            [](const entry_type& entry, const TId value) {
+                        return entry.id < value;
+                    });
+                    if (it == end || it->id != id) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return it->value;
+                }
+
+                std::size_t size() const final {
+                    return m_entry_count;
+                }
+
+                std::size_t used_memory() const final {
+                    return m_mapping.size();
+                }
+
+                void clear() final {
+                    throw std::runtime_error{"can't clear read-only checkpoint index"};
+                }
+
+            }; // class CheckpointIndex
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_CHECKPOINT_HPP
@@ -54,6 +54,10 @@ namespace osmium {
                 mmap_vector_base<T>() {
             }
 
+            explicit mmap_vector_anon(const osmium::util::huge_pages hp) :
+                mmap_vector_base<T>(osmium::detail::mmap_vector_size_increment, hp) {
+            }
+
         }; // class mmap_vector_anon
 
     } // namespace detail
@@ -73,8 +73,9 @@ namespace osmium {
                 shrink_to_fit();
             }
 
-            explicit mmap_vector_base(const std::size_t capacity = mmap_vector_size_increment) :
-                m_mapping(capacity) {
+            explicit mmap_vector_base(const std::size_t capacity = mmap_vector_size_increment,
+                                      const osmium::util::huge_pages hp = osmium::util::huge_pages::none) :
+                m_mapping(capacity, hp) {
                 std::fill_n(data(), capacity, osmium::index::empty_value<T>());
             }
 
@@ -90,6 +91,29 @@ namespace osmium {
                 m_mapping.unmap();
             }
 
+            /**
+             * Advise the kernel how the memory backing this vector will
+             * be accessed, for instance sequentially for a full scan or
+             * randomly for lookups. See MemoryMapping::advise().
+             */
+            void advise(const osmium::util::memory_advice advice) const noexcept {
+                m_mapping.advise(advice);
+            }
+
+            /**
+             * Fault the given range of elements into memory in one
+             * sequential pass. Use this after opening a file-backed
+             * vector to warm it up before doing random lookups.
+             */
+            void prefault(const std::size_t offset, const std::size_t count) const noexcept {
+                m_mapping.prefault(offset, count);
+            }
+
+            /// Fault the complete vector into memory.
+            void prefault() const noexcept {
+                m_mapping.prefault();
+            }
+
             std::size_t capacity() const noexcept {
                 return m_mapping.size();
             }
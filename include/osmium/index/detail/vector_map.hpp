@@ -36,6 +36,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/index/index.hpp>
 #include <osmium/index/map.hpp>
 #include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/memory_mapping.hpp>
 
 #include <algorithm>
 #include <cstddef>
@@ -77,6 +78,10 @@ namespace osmium {
                     m_vector(fd) {
                 }
 
+                explicit VectorBasedDenseMap(osmium::util::huge_pages hp) :
+                    m_vector(hp) {
+                }
+
                 void reserve(const std::size_t size) final {
                     m_vector.reserve(size);
                 }
@@ -106,6 +111,19 @@ namespace osmium {
                     return m_vector[id];
                 }
 
+                void get_batch(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    // Issue all prefetches first so the cache misses of
+                    // the lookups can overlap, then gather the values.
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (ids[i] < m_vector.size()) {
+                            osmium::index::detail::prefetch_for_read(&m_vector[ids[i]]);
+                        }
+                    }
+                    for (std::size_t i = 0; i < count; ++i) {
+                        values[i] = get_noexcept(ids[i]);
+                    }
+                }
+
                 std::size_t size() const final {
                     return m_vector.size();
                 }
@@ -114,6 +132,27 @@ namespace osmium {
                     return m_vector.size() * sizeof(element_type);
                 }
 
+                /**
+                 * Advise the kernel how this index will be accessed,
+                 * for instance osmium::util::memory_advice::random for
+                 * point lookups. Only available for indexes backed by a
+                 * memory mapping.
+                 */
+                void advise(const osmium::util::memory_advice advice) const noexcept {
+                    m_vector.advise(advice);
+                }
+
+                /**
+                 * Fault the complete index into memory in one sequential
+                 * pass. Call this once after opening a file-backed index
+                 * to avoid paying for the page faults spread out over
+                 * millions of random lookups. Only available for indexes
+                 * backed by a memory mapping.
+                 */
+                void prefault() const noexcept {
+                    m_vector.prefault();
+                }
+
                 std::size_t used_memory() const final {
                     return sizeof(TValue) * size();
                 }
@@ -217,6 +256,58 @@ namespace osmium {
                     return result->second;
                 }
 
+                void get_batch(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    enum : std::size_t { num_lanes = 8 };
+
+                    const std::size_t size = m_vector.size();
+
+                    for (std::size_t done = 0; done < count; done += num_lanes) {
+                        const std::size_t num = std::min<std::size_t>(count - done, num_lanes);
+
+                        std::size_t lo[num_lanes];
+                        std::size_t hi[num_lanes];
+                        for (std::size_t lane = 0; lane < num; ++lane) {
+                            lo[lane] = 0;
+                            hi[lane] = size;
+                        }
+
+                        // Run the binary searches for all lanes in lockstep
+                        // and prefetch the next probe of every lane before
+                        // doing any of the comparisons, so the cache misses
+                        // of the searches can overlap.
+                        bool active = size > 0;
+                        while (active) {
+                            for (std::size_t lane = 0; lane < num; ++lane) {
+                                if (lo[lane] < hi[lane]) {
+                                    osmium::index::detail::prefetch_for_read(&m_vector[(lo[lane] + hi[lane]) / 2]);
+                                }
+                            }
+                            active = false;
+                            for (std::size_t lane = 0; lane < num; ++lane) {
+                                if (lo[lane] < hi[lane]) {
+                                    const std::size_t mid = (lo[lane] + hi[lane]) / 2;
+                                    if (m_vector[mid].first < ids[done + lane]) {
+                                        lo[lane] = mid + 1;
+                                    } else {
+                                        hi[lane] = mid;
+                                    }
+                                    if (lo[lane] < hi[lane]) {
+                                        active = true;
+                                    }
+                                }
+                            }
+                        }
+
+                        for (std::size_t lane = 0; lane < num; ++lane) {
+                            if (lo[lane] < size && m_vector[lo[lane]].first == ids[done + lane]) {
+                                values[done + lane] = m_vector[lo[lane]].second;
+                            } else {
+                                values[done + lane] = osmium::index::empty_value<TValue>();
+                            }
+                        }
+                    }
+                }
+
                 std::size_t size() const final {
                     return m_vector.size();
                 }
@@ -225,6 +316,23 @@ namespace osmium {
                     return m_vector.size() * sizeof(element_type);
                 }
 
+                /**
+                 * Advise the kernel how this index will be accessed.
+                 * Only available for indexes backed by a memory mapping.
+                 */
+                void advise(const osmium::util::memory_advice advice) const noexcept {
+                    m_vector.advise(advice);
+                }
+
+                /**
+                 * Fault the complete index into memory in one sequential
+                 * pass. Only available for indexes backed by a memory
+                 * mapping.
+                 */
+                void prefault() const noexcept {
+                    m_vector.prefault();
+                }
+
                 std::size_t used_memory() const final {
                     return sizeof(element_type) * size();
                 }
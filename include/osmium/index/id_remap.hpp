@@ -0,0 +1,275 @@
+#ifndef OSMIUM_INDEX_ID_REMAP_HPP
+#define OSMIUM_INDEX_ID_REMAP_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/nwr_array.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        /**
+         * Maps OSM object ids to new, sequentially assigned ids as used
+         * for renumbering pipelines. New ids are handed out in the order
+         * the old ids are added, starting at 1.
+         *
+         * The map exploits that ids in OSM files come (mostly) sorted:
+         * consecutive old ids mapped to consecutive new ids are stored
+         * as one run, so a typical planet or extract needs only a few
+         * entries per million objects instead of one. Lookup is a
+         * branchless binary search over the sorted runs. The rare ids
+         * added out of order (forward references in relations, way nodes
+         * missing from an extract) go into a small sorted side table.
+         *
+         * Only positive ids can be mapped.
+         */
+        class IdRemap {
+
+            struct run {
+                osmium::unsigned_object_id_type from;
+                osmium::unsigned_object_id_type to;
+                osmium::unsigned_object_id_type count;
+            };
+
+            std::vector<run> m_runs;
+
+            // Ids added out of order, kept sorted by old id.
+            std::vector<std::pair<osmium::unsigned_object_id_type, osmium::unsigned_object_id_type>> m_extra;
+
+            osmium::unsigned_object_id_type m_next_id = 1;
+
+            /**
+             * Index of the last run with from <= id, or 0 if there is
+             * none. The conditional in the loop compiles to a conditional
+             * move, so the search doesn't suffer branch mispredictions on
+             * random lookups.
+             */
+            std::size_t find_run(const osmium::unsigned_object_id_type id) const noexcept {
+                std::size_t base = 0;
+                std::size_t len = m_runs.size();
+                while (len > 1) {
+                    const std::size_t half = len / 2;
+                    base = (m_runs[base + half].from <= id) ? base + half : base;
+                    len -= half;
+                }
+                return base;
+            }
+
+            osmium::unsigned_object_id_type lookup(const osmium::unsigned_object_id_type id) const noexcept {
+                if (!m_runs.empty()) {
+                    const run& r = m_runs[find_run(id)];
+                    if (id >= r.from && id - r.from < r.count) {
+                        return r.to + (id - r.from);
+                    }
+                }
+                if (!m_extra.empty()) {
+                    const auto it = std::lower_bound(m_extra.begin(), m_extra.end(),
+                                                     std::make_pair(id, osmium::unsigned_object_id_type(0)));
+                    if (it != m_extra.end() && it->first == id) {
+                        return it->second;
+                    }
+                }
+                return 0;
+            }
+
+        public:
+
+            IdRemap() = default;
+
+            void reserve(const std::size_t size) {
+                m_runs.reserve(size);
+            }
+
+            /**
+             * Add a mapping for the given old id and return the newly
+             * assigned id. The id must not have been added before.
+             */
+            osmium::unsigned_object_id_type add(const osmium::unsigned_object_id_type id) {
+                const osmium::unsigned_object_id_type new_id = m_next_id++;
+                if (!m_runs.empty()) {
+                    run& last = m_runs.back();
+                    if (id == last.from + last.count && new_id == last.to + last.count) {
+                        ++last.count;
+                        return new_id;
+                    }
+                    if (id < last.from + last.count) {
+                        const auto it = std::lower_bound(m_extra.begin(), m_extra.end(),
+                                                         std::make_pair(id, osmium::unsigned_object_id_type(0)));
+                        m_extra.emplace(it, id, new_id);
+                        return new_id;
+                    }
+                }
+                m_runs.push_back(run{id, new_id, 1});
+                return new_id;
+            }
+
+            /**
+             * Get the new id the given old id is mapped to, assigning
+             * the next sequential id if it isn't mapped yet.
+             */
+            osmium::unsigned_object_id_type add_or_get(const osmium::unsigned_object_id_type id) {
+                const osmium::unsigned_object_id_type new_id = lookup(id);
+                if (new_id != 0) {
+                    return new_id;
+                }
+                return add(id);
+            }
+
+            /**
+             * Get the new id the given old id is mapped to.
+             *
+             * @throws osmium::not_found if the id was never added.
+             */
+            osmium::unsigned_object_id_type get(const osmium::unsigned_object_id_type id) const {
+                const osmium::unsigned_object_id_type new_id = lookup(id);
+                if (new_id == 0) {
+                    throw osmium::not_found{id};
+                }
+                return new_id;
+            }
+
+            /// Like get(), but returns 0 if the id was never added.
+            osmium::unsigned_object_id_type get_noexcept(const osmium::unsigned_object_id_type id) const noexcept {
+                return lookup(id);
+            }
+
+            /// Number of ids mapped.
+            std::size_t size() const noexcept {
+                return static_cast<std::size_t>(m_next_id) - 1;
+            }
+
+            bool empty() const noexcept {
+                return m_next_id == 1;
+            }
+
+            std::size_t used_memory() const noexcept {
+                return m_runs.capacity() * sizeof(run) +
+                       m_extra.capacity() * sizeof(decltype(m_extra)::value_type) +
+                       sizeof(IdRemap);
+            }
+
+            void clear() {
+                m_runs.clear();
+                m_runs.shrink_to_fit();
+                m_extra.clear();
+                m_extra.shrink_to_fit();
+                m_next_id = 1;
+            }
+
+        }; // class IdRemap
+
+        /**
+         * Renumbers the objects in buffers of OSM data using one IdRemap
+         * per object type. Ids and references are patched in place in the
+         * committed buffer, no objects are rebuilt, so the pass adds
+         * almost nothing to the I/O cost of a renumbering pipeline.
+         *
+         * Works like the renumbering in osmium-tool: objects get new ids
+         * in the order they are seen, references to ids that were never
+         * seen as an object (way nodes missing from an extract, forward
+         * references in relations) get the next free id of their type
+         * assigned when they are first encountered. For the usual
+         * node/way/relation file order all references except
+         * relation-on-relation forward references resolve to already
+         * assigned ids.
+         */
+        class IdRemapper {
+
+            osmium::nwr_array<IdRemap> m_maps;
+
+        public:
+
+            IdRemapper() = default;
+
+            IdRemap& index(const osmium::item_type type) noexcept {
+                return m_maps(type);
+            }
+
+            const IdRemap& index(const osmium::item_type type) const noexcept {
+                return m_maps(type);
+            }
+
+            /**
+             * Renumber all OSM objects in the buffer in place. The buffer
+             * must contain committed data.
+             */
+            void remap(osmium::memory::Buffer& buffer) {
+                for (auto& object : buffer.select<osmium::OSMObject>()) {
+                    object.set_id(static_cast<osmium::object_id_type>(
+                        m_maps(object.type()).add_or_get(object.positive_id())));
+                    if (object.type() == osmium::item_type::way) {
+                        for (auto& node_ref : static_cast<osmium::Way&>(object).nodes()) {
+                            node_ref.set_ref(static_cast<osmium::object_id_type>(
+                                m_maps.nodes().add_or_get(node_ref.positive_ref())));
+                        }
+                    } else if (object.type() == osmium::item_type::relation) {
+                        for (auto& member : static_cast<osmium::Relation&>(object).members()) {
+                            member.set_ref(static_cast<osmium::object_id_type>(
+                                m_maps(member.type()).add_or_get(member.positive_ref())));
+                        }
+                    }
+                }
+            }
+
+            std::size_t used_memory() const noexcept {
+                return m_maps.nodes().used_memory() +
+                       m_maps.ways().used_memory() +
+                       m_maps.relations().used_memory();
+            }
+
+            void clear() {
+                for (auto& map : m_maps) {
+                    map.clear();
+                }
+            }
+
+        }; // class IdRemapper
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_ID_REMAP_HPP
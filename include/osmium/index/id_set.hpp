@@ -33,15 +33,23 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/tmpfile.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/endian.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
 
 #include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <future>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <type_traits>
 #include <vector>
@@ -106,6 +114,46 @@ namespace osmium {
                 default_chunk_bits = 22U
             };
 
+            // Number of bytes read and processed in one go when scanning
+            // the bit field for set bits.
+            enum : std::size_t {
+                bit_scan_word_size = sizeof(uint64_t)
+            };
+
+            /**
+             * Load one word from the bit field. Bit n of the result
+             * corresponds to the bit for Id (8 * byte offset of data) + n,
+             * independent of the byte order of the machine.
+             */
+            inline uint64_t load_bit_scan_word(const unsigned char* data) noexcept {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+                uint64_t word = 0;
+                std::memcpy(&word, data, sizeof(word));
+                return word;
+#else
+                uint64_t word = 0;
+                for (std::size_t i = 0; i < sizeof(word); ++i) {
+                    word |= static_cast<uint64_t>(data[i]) << (i * 8U);
+                }
+                return word;
+#endif
+            }
+
+            /// Get the position of the least significant set bit.
+            inline unsigned int count_trailing_zeros(uint64_t value) noexcept {
+                assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(__builtin_ctzll(value));
+#else
+                unsigned int count = 0;
+                while ((value & 1U) == 0) {
+                    value >>= 1U;
+                    ++count;
+                }
+                return count;
+#endif
+            }
+
         } // namespace detail
 
         template <typename T, std::size_t chunk_bits = detail::default_chunk_bits>
@@ -127,27 +175,14 @@ namespace osmium {
             T m_last;
 
             void next() noexcept {
-                while (m_value != m_last && !m_set->get(m_value)) {
-                    const T cid = id_set::chunk_id(m_value);
-                    assert(cid < m_set->m_data.size());
-                    if (!m_set->m_data[cid]) {
-                        m_value = (cid + 1) << (chunk_bits + 3);
-                    } else {
-                        const auto slot = m_set->m_data[cid][id_set::offset(m_value)];
-                        if (slot == 0) {
-                            m_value += 8;
-                            m_value &= ~0x7ULL;
-                        } else {
-                            ++m_value;
-                        }
-                    }
-                }
+                m_value = m_set->find_next(m_value, m_last);
             }
 
         public:
 
             using iterator_category = std::forward_iterator_tag;
             using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
             using pointer           = value_type*;
             using reference         = value_type&;
 
@@ -240,6 +275,46 @@ namespace osmium {
                 return chunk[offset(id)];
             }
 
+            /**
+             * Find the smallest Id equal to or larger than value that is
+             * in the set. Returns last_value if there is no such Id. Scans
+             * the bit field one word at a time, skipping unallocated
+             * chunks completely.
+             *
+             * @pre last_value <= last()
+             */
+            T find_next(T value, const T last_value) const noexcept {
+                static_assert(chunk_bits >= 3U, "chunk size must be a multiple of the word size");
+
+                while (value < last_value) {
+                    const T cid = static_cast<T>(chunk_id(value));
+                    assert(cid < m_data.size());
+                    const unsigned char* chunk = m_data[cid].get();
+                    if (!chunk) {
+                        value = static_cast<T>(cid + 1) << (chunk_bits + 3U);
+                        continue;
+                    }
+
+                    std::size_t word_offset = offset(value) & ~(detail::bit_scan_word_size - 1);
+                    uint64_t word = detail::load_bit_scan_word(chunk + word_offset);
+                    word &= std::numeric_limits<uint64_t>::max() << (value & 0x3fU);
+
+                    while (word == 0 && (word_offset += detail::bit_scan_word_size) != chunk_size) {
+                        word = detail::load_bit_scan_word(chunk + word_offset);
+                    }
+
+                    if (word != 0) {
+                        const T id = (static_cast<T>(cid) << (chunk_bits + 3U)) +
+                                     static_cast<T>(word_offset * 8U + detail::count_trailing_zeros(word));
+                        return id < last_value ? id : last_value;
+                    }
+
+                    value = static_cast<T>(cid + 1) << (chunk_bits + 3U);
+                }
+
+                return last_value;
+            }
+
         public:
 
             using const_iterator = IdSetDenseIterator<T, chunk_bits>;
@@ -362,6 +437,60 @@ namespace osmium {
                 return m_data.size() * chunk_size;
             }
 
+            /**
+             * Call func with every Id in the set in the range [from, to)
+             * in ascending order. This is faster than iterating over that
+             * range with an iterator, because the word holding the current
+             * bit doesn't have to be re-read for every Id visited.
+             *
+             * @param from First Id of the range.
+             * @param to One past the last Id of the range.
+             * @param func Callable taking a single argument of type T.
+             */
+            template <typename TFunc>
+            void for_each_in_range(T from, T to, TFunc&& func) const {
+                if (to > last()) {
+                    to = last();
+                }
+
+                T value = from;
+                while (value < to) {
+                    const T cid = static_cast<T>(chunk_id(value));
+                    const unsigned char* chunk = m_data[cid].get();
+                    if (!chunk) {
+                        value = static_cast<T>(cid + 1) << (chunk_bits + 3U);
+                        continue;
+                    }
+
+                    std::size_t word_offset = offset(value) & ~(detail::bit_scan_word_size - 1);
+                    uint64_t word = detail::load_bit_scan_word(chunk + word_offset);
+                    word &= std::numeric_limits<uint64_t>::max() << (value & 0x3fU);
+
+                    while (true) {
+                        const T base = (static_cast<T>(cid) << (chunk_bits + 3U)) +
+                                       static_cast<T>(word_offset * 8U);
+                        if (base >= to) {
+                            return;
+                        }
+                        while (word != 0) {
+                            const T id = base + detail::count_trailing_zeros(word);
+                            if (id >= to) {
+                                return;
+                            }
+                            func(id);
+                            word &= word - 1;
+                        }
+                        word_offset += detail::bit_scan_word_size;
+                        if (word_offset == chunk_size) {
+                            break;
+                        }
+                        word = detail::load_bit_scan_word(chunk + word_offset);
+                    }
+
+                    value = static_cast<T>(cid + 1) << (chunk_bits + 3U);
+                }
+            }
+
             const_iterator begin() const {
                 return {this, 0, last()};
             }
@@ -503,6 +632,484 @@ namespace osmium {
 
         }; // class IdSetSmall
 
+        namespace detail {
+
+            /**
+             * Output iterator calling set() for every Id written to it.
+             */
+            template <typename T>
+            class id_set_inserter {
+
+                IdSet<T>* m_set;
+
+            public:
+
+                using iterator_category = std::output_iterator_tag;
+                using value_type        = void;
+                using difference_type   = void;
+                using pointer           = void;
+                using reference         = void;
+
+                explicit id_set_inserter(IdSet<T>& set) noexcept :
+                    m_set(&set) {
+                }
+
+                id_set_inserter& operator=(T id) {
+                    m_set->set(id);
+                    return *this;
+                }
+
+                id_set_inserter& operator*() noexcept {
+                    return *this;
+                }
+
+                id_set_inserter& operator++() noexcept {
+                    return *this;
+                }
+
+                id_set_inserter operator++(int) noexcept { // NOLINT(cert-dcl21-cpp)
+                    return *this;
+                }
+
+            }; // class id_set_inserter
+
+        } // namespace detail
+
+        /**
+         * Merge the Ids in the half-open range [first_id, last_id) from
+         * all the specified sets into the output iterator. The output is
+         * sorted and does not contain duplicates. Uses a k-way merge with
+         * a binary min-heap over the input sets, so nothing is
+         * materialized besides one cursor per input set.
+         *
+         * @pre All sets must be sorted and must not contain duplicates.
+         *      Call sort_unique() on them if you are not sure.
+         *
+         * @returns The output iterator after all Ids have been written.
+         */
+        template <typename T, typename TOutputIterator>
+        TOutputIterator merge_sorted(const std::vector<const IdSetSmall<T>*>& sets, TOutputIterator out, T first_id, T last_id) {
+            using input_iterator = typename IdSetSmall<T>::const_iterator;
+
+            struct cursor {
+                input_iterator current;
+                input_iterator end;
+            };
+
+            const auto greater = [](const cursor& lhs, const cursor& rhs) {
+                return *lhs.current > *rhs.current;
+            };
+
+            std::vector<cursor> heap;
+            heap.reserve(sets.size());
+            for (const IdSetSmall<T>* set : sets) {
+                assert(set);
+                const auto begin = std::lower_bound(set->cbegin(), set->cend(), first_id);
+                const auto end = std::lower_bound(begin, set->cend(), last_id);
+                if (begin != end) {
+                    heap.push_back(cursor{begin, end});
+                }
+            }
+            std::make_heap(heap.begin(), heap.end(), greater);
+
+            bool is_first = true;
+            T last_written = 0;
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), greater);
+                cursor& c = heap.back();
+                const T id = *c.current;
+                if (is_first || id != last_written) {
+                    *out++ = id;
+                    last_written = id;
+                    is_first = false;
+                }
+                ++c.current;
+                if (c.current == c.end) {
+                    heap.pop_back();
+                } else {
+                    std::push_heap(heap.begin(), heap.end(), greater);
+                }
+            }
+
+            return out;
+        }
+
+        /**
+         * Merge the Ids from all the specified sets into the output
+         * iterator. The output is sorted and does not contain duplicates.
+         *
+         * @pre All sets must be sorted and must not contain duplicates.
+         *      Call sort_unique() on them if you are not sure.
+         *
+         * @returns The output iterator after all Ids have been written.
+         */
+        template <typename T, typename TOutputIterator>
+        TOutputIterator merge_sorted(const std::vector<const IdSetSmall<T>*>& sets, TOutputIterator out) {
+            return merge_sorted(sets, out, T{0}, std::numeric_limits<T>::max());
+        }
+
+        /**
+         * Merge the Ids from all the specified sets into an IdSetDense
+         * without materializing any intermediate sets.
+         *
+         * @pre All sets must be sorted and must not contain duplicates.
+         *      Call sort_unique() on them if you are not sure.
+         */
+        template <typename T>
+        void merge_sorted(const std::vector<const IdSetSmall<T>*>& sets, IdSetDense<T>& result) {
+            merge_sorted(sets, detail::id_set_inserter<T>{result});
+        }
+
+        /**
+         * Merge the Ids from all the specified sets into a new
+         * IdSetSmall, splitting the Id range over the threads of the
+         * specified pool. Each thread merges one Id range, the ranges
+         * are chosen from the quantiles of the largest input set, the
+         * per-range results are simply concatenated because the ranges
+         * are disjoint.
+         *
+         * @pre All sets must be sorted and must not contain duplicates.
+         *      Call sort_unique() on them if you are not sure.
+         */
+        template <typename T>
+        IdSetSmall<T> merge_sorted(const std::vector<const IdSetSmall<T>*>& sets, osmium::thread::Pool& pool) {
+            IdSetSmall<T> result;
+
+            const IdSetSmall<T>* largest = nullptr;
+            for (const IdSetSmall<T>* set : sets) {
+                assert(set);
+                if (!largest || set->size() > largest->size()) {
+                    largest = set;
+                }
+            }
+
+            const auto num_parts = static_cast<std::size_t>(pool.num_threads());
+            if (!largest || largest->size() < 2 || num_parts < 2) {
+                merge_sorted(sets, detail::id_set_inserter<T>{result});
+                return result;
+            }
+
+            // Split points from the quantiles of the largest set. Empty
+            // ranges for some threads just mean less parallelism.
+            std::vector<T> bounds;
+            bounds.reserve(num_parts + 1);
+            bounds.push_back(0);
+            for (std::size_t i = 1; i < num_parts; ++i) {
+                const T split = *(largest->cbegin() + static_cast<std::ptrdiff_t>(largest->size() * i / num_parts));
+                if (split > bounds.back()) {
+                    bounds.push_back(split);
+                }
+            }
+            bounds.push_back(std::numeric_limits<T>::max());
+
+            std::vector<std::future<std::vector<T>>> results;
+            results.reserve(bounds.size() - 1);
+            for (std::size_t i = 0; i < bounds.size() - 1; ++i) {
+                const T from = bounds[i];
+                const T to = bounds[i + 1];
+                results.push_back(pool.submit([&sets, from, to]() {
+                    std::vector<T> ids;
+                    merge_sorted(sets, std::back_inserter(ids), from, to);
+                    return ids;
+                }));
+            }
+
+            for (auto& future : results) {
+                for (const T id : future.get()) {
+                    result.set(id);
+                }
+            }
+
+            return result;
+        }
+
+        /**
+         * A set of Ids stored as a bit field in a file, with only a small
+         * cache of hot chunks mapped into memory. Use this instead of
+         * IdSetDense when many sets are needed at the same time and they
+         * do not all fit into memory, for instance when tracking the Ids
+         * for many extracts at once.
+         *
+         * The file is divided into chunks of 2^chunk_bits bits each. A
+         * chunk is mapped into memory when an Id in it is accessed and
+         * unmapped again when its direct-mapped cache slot is needed for
+         * another chunk, so the memory use is bounded by the number of
+         * cache slots regardless of how large the Id space is. By
+         * default the set works on an unnamed temporary file that is
+         * deleted automatically.
+         *
+         * Accessing the set can do file I/O and is much slower than the
+         * in-memory sets, especially when accesses alternate between
+         * more chunks than there are cache slots.
+         */
+        template <typename T, std::size_t chunk_bits = detail::default_chunk_bits>
+        class ExternalIdSet : public IdSet<T> {
+
+            static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
+            static_assert(sizeof(T) >= 4, "Needs at least 32bit type");
+            static_assert(chunk_bits >= 16, "chunk_bits must be at least 16 so chunks start on page boundaries");
+
+            enum : std::size_t {
+                chunk_size = 1ULL << (chunk_bits - 3U),
+                default_cache_chunks = 8U
+            };
+
+            constexpr static const std::size_t invalid_chunk = std::numeric_limits<std::size_t>::max();
+
+            struct cached_chunk {
+                std::size_t id = invalid_chunk;
+                std::unique_ptr<osmium::util::MemoryMapping> mapping{};
+            };
+
+            int m_fd;
+
+            /// Number of chunks the file holds, chunks beyond this read as all-zero.
+            mutable std::size_t m_file_chunks;
+
+            std::size_t m_count = 0;
+
+            // The cache state changes on lookups, too, so it is mutable.
+            mutable std::vector<cached_chunk> m_cache;
+
+            static std::size_t chunk_id(const T id) noexcept {
+                return static_cast<std::size_t>(id >> chunk_bits);
+            }
+
+            static std::size_t chunk_offset(const T id) noexcept {
+                return static_cast<std::size_t>(id & ((1ULL << chunk_bits) - 1U)) >> 3U;
+            }
+
+            static unsigned char bitmask(const T id) noexcept {
+                return static_cast<unsigned char>(1U << (id & 0x07U));
+            }
+
+            /**
+             * Get the in-memory address of the chunk, mapping it and, if
+             * needed, growing the file first. New chunks read as all-zero
+             * which means "not in the set".
+             */
+            unsigned char* chunk_data(const std::size_t chunk) const {
+                cached_chunk& cached = m_cache[chunk % m_cache.size()];
+                if (cached.id != chunk) {
+                    cached.mapping.reset(); // unmapping flushes the shared mapping
+                    cached.id = invalid_chunk;
+                    if (chunk >= m_file_chunks) {
+                        osmium::resize_file(m_fd, (chunk + 1) * chunk_size);
+                        m_file_chunks = chunk + 1;
+                    }
+                    cached.mapping.reset(new osmium::util::MemoryMapping{chunk_size,
+                                                                         osmium::util::MemoryMapping::mapping_mode::write_shared,
+                                                                         m_fd,
+                                                                         static_cast<off_t>(chunk * chunk_size)});
+                    cached.id = chunk;
+                }
+                return static_cast<unsigned char*>(cached.mapping->get_addr());
+            }
+
+        public:
+
+            /**
+             * @param fd File descriptor of the (usually empty) file the
+             *        bit field is stored in.
+             * @param cache_chunks Number of chunks kept mapped in memory.
+             */
+            explicit ExternalIdSet(const int fd, const std::size_t cache_chunks = default_cache_chunks) :
+                m_fd(fd),
+                m_file_chunks(osmium::file_size(fd) / chunk_size),
+                m_cache(cache_chunks > 0 ? cache_chunks : 1) {
+            }
+
+            /// Create a set backed by an unnamed temporary file.
+            explicit ExternalIdSet(const std::size_t cache_chunks = default_cache_chunks) :
+                ExternalIdSet(osmium::detail::create_tmp_file(), cache_chunks) {
+            }
+
+            ExternalIdSet(const ExternalIdSet&) = delete;
+            ExternalIdSet& operator=(const ExternalIdSet&) = delete;
+
+            ExternalIdSet(ExternalIdSet&&) = delete;
+            ExternalIdSet& operator=(ExternalIdSet&&) = delete;
+
+            ~ExternalIdSet() noexcept override = default;
+
+            /**
+             * Add the Id to the set if it is not already in there.
+             *
+             * @returns true if the Id was added, false if it was already set.
+             */
+            bool check_and_set(const T id) {
+                unsigned char& byte = chunk_data(chunk_id(id))[chunk_offset(id)];
+                if ((byte & bitmask(id)) == 0) {
+                    byte |= bitmask(id);
+                    ++m_count;
+                    return true;
+                }
+                return false;
+            }
+
+            void set(const T id) final {
+                check_and_set(id);
+            }
+
+            /**
+             * Is the Id in the set? Looking at a chunk that is not in the
+             * cache does file I/O. If an I/O error happens, the Id is
+             * reported as not in the set.
+             */
+            bool get(const T id) const noexcept final {
+                if (chunk_id(id) >= m_file_chunks) {
+                    return false;
+                }
+                try {
+                    return (chunk_data(chunk_id(id))[chunk_offset(id)] & bitmask(id)) != 0;
+                } catch (...) {
+                    return false;
+                }
+            }
+
+            /**
+             * The number of Ids in the set.
+             */
+            std::size_t size() const noexcept {
+                return m_count;
+            }
+
+            bool empty() const final {
+                return m_count == 0;
+            }
+
+            void clear() final {
+                for (auto& cached : m_cache) {
+                    cached.mapping.reset();
+                    cached.id = invalid_chunk;
+                }
+                osmium::resize_file(m_fd, 0);
+                m_file_chunks = 0;
+                m_count = 0;
+            }
+
+            std::size_t used_memory() const noexcept final {
+                return m_cache.size() * chunk_size + sizeof(ExternalIdSet);
+            }
+
+        }; // class ExternalIdSet
+
+        /**
+         * IdSet wrapper that fronts any IdSet implementation with a small
+         * Bloom filter. Negative membership tests, which make up almost
+         * all of the tests when cutting extracts from a planet file, are
+         * answered from the filter with a single cache line access,
+         * without touching the (much larger) wrapped set.
+         *
+         * Both probe bits of an Id always fall into the same filter word,
+         * so a miss costs exactly one memory access. The filter can
+         * return false positives, those fall through to the wrapped set,
+         * so results are always exact.
+         *
+         * @tparam T Id type, usually osmium::unsigned_object_id_type.
+         * @tparam TIdSet The wrapped set type, must derive from IdSet<T>.
+         * @tparam filter_bits Log2 of the number of bits in the filter.
+         *         The default of 21 makes the filter 256 kB which fits
+         *         into the L2 cache of most CPUs.
+         */
+        template <typename T, typename TIdSet = IdSetDense<T>, std::size_t filter_bits = 21>
+        class IdSetWithFilter : public IdSet<T> {
+
+            static_assert(filter_bits >= 6 && filter_bits < 32, "filter_bits out of range");
+
+            enum : std::size_t {
+                num_filter_words = (1ULL << filter_bits) / 64U
+            };
+
+            std::vector<uint64_t> m_filter;
+            TIdSet m_set;
+
+            static uint64_t hash(const T id) noexcept {
+                uint64_t h = static_cast<uint64_t>(id);
+                h *= 0x9e3779b97f4a7c15ULL;
+                h ^= h >> 32U;
+                return h;
+            }
+
+            static std::size_t filter_word(const uint64_t h) noexcept {
+                return static_cast<std::size_t>((h >> 12U) & (num_filter_words - 1));
+            }
+
+            static uint64_t filter_mask(const uint64_t h) noexcept {
+                return (1ULL << (h & 63U)) | (1ULL << ((h >> 6U) & 63U));
+            }
+
+        public:
+
+            IdSetWithFilter() :
+                m_filter(num_filter_words, 0) {
+            }
+
+            IdSetWithFilter(const IdSetWithFilter&) = default;
+            IdSetWithFilter& operator=(const IdSetWithFilter&) = default;
+
+            IdSetWithFilter(IdSetWithFilter&&) noexcept = default;
+            IdSetWithFilter& operator=(IdSetWithFilter&&) noexcept = default;
+
+            ~IdSetWithFilter() noexcept override = default;
+
+            /**
+             * Add the given Id to the set.
+             */
+            void set(T id) final {
+                const auto h = hash(id);
+                m_filter[filter_word(h)] |= filter_mask(h);
+                m_set.set(id);
+            }
+
+            /**
+             * Is the Id in the set? Checks the filter first, only filter
+             * hits are looked up in the wrapped set.
+             */
+            bool get(T id) const noexcept final {
+                const auto h = hash(id);
+                const auto mask = filter_mask(h);
+                if ((m_filter[filter_word(h)] & mask) != mask) {
+                    return false;
+                }
+                return m_set.get(id);
+            }
+
+            /**
+             * Is the set empty?
+             */
+            bool empty() const final {
+                return m_set.empty();
+            }
+
+            /**
+             * Clear the set.
+             */
+            void clear() final {
+                std::fill(m_filter.begin(), m_filter.end(), 0);
+                m_set.clear();
+            }
+
+            std::size_t used_memory() const noexcept final {
+                return m_filter.capacity() * sizeof(uint64_t) + m_set.used_memory();
+            }
+
+            /**
+             * Access the wrapped set. Do not add Ids through this
+             * reference, they would be missing from the filter and
+             * lookups through the wrapper would not find them.
+             */
+            TIdSet& id_set() noexcept {
+                return m_set;
+            }
+
+            /// Access the wrapped set.
+            const TIdSet& id_set() const noexcept {
+                return m_set;
+            }
+
+        }; // class IdSetWithFilter
+
     } // namespace index
 
 } // namespace osmium
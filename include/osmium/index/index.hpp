@@ -90,6 +90,24 @@ namespace osmium {
             return std::numeric_limits<size_t>::max();
         }
 
+        namespace detail {
+
+            /**
+             * Hint to the CPU that the cache line containing addr will
+             * be read soon. Does nothing on compilers without prefetch
+             * support. Prefetching an invalid address is allowed, it
+             * will never fault.
+             */
+            inline void prefetch_for_read(const void* addr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch(addr, 0);
+#else
+                (void)addr;
+#endif
+            }
+
+        } // namespace detail
+
     } // namespace index
 
 } // namespace osmium
@@ -146,6 +146,29 @@ namespace osmium {
                  */
                 virtual TValue get_noexcept(const TId id) const noexcept = 0;
 
+                /**
+                 * Retrieve values for a batch of ids. For each id the
+                 * corresponding entry in the values array is set to the
+                 * value from the index or, if not found, to the empty value
+                 * (same rules as for get_noexcept()).
+                 *
+                 * Implementations can overlap the memory accesses for the
+                 * whole batch, for instance using software prefetching,
+                 * which is usually much faster than looking up ids one by
+                 * one in an index that doesn't fit into the CPU caches. The
+                 * default implementation simply calls get_noexcept() in a
+                 * loop.
+                 *
+                 * @param ids Pointer to count ids to look for.
+                 * @param count Number of ids.
+                 * @param values Pointer to space for count values.
+                 */
+                virtual void get_batch(const TId* ids, const std::size_t count, TValue* values) const noexcept {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        values[i] = get_noexcept(ids[i]);
+                    }
+                }
+
                 /**
                  * Get the approximate number of items in the storage. The storage
                  * might allocate memory in blocks, so this size might not be
@@ -0,0 +1,442 @@
+#ifndef OSMIUM_INDEX_MAP_DENSE_FILE_CACHE_ARRAY_HPP
+#define OSMIUM_INDEX_MAP_DENSE_FILE_CACHE_ARRAY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/create_map_with_fd.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/file.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+# include <unistd.h>
+#endif
+
+#define OSMIUM_HAS_INDEX_MAP_DENSE_FILE_CACHE_ARRAY
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * Dense index backed by a file, keeping only a fixed-size cache
+             * of file blocks in memory. In contrast to DenseFileArray, which
+             * mmaps the whole file, this class has a bounded memory
+             * footprint, so the rest of the RAM stays available as working
+             * set for whatever else is going on.
+             *
+             * Blocks are cached direct-mapped. A dirty block evicted from
+             * the cache is written back asynchronously so the next block can
+             * be read while the write is still in flight. Optionally the
+             * file can be accessed with O_DIRECT (on systems supporting it),
+             * bypassing the page cache completely.
+             *
+             * Note that get() and get_noexcept() do file I/O and can be
+             * slow. If an I/O error happens in get_noexcept(), it is
+             * reported as "not found".
+             */
+            template <typename TId, typename TValue>
+            class DenseFileCacheArray : public Map<TId, TValue> {
+
+                enum : std::size_t {
+                    block_size_bytes = 64UL * 1024UL, // must be a multiple of the O_DIRECT alignment
+                    buffer_alignment = 4096UL,
+                    default_cache_blocks = 1024UL // 64 MB cache
+                };
+
+                static_assert(block_size_bytes % sizeof(TValue) == 0,
+                              "block size must be a multiple of the value size");
+
+                enum : std::size_t {
+                    block_entries = block_size_bytes / sizeof(TValue)
+                };
+
+                constexpr static const std::size_t invalid_block = std::numeric_limits<std::size_t>::max();
+
+                /**
+                 * Block-sized buffer aligned for O_DIRECT. Alignment is done
+                 * manually, because C++11 has no portable aligned allocation.
+                 */
+                class AlignedBuffer {
+
+                    std::unique_ptr<char[]> m_raw{};
+                    TValue* m_data = nullptr;
+
+                public:
+
+                    void allocate() {
+                        m_raw.reset(new char[block_size_bytes + buffer_alignment]);
+                        auto addr = reinterpret_cast<std::uintptr_t>(m_raw.get());
+                        addr = (addr + buffer_alignment - 1) & ~static_cast<std::uintptr_t>(buffer_alignment - 1);
+                        m_data = reinterpret_cast<TValue*>(addr);
+                    }
+
+                    explicit operator bool() const noexcept {
+                        return m_data != nullptr;
+                    }
+
+                    TValue* data() const noexcept {
+                        return m_data;
+                    }
+
+                    void swap(AlignedBuffer& other) noexcept {
+                        using std::swap;
+                        swap(m_raw, other.m_raw);
+                        swap(m_data, other.m_data);
+                    }
+
+                }; // class AlignedBuffer
+
+                struct CacheBlock {
+                    std::size_t id = invalid_block;
+                    bool dirty = false;
+                    AlignedBuffer buffer{};
+                };
+
+                int m_fd;
+                std::size_t m_num_blocks;
+                std::size_t m_size = 0;
+
+                // The cache state changes on lookups, too, so it is mutable.
+                mutable std::vector<CacheBlock> m_cache;
+                mutable AlignedBuffer m_empty_block{};
+
+                /// Number of blocks the file definitely contains, used to fill holes with the empty value.
+                mutable std::size_t m_file_blocks = 0;
+
+#ifndef _WIN32
+                mutable std::future<void> m_pending_write{};
+                mutable std::size_t m_pending_block = invalid_block;
+#endif
+                mutable AlignedBuffer m_spare{};
+
+                static void pwrite_all(const int fd, const char* data, const std::size_t size, const std::size_t offset) {
+#ifdef _WIN32
+                    if (::_lseeki64(fd, static_cast<int64_t>(offset), SEEK_SET) < 0) {
+                        throw std::system_error{errno, std::system_category(), "Seek failed"};
+                    }
+                    osmium::io::detail::reliable_write(fd, data, size);
+#else
+                    std::size_t done = 0;
+                    while (done < size) {
+                        const auto length = ::pwrite(fd, data + done, size - done, static_cast<off_t>(offset + done));
+                        if (length < 0) {
+                            if (errno == EINTR) {
+                                continue;
+                            }
+                            throw std::system_error{errno, std::system_category(), "Write failed"};
+                        }
+                        done += static_cast<std::size_t>(length);
+                    }
+#endif
+                }
+
+                /// Read up to size bytes, stopping at EOF. Returns the number of bytes read.
+                static std::size_t pread_some(const int fd, char* data, const std::size_t size, const std::size_t offset) {
+#ifdef _WIN32
+                    if (::_lseeki64(fd, static_cast<int64_t>(offset), SEEK_SET) < 0) {
+                        throw std::system_error{errno, std::system_category(), "Seek failed"};
+                    }
+                    std::size_t done = 0;
+                    while (done < size) {
+                        const auto length = ::_read(fd, data + done, static_cast<unsigned int>(size - done));
+#else
+                    std::size_t done = 0;
+                    while (done < size) {
+                        const auto length = ::pread(fd, data + done, size - done, static_cast<off_t>(offset + done));
+#endif
+                        if (length < 0) {
+                            if (errno == EINTR) {
+                                continue;
+                            }
+                            throw std::system_error{errno, std::system_category(), "Read failed"};
+                        }
+                        if (length == 0) { // EOF
+                            break;
+                        }
+                        done += static_cast<std::size_t>(length);
+                    }
+                    return done;
+                }
+
+                void wait_for_pending_write() const {
+#ifndef _WIN32
+                    if (m_pending_write.valid()) {
+                        m_pending_write.get(); // rethrows a failed write
+                        m_pending_block = invalid_block;
+                    }
+#endif
+                }
+
+                const AlignedBuffer& empty_block() const {
+                    if (!m_empty_block) {
+                        m_empty_block.allocate();
+                        std::fill_n(m_empty_block.data(), block_entries, osmium::index::empty_value<TValue>());
+                    }
+                    return m_empty_block;
+                }
+
+                /**
+                 * Make sure all blocks before block_id exist in the file,
+                 * filled with the empty value. A hole left by the filesystem
+                 * would read back as zeros, which is not necessarily the
+                 * empty value.
+                 */
+                void materialize_up_to(const std::size_t block_id) const {
+                    while (m_file_blocks < block_id) {
+                        pwrite_all(m_fd, reinterpret_cast<const char*>(empty_block().data()), block_size_bytes, m_file_blocks * block_size_bytes);
+                        ++m_file_blocks;
+                    }
+                }
+
+                /// Write back a dirty block, asynchronously where possible. The block contents are invalid afterwards.
+                void write_back(CacheBlock& block) const {
+                    materialize_up_to(block.id);
+#ifdef _WIN32
+                    pwrite_all(m_fd, reinterpret_cast<const char*>(block.buffer.data()), block_size_bytes, block.id * block_size_bytes);
+#else
+                    wait_for_pending_write();
+                    if (!m_spare) {
+                        m_spare.allocate();
+                    }
+                    // Hand the dirty buffer over to the writer and give the
+                    // (now unused) spare buffer to the cache block.
+                    block.buffer.swap(m_spare);
+                    m_pending_block = block.id;
+                    const int fd = m_fd;
+                    const char* data = reinterpret_cast<const char*>(m_spare.data());
+                    const std::size_t offset = block.id * block_size_bytes;
+                    m_pending_write = std::async(std::launch::async, [fd, data, offset]() {
+                        pwrite_all(fd, data, block_size_bytes, offset);
+                    });
+#endif
+                    if (block.id >= m_file_blocks) {
+                        m_file_blocks = block.id + 1;
+                    }
+                    block.dirty = false;
+                }
+
+                CacheBlock& load_block(const std::size_t block_id) const {
+                    CacheBlock& block = m_cache[block_id % m_num_blocks];
+                    if (block.id == block_id) {
+                        return block;
+                    }
+
+                    if (!block.buffer) {
+                        block.buffer.allocate();
+                    }
+                    if (block.dirty) {
+                        write_back(block);
+                    }
+#ifndef _WIN32
+                    if (m_pending_block == block_id) {
+                        wait_for_pending_write();
+                    }
+#endif
+                    block.id = block_id;
+                    block.dirty = false;
+
+                    const std::size_t got = pread_some(m_fd, reinterpret_cast<char*>(block.buffer.data()), block_size_bytes, block_id * block_size_bytes);
+                    std::fill(block.buffer.data() + got / sizeof(TValue), block.buffer.data() + block_entries, osmium::index::empty_value<TValue>());
+
+                    return block;
+                }
+
+            public:
+
+                /**
+                 * @param fd File descriptor of the (usually empty) index file.
+                 * @param direct_io Try to enable O_DIRECT on the file. This
+                 *        is best effort: If the system or filesystem doesn't
+                 *        support it, normal buffered I/O is used.
+                 * @param cache_blocks Number of 64 kB blocks to cache in memory.
+                 */
+                explicit DenseFileCacheArray(const int fd, const bool direct_io = false, const std::size_t cache_blocks = default_cache_blocks) :
+                    m_fd(fd),
+                    m_num_blocks(cache_blocks > 0 ? cache_blocks : 1),
+                    m_cache(m_num_blocks) {
+                    const std::size_t file_size = osmium::file_size(fd);
+                    m_size = file_size / sizeof(TValue);
+                    m_file_blocks = file_size / block_size_bytes;
+
+                    // Pad a partly filled last block with the empty value,
+                    // so all later I/O is block-aligned (needed for O_DIRECT).
+                    const std::size_t partial = file_size % block_size_bytes;
+                    if (partial > 0) {
+                        pwrite_all(m_fd, reinterpret_cast<const char*>(empty_block().data()) + partial, block_size_bytes - partial, file_size);
+                        ++m_file_blocks;
+                    }
+
+#if defined(O_DIRECT) && !defined(_WIN32)
+                    if (direct_io) {
+                        const int flags = ::fcntl(m_fd, F_GETFL);
+                        if (flags != -1) {
+                            ::fcntl(m_fd, F_SETFL, flags | O_DIRECT); // NOLINT(hicpp-signed-bitwise)
+                        }
+                    }
+#else
+                    (void)direct_io;
+#endif
+                }
+
+                DenseFileCacheArray() :
+                    DenseFileCacheArray(osmium::detail::create_tmp_file()) {
+                }
+
+                DenseFileCacheArray(const DenseFileCacheArray&) = delete;
+                DenseFileCacheArray& operator=(const DenseFileCacheArray&) = delete;
+
+                DenseFileCacheArray(DenseFileCacheArray&&) = delete;
+                DenseFileCacheArray& operator=(DenseFileCacheArray&&) = delete;
+
+                ~DenseFileCacheArray() noexcept override {
+                    try {
+                        flush();
+                    } catch (...) { // NOLINT(bugprone-empty-catch)
+                        // Ignore errors, we can't do anything about them here.
+                    }
+                }
+
+                /// Write all dirty blocks back to the file and wait for pending writes.
+                void flush() {
+                    wait_for_pending_write();
+                    for (auto& block : m_cache) {
+                        if (block.id != invalid_block && block.dirty) {
+                            materialize_up_to(block.id);
+                            pwrite_all(m_fd, reinterpret_cast<const char*>(block.buffer.data()), block_size_bytes, block.id * block_size_bytes);
+                            if (block.id >= m_file_blocks) {
+                                m_file_blocks = block.id + 1;
+                            }
+                            block.dirty = false;
+                        }
+                    }
+                }
+
+                void set(const TId id, const TValue value) final {
+                    auto& block = load_block(id / block_entries);
+                    block.buffer.data()[id % block_entries] = value;
+                    block.dirty = true;
+                    if (id >= m_size) {
+                        m_size = id + 1;
+                    }
+                }
+
+                TValue get(const TId id) const final {
+                    if (id >= m_size) {
+                        throw osmium::not_found{id};
+                    }
+                    const TValue value = load_block(id / block_entries).buffer.data()[id % block_entries];
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    if (id >= m_size) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    try {
+                        return load_block(id / block_entries).buffer.data()[id % block_entries];
+                    } catch (...) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                }
+
+                std::size_t size() const final {
+                    return m_size;
+                }
+
+                std::size_t used_memory() const final {
+                    return m_num_blocks * block_size_bytes;
+                }
+
+                void clear() final {
+                    wait_for_pending_write();
+                    m_cache.clear();
+                    m_cache.shrink_to_fit();
+                    m_size = 0;
+                }
+
+                void dump_as_array(const int fd) final {
+                    flush();
+                    AlignedBuffer scratch;
+                    scratch.allocate();
+                    std::size_t offset = 0;
+                    const std::size_t total = m_size * sizeof(TValue);
+                    while (offset < total) {
+                        const std::size_t want = std::min<std::size_t>(block_size_bytes, total - offset);
+                        const std::size_t got = pread_some(m_fd, reinterpret_cast<char*>(scratch.data()), want, offset);
+                        std::fill(scratch.data() + got / sizeof(TValue), scratch.data() + want / sizeof(TValue), osmium::index::empty_value<TValue>());
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(scratch.data()), want);
+                        offset += want;
+                    }
+                }
+
+            }; // class DenseFileCacheArray
+
+            template <typename TId, typename TValue>
+            struct create_map<TId, TValue, DenseFileCacheArray> {
+                DenseFileCacheArray<TId, TValue>* operator()(const std::vector<std::string>& config) {
+                    return osmium::index::detail::create_map_with_fd<DenseFileCacheArray<TId, TValue>>(config);
+                }
+            };
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseFileCacheArray, dense_file_cache_array)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_DENSE_FILE_CACHE_ARRAY_HPP
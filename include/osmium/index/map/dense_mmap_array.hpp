@@ -37,6 +37,10 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/index/detail/mmap_vector_anon.hpp> // IWYU pragma: keep
 #include <osmium/index/detail/vector_map.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <string>
+#include <vector>
 
 #define OSMIUM_HAS_INDEX_MAP_DENSE_MMAP_ARRAY
 
@@ -49,6 +53,23 @@ namespace osmium {
             template <typename TId, typename TValue>
             using DenseMmapArray = VectorBasedDenseMap<osmium::detail::mmap_vector_anon<TValue>, TId, TValue>;
 
+            template <typename TId, typename TValue>
+            struct create_map<TId, TValue, DenseMmapArray> {
+                DenseMmapArray<TId, TValue>* operator()(const std::vector<std::string>& config) {
+                    auto hp = osmium::util::huge_pages::none;
+                    if (config.size() > 1) {
+                        if (config[1] == "hugetlb") {
+                            hp = osmium::util::huge_pages::hugetlb;
+                        } else if (config[1] == "hugepages") {
+                            hp = osmium::util::huge_pages::transparent;
+                        } else if (!config[1].empty()) {
+                            throw map_factory_error{"Unknown option '" + config[1] + "' for map type 'dense_mmap_array'"};
+                        }
+                    }
+                    return new DenseMmapArray<TId, TValue>{hp};
+                }
+            };
+
         } // namespace map
 
     } // namespace index
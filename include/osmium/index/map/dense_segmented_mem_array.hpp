@@ -0,0 +1,180 @@
+#ifndef OSMIUM_INDEX_MAP_DENSE_SEGMENTED_MEM_ARRAY_HPP
+#define OSMIUM_INDEX_MAP_DENSE_SEGMENTED_MEM_ARRAY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_DENSE_SEGMENTED_MEM_ARRAY
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * A piecewise-dense index. The id space is divided into
+             * segments of 2^20 ids; a directory maps the segment of an
+             * id to its storage, which is a plain array indexed by the
+             * offset of the id within the segment, so every access is
+             * still O(1) with one extra indirection compared to
+             * DenseMemArray or DenseMmapArray.
+             *
+             * Unlike those classes, which size their array by the
+             * largest id ever set, only touched segments get storage
+             * here. That makes this index the right choice when the ids
+             * cluster in ranges far apart: synthetic area ids (twice
+             * the relation id plus one, see osmium/osm/area.hpp),
+             * negative ids mapped to the high end of the id space, or
+             * test fixtures with a few huge ids. A single large id
+             * costs one directory slot and one segment, not gigabytes
+             * of zero pages and the TLB entries to back them.
+             */
+            template <typename TId, typename TValue>
+            class DenseSegmentedMemArray : public osmium::index::map::Map<TId, TValue> {
+
+                enum {
+                    bits = 20
+                };
+
+                enum : std::uint64_t {
+                    segment_size = 1ULL << bits,
+                    offset_mask = segment_size - 1
+                };
+
+                enum : std::uint32_t {
+                    no_segment = 0
+                };
+
+                /// Maps id >> bits to (index into m_segments) + 1, no_segment if untouched.
+                std::vector<std::uint32_t> m_directory;
+
+                /// Each segment is grown only up to the largest offset set in it.
+                std::vector<std::vector<TValue>> m_segments;
+
+                const std::vector<TValue>* find_segment(const TId id) const noexcept {
+                    const std::uint64_t segment = id >> bits;
+                    if (segment >= m_directory.size() || m_directory[segment] == no_segment) {
+                        return nullptr;
+                    }
+                    return &m_segments[m_directory[segment] - 1];
+                }
+
+            public:
+
+                DenseSegmentedMemArray() = default;
+
+                DenseSegmentedMemArray(const DenseSegmentedMemArray&) = default;
+                DenseSegmentedMemArray& operator=(const DenseSegmentedMemArray&) = default;
+
+                DenseSegmentedMemArray(DenseSegmentedMemArray&&) noexcept = default;
+                DenseSegmentedMemArray& operator=(DenseSegmentedMemArray&&) noexcept = default;
+
+                ~DenseSegmentedMemArray() noexcept override = default;
+
+                void set(const TId id, const TValue value) final {
+                    const std::uint64_t segment = id >> bits;
+                    if (segment >= m_directory.size()) {
+                        m_directory.resize(segment + 1, no_segment);
+                    }
+                    if (m_directory[segment] == no_segment) {
+                        m_segments.emplace_back();
+                        m_directory[segment] = static_cast<std::uint32_t>(m_segments.size());
+                    }
+                    std::vector<TValue>& values = m_segments[m_directory[segment] - 1];
+                    const std::size_t offset = id & offset_mask;
+                    if (offset >= values.size()) {
+                        values.resize(offset + 1, osmium::index::empty_value<TValue>());
+                    }
+                    values[offset] = value;
+                }
+
+                TValue get(const TId id) const final {
+                    const TValue value = get_noexcept(id);
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    const auto* values = find_segment(id);
+                    const std::size_t offset = id & offset_mask;
+                    if (!values || offset >= values->size()) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return (*values)[offset];
+                }
+
+                std::size_t size() const final {
+                    std::size_t sum = 0;
+                    for (const auto& values : m_segments) {
+                        sum += values.size();
+                    }
+                    return sum;
+                }
+
+                std::size_t used_memory() const final {
+                    std::size_t sum = m_directory.capacity() * sizeof(std::uint32_t);
+                    for (const auto& values : m_segments) {
+                        sum += values.capacity() * sizeof(TValue);
+                    }
+                    return sum;
+                }
+
+                void clear() final {
+                    m_directory.clear();
+                    m_directory.shrink_to_fit();
+                    m_segments.clear();
+                    m_segments.shrink_to_fit();
+                }
+
+            }; // class DenseSegmentedMemArray
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseSegmentedMemArray, dense_segmented_mem_array)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_DENSE_SEGMENTED_MEM_ARRAY_HPP
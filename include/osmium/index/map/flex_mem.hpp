@@ -33,12 +33,17 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/mmap_vector_file.hpp>
 #include <osmium/index/index.hpp>
 #include <osmium/index/map.hpp>
+#include <osmium/util/config.hpp>
+#include <osmium/util/memory.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -52,10 +57,17 @@ namespace osmium {
 
             /**
              * This is an autoscaling index that works well with small and
-             * large input data. All data will be held in memory. For small
-             * input data a sparse array will be used, if this becomes
-             * inefficient, the class will switch automatically to a dense
-             * index.
+             * large input data. For small input data a sparse array will be
+             * used, if this becomes inefficient, the class will switch
+             * automatically to a dense index.
+             *
+             * Normally all data is held in memory. If a memory limit is set
+             * (either with set_memory_limit() or through the environment
+             * variable OSMIUM_FLEX_MEM_LIMIT, in MBytes), blocks of the
+             * dense index that have not been accessed recently are spilled
+             * to a memory-mapped temporary file once the limit is reached,
+             * so the index also works with input data larger than the
+             * available memory.
              */
             template <typename TId, typename TValue>
             class FlexMem : public osmium::index::map::Map<TId, TValue> {
@@ -100,13 +112,50 @@ namespace osmium {
                     }
                 };
 
+                enum : std::size_t {
+                    no_file_block = static_cast<std::size_t>(-1)
+                };
+
                 std::vector<entry> m_sparse_entries;
 
+                // Sparse entries frozen into immutable sorted segments when
+                // a snapshot was taken (see get_snapshot()). The shared
+                // ownership keeps a segment alive for the snapshots still
+                // using it after switch_to_dense() has dropped it here.
+                std::vector<std::shared_ptr<const std::vector<entry>>> m_frozen_entries;
+
                 std::vector<std::vector<TValue>> m_dense_blocks;
 
+                // For each dense block the position (in blocks) in the spill
+                // file, or no_file_block if the block was never spilled. A
+                // block lives either in m_dense_blocks or in the file, never
+                // in both.
+                std::vector<std::size_t> m_block_file_index;
+
+                // For each dense block a flag telling us whether the block
+                // was accessed since the clock hand in spill_cold_block()
+                // last swept over it. Mutable because reads set it, too.
+                mutable std::vector<uint8_t> m_block_hot;
+
+                // Spill file, created when the first block is spilled.
+                std::unique_ptr<osmium::detail::mmap_vector_file<TValue>> m_file;
+
+                std::size_t m_blocks_in_memory = 0;
+
+                // Maximum number of dense blocks held in memory, 0 means
+                // no limit (nothing is ever spilled).
+                std::size_t m_max_blocks_in_memory = 0;
+
+                // Number of blocks in the spill file.
+                std::size_t m_file_blocks = 0;
+
+                std::size_t m_clock_hand = 0;
+
                 // The maximum Id that was seen yet. Only set in sparse mode.
                 uint64_t m_max_id = 0;
 
+                osmium::MemoryAccounting::tracker m_memory_tracker{osmium::MemoryAccounting::subsystem::indexes};
+
                 // Set to false in sparse mode and to true in dense mode.
                 bool m_dense;
 
@@ -118,15 +167,78 @@ namespace osmium {
                     return id & (block_size - 1);
                 }
 
+                bool is_spilled(const uint64_t num) const noexcept {
+                    return m_block_file_index[num] != no_file_block;
+                }
+
+                // Spill the first block the clock hand finds that was not
+                // accessed since the last sweep. Blocks accessed since then
+                // get a second chance.
+                void spill_cold_block() {
+                    if (!m_file) {
+                        m_file.reset(new osmium::detail::mmap_vector_file<TValue>{});
+                    }
+                    for (std::size_t i = 0; i <= 2 * m_dense_blocks.size(); ++i) {
+                        const std::size_t num = m_clock_hand++ % m_dense_blocks.size();
+                        if (m_dense_blocks[num].empty()) {
+                            continue;
+                        }
+                        if (m_block_hot[num]) {
+                            m_block_hot[num] = 0;
+                            continue;
+                        }
+                        m_block_file_index[num] = m_file_blocks++;
+                        m_file->resize(m_file_blocks * block_size);
+                        std::copy(m_dense_blocks[num].begin(), m_dense_blocks[num].end(),
+                                  m_file->begin() + m_block_file_index[num] * block_size);
+                        m_dense_blocks[num].clear();
+                        m_dense_blocks[num].shrink_to_fit();
+                        --m_blocks_in_memory;
+                        return;
+                    }
+                }
+
                 // Assure that the block with the given number exists. Create
                 // it if needed.
                 void assure_block(const uint64_t num) {
                     if (num >= m_dense_blocks.size()) {
                         m_dense_blocks.resize(num + 1);
+                        m_block_file_index.resize(num + 1, no_file_block);
+                        m_block_hot.resize(num + 1, 0);
                     }
-                    if (m_dense_blocks[num].empty()) {
+                    if (m_dense_blocks[num].empty() && !is_spilled(num)) {
+                        if (m_max_blocks_in_memory > 0 && m_blocks_in_memory >= m_max_blocks_in_memory) {
+                            spill_cold_block();
+                        }
                         m_dense_blocks[num].assign(block_size, osmium::index::empty_value<TValue>());
+                        ++m_blocks_in_memory;
+                    }
+                }
+
+                static TValue find_entry(const std::vector<entry>& entries, const uint64_t id) noexcept {
+                    const auto it = std::lower_bound(entries.begin(),
+                                                     entries.end(),
+                                                     entry{id, osmium::index::empty_value<TValue>()});
+                    if (it == entries.end() || it->id != id) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return it->value;
+                }
+
+                std::size_t num_sparse_entries() const noexcept {
+                    std::size_t num = m_sparse_entries.size();
+                    for (const auto& segment : m_frozen_entries) {
+                        num += segment->size();
                     }
+                    return num;
+                }
+
+                // Freeze the current sparse entries into an immutable
+                // sorted segment that snapshots can pin.
+                void freeze_active_entries() {
+                    std::sort(m_sparse_entries.begin(), m_sparse_entries.end());
+                    m_frozen_entries.emplace_back(std::make_shared<std::vector<entry>>(std::move(m_sparse_entries)));
+                    m_sparse_entries = std::vector<entry>{};
                 }
 
                 void set_sparse(const uint64_t id, const TValue value) {
@@ -134,8 +246,8 @@ namespace osmium {
                     if (id > m_max_id) {
                         m_max_id = id;
 
-                        if (m_sparse_entries.size() >= min_dense_entries) {
-                            if (m_max_id < m_sparse_entries.size() * density_factor) {
+                        if (num_sparse_entries() >= min_dense_entries) {
+                            if (m_max_id < num_sparse_entries() * density_factor) {
                                 switch_to_dense();
                             }
                         }
@@ -143,29 +255,100 @@ namespace osmium {
                 }
 
                 TValue get_sparse(const uint64_t id) const noexcept {
-                    const auto it = std::lower_bound(m_sparse_entries.begin(),
-                                                     m_sparse_entries.end(),
-                                                     entry{id, osmium::index::empty_value<TValue>()});
-                    if (it == m_sparse_entries.end() || it->id != id) {
-                        return osmium::index::empty_value<TValue>();
+                    auto value = find_entry(m_sparse_entries, id);
+                    if (!(value == osmium::index::empty_value<TValue>())) {
+                        return value;
                     }
-                    return it->value;
+                    // newer frozen segments win over older ones
+                    for (auto it = m_frozen_entries.rbegin(); it != m_frozen_entries.rend(); ++it) {
+                        value = find_entry(**it, id);
+                        if (!(value == osmium::index::empty_value<TValue>())) {
+                            return value;
+                        }
+                    }
+                    return osmium::index::empty_value<TValue>();
                 }
 
                 void set_dense(const uint64_t id, const TValue value) {
-                    assure_block(block(id));
-                    m_dense_blocks[block(id)][offset(id)] = value;
+                    const uint64_t num = block(id);
+                    assure_block(num);
+                    if (m_dense_blocks[num].empty()) {
+                        (*m_file)[m_block_file_index[num] * block_size + offset(id)] = value;
+                    } else {
+                        m_dense_blocks[num][offset(id)] = value;
+                        m_block_hot[num] = 1;
+                    }
                 }
 
                 TValue get_dense(const uint64_t id) const noexcept {
-                    if (m_dense_blocks.size() <= block(id) || m_dense_blocks[block(id)].empty()) {
+                    const uint64_t num = block(id);
+                    if (m_dense_blocks.size() <= num) {
                         return osmium::index::empty_value<TValue>();
                     }
-                    return m_dense_blocks[block(id)][offset(id)];
+                    if (m_dense_blocks[num].empty()) {
+                        if (!is_spilled(num)) {
+                            return osmium::index::empty_value<TValue>();
+                        }
+                        return (*m_file)[m_block_file_index[num] * block_size + offset(id)];
+                    }
+                    m_block_hot[num] = 1;
+                    return m_dense_blocks[num][offset(id)];
                 }
 
             public:
 
+                /**
+                 * A read-only view of the data in the index at the time
+                 * the snapshot was taken (see get_snapshot()). Reads
+                 * through a snapshot stay valid while the index continues
+                 * to grow and across the sparse-to-dense switch, so one
+                 * thread can look up already-set ids while another keeps
+                 * filling the index. Ids set after the snapshot was taken
+                 * are not visible through it. The pinned data is freed
+                 * when the index has switched to dense and the last
+                 * snapshot referencing the data goes away.
+                 */
+                class snapshot {
+
+                    friend class FlexMem;
+
+                    std::vector<std::shared_ptr<const std::vector<entry>>> m_segments;
+
+                    explicit snapshot(std::vector<std::shared_ptr<const std::vector<entry>>> segments) :
+                        m_segments(std::move(segments)) {
+                    }
+
+                public:
+
+                    TValue get_noexcept(const TId id) const noexcept {
+                        // newer segments win over older ones
+                        for (auto it = m_segments.rbegin(); it != m_segments.rend(); ++it) {
+                            const auto value = find_entry(**it, id);
+                            if (!(value == osmium::index::empty_value<TValue>())) {
+                                return value;
+                            }
+                        }
+                        return osmium::index::empty_value<TValue>();
+                    }
+
+                    TValue get(const TId id) const {
+                        const auto value = get_noexcept(id);
+                        if (value == osmium::index::empty_value<TValue>()) {
+                            throw osmium::not_found{id};
+                        }
+                        return value;
+                    }
+
+                    std::size_t size() const noexcept {
+                        std::size_t num = 0;
+                        for (const auto& segment : m_segments) {
+                            num += segment->size();
+                        }
+                        return num;
+                    }
+
+                }; // class snapshot
+
                 /**
                  * Create FlexMem index.
                  *
@@ -177,23 +360,43 @@ namespace osmium {
                  */
                 explicit FlexMem(bool use_dense = false) :
                     m_dense(use_dense) {
+                    const auto limit_mbytes = osmium::config::get_flex_mem_limit();
+                    if (limit_mbytes > 0) {
+                        set_memory_limit(limit_mbytes * 1024ULL * 1024ULL);
+                    }
                 }
 
                 bool is_dense() const noexcept {
                     return m_dense;
                 }
 
+                /**
+                 * Set the maximum amount of memory (in bytes) used for the
+                 * dense index. When the limit is reached, blocks that have
+                 * not been accessed recently are moved to a memory-mapped
+                 * temporary file. Set to 0 (the default) to keep everything
+                 * in memory. Can also be set through the environment
+                 * variable OSMIUM_FLEX_MEM_LIMIT (in MBytes).
+                 */
+                void set_memory_limit(const std::size_t bytes) noexcept {
+                    m_max_blocks_in_memory = bytes / (block_size * sizeof(TValue));
+                    if (bytes > 0 && m_max_blocks_in_memory == 0) {
+                        m_max_blocks_in_memory = 1;
+                    }
+                }
+
                 std::size_t size() const noexcept final {
                     if (m_dense) {
                         return m_dense_blocks.size() * block_size;
                     }
-                    return m_sparse_entries.size();
+                    return num_sparse_entries();
                 }
 
                 std::size_t used_memory() const noexcept final {
                     return sizeof(FlexMem) +
-                           m_sparse_entries.size() * sizeof(entry) +
-                           m_dense_blocks.size() * (block_size * sizeof(TValue) + sizeof(std::vector<TValue>));
+                           num_sparse_entries() * sizeof(entry) +
+                           m_blocks_in_memory * block_size * sizeof(TValue) +
+                           m_dense_blocks.size() * (sizeof(std::vector<TValue>) + sizeof(std::size_t) + sizeof(uint8_t));
                 }
 
                 void set(const TId id, const TValue value) final {
@@ -202,6 +405,7 @@ namespace osmium {
                     } else {
                         set_sparse(id, value);
                     }
+                    m_memory_tracker.update(used_memory());
                 }
 
                 TValue get_noexcept(const TId id) const noexcept final {
@@ -222,10 +426,21 @@ namespace osmium {
                 void clear() final {
                     m_sparse_entries.clear();
                     m_sparse_entries.shrink_to_fit();
+                    m_frozen_entries.clear();
+                    m_frozen_entries.shrink_to_fit();
                     m_dense_blocks.clear();
                     m_dense_blocks.shrink_to_fit();
+                    m_block_file_index.clear();
+                    m_block_file_index.shrink_to_fit();
+                    m_block_hot.clear();
+                    m_block_hot.shrink_to_fit();
+                    m_file.reset();
+                    m_blocks_in_memory = 0;
+                    m_file_blocks = 0;
+                    m_clock_hand = 0;
                     m_max_id = 0;
                     m_dense = false;
+                    m_memory_tracker.update(used_memory());
                 }
 
                 void sort() final {
@@ -244,21 +459,53 @@ namespace osmium {
                     if (m_dense) {
                         return;
                     }
+                    // older segments first so later writes win
+                    for (const auto& segment : m_frozen_entries) {
+                        for (const auto& entry : *segment) {
+                            set_dense(entry.id, entry.value);
+                        }
+                    }
                     for (const auto& entry : m_sparse_entries) {
                         set_dense(entry.id, entry.value);
                     }
                     m_sparse_entries.clear();
                     m_sparse_entries.shrink_to_fit();
+                    // Snapshots still holding a frozen segment keep it
+                    // alive, for everybody else the memory is freed here.
+                    m_frozen_entries.clear();
+                    m_frozen_entries.shrink_to_fit();
                     m_max_id = 0;
                     m_dense = true;
                 }
 
+                /**
+                 * Get a snapshot of the data currently in the index. The
+                 * current sparse entries are frozen into an immutable
+                 * segment which the snapshot pins, so reads through the
+                 * snapshot stay valid while this thread keeps calling
+                 * set() and across the automatic (or explicit) switch to
+                 * the dense representation.
+                 *
+                 * Must be called from the thread that writes to the index
+                 * and only while the index is still sparse; the snapshot
+                 * itself can then be read from any thread.
+                 *
+                 * @pre @code !is_dense() @endcode
+                 */
+                snapshot get_snapshot() {
+                    assert(!m_dense);
+                    if (!m_sparse_entries.empty()) {
+                        freeze_active_entries();
+                    }
+                    return snapshot{m_frozen_entries};
+                }
+
                 std::pair<std::size_t, std::size_t> stats() const noexcept {
                     std::size_t used_blocks = 0;
                     std::size_t empty_blocks = 0;
 
-                    for (const auto& dense_block : m_dense_blocks) {
-                        if (dense_block.empty()) {
+                    for (std::size_t num = 0; num < m_dense_blocks.size(); ++num) {
+                        if (m_dense_blocks[num].empty() && !is_spilled(num)) {
                             ++empty_blocks;
                         } else {
                             ++used_blocks;
@@ -268,6 +515,11 @@ namespace osmium {
                     return std::make_pair(used_blocks, empty_blocks);
                 }
 
+                /// The number of dense blocks spilled to the temporary file.
+                std::size_t spilled_blocks() const noexcept {
+                    return m_file_blocks;
+                }
+
             }; // class FlexMem
 
         } // namespace map
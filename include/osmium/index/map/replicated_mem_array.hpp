@@ -0,0 +1,238 @@
+#ifndef OSMIUM_INDEX_MAP_REPLICATED_MEM_ARRAY_HPP
+#define OSMIUM_INDEX_MAP_REPLICATED_MEM_ARRAY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/map.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_REPLICATED_MEM_ARRAY
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * Wrapper around the DenseMemArray for NUMA machines where
+             * remote-node memory accesses are much slower than local ones.
+             * The index is filled once (the node phase), then read heavily
+             * from many threads (the way phase). On the first read after
+             * the last write each reader group gets its own copy of the
+             * underlying array, so the typical workload never has to cross
+             * the socket interconnect for lookups.
+             *
+             * Replicas are created lazily by the first reading thread that
+             * is routed to them, so with the usual first-touch allocation
+             * policy the pages of a replica end up on the NUMA node of its
+             * readers. Threads are routed to replicas by a hash of their
+             * thread id; pin your worker threads to NUMA nodes to get
+             * deterministic placement. There is no hard binding via
+             * libnuma because libosmium doesn't depend on it.
+             *
+             * Memory use is the size of the array times the number of
+             * replicas plus one. Writes are only allowed from a single
+             * thread and invalidate all replicas, they are rebuilt on the
+             * next read.
+             *
+             * Available through the map_factory as
+             * "replicated_mem_array" or "replicated_mem_array,NUM_REPLICAS".
+             */
+            template <typename TId, typename TValue>
+            class ReplicatedMemArray : public Map<TId, TValue> {
+
+                enum : std::size_t {
+                    default_num_replicas = 2
+                };
+
+                using array_type = DenseMemArray<TId, TValue>;
+
+                array_type m_primary{};
+                mutable std::vector<std::atomic<array_type*>> m_replicas;
+                mutable std::atomic<bool> m_replicated{false};
+                mutable std::mutex m_mutex{};
+
+                static std::size_t thread_token() noexcept {
+                    thread_local const std::size_t token = std::hash<std::thread::id>{}(std::this_thread::get_id());
+                    return token;
+                }
+
+                void drop_replicas() noexcept {
+                    for (auto& replica : m_replicas) {
+                        delete replica.exchange(nullptr);
+                    }
+                    m_replicated.store(false, std::memory_order_relaxed);
+                }
+
+                const array_type* build_replica(const std::size_t slot) const noexcept {
+                    try {
+                        const std::lock_guard<std::mutex> lock{m_mutex};
+                        array_type* replica = m_replicas[slot].load(std::memory_order_acquire);
+                        if (!replica) {
+                            // The Map classes are not copyable, copy the
+                            // contents element by element. This thread does
+                            // the (first) touch of all the replica's pages.
+                            std::unique_ptr<array_type> copy{new array_type{}};
+                            copy->reserve(m_primary.size());
+                            TId id = 0;
+                            for (const auto& value : m_primary) {
+                                copy->set(id++, value);
+                            }
+                            replica = copy.release();
+                            m_replicas[slot].store(replica, std::memory_order_release);
+                            m_replicated.store(true, std::memory_order_relaxed);
+                        }
+                        return replica;
+                    } catch (...) {
+                        // Can't copy the array, fall back to the shared
+                        // primary. Lookups stay correct, just not local.
+                        return &m_primary;
+                    }
+                }
+
+                const array_type& local_replica() const noexcept {
+                    const std::size_t slot = thread_token() % m_replicas.size();
+                    const array_type* replica = m_replicas[slot].load(std::memory_order_acquire);
+                    if (!replica) {
+                        replica = build_replica(slot);
+                    }
+                    return *replica;
+                }
+
+            public:
+
+                explicit ReplicatedMemArray(std::size_t num_replicas = default_num_replicas) :
+                    m_replicas(num_replicas > 0 ? num_replicas : 1) {
+                }
+
+                ReplicatedMemArray(const ReplicatedMemArray&) = delete;
+                ReplicatedMemArray& operator=(const ReplicatedMemArray&) = delete;
+
+                ReplicatedMemArray(ReplicatedMemArray&&) = delete;
+                ReplicatedMemArray& operator=(ReplicatedMemArray&&) = delete;
+
+                ~ReplicatedMemArray() noexcept override {
+                    drop_replicas();
+                }
+
+                std::size_t num_replicas() const noexcept {
+                    return m_replicas.size();
+                }
+
+                void reserve(const std::size_t size) final {
+                    m_primary.reserve(size);
+                }
+
+                void set(const TId id, const TValue value) final {
+                    if (m_replicated.load(std::memory_order_relaxed)) {
+                        drop_replicas();
+                    }
+                    m_primary.set(id, value);
+                }
+
+                TValue get(const TId id) const final {
+                    return local_replica().get(id);
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    return local_replica().get_noexcept(id);
+                }
+
+                void get_batch(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    local_replica().get_batch(ids, count, values);
+                }
+
+                std::size_t size() const final {
+                    return m_primary.size();
+                }
+
+                std::size_t used_memory() const final {
+                    std::size_t sum = m_primary.used_memory();
+                    for (const auto& replica : m_replicas) {
+                        const array_type* array = replica.load(std::memory_order_acquire);
+                        if (array) {
+                            sum += array->used_memory();
+                        }
+                    }
+                    return sum;
+                }
+
+                void clear() final {
+                    drop_replicas();
+                    m_primary.clear();
+                }
+
+                void sort() final {
+                    if (m_replicated.load(std::memory_order_relaxed)) {
+                        drop_replicas();
+                    }
+                    m_primary.sort();
+                }
+
+                void dump_as_array(const int fd) final {
+                    m_primary.dump_as_array(fd);
+                }
+
+            }; // class ReplicatedMemArray
+
+            template <typename TId, typename TValue>
+            struct create_map<TId, TValue, ReplicatedMemArray> {
+                ReplicatedMemArray<TId, TValue>* operator()(const std::vector<std::string>& config) {
+                    if (config.size() > 1 && !config[1].empty()) {
+                        return new ReplicatedMemArray<TId, TValue>(std::stoul(config[1]));
+                    }
+                    return new ReplicatedMemArray<TId, TValue>();
+                }
+            };
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::ReplicatedMemArray, replicated_mem_array)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_REPLICATED_MEM_ARRAY_HPP
@@ -0,0 +1,264 @@
+#ifndef OSMIUM_INDEX_MAP_SPARSE_MEM_ROBIN_HOOD_HPP
+#define OSMIUM_INDEX_MAP_SPARSE_MEM_ROBIN_HOOD_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_ROBIN_HOOD
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * This implementation is an open-addressing hash map using
+             * robin-hood hashing. Entries are kept in a flat array, so a
+             * lookup usually touches only one or two adjacent cache lines
+             * instead of walking a tree like SparseMemMap does. Unlike
+             * SparseMemArray it does not need a sort() before lookups
+             * start.
+             *
+             * Use this index for sparse input (small extracts) when random
+             * get() performance matters.
+             */
+            template <typename TId, typename TValue>
+            class SparseMemRobinHood : public osmium::index::map::Map<TId, TValue> {
+
+                struct entry_type {
+                    TId id;
+                    TValue value;
+                };
+
+                enum : std::size_t {
+                    initial_capacity = 1024U
+                };
+
+                // Grow the table when it is filled beyond 7/8th of the
+                // capacity.
+                enum : std::size_t {
+                    max_load_num = 7U,
+                    max_load_den = 8U
+                };
+
+                std::vector<entry_type> m_entries{};
+
+                // Probe distance of each slot plus one, 0 means the slot is
+                // empty. Kept separate from the entries so probing scans a
+                // dense byte array.
+                std::vector<std::uint8_t> m_distances{};
+
+                std::size_t m_size = 0;
+
+                static std::size_t mix_hash(const TId id) noexcept {
+                    // Murmur3 finalizer to spread sequential ids over the
+                    // whole table.
+                    auto h = static_cast<std::uint64_t>(id);
+                    h ^= h >> 33U;
+                    h *= 0xff51afd7ed558ccdULL;
+                    h ^= h >> 33U;
+                    h *= 0xc4ceb9fe1a85ec53ULL;
+                    h ^= h >> 33U;
+                    return static_cast<std::size_t>(h);
+                }
+
+                std::size_t slot_of(const TId id) const noexcept {
+                    return mix_hash(id) & (m_entries.size() - 1);
+                }
+
+                bool needs_growing() const noexcept {
+                    return m_entries.empty() ||
+                           m_size + 1 > m_entries.size() / max_load_den * max_load_num;
+                }
+
+                void grow(std::size_t new_capacity) {
+                    std::vector<entry_type> old_entries{};
+                    std::vector<std::uint8_t> old_distances{};
+                    using std::swap;
+                    swap(old_entries, m_entries);
+                    swap(old_distances, m_distances);
+
+                    m_entries.resize(new_capacity);
+                    m_distances.assign(new_capacity, 0);
+                    m_size = 0;
+
+                    for (std::size_t i = 0; i < old_entries.size(); ++i) {
+                        if (old_distances[i] != 0) {
+                            insert(old_entries[i].id, old_entries[i].value);
+                        }
+                    }
+                }
+
+                void insert(TId id, TValue value) {
+                    std::size_t slot = slot_of(id);
+                    std::uint8_t distance = 1;
+
+                    while (true) {
+                        if (m_distances[slot] == 0) {
+                            m_entries[slot] = entry_type{id, value};
+                            m_distances[slot] = distance;
+                            ++m_size;
+                            return;
+                        }
+                        if (m_entries[slot].id == id) {
+                            m_entries[slot].value = value;
+                            return;
+                        }
+                        if (m_distances[slot] < distance) {
+                            // Robin hood: take from the rich, give to the
+                            // poor. Swap the new entry into this slot and
+                            // continue inserting the displaced one.
+                            using std::swap;
+                            swap(m_entries[slot].id, id);
+                            swap(m_entries[slot].value, value);
+                            swap(m_distances[slot], distance);
+                        }
+                        slot = (slot + 1) & (m_entries.size() - 1);
+                        ++distance;
+                        if (distance == 255) {
+                            // Probe sequence too long, rehash into a bigger
+                            // table and start over.
+                            const TId pending_id = id;
+                            const TValue pending_value = value;
+                            grow(m_entries.size() * 2);
+                            insert(pending_id, pending_value);
+                            return;
+                        }
+                    }
+                }
+
+                const entry_type* find(const TId id) const noexcept {
+                    if (m_entries.empty()) {
+                        return nullptr;
+                    }
+                    std::size_t slot = slot_of(id);
+                    std::uint8_t distance = 1;
+                    while (m_distances[slot] >= distance) {
+                        if (m_entries[slot].id == id) {
+                            return &m_entries[slot];
+                        }
+                        slot = (slot + 1) & (m_entries.size() - 1);
+                        ++distance;
+                    }
+                    return nullptr;
+                }
+
+            public:
+
+                SparseMemRobinHood() = default;
+
+                void reserve(const std::size_t size) final {
+                    std::size_t capacity = initial_capacity;
+                    while (capacity / max_load_den * max_load_num < size) {
+                        capacity *= 2;
+                    }
+                    if (capacity > m_entries.size()) {
+                        grow(capacity);
+                    }
+                }
+
+                void set(const TId id, const TValue value) final {
+                    if (needs_growing()) {
+                        grow(m_entries.empty() ? initial_capacity : m_entries.size() * 2);
+                    }
+                    insert(id, value);
+                }
+
+                TValue get(const TId id) const final {
+                    const entry_type* entry = find(id);
+                    if (entry == nullptr) {
+                        throw osmium::not_found{id};
+                    }
+                    return entry->value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    const entry_type* entry = find(id);
+                    if (entry == nullptr) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return entry->value;
+                }
+
+                std::size_t size() const noexcept final {
+                    return m_size;
+                }
+
+                std::size_t used_memory() const noexcept final {
+                    return m_entries.size() * (sizeof(entry_type) + sizeof(std::uint8_t));
+                }
+
+                void clear() final {
+                    m_entries.clear();
+                    m_entries.shrink_to_fit();
+                    m_distances.clear();
+                    m_distances.shrink_to_fit();
+                    m_size = 0;
+                }
+
+                void dump_as_list(const int fd) final {
+                    std::vector<std::pair<TId, TValue>> v;
+                    v.reserve(m_size);
+                    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+                        if (m_distances[i] != 0) {
+                            v.emplace_back(m_entries[i].id, m_entries[i].value);
+                        }
+                    }
+                    std::sort(v.begin(), v.end());
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(v.data()), sizeof(std::pair<TId, TValue>) * v.size());
+                }
+
+            }; // class SparseMemRobinHood
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemRobinHood, sparse_mem_robin_hood)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_SPARSE_MEM_ROBIN_HOOD_HPP
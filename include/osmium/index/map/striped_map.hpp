@@ -0,0 +1,190 @@
+#ifndef OSMIUM_INDEX_MAP_STRIPED_MAP_HPP
+#define OSMIUM_INDEX_MAP_STRIPED_MAP_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/map.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * Thread-safe wrapper around any of the osmium::index::map
+             * index classes. The id space is sharded over a number of
+             * stripes, each with its own instance of the wrapped index and
+             * its own lock, so threads storing different ids rarely
+             * contend. This allows filling a node location index from
+             * several decoder threads in parallel.
+             *
+             * Ids are distributed round-robin over the stripes (stripe =
+             * id % num_stripes, inner id = id / num_stripes), so a dense
+             * wrapped index stays dense within every stripe.
+             *
+             * @tparam TId Id type, usually osmium::unsigned_object_id_type.
+             * @tparam TValue Value type, usually osmium::Location.
+             * @tparam TMap The wrapped index class, must be derived from
+             *         osmium::index::map::Map<TId, TValue> and default
+             *         constructible, for instance DenseMmapArray.
+             */
+            template <typename TId, typename TValue, typename TMap>
+            class StripedMap : public Map<TId, TValue> {
+
+                enum {
+                    default_num_stripes = 64
+                };
+
+                struct Stripe {
+                    mutable std::mutex mutex{};
+                    TMap map{};
+                };
+
+                std::vector<std::unique_ptr<Stripe>> m_stripes;
+
+                static std::size_t round_up_to_power_of_two(std::size_t value) noexcept {
+                    std::size_t result = 1;
+                    while (result < value) {
+                        result *= 2;
+                    }
+                    return result;
+                }
+
+                Stripe& stripe_for(const TId id) const noexcept {
+                    return *m_stripes[id & (m_stripes.size() - 1)];
+                }
+
+                TId inner_id(const TId id) const noexcept {
+                    return id / static_cast<TId>(m_stripes.size());
+                }
+
+            public:
+
+                explicit StripedMap(std::size_t num_stripes = default_num_stripes) {
+                    const std::size_t count = round_up_to_power_of_two(num_stripes);
+                    m_stripes.reserve(count);
+                    for (std::size_t i = 0; i < count; ++i) {
+                        m_stripes.emplace_back(new Stripe{});
+                    }
+                }
+
+                StripedMap(const StripedMap&) = delete;
+                StripedMap& operator=(const StripedMap&) = delete;
+
+                StripedMap(StripedMap&&) noexcept = default;
+                StripedMap& operator=(StripedMap&&) noexcept = default;
+
+                ~StripedMap() noexcept override = default;
+
+                std::size_t num_stripes() const noexcept {
+                    return m_stripes.size();
+                }
+
+                void reserve(const std::size_t size) final {
+                    for (auto& stripe : m_stripes) {
+                        const std::lock_guard<std::mutex> lock{stripe->mutex};
+                        stripe->map.reserve(size / m_stripes.size() + 1);
+                    }
+                }
+
+                void set(const TId id, const TValue value) final {
+                    Stripe& stripe = stripe_for(id);
+                    const std::lock_guard<std::mutex> lock{stripe.mutex};
+                    stripe.map.set(inner_id(id), value);
+                }
+
+                TValue get(const TId id) const final {
+                    const Stripe& stripe = stripe_for(id);
+                    const std::lock_guard<std::mutex> lock{stripe.mutex};
+                    try {
+                        return stripe.map.get(inner_id(id));
+                    } catch (const osmium::not_found&) {
+                        // Re-throw with the original id, the inner map only
+                        // knows the stripe-local one.
+                        throw osmium::not_found{id};
+                    }
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    const Stripe& stripe = stripe_for(id);
+                    const std::lock_guard<std::mutex> lock{stripe.mutex};
+                    return stripe.map.get_noexcept(inner_id(id));
+                }
+
+                std::size_t size() const final {
+                    std::size_t sum = 0;
+                    for (const auto& stripe : m_stripes) {
+                        const std::lock_guard<std::mutex> lock{stripe->mutex};
+                        sum += stripe->map.size();
+                    }
+                    return sum;
+                }
+
+                std::size_t used_memory() const final {
+                    std::size_t sum = 0;
+                    for (const auto& stripe : m_stripes) {
+                        const std::lock_guard<std::mutex> lock{stripe->mutex};
+                        sum += stripe->map.used_memory();
+                    }
+                    return sum;
+                }
+
+                void clear() final {
+                    for (auto& stripe : m_stripes) {
+                        const std::lock_guard<std::mutex> lock{stripe->mutex};
+                        stripe->map.clear();
+                    }
+                }
+
+                void sort() final {
+                    for (auto& stripe : m_stripes) {
+                        const std::lock_guard<std::mutex> lock{stripe->mutex};
+                        stripe->map.sort();
+                    }
+                }
+
+            }; // class StripedMap
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_MAP_STRIPED_MAP_HPP
@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/index/multimap/sparse_file_array.hpp>   // IWYU pragma: keep
 #include <osmium/index/multimap/sparse_mem_array.hpp>    // IWYU pragma: keep
+#include <osmium/index/multimap/sparse_mem_grouped_array.hpp> // IWYU pragma: keep
 #include <osmium/index/multimap/sparse_mem_multimap.hpp> // IWYU pragma: keep
 #include <osmium/index/multimap/sparse_mmap_array.hpp>   // IWYU pragma: keep
 
@@ -37,9 +37,13 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/index/multimap.hpp>
 #include <osmium/index/multimap/sparse_mem_array.hpp>
 #include <osmium/index/multimap/sparse_mem_multimap.hpp>
+#include <osmium/thread/pool.hpp>
 
+#include <chrono>
 #include <cstddef>
+#include <future>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -59,6 +63,14 @@ namespace osmium {
                 typename main_map_type::iterator m_end_main;
                 typename extra_map_type::iterator m_begin_extra;
                 typename extra_map_type::iterator m_end_extra;
+                typename extra_map_type::iterator m_begin_extra2;
+                typename extra_map_type::iterator m_end_extra2;
+
+                // The extra maps store pair<const TId, TValue>, but we
+                // hand out element_type which is pair<TId, TValue>. The
+                // converted element lives here so that operator*() can
+                // return a reference to it.
+                element_type m_current{};
 
             public:
 
@@ -66,17 +78,32 @@ namespace osmium {
                                typename main_map_type::iterator end_main,
                                typename extra_map_type::iterator begin_extra,
                                typename extra_map_type::iterator end_extra) :
+                    HybridIterator(begin_main, end_main, begin_extra, end_extra, end_extra, end_extra) {
+                }
+
+                HybridIterator(typename main_map_type::iterator begin_main,
+                               typename main_map_type::iterator end_main,
+                               typename extra_map_type::iterator begin_extra,
+                               typename extra_map_type::iterator end_extra,
+                               typename extra_map_type::iterator begin_extra2,
+                               typename extra_map_type::iterator end_extra2) :
                     m_begin_main(begin_main),
                     m_end_main(end_main),
                     m_begin_extra(begin_extra),
-                    m_end_extra(end_extra) {
+                    m_end_extra(end_extra),
+                    m_begin_extra2(begin_extra2),
+                    m_end_extra2(end_extra2) {
                 }
 
                 ~HybridIterator() noexcept = default;
 
                 HybridIterator& operator++() {
                     if (m_begin_main == m_end_main) {
-                        ++m_begin_extra;
+                        if (m_begin_extra == m_end_extra) {
+                            ++m_begin_extra2;
+                        } else {
+                            ++m_begin_extra;
+                        }
                     } else {
                         ++m_begin_main;
                         while (m_begin_main != m_end_main && m_begin_main->second == osmium::index::empty_value<TValue>()) { // ignore removed elements
@@ -96,7 +123,9 @@ namespace osmium {
                     return m_begin_main == rhs.m_begin_main &&
                            m_end_main   == rhs.m_end_main &&
                            m_begin_extra == rhs.m_begin_extra &&
-                           m_end_extra   == rhs.m_end_extra;
+                           m_end_extra   == rhs.m_end_extra &&
+                           m_begin_extra2 == rhs.m_begin_extra2 &&
+                           m_end_extra2   == rhs.m_end_extra2;
                 }
 
                 bool operator!=(const HybridIterator& rhs) const {
@@ -105,7 +134,12 @@ namespace osmium {
 
                 const element_type& operator*() {
                     if (m_begin_main == m_end_main) {
-                        return *m_begin_extra;
+                        if (m_begin_extra == m_end_extra) {
+                            m_current = element_type{m_begin_extra2->first, m_begin_extra2->second};
+                        } else {
+                            m_current = element_type{m_begin_extra->first, m_begin_extra->second};
+                        }
+                        return m_current;
                     }
                     return *m_begin_main;
                 }
@@ -122,9 +156,45 @@ namespace osmium {
                 using main_map_type  = SparseMemArray<TId, TValue>;
                 using extra_map_type = SparseMemMultimap<TId, TValue>;
 
+                using element_type = typename std::pair<TId, TValue>;
+
                 main_map_type m_main;
                 extra_map_type m_extra;
 
+                /**
+                 * Entries being consolidated into the main map by a
+                 * background task. Queries still see them through
+                 * get_all() until the new main map is installed.
+                 */
+                extra_map_type m_consolidating;
+
+                /**
+                 * Removals requested while a background consolidation was
+                 * running. They are applied when the new main map is
+                 * installed.
+                 */
+                std::vector<element_type> m_pending_removes;
+
+                /// Result of a running background consolidation.
+                std::future<main_map_type> m_future{};
+
+                /**
+                 * Is a background consolidation running? While this is
+                 * true m_main and m_consolidating are read by the
+                 * background task and must not be changed.
+                 */
+                bool consolidation_running() const noexcept {
+                    return m_future.valid();
+                }
+
+                /// Install the result of a background consolidation if it
+                /// is ready. Does not block.
+                void maybe_finish_consolidation() {
+                    if (consolidation_running() && m_future.wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+                        finish_consolidation();
+                    }
+                }
+
             public:
 
                 using iterator       = HybridIterator<TId, TValue>;
@@ -135,14 +205,21 @@ namespace osmium {
                     m_extra() {
                 }
 
-                ~Hybrid() noexcept = default;
+                ~Hybrid() noexcept {
+                    try {
+                        finish_consolidation();
+                    } catch (...) {
+                        // Ignore any exceptions because we can't do
+                        // anything about them here.
+                    }
+                }
 
                 size_t size() const final {
-                    return m_main.size() + m_extra.size();
+                    return m_main.size() + m_extra.size() + m_consolidating.size();
                 }
 
                 size_t used_memory() const final {
-                    return m_main.used_memory() + m_extra.used_memory();
+                    return m_main.used_memory() + m_extra.used_memory() + m_consolidating.used_memory();
                 }
 
                 void reserve(const size_t size) {
@@ -150,26 +227,48 @@ namespace osmium {
                 }
 
                 void unsorted_set(const TId id, const TValue value) {
-                    m_main.set(id, value);
+                    maybe_finish_consolidation();
+                    if (consolidation_running()) {
+                        // The main map is read by the background task and
+                        // must not change until the result is installed.
+                        m_extra.set(id, value);
+                    } else {
+                        m_main.set(id, value);
+                    }
                 }
 
                 void set(const TId id, const TValue value) final {
+                    maybe_finish_consolidation();
                     m_extra.set(id, value);
                 }
 
                 std::pair<iterator, iterator> get_all(const TId id) {
+                    maybe_finish_consolidation();
                     const auto result_main = m_main.get_all(id);
                     const auto result_extra = m_extra.get_all(id);
-                    return std::make_pair(iterator{result_main.first, result_main.second, result_extra.first, result_extra.second},
-                                          iterator{result_main.second, result_main.second, result_extra.second, result_extra.second});
+                    const auto result_consolidating = m_consolidating.get_all(id);
+                    return std::make_pair(iterator{result_main.first, result_main.second,
+                                                   result_extra.first, result_extra.second,
+                                                   result_consolidating.first, result_consolidating.second},
+                                          iterator{result_main.second, result_main.second,
+                                                   result_extra.second, result_extra.second,
+                                                   result_consolidating.second, result_consolidating.second});
                 }
 
                 void remove(const TId id, const TValue value) {
-                    m_main.remove(id, value);
+                    maybe_finish_consolidation();
+                    if (consolidation_running()) {
+                        // The main map is frozen, remember the removal
+                        // and apply it when the new map is installed.
+                        m_pending_removes.emplace_back(id, value);
+                    } else {
+                        m_main.remove(id, value);
+                    }
                     m_extra.remove(id, value);
                 }
 
                 void consolidate() {
+                    finish_consolidation();
                     m_main.erase_removed();
                     for (const auto& element : m_extra) {
                         m_main.set(element.first, element.second);
@@ -178,17 +277,72 @@ namespace osmium {
                     m_main.sort();
                 }
 
+                /**
+                 * Consolidate asynchronously on the specified thread pool.
+                 * The extra entries are moved aside and a background task
+                 * builds a new sorted main map from them and the current
+                 * main map. Until the task is done, queries see the old
+                 * main map merged with the moved-aside entries, so they
+                 * never block on the merge; the result is installed by the
+                 * first call to one of the query or modify functions after
+                 * the task has finished, or by finish_consolidation().
+                 *
+                 * The Hybrid object must not be used from multiple threads
+                 * and must stay alive until the consolidation has been
+                 * finished.
+                 */
+                void consolidate(osmium::thread::Pool& pool) {
+                    finish_consolidation();
+                    for (const auto& element : m_extra) {
+                        m_consolidating.set(element.first, element.second);
+                    }
+                    m_extra.clear();
+                    m_future = pool.submit([this]() {
+                        main_map_type new_main;
+                        for (const auto& element : m_main) {
+                            if (element.second != osmium::index::empty_value<TValue>()) {
+                                new_main.set(element.first, element.second);
+                            }
+                        }
+                        for (const auto& element : m_consolidating) {
+                            new_main.set(element.first, element.second);
+                        }
+                        new_main.sort();
+                        return new_main;
+                    });
+                }
+
+                /**
+                 * Wait for a running background consolidation and install
+                 * its result. Does nothing if no consolidation is running.
+                 */
+                void finish_consolidation() {
+                    if (!consolidation_running()) {
+                        return;
+                    }
+                    m_main = m_future.get();
+                    m_consolidating.clear();
+                    for (const auto& element : m_pending_removes) {
+                        m_main.remove(element.first, element.second);
+                    }
+                    m_pending_removes.clear();
+                }
+
                 void dump_as_list(const int fd) final {
                     consolidate();
                     m_main.dump_as_list(fd);
                 }
 
                 void clear() final {
+                    finish_consolidation();
                     m_main.clear();
                     m_extra.clear();
+                    m_consolidating.clear();
+                    m_pending_removes.clear();
                 }
 
                 void sort() final {
+                    finish_consolidation();
                     m_main.sort();
                 }
 
@@ -0,0 +1,209 @@
+#ifndef OSMIUM_INDEX_MULTIMAP_SPARSE_MEM_GROUPED_ARRAY_HPP
+#define OSMIUM_INDEX_MULTIMAP_SPARSE_MEM_GROUPED_ARRAY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/multimap.hpp>
+#include <osmium/io/detail/read_write.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace multimap {
+
+            /**
+             * A multimap storing the values grouped by key. Entries are
+             * collected in an unsorted staging vector and sort() converts
+             * them into the group layout: one (key, offset) entry per
+             * unique key plus all values packed into one contiguous
+             * vector, in key order. A key with n values costs one group
+             * entry plus n values instead of n (key, value) pairs, which
+             * roughly halves the memory of a SparseMemArray when most
+             * keys have only a few values each.
+             *
+             * Use it like the other multimap classes: set() all entries,
+             * call sort() once, then query with get_all(). Calling set()
+             * again after sort() is allowed, but the new entries are only
+             * visible after the next sort() which has to rebuild the
+             * whole group layout.
+             */
+            template <typename TId, typename TValue>
+            class SparseMemGroupedArray : public osmium::index::multimap::Multimap<TId, TValue> {
+
+                struct group_type {
+                    TId id;
+                    std::size_t offset;
+                };
+
+            public:
+
+                using element_type         = typename std::pair<TId, TValue>;
+                using const_value_iterator = const TValue*;
+
+            private:
+
+                std::vector<element_type> m_staging;
+                std::vector<group_type> m_groups;
+                std::vector<TValue> m_values;
+
+                /**
+                 * Find the group for the specified id. Returns the pair
+                 * (values begin, values end), both nullptr if there is no
+                 * group for the id.
+                 */
+                std::pair<const_value_iterator, const_value_iterator> find_group(const TId id) const noexcept {
+                    const auto it = std::lower_bound(m_groups.cbegin(), m_groups.cend(), id, [](const group_type& group, const TId value) {
+                        return group.id < value;
+                    });
+                    if (it == m_groups.cend() || it->id != id) {
+                        return std::make_pair(nullptr, nullptr);
+                    }
+                    const auto next = it + 1;
+                    const std::size_t end_offset = next == m_groups.cend() ? m_values.size() : next->offset;
+                    return std::make_pair(m_values.data() + it->offset,
+                                          m_values.data() + end_offset);
+                }
+
+            public:
+
+                SparseMemGroupedArray() = default;
+
+                ~SparseMemGroupedArray() noexcept override = default;
+
+                void set(const TId id, const TValue value) final {
+                    m_staging.emplace_back(id, value);
+                }
+
+                void unsorted_set(const TId id, const TValue value) {
+                    m_staging.emplace_back(id, value);
+                }
+
+                /**
+                 * Get all values stored for the specified id as the pair
+                 * (begin, end) of value iterators. Unlike with the other
+                 * multimap classes the iterators point at the values
+                 * directly, the key is not repeated per entry.
+                 *
+                 * @pre You must have called sort() after the last set().
+                 */
+                std::pair<const_value_iterator, const_value_iterator> get_all(const TId id) const noexcept {
+                    return find_group(id);
+                }
+
+                size_t size() const final {
+                    return m_values.size() + m_staging.size();
+                }
+
+                size_t used_memory() const final {
+                    return m_staging.capacity() * sizeof(element_type) +
+                           m_groups.capacity() * sizeof(group_type) +
+                           m_values.capacity() * sizeof(TValue);
+                }
+
+                /// The number of unique keys. Only valid after sort().
+                size_t group_count() const noexcept {
+                    return m_groups.size();
+                }
+
+                void clear() final {
+                    m_staging.clear();
+                    m_staging.shrink_to_fit();
+                    m_groups.clear();
+                    m_groups.shrink_to_fit();
+                    m_values.clear();
+                    m_values.shrink_to_fit();
+                }
+
+                /**
+                 * Build the group layout from all entries added so far.
+                 * If sort() was called before, the existing groups are
+                 * expanded and rebuilt together with the new entries.
+                 */
+                void sort() final {
+                    if (!m_groups.empty()) {
+                        // Expand existing groups back into the staging
+                        // vector so everything is rebuilt together.
+                        m_staging.reserve(m_staging.size() + m_values.size());
+                        for (std::size_t g = 0; g < m_groups.size(); ++g) {
+                            const std::size_t end_offset = g + 1 == m_groups.size() ? m_values.size() : m_groups[g + 1].offset;
+                            for (std::size_t n = m_groups[g].offset; n < end_offset; ++n) {
+                                m_staging.emplace_back(m_groups[g].id, m_values[n]);
+                            }
+                        }
+                        m_groups.clear();
+                        m_values.clear();
+                    }
+
+                    std::sort(m_staging.begin(), m_staging.end());
+
+                    m_values.reserve(m_staging.size());
+                    for (const element_type& element : m_staging) {
+                        if (m_groups.empty() || m_groups.back().id != element.first) {
+                            m_groups.push_back(group_type{element.first, m_values.size()});
+                        }
+                        m_values.push_back(element.second);
+                    }
+
+                    m_staging.clear();
+                    m_staging.shrink_to_fit();
+                }
+
+                void dump_as_list(const int fd) final {
+                    std::vector<element_type> v;
+                    v.reserve(size());
+                    for (std::size_t g = 0; g < m_groups.size(); ++g) {
+                        const std::size_t end_offset = g + 1 == m_groups.size() ? m_values.size() : m_groups[g + 1].offset;
+                        for (std::size_t n = m_groups[g].offset; n < end_offset; ++n) {
+                            v.emplace_back(m_groups[g].id, m_values[n]);
+                        }
+                    }
+                    v.insert(v.end(), m_staging.cbegin(), m_staging.cend());
+                    std::sort(v.begin(), v.end());
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(v.data()), sizeof(element_type) * v.size());
+                }
+
+            }; // class SparseMemGroupedArray
+
+        } // namespace multimap
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_MULTIMAP_SPARSE_MEM_GROUPED_ARRAY_HPP
@@ -43,6 +43,10 @@ DEALINGS IN THE SOFTWARE.
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseFileArray, dense_file_array)
 #endif
 
+#ifdef OSMIUM_HAS_INDEX_MAP_DENSE_FILE_CACHE_ARRAY
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseFileCacheArray, dense_file_cache_array)
+#endif
+
 #ifdef OSMIUM_HAS_INDEX_MAP_DENSE_MEM_ARRAY
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseMemArray, dense_mem_array)
 #endif
@@ -36,13 +36,19 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/sort.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <future>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -119,6 +125,21 @@ namespace osmium {
                     m_map.erase(last, m_map.end());
                 }
 
+                void sort_unique(osmium::thread::Pool& pool) {
+                    osmium::thread::parallel_sort(m_map.begin(), m_map.end(),
+                                                  std::less<kv_pair>{}, pool);
+                    const auto last = std::unique(m_map.begin(), m_map.end());
+                    m_map.erase(last, m_map.end());
+                }
+
+                const_iterator begin() const noexcept {
+                    return m_map.begin();
+                }
+
+                const_iterator end() const noexcept {
+                    return m_map.end();
+                }
+
                 std::pair<const_iterator, const_iterator> get(const key_type key) const noexcept {
                     return std::equal_range(m_map.begin(), m_map.end(), kv_pair{key}, [](const kv_pair& lhs, const kv_pair& rhs) {
                         return lhs.key < rhs.key;
@@ -321,6 +342,54 @@ namespace osmium {
             bool m_valid = true;
 #endif
 
+            using ancestors_memo_type = std::unordered_map<osmium::unsigned_object_id_type,
+                                                           std::vector<osmium::unsigned_object_id_type>>;
+
+            /**
+             * Collect all relations reachable from the given id by
+             * repeatedly following member-to-parent links in the (sorted)
+             * map. Every relation is visited at most once, so cycles in
+             * the input are handled, they simply don't add anything new.
+             * The id itself is never part of its own ancestors, even if a
+             * cycle leads back to it. Results stored in the memo are
+             * reused instead of being expanded again.
+             */
+            static std::vector<osmium::unsigned_object_id_type> collect_ancestors(const map_type& map,
+                                                                                  const osmium::unsigned_object_id_type id,
+                                                                                  ancestors_memo_type& memo) {
+                std::vector<osmium::unsigned_object_id_type> result;
+                std::unordered_set<osmium::unsigned_object_id_type> visited{id};
+                std::vector<osmium::unsigned_object_id_type> todo{id};
+
+                while (!todo.empty()) {
+                    const auto current = todo.back();
+                    todo.pop_back();
+                    const auto parents = map.get(current);
+                    for (auto it = parents.first; it != parents.second; ++it) {
+                        const osmium::unsigned_object_id_type parent = it->value;
+                        if (!visited.insert(parent).second) {
+                            continue;
+                        }
+                        result.push_back(parent);
+                        const auto m = memo.find(parent);
+                        if (m == memo.end()) {
+                            todo.push_back(parent);
+                        } else {
+                            // The complete set of ancestors of this
+                            // parent is already known, take it over
+                            // instead of walking up from here again.
+                            for (const auto ancestor_id : m->second) {
+                                if (visited.insert(ancestor_id).second) {
+                                    result.push_back(ancestor_id);
+                                }
+                            }
+                        }
+                    }
+                }
+
+                return result;
+            }
+
         public:
 
             RelationsMapStash() = default;
@@ -405,6 +474,131 @@ namespace osmium {
                 return RelationsMapIndex{std::move(m_map)};
             }
 
+            /**
+             * Build an index for member to parent lookups from the contents
+             * of this stash and return it. The sort uses multiple threads
+             * from the given thread pool.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            RelationsMapIndex build_member_to_parent_index(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_member_to_parent_index()");
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndex{std::move(m_map)};
+            }
+
+            /**
+             * Build an index mapping member relation IDs to the IDs of
+             * *all* their ancestor relations, not just the direct parents:
+             * the transitive closure over the member-to-parent mapping.
+             * Use this to resolve nested relation trees (route masters,
+             * boundary hierarchies) with a single lookup per relation
+             * instead of walking up level by level with your own cycle
+             * detection:
+             *
+             * @code
+             * const auto index = stash.build_member_to_ancestors_index();
+             * index.for_each(member_id, [](osmium::unsigned_object_id_type ancestor_id) {
+             *   ...
+             * });
+             * @endcode
+             *
+             * Cycles in the input are handled, a relation is never
+             * reported as its own ancestor. Note that the index needs
+             * memory proportional to the sum of all ancestor list
+             * lengths.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            RelationsMapIndex build_member_to_ancestors_index() {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_member_to_ancestors_index()");
+                m_map.sort_unique();
+
+                map_type closure;
+                ancestors_memo_type memo;
+
+                for (auto it = m_map.begin(); it != m_map.end();) {
+                    const osmium::unsigned_object_id_type member_id = it->key;
+                    auto ancestors = collect_ancestors(m_map, member_id, memo);
+                    for (const auto ancestor_id : ancestors) {
+                        closure.set(member_id, ancestor_id);
+                    }
+                    memo.emplace(member_id, std::move(ancestors));
+                    while (it != m_map.end() && it->key == member_id) {
+                        ++it;
+                    }
+                }
+
+                closure.sort_unique();
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndex{std::move(closure)};
+            }
+
+            /**
+             * Build an index mapping member relation IDs to the IDs of
+             * all their ancestor relations from the contents of this
+             * stash and return it. Like the version of this function
+             * without the pool argument, but the closure computation and
+             * the sorts are distributed over the threads of the given
+             * pool.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            RelationsMapIndex build_member_to_ancestors_index(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_member_to_ancestors_index()");
+                m_map.sort_unique(pool);
+
+                std::vector<osmium::unsigned_object_id_type> keys;
+                for (auto it = m_map.begin(); it != m_map.end();) {
+                    keys.push_back(it->key);
+                    while (it != m_map.end() && it->key == keys.back()) {
+                        ++it;
+                    }
+                }
+
+                // Every task computes the closure for a contiguous chunk
+                // of the member IDs with its own memo, so no
+                // synchronization is needed while the tasks run.
+                using task_result_type = std::vector<std::pair<osmium::unsigned_object_id_type, osmium::unsigned_object_id_type>>;
+                std::vector<std::future<task_result_type>> results;
+
+                const std::size_t num_tasks = std::max<std::size_t>(1, static_cast<std::size_t>(pool.num_threads()));
+                const std::size_t chunk_size = (keys.size() + num_tasks - 1) / num_tasks;
+                for (std::size_t offset = 0; offset < keys.size(); offset += chunk_size) {
+                    const std::size_t last = std::min(keys.size(), offset + chunk_size);
+                    results.push_back(pool.submit([this, &keys, offset, last]() {
+                        task_result_type result;
+                        ancestors_memo_type memo;
+                        for (std::size_t i = offset; i < last; ++i) {
+                            auto ancestors = collect_ancestors(m_map, keys[i], memo);
+                            for (const auto ancestor_id : ancestors) {
+                                result.emplace_back(keys[i], ancestor_id);
+                            }
+                            memo.emplace(keys[i], std::move(ancestors));
+                        }
+                        return result;
+                    }));
+                }
+
+                map_type closure;
+                for (auto& future : results) {
+                    for (const auto& entry : future.get()) {
+                        closure.set(entry.first, entry.second);
+                    }
+                }
+
+                closure.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndex{std::move(closure)};
+            }
+
             /**
              * Build an index for parent to member lookups from the contents
              * of this stash and return it.
@@ -421,6 +615,23 @@ namespace osmium {
                 return RelationsMapIndex{std::move(m_map)};
             }
 
+            /**
+             * Build an index for parent to member lookups from the contents
+             * of this stash and return it. The sort uses multiple threads
+             * from the given thread pool.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            RelationsMapIndex build_parent_to_member_index(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_parent_to_member_index()");
+                m_map.flip_in_place();
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndex{std::move(m_map)};
+            }
+
             /**
              * Build indexes for member-to-parent and parent-to-member lookups
              * from the contents of this stash and return them.
@@ -438,6 +649,24 @@ namespace osmium {
                 return RelationsMapIndexes{std::move(m_map), std::move(reverse_map)};
             }
 
+            /**
+             * Build indexes for member-to-parent and parent-to-member lookups
+             * from the contents of this stash and return them. The sorts use
+             * multiple threads from the given thread pool.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            RelationsMapIndexes build_indexes(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_indexes()");
+                auto reverse_map = m_map.flip_copy();
+                reverse_map.sort_unique(pool);
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndexes{std::move(m_map), std::move(reverse_map)};
+            }
+
         }; // class RelationsMapStash
 
         // defined outside the class on purpose
@@ -47,16 +47,24 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/error.hpp>
 #include <osmium/io/file_compression.hpp>
 #include <osmium/io/writer_options.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/util/file.hpp>
 
 #include <bzlib.h>
 
 #include <cassert>
 #include <cerrno>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <future>
 #include <limits>
+#include <memory>
+#include <queue>
 #include <string>
 #include <system_error>
+#include <utility>
 
 #ifndef _MSC_VER
 # include <unistd.h>
@@ -409,13 +417,671 @@ namespace osmium {
 
         }; // class Bzip2BufferDecompressor
 
+        namespace detail {
+
+            /**
+             * Task run on the thread pool decompressing one complete bzip2
+             * stream held in memory.
+             */
+            class Bzip2StreamDecompressTask {
+
+                std::string m_input;
+
+            public:
+
+                explicit Bzip2StreamDecompressTask(std::string&& input) :
+                    m_input(std::move(input)) {
+                }
+
+                std::string operator()() {
+                    Bzip2BufferDecompressor decompressor{m_input.data(), m_input.size()};
+                    std::string output;
+                    for (std::string chunk = decompressor.read(); !chunk.empty(); chunk = decompressor.read()) {
+                        output += chunk;
+                    }
+                    decompressor.close();
+                    return output;
+                }
+
+            }; // class Bzip2StreamDecompressTask
+
+        } // namespace detail
+
+        /**
+         * Decompressor for bzip2 files consisting of multiple concatenated
+         * bzip2 streams, as produced by pbzip2 and other parallel
+         * compressors. The read thread only splits the raw input at the
+         * byte-aligned stream boundaries, the streams themselves are
+         * decompressed as parallel tasks on the thread pool, so reading
+         * large multi-stream files scales with the number of cores instead
+         * of being limited to one. Results are handed out strictly in file
+         * order, downstream code sees the same byte stream it would get
+         * from the normal Bzip2Decompressor.
+         *
+         * Files containing a single bzip2 stream can not be split this way
+         * (bzip2 blocks inside a stream are not byte-aligned), they keep
+         * using the sequential Bzip2Decompressor. The decision is made with
+         * file_is_multi_stream() when the decompressor is created.
+         */
+        class Bzip2MultiStreamDecompressor final : public Decompressor {
+
+            enum : std::size_t {
+                // stream header ("BZh" plus block size digit) directly
+                // followed by the magic of the first block
+                stream_magic_length = 10,
+
+                // bounds the number of decompression tasks in flight and
+                // with it the memory needed for their inputs and results
+                max_tasks_in_flight = 16,
+
+                // a second stream header must appear this early in the
+                // file for it to be detected as multi-stream
+                detection_window_size = 4UL * 1024UL * 1024UL
+            };
+
+            osmium::thread::Pool& m_pool;
+            std::queue<std::future<std::string>> m_results{};
+            std::string m_carry{};
+            std::size_t m_scan_position = 1;
+            std::size_t m_raw_offset = 0;
+            int m_fd;
+            bool m_eof = false;
+
+            static bool is_stream_start(const char* data) noexcept {
+                return data[0] == 'B' && data[1] == 'Z' && data[2] == 'h' &&
+                       data[3] >= '1' && data[3] <= '9' &&
+                       data[4] == '\x31' && data[5] == '\x41' &&
+                       data[6] == '\x59' && data[7] == '\x26' &&
+                       data[8] == '\x53' && data[9] == '\x59';
+            }
+
+            /**
+             * Find the first bzip2 stream start at or after position from.
+             * Returns size if there is none.
+             */
+            static std::size_t find_stream_start(const char* data, const std::size_t size, const std::size_t from) noexcept {
+                std::size_t pos = from;
+                while (pos + stream_magic_length <= size) {
+                    const auto* candidate = static_cast<const char*>(std::memchr(data + pos, 'B', size - stream_magic_length - pos + 1));
+                    if (!candidate) {
+                        break;
+                    }
+                    pos = static_cast<std::size_t>(candidate - data);
+                    if (is_stream_start(data + pos)) {
+                        return pos;
+                    }
+                    ++pos;
+                }
+                return size;
+            }
+
+            void submit(std::string&& input) {
+                m_results.push(m_pool.submit(detail::Bzip2StreamDecompressTask{std::move(input)}));
+            }
+
+            /// Cut all complete streams out of the carry buffer and submit them.
+            void split_carry() {
+                for (;;) {
+                    const std::size_t split = find_stream_start(m_carry.data(), m_carry.size(), m_scan_position);
+                    if (split == m_carry.size()) {
+                        // no boundary (yet), remember how far we scanned
+                        m_scan_position = m_carry.size() > stream_magic_length ? m_carry.size() - stream_magic_length + 1 : 1;
+                        return;
+                    }
+                    std::string rest{m_carry.substr(split)};
+                    m_carry.resize(split);
+                    submit(std::move(m_carry));
+                    m_carry = std::move(rest);
+                    m_scan_position = 1;
+                }
+            }
+
+        public:
+
+            /**
+             * Check whether the file behind fd starts with more than one
+             * bzip2 stream. Needs a seekable file positioned at the
+             * beginning; the file position is restored before returning.
+             */
+            static bool file_is_multi_stream(const int fd) noexcept {
+                try {
+                    if (osmium::file_size(fd) == 0 || osmium::file_offset(fd) != 0) {
+                        return false; // pipe, empty file, or not at the beginning
+                    }
+                    std::string window;
+                    window.resize(detection_window_size);
+                    std::size_t size = 0;
+                    while (size < window.size()) {
+                        const auto nread = osmium::io::detail::reliable_read(fd, &window[size], static_cast<unsigned int>(window.size() - size));
+                        if (nread <= 0) {
+                            break;
+                        }
+                        size += static_cast<std::size_t>(nread);
+                    }
+                    osmium::util::file_seek(fd, 0);
+                    return find_stream_start(window.data(), size, 1) != size;
+                } catch (...) {
+                    osmium::util::file_seek(fd, 0);
+                    return false;
+                }
+            }
+
+            explicit Bzip2MultiStreamDecompressor(const int fd, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                m_pool(pool),
+                m_fd(fd) {
+            }
+
+            Bzip2MultiStreamDecompressor(const Bzip2MultiStreamDecompressor&) = delete;
+            Bzip2MultiStreamDecompressor& operator=(const Bzip2MultiStreamDecompressor&) = delete;
+
+            Bzip2MultiStreamDecompressor(Bzip2MultiStreamDecompressor&&) = delete;
+            Bzip2MultiStreamDecompressor& operator=(Bzip2MultiStreamDecompressor&&) = delete;
+
+            ~Bzip2MultiStreamDecompressor() noexcept override {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            std::string read() override {
+                if (want_buffered_pages_removed()) {
+                    osmium::io::detail::remove_buffered_pages(m_fd, m_raw_offset);
+                }
+
+                // Keep the pipeline of decompression tasks filled.
+                while (!m_eof && m_results.size() < max_tasks_in_flight) {
+                    const std::size_t old_size = m_carry.size();
+                    m_carry.resize(old_size + osmium::io::Decompressor::input_buffer_size);
+                    const auto nread = osmium::io::detail::reliable_read(m_fd, &m_carry[old_size], osmium::io::Decompressor::input_buffer_size);
+                    m_carry.resize(old_size + static_cast<std::size_t>(nread));
+                    m_raw_offset += static_cast<std::size_t>(nread);
+                    if (nread == 0) {
+                        m_eof = true;
+                        if (!m_carry.empty()) {
+                            submit(std::move(m_carry));
+                            m_carry.clear();
+                        }
+                        break;
+                    }
+                    split_carry();
+                }
+
+                set_offset(m_raw_offset);
+
+                if (m_results.empty()) {
+                    return {};
+                }
+
+                std::future<std::string> result{std::move(m_results.front())};
+                m_results.pop();
+                return result.get();
+            }
+
+            void close() override {
+                while (!m_results.empty()) {
+                    try {
+                        m_results.front().get();
+                    } catch (...) {
+                        // Results are discarded on close, so are their errors.
+                    }
+                    m_results.pop();
+                }
+                if (m_fd >= 0) {
+                    if (want_buffered_pages_removed()) {
+                        osmium::io::detail::remove_buffered_pages(m_fd);
+                    }
+                    const int fd = m_fd;
+                    m_fd = -1;
+                    osmium::io::detail::reliable_close(fd);
+                }
+            }
+
+        }; // class Bzip2MultiStreamDecompressor
+
+        namespace detail {
+
+            /**
+             * Decompress one complete bzip2 stream held in memory. Unlike
+             * Bzip2BufferDecompressor this insists on seeing the end of the
+             * stream, truncated input is an error instead of a short result.
+             */
+            inline std::string decompress_single_bzip2_stream(const std::string& input) {
+                assert(input.size() < std::numeric_limits<unsigned int>::max());
+
+                bz_stream bzstream{};
+                bzstream.next_in = const_cast<char*>(input.data());
+                bzstream.avail_in = static_cast<unsigned int>(input.size());
+                int result = BZ2_bzDecompressInit(&bzstream, 0, 0);
+                if (result != BZ_OK) {
+                    throw bzip2_error{"bzip2 error: decompression init failed: ", result};
+                }
+
+                std::string output;
+                std::size_t size = 0;
+                do {
+                    output.resize(size + osmium::io::Decompressor::input_buffer_size);
+                    bzstream.next_out = &output[size];
+                    bzstream.avail_out = static_cast<unsigned int>(output.size() - size);
+                    result = BZ2_bzDecompress(&bzstream);
+                    size = output.size() - bzstream.avail_out;
+                    if (result == BZ_OK && bzstream.avail_in == 0 && bzstream.avail_out != 0) {
+                        // input exhausted before the stream ended
+                        result = BZ_UNEXPECTED_EOF;
+                    }
+                } while (result == BZ_OK);
+
+                BZ2_bzDecompressEnd(&bzstream);
+
+                if (result != BZ_STREAM_END) {
+                    throw bzip2_error{"bzip2 error: decompress failed: ", result};
+                }
+
+                output.resize(size);
+                return output;
+            }
+
+            /// Task run on the thread pool decompressing one carved-out bzip2 block.
+            class Bzip2BlockDecompressTask {
+
+                std::string m_input;
+
+            public:
+
+                explicit Bzip2BlockDecompressTask(std::string&& input) :
+                    m_input(std::move(input)) {
+                }
+
+                std::string operator()() {
+                    return decompress_single_bzip2_stream(m_input);
+                }
+
+            }; // class Bzip2BlockDecompressTask
+
+        } // namespace detail
+
+        /**
+         * Decompressor decompressing the blocks inside a single bzip2
+         * stream in parallel, the way lbzip2 does it. The blocks in a
+         * stream are independent of each other but not byte-aligned, so
+         * the read thread scans the raw bits for the 48-bit block magic,
+         * carves every block out into a self-contained single-block
+         * stream (shifting it onto a byte boundary; the CRC from the
+         * block header doubles as the stream CRC) and hands it to the
+         * thread pool for decompression. Results are returned strictly
+         * in file order, so downstream code sees the same byte stream
+         * the sequential Bzip2Decompressor would produce.
+         *
+         * The block magic can also appear by chance inside compressed
+         * data (probability 2^-48 per bit position). A block carved at
+         * such a false boundary fails to decompress; when that happens
+         * the file is decompressed again from the start with the
+         * sequential decompressor, skipping the output already handed
+         * out, so the result is correct either way. Because of this
+         * fallback the decompressor is only used on seekable files, see
+         * file_is_suitable().
+         */
+        class Bzip2BlockDecompressor final : public Decompressor {
+
+            enum : std::size_t {
+                // bounds the number of decompression tasks in flight and
+                // with it the memory needed for their inputs and results
+                max_tasks_in_flight = 16
+            };
+
+            enum : uint64_t {
+                block_magic = 0x314159265359ULL, // start of a block
+                eos_magic   = 0x177245385090ULL, // end of a stream
+                magic_mask  = 0xffffffffffffULL
+            };
+
+            osmium::thread::Pool& m_pool;
+            std::queue<std::future<std::string>> m_results{};
+            std::unique_ptr<Decompressor> m_fallback{};
+            std::string m_pending_output{};
+            std::string m_carry{}; // raw bytes starting at file offset m_carry_offset
+            uint64_t m_window = 0; // rolling bit window of the scanner
+            std::size_t m_carry_offset = 0;
+            std::size_t m_scan_byte = 0; // file offset of the next byte to scan
+            std::size_t m_block_start_bit = 0; // file bit offset of the current block magic
+            std::size_t m_header_byte = 0; // file offset of the current stream header
+            std::size_t m_raw_offset = 0;
+            std::size_t m_delivered = 0; // decompressed bytes already handed out
+            int m_fd;
+            char m_level = 0; // block size digit from the current stream header
+            bool m_in_block = false;
+            bool m_seen_block = false;
+            bool m_eof = false;
+            bool m_failed = false;
+
+            unsigned char byte_at(const std::size_t offset) const noexcept {
+                assert(offset >= m_carry_offset && offset < m_carry_offset + m_carry.size());
+                return static_cast<unsigned char>(m_carry[offset - m_carry_offset]);
+            }
+
+            /// Read up to 48 bits starting at the given file bit offset.
+            uint64_t read_bits(const std::size_t bit, const unsigned int count) const noexcept {
+                const std::size_t first_byte = bit >> 3U;
+                const auto shift = static_cast<unsigned int>(bit & 7U);
+                const unsigned int nbytes = (shift + count + 7U) / 8U;
+                const std::size_t end = m_carry_offset + m_carry.size();
+                uint64_t window = 0;
+                for (unsigned int i = 0; i < nbytes; ++i) {
+                    const std::size_t pos = first_byte + i;
+                    window = (window << 8U) | (pos < end ? byte_at(pos) : 0U);
+                }
+                return (window >> (nbytes * 8U - shift - count)) & ((1ULL << count) - 1);
+            }
+
+            /**
+             * Build a self-contained single-block bzip2 stream from the
+             * block in the file bit range [bit_from, bit_to).
+             */
+            std::string carve_block(const std::size_t bit_from, const std::size_t bit_to) const {
+                std::string out;
+                out.reserve((bit_to - bit_from) / 8 + 16);
+                out += 'B';
+                out += 'Z';
+                out += 'h';
+                out += m_level;
+
+                uint64_t accu = 0;
+                unsigned int accu_bits = 0;
+                const auto append_bits = [&](const uint64_t value, const unsigned int count) {
+                    accu = (accu << count) | (value & ((1ULL << count) - 1));
+                    accu_bits += count;
+                    while (accu_bits >= 8) {
+                        accu_bits -= 8;
+                        out += static_cast<char>((accu >> accu_bits) & 0xffU);
+                    }
+                };
+
+                std::size_t pos = bit_from;
+                while (pos < bit_to) {
+                    const auto count = bit_to - pos >= 32 ? 32U : static_cast<unsigned int>(bit_to - pos);
+                    append_bits(read_bits(pos, count), count);
+                    pos += count;
+                }
+
+                // end-of-stream marker; for a single-block stream the
+                // stream CRC is the CRC from the block header
+                append_bits(eos_magic, 48);
+                append_bits(read_bits(bit_from + 48, 32), 32);
+                if (accu_bits > 0) {
+                    append_bits(0, 8 - accu_bits);
+                }
+
+                return out;
+            }
+
+            void close_block(const std::size_t end_bit) {
+                m_results.push(m_pool.submit(detail::Bzip2BlockDecompressTask{carve_block(m_block_start_bit, end_bit)}));
+            }
+
+            /// Check and parse the stream header expected at m_header_byte.
+            void begin_stream(const std::size_t magic_bit) {
+                if (magic_bit != m_header_byte * 8 + 32 ||
+                    byte_at(m_header_byte) != 'B' ||
+                    byte_at(m_header_byte + 1) != 'Z' ||
+                    byte_at(m_header_byte + 2) != 'h' ||
+                    byte_at(m_header_byte + 3) < '1' ||
+                    byte_at(m_header_byte + 3) > '9') {
+                    m_failed = true;
+                    return;
+                }
+                m_level = static_cast<char>(byte_at(m_header_byte + 3));
+            }
+
+            void found_block_magic(const std::size_t start_bit) {
+                if (m_in_block) {
+                    close_block(start_bit);
+                } else {
+                    begin_stream(start_bit);
+                }
+                m_block_start_bit = start_bit;
+                m_in_block = true;
+                m_seen_block = true;
+            }
+
+            void found_eos_magic(const std::size_t start_bit) {
+                if (!m_in_block) {
+                    m_failed = true; // end-of-stream marker without a block
+                    return;
+                }
+                close_block(start_bit);
+                m_in_block = false;
+                // stream CRC follows the marker, then padding to the next
+                // byte boundary where another stream can start
+                m_header_byte = (start_bit + 48 + 32 + 7) / 8;
+            }
+
+            /// Drop carry bytes that no unfinished block can refer to any more.
+            void trim_carry() {
+                const std::size_t keep_from = m_in_block ? m_block_start_bit / 8 : m_header_byte;
+                if (keep_from > m_carry_offset) {
+                    const std::size_t count = keep_from - m_carry_offset;
+                    if (count >= m_carry.size()) {
+                        m_carry_offset += m_carry.size();
+                        m_carry.clear();
+                    } else {
+                        m_carry.erase(0, count);
+                        m_carry_offset += count;
+                    }
+                }
+            }
+
+            /// Scan all unscanned carry bytes for block and end-of-stream magics.
+            void scan_carry() {
+                const std::size_t end = m_carry_offset + m_carry.size();
+                while (m_scan_byte < end && !m_failed) {
+                    m_window = (m_window << 8U) | byte_at(m_scan_byte);
+                    ++m_scan_byte;
+                    for (int shift = 7; shift >= 0; --shift) {
+                        if (m_scan_byte * 8 < 48 + static_cast<unsigned int>(shift)) {
+                            continue; // not enough bits in the file yet
+                        }
+                        const uint64_t candidate = (m_window >> static_cast<unsigned int>(shift)) & magic_mask;
+                        const std::size_t start_bit = m_scan_byte * 8 - static_cast<unsigned int>(shift) - 48;
+                        if (candidate == block_magic) {
+                            found_block_magic(start_bit);
+                        } else if (candidate == eos_magic) {
+                            found_eos_magic(start_bit);
+                        }
+                        if (m_failed) {
+                            break;
+                        }
+                    }
+                }
+                trim_carry();
+            }
+
+            /**
+             * A block failed to decompress (or the scan got confused):
+             * rewind and decompress the whole file sequentially, skipping
+             * the output that was already handed out.
+             */
+            void start_fallback() {
+                while (!m_results.empty()) {
+                    try {
+                        m_results.front().get();
+                    } catch (...) {
+                        // Results are discarded, so are their errors.
+                    }
+                    m_results.pop();
+                }
+                m_carry.clear();
+                osmium::util::file_seek(m_fd, 0);
+                m_fallback.reset(new Bzip2Decompressor{m_fd});
+                m_fd = -1; // the fallback owns the file descriptor now
+
+                std::size_t to_skip = m_delivered;
+                while (to_skip > 0) {
+                    std::string data{m_fallback->read()};
+                    if (data.empty()) {
+                        break;
+                    }
+                    if (data.size() > to_skip) {
+                        m_pending_output = data.substr(to_skip);
+                        break;
+                    }
+                    to_skip -= data.size();
+                }
+            }
+
+            std::string read_fallback() {
+                if (!m_pending_output.empty()) {
+                    std::string data;
+                    using std::swap;
+                    swap(data, m_pending_output);
+                    return data;
+                }
+                return m_fallback->read();
+            }
+
+        public:
+
+            /**
+             * Check whether the file behind fd looks like a bzip2 file we
+             * can do block-parallel decompression on. Needs a seekable
+             * file positioned at the beginning; the file position is
+             * restored before returning.
+             */
+            static bool file_is_suitable(const int fd) noexcept {
+                try {
+                    if (osmium::file_size(fd) == 0 || osmium::file_offset(fd) != 0) {
+                        return false; // pipe, empty file, or not at the beginning
+                    }
+                    char header[4] = {0, 0, 0, 0};
+                    std::size_t size = 0;
+                    while (size < sizeof(header)) {
+                        const auto nread = osmium::io::detail::reliable_read(fd, header + size, static_cast<unsigned int>(sizeof(header) - size));
+                        if (nread <= 0) {
+                            break;
+                        }
+                        size += static_cast<std::size_t>(nread);
+                    }
+                    osmium::util::file_seek(fd, 0);
+                    return size == sizeof(header) &&
+                           header[0] == 'B' && header[1] == 'Z' && header[2] == 'h' &&
+                           header[3] >= '1' && header[3] <= '9';
+                } catch (...) {
+                    osmium::util::file_seek(fd, 0);
+                    return false;
+                }
+            }
+
+            explicit Bzip2BlockDecompressor(const int fd, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                m_pool(pool),
+                m_fd(fd) {
+            }
+
+            Bzip2BlockDecompressor(const Bzip2BlockDecompressor&) = delete;
+            Bzip2BlockDecompressor& operator=(const Bzip2BlockDecompressor&) = delete;
+
+            Bzip2BlockDecompressor(Bzip2BlockDecompressor&&) = delete;
+            Bzip2BlockDecompressor& operator=(Bzip2BlockDecompressor&&) = delete;
+
+            ~Bzip2BlockDecompressor() noexcept override {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            std::string read() override {
+                if (m_fallback) {
+                    return read_fallback();
+                }
+
+                if (want_buffered_pages_removed()) {
+                    osmium::io::detail::remove_buffered_pages(m_fd, m_raw_offset);
+                }
+
+                // Keep the pipeline of decompression tasks filled.
+                while (!m_eof && !m_failed && m_results.size() < max_tasks_in_flight) {
+                    const std::size_t old_size = m_carry.size();
+                    m_carry.resize(old_size + osmium::io::Decompressor::input_buffer_size);
+                    const auto nread = osmium::io::detail::reliable_read(m_fd, &m_carry[old_size], osmium::io::Decompressor::input_buffer_size);
+                    m_carry.resize(old_size + static_cast<std::size_t>(nread));
+                    m_raw_offset += static_cast<std::size_t>(nread);
+                    if (nread == 0) {
+                        m_eof = true;
+                        if (m_in_block || (!m_seen_block && m_raw_offset > 0)) {
+                            // unterminated block or no block at all: let
+                            // the sequential decompressor sort it out
+                            m_failed = true;
+                        }
+                        break;
+                    }
+                    scan_carry();
+                }
+
+                if (m_failed) {
+                    start_fallback();
+                    return read_fallback();
+                }
+
+                set_offset(m_raw_offset);
+
+                if (m_results.empty()) {
+                    return {};
+                }
+
+                std::future<std::string> result{std::move(m_results.front())};
+                m_results.pop();
+                try {
+                    std::string data{result.get()};
+                    m_delivered += data.size();
+                    return data;
+                } catch (const osmium::bzip2_error&) {
+                    // very likely a false block boundary
+                    start_fallback();
+                    return read_fallback();
+                }
+            }
+
+            void close() override {
+                while (!m_results.empty()) {
+                    try {
+                        m_results.front().get();
+                    } catch (...) {
+                        // Results are discarded on close, so are their errors.
+                    }
+                    m_results.pop();
+                }
+                if (m_fallback) {
+                    m_fallback->close();
+                    m_fallback.reset();
+                }
+                if (m_fd >= 0) {
+                    if (want_buffered_pages_removed()) {
+                        osmium::io::detail::remove_buffered_pages(m_fd);
+                    }
+                    const int fd = m_fd;
+                    m_fd = -1;
+                    osmium::io::detail::reliable_close(fd);
+                }
+            }
+
+        }; // class Bzip2BlockDecompressor
+
         namespace detail {
 
             // we want the register_compression() function to run, setting
             // the variable is only a side-effect, it will never be used
             const bool registered_bzip2_compression = osmium::io::CompressionFactory::instance().register_compression(osmium::io::file_compression::bzip2,
                 [](const int fd, const fsync sync) { return new osmium::io::Bzip2Compressor{fd, sync}; },
-                [](const int fd) { return new osmium::io::Bzip2Decompressor{fd}; },
+                [](const int fd) -> osmium::io::Decompressor* {
+                    if (osmium::io::Bzip2MultiStreamDecompressor::file_is_multi_stream(fd)) {
+                        return new osmium::io::Bzip2MultiStreamDecompressor{fd};
+                    }
+                    if (osmium::io::Bzip2BlockDecompressor::file_is_suitable(fd)) {
+                        return new osmium::io::Bzip2BlockDecompressor{fd};
+                    }
+                    return new osmium::io::Bzip2Decompressor{fd};
+                },
                 [](const char* buffer, const std::size_t size) { return new osmium::io::Bzip2BufferDecompressor{buffer, size}; }
             );
 
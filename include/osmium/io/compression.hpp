@@ -34,16 +34,18 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/detail/uring_reader.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file_compression.hpp>
 #include <osmium/io/writer_options.hpp>
+#include <osmium/util/config.hpp>
 #include <osmium/util/file.hpp>
 
+#include <array>
 #include <atomic>
 #include <cerrno>
 #include <cstddef>
 #include <functional>
-#include <map>
 #include <memory>
 #include <string>
 #include <system_error>
@@ -159,17 +161,27 @@ namespace osmium {
                                               create_decompressor_type_fd,
                                               create_decompressor_type_buffer>;
 
-            using compression_map_type = std::map<const osmium::io::file_compression, callbacks_type>;
+            enum : std::size_t {
+                // number of values in the file_compression enum
+                num_compression_types = 4
+            };
 
-            compression_map_type m_callbacks;
+            // Dispatch table indexed by the numeric value of the
+            // file_compression enum. An unregistered compression type has
+            // empty std::function objects in its slot.
+            std::array<callbacks_type, num_compression_types> m_callbacks;
 
             CompressionFactory() = default;
 
+            static std::size_t index(const osmium::io::file_compression compression) noexcept {
+                return static_cast<std::size_t>(compression);
+            }
+
             const callbacks_type& find_callbacks(const osmium::io::file_compression compression) const {
-                const auto it = m_callbacks.find(compression);
+                const std::size_t idx = index(compression);
 
-                if (it != m_callbacks.end()) {
-                    return it->second;
+                if (idx < m_callbacks.size() && std::get<0>(m_callbacks[idx])) {
+                    return m_callbacks[idx];
                 }
 
                 std::string error_message{"Support for compression '"};
@@ -199,27 +211,32 @@ namespace osmium {
                 const create_decompressor_type_fd& create_decompressor_fd,
                 const create_decompressor_type_buffer& create_decompressor_buffer) {
 
-                const compression_map_type::value_type cc{compression,
-                                                          std::make_tuple(create_compressor,
-                                                              create_decompressor_fd,
-                                                              create_decompressor_buffer)};
+                const std::size_t idx = index(compression);
+                if (idx >= m_callbacks.size() || std::get<0>(m_callbacks[idx])) {
+                    // like std::map::insert() an existing entry is kept
+                    return false;
+                }
+
+                m_callbacks[idx] = std::make_tuple(create_compressor,
+                                                   create_decompressor_fd,
+                                                   create_decompressor_buffer);
 
-                return m_callbacks.insert(cc).second;
+                return true;
             }
 
             template <typename... TArgs>
             std::unique_ptr<osmium::io::Compressor> create_compressor(const osmium::io::file_compression compression, TArgs&&... args) const {
-                const auto callbacks = find_callbacks(compression);
+                const auto& callbacks = find_callbacks(compression);
                 return std::unique_ptr<osmium::io::Compressor>(std::get<0>(callbacks)(std::forward<TArgs>(args)...));
             }
 
             std::unique_ptr<osmium::io::Decompressor> create_decompressor(const osmium::io::file_compression compression, const int fd) const {
-                const auto callbacks = find_callbacks(compression);
+                const auto& callbacks = find_callbacks(compression);
                 return std::unique_ptr<osmium::io::Decompressor>(std::get<1>(callbacks)(fd));
             }
 
             std::unique_ptr<osmium::io::Decompressor> create_decompressor(const osmium::io::file_compression compression, const char* buffer, const std::size_t size) const {
-                const auto callbacks = find_callbacks(compression);
+                const auto& callbacks = find_callbacks(compression);
                 return std::unique_ptr<osmium::io::Decompressor>(std::get<2>(callbacks)(buffer, size));
             }
 
@@ -312,6 +329,9 @@ namespace osmium {
 
         class NoDecompressor final : public Decompressor {
 
+#ifdef OSMIUM_WITH_IO_URING
+            std::unique_ptr<osmium::io::detail::UringReader> m_uring{};
+#endif
             int m_fd = -1;
             const char* m_buffer = nullptr;
             std::size_t m_buffer_size = 0;
@@ -321,6 +341,15 @@ namespace osmium {
 
             explicit NoDecompressor(const int fd) :
                 m_fd(fd) {
+#ifdef OSMIUM_WITH_IO_URING
+                if (osmium::config::use_io_uring()) {
+                    std::unique_ptr<osmium::io::detail::UringReader> reader{
+                        new osmium::io::detail::UringReader{fd, osmium::io::Decompressor::input_buffer_size}};
+                    if (reader->is_open()) {
+                        m_uring = std::move(reader);
+                    }
+                }
+#endif
             }
 
             NoDecompressor(const char* buffer, const std::size_t size) :
@@ -352,12 +381,20 @@ namespace osmium {
                         buffer.append(m_buffer, size);
                     }
                 } else {
-                    buffer.resize(osmium::io::Decompressor::input_buffer_size);
                     if (want_buffered_pages_removed()) {
                         osmium::io::detail::remove_buffered_pages(m_fd, m_offset);
                     }
-                    const auto nread = detail::reliable_read(m_fd, &*buffer.begin(), osmium::io::Decompressor::input_buffer_size);
-                    buffer.resize(static_cast<std::string::size_type>(nread));
+#ifdef OSMIUM_WITH_IO_URING
+                    if (m_uring) {
+                        buffer = m_uring->read();
+                    } else {
+#endif
+                        buffer.resize(osmium::io::Decompressor::input_buffer_size);
+                        const auto nread = detail::reliable_read(m_fd, &*buffer.begin(), osmium::io::Decompressor::input_buffer_size);
+                        buffer.resize(static_cast<std::string::size_type>(nread));
+#ifdef OSMIUM_WITH_IO_URING
+                    }
+#endif
                 }
 
                 m_offset += buffer.size();
@@ -367,6 +404,9 @@ namespace osmium {
             }
 
             void close() override {
+#ifdef OSMIUM_WITH_IO_URING
+                m_uring.reset();
+#endif
                 if (m_fd >= 0) {
                     if (want_buffered_pages_removed()) {
                         osmium::io::detail::remove_buffered_pages(m_fd);
@@ -104,6 +104,9 @@ namespace osmium {
                 /// Write in form of a diff file?
                 bool format_as_diff = false;
 
+                /// Write only fields that have non-default values?
+                bool sparse = false;
+
             }; // struct debug_output_options
 
             /**
@@ -118,8 +121,36 @@ namespace osmium {
                 const char* m_utf8_prefix = "";
                 const char* m_utf8_suffix = "";
 
+                // Styled templates built once per block from the options,
+                // so writing a field is a few length-prefixed appends
+                // instead of re-assembling the escape sequences for every
+                // object.
+                std::string m_field_prefix;   // before a field name
+                std::string m_field_suffix;   // after a field name
+                std::string m_string_prefix;  // before a quoted string
+                std::string m_string_suffix;  // after a quoted string
+                std::string m_diff_minus;     // styled '-' diff marker
+                std::string m_diff_plus;      // styled '+' diff marker
+
                 char m_diff_char = '\0';
 
+                void init_templates() {
+                    m_field_prefix = "  ";
+                    m_string_prefix = "\"";
+                    m_string_suffix = "\"";
+                    m_diff_minus = "-";
+                    m_diff_plus = "+";
+                    if (m_options.use_color) {
+                        m_field_prefix += color_cyan;
+                        m_field_suffix = color_reset;
+                        m_string_prefix += color_blue;
+                        m_string_suffix.insert(0, color_reset);
+                        m_diff_minus = std::string{color_backg_red} + color_white + color_bold + '-' + color_reset;
+                        m_diff_plus = std::string{color_backg_green} + color_white + color_bold + '+' + color_reset;
+                    }
+                    m_field_suffix += ": ";
+                }
+
                 void append_encoded_string(const char* data) {
                     append_debug_encoded_string(*m_out, data, m_utf8_prefix, m_utf8_suffix);
                 }
@@ -139,33 +170,21 @@ namespace osmium {
                     if (!m_diff_char) {
                         return;
                     }
-                    if (m_options.use_color) {
-                        if (m_diff_char == '-') {
-                            *m_out += color_backg_red;
-                            *m_out += color_white;
-                            *m_out += color_bold;
-                            *m_out += '-';
-                            *m_out += color_reset;
-                            return;
-                        }
-                        if (m_diff_char == '+') {
-                            *m_out += color_backg_green;
-                            *m_out += color_white;
-                            *m_out += color_bold;
-                            *m_out += '+';
-                            *m_out += color_reset;
-                            return;
-                        }
+                    if (m_diff_char == '-') {
+                        m_out->append(m_diff_minus);
+                        return;
+                    }
+                    if (m_diff_char == '+') {
+                        m_out->append(m_diff_plus);
+                        return;
                     }
                     *m_out += m_diff_char;
                 }
 
                 void write_string(const char* string) {
-                    *m_out += '"';
-                    write_color(color_blue);
+                    m_out->append(m_string_prefix);
                     append_encoded_string(string);
-                    write_color(color_reset);
-                    *m_out += '"';
+                    m_out->append(m_string_suffix);
                 }
 
                 void write_object_type(const char* object_type, bool visible = true) {
@@ -182,18 +201,15 @@ namespace osmium {
 
                 void write_fieldname(const char* name) {
                     write_diff();
-                    *m_out += "  ";
-                    write_color(color_cyan);
+                    m_out->append(m_field_prefix);
                     *m_out += name;
-                    write_color(color_reset);
-                    *m_out += ": ";
+                    m_out->append(m_field_suffix);
                 }
 
                 void write_comment_field(const char* name) {
                     write_color(color_cyan);
                     *m_out += name;
-                    write_color(color_reset);
-                    *m_out += ": ";
+                    m_out->append(m_field_suffix);
                 }
 
                 void write_counter(int width, int n) {
@@ -215,7 +231,8 @@ namespace osmium {
 
                 void write_timestamp(const osmium::Timestamp& timestamp) {
                     if (timestamp.valid()) {
-                        *m_out += timestamp.to_iso();
+                        char buffer[osmium::Timestamp::max_length];
+                        m_out->append(buffer, timestamp.to_iso(buffer));
                         *m_out += " (";
                         output_int(timestamp.seconds_since_epoch());
                         *m_out += ')';
@@ -232,22 +249,26 @@ namespace osmium {
                     } else {
                         write_error(" deleted\n");
                     }
-                    if (m_options.add_metadata.version()) {
+                    if (m_options.add_metadata.version() &&
+                        !(m_options.sparse && object.version() == 0)) {
                         write_fieldname("version");
                         *m_out += "  ";
                         output_int(object.version());
                         *m_out += '\n';
                     }
-                    if (m_options.add_metadata.changeset()) {
+                    if (m_options.add_metadata.changeset() &&
+                        !(m_options.sparse && object.changeset() == 0)) {
                         write_fieldname("changeset");
                         output_int(object.changeset());
                         *m_out += '\n';
                     }
-                    if (m_options.add_metadata.timestamp()) {
+                    if (m_options.add_metadata.timestamp() &&
+                        !(m_options.sparse && !object.timestamp().valid())) {
                         write_fieldname("timestamp");
                         write_timestamp(object.timestamp());
                     }
-                    if (m_options.add_metadata.user() || m_options.add_metadata.uid()) {
+                    if ((m_options.add_metadata.user() || m_options.add_metadata.uid()) &&
+                        !(m_options.sparse && object.uid() == 0 && object.user()[0] == '\0')) {
                         write_fieldname("user");
                         *m_out += "     ";
                         if (m_options.add_metadata.uid()) {
@@ -335,15 +356,16 @@ namespace osmium {
 
             public:
 
-                DebugOutputBlock(osmium::memory::Buffer&& buffer, const debug_output_options& options) :
-                    OutputBlock(std::move(buffer)),
+                DebugOutputBlock(osmium::memory::Buffer&& buffer, const debug_output_options& options, osmium::memory::BufferPool* buffer_pool = nullptr, std::shared_ptr<const output_filter_type> filter = {}) :
+                    OutputBlock(std::move(buffer), buffer_pool, std::move(filter)),
                     m_options(options),
                     m_utf8_prefix(options.use_color ? color_red  : ""),
                     m_utf8_suffix(options.use_color ? color_blue : "") {
+                    init_templates();
                 }
 
                 std::string operator()() {
-                    osmium::apply(m_input_buffer->cbegin(), m_input_buffer->cend(), *this);
+                    apply_input(*this);
 
                     std::string out;
                     using std::swap;
@@ -358,7 +380,8 @@ namespace osmium {
                     write_object_type("node", node.visible());
                     write_meta(node);
 
-                    if (node.visible()) {
+                    if (node.visible() &&
+                        !(m_options.sparse && !node.location())) {
                         write_location(node.location());
                     }
 
@@ -450,33 +473,45 @@ namespace osmium {
                     output_int(changeset.id());
                     *m_out += '\n';
 
-                    write_fieldname("num changes");
-                    output_int(changeset.num_changes());
-                    if (changeset.num_changes() == 0) {
-                        write_error(" NO CHANGES!");
+                    if (!(m_options.sparse && changeset.num_changes() == 0)) {
+                        write_fieldname("num changes");
+                        output_int(changeset.num_changes());
+                        if (changeset.num_changes() == 0) {
+                            write_error(" NO CHANGES!");
+                        }
+                        *m_out += '\n';
                     }
-                    *m_out += '\n';
 
-                    write_fieldname("created at");
-                    *m_out += ' ';
-                    write_timestamp(changeset.created_at());
+                    if (!(m_options.sparse && !changeset.created_at().valid())) {
+                        write_fieldname("created at");
+                        *m_out += ' ';
+                        write_timestamp(changeset.created_at());
+                    }
 
-                    write_fieldname("closed at");
-                    *m_out += "  ";
-                    if (changeset.closed()) {
-                        write_timestamp(changeset.closed_at());
-                    } else {
-                        write_error("OPEN!\n");
+                    if (!(m_options.sparse && !changeset.closed())) {
+                        write_fieldname("closed at");
+                        *m_out += "  ";
+                        if (changeset.closed()) {
+                            write_timestamp(changeset.closed_at());
+                        } else {
+                            write_error("OPEN!\n");
+                        }
                     }
 
-                    write_fieldname("user");
-                    *m_out += "       ";
-                    output_int(changeset.uid());
-                    *m_out += ' ';
-                    write_string(changeset.user());
-                    *m_out += '\n';
+                    if (!(m_options.sparse && changeset.uid() == 0 && changeset.user()[0] == '\0')) {
+                        write_fieldname("user");
+                        *m_out += "       ";
+                        output_int(changeset.uid());
+                        *m_out += ' ';
+                        write_string(changeset.user());
+                        *m_out += '\n';
+                    }
 
-                    write_box(changeset.bounds());
+                    if (!(m_options.sparse &&
+                          changeset.bounds().bottom_left().is_undefined() &&
+                          changeset.bounds().top_right().is_undefined())) {
+                        write_box(changeset.bounds());
+                    }
                     write_tags(changeset.tags(), "  ");
 
                     if (changeset.num_comments() > 0) {
@@ -535,10 +570,12 @@ namespace osmium {
 
                 DebugOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
                     OutputFormat(pool, output_queue) {
-                    m_options.add_metadata   = osmium::metadata_options{file.get("add_metadata")};
+                    const auto generic_options = resolve_generic_output_options(file);
+                    m_options.add_metadata   = generic_options.add_metadata;
+                    m_options.format_as_diff = generic_options.format_as_diff;
                     m_options.use_color      = file.is_true("color");
                     m_options.add_crc32      = file.is_true("add_crc32");
-                    m_options.format_as_diff = file.is_true("diff");
+                    m_options.sparse         = file.is_true("sparse");
                 }
 
                 void write_header(const osmium::io::Header& header) final {
@@ -583,7 +620,7 @@ namespace osmium {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    m_output_queue.push(m_pool.submit(DebugOutputBlock{std::move(buffer), m_options}));
+                    m_output_queue.push(m_pool.submit(DebugOutputBlock{std::move(buffer), m_options, m_buffer_pool, m_filter}));
                 }
 
             }; // class DebugOutputFormat
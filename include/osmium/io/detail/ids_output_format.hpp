@@ -91,13 +91,13 @@ namespace osmium {
 
             public:
 
-                IDSOutputBlock(osmium::memory::Buffer&& buffer, const ids_output_options& options) :
-                    OutputBlock(std::move(buffer)),
+                IDSOutputBlock(osmium::memory::Buffer&& buffer, const ids_output_options& options, osmium::memory::BufferPool* buffer_pool = nullptr, std::shared_ptr<const output_filter_type> filter = {}) :
+                    OutputBlock(std::move(buffer), buffer_pool, std::move(filter)),
                     m_options(options) {
                 }
 
                 std::string operator()() {
-                    osmium::apply(m_input_buffer->cbegin(), m_input_buffer->cend(), *this);
+                    apply_input(*this);
 
                     std::string out;
                     using std::swap;
@@ -138,7 +138,7 @@ namespace osmium {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    m_output_queue.push(m_pool.submit(IDSOutputBlock{std::move(buffer), m_options}));
+                    m_output_queue.push(m_pool.submit(IDSOutputBlock{std::move(buffer), m_options, m_buffer_pool, m_filter}));
                 }
 
             }; // class IDSOutputFormat
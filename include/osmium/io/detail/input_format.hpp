@@ -39,10 +39,14 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+#include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/pool.hpp>
 
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <future>
@@ -65,8 +69,20 @@ namespace osmium {
                 std::atomic<std::size_t>* offset_ptr;
                 osmium::osm_entity_bits::type read_which_entities;
                 osmium::io::read_meta read_metadata;
+                osmium::io::read_tags read_tags;
+                osmium::io::read_discussions read_discussions;
+                osmium::io::way_envelopes way_envelopes;
+                osmium::io::clean_way_nodes clean_way_nodes;
+                std::atomic<std::uint64_t>* duplicate_nodes_ptr;
+                osmium::io::skip_damaged_blobs skip_damaged_blobs;
+                std::atomic<std::uint64_t>* damaged_blobs_ptr;
+                osmium::Box filter_box;
                 osmium::io::buffers_type buffers_kind;
+                std::size_t start_offset;
                 bool want_buffered_pages_removed;
+                osmium::io::mapped_input use_mapped_input;
+                osmium::memory::BufferPool* buffer_pool;
+                std::function<bool(const osmium::io::blob_info&)> blob_filter;
             };
 
             class Parser {
@@ -77,6 +93,15 @@ namespace osmium {
                 queue_wrapper<std::string> m_input_queue;
                 osmium::osm_entity_bits::type m_read_which_entities;
                 osmium::io::read_meta m_read_metadata;
+                osmium::io::read_tags m_read_tags;
+                osmium::io::read_discussions m_read_discussions;
+                osmium::io::way_envelopes m_way_envelopes;
+                osmium::io::clean_way_nodes m_clean_way_nodes;
+                std::atomic<std::uint64_t>* m_duplicate_nodes_ptr;
+                osmium::io::skip_damaged_blobs m_skip_damaged_blobs;
+                std::atomic<std::uint64_t>* m_damaged_blobs_ptr;
+                osmium::Box m_filter_box;
+                std::size_t m_start_offset;
                 bool m_header_is_done = false;
 
             protected:
@@ -93,6 +118,50 @@ namespace osmium {
                     return m_read_metadata;
                 }
 
+                osmium::io::read_tags read_tags() const noexcept {
+                    return m_read_tags;
+                }
+
+                osmium::io::read_discussions read_discussions() const noexcept {
+                    return m_read_discussions;
+                }
+
+                osmium::io::way_envelopes way_envelopes() const noexcept {
+                    return m_way_envelopes;
+                }
+
+                osmium::io::clean_way_nodes clean_way_nodes() const noexcept {
+                    return m_clean_way_nodes;
+                }
+
+                /**
+                 * Counter for the way nodes removed by the clean_way_nodes
+                 * option, owned by the Reader. Can be a nullptr.
+                 */
+                std::atomic<std::uint64_t>* duplicate_nodes_counter() const noexcept {
+                    return m_duplicate_nodes_ptr;
+                }
+
+                osmium::io::skip_damaged_blobs skip_damaged_blobs() const noexcept {
+                    return m_skip_damaged_blobs;
+                }
+
+                /**
+                 * Counter for the blobs skipped by the skip_damaged_blobs
+                 * option, owned by the Reader. Can be a nullptr.
+                 */
+                std::atomic<std::uint64_t>* damaged_blobs_counter() const noexcept {
+                    return m_damaged_blobs_ptr;
+                }
+
+                const osmium::Box& filter_box() const noexcept {
+                    return m_filter_box;
+                }
+
+                std::size_t start_offset() const noexcept {
+                    return m_start_offset;
+                }
+
                 bool header_is_done() const noexcept {
                     return m_header_is_done;
                 }
@@ -130,7 +199,16 @@ namespace osmium {
                     m_header_promise(args.header_promise),
                     m_input_queue(args.input_queue),
                     m_read_which_entities(args.read_which_entities),
-                    m_read_metadata(args.read_metadata) {
+                    m_read_metadata(args.read_metadata),
+                    m_read_tags(args.read_tags),
+                    m_read_discussions(args.read_discussions),
+                    m_way_envelopes(args.way_envelopes),
+                    m_clean_way_nodes(args.clean_way_nodes),
+                    m_duplicate_nodes_ptr(args.duplicate_nodes_ptr),
+                    m_skip_damaged_blobs(args.skip_damaged_blobs),
+                    m_damaged_blobs_ptr(args.damaged_blobs_ptr),
+                    m_filter_box(args.filter_box),
+                    m_start_offset(args.start_offset) {
                 }
 
                 Parser(const Parser&) = delete;
@@ -168,12 +246,19 @@ namespace osmium {
             class ParserWithBuffer : public Parser {
 
                 enum {
-                    initial_buffer_size = 1024UL * 1024UL
+                    initial_buffer_size = 1024UL * 1024UL,
+                    scratch_buffer_size = 64UL * 1024UL
                 };
 
                 osmium::memory::Buffer m_buffer{initial_buffer_size,
                                                 osmium::memory::Buffer::auto_grow::internal};
 
+                // Scratch space in which a single object can be assembled
+                // before it is block-copied into the main buffer. Reused
+                // for every object, so its memory is allocated only once.
+                // Allocated lazily, not all parsers use it.
+                osmium::memory::Buffer m_scratch_buffer{};
+
                 osmium::io::buffers_type m_buffers_kind;
                 osmium::item_type m_last_type = osmium::item_type::undefined;
 
@@ -202,6 +287,39 @@ namespace osmium {
                     return m_buffer;
                 }
 
+                /**
+                 * Get the (cleared) scratch buffer. Assemble a single
+                 * object in it and then call append_scratch_buffer() to
+                 * move it into the main buffer.
+                 */
+                osmium::memory::Buffer& scratch_buffer() {
+                    if (!m_scratch_buffer) {
+                        m_scratch_buffer = osmium::memory::Buffer{scratch_buffer_size,
+                                                                  osmium::memory::Buffer::auto_grow::yes};
+                    }
+                    m_scratch_buffer.clear();
+                    return m_scratch_buffer;
+                }
+
+                /**
+                 * Block-copy the object assembled in the scratch buffer
+                 * into the main buffer with a single append. Cheaper than
+                 * assembling directly in the main buffer which checks for
+                 * space on every field added and can have to grow in the
+                 * middle of an object.
+                 */
+                void append_scratch_buffer() {
+                    m_scratch_buffer.commit();
+                    if (m_scratch_buffer.committed() > 0) {
+                        m_buffer.add_buffer(m_scratch_buffer);
+                        m_buffer.commit();
+                    }
+                }
+
+                osmium::io::buffers_type buffers_kind() const noexcept {
+                    return m_buffers_kind;
+                }
+
                 void flush_nested_buffer() {
                     if (m_buffer.has_nested_buffers()) {
                         std::unique_ptr<osmium::memory::Buffer> buffer_ptr{m_buffer.get_last_nested()};
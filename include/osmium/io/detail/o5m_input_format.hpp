@@ -50,7 +50,9 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/timestamp.hpp>
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
+#include <osmium/util/config.hpp>
 #include <osmium/util/delta.hpp>
 
 #include <protozero/exception.hpp>
@@ -62,11 +64,13 @@ DEALINGS IN THE SOFTWARE.
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <future>
 #include <limits>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -162,6 +166,10 @@ namespace osmium {
 
                 ReferenceTable m_reference_table;
 
+                char m_file_type = 'm';
+
+                bool m_enable_parallel = true;
+
                 static int64_t zvarint(const char** data, const char* end) {
                     return protozero::decode_zigzag64(protozero::decode_varint(data, end));
                 }
@@ -180,6 +188,10 @@ namespace osmium {
                     while (m_input.size() < need_bytes) {
                         const std::string data{get_input()};
                         if (input_done()) {
+                            // Keep the pointers valid, the erase() above
+                            // invalidated them.
+                            m_data = m_input.data();
+                            m_end = m_input.data() + m_input.size();
                             return false;
                         }
                         m_input.append(data);
@@ -210,6 +222,7 @@ namespace osmium {
                         throw o5m_error{"wrong header magic"};
                     }
 
+                    m_file_type = *m_data;
                     m_data++;
                 }
 
@@ -347,6 +360,10 @@ namespace osmium {
                     }
                 }
 
+                // The info section must be decoded even if the metadata is
+                // not wanted, because the delta decoders and the reference
+                // table have to be updated for later objects. But in that
+                // case nothing is stored in the object.
                 const char* decode_info(osmium::OSMObject& object, const char** dataptr, const char* const end) {
                     const char* user = "";
 
@@ -354,6 +371,8 @@ namespace osmium {
                         throw o5m_error{"premature end of file while parsing object metadata"};
                     }
 
+                    const bool wanted = (read_metadata() == osmium::io::read_meta::yes);
+
                     if (**dataptr == 0x00) { // no info section
                         ++*dataptr;
                     } else { // has info section
@@ -361,17 +380,24 @@ namespace osmium {
                         if (version > std::numeric_limits<object_version_type>::max()) {
                             throw o5m_error{"object version too large"};
                         }
-                        object.set_version(static_cast<object_version_type>(version));
+                        if (wanted) {
+                            object.set_version(static_cast<object_version_type>(version));
+                        }
 
                         const auto timestamp = m_delta_timestamp.update(zvarint(dataptr, end));
                         if (timestamp != 0) { // has timestamp
-                            object.set_timestamp(timestamp);
-                            object.set_changeset(m_delta_changeset.update(zvarint(dataptr, end)));
+                            const auto changeset = m_delta_changeset.update(zvarint(dataptr, end));
+                            if (wanted) {
+                                object.set_timestamp(timestamp);
+                                object.set_changeset(changeset);
+                            }
                             if (*dataptr != end) {
                                 const auto uid_user = decode_user(dataptr, end);
-                                object.set_uid(uid_user.first);
-                                user = uid_user.second;
-                            } else {
+                                if (wanted) {
+                                    object.set_uid(uid_user.first);
+                                    user = uid_user.second;
+                                }
+                            } else if (wanted) {
                                 object.set_uid(user_id_type{0});
                             }
                         }
@@ -381,25 +407,31 @@ namespace osmium {
                 }
 
                 void decode_node(const char* data, const char* const end) {
-                    osmium::builder::NodeBuilder builder{buffer()};
+                    // Nodes are small and by far the most common objects,
+                    // so they are assembled in the scratch buffer and then
+                    // block-copied into the main buffer in one go.
+                    {
+                        osmium::builder::NodeBuilder builder{scratch_buffer()};
 
-                    builder.set_id(m_delta_id.update(zvarint(&data, end)));
+                        builder.set_id(m_delta_id.update(zvarint(&data, end)));
 
-                    builder.set_user(decode_info(builder.object(), &data, end));
+                        builder.set_user(decode_info(builder.object(), &data, end));
 
-                    if (data == end) {
-                        // no location, object is deleted
-                        builder.set_visible(false);
-                        builder.set_location(osmium::Location{});
-                    } else {
-                        const auto lon = m_delta_lon.update(zvarint(&data, end));
-                        const auto lat = m_delta_lat.update(zvarint(&data, end));
-                        builder.set_location(osmium::Location{lon, lat});
+                        if (data == end) {
+                            // no location, object is deleted
+                            builder.set_visible(false);
+                            builder.set_location(osmium::Location{});
+                        } else {
+                            const auto lon = m_delta_lon.update(zvarint(&data, end));
+                            const auto lat = m_delta_lat.update(zvarint(&data, end));
+                            builder.set_location(osmium::Location{lon, lat});
 
-                        if (data != end) {
-                            decode_tags(builder, &data, end);
+                            if (data != end) {
+                                decode_tags(builder, &data, end);
+                            }
                         }
                     }
+                    append_scratch_buffer();
                 }
 
                 void decode_way(const char* data, const char* const end) {
@@ -604,6 +636,263 @@ namespace osmium {
                     flush_final_buffer();
                 }
 
+                /**
+                 * Decode the datasets before the first OSM object (bounding
+                 * box and file timestamp) which belong into the header. Stops
+                 * at the first node, way, or relation dataset without
+                 * consuming it.
+                 */
+                void decode_header_datasets() {
+                    while (ensure_bytes_available(1)) {
+                        const auto ds_type = static_cast<dataset_type>(*m_data);
+                        if (ds_type == dataset_type::node ||
+                            ds_type == dataset_type::way ||
+                            ds_type == dataset_type::relation) {
+                            return;
+                        }
+                        ++m_data;
+
+                        if (ds_type > dataset_type::jump) {
+                            if (ds_type == dataset_type::reset) {
+                                reset();
+                            }
+                            continue;
+                        }
+
+                        ensure_bytes_available(protozero::max_varint_length);
+
+                        uint64_t length = 0;
+                        try {
+                            length = protozero::decode_varint(&m_data, m_end);
+                        } catch (const protozero::end_of_buffer_exception&) {
+                            throw o5m_error{"premature end of file"};
+                        }
+
+                        if (!ensure_bytes_available(length)) {
+                            throw o5m_error{"premature end of file"};
+                        }
+
+                        switch (ds_type) {
+                            case dataset_type::bounding_box:
+                                decode_bbox(m_data, m_data + length);
+                                break;
+                            case dataset_type::timestamp:
+                                decode_timestamp(m_data, m_data + length);
+                                break;
+                            default:
+                                // ignore unknown datasets
+                                break;
+                        }
+
+                        m_data += length;
+                    }
+                }
+
+                // Sentinels returned by find_cut_point().
+                enum : std::size_t {
+                    scan_found_eof   = std::numeric_limits<std::size_t>::max(),
+                    scan_reached_max = std::numeric_limits<std::size_t>::max() - 1
+                };
+
+                // How far ahead of m_data the framing scan has progressed.
+                // An offset survives ensure_bytes_available() moving the
+                // buffer contents around, a pointer would not.
+                std::size_t m_scan_offset = 0;
+
+                /**
+                 * Scan forward over the dataset framing (type byte plus
+                 * length for most datasets) without decoding any contents,
+                 * looking for a Reset dataset. At a Reset all delta decoders
+                 * and the reference table start from scratch, so the data
+                 * between two Resets can be decoded independently.
+                 *
+                 * A 0xff byte inside a dataset payload is not a Reset, which
+                 * is why the framing has to be walked instead of simply
+                 * searching for the byte.
+                 *
+                 * @returns The offset of the Reset dataset relative to the
+                 *          current read position, scan_found_eof if the input
+                 *          ends before one is found, or scan_reached_max if
+                 *          no Reset turned up within max_chunk_size bytes.
+                 */
+                std::size_t find_cut_point(const std::size_t min_chunk_size, const std::size_t max_chunk_size) {
+                    while (m_scan_offset < max_chunk_size) {
+                        if (!ensure_bytes_available(m_scan_offset + 1)) {
+                            return scan_found_eof;
+                        }
+                        const auto ds_type = static_cast<dataset_type>(m_data[m_scan_offset]);
+                        if (ds_type > dataset_type::jump) {
+                            if (ds_type == dataset_type::reset && m_scan_offset >= min_chunk_size) {
+                                return m_scan_offset;
+                            }
+                            ++m_scan_offset;
+                        } else {
+                            while (true) {
+                                const char* data = m_data + m_scan_offset + 1;
+                                uint64_t length = 0;
+                                try {
+                                    length = protozero::decode_varint(&data, m_end);
+                                } catch (const protozero::end_of_buffer_exception&) {
+                                    if (!ensure_bytes_available(m_scan_offset + 1 + protozero::max_varint_length)) {
+                                        throw o5m_error{"premature end of file"};
+                                    }
+                                    continue;
+                                }
+                                m_scan_offset = static_cast<std::size_t>(data - m_data) + length;
+                                break;
+                            }
+                            if (!ensure_bytes_available(m_scan_offset)) {
+                                throw o5m_error{"premature end of file"};
+                            }
+                        }
+                    }
+                    return scan_reached_max;
+                }
+
+                std::string extract_chunk(const std::size_t size) {
+                    std::string chunk{m_data, size};
+                    m_data += size;
+                    m_scan_offset -= size;
+                    return chunk;
+                }
+
+                /**
+                 * Decode a single chunk of o5m data starting at a Reset (or
+                 * at the beginning of the file body). The chunk is prefixed
+                 * with a file header and decoded by a nested O5mParser with
+                 * its own queues, the resulting buffers are returned in
+                 * order.
+                 *
+                 * Runs on a thread of the thread pool.
+                 */
+                static std::vector<osmium::memory::Buffer> decode_chunk(osmium::thread::Pool& pool,
+                                                                        std::string&& chunk,
+                                                                        const char file_type,
+                                                                        const osmium::osm_entity_bits::type read_which_entities,
+                                                                        const osmium::io::read_meta read_metadata,
+                                                                        const osmium::io::buffers_type buffers_kind) {
+                    std::string data{"\xff\xe0\x04o5"};
+                    data += file_type;
+                    data += '2';
+                    data += chunk;
+
+                    future_string_queue_type input_queue{2, "o5m_chunk_in"};
+                    future_buffer_queue_type output_queue{0, "o5m_chunk_out"};
+                    std::promise<osmium::io::Header> header_promise;
+
+                    parser_arguments args{pool, -1, input_queue, output_queue,
+                                          header_promise, nullptr,
+                                          read_which_entities, read_metadata,
+                                          osmium::io::read_tags::yes,
+                                          osmium::io::read_discussions::yes,
+                                          osmium::io::way_envelopes::no,
+                                          osmium::io::clean_way_nodes::no,
+                                          nullptr,
+                                          osmium::io::skip_damaged_blobs::no,
+                                          nullptr,
+                                          osmium::Box{},
+                                          buffers_kind, 0, false,
+                                          osmium::io::mapped_input::no, nullptr, nullptr};
+
+                    O5mParser parser{args};
+                    parser.m_enable_parallel = false;
+
+                    add_to_queue(input_queue, std::move(data));
+                    add_end_of_data_to_queue(input_queue);
+                    parser.parse();
+
+                    std::vector<osmium::memory::Buffer> buffers;
+                    queue_wrapper<osmium::memory::Buffer> queue{output_queue};
+                    while (!queue.has_reached_end_of_data()) {
+                        osmium::memory::Buffer buffer{queue.pop()};
+                        if (buffer) {
+                            buffers.push_back(std::move(buffer));
+                        }
+                    }
+
+                    return buffers;
+                }
+
+                using chunk_result_queue = std::deque<std::future<std::vector<osmium::memory::Buffer>>>;
+
+                void submit_chunk(chunk_result_queue& results, std::string&& chunk) {
+                    auto& pool = get_pool();
+                    const auto chunk_ptr = std::make_shared<std::string>(std::move(chunk));
+                    const auto file_type = m_file_type;
+                    const auto read_which_entities = read_types();
+                    const auto read_meta = read_metadata();
+                    const auto kind = buffers_kind();
+                    results.push_back(pool.submit([&pool, chunk_ptr, file_type, read_which_entities, read_meta, kind]() {
+                        return decode_chunk(pool, std::move(*chunk_ptr), file_type, read_which_entities, read_meta, kind);
+                    }));
+                }
+
+                void deliver_chunk_result(chunk_result_queue& results) {
+                    auto buffers = results.front().get();
+                    results.pop_front();
+                    for (auto& buffer : buffers) {
+                        send_to_output_queue(std::move(buffer));
+                    }
+                }
+
+                /**
+                 * Split the input at Reset datasets and decode the chunks
+                 * in parallel on the thread pool, sending the buffers
+                 * downstream in input order.
+                 *
+                 * The datasets before the first OSM object are decoded here,
+                 * so the header ends up in this parser. If a long stretch of
+                 * input contains no Reset (files not written by this library
+                 * may use them sparingly or not at all), decoding falls back
+                 * to sequential.
+                 */
+                void run_parallel() {
+                    enum : std::size_t {
+                        min_chunk_size = 1024UL * 1024UL,
+                        max_chunk_size = 64UL * 1024UL * 1024UL
+                    };
+
+                    decode_header_datasets();
+                    mark_header_as_done();
+
+                    if (read_types() == osmium::osm_entity_bits::nothing) {
+                        return;
+                    }
+
+                    chunk_result_queue results;
+                    const auto max_outstanding = static_cast<std::size_t>(get_pool().num_threads()) * 2;
+
+                    while (true) {
+                        const auto cut = find_cut_point(min_chunk_size, max_chunk_size);
+                        if (cut == scan_reached_max) {
+                            // No Reset in sight. The read position is at the
+                            // start of a section that begins in fresh decoder
+                            // state, so the rest of the file can be decoded
+                            // sequentially in this parser.
+                            while (!results.empty()) {
+                                deliver_chunk_result(results);
+                            }
+                            decode_data();
+                            return;
+                        }
+                        if (cut == scan_found_eof) {
+                            break;
+                        }
+                        submit_chunk(results, extract_chunk(cut));
+                        while (results.size() >= max_outstanding) {
+                            deliver_chunk_result(results);
+                        }
+                    }
+
+                    // The data after the last Reset in the file.
+                    if (m_scan_offset > 0) {
+                        submit_chunk(results, extract_chunk(m_scan_offset));
+                    }
+                    while (!results.empty()) {
+                        deliver_chunk_result(results);
+                    }
+                }
+
             public:
 
                 explicit O5mParser(parser_arguments& args) :
@@ -624,7 +913,15 @@ namespace osmium {
                     osmium::thread::set_thread_name("_osmium_o5m_in");
 
                     decode_header();
-                    decode_data();
+
+                    if (m_enable_parallel &&
+                        get_pool().num_threads() > 1 &&
+                        osmium::config::use_parallel_o5m_parsing()) {
+                        run_parallel();
+                        mark_header_as_done();
+                    } else {
+                        decode_data();
+                    }
                 }
 
             }; // class O5mParser
@@ -0,0 +1,420 @@
+#ifndef OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
+#define OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/output_format.hpp>
+#include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/metadata_options.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/node_ref.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/delta.hpp>
+#include <osmium/visitor.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            // Implementation of the o5m/o5c file formats according to the
+            // description at https://wiki.openstreetmap.org/wiki/O5m .
+
+            /**
+             * Keeps track of the strings recently written to the output so
+             * they can be written as back-references. This is the encoding
+             * counterpart of the ReferenceTable in the o5m parser: it must
+             * count exactly the strings a decoder will put into its table,
+             * ie. only strings written inline and not longer than the
+             * maximum entry size.
+             */
+            class O5mWriteReferenceTable {
+
+                // The following settings are from the o5m description:
+
+                enum : std::uint64_t {
+                    // The maximum number of entries in this table.
+                    number_of_entries = 15000UL
+                };
+
+                // The maximum length of a string in the table including
+                // two \0 bytes.
+                enum {
+                    max_length = 250U + 2U
+                };
+
+                // Maps the string to the position at which it was last
+                // written inline. Stale entries are pruned now and then so
+                // the map doesn't grow with the number of unique strings
+                // in the input.
+                std::unordered_map<std::string, std::uint64_t> m_index;
+
+                std::uint64_t m_counter = 0;
+
+                void prune() {
+                    for (auto it = m_index.begin(); it != m_index.end();) {
+                        if (m_counter - it->second >= number_of_entries) {
+                            it = m_index.erase(it);
+                        } else {
+                            ++it;
+                        }
+                    }
+                }
+
+            public:
+
+                /**
+                 * If the string was written inline recently enough, return
+                 * the back-reference (1 for the most recently written
+                 * string). Otherwise return 0 and remember the string; the
+                 * caller must then write it inline.
+                 */
+                std::uint64_t add_or_get_reference(const std::string& string) {
+                    if (string.size() > max_length) {
+                        return 0;
+                    }
+
+                    if (m_index.size() >= number_of_entries * 4) {
+                        prune();
+                    }
+
+                    auto& position = m_index[string];
+                    if (position != 0 && m_counter - position < number_of_entries) {
+                        return m_counter - position + 1;
+                    }
+
+                    position = ++m_counter;
+                    return 0;
+                }
+
+            }; // class O5mWriteReferenceTable
+
+            /**
+             * Writes out one buffer with OSM data in o5m format.
+             *
+             * Every block starts with a reset dataset (0xff), so the delta
+             * encoders and the string reference table start from scratch
+             * for each buffer. This makes the blocks independent of each
+             * other and they can be encoded in parallel on the thread pool,
+             * at the cost of slightly larger output.
+             */
+            class O5mOutputBlock : public OutputBlock {
+
+                osmium::metadata_options m_add_metadata;
+
+                O5mWriteReferenceTable m_reference_table;
+
+                osmium::DeltaEncode<osmium::object_id_type> m_delta_id;
+
+                osmium::DeltaEncode<std::int64_t> m_delta_timestamp;
+                osmium::DeltaEncode<osmium::changeset_id_type> m_delta_changeset;
+                osmium::DeltaEncode<std::int64_t> m_delta_lon;
+                osmium::DeltaEncode<std::int64_t> m_delta_lat;
+
+                osmium::DeltaEncode<osmium::object_id_type> m_delta_way_node_id;
+                std::array<osmium::DeltaEncode<osmium::object_id_type>, 3> m_delta_member_ids;
+
+                // The body of the current dataset. It has to be encoded
+                // separately from the output, because the dataset length
+                // comes before the dataset body in the output.
+                std::string m_dataset{};
+
+                static void append_varint(std::string& out, std::uint64_t value) {
+                    protozero::add_varint_to_buffer(&out, value);
+                }
+
+                static void append_zvarint(std::string& out, std::int64_t value) {
+                    append_varint(out, protozero::encode_zigzag64(value));
+                }
+
+                /**
+                 * Write a string (a key/value pair, uid/user pair, or
+                 * member type/role) either as a back-reference into the
+                 * string table or inline, prefixed with a \0 byte.
+                 */
+                void append_string(const std::string& string) {
+                    const auto reference = m_reference_table.add_or_get_reference(string);
+                    if (reference != 0) {
+                        append_varint(m_dataset, reference);
+                    } else {
+                        m_dataset += '\0';
+                        m_dataset += string;
+                    }
+                }
+
+                void append_tags(const osmium::TagList& tags) {
+                    std::string string;
+                    for (const auto& tag : tags) {
+                        string.clear();
+                        string += tag.key();
+                        string += '\0';
+                        string += tag.value();
+                        string += '\0';
+                        append_string(string);
+                    }
+                }
+
+                void append_info(const osmium::OSMObject& object) {
+                    // An info section always starts with the version, so
+                    // without a version there can be no other metadata
+                    // either. A \0 byte means "no info section".
+                    const std::uint64_t version = m_add_metadata.version() ? object.version() : 0;
+                    if (version == 0) {
+                        m_dataset += '\0';
+                        return;
+                    }
+
+                    append_varint(m_dataset, version);
+
+                    const std::int64_t timestamp = m_add_metadata.timestamp() ? std::int64_t(object.timestamp().seconds_since_epoch()) : 0;
+                    append_zvarint(m_dataset, m_delta_timestamp.update(timestamp));
+
+                    // The o5m format can only store changeset and user info
+                    // for objects that have a timestamp.
+                    if (timestamp != 0) {
+                        append_zvarint(m_dataset, m_delta_changeset.update(m_add_metadata.changeset() ? object.changeset() : 0));
+
+                        std::string string;
+                        append_varint(string, m_add_metadata.uid() ? object.uid() : 0);
+                        string += '\0';
+                        if (m_add_metadata.user()) {
+                            string += object.user();
+                        }
+                        string += '\0';
+                        append_string(string);
+                    }
+                }
+
+                void append_dataset(const char dataset_type) {
+                    *m_out += dataset_type;
+                    append_varint(*m_out, m_dataset.size());
+                    *m_out += m_dataset;
+                }
+
+            public:
+
+                O5mOutputBlock(osmium::memory::Buffer&& buffer, const osmium::metadata_options& add_metadata, osmium::memory::BufferPool* buffer_pool = nullptr, std::shared_ptr<const output_filter_type> filter = {}) :
+                    OutputBlock(std::move(buffer), buffer_pool, std::move(filter)),
+                    m_add_metadata(add_metadata) {
+                }
+
+                std::string operator()() {
+                    *m_out += '\xff'; // reset dataset
+
+                    apply_input(*this);
+
+                    std::string out;
+                    using std::swap;
+                    swap(out, *m_out);
+
+                    return out;
+                }
+
+                void node(const osmium::Node& node) {
+                    m_dataset.clear();
+
+                    append_zvarint(m_dataset, m_delta_id.update(node.id()));
+                    append_info(node);
+
+                    // A node without a location section is a deleted node.
+                    if (node.visible() && node.location()) {
+                        append_zvarint(m_dataset, m_delta_lon.update(node.location().x()));
+                        append_zvarint(m_dataset, m_delta_lat.update(node.location().y()));
+                        append_tags(node.tags());
+                    }
+
+                    append_dataset('\x10');
+                }
+
+                void way(const osmium::Way& way) {
+                    m_dataset.clear();
+
+                    append_zvarint(m_dataset, m_delta_id.update(way.id()));
+                    append_info(way);
+
+                    // A way without a reference section is a deleted way.
+                    if (way.visible()) {
+                        std::string refs;
+                        for (const auto& node_ref : way.nodes()) {
+                            append_zvarint(refs, m_delta_way_node_id.update(node_ref.ref()));
+                        }
+                        append_varint(m_dataset, refs.size());
+                        m_dataset += refs;
+
+                        append_tags(way.tags());
+                    }
+
+                    append_dataset('\x11');
+                }
+
+                void relation(const osmium::Relation& relation) {
+                    m_dataset.clear();
+
+                    append_zvarint(m_dataset, m_delta_id.update(relation.id()));
+                    append_info(relation);
+
+                    // A relation without a reference section is a deleted
+                    // relation.
+                    if (relation.visible()) {
+                        std::string refs;
+                        std::string string;
+                        for (const auto& member : relation.members()) {
+                            const auto i = osmium::item_type_to_nwr_index(member.type());
+                            append_zvarint(refs, m_delta_member_ids[i].update(member.ref()));
+
+                            string.clear();
+                            string += static_cast<char>('0' + i);
+                            string += member.role();
+                            string += '\0';
+
+                            const auto reference = m_reference_table.add_or_get_reference(string);
+                            if (reference != 0) {
+                                append_varint(refs, reference);
+                            } else {
+                                refs += '\0';
+                                refs += string;
+                            }
+                        }
+                        append_varint(m_dataset, refs.size());
+                        m_dataset += refs;
+
+                        append_tags(relation.tags());
+                    }
+
+                    append_dataset('\x12');
+                }
+
+            }; // class O5mOutputBlock
+
+            class O5mOutputFormat : public osmium::io::detail::OutputFormat {
+
+                osmium::metadata_options m_add_metadata;
+                bool m_write_change_file = false;
+
+            public:
+
+                O5mOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
+                    OutputFormat(pool, output_queue),
+                    m_add_metadata(resolve_generic_output_options(file).add_metadata),
+                    m_write_change_file(file.has_multiple_object_versions()) {
+                }
+
+                void write_header(const osmium::io::Header& header) final {
+                    std::string out;
+
+                    out += '\xff'; // reset dataset
+
+                    // header dataset with the file format version
+                    out += '\xe0';
+                    out += '\x04';
+                    out += m_write_change_file ? "o5c2" : "o5m2";
+
+                    const std::string timestamp{header.get("o5m_timestamp").empty() ?
+                                                header.get("timestamp") :
+                                                header.get("o5m_timestamp")};
+                    if (!timestamp.empty()) {
+                        std::string dataset;
+                        protozero::add_varint_to_buffer(&dataset, protozero::encode_zigzag64(std::int64_t(osmium::Timestamp{timestamp.c_str()}.seconds_since_epoch())));
+                        out += '\xdc'; // timestamp dataset
+                        protozero::add_varint_to_buffer(&out, dataset.size());
+                        out += dataset;
+                    }
+
+                    if (!header.boxes().empty()) {
+                        const osmium::Box box = header.joined_boxes();
+                        std::string dataset;
+                        protozero::add_varint_to_buffer(&dataset, protozero::encode_zigzag64(box.bottom_left().x()));
+                        protozero::add_varint_to_buffer(&dataset, protozero::encode_zigzag64(box.bottom_left().y()));
+                        protozero::add_varint_to_buffer(&dataset, protozero::encode_zigzag64(box.top_right().x()));
+                        protozero::add_varint_to_buffer(&dataset, protozero::encode_zigzag64(box.top_right().y()));
+                        out += '\xdb'; // bounding box dataset
+                        protozero::add_varint_to_buffer(&out, dataset.size());
+                        out += dataset;
+                    }
+
+                    send_to_output_queue(std::move(out));
+                }
+
+                void write_buffer(osmium::memory::Buffer&& buffer) final {
+                    m_output_queue.push(m_pool.submit(O5mOutputBlock{std::move(buffer), m_add_metadata, m_buffer_pool, m_filter}));
+                }
+
+                void write_end() final {
+                    // end-of-file dataset, optional in the o5m format
+                    send_to_output_queue(std::string{"\xfe", 1});
+                }
+
+            }; // class O5mOutputFormat
+
+            // we want the register_output_format() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_o5m_output = osmium::io::detail::OutputFormatFactory::instance().register_output_format(osmium::io::file_format::o5m,
+                [](osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) {
+                    return new osmium::io::detail::O5mOutputFormat(pool, file, output_queue);
+            });
+
+            // dummy function to silence the unused variable warning from above
+            inline bool get_registered_o5m_output() noexcept {
+                return registered_o5m_output;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
@@ -133,7 +133,10 @@ namespace osmium {
                             break;
                     }
 
-                    if (opl_parse_line(m_line_count, data, buffer(), read_types())) {
+                    // Assemble the object in the scratch buffer and
+                    // block-copy it into the main buffer in one go.
+                    if (opl_parse_line(m_line_count, data, scratch_buffer(), read_types())) {
+                        append_scratch_buffer();
                         flush_nested_buffer();
                     }
                     ++m_line_count;
@@ -56,8 +56,8 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/thread/pool.hpp>
 #include <osmium/visitor.hpp>
 
+#include <cstddef>
 #include <cstdint>
-#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -88,22 +88,53 @@ namespace osmium {
 
                 opl_output_options m_options;
 
+                /**
+                 * Each object is formatted into this line buffer which is
+                 * then appended to the block output in one piece. It points
+                 * to the thread-local buffer from the OutputBlock base
+                 * class, so its capacity is kept across objects and blocks
+                 * and formatting a line does not allocate.
+                 */
+                std::string* m_line = nullptr;
+
+                enum {
+                    max_coordinate_length = 12 // "-214.7483648"
+                };
+
+                /// Write a location coordinate in fixed-point format.
+                static void append_coordinate(std::string& out, const int32_t value) {
+                    const auto old_size = out.size();
+                    out.resize(old_size + max_coordinate_length);
+                    char* const begin = &out[old_size];
+                    const char* const end = osmium::detail::append_location_coordinate_to_string(begin, value);
+                    out.resize(old_size + static_cast<std::size_t>(end - begin));
+                }
+
+                void start_line() {
+                    m_line = &thread_local_line_buffer();
+                }
+
+                void finish_line() {
+                    m_out->append(*m_line);
+                }
+
                 void append_encoded_string(const char* data) {
-                    osmium::io::detail::append_utf8_encoded_string(*m_out, data);
+                    osmium::io::detail::append_utf8_encoded_string(*m_line, data);
                 }
 
                 void write_field_int(char c, int64_t value) {
-                    *m_out += c;
-                    output_int(value);
+                    *m_line += c;
+                    append_int(*m_line, value);
                 }
 
                 void write_field_timestamp(char c, const osmium::Timestamp& timestamp) {
-                    *m_out += c;
-                    *m_out += timestamp.to_iso();
+                    *m_line += c;
+                    char buffer[osmium::Timestamp::max_length];
+                    m_line->append(buffer, timestamp.to_iso(buffer));
                 }
 
                 void write_tags(const osmium::TagList& tags) {
-                    *m_out += " T";
+                    *m_line += " T";
 
                     if (tags.empty()) {
                         return;
@@ -111,40 +142,40 @@ namespace osmium {
 
                     auto it = tags.begin();
                     append_encoded_string(it->key());
-                    *m_out += '=';
+                    *m_line += '=';
                     append_encoded_string(it->value());
 
                     for (++it; it != tags.end(); ++it) {
-                        *m_out += ',';
+                        *m_line += ',';
                         append_encoded_string(it->key());
-                        *m_out += '=';
+                        *m_line += '=';
                         append_encoded_string(it->value());
                     }
                 }
 
                 void write_meta(const osmium::OSMObject& object) {
-                    output_int(object.id());
+                    append_int(*m_line, object.id());
                     if (m_options.add_metadata.any()) {
                         if (m_options.add_metadata.version()) {
-                            *m_out += ' ';
+                            *m_line += ' ';
                             write_field_int('v', object.version());
                         }
-                        *m_out += " d";
-                        *m_out += (object.visible() ? 'V' : 'D');
+                        *m_line += " d";
+                        *m_line += (object.visible() ? 'V' : 'D');
                         if (m_options.add_metadata.changeset()) {
-                            *m_out += ' ';
+                            *m_line += ' ';
                             write_field_int('c', object.changeset());
                         }
                         if (m_options.add_metadata.timestamp()) {
-                            *m_out += ' ';
+                            *m_line += ' ';
                             write_field_timestamp('t', object.timestamp());
                         }
                         if (m_options.add_metadata.uid()) {
-                            *m_out += ' ';
+                            *m_line += ' ';
                             write_field_int('i', object.uid());
                         }
                         if (m_options.add_metadata.user()) {
-                            *m_out += " u";
+                            *m_line += " u";
                             append_encoded_string(object.user());
                         }
                     }
@@ -153,33 +184,33 @@ namespace osmium {
 
                 void write_location(const osmium::Location& location, const char x, const char y) {
                     const bool not_undefined = !location.is_undefined();
-                    *m_out += ' ';
-                    *m_out += x;
+                    *m_line += ' ';
+                    *m_line += x;
                     if (not_undefined) {
-                        osmium::detail::append_location_coordinate_to_string(std::back_inserter(*m_out), location.x());
+                        append_coordinate(*m_line, location.x());
                     }
-                    *m_out += ' ';
-                    *m_out += y;
+                    *m_line += ' ';
+                    *m_line += y;
                     if (not_undefined) {
-                        osmium::detail::append_location_coordinate_to_string(std::back_inserter(*m_out), location.y());
+                        append_coordinate(*m_line, location.y());
                     }
                 }
 
                 void write_diff(const osmium::OSMObject& object) {
                     if (m_options.format_as_diff) {
-                        *m_out += object.diff_as_char();
+                        *m_line += object.diff_as_char();
                     }
                 }
 
             public:
 
-                OPLOutputBlock(osmium::memory::Buffer&& buffer, const opl_output_options& options) :
-                    OutputBlock(std::move(buffer)),
+                OPLOutputBlock(osmium::memory::Buffer&& buffer, const opl_output_options& options, osmium::memory::BufferPool* buffer_pool = nullptr, std::shared_ptr<const output_filter_type> filter = {}) :
+                    OutputBlock(std::move(buffer), buffer_pool, std::move(filter)),
                     m_options(options) {
                 }
 
                 std::string operator()() {
-                    osmium::apply(m_input_buffer->cbegin(), m_input_buffer->cend(), *this);
+                    apply_input(*this);
 
                     std::string out;
                     using std::swap;
@@ -189,94 +220,106 @@ namespace osmium {
                 }
 
                 void node(const osmium::Node& node) {
+                    start_line();
                     write_diff(node);
-                    *m_out += 'n';
+                    *m_line += 'n';
                     write_meta(node);
                     write_location(node.location(), 'x', 'y');
-                    *m_out += '\n';
+                    *m_line += '\n';
+                    finish_line();
                 }
 
                 void write_field_ref(const osmium::NodeRef& node_ref) {
                     write_field_int('n', node_ref.ref());
-                    *m_out += 'x';
+                    *m_line += 'x';
                     if (node_ref.location()) {
-                        node_ref.location().as_string(std::back_inserter(*m_out), 'y');
+                        const auto old_size = m_line->size();
+                        m_line->resize(old_size + 2 * max_coordinate_length + 1);
+                        char* const begin = &(*m_line)[old_size];
+                        const char* const end = node_ref.location().as_string(begin, 'y');
+                        m_line->resize(old_size + static_cast<std::size_t>(end - begin));
                     } else {
-                        *m_out += 'y';
+                        *m_line += 'y';
                     }
                 }
 
                 void way(const osmium::Way& way) {
+                    start_line();
                     write_diff(way);
-                    *m_out += 'w';
+                    *m_line += 'w';
                     write_meta(way);
 
-                    *m_out += " N";
+                    *m_line += " N";
 
                     if (!way.nodes().empty()) {
                         const auto* it = way.nodes().cbegin();
                         if (m_options.locations_on_ways) {
                             write_field_ref(*it);
                             for (++it; it != way.nodes().end(); ++it) {
-                                *m_out += ',';
+                                *m_line += ',';
                                 write_field_ref(*it);
                             }
                         } else {
                             write_field_int('n', it->ref());
                             for (++it; it != way.nodes().end(); ++it) {
-                                *m_out += ',';
+                                *m_line += ',';
                                 write_field_int('n', it->ref());
                             }
                         }
                     }
 
-                    *m_out += '\n';
+                    *m_line += '\n';
+                    finish_line();
                 }
 
                 void relation_member(const osmium::RelationMember& member) {
-                    *m_out += item_type_to_char(member.type());
-                    output_int(member.ref());
-                    *m_out += '@';
+                    *m_line += item_type_to_char(member.type());
+                    append_int(*m_line, member.ref());
+                    *m_line += '@';
                     append_encoded_string(member.role());
                 }
 
                 void relation(const osmium::Relation& relation) {
+                    start_line();
                     write_diff(relation);
-                    *m_out += 'r';
+                    *m_line += 'r';
                     write_meta(relation);
 
-                    *m_out += " M";
+                    *m_line += " M";
 
                     if (!relation.members().empty()) {
                         auto it = relation.members().begin();
                         relation_member(*it);
                         for (++it; it != relation.members().end(); ++it) {
-                            *m_out += ',';
+                            *m_line += ',';
                             relation_member(*it);
                         }
                     }
 
-                    *m_out += '\n';
+                    *m_line += '\n';
+                    finish_line();
                 }
 
                 void changeset(const osmium::Changeset& changeset) {
+                    start_line();
                     write_field_int('c', changeset.id());
-                    *m_out += ' ';
+                    *m_line += ' ';
                     write_field_int('k', changeset.num_changes());
-                    *m_out += ' ';
+                    *m_line += ' ';
                     write_field_timestamp('s', changeset.created_at());
-                    *m_out += ' ';
+                    *m_line += ' ';
                     write_field_timestamp('e', changeset.closed_at());
-                    *m_out += ' ';
+                    *m_line += ' ';
                     write_field_int('d', changeset.num_comments());
-                    *m_out += ' ';
+                    *m_line += ' ';
                     write_field_int('i', changeset.uid());
-                    *m_out += " u";
+                    *m_line += " u";
                     append_encoded_string(changeset.user());
                     write_location(changeset.bounds().bottom_left(), 'x', 'y');
                     write_location(changeset.bounds().top_right(), 'X', 'Y');
                     write_tags(changeset.tags());
-                    *m_out += '\n';
+                    *m_line += '\n';
+                    finish_line();
                 }
 
             }; // class OPLOutputBlock
@@ -289,13 +332,14 @@ namespace osmium {
 
                 OPLOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
                     OutputFormat(pool, output_queue) {
-                    m_options.add_metadata      = osmium::metadata_options{file.get("add_metadata")};
-                    m_options.locations_on_ways = file.is_true("locations_on_ways");
-                    m_options.format_as_diff    = file.is_true("diff");
+                    const auto generic_options = resolve_generic_output_options(file);
+                    m_options.add_metadata      = generic_options.add_metadata;
+                    m_options.locations_on_ways = generic_options.locations_on_ways;
+                    m_options.format_as_diff    = generic_options.format_as_diff;
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    m_output_queue.push(m_pool.submit(OPLOutputBlock{std::move(buffer), m_options}));
+                    m_output_queue.push(m_pool.submit(OPLOutputBlock{std::move(buffer), m_options, m_buffer_pool, m_filter}));
                 }
 
             }; // class OPLOutputFormat
@@ -46,15 +46,39 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/timestamp.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/osm/types_from_string.hpp>
 #include <osmium/osm/way.hpp>
+#include <osmium/util/endian.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iterator>
 #include <limits>
 #include <stdexcept>
 #include <string>
 
+// The vectorized scanning functions read entire aligned 16 byte chunks.
+// They never read across a page boundary, but they do read beyond the
+// terminating null byte, which AddressSanitizer reports as an overflow,
+// so fall back to the scalar versions in sanitized builds.
+#ifdef __SSE2__
+# if defined(__SANITIZE_ADDRESS__)
+#  undef OSMIUM_USE_SSE2_OPL_SCAN
+# elif defined(__has_feature)
+#  if !__has_feature(address_sanitizer)
+#   define OSMIUM_USE_SSE2_OPL_SCAN
+#  endif
+# else
+#  define OSMIUM_USE_SSE2_OPL_SCAN
+# endif
+#endif
+
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+# include <emmintrin.h>
+#endif
+
 namespace osmium {
 
     namespace builder {
@@ -126,14 +150,132 @@ namespace osmium {
                 return *s != '\0' && *s != ' ' && *s != '\t';
             }
 
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+            /// Get the number of the lowest set bit in the non-zero mask.
+            inline int opl_first_set_bit(const int mask) noexcept {
+                return __builtin_ctz(static_cast<unsigned int>(mask));
+            }
+#endif
+
+            /**
+             * Find the first space or tab character or the end of the
+             * string.
+             *
+             * On platforms with SSE2 this scans 16 bytes at a time. The
+             * scalar prologue gets us to an aligned address first, so the
+             * vector loads can never cross a page boundary even when they
+             * read beyond the terminating null byte.
+             */
+            inline const char* opl_find_end_of_section(const char* s) noexcept {
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+                while (reinterpret_cast<uintptr_t>(s) % 16 != 0) {
+                    if (*s == '\0' || *s == ' ' || *s == '\t') {
+                        return s;
+                    }
+                    ++s;
+                }
+                const __m128i zero  = _mm_setzero_si128();
+                const __m128i space = _mm_set1_epi8(' ');
+                const __m128i tab   = _mm_set1_epi8('\t');
+                while (true) {
+                    const __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i*>(s));
+                    const __m128i match = _mm_or_si128(_mm_cmpeq_epi8(chunk, zero),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                                       _mm_cmpeq_epi8(chunk, tab)));
+                    const int mask = _mm_movemask_epi8(match);
+                    if (mask != 0) {
+                        return s + opl_first_set_bit(mask);
+                    }
+                    s += 16;
+                }
+#else
+                while (opl_non_empty(s)) {
+                    ++s;
+                }
+                return s;
+#endif
+            }
+
+            /**
+             * Find the first character that ends a string: space, tab,
+             * comma, equal sign, the start of a '%' escape, or the end of
+             * the string. Vectorized like opl_find_end_of_section().
+             */
+            inline const char* opl_find_end_of_string(const char* s) noexcept {
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+                while (reinterpret_cast<uintptr_t>(s) % 16 != 0) {
+                    if (*s == '\0' || *s == ' ' || *s == '\t' || *s == ',' || *s == '=' || *s == '%') {
+                        return s;
+                    }
+                    ++s;
+                }
+                const __m128i zero    = _mm_setzero_si128();
+                const __m128i space   = _mm_set1_epi8(' ');
+                const __m128i tab     = _mm_set1_epi8('\t');
+                const __m128i comma   = _mm_set1_epi8(',');
+                const __m128i equal   = _mm_set1_epi8('=');
+                const __m128i percent = _mm_set1_epi8('%');
+                while (true) {
+                    const __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i*>(s));
+                    const __m128i match = _mm_or_si128(
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, zero),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                                       _mm_cmpeq_epi8(chunk, tab))),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, comma),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, equal),
+                                                       _mm_cmpeq_epi8(chunk, percent))));
+                    const int mask = _mm_movemask_epi8(match);
+                    if (mask != 0) {
+                        return s + opl_first_set_bit(mask);
+                    }
+                    s += 16;
+                }
+#else
+                while (*s != '\0' && *s != ' ' && *s != '\t' && *s != ',' && *s != '=' && *s != '%') {
+                    ++s;
+                }
+                return s;
+#endif
+            }
+
+            /**
+             * Find the first character that is not an ASCII digit.
+             * Vectorized like opl_find_end_of_section().
+             */
+            inline const char* opl_find_end_of_digits(const char* s) noexcept {
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+                while (reinterpret_cast<uintptr_t>(s) % 16 != 0) {
+                    if (*s < '0' || *s > '9') {
+                        return s;
+                    }
+                    ++s;
+                }
+                const __m128i below_zero = _mm_set1_epi8('0');
+                const __m128i above_nine = _mm_set1_epi8('9');
+                while (true) {
+                    const __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i*>(s));
+                    const __m128i match = _mm_or_si128(_mm_cmplt_epi8(chunk, below_zero),
+                                                       _mm_cmpgt_epi8(chunk, above_nine));
+                    const int mask = _mm_movemask_epi8(match);
+                    if (mask != 0) {
+                        return s + opl_first_set_bit(mask);
+                    }
+                    s += 16;
+                }
+#else
+                while (*s >= '0' && *s <= '9') {
+                    ++s;
+                }
+                return s;
+#endif
+            }
+
             /**
              * Skip to the next space or tab character or the end of the
              * string.
              */
             inline const char* opl_skip_section(const char** s) noexcept {
-                while (opl_non_empty(*s)) {
-                    ++*s;
-                }
+                *s = opl_find_end_of_section(*s);
                 return *s;
             }
 
@@ -192,16 +334,14 @@ namespace osmium {
                 assert(*data);
                 const char* s = *data;
                 while (true) {
-                    if (*s == '\0' || *s == ' ' || *s == '\t' || *s == ',' || *s == '=') {
+                    const char* start = s;
+                    s = opl_find_end_of_string(s);
+                    result.append(start, s);
+                    if (*s != '%') {
                         break;
                     }
-                    if (*s == '%') {
-                        ++s;
-                        opl_parse_escaped(&s, result);
-                    } else {
-                        result += *s;
-                        ++s;
-                    }
+                    ++s;
+                    opl_parse_escaped(&s, result);
                 }
                 *data = s;
             }
@@ -218,15 +358,24 @@ namespace osmium {
                 }
 
                 int64_t value = 0;
-                while (**s >= '0' && **s <= '9') {
-                    if (value <= -922337203685477580) {
-                        if ((value < -922337203685477580) || (**s > '8')) {
-                            throw opl_error("integer too long", *s);
+                const char* const end = opl_find_end_of_digits(*s);
+                if (end - *s <= 18) {
+                    // the common case: 18 digits or less can not overflow
+                    // an int64_t, so the digits can be parsed in batches
+                    // without any checks
+                    value = -static_cast<int64_t>(osmium::detail::parse_digits_unchecked(*s, static_cast<std::size_t>(end - *s)));
+                    *s = end;
+                } else {
+                    while (**s >= '0' && **s <= '9') {
+                        if (value <= -922337203685477580) {
+                            if ((value < -922337203685477580) || (**s > '8')) {
+                                throw opl_error("integer too long", *s);
+                            }
                         }
+                        value *= 10;
+                        value -= **s - '0';
+                        ++*s;
                     }
-                    value *= 10;
-                    value -= **s - '0';
-                    ++*s;
                 }
 
                 if (negative) {
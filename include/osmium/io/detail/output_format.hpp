@@ -35,11 +35,15 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/handler.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/detail/string_pool.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+#include <osmium/osm/metadata_options.hpp>
 #include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
 
 #include <array>
 #include <cstdint>
@@ -58,6 +62,61 @@ namespace osmium {
 
         namespace detail {
 
+            /// Type of the predicate deciding which entities are written.
+            using output_filter_type = std::function<bool(const osmium::OSMEntity&)>;
+
+            /**
+             * The generic options understood by all or most output formats,
+             * resolved from the string map of a File in a single pass by
+             * resolve_generic_output_options(). The format implementations
+             * take these settings from here instead of each doing its own
+             * string lookups in the map; the map itself stays the extension
+             * point for format-specific and user options.
+             */
+            struct generic_output_options {
+
+                osmium::metadata_options add_metadata{};
+                bool locations_on_ways = false;
+                bool format_as_diff = false;
+
+            }; // struct generic_output_options
+
+            inline bool option_value_is_true(const std::string& value) noexcept {
+                return value == "true" || value == "yes";
+            }
+
+            inline generic_output_options resolve_generic_output_options(const osmium::io::File& file) {
+                generic_output_options options;
+                for (const auto& option : file) {
+                    if (option.first == "add_metadata") {
+                        options.add_metadata = osmium::metadata_options{option.second};
+                    } else if (option.first == "locations_on_ways") {
+                        options.locations_on_ways = option_value_is_true(option.second);
+                    } else if (option.first == "diff") {
+                        options.format_as_diff = option_value_is_true(option.second);
+                    }
+                }
+                return options;
+            }
+
+            /**
+             * Wrap an input buffer into a shared_ptr shared by all encoding
+             * tasks working on it. If a buffer pool is set, the buffer is
+             * released back into that pool once the last task is done with
+             * it, otherwise it is simply destroyed.
+             */
+            inline std::shared_ptr<osmium::memory::Buffer> make_input_buffer(osmium::memory::Buffer&& buffer, osmium::memory::BufferPool* buffer_pool) {
+                if (!buffer_pool) {
+                    return std::make_shared<osmium::memory::Buffer>(std::move(buffer));
+                }
+                return std::shared_ptr<osmium::memory::Buffer>{
+                    new osmium::memory::Buffer{std::move(buffer)},
+                    [buffer_pool](osmium::memory::Buffer* b) {
+                        buffer_pool->release(std::move(*b));
+                        delete b;
+                    }};
+            }
+
             class OutputBlock : public osmium::handler::Handler {
 
             protected:
@@ -66,17 +125,52 @@ namespace osmium {
 
                 std::shared_ptr<std::string> m_out;
 
-                explicit OutputBlock(osmium::memory::Buffer&& buffer) :
-                    m_input_buffer(std::make_shared<osmium::memory::Buffer>(std::move(buffer))),
-                    m_out(std::make_shared<std::string>()) {
+                std::shared_ptr<const output_filter_type> m_filter;
+
+                explicit OutputBlock(osmium::memory::Buffer&& buffer, osmium::memory::BufferPool* buffer_pool = nullptr, std::shared_ptr<const output_filter_type> filter = {}) :
+                    m_input_buffer(make_input_buffer(std::move(buffer), buffer_pool)),
+                    m_out(std::make_shared<std::string>(StringPool::instance().get())),
+                    m_filter(std::move(filter)) {
+                }
+
+                /**
+                 * Apply all entities in the input buffer to the given
+                 * handler, skipping the entities rejected by the filter
+                 * if one is set.
+                 */
+                template <typename THandler>
+                void apply_input(THandler& handler) {
+                    if (m_filter) {
+                        for (auto it = m_input_buffer->cbegin(); it != m_input_buffer->cend(); ++it) {
+                            if ((*m_filter)(*it)) {
+                                osmium::apply_item(*it, handler);
+                            }
+                        }
+                    } else {
+                        osmium::apply(m_input_buffer->cbegin(), m_input_buffer->cend(), handler);
+                    }
+                }
+
+                /**
+                 * Returns a thread-local string for assembling the output
+                 * for a single object before it is appended to the block
+                 * output in one piece. The buffer is cleared but keeps its
+                 * capacity. It is reused for all objects and blocks handled
+                 * by the same worker thread, so after a short warm-up phase
+                 * using it does not allocate any more.
+                 */
+                static std::string& thread_local_line_buffer() {
+                    thread_local std::string buffer;
+                    buffer.clear();
+                    return buffer;
                 }
 
                 // Simple function to convert integer to string. This is much
                 // faster than using sprintf, but could be further optimized.
                 // See https://github.com/miloyip/itoa-benchmark .
-                void output_int(int64_t value) {
+                static void append_int(std::string& out, int64_t value) {
                     if (value < 0) {
-                        *m_out += '-';
+                        out += '-';
                         value = -value;
                     }
 
@@ -87,14 +181,18 @@ namespace osmium {
                         value /= 10;
                     } while (value > 0);
 
-                    const auto old_size = m_out->size();
-                    m_out->resize(old_size + (t - temp));
-                    char* data = &(*m_out)[old_size];
+                    const auto old_size = out.size();
+                    out.resize(old_size + (t - temp));
+                    char* data = &out[old_size];
                     do {
                         *data++ = *--t;
                     } while (t != temp);
                 }
 
+                void output_int(int64_t value) {
+                    append_int(*m_out, value);
+                }
+
             }; // class OutputBlock;
 
             /**
@@ -110,6 +208,8 @@ namespace osmium {
 
                 osmium::thread::Pool& m_pool;
                 future_string_queue_type& m_output_queue;
+                osmium::memory::BufferPool* m_buffer_pool = nullptr;
+                std::shared_ptr<const output_filter_type> m_filter{};
 
                 /**
                  * Wrap the string into a future and add it to the output
@@ -134,6 +234,26 @@ namespace osmium {
 
                 virtual ~OutputFormat() noexcept = default;
 
+                /**
+                 * Set the buffer pool that input buffers are released into
+                 * after the encoding tasks have consumed them. If this is
+                 * not called, consumed buffers are simply destroyed.
+                 */
+                void set_buffer_pool(osmium::memory::BufferPool* buffer_pool) noexcept {
+                    m_buffer_pool = buffer_pool;
+                }
+
+                /**
+                 * Set the predicate deciding which entities are written.
+                 * Evaluated during serialization, shared by all encoding
+                 * tasks, so it must be safe to call concurrently.
+                 */
+                void set_filter(output_filter_type filter) {
+                    if (filter) {
+                        m_filter = std::make_shared<const output_filter_type>(std::move(filter));
+                    }
+                }
+
                 virtual void write_header(const osmium::io::Header& /*header*/) {
                 }
 
@@ -215,7 +335,10 @@ namespace osmium {
 
                 ~BlackholeOutputFormat() noexcept override = default;
 
-                void write_buffer(osmium::memory::Buffer&& /*buffer*/) override {
+                void write_buffer(osmium::memory::Buffer&& buffer) override {
+                    if (m_buffer_pool) {
+                        m_buffer_pool->release(std::move(buffer));
+                    }
                 }
 
             }; // class BlackholeOutputFormat
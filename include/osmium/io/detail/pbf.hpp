@@ -87,7 +87,11 @@ namespace osmium {
                     return pbf_compression::none;
                 }
                 if (val == "lz4") {
+#ifdef OSMIUM_WITH_LZ4
                     return pbf_compression::lz4;
+#else
+                    throw std::invalid_argument{"The 'pbf_compression' option is set to 'lz4', but libosmium was built without LZ4 support."};
+#endif
                 }
                 throw std::invalid_argument{"Unknown value for 'pbf_compression' option."};
             }
@@ -33,6 +33,9 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <atomic>
+#include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <limits>
@@ -45,10 +48,13 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
 #include <osmium/io/detail/protobuf_tags.hpp>
+#include <osmium/io/detail/varint_decoder.hpp>
 #include <osmium/io/detail/zlib.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+#include <osmium/memory/slab_allocator.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/osm/item_type.hpp>
@@ -60,11 +66,14 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 #include <osmium/util/delta.hpp>
+#include <osmium/util/memory_mapping.hpp>
+#include <osmium/util/probes.hpp>
 
 #ifdef OSMIUM_WITH_LZ4
 # include <osmium/io/detail/lz4.hpp>
 #endif
 
+#include <protozero/exception.hpp>
 #include <protozero/iterators.hpp>
 #include <protozero/pbf_message.hpp>
 #include <protozero/types.hpp>
@@ -152,9 +161,23 @@ namespace osmium {
 
                 osmium::osm_entity_bits::type m_read_types;
 
-                osmium::memory::Buffer m_buffer{initial_buffer_size, osmium::memory::Buffer::auto_grow::internal};
+                osmium::memory::Buffer m_buffer;
 
                 osmium::io::read_meta m_read_metadata;
+                osmium::io::read_tags m_read_tags;
+                osmium::io::way_envelopes m_way_envelopes;
+                osmium::io::clean_way_nodes m_clean_way_nodes;
+                std::atomic<std::uint64_t>* m_duplicate_nodes_counter;
+                osmium::Box m_filter_box;
+
+                // Does the location filter drop a (visible) node at this
+                // location? Invalid locations are kept, we can't tell
+                // where they are.
+                bool filtered_out(const osmium::Location& location) const noexcept {
+                    return m_filter_box.valid() &&
+                           location.valid() &&
+                           !m_filter_box.contains(location);
+                }
 
                 void decode_stringtable(const data_view& data) {
                     if (!m_stringtable.empty()) {
@@ -193,6 +216,13 @@ namespace osmium {
                     }
                 }
 
+                // The read types are a template parameter here, the
+                // decode loop is instantiated once for every possible
+                // subset of node/way/relation. This way the per-group
+                // checks are resolved at compile time and the decode
+                // paths for unwanted types drop out of the instantiation
+                // completely.
+                template <osmium::osm_entity_bits::type TReadTypes>
                 void decode_primitive_block_data() {
                     protozero::pbf_message<OSMFormat::PrimitiveBlock> pbf_primitive_block{m_data};
                     while (pbf_primitive_block.next(OSMFormat::PrimitiveBlock::repeated_PrimitiveGroup_primitivegroup, protozero::pbf_wire_type::length_delimited)) {
@@ -200,15 +230,18 @@ namespace osmium {
                         while (pbf_primitive_group.next()) {
                             switch (pbf_primitive_group.tag_and_type()) {
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes, protozero::pbf_wire_type::length_delimited):
-                                    if (m_read_types & osmium::osm_entity_bits::node) {
-                                        decode_node(pbf_primitive_group.get_view());
-                                        m_buffer.commit();
+                                    if (TReadTypes & osmium::osm_entity_bits::node) {
+                                        if (decode_node(pbf_primitive_group.get_view())) {
+                                            m_buffer.commit();
+                                        } else {
+                                            m_buffer.rollback();
+                                        }
                                     } else {
                                         pbf_primitive_group.skip();
                                     }
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, protozero::pbf_wire_type::length_delimited):
-                                    if (m_read_types & osmium::osm_entity_bits::node) {
+                                    if (TReadTypes & osmium::osm_entity_bits::node) {
                                         if (m_read_metadata == osmium::io::read_meta::yes) {
                                             decode_dense_nodes(pbf_primitive_group.get_view());
                                         } else {
@@ -220,7 +253,7 @@ namespace osmium {
                                     }
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Way_ways, protozero::pbf_wire_type::length_delimited):
-                                    if (m_read_types & osmium::osm_entity_bits::way) {
+                                    if (TReadTypes & osmium::osm_entity_bits::way) {
                                         decode_way(pbf_primitive_group.get_view());
                                         m_buffer.commit();
                                     } else {
@@ -228,7 +261,7 @@ namespace osmium {
                                     }
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Relation_relations, protozero::pbf_wire_type::length_delimited):
-                                    if (m_read_types & osmium::osm_entity_bits::relation) {
+                                    if (TReadTypes & osmium::osm_entity_bits::relation) {
                                         decode_relation(pbf_primitive_group.get_view());
                                         m_buffer.commit();
                                     } else {
@@ -242,6 +275,40 @@ namespace osmium {
                     }
                 }
 
+                void decode_primitive_block_data_dispatch() {
+                    using osmium::osm_entity_bits::node;
+                    using osmium::osm_entity_bits::way;
+                    using osmium::osm_entity_bits::relation;
+
+                    // The switch is on the underlying type because some of
+                    // the bit combinations have no named enumerator.
+                    switch (static_cast<unsigned char>(m_read_types & osmium::osm_entity_bits::nwr)) {
+                        case osmium::osm_entity_bits::nothing:
+                            break;
+                        case node:
+                            decode_primitive_block_data<node>();
+                            break;
+                        case way:
+                            decode_primitive_block_data<way>();
+                            break;
+                        case relation:
+                            decode_primitive_block_data<relation>();
+                            break;
+                        case node | way:
+                            decode_primitive_block_data<node | way>();
+                            break;
+                        case node | relation:
+                            decode_primitive_block_data<node | relation>();
+                            break;
+                        case way | relation:
+                            decode_primitive_block_data<way | relation>();
+                            break;
+                        default:
+                            decode_primitive_block_data<osmium::osm_entity_bits::nwr>();
+                            break;
+                    }
+                }
+
                 osm_string_len_type decode_info(const data_view& data, osmium::OSMObject& object) {
                     osm_string_len_type user{"", 0};
 
@@ -296,11 +363,29 @@ namespace osmium {
                     return user;
                 }
 
+                // Add up the sizes of the strings making up the tags. The
+                // string lengths are known from the string table, so the
+                // buffer space for the whole tag list can be reserved in
+                // one go before it is built. Takes the varint ranges by
+                // value, decoding them a second time is much cheaper than
+                // growing the buffer halfway through a tag list.
+                std::size_t tag_list_size(varint_range keys, varint_range vals) const {
+                    std::size_t size = sizeof(osmium::TagList);
+                    while (!keys.empty() && !vals.empty()) {
+                        size += m_stringtable.at(keys.next_uint32()).second;
+                        size += m_stringtable.at(vals.next_uint32()).second;
+                        size += 2; // the \0 bytes after key and value
+                    }
+                    return osmium::memory::padded_length(size);
+                }
+
                 void build_tag_list(osmium::builder::Builder& parent, varint_range& keys, varint_range& vals) {
                     if (keys.empty() || vals.empty()) {
                         return;
                     }
 
+                    parent.reserve(tag_list_size(keys, vals));
+
                     osmium::builder::TagListBuilder builder{parent};
                     do {
                         const auto& k = m_stringtable.at(keys.next_uint32());
@@ -317,7 +402,11 @@ namespace osmium {
                     return static_cast<int32_t>((c * m_granularity + m_lat_offset) / resolution_convert);
                 }
 
-                void decode_node(const data_view& data) {
+                // Returns false if the node was dropped by the location
+                // filter. The caller has to roll the buffer back then,
+                // for a plain node the location is only known after the
+                // whole message has been decoded.
+                bool decode_node(const data_view& data) {
                     osmium::builder::NodeBuilder builder{m_buffer};
                     osmium::Node& node = builder.object();
 
@@ -335,10 +424,18 @@ namespace osmium {
                                 node.set_id(pbf_node.get_sint64());
                                 break;
                             case protozero::tag_and_type(OSMFormat::Node::packed_uint32_keys, protozero::pbf_wire_type::length_delimited):
-                                keys = varint_range{pbf_node.get_view()};
+                                if (m_read_tags == osmium::io::read_tags::yes) {
+                                    keys = varint_range{pbf_node.get_view()};
+                                } else {
+                                    pbf_node.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Node::packed_uint32_vals, protozero::pbf_wire_type::length_delimited):
-                                vals = varint_range{pbf_node.get_view()};
+                                if (m_read_tags == osmium::io::read_tags::yes) {
+                                    vals = varint_range{pbf_node.get_view()};
+                                } else {
+                                    pbf_node.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Node::optional_Info_info, protozero::pbf_wire_type::length_delimited):
                                 if (m_read_metadata == osmium::io::read_meta::yes) {
@@ -363,15 +460,19 @@ namespace osmium {
                             lat == std::numeric_limits<int64_t>::max()) {
                             throw osmium::pbf_error{"illegal coordinate format"};
                         }
-                        node.set_location(osmium::Location{
-                                convert_pbf_lon(lon),
-                                convert_pbf_lat(lat)
-                        });
+                        const osmium::Location location{convert_pbf_lon(lon),
+                                                        convert_pbf_lat(lat)};
+                        if (filtered_out(location)) {
+                            return false;
+                        }
+                        node.set_location(location);
                     }
 
                     builder.set_user(user.first, user.second);
 
                     build_tag_list(builder, keys, vals);
+
+                    return true;
                 }
 
                 void decode_way(const data_view& data) {
@@ -392,10 +493,18 @@ namespace osmium {
                                 builder.object().set_id(pbf_way.get_int64());
                                 break;
                             case protozero::tag_and_type(OSMFormat::Way::packed_uint32_keys, protozero::pbf_wire_type::length_delimited):
-                                keys = varint_range{pbf_way.get_view()};
+                                if (m_read_tags == osmium::io::read_tags::yes) {
+                                    keys = varint_range{pbf_way.get_view()};
+                                } else {
+                                    pbf_way.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Way::packed_uint32_vals, protozero::pbf_wire_type::length_delimited):
-                                vals = varint_range{pbf_way.get_view()};
+                                if (m_read_tags == osmium::io::read_tags::yes) {
+                                    vals = varint_range{pbf_way.get_view()};
+                                } else {
+                                    pbf_way.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Way::optional_Info_info, protozero::pbf_wire_type::length_delimited):
                                 if (m_read_metadata == osmium::io::read_meta::yes) {
@@ -421,22 +530,41 @@ namespace osmium {
                     builder.set_user(user.first, user.second);
 
                     if (!refs.empty()) {
-                        osmium::builder::WayNodeListBuilder wnl_builder{builder};
-                        osmium::DeltaDecode<int64_t> ref;
-                        if (lats.empty()) {
-                            while (!refs.empty()) {
-                                wnl_builder.add_node_ref(ref.update(refs.next_sint64()));
+                        osmium::Box envelope;
+                        const bool want_envelope = m_way_envelopes == osmium::io::way_envelopes::yes;
+                        std::size_t duplicates = 0;
+                        {
+                            osmium::builder::WayNodeListBuilder wnl_builder{builder};
+                            if (m_clean_way_nodes == osmium::io::clean_way_nodes::yes) {
+                                wnl_builder.skip_duplicates();
                             }
-                        } else {
-                            osmium::DeltaDecode<int64_t> lon;
-                            osmium::DeltaDecode<int64_t> lat;
-                            while (!refs.empty() && !lons.empty() && !lats.empty()) {
-                                wnl_builder.add_node_ref(
-                                    ref.update(refs.next_sint64()),
-                                    osmium::Location{convert_pbf_lon(lon.update(lons.next_sint64())),
-                                                     convert_pbf_lat(lat.update(lats.next_sint64()))}
-                                );
+                            osmium::DeltaDecode<int64_t> ref;
+                            if (lats.empty()) {
+                                while (!refs.empty()) {
+                                    wnl_builder.add_node_ref(ref.update(refs.next_sint64()));
+                                }
+                            } else {
+                                osmium::DeltaDecode<int64_t> lon;
+                                osmium::DeltaDecode<int64_t> lat;
+                                while (!refs.empty() && !lons.empty() && !lats.empty()) {
+                                    const osmium::Location location{convert_pbf_lon(lon.update(lons.next_sint64())),
+                                                                    convert_pbf_lat(lat.update(lats.next_sint64()))};
+                                    if (want_envelope) {
+                                        envelope.extend(location);
+                                    }
+                                    wnl_builder.add_node_ref(ref.update(refs.next_sint64()), location);
+                                }
                             }
+                            duplicates = wnl_builder.duplicates_skipped();
+                        }
+                        if (duplicates > 0 && m_duplicate_nodes_counter) {
+                            m_duplicate_nodes_counter->fetch_add(duplicates, std::memory_order_relaxed);
+                        }
+                        // The locations are in the cache here anyway, so
+                        // storing the envelope now saves a second pass over
+                        // them later.
+                        if (envelope.valid()) {
+                            osmium::builder::WayEnvelopeBuilder{builder, envelope};
                         }
                     }
 
@@ -461,10 +589,18 @@ namespace osmium {
                                 builder.object().set_id(pbf_relation.get_int64());
                                 break;
                             case protozero::tag_and_type(OSMFormat::Relation::packed_uint32_keys, protozero::pbf_wire_type::length_delimited):
-                                keys = varint_range{pbf_relation.get_view()};
+                                if (m_read_tags == osmium::io::read_tags::yes) {
+                                    keys = varint_range{pbf_relation.get_view()};
+                                } else {
+                                    pbf_relation.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Relation::packed_uint32_vals, protozero::pbf_wire_type::length_delimited):
-                                vals = varint_range{pbf_relation.get_view()};
+                                if (m_read_tags == osmium::io::read_tags::yes) {
+                                    vals = varint_range{pbf_relation.get_view()};
+                                } else {
+                                    pbf_relation.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Relation::optional_Info_info, protozero::pbf_wire_type::length_delimited):
                                 if (m_read_metadata == osmium::io::read_meta::yes) {
@@ -510,7 +646,42 @@ namespace osmium {
                     build_tag_list(builder, keys, vals);
                 }
 
+                // Same as tag_list_size(), but for the interleaved and
+                // 0-terminated key/value index list of dense nodes. Format
+                // errors are ignored here, they are reported when the tag
+                // list is actually built.
+                std::size_t dense_tag_list_size(varint_range tags) const {
+                    std::size_t size = sizeof(osmium::TagList);
+                    while (!tags.empty()) {
+                        const auto idx = tags.next_int32();
+                        if (idx == 0 || tags.empty()) {
+                            break;
+                        }
+                        size += m_stringtable.at(idx).second;
+                        size += m_stringtable.at(tags.next_int32()).second;
+                        size += 2; // the \0 bytes after key and value
+                    }
+                    return osmium::memory::padded_length(size);
+                }
+
+                // Advance the interleaved key/value index list past the
+                // tags of one dense node that was dropped by the location
+                // filter.
+                static void skip_dense_tags(varint_range& tags) {
+                    while (!tags.empty()) {
+                        if (tags.next_int32() == 0) {
+                            return;
+                        }
+                        if (tags.empty()) {
+                            throw osmium::pbf_error{"PBF format error"}; // this is against the spec, keys/vals must come in pairs
+                        }
+                        tags.next_int32();
+                    }
+                }
+
                 void build_tag_list_from_dense_nodes(osmium::builder::NodeBuilder& builder, varint_range& tags) {
+                    builder.reserve(dense_tag_list_size(tags));
+
                     osmium::builder::TagListBuilder tl_builder{builder};
                     while (!tags.empty()) {
                         const auto idx = tags.next_int32();
@@ -527,54 +698,57 @@ namespace osmium {
                 }
 
                 void decode_dense_nodes_without_metadata(const data_view& data) {
-                    varint_range ids;
-                    varint_range lats;
-                    varint_range lons;
+                    std::vector<int64_t> ids;
+                    std::vector<int64_t> lats;
+                    std::vector<int64_t> lons;
                     varint_range tags;
 
                     protozero::pbf_message<OSMFormat::DenseNodes> pbf_dense_nodes{data};
                     while (pbf_dense_nodes.next()) {
                         switch (pbf_dense_nodes.tag_and_type()) {
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
-                                ids = varint_range{pbf_dense_nodes.get_view()};
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), ids);
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
-                                lats = varint_range{pbf_dense_nodes.get_view()};
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), lats);
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited):
-                                lons = varint_range{pbf_dense_nodes.get_view()};
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), lons);
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_int32_keys_vals, protozero::pbf_wire_type::length_delimited):
-                                tags = varint_range{pbf_dense_nodes.get_view()};
+                                if (m_read_tags == osmium::io::read_tags::yes) {
+                                    tags = varint_range{pbf_dense_nodes.get_view()};
+                                } else {
+                                    pbf_dense_nodes.skip();
+                                }
                                 break;
                             default:
                                 pbf_dense_nodes.skip();
                         }
                     }
 
-                    osmium::DeltaDecode<int64_t> dense_id;
-                    osmium::DeltaDecode<int64_t> dense_latitude;
-                    osmium::DeltaDecode<int64_t> dense_longitude;
+                    if (lons.size() < ids.size() ||
+                        lats.size() < ids.size()) {
+                        // this is against the spec, must have same number of elements
+                        throw osmium::pbf_error{"PBF format error"};
+                    }
+
+                    for (std::size_t n = 0; n < ids.size(); ++n) {
+                        const osmium::Location location{convert_pbf_lon(lons[n]),
+                                                        convert_pbf_lat(lats[n])};
 
-                    while (!ids.empty()) {
-                        if (lons.empty() ||
-                            lats.empty()) {
-                            // this is against the spec, must have same number of elements
-                            throw osmium::pbf_error{"PBF format error"};
+                        if (filtered_out(location)) {
+                            skip_dense_tags(tags);
+                            continue;
                         }
 
                         {
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
 
-                            node.set_id(dense_id.update(ids.next_sint64()));
+                            node.set_id(ids[n]);
 
-                            const auto lon = dense_longitude.update(lons.next_sint64());
-                            const auto lat = dense_latitude.update(lats.next_sint64());
-                            builder.object().set_location(osmium::Location{
-                                    convert_pbf_lon(lon),
-                                    convert_pbf_lat(lat)
-                            });
+                            builder.object().set_location(location);
 
                             if (!tags.empty()) {
                                 build_tag_list_from_dense_nodes(builder, tags);
@@ -588,9 +762,9 @@ namespace osmium {
                 void decode_dense_nodes(const data_view& data) {
                     bool has_info = false;
 
-                    varint_range ids;
-                    varint_range lats;
-                    varint_range lons;
+                    std::vector<int64_t> ids;
+                    std::vector<int64_t> lats;
+                    std::vector<int64_t> lons;
                     varint_range tags;
                     varint_range versions;
                     varint_range timestamps;
@@ -603,7 +777,7 @@ namespace osmium {
                     while (pbf_dense_nodes.next()) {
                         switch (pbf_dense_nodes.tag_and_type()) {
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
-                                ids = varint_range{pbf_dense_nodes.get_view()};
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), ids);
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::optional_DenseInfo_denseinfo, protozero::pbf_wire_type::length_delimited):
                                 {
@@ -636,41 +810,74 @@ namespace osmium {
                                 }
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
-                                lats = varint_range{pbf_dense_nodes.get_view()};
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), lats);
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited):
-                                lons = varint_range{pbf_dense_nodes.get_view()};
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), lons);
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_int32_keys_vals, protozero::pbf_wire_type::length_delimited):
-                                tags = varint_range{pbf_dense_nodes.get_view()};
+                                if (m_read_tags == osmium::io::read_tags::yes) {
+                                    tags = varint_range{pbf_dense_nodes.get_view()};
+                                } else {
+                                    pbf_dense_nodes.skip();
+                                }
                                 break;
                             default:
                                 pbf_dense_nodes.skip();
                         }
                     }
 
-                    osmium::DeltaDecode<int64_t> dense_id;
-                    osmium::DeltaDecode<int64_t> dense_latitude;
-                    osmium::DeltaDecode<int64_t> dense_longitude;
                     osmium::DeltaDecode<int64_t> dense_uid;
                     osmium::DeltaDecode<int64_t> dense_user_sid;
                     osmium::DeltaDecode<int64_t> dense_changeset;
                     osmium::DeltaDecode<int64_t> dense_timestamp;
 
-                    while (!ids.empty()) {
-                        if (lons.empty() ||
-                            lats.empty()) {
-                            // this is against the spec, must have same number of elements
-                            throw osmium::pbf_error{"PBF format error"};
+                    if (lons.size() < ids.size() ||
+                        lats.size() < ids.size()) {
+                        // this is against the spec, must have same number of elements
+                        throw osmium::pbf_error{"PBF format error"};
+                    }
+
+                    for (std::size_t n = 0; n < ids.size(); ++n) {
+                        bool visible = true;
+                        if (has_info && !visibles.empty()) {
+                            visible = (visibles.next_int32() != 0);
                         }
 
-                        {
-                            bool visible = true;
+                        // even if the node isn't visible, there's still a record
+                        // of its lat/lon in the dense arrays.
+                        const osmium::Location location{convert_pbf_lon(lons[n]),
+                                                        convert_pbf_lat(lats[n])};
 
+                        if (visible && filtered_out(location)) {
+                            // the delta-coded streams have to be advanced
+                            // even for nodes the location filter drops
+                            if (has_info) {
+                                if (!versions.empty()) {
+                                    versions.next_int32();
+                                }
+                                if (!changesets.empty()) {
+                                    dense_changeset.update(changesets.next_sint64());
+                                }
+                                if (!timestamps.empty()) {
+                                    dense_timestamp.update(timestamps.next_sint64());
+                                }
+                                if (!uids.empty()) {
+                                    dense_uid.update(uids.next_sint32());
+                                }
+                                if (!user_sids.empty()) {
+                                    dense_user_sid.update(user_sids.next_sint32());
+                                }
+                            }
+                            skip_dense_tags(tags);
+                            continue;
+                        }
+
+                        {
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
 
-                            node.set_id(dense_id.update(ids.next_sint64()));
+                            node.set_id(ids[n]);
 
                             if (has_info) {
                                 if (!versions.empty()) {
@@ -707,9 +914,6 @@ namespace osmium {
                                     node.set_uid_from_signed(static_cast<osmium::signed_user_id_type>(dense_uid.update(uids.next_sint32())));
                                 }
 
-                                if (!visibles.empty()) {
-                                    visible = (visibles.next_int32() != 0);
-                                }
                                 node.set_visible(visible);
 
                                 if (!user_sids.empty()) {
@@ -718,15 +922,8 @@ namespace osmium {
                                 }
                             }
 
-                            // even if the node isn't visible, there's still a record
-                            // of its lat/lon in the dense arrays.
-                            const auto lon = dense_longitude.update(lons.next_sint64());
-                            const auto lat = dense_latitude.update(lats.next_sint64());
                             if (visible) {
-                                builder.object().set_location(osmium::Location{
-                                        convert_pbf_lon(lon),
-                                        convert_pbf_lat(lat)
-                                });
+                                builder.object().set_location(location);
                             }
 
                             if (!tags.empty()) {
@@ -739,10 +936,17 @@ namespace osmium {
 
             public:
 
-                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, const osmium::io::read_tags read_tags, const osmium::io::way_envelopes way_envelopes = osmium::io::way_envelopes::no, const osmium::io::clean_way_nodes clean_way_nodes = osmium::io::clean_way_nodes::no, std::atomic<std::uint64_t>* duplicate_nodes_counter = nullptr, const osmium::Box& filter_box = osmium::Box{}, osmium::memory::BufferPool* buffer_pool = nullptr) :
                     m_data(data),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_buffer(buffer_pool ? buffer_pool->acquire()
+                                         : osmium::memory::Buffer{osmium::memory::slab_allocate, osmium::memory::slab_deallocate, initial_buffer_size, osmium::memory::Buffer::auto_grow::internal}),
+                    m_read_metadata(read_metadata),
+                    m_read_tags(read_tags),
+                    m_way_envelopes(way_envelopes),
+                    m_clean_way_nodes(clean_way_nodes),
+                    m_duplicate_nodes_counter(duplicate_nodes_counter),
+                    m_filter_box(filter_box) {
                 }
 
                 PBFPrimitiveBlockDecoder(const PBFPrimitiveBlockDecoder&) = delete;
@@ -756,7 +960,7 @@ namespace osmium {
                 osmium::memory::Buffer operator()() {
                     try {
                         decode_primitive_block_metadata();
-                        decode_primitive_block_data();
+                        decode_primitive_block_data_dispatch();
                     } catch (const std::out_of_range&) {
                         throw osmium::pbf_error{"string id out of range"};
                     }
@@ -766,7 +970,7 @@ namespace osmium {
 
             }; // class PBFPrimitiveBlockDecoder
 
-            inline data_view decode_blob(const std::string& blob_data, std::string& output) {
+            inline data_view decode_blob(const data_view& blob_data, std::string& output) {
                 int32_t raw_size = 0;
                 protozero::data_view compressed_data;
                 pbf_compression use_compression = pbf_compression::none;
@@ -947,7 +1151,7 @@ namespace osmium {
              * @returns Header object
              * @throws osmium::pbf_error If there was a parsing error
              */
-            inline osmium::io::Header decode_header(const std::string& header_block_data) {
+            inline osmium::io::Header decode_header(const data_view& header_block_data) {
                 std::string output;
 
                 return decode_header_block(decode_blob(header_block_data, output));
@@ -956,25 +1160,155 @@ namespace osmium {
             class PBFDataBlobDecoder {
 
                 std::shared_ptr<std::string> m_input_buffer;
+
+                // Keeps the memory mapping alive as long as any copy of this
+                // decoder still references data inside it (zero-copy mode).
+                std::shared_ptr<const osmium::util::MemoryMapping> m_mapping;
+
+                data_view m_data;
+                osmium::memory::BufferPool* m_buffer_pool;
                 osmium::osm_entity_bits::type m_read_types;
                 osmium::io::read_meta m_read_metadata;
+                osmium::io::read_tags m_read_tags;
+                osmium::io::way_envelopes m_way_envelopes;
+                osmium::io::clean_way_nodes m_clean_way_nodes;
+                std::atomic<std::uint64_t>* m_duplicate_nodes_counter;
+                osmium::io::skip_damaged_blobs m_skip_damaged_blobs;
+                std::atomic<std::uint64_t>* m_damaged_blobs_counter;
+                osmium::Box m_filter_box;
+                std::size_t m_source_offset = 0;
+                std::size_t m_sequence = 0;
+                bool m_have_source = false;
+
+                void stamp_provenance(osmium::memory::Buffer& buffer) const {
+                    if (!m_have_source) {
+                        return;
+                    }
+                    osmium::memory::Buffer::provenance prov;
+                    prov.source_offset = m_source_offset;
+                    prov.sequence = m_sequence;
+                    prov.decoded_at_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count());
+                    buffer.set_provenance(prov);
+                }
+
+                osmium::memory::Buffer decode() {
+                    OSMIUM_PROBE2(decode_start, m_sequence, m_data.size());
+                    std::string output;
+                    PBFPrimitiveBlockDecoder decoder{decode_blob(m_data, output), m_read_types, m_read_metadata, m_read_tags, m_way_envelopes, m_clean_way_nodes, m_duplicate_nodes_counter, m_filter_box, m_buffer_pool};
+                    osmium::memory::Buffer buffer = decoder();
+                    stamp_provenance(buffer);
+                    OSMIUM_PROBE2(decode_end, m_sequence, buffer.committed());
+                    return buffer;
+                }
 
             public:
 
-                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, const osmium::io::read_tags read_tags = osmium::io::read_tags::yes, const osmium::io::way_envelopes way_envelopes = osmium::io::way_envelopes::no, const osmium::io::clean_way_nodes clean_way_nodes = osmium::io::clean_way_nodes::no, std::atomic<std::uint64_t>* duplicate_nodes_counter = nullptr, const osmium::io::skip_damaged_blobs skip_damaged_blobs = osmium::io::skip_damaged_blobs::no, std::atomic<std::uint64_t>* damaged_blobs_counter = nullptr, const osmium::Box& filter_box = osmium::Box{}, osmium::memory::BufferPool* buffer_pool = nullptr) :
                     m_input_buffer(std::make_shared<std::string>(std::move(input_buffer))),
+                    m_data(*m_input_buffer),
+                    m_buffer_pool(buffer_pool),
+                    m_read_types(read_types),
+                    m_read_metadata(read_metadata),
+                    m_read_tags(read_tags),
+                    m_way_envelopes(way_envelopes),
+                    m_clean_way_nodes(clean_way_nodes),
+                    m_duplicate_nodes_counter(duplicate_nodes_counter),
+                    m_skip_damaged_blobs(skip_damaged_blobs),
+                    m_damaged_blobs_counter(damaged_blobs_counter),
+                    m_filter_box(filter_box) {
+                }
+
+                PBFDataBlobDecoder(const data_view& data, std::shared_ptr<const osmium::util::MemoryMapping> mapping, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, const osmium::io::read_tags read_tags = osmium::io::read_tags::yes, const osmium::io::way_envelopes way_envelopes = osmium::io::way_envelopes::no, const osmium::io::clean_way_nodes clean_way_nodes = osmium::io::clean_way_nodes::no, std::atomic<std::uint64_t>* duplicate_nodes_counter = nullptr, const osmium::io::skip_damaged_blobs skip_damaged_blobs = osmium::io::skip_damaged_blobs::no, std::atomic<std::uint64_t>* damaged_blobs_counter = nullptr, const osmium::Box& filter_box = osmium::Box{}, osmium::memory::BufferPool* buffer_pool = nullptr) :
+                    m_mapping(std::move(mapping)),
+                    m_data(data),
+                    m_buffer_pool(buffer_pool),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_metadata(read_metadata),
+                    m_read_tags(read_tags),
+                    m_way_envelopes(way_envelopes),
+                    m_clean_way_nodes(clean_way_nodes),
+                    m_duplicate_nodes_counter(duplicate_nodes_counter),
+                    m_skip_damaged_blobs(skip_damaged_blobs),
+                    m_damaged_blobs_counter(damaged_blobs_counter),
+                    m_filter_box(filter_box) {
+                }
+
+                /**
+                 * Tell the decoder where its blob sits in the source
+                 * file, so it can annotate the decoded buffer with its
+                 * provenance (see osmium::memory::Buffer::provenance).
+                 */
+                void set_source(const std::size_t offset, const std::size_t sequence) noexcept {
+                    m_source_offset = offset;
+                    m_sequence = sequence;
+                    m_have_source = true;
                 }
 
                 osmium::memory::Buffer operator()() {
-                    std::string output;
-                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), m_read_types, m_read_metadata};
-                    return decoder();
+                    if (m_skip_damaged_blobs == osmium::io::skip_damaged_blobs::yes) {
+                        try {
+                            return decode();
+                        } catch (const osmium::io_error&) {
+                            // fall through
+                        } catch (const protozero::exception&) {
+                            // fall through
+                        }
+                        if (m_damaged_blobs_counter) {
+                            m_damaged_blobs_counter->fetch_add(1, std::memory_order_relaxed);
+                        }
+                        // A valid but empty buffer; the Reader skips those,
+                        // only an invalid buffer would signal end-of-file.
+                        return osmium::memory::Buffer{64, osmium::memory::Buffer::auto_grow::internal};
+                    }
+                    return decode();
                 }
 
             }; // class PBFDataBlobDecoder
 
+            /**
+             * Decodes several consecutive data blobs as one thread pool
+             * task. Files written with small primitive blocks contain many
+             * tiny blobs and submitting each one to the pool separately
+             * costs more in scheduling than the decoding itself. The
+             * decoded buffers are chained together as nested buffers, so
+             * they travel through the output queue as a single unit but
+             * are still handed to the application one at a time and in
+             * file order.
+             */
+            class PBFBlobBatchDecoder {
+
+                std::vector<PBFDataBlobDecoder> m_decoders;
+
+            public:
+
+                PBFBlobBatchDecoder() = default;
+
+                void add(PBFDataBlobDecoder&& decoder) {
+                    m_decoders.push_back(std::move(decoder));
+                }
+
+                bool empty() const noexcept {
+                    return m_decoders.empty();
+                }
+
+                osmium::memory::Buffer operator()() {
+                    assert(!m_decoders.empty());
+                    osmium::memory::Buffer batch;
+                    for (auto& decoder : m_decoders) {
+                        osmium::memory::Buffer buffer = decoder();
+                        if (batch) {
+                            // the previously decoded buffers contain data
+                            // that comes before this one
+                            buffer.add_nested_buffer(std::move(batch));
+                        }
+                        batch = std::move(buffer);
+                    }
+                    return batch;
+                }
+
+            }; // class PBFBlobBatchDecoder
+
         } // namespace detail
 
     } // namespace io
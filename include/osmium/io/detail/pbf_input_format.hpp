@@ -44,16 +44,22 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
 
 #include <protozero/pbf_message.hpp>
 #include <protozero/types.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
+#include <system_error>
 #include <type_traits>
 #include <utility>
 
@@ -66,9 +72,56 @@ namespace osmium {
             class PBFParser final : public Parser {
 
                 std::string m_input_buffer{};
+
+                // In mapped input mode the whole input file is mapped into
+                // memory and blob data is handed to the decoders as views
+                // into this mapping without any copying. The mapping is
+                // shared with the decoders so it stays alive until the last
+                // one is done with it.
+                std::shared_ptr<const osmium::util::MemoryMapping> m_mapping{};
+                std::size_t m_mapping_offset = 0;
+
                 std::atomic<std::size_t>* m_offset_ptr;
+                std::size_t m_stream_offset = 0;
+                std::size_t m_fd_offset = 0;
+                std::function<bool(const osmium::io::blob_info&)> m_blob_filter;
                 int m_fd;
                 bool m_want_buffered_pages_removed;
+                osmium::io::mapped_input m_use_mapped_input;
+                osmium::memory::BufferPool* m_buffer_pool;
+
+                std::size_t bytes_left_in_mapping() const noexcept {
+                    return m_mapping->size() - m_mapping_offset;
+                }
+
+                /**
+                 * Get a view of the next size bytes of the memory mapping
+                 * and advance the read position past them.
+                 */
+                protozero::data_view get_view_from_mapping(std::size_t size) {
+                    if (bytes_left_in_mapping() < size) {
+                        throw osmium::pbf_error{"unexpected EOF"};
+                    }
+                    const protozero::data_view view{m_mapping->get_addr<const char>() + m_mapping_offset, size};
+                    m_mapping_offset += size;
+                    *m_offset_ptr = m_mapping_offset;
+                    return view;
+                }
+
+                void setup_mapping() {
+                    if (m_use_mapped_input != osmium::io::mapped_input::yes || m_fd == -1) {
+                        return;
+                    }
+                    try {
+                        const auto size = osmium::file_size(m_fd);
+                        if (size > 0) {
+                            m_mapping = std::make_shared<const osmium::util::MemoryMapping>(size, osmium::util::MemoryMapping::mapping_mode::readonly, m_fd);
+                        }
+                    } catch (const std::system_error&) {
+                        // Could be a pipe or some other fd that can not be
+                        // mapped, fall back to the normal read path.
+                    }
+                }
 
                 /**
                  * Make sure the input data contains at least the specified
@@ -98,6 +151,7 @@ namespace osmium {
                 void pop_from_input_queue(size_t size) {
                     assert(m_fd == -1);
                     m_input_buffer.erase(0, size);
+                    m_stream_offset += size;
                 }
 
                 static uint32_t get_size_in_network_byte_order(const char* d) noexcept {
@@ -119,11 +173,19 @@ namespace osmium {
                  * the length of the following BlobHeader.
                  */
                 uint32_t read_blob_header_size_from_file() {
+                    if (m_mapping) {
+                        if (bytes_left_in_mapping() < sizeof(uint32_t)) {
+                            return 0; // EOF
+                        }
+                        return check_size(get_size_in_network_byte_order(get_view_from_mapping(sizeof(uint32_t)).data()));
+                    }
+
                     if (m_fd != -1) {
                         std::array<char, sizeof(uint32_t)> buffer{};
                         if (!osmium::io::detail::read_exactly(m_fd, buffer.data(), static_cast<unsigned int>(buffer.size()))) {
                             return 0; // EOF
                         }
+                        m_fd_offset += buffer.size();
                         return check_size(get_size_in_network_byte_order(buffer.data()));
                     }
 
@@ -185,6 +247,10 @@ namespace osmium {
                         return 0;
                     }
 
+                    if (m_mapping) {
+                        return decode_blob_header(get_view_from_mapping(size), expected_type);
+                    }
+
                     if (m_fd != -1) {
                         auto const buffer = read_from_input_queue_with_check(size);
                         const auto blob_size = decode_blob_header(protozero::data_view{buffer.data(), size}, expected_type);
@@ -210,6 +276,7 @@ namespace osmium {
                         if (!osmium::io::detail::read_exactly(m_fd, &*buffer.begin(), static_cast<unsigned int>(size))) {
                             throw osmium::pbf_error{"unexpected EOF"};
                         }
+                        m_fd_offset += size;
                     } else {
                         ensure_available_in_input_queue(size);
                         buffer.append(m_input_buffer, 0, size);
@@ -222,27 +289,187 @@ namespace osmium {
                 // Parse the header in the PBF OSMHeader blob.
                 void parse_header_blob() {
                     const auto size = check_type_and_get_blob_size("OSMHeader");
+                    if (m_mapping) {
+                        check_blob_size(size);
+                        set_header_value(decode_header(get_view_from_mapping(size)));
+                        return;
+                    }
                     const osmium::io::Header header{decode_header(read_from_input_queue_with_check(size))};
                     set_header_value(header);
                 }
 
+                static void check_blob_size(std::size_t size) {
+                    if (size > max_uncompressed_blob_size) {
+                        throw osmium::pbf_error{std::string{"invalid blob size: "} +
+                                                std::to_string(size)};
+                    }
+                }
+
+                PBFDataBlobDecoder create_data_blob_decoder(std::size_t size) {
+                    if (m_mapping) {
+                        check_blob_size(size);
+                        return PBFDataBlobDecoder{get_view_from_mapping(size), m_mapping, read_types(), read_metadata(), read_tags(), way_envelopes(), clean_way_nodes(), duplicate_nodes_counter(), skip_damaged_blobs(), damaged_blobs_counter(), filter_box(), m_buffer_pool};
+                    }
+                    return PBFDataBlobDecoder{read_from_input_queue_with_check(size), read_types(), read_metadata(), read_tags(), way_envelopes(), clean_way_nodes(), duplicate_nodes_counter(), skip_damaged_blobs(), damaged_blobs_counter(), filter_box(), m_buffer_pool};
+                }
+
+                /**
+                 * Jump to the start offset configured on the Reader. Called
+                 * after the header blob has been parsed. In mapped input
+                 * and file descriptor modes this is a real seek, when
+                 * reading from the input queue the bytes up to the offset
+                 * are read and discarded.
+                 */
+                void skip_to_start_offset() {
+                    const std::size_t offset = start_offset();
+                    if (offset == 0) {
+                        return;
+                    }
+
+                    if (m_mapping) {
+                        if (offset < m_mapping_offset || offset > m_mapping->size()) {
+                            throw osmium::pbf_error{std::string{"invalid start offset: "} +
+                                                    std::to_string(offset)};
+                        }
+                        m_mapping_offset = offset;
+                        *m_offset_ptr = m_mapping_offset;
+                        return;
+                    }
+
+                    if (m_fd != -1) {
+                        osmium::util::file_seek(m_fd, offset);
+                        m_fd_offset = offset;
+                        *m_offset_ptr = offset;
+                        return;
+                    }
+
+                    if (offset < m_stream_offset) {
+                        throw osmium::pbf_error{std::string{"invalid start offset: "} +
+                                                std::to_string(offset)};
+                    }
+                    while (m_stream_offset < offset) {
+                        if (m_input_buffer.empty()) {
+                            ensure_available_in_input_queue(1);
+                        }
+                        pop_from_input_queue(std::min(offset - m_stream_offset, m_input_buffer.size()));
+                    }
+                }
+
+                /**
+                 * The file offset of the next blob, ie. of the 4 length
+                 * bytes before its BlobHeader. Same convention as the
+                 * offsets in the PBFBlobIndex.
+                 */
+                std::size_t current_offset() const noexcept {
+                    if (m_mapping) {
+                        return m_mapping_offset;
+                    }
+                    if (m_fd != -1) {
+                        return m_fd_offset;
+                    }
+                    return m_stream_offset;
+                }
+
+                /**
+                 * Skip over the data of a blob the filter rejected without
+                 * decompressing or decoding it. In mapped input mode this
+                 * doesn't even touch the blob's pages.
+                 */
+                void skip_data_blob(std::size_t size) {
+                    check_blob_size(size);
+                    if (m_mapping) {
+                        get_view_from_mapping(size);
+                        return;
+                    }
+                    read_from_input_queue_with_check(size);
+                }
+
+                // Blobs with less compressed data than this count as
+                // "small" and several of them are coalesced into a single
+                // thread pool task. Normal-sized blobs are well above this,
+                // so batching only kicks in for files written with small
+                // primitive blocks where per-task scheduling overhead would
+                // otherwise dominate the decoding work.
+                enum : std::size_t {
+                    small_blob_size = 64UL * 1024UL
+                };
+
+                // Once the combined compressed size of the blobs in a batch
+                // reaches this, the batch is submitted to the pool. Roughly
+                // the size of one normal blob, so batched and unbatched
+                // tasks end up doing a similar amount of work.
+                enum : std::size_t {
+                    blob_batch_target_size = 1024UL * 1024UL
+                };
+
                 void parse_data_blobs() {
                     const bool use_pool = osmium::config::use_pool_threads_for_pbf_parsing();
-                    while (const auto size = check_type_and_get_blob_size("OSMData")) {
-                        std::string input_buffer{read_from_input_queue_with_check(size)};
+                    std::size_t blob_index = 0;
+
+                    PBFBlobBatchDecoder batch;
+                    std::size_t batch_size = 0;
 
-                        PBFDataBlobDecoder data_blob_parser{std::move(input_buffer), read_types(), read_metadata()};
+                    const auto flush_batch = [&]() {
+                        if (!batch.empty()) {
+                            send_to_output_queue(get_pool().submit(std::move(batch)));
+                            batch = PBFBlobBatchDecoder{};
+                            batch_size = 0;
+                        }
+                    };
 
-                        if (use_pool) {
-                            send_to_output_queue(get_pool().submit(std::move(data_blob_parser)));
-                        } else {
-                            send_to_output_queue(data_blob_parser());
+                    while (true) {
+                        const std::size_t blob_offset = current_offset();
+                        try {
+                            const auto size = check_type_and_get_blob_size("OSMData");
+                            if (size == 0) { // EOF
+                                break;
+                            }
+
+                            if (m_blob_filter && !m_blob_filter(osmium::io::blob_info{blob_index, blob_offset, size})) {
+                                skip_data_blob(size);
+                            } else if (use_pool && size < small_blob_size) {
+                                PBFDataBlobDecoder decoder{create_data_blob_decoder(size)};
+                                decoder.set_source(blob_offset, blob_index);
+                                batch.add(std::move(decoder));
+                                batch_size += size;
+                                if (batch_size >= blob_batch_target_size) {
+                                    flush_batch();
+                                }
+                            } else {
+                                // submit any pending batch first to keep the
+                                // blobs in file order
+                                flush_batch();
+
+                                PBFDataBlobDecoder data_blob_parser{create_data_blob_decoder(size)};
+                                data_blob_parser.set_source(blob_offset, blob_index);
+
+                                if (use_pool) {
+                                    send_to_output_queue(get_pool().submit(std::move(data_blob_parser)));
+                                } else {
+                                    send_to_output_queue(data_blob_parser());
+                                }
+                            }
+                        } catch (const osmium::io_error&) {
+                            // A broken or truncated blob header or blob.
+                            // There is no way to find the start of the next
+                            // blob after it, so treat it as the end of the
+                            // data.
+                            if (skip_damaged_blobs() != osmium::io::skip_damaged_blobs::yes) {
+                                throw;
+                            }
+                            if (damaged_blobs_counter()) {
+                                damaged_blobs_counter()->fetch_add(1, std::memory_order_relaxed);
+                            }
+                            break;
                         }
+                        ++blob_index;
 
                         if (m_want_buffered_pages_removed) {
                             osmium::io::detail::remove_buffered_pages(m_fd, *m_offset_ptr);
                         }
                     }
+
+                    flush_batch();
                 }
 
             public:
@@ -250,8 +477,11 @@ namespace osmium {
                 explicit PBFParser(parser_arguments& args) :
                     Parser(args),
                     m_offset_ptr(args.offset_ptr),
+                    m_blob_filter(args.blob_filter),
                     m_fd(args.fd),
-                    m_want_buffered_pages_removed(args.want_buffered_pages_removed) {
+                    m_want_buffered_pages_removed(args.want_buffered_pages_removed),
+                    m_use_mapped_input(args.use_mapped_input),
+                    m_buffer_pool(args.buffer_pool) {
                 }
 
                 PBFParser(const PBFParser&) = delete;
@@ -265,9 +495,12 @@ namespace osmium {
                 void run() override {
                     osmium::thread::set_thread_name("_osmium_pbf_in");
 
+                    setup_mapping();
+
                     parse_header_blob();
 
                     if (read_types() != osmium::osm_entity_bits::nothing) {
+                        skip_to_start_offset();
                         parse_data_blobs();
                     }
 
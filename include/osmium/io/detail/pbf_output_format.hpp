@@ -33,11 +33,15 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,6 +52,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/detail/protobuf_tags.hpp>
 #include <osmium/io/detail/queue_util.hpp>
 #include <osmium/io/detail/string_table.hpp>
+#include <osmium/io/detail/varint_encoder.hpp>
 #include <osmium/io/detail/zlib.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
@@ -69,6 +74,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/thread/pool.hpp>
 #include <osmium/util/delta.hpp>
 #include <osmium/util/misc.hpp>
+#include <osmium/util/probes.hpp>
 #include <osmium/visitor.hpp>
 
 #ifdef OSMIUM_WITH_LZ4
@@ -111,6 +117,14 @@ namespace osmium {
                 /// Should node locations be added to ways?
                 bool locations_on_ways = false;
 
+                /**
+                 * Size of the chunks the block string tables allocate
+                 * their string memory in. Make this large enough for all
+                 * strings of a block and every string table is a single
+                 * allocation.
+                 */
+                std::size_t stringtable_chunk_size = StringTable::default_stringtable_chunk_size;
+
             }; // struct pbf_output_options
 
             /**
@@ -235,7 +249,7 @@ namespace osmium {
                     std::string data;
                     protozero::pbf_builder<OSMFormat::DenseNodes> pbf_dense_nodes{data};
 
-                    pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_id, m_ids.cbegin(), m_ids.cend());
+                    add_packed_svarint(pbf_dense_nodes, OSMFormat::DenseNodes::packed_sint64_id, m_ids);
 
                     if (m_options->add_metadata.any() || m_options->add_visible_flag) {
                         protozero::pbf_builder<OSMFormat::DenseInfo> pbf_dense_info{pbf_dense_nodes, OSMFormat::DenseNodes::optional_DenseInfo_denseinfo};
@@ -243,24 +257,24 @@ namespace osmium {
                             pbf_dense_info.add_packed_int32(OSMFormat::DenseInfo::packed_int32_version, m_versions.cbegin(), m_versions.cend());
                         }
                         if (m_options->add_metadata.timestamp()) {
-                            pbf_dense_info.add_packed_sint64(OSMFormat::DenseInfo::packed_sint64_timestamp, m_timestamps.cbegin(), m_timestamps.cend());
+                            add_packed_svarint(pbf_dense_info, OSMFormat::DenseInfo::packed_sint64_timestamp, m_timestamps);
                         }
                         if (m_options->add_metadata.changeset()) {
-                            pbf_dense_info.add_packed_sint64(OSMFormat::DenseInfo::packed_sint64_changeset, m_changesets.cbegin(), m_changesets.cend());
+                            add_packed_svarint(pbf_dense_info, OSMFormat::DenseInfo::packed_sint64_changeset, m_changesets);
                         }
                         if (m_options->add_metadata.uid()) {
-                            pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_uid, m_uids.cbegin(), m_uids.cend());
+                            add_packed_svarint(pbf_dense_info, OSMFormat::DenseInfo::packed_sint32_uid, m_uids);
                         }
                         if (m_options->add_metadata.user()) {
-                            pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_user_sid, m_user_sids.cbegin(), m_user_sids.cend());
+                            add_packed_svarint(pbf_dense_info, OSMFormat::DenseInfo::packed_sint32_user_sid, m_user_sids);
                         }
                         if (m_options->add_visible_flag) {
                             pbf_dense_info.add_packed_bool(OSMFormat::DenseInfo::packed_bool_visible, m_visibles.cbegin(), m_visibles.cend());
                         }
                     }
 
-                    pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_lat, m_lats.cbegin(), m_lats.cend());
-                    pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_lon, m_lons.cbegin(), m_lons.cend());
+                    add_packed_svarint(pbf_dense_nodes, OSMFormat::DenseNodes::packed_sint64_lat, m_lats);
+                    add_packed_svarint(pbf_dense_nodes, OSMFormat::DenseNodes::packed_sint64_lon, m_lons);
 
                     pbf_dense_nodes.add_packed_int32(OSMFormat::DenseNodes::packed_int32_keys_vals, m_tags.cbegin(), m_tags.cend());
 
@@ -283,15 +297,37 @@ namespace osmium {
 
                 explicit PrimitiveBlock(const pbf_output_options& options, OSMFormat::PrimitiveGroup type, size_t bucket_count) :
                     m_pbf_primitive_group(m_pbf_primitive_group_data),
-                    m_stringtable(StringTable::default_stringtable_chunk_size, bucket_count),
+                    m_stringtable(options.stringtable_chunk_size, bucket_count),
                     m_options(options),
                     m_type(type) {
                 }
 
+                /**
+                 * Clear the block so it can be reused. The string table
+                 * keeps its chunk memory and hash table size, so a
+                 * reused block does not have to allocate it again.
+                 */
+                void reset(const pbf_output_options& options, const OSMFormat::PrimitiveGroup type) {
+                    m_pbf_primitive_group_data.clear();
+                    m_stringtable.clear();
+                    m_options = options;
+                    m_dense_nodes.reset();
+                    m_type = type;
+                    m_count = 0;
+                }
+
                 std::size_t get_bucket_count() const noexcept {
                     return m_stringtable.get_bucket_count();
                 }
 
+                std::size_t get_chunk_count() const noexcept {
+                    return m_stringtable.get_chunk_count();
+                }
+
+                std::size_t get_chunk_size() const noexcept {
+                    return m_stringtable.get_chunk_size();
+                }
+
                 const std::string& group_data() {
                     if (m_dense_nodes) {
                         m_pbf_primitive_group.add_message(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, m_dense_nodes->serialize());
@@ -364,6 +400,74 @@ namespace osmium {
 
             }; // class PrimitiveBlock
 
+            /**
+             * Pool of PrimitiveBlocks. One block is needed for every
+             * block serialized, thousands of them for a larger file, and
+             * each one allocates string table chunks and a hash table.
+             * Blocks from this pool keep that memory (see
+             * PrimitiveBlock::reset()), so sustained writing reuses the
+             * same few blocks instead of churning through the allocator.
+             * Like the StringPool this is shared by all writers.
+             */
+            class PrimitiveBlockPool {
+
+                enum size_limits : std::size_t {
+                    /// More blocks than this are never kept.
+                    max_pool_size = 32,
+
+                    /**
+                     * Blocks whose string table grew to more than this
+                     * many chunks are not kept, so one block with huge
+                     * string tables can not hold on to memory forever.
+                     */
+                    max_chunk_count = 8
+                };
+
+                std::mutex m_mutex;
+                std::vector<std::shared_ptr<PrimitiveBlock>> m_blocks;
+
+            public:
+
+                static PrimitiveBlockPool& instance() {
+                    static PrimitiveBlockPool pool;
+                    return pool;
+                }
+
+                /**
+                 * Get a block from the pool, either a cleared previously
+                 * used one or a freshly allocated one.
+                 */
+                std::shared_ptr<PrimitiveBlock> get(const pbf_output_options& options, const OSMFormat::PrimitiveGroup type, const std::size_t bucket_count) {
+                    {
+                        const std::lock_guard<std::mutex> lock{m_mutex};
+                        if (!m_blocks.empty() &&
+                            m_blocks.back()->get_chunk_size() == options.stringtable_chunk_size) {
+                            std::shared_ptr<PrimitiveBlock> block{std::move(m_blocks.back())};
+                            m_blocks.pop_back();
+                            block->reset(options, type);
+                            return block;
+                        }
+                    }
+                    return std::shared_ptr<PrimitiveBlock>{new PrimitiveBlock{options, type, bucket_count}};
+                }
+
+                /**
+                 * Return a block to the pool for later reuse. Call this
+                 * only when no one else holds a reference to the block
+                 * any more.
+                 */
+                void put(std::shared_ptr<PrimitiveBlock>&& block) {
+                    if (!block || block->get_chunk_count() > max_chunk_count) {
+                        return;
+                    }
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    if (m_blocks.size() < max_pool_size) {
+                        m_blocks.push_back(std::move(block));
+                    }
+                }
+
+            }; // class PrimitiveBlockPool
+
             class SerializeBlob {
 
                 std::shared_ptr<PrimitiveBlock> m_block{};
@@ -414,6 +518,7 @@ namespace osmium {
                  * to be written to a file.
                  */
                 std::string operator()() {
+                    OSMIUM_PROBE(serialize);
                     if (m_block) {
                         protozero::pbf_builder<OSMFormat::PrimitiveBlock> primitive_block{m_msg};
 
@@ -430,6 +535,7 @@ namespace osmium {
                     std::string blob_data;
                     protozero::pbf_builder<FileFormat::Blob> pbf_blob{blob_data};
 
+                    OSMIUM_PROBE1(compress, m_msg.size());
                     switch (m_use_compression) {
                         case pbf_compression::none:
                             pbf_blob.add_bytes(FileFormat::Blob::optional_bytes_raw, m_msg);
@@ -478,49 +584,43 @@ namespace osmium {
 
             }; // class SerializeBlob
 
-            class PBFOutputFormat : public osmium::io::detail::OutputFormat, public osmium::handler::Handler {
-
-                pbf_output_options m_options;
+            /**
+             * Serialize a batch of OSM objects into one or more primitive
+             * blocks. This does all the work of building a block -- delta
+             * encoding, string table construction, and compression -- so
+             * it can run on a worker thread. The batch keeps the buffers
+             * the objects live in alive while it is being processed.
+             */
+            class SerializeBatch {
 
-                std::shared_ptr<PrimitiveBlock> m_primitive_block{};
+                std::vector<std::shared_ptr<osmium::memory::Buffer>> m_buffers;
 
-                std::size_t m_bucket_count = StringTable::min_bucket_count;
+                std::vector<const osmium::OSMObject*> m_objects;
 
-                void store_primitive_block() {
-                    if (!m_primitive_block || m_primitive_block->count() == 0) {
-                        return;
-                    }
+                pbf_output_options m_options;
 
-                    // Remember the bucket_count of the hash in the string
-                    // table. It will be used when initializing the string
-                    // table for the next block.
-                    //
-                    // Some versions of the std library will set the bucket
-                    // count always larger then what we set it to. We decrease
-                    // the bucket count by one, this way the bucket will not
-                    // grow too much.
-                    m_bucket_count = m_primitive_block->get_bucket_count() - 1;
+                // The bucket count of the string table hash is shared
+                // between all batches. It is used as a hint when
+                // initializing the string table of the next block, so the
+                // hash doesn't have to grow from its minimum size for
+                // every block.
+                std::shared_ptr<std::atomic<std::size_t>> m_bucket_count;
 
-                    m_output_queue.push(m_pool.submit(
-                        SerializeBlob{std::move(m_primitive_block),
-                                      pbf_blob_type::data,
-                                      m_options.use_compression,
-                                      m_options.compression_level}));
-                }
+                OSMFormat::PrimitiveGroup m_type;
 
                 template <typename T>
-                void add_meta(const osmium::OSMObject& object, T& pbf_object) {
+                void add_meta(PrimitiveBlock& block, const osmium::OSMObject& object, T& pbf_object) const {
                     {
                         protozero::packed_field_uint32 field{pbf_object, static_cast<protozero::pbf_tag_type>(T::enum_type::packed_uint32_keys)};
                         for (const auto& tag : object.tags()) {
-                            field.add_element(m_primitive_block->store_in_stringtable_unsigned(tag.key()));
+                            field.add_element(block.store_in_stringtable_unsigned(tag.key()));
                         }
                     }
 
                     {
                         protozero::packed_field_uint32 field{pbf_object, static_cast<protozero::pbf_tag_type>(T::enum_type::packed_uint32_vals)};
                         for (const auto& tag : object.tags()) {
-                            field.add_element(m_primitive_block->store_in_stringtable_unsigned(tag.value()));
+                            field.add_element(block.store_in_stringtable_unsigned(tag.value()));
                         }
                     }
 
@@ -542,7 +642,7 @@ namespace osmium {
                             pbf_info.add_int32(OSMFormat::Info::optional_int32_uid, static_cast<int32_t>(object.uid()));
                         }
                         if (m_options.add_metadata.user()) {
-                            pbf_info.add_uint32(OSMFormat::Info::optional_uint32_user_sid, m_primitive_block->store_in_stringtable_unsigned(object.user()));
+                            pbf_info.add_uint32(OSMFormat::Info::optional_uint32_user_sid, block.store_in_stringtable_unsigned(object.user()));
                         }
                         if (m_options.add_visible_flag) {
                             pbf_info.add_bool(OSMFormat::Info::optional_bool_visible, object.visible());
@@ -550,13 +650,191 @@ namespace osmium {
                     }
                 }
 
-                void switch_primitive_block_type(OSMFormat::PrimitiveGroup type) {
-                    if (!m_primitive_block || !m_primitive_block->can_add(type)) {
-                        store_primitive_block();
-                        m_primitive_block.reset(new PrimitiveBlock{m_options, type, m_bucket_count});
+                void encode_node(PrimitiveBlock& block, const osmium::Node& node) const {
+                    protozero::pbf_builder<OSMFormat::Node> pbf_node{block.group(), OSMFormat::PrimitiveGroup::repeated_Node_nodes};
+
+                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_id, node.id());
+                    add_meta(block, node, pbf_node);
+
+                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_lat, node.location().y());
+                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_lon, node.location().x());
+                }
+
+                void encode_way(PrimitiveBlock& block, const osmium::Way& way) const {
+                    protozero::pbf_builder<OSMFormat::Way> pbf_way{block.group(), OSMFormat::PrimitiveGroup::repeated_Way_ways};
+
+                    pbf_way.add_int64(OSMFormat::Way::required_int64_id, way.id());
+                    add_meta(block, way, pbf_way);
+
+                    {
+                        osmium::DeltaEncode<object_id_type, int64_t> delta_id;
+                        protozero::packed_field_sint64 field{pbf_way, static_cast<protozero::pbf_tag_type>(OSMFormat::Way::packed_sint64_refs)};
+                        for (const auto& node_ref : way.nodes()) {
+                            field.add_element(delta_id.update(node_ref.ref()));
+                        }
+                    }
+
+                    if (m_options.locations_on_ways) {
+                        {
+                            osmium::DeltaEncode<int64_t, int64_t> delta;
+                            protozero::packed_field_sint64 field{pbf_way, static_cast<protozero::pbf_tag_type>(OSMFormat::Way::packed_sint64_lon)};
+                            for (const auto& node_ref : way.nodes()) {
+                                field.add_element(delta.update(node_ref.location().x()));
+                            }
+                        }
+                        {
+                            osmium::DeltaEncode<int64_t, int64_t> delta;
+                            protozero::packed_field_sint64 field{pbf_way, static_cast<protozero::pbf_tag_type>(OSMFormat::Way::packed_sint64_lat)};
+                            for (const auto& node_ref : way.nodes()) {
+                                field.add_element(delta.update(node_ref.location().y()));
+                            }
+                        }
                     }
                 }
 
+                void encode_relation(PrimitiveBlock& block, const osmium::Relation& relation) const {
+                    protozero::pbf_builder<OSMFormat::Relation> pbf_relation{block.group(), OSMFormat::PrimitiveGroup::repeated_Relation_relations};
+
+                    pbf_relation.add_int64(OSMFormat::Relation::required_int64_id, relation.id());
+                    add_meta(block, relation, pbf_relation);
+
+                    {
+                        protozero::packed_field_int32 field{pbf_relation, static_cast<protozero::pbf_tag_type>(OSMFormat::Relation::packed_int32_roles_sid)};
+                        for (const auto& member : relation.members()) {
+                            field.add_element(block.store_in_stringtable(member.role()));
+                        }
+                    }
+
+                    {
+                        osmium::DeltaEncode<object_id_type, int64_t> delta_id;
+                        protozero::packed_field_sint64 field{pbf_relation, static_cast<protozero::pbf_tag_type>(OSMFormat::Relation::packed_sint64_memids)};
+                        for (const auto& member : relation.members()) {
+                            field.add_element(delta_id.update(member.ref()));
+                        }
+                    }
+
+                    {
+                        protozero::packed_field_int32 field{pbf_relation, static_cast<protozero::pbf_tag_type>(OSMFormat::Relation::packed_MemberType_types)};
+                        for (const auto& member : relation.members()) {
+                            field.add_element(static_cast<int32_t>(osmium::item_type_to_nwr_index(member.type())));
+                        }
+                    }
+                }
+
+                void encode(PrimitiveBlock& block, const osmium::OSMObject& object) const {
+                    switch (object.type()) {
+                        case osmium::item_type::node:
+                            if (m_type == OSMFormat::PrimitiveGroup::optional_DenseNodes_dense) {
+                                block.add_dense_node(static_cast<const osmium::Node&>(object));
+                            } else {
+                                encode_node(block, static_cast<const osmium::Node&>(object));
+                            }
+                            break;
+                        case osmium::item_type::way:
+                            encode_way(block, static_cast<const osmium::Way&>(object));
+                            break;
+                        case osmium::item_type::relation:
+                            encode_relation(block, static_cast<const osmium::Relation&>(object));
+                            break;
+                        default:
+                            assert(false && "can only encode nodes, ways, and relations");
+                    }
+                }
+
+                std::string serialize_block(std::shared_ptr<PrimitiveBlock>&& block) const {
+                    m_bucket_count->store(block->get_bucket_count());
+                    std::string data{SerializeBlob{block,
+                                                   pbf_blob_type::data,
+                                                   m_options.use_compression,
+                                                   m_options.compression_level}()};
+                    PrimitiveBlockPool::instance().put(std::move(block));
+                    return data;
+                }
+
+            public:
+
+                SerializeBatch(std::vector<std::shared_ptr<osmium::memory::Buffer>>&& buffers,
+                               std::vector<const osmium::OSMObject*>&& objects,
+                               const pbf_output_options& options,
+                               OSMFormat::PrimitiveGroup type,
+                               std::shared_ptr<std::atomic<std::size_t>> bucket_count) :
+                    m_buffers(std::move(buffers)),
+                    m_objects(std::move(objects)),
+                    m_options(options),
+                    m_bucket_count(std::move(bucket_count)),
+                    m_type(type) {
+                }
+
+                /**
+                 * Encode all objects of the batch into primitive blocks,
+                 * serialize the blocks into blobs, and return the blobs
+                 * concatenated in a form ready to be written to a file.
+                 * A new block is started whenever the current one is full.
+                 */
+                std::string operator()() {
+                    std::string output;
+
+                    std::shared_ptr<PrimitiveBlock> block{PrimitiveBlockPool::instance().get(m_options, m_type, m_bucket_count->load())};
+                    for (const osmium::OSMObject* object : m_objects) {
+                        if (!block->can_add(m_type)) {
+                            output += serialize_block(std::move(block));
+                            block = PrimitiveBlockPool::instance().get(m_options, m_type, m_bucket_count->load());
+                        }
+                        encode(*block, *object);
+                    }
+                    output += serialize_block(std::move(block));
+
+                    return output;
+                }
+
+            }; // class SerializeBatch
+
+            class PBFOutputFormat : public osmium::io::detail::OutputFormat, public osmium::handler::Handler {
+
+                pbf_output_options m_options;
+
+                /// The buffer currently being written, shared with all batches using it.
+                std::shared_ptr<osmium::memory::Buffer> m_input_buffer{};
+
+                /// The buffers keeping the objects of the current batch alive.
+                std::vector<std::shared_ptr<osmium::memory::Buffer>> m_batch_buffers{};
+
+                /// The objects collected for the current batch.
+                std::vector<const osmium::OSMObject*> m_batch_objects{};
+
+                std::shared_ptr<std::atomic<std::size_t>> m_bucket_count =
+                    std::make_shared<std::atomic<std::size_t>>(static_cast<std::size_t>(StringTable::min_bucket_count));
+
+                OSMFormat::PrimitiveGroup m_batch_type = OSMFormat::PrimitiveGroup::optional_DenseNodes_dense;
+
+                void flush_batch() {
+                    if (m_batch_objects.empty()) {
+                        return;
+                    }
+
+                    m_output_queue.push(m_pool.submit(
+                        SerializeBatch{std::move(m_batch_buffers),
+                                       std::move(m_batch_objects),
+                                       m_options,
+                                       m_batch_type,
+                                       m_bucket_count}));
+
+                    m_batch_buffers.clear();
+                    m_batch_objects.clear();
+                }
+
+                void add_to_batch(const osmium::OSMObject& object, OSMFormat::PrimitiveGroup type) {
+                    if (type != m_batch_type || m_batch_objects.size() >= max_entities_per_block) {
+                        flush_batch();
+                        m_batch_type = type;
+                    }
+
+                    if (m_batch_buffers.empty() || m_batch_buffers.back() != m_input_buffer) {
+                        m_batch_buffers.push_back(m_input_buffer);
+                    }
+                    m_batch_objects.push_back(&object);
+                }
+
             public:
 
                 PBFOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
@@ -566,12 +844,23 @@ namespace osmium {
                         throw std::invalid_argument{"The 'pbf_add_metadata' option is deprecated. Please use 'add_metadata' instead."};
                     }
 
+                    const auto generic_options = resolve_generic_output_options(file);
                     m_options.use_dense_nodes = file.is_not_false("pbf_dense_nodes");
                     m_options.use_compression = get_compression_type(file.get("pbf_compression"));
-                    m_options.add_metadata = osmium::metadata_options{file.get("add_metadata")};
+                    m_options.add_metadata = generic_options.add_metadata;
                     m_options.add_historical_information_flag = file.has_multiple_object_versions();
                     m_options.add_visible_flag = file.has_multiple_object_versions();
-                    m_options.locations_on_ways = file.is_true("locations_on_ways");
+                    m_options.locations_on_ways = generic_options.locations_on_ways;
+
+                    const auto scs = file.get("pbf_stringtable_chunk_size");
+                    if (!scs.empty()) {
+                        char* end_ptr = nullptr;
+                        const auto val = std::strtol(scs.c_str(), &end_ptr, 10);
+                        if (*end_ptr != '\0' || val < 1024) {
+                            throw std::invalid_argument{"The 'pbf_stringtable_chunk_size' option must be an integer of at least 1024."};
+                        }
+                        m_options.stringtable_chunk_size = static_cast<std::size_t>(val);
+                    }
 
                     const auto pbl = file.get("pbf_compression_level");
                     if (pbl.empty()) {
@@ -667,91 +956,34 @@ namespace osmium {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    osmium::apply(buffer.cbegin(), buffer.cend(), *this);
+                    m_input_buffer = make_input_buffer(std::move(buffer), m_buffer_pool);
+                    if (m_filter) {
+                        for (auto it = m_input_buffer->cbegin(); it != m_input_buffer->cend(); ++it) {
+                            if ((*m_filter)(*it)) {
+                                osmium::apply_item(*it, *this);
+                            }
+                        }
+                    } else {
+                        osmium::apply(m_input_buffer->cbegin(), m_input_buffer->cend(), *this);
+                    }
                 }
 
                 void write_end() final {
-                    store_primitive_block();
+                    flush_batch();
+                    m_input_buffer.reset();
                 }
 
                 void node(const osmium::Node& node) {
-                    if (m_options.use_dense_nodes) {
-                        switch_primitive_block_type(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense);
-                        m_primitive_block->add_dense_node(node);
-                        return;
-                    }
-
-                    switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes);
-                    protozero::pbf_builder<OSMFormat::Node> pbf_node{m_primitive_block->group(), OSMFormat::PrimitiveGroup::repeated_Node_nodes};
-
-                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_id, node.id());
-                    add_meta(node, pbf_node);
-
-                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_lat, node.location().y());
-                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_lon, node.location().x());
+                    add_to_batch(node, m_options.use_dense_nodes ? OSMFormat::PrimitiveGroup::optional_DenseNodes_dense
+                                                                 : OSMFormat::PrimitiveGroup::repeated_Node_nodes);
                 }
 
                 void way(const osmium::Way& way) {
-                    switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Way_ways);
-                    protozero::pbf_builder<OSMFormat::Way> pbf_way{m_primitive_block->group(), OSMFormat::PrimitiveGroup::repeated_Way_ways};
-
-                    pbf_way.add_int64(OSMFormat::Way::required_int64_id, way.id());
-                    add_meta(way, pbf_way);
-
-                    {
-                        osmium::DeltaEncode<object_id_type, int64_t> delta_id;
-                        protozero::packed_field_sint64 field{pbf_way, static_cast<protozero::pbf_tag_type>(OSMFormat::Way::packed_sint64_refs)};
-                        for (const auto& node_ref : way.nodes()) {
-                            field.add_element(delta_id.update(node_ref.ref()));
-                        }
-                    }
-
-                    if (m_options.locations_on_ways) {
-                        {
-                            osmium::DeltaEncode<int64_t, int64_t> delta;
-                            protozero::packed_field_sint64 field{pbf_way, static_cast<protozero::pbf_tag_type>(OSMFormat::Way::packed_sint64_lon)};
-                            for (const auto& node_ref : way.nodes()) {
-                                field.add_element(delta.update(node_ref.location().x()));
-                            }
-                        }
-                        {
-                            osmium::DeltaEncode<int64_t, int64_t> delta;
-                            protozero::packed_field_sint64 field{pbf_way, static_cast<protozero::pbf_tag_type>(OSMFormat::Way::packed_sint64_lat)};
-                            for (const auto& node_ref : way.nodes()) {
-                                field.add_element(delta.update(node_ref.location().y()));
-                            }
-                        }
-                    }
+                    add_to_batch(way, OSMFormat::PrimitiveGroup::repeated_Way_ways);
                 }
 
                 void relation(const osmium::Relation& relation) {
-                    switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Relation_relations);
-                    protozero::pbf_builder<OSMFormat::Relation> pbf_relation{m_primitive_block->group(), OSMFormat::PrimitiveGroup::repeated_Relation_relations};
-
-                    pbf_relation.add_int64(OSMFormat::Relation::required_int64_id, relation.id());
-                    add_meta(relation, pbf_relation);
-
-                    {
-                        protozero::packed_field_int32 field{pbf_relation, static_cast<protozero::pbf_tag_type>(OSMFormat::Relation::packed_int32_roles_sid)};
-                        for (const auto& member : relation.members()) {
-                            field.add_element(m_primitive_block->store_in_stringtable(member.role()));
-                        }
-                    }
-
-                    {
-                        osmium::DeltaEncode<object_id_type, int64_t> delta_id;
-                        protozero::packed_field_sint64 field{pbf_relation, static_cast<protozero::pbf_tag_type>(OSMFormat::Relation::packed_sint64_memids)};
-                        for (const auto& member : relation.members()) {
-                            field.add_element(delta_id.update(member.ref()));
-                        }
-                    }
-
-                    {
-                        protozero::packed_field_int32 field{pbf_relation, static_cast<protozero::pbf_tag_type>(OSMFormat::Relation::packed_MemberType_types)};
-                        for (const auto& member : relation.members()) {
-                            field.add_element(static_cast<int32_t>(osmium::item_type_to_nwr_index(member.type())));
-                        }
-                    }
+                    add_to_batch(relation, OSMFormat::PrimitiveGroup::repeated_Relation_relations);
                 }
 
             }; // class PBFOutputFormat
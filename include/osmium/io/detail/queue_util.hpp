@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/memory/buffer.hpp>
+#include <osmium/thread/lockfree_queue.hpp>
 #include <osmium/thread/queue.hpp>
 
 #include <cassert>
@@ -70,6 +71,15 @@ namespace osmium {
              */
             using future_string_queue_type = future_queue_type<std::string>;
 
+            /**
+             * Like future_queue_type, but based on the lock-free queue
+             * instead of the mutex-based one. Use this where many threads
+             * push to or pop from the same queue and the futex contention
+             * in osmium::thread::Queue becomes a bottleneck.
+             */
+            template <typename T>
+            using lockfree_future_queue_type = osmium::thread::LockfreeQueue<std::future<T>>;
+
             template <typename T>
             inline void add_to_queue(future_queue_type<T>& queue, T&& data) {
                 std::promise<T> promise;
@@ -89,6 +99,25 @@ namespace osmium {
                 add_to_queue<T>(queue, T{});
             }
 
+            template <typename T>
+            inline void add_to_queue(lockfree_future_queue_type<T>& queue, T&& data) {
+                std::promise<T> promise;
+                queue.push(promise.get_future());
+                promise.set_value(std::forward<T>(data));
+            }
+
+            template <typename T>
+            inline void add_to_queue(lockfree_future_queue_type<T>& queue, std::exception_ptr&& exception) {
+                std::promise<T> promise;
+                queue.push(promise.get_future());
+                promise.set_exception(std::move(exception));
+            }
+
+            template <typename T>
+            inline void add_end_of_data_to_queue(lockfree_future_queue_type<T>& queue) {
+                add_to_queue<T>(queue, T{});
+            }
+
             inline bool at_end_of_data(const std::string& data) noexcept {
                 return data.empty();
             }
@@ -97,14 +126,14 @@ namespace osmium {
                 return !buffer;
             }
 
-            template <typename T>
+            template <typename T, typename TQueue = future_queue_type<T>>
             class queue_wrapper {
 
-                future_queue_type<T>& m_queue;
+                TQueue& m_queue;
 
             public:
 
-                explicit queue_wrapper(future_queue_type<T>& queue) :
+                explicit queue_wrapper(TQueue& queue) :
                     m_queue(queue) {
                 }
 
@@ -129,6 +158,11 @@ namespace osmium {
                     return !m_queue.in_use();
                 }
 
+                /// Is there currently no data waiting in the queue?
+                bool empty() const {
+                    return m_queue.empty();
+                }
+
                 T pop() {
                     T data;
                     if (m_queue.in_use()) {
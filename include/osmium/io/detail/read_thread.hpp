@@ -35,9 +35,12 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/stats.hpp>
 #include <osmium/thread/util.hpp>
+#include <osmium/util/probes.hpp>
 
 #include <atomic>
+#include <cassert>
 #include <exception>
 #include <string>
 #include <thread>
@@ -60,6 +63,7 @@ namespace osmium {
                 // only used in the sub-thread
                 osmium::io::Decompressor& m_decompressor;
                 future_string_queue_type& m_queue;
+                IOStatsCollector* m_stats;
 
                 // used in both threads
                 std::atomic<bool> m_done;
@@ -67,12 +71,18 @@ namespace osmium {
                 // only used in the main thread
                 std::thread m_thread;
 
-                void run_in_thread() {
-                    osmium::thread::set_thread_name("_osmium_read");
-
+                void run() {
                     try {
                         while (!m_done) {
-                            std::string data{m_decompressor.read()};
+                            std::string data;
+                            if (m_stats) {
+                                const auto start = IOStatsCollector::clock::now();
+                                data = m_decompressor.read();
+                                m_stats->add_io(IOStatsCollector::elapsed_ns(start), data.size());
+                            } else {
+                                data = m_decompressor.read();
+                            }
+                            OSMIUM_PROBE1(blob_read, data.size());
                             if (at_end_of_data(data)) {
                                 break;
                             }
@@ -87,14 +97,28 @@ namespace osmium {
                     add_end_of_data_to_queue(m_queue);
                 }
 
+                void run_in_thread() {
+                    osmium::thread::set_thread_name("_osmium_read");
+                    run();
+                }
+
             public:
 
+                /**
+                 * If start_thread is false, no thread is started and the
+                 * caller has to call run_inline() to do the work of the
+                 * read thread. Make sure the queue can hold the complete
+                 * input in that case, run_inline() blocks otherwise.
+                 */
                 ReadThreadManager(osmium::io::Decompressor& decompressor,
-                                  future_string_queue_type& queue) :
+                                  future_string_queue_type& queue,
+                                  IOStatsCollector* stats = nullptr,
+                                  bool start_thread = true) :
                     m_decompressor(decompressor),
                     m_queue(queue),
+                    m_stats(stats),
                     m_done(false),
-                    m_thread(std::thread(&ReadThreadManager::run_in_thread, this)) {
+                    m_thread(start_thread ? std::thread(&ReadThreadManager::run_in_thread, this) : std::thread{}) {
                 }
 
                 ReadThreadManager(const ReadThreadManager&) = delete;
@@ -111,6 +135,21 @@ namespace osmium {
                     }
                 }
 
+                /// Do the work of the read thread in the calling thread.
+                void run_inline() {
+                    run();
+                }
+
+                /**
+                 * Start the read thread. Only call this once and only if
+                 * the manager was constructed with start_thread set to
+                 * false and run_inline() is not used.
+                 */
+                void start() {
+                    assert(!m_thread.joinable());
+                    m_thread = std::thread{&ReadThreadManager::run_in_thread, this};
+                }
+
                 void stop() noexcept {
                     m_done = true;
                 }
@@ -272,6 +272,27 @@ namespace osmium {
                 return fd2;
             }
 
+            /**
+             * Tell the filesystem how large the file written through this
+             * file descriptor is expected to become, so it can reserve
+             * contiguous space up front instead of growing the file in
+             * small, badly fragmented extents. The hint does not have to
+             * be exact and the file size is not changed, so nothing needs
+             * to be truncated if less data is written in the end. This is
+             * best effort: if the filesystem does not support
+             * preallocation or this platform has no suitable call,
+             * nothing happens.
+             */
+#ifdef __linux__
+            inline void preallocate_file_space(int fd, std::size_t size) noexcept {
+                if (fd > 2 && size > 0) {
+                    ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size));
+                }
+#else
+            inline void preallocate_file_space(int /*fd*/, std::size_t /*size*/) noexcept {
+#endif
+            }
+
             /**
              * Tell the kernel to remove all pages from this file from the
              * buffer cache. Used when reading a large file that will not be
@@ -0,0 +1,72 @@
+#ifndef OSMIUM_IO_DETAIL_SHM_COMMON_HPP
+#define OSMIUM_IO_DETAIL_SHM_COMMON_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * The "shm" format (also addressable as "blob") is a stream
+             * of osmium::memory::Buffer contents in their raw in-memory
+             * form: after the magic every record is a uint64_t with the
+             * number of payload bytes (in host byte order, like
+             * everything else in this format) followed by that many raw
+             * buffer bytes. If the topmost bit of the record size is set,
+             * the payload is an lz4 block and a uint64_t with the
+             * uncompressed size follows the record size. It is meant as a
+             * transport format between osmium-based processes or pipeline
+             * stages on the same machine (through files in /dev/shm or
+             * through pipes), not as an archival format.
+             */
+            constexpr const char shm_format_magic[] = "OSMSHM01";
+
+            // Not including the terminating null byte.
+            constexpr const std::size_t shm_format_magic_size = sizeof(shm_format_magic) - 1;
+
+            // Topmost bit of the record size marks lz4-compressed records.
+            constexpr const std::uint64_t shm_record_compressed_flag = 1ULL << 63U;
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_SHM_COMMON_HPP
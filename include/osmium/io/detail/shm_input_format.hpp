@@ -0,0 +1,215 @@
+#ifndef OSMIUM_IO_DETAIL_SHM_INPUT_FORMAT_HPP
+#define OSMIUM_IO_DETAIL_SHM_INPUT_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/input_format.hpp>
+#include <osmium/io/detail/shm_common.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/thread/util.hpp>
+
+#ifdef OSMIUM_WITH_LZ4
+# include <osmium/io/detail/lz4.hpp>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Reads a stream of buffers in the raw in-memory buffer format
+             * ("shm" format) as written by the ShmOutputFormat. Every
+             * record becomes one osmium::memory::Buffer, no decoding is
+             * needed, the record bytes only have to be copied into place.
+             */
+            class ShmParser : public Parser {
+
+                std::string m_input{};
+                std::size_t m_pos = 0;
+
+                /**
+                 * Make sure at least size unconsumed bytes are available
+                 * in m_input. Returns false if the input ends before that
+                 * many bytes could be read.
+                 */
+                bool ensure_bytes(const std::size_t size) {
+                    while (m_input.size() - m_pos < size) {
+                        if (m_pos > 0) {
+                            m_input.erase(0, m_pos);
+                            m_pos = 0;
+                        }
+                        const std::string data{get_input()};
+                        if (data.empty()) {
+                            return false;
+                        }
+                        m_input.append(data);
+                    }
+                    return true;
+                }
+
+                std::size_t available() const noexcept {
+                    return m_input.size() - m_pos;
+                }
+
+                void check_magic() {
+                    if (!ensure_bytes(shm_format_magic_size) ||
+                        std::memcmp(m_input.data() + m_pos, shm_format_magic, shm_format_magic_size) != 0) {
+                        throw osmium::io_error{"Input data not in 'shm' buffer format."};
+                    }
+                    m_pos += shm_format_magic_size;
+                }
+
+                /**
+                 * The raw pass-through can not leave out entities, so if
+                 * only some entity types should be read, the wanted ones
+                 * are copied into a fresh buffer.
+                 */
+                osmium::memory::Buffer filter_entities(const osmium::memory::Buffer& buffer) {
+                    osmium::memory::Buffer filtered{buffer.committed(), osmium::memory::Buffer::auto_grow::yes};
+                    for (const auto& entity : buffer.select<osmium::OSMEntity>()) {
+                        if ((osmium::osm_entity_bits::from_item_type(entity.type()) & read_types()) != osmium::osm_entity_bits::nothing) {
+                            filtered.add_item(entity);
+                            filtered.commit();
+                        }
+                    }
+                    return filtered;
+                }
+
+            public:
+
+                explicit ShmParser(parser_arguments& args) :
+                    Parser(args) {
+                }
+
+                ShmParser(const ShmParser&) = delete;
+                ShmParser& operator=(const ShmParser&) = delete;
+
+                ShmParser(ShmParser&&) = delete;
+                ShmParser& operator=(ShmParser&&) = delete;
+
+                ~ShmParser() noexcept override = default;
+
+                void run() override {
+                    osmium::thread::set_thread_name("_osmium_shm_in");
+
+                    check_magic();
+                    set_header_value(osmium::io::Header{});
+
+                    uint64_t record_size = 0;
+                    while (ensure_bytes(sizeof(record_size))) {
+                        std::memcpy(&record_size, m_input.data() + m_pos, sizeof(record_size));
+                        m_pos += sizeof(record_size);
+
+                        const bool compressed = (record_size & shm_record_compressed_flag) != 0;
+                        record_size &= ~shm_record_compressed_flag;
+
+                        uint64_t raw_size = record_size;
+                        if (compressed) {
+                            if (!ensure_bytes(sizeof(raw_size))) {
+                                throw osmium::io_error{"Premature end of file in 'shm' buffer format."};
+                            }
+                            std::memcpy(&raw_size, m_input.data() + m_pos, sizeof(raw_size));
+                            m_pos += sizeof(raw_size);
+                        }
+
+                        if (record_size == 0) {
+                            continue;
+                        }
+                        if (!ensure_bytes(record_size)) {
+                            throw osmium::io_error{"Premature end of file in 'shm' buffer format."};
+                        }
+
+                        std::unique_ptr<unsigned char[]> data{new unsigned char[raw_size]};
+                        if (compressed) {
+#ifdef OSMIUM_WITH_LZ4
+                            std::string uncompressed;
+                            lz4_uncompress_string(m_input.data() + m_pos,
+                                                  static_cast<unsigned long>(record_size), // NOLINT(google-runtime-int)
+                                                  static_cast<unsigned long>(raw_size), // NOLINT(google-runtime-int)
+                                                  uncompressed);
+                            std::memcpy(data.get(), uncompressed.data(), raw_size);
+#else
+                            throw osmium::io_error{"lz4 compression not supported in 'shm' format"};
+#endif
+                        } else {
+                            std::memcpy(data.get(), m_input.data() + m_pos, record_size);
+                        }
+                        m_pos += record_size;
+
+                        osmium::memory::Buffer buffer{std::move(data), raw_size, raw_size};
+                        if (read_types() != osmium::osm_entity_bits::all) {
+                            buffer = filter_entities(buffer);
+                        }
+                        send_to_output_queue(std::move(buffer));
+                    }
+
+                    if (available() > 0) {
+                        throw osmium::io_error{"Premature end of file in 'shm' buffer format."};
+                    }
+                }
+
+            }; // class ShmParser
+
+            // we want the register_parser() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_shm_parser = ParserFactory::instance().register_parser(
+                file_format::shm,
+                [](parser_arguments& args) {
+                    return std::unique_ptr<Parser>(new ShmParser{args});
+                });
+
+            // dummy function to silence the unused variable warning from above
+            inline bool get_registered_shm_parser() noexcept {
+                return registered_shm_parser;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_SHM_INPUT_FORMAT_HPP
@@ -0,0 +1,168 @@
+#ifndef OSMIUM_IO_DETAIL_SHM_OUTPUT_FORMAT_HPP
+#define OSMIUM_IO_DETAIL_SHM_OUTPUT_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/output_format.hpp>
+#include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/detail/shm_common.hpp>
+#include <osmium/io/detail/string_pool.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity.hpp>
+#include <osmium/thread/pool.hpp>
+
+#ifdef OSMIUM_WITH_LZ4
+# include <osmium/io/detail/lz4.hpp>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Writes out buffers with OSM data in the raw in-memory buffer
+             * format ("shm" format). Because the buffer contents are
+             * position-independent, the data does not have to be encoded
+             * at all: each committed buffer becomes one length-prefixed
+             * record of raw bytes. Point the file name at a file in
+             * /dev/shm (or use a pipe) and the next osmium-based process
+             * in a pipeline can pick the buffers up without any
+             * serialize/deserialize cycle. The data is only valid on the
+             * machine (and architecture) it was written on, this is a
+             * transport format, not an archival format.
+             */
+            class ShmOutputFormat : public osmium::io::detail::OutputFormat {
+
+                bool m_use_lz4 = false;
+
+                void append_record(std::string& out, const unsigned char* data, const std::size_t size) const {
+                    if (m_use_lz4) {
+#ifdef OSMIUM_WITH_LZ4
+                        const std::string compressed{lz4_compress(std::string{reinterpret_cast<const char*>(data), size})};
+                        const uint64_t record_size = compressed.size() | shm_record_compressed_flag;
+                        const uint64_t raw_size = size;
+                        out.append(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+                        out.append(reinterpret_cast<const char*>(&raw_size), sizeof(raw_size));
+                        out.append(compressed);
+                        return;
+#endif
+                    }
+                    const uint64_t record_size = size;
+                    out.append(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+                    out.append(reinterpret_cast<const char*>(data), size);
+                }
+
+            public:
+
+                ShmOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
+                    OutputFormat(pool, output_queue) {
+                    const std::string compression{file.get("shm_compression")};
+                    if (compression == "lz4") {
+#ifdef OSMIUM_WITH_LZ4
+                        m_use_lz4 = true;
+#else
+                        throw osmium::io_error{"lz4 compression not supported in 'shm' format"};
+#endif
+                    } else if (!compression.empty() && compression != "none") {
+                        throw std::invalid_argument{std::string{"Unknown value for 'shm_compression' option: '"} + compression + "'"};
+                    }
+                }
+
+                void write_header(const osmium::io::Header& /*header*/) final {
+                    // Only the magic is written. The header data is not
+                    // transported, the reading side uses a default
+                    // constructed header.
+                    send_to_output_queue(std::string{shm_format_magic, shm_format_magic_size});
+                }
+
+                void write_buffer(osmium::memory::Buffer&& buffer) final {
+                    std::string out{StringPool::instance().get()};
+
+                    if (m_filter) {
+                        // With a filter set the raw pass-through is not
+                        // possible, the surviving entities are copied
+                        // item by item. Their padded raw bytes
+                        // concatenated are again valid buffer contents.
+                        std::string body;
+                        for (const auto& entity : buffer.select<osmium::OSMEntity>()) {
+                            if ((*m_filter)(entity)) {
+                                body.append(reinterpret_cast<const char*>(&entity), entity.padded_size());
+                            }
+                        }
+                        if (!body.empty()) {
+                            append_record(out, reinterpret_cast<const unsigned char*>(body.data()), body.size());
+                        }
+                    } else {
+                        append_record(out, buffer.data(), buffer.committed());
+                    }
+
+                    if (m_buffer_pool) {
+                        m_buffer_pool->release(std::move(buffer));
+                    }
+
+                    send_to_output_queue(std::move(out));
+                }
+
+            }; // class ShmOutputFormat
+
+            // we want the register_output_format() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_shm_output = osmium::io::detail::OutputFormatFactory::instance().register_output_format(osmium::io::file_format::shm,
+                [](osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) {
+                    return new osmium::io::detail::ShmOutputFormat(pool, file, output_queue);
+            });
+
+            // dummy function to silence the unused variable warning from above
+            inline bool get_registered_shm_output() noexcept {
+                return registered_shm_output;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_SHM_OUTPUT_FORMAT_HPP
@@ -0,0 +1,122 @@
+#ifndef OSMIUM_IO_DETAIL_STRING_POOL_HPP
+#define OSMIUM_IO_DETAIL_STRING_POOL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Pool of std::strings used as serialization buffers. When
+             * writing OSM data each buffer of data is serialized into a
+             * freshly allocated string which is freed again after it was
+             * written out. On writers with many serialization threads
+             * this constant allocation and deallocation of large strings
+             * creates contention in the allocator. This pool keeps a
+             * small number of used strings around and hands them out
+             * again, so sustained writing does not allocate any more.
+             */
+            class StringPool {
+
+                enum size_limits : std::size_t {
+                    // More strings than this are never kept, whatever
+                    // else is returned to the pool is freed normally.
+                    max_pool_size = 32,
+
+                    // Strings with less capacity than this are not
+                    // worth keeping.
+                    min_string_capacity = 1024,
+
+                    // Strings with a larger capacity than this are never
+                    // kept, so one oversized serialization result can
+                    // not hold on to memory forever.
+                    max_string_capacity = 64UL * 1024UL * 1024UL
+                };
+
+                std::mutex m_mutex;
+                std::vector<std::string> m_strings;
+
+            public:
+
+                static StringPool& instance() {
+                    static StringPool pool;
+                    return pool;
+                }
+
+                /**
+                 * Get a string from the pool. Returns an empty string
+                 * which possibly still has capacity from an earlier use.
+                 */
+                std::string get() {
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    if (m_strings.empty()) {
+                        return std::string{};
+                    }
+                    std::string str{std::move(m_strings.back())};
+                    m_strings.pop_back();
+                    return str;
+                }
+
+                /**
+                 * Return a string to the pool for later reuse. The
+                 * content is cleared, the allocated memory is kept.
+                 */
+                void put(std::string&& str) {
+                    if (str.capacity() < min_string_capacity || str.capacity() > max_string_capacity) {
+                        return;
+                    }
+                    str.clear();
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    if (m_strings.size() < max_pool_size) {
+                        m_strings.push_back(std::move(str));
+                    }
+                }
+
+            }; // class StringPool
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_STRING_POOL_HPP
@@ -42,8 +42,8 @@ DEALINGS IN THE SOFTWARE.
 #include <iterator>
 #include <list>
 #include <string>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -57,34 +57,62 @@ namespace osmium {
              * Storage of lots of strings (const char *). Memory is allocated in chunks.
              * If a string is added and there is no space in the current chunk, a new
              * chunk will be allocated. Strings added to the store must not be larger
-             * than the chunk size.
+             * than the chunk size. Use a chunk size large enough for all the strings
+             * you expect if you want a single contiguous allocation.
              *
-             * All memory is released when the destructor is called. There is no other way
-             * to release all or part of the memory.
+             * Chunks are only ever freed by the destructor. clear() empties the
+             * store but keeps the chunk memory around for reuse, so a store that
+             * is cleared and filled over and over again only allocates in the
+             * first few rounds.
              *
              */
             class StringStore {
 
+                using const_chunk_iterator = std::list<std::string>::const_iterator;
+
                 size_t m_chunk_size;
 
                 std::list<std::string> m_chunks;
 
-                void add_chunk() {
-                    m_chunks.emplace_back();
-                    m_chunks.back().reserve(m_chunk_size);
+                /// The chunk new strings are currently added to.
+                std::list<std::string>::iterator m_current;
+
+                void next_chunk() {
+                    if (std::next(m_current) == m_chunks.end()) {
+                        m_chunks.emplace_back();
+                        m_chunks.back().reserve(m_chunk_size);
+                    }
+                    ++m_current;
                 }
 
             public:
 
                 explicit StringStore(size_t chunk_size) :
                     m_chunk_size(chunk_size) {
-                    add_chunk();
+                    m_chunks.emplace_back();
+                    m_chunks.front().reserve(m_chunk_size);
+                    m_current = m_chunks.begin();
                 }
 
+                StringStore(const StringStore&) = delete;
+                StringStore& operator=(const StringStore&) = delete;
+
+                StringStore(StringStore&&) noexcept = default;
+                StringStore& operator=(StringStore&&) noexcept = default;
+
+                ~StringStore() noexcept = default;
+
+                /**
+                 * Remove all strings from the store. The allocated chunks
+                 * are kept and will be filled again by later calls to
+                 * add().
+                 */
                 void clear() noexcept {
                     assert(!m_chunks.empty());
-                    m_chunks.erase(std::next(m_chunks.begin()), m_chunks.end());
-                    m_chunks.front().clear();
+                    for (auto& chunk : m_chunks) {
+                        chunk.clear();
+                    }
+                    m_current = m_chunks.begin();
                 }
 
                 /**
@@ -98,16 +126,16 @@ namespace osmium {
 
                     assert(len <= m_chunk_size);
 
-                    size_t chunk_len = m_chunks.back().size();
-                    if (chunk_len + len > m_chunks.back().capacity()) {
-                        add_chunk();
+                    size_t chunk_len = m_current->size();
+                    if (chunk_len + len > m_current->capacity()) {
+                        next_chunk();
                         chunk_len = 0;
                     }
 
-                    m_chunks.back().append(string);
-                    m_chunks.back().append(1, '\0');
+                    m_current->append(string);
+                    m_current->append(1, '\0');
 
-                    return m_chunks.back().c_str() + chunk_len;
+                    return m_current->c_str() + chunk_len;
                 }
 
                 class const_iterator {
@@ -178,11 +206,12 @@ namespace osmium {
                     if (m_chunks.front().empty()) {
                         return end();
                     }
-                    return {m_chunks.begin(), m_chunks.end()};
+                    return {m_chunks.begin(), std::next(const_chunk_iterator(m_current))};
                 }
 
                 const_iterator end() const {
-                    return {m_chunks.end(), m_chunks.end()};
+                    const auto last = std::next(const_chunk_iterator(m_current));
+                    return {last, last};
                 }
 
                 // These functions get you some idea how much memory was
@@ -196,7 +225,7 @@ namespace osmium {
                 }
 
                 size_t get_used_bytes_in_last_chunk() const noexcept {
-                    return m_chunks.back().size();
+                    return m_current->size();
                 }
 
             }; // class StringStore
@@ -236,9 +265,48 @@ namespace osmium {
                 };
 
                 StringStore m_strings;
-                std::unordered_map<const char*, int32_t, djb2_hash, str_equal> m_index;
+
+                // Pointers to the interned strings, the string with the
+                // id n is at index n - 1.
+                std::vector<const char*> m_string_ptrs;
+
+                // Open addressing hash table with linear probing indexing
+                // into m_string_ptrs. The size is always a power of two and
+                // at most half full. Entries contain the string id, 0 means
+                // the slot is empty.
+                std::vector<int32_t> m_table;
+
                 int32_t m_size = 0;
 
+                static std::size_t round_up_to_power_of_two(std::size_t value) noexcept {
+                    std::size_t result = min_bucket_count;
+                    while (result < value) {
+                        result <<= 1U;
+                    }
+                    return result;
+                }
+
+                void insert(const char* string, const int32_t id) noexcept {
+                    const std::size_t mask = m_table.size() - 1;
+                    std::size_t pos = djb2_hash{}(string) & mask;
+                    while (m_table[pos] != 0) {
+                        pos = (pos + 1) & mask;
+                    }
+                    m_table[pos] = id;
+                }
+
+                void grow_table_if_needed() {
+                    // Grow when the table would be more than half full.
+                    if ((m_string_ptrs.size() + 1) * 2 < m_table.size()) {
+                        return;
+                    }
+                    m_table.assign(m_table.size() * 2, 0);
+                    int32_t id = 0;
+                    for (const char* string : m_string_ptrs) {
+                        insert(string, ++id);
+                    }
+                }
+
             public:
 
                 // There is one string table per PBF primitive block. Most of
@@ -254,12 +322,12 @@ namespace osmium {
 
                 // Minimum bucket count for hash.
                 enum {
-                    min_bucket_count = 1
+                    min_bucket_count = 64
                 };
 
                 explicit StringTable(size_t size = default_stringtable_chunk_size, size_t bucket_count = min_bucket_count) :
                     m_strings(size),
-                    m_index(bucket_count) {
+                    m_table(round_up_to_power_of_two(bucket_count), 0) {
                     m_strings.add("");
                 }
 
@@ -267,23 +335,52 @@ namespace osmium {
                     return m_size + 1;
                 }
 
+                /**
+                 * Remove all strings from the table. The chunk memory of
+                 * the string store and the hash table keep their size, so
+                 * a cleared table can be filled again without allocating.
+                 */
+                void clear() {
+                    m_strings.clear();
+                    m_strings.add("");
+                    m_string_ptrs.clear();
+                    m_table.assign(m_table.size(), 0);
+                    m_size = 0;
+                }
+
+                std::size_t get_chunk_count() const noexcept {
+                    return m_strings.get_chunk_count();
+                }
+
+                std::size_t get_chunk_size() const noexcept {
+                    return m_strings.get_chunk_size();
+                }
+
                 std::size_t get_bucket_count() const noexcept {
-                    return m_index.bucket_count();
+                    return m_table.size();
                 }
 
                 int32_t add(const char* s) {
-                    const auto f = m_index.find(s);
-                    if (f != m_index.end()) {
-                        return f->second;
+                    const std::size_t mask = m_table.size() - 1;
+                    std::size_t pos = djb2_hash{}(s) & mask;
+                    for (int32_t id = m_table[pos]; id != 0; id = m_table[pos]) {
+                        if (str_equal{}(m_string_ptrs[static_cast<std::size_t>(id) - 1], s)) {
+                            return id;
+                        }
+                        pos = (pos + 1) & mask;
                     }
 
                     const char* cs = m_strings.add(s);
-                    m_index[cs] = ++m_size;
+                    ++m_size;
 
                     if (m_size > max_entries) {
                         throw osmium::pbf_error{"string table has too many entries"};
                     }
 
+                    grow_table_if_needed();
+                    m_string_ptrs.push_back(cs);
+                    insert(cs, m_size);
+
                     return m_size;
                 }
 
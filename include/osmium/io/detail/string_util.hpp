@@ -41,6 +41,14 @@ DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <utility>
 
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+# define OSMIUM_STRING_SCAN_SSE2
+# include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+# define OSMIUM_STRING_SCAN_NEON
+# include <arm_neon.h>
+#endif
+
 namespace osmium {
 
     namespace io {
@@ -201,12 +209,127 @@ namespace osmium {
                 out += hex_digits[ value         & 0xfU];
             }
 
+            // Does this character need to be escaped in XML output?
+            inline bool needs_xml_escape(const char c) noexcept {
+                return c == '&' || c == '"' || c == '\'' || c == '<' ||
+                       c == '>' || c == '\n' || c == '\r' || c == '\t';
+            }
+
+            // Can this character be written to OPL output as it is? For
+            // bytes >= 0x80 this depends on the code point, so they never
+            // take the fast path.
+            inline bool is_opl_plain(const char c) noexcept {
+                return c > 0x20 && c < 0x7f &&
+                       c != '%' && c != ',' && c != '=' && c != '@';
+            }
+
+            /**
+             * Find the first character in [data, end) that needs to be
+             * escaped in XML output. Scans 16 bytes at a time where SSE2 or
+             * NEON is available; the clean run before the returned position
+             * can be copied to the output as it is.
+             */
+            inline const char* find_xml_escape(const char* data, const char* const end) noexcept {
+#if defined(OSMIUM_STRING_SCAN_SSE2)
+                while (end - data >= 16) {
+                    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                    __m128i bad =                    _mm_cmpeq_epi8(block, _mm_set1_epi8('&'));
+                    bad = _mm_or_si128(bad, _mm_cmpeq_epi8(block, _mm_set1_epi8('"')));
+                    bad = _mm_or_si128(bad, _mm_cmpeq_epi8(block, _mm_set1_epi8('\'')));
+                    bad = _mm_or_si128(bad, _mm_cmpeq_epi8(block, _mm_set1_epi8('<')));
+                    bad = _mm_or_si128(bad, _mm_cmpeq_epi8(block, _mm_set1_epi8('>')));
+                    bad = _mm_or_si128(bad, _mm_cmpeq_epi8(block, _mm_set1_epi8('\n')));
+                    bad = _mm_or_si128(bad, _mm_cmpeq_epi8(block, _mm_set1_epi8('\r')));
+                    bad = _mm_or_si128(bad, _mm_cmpeq_epi8(block, _mm_set1_epi8('\t')));
+                    if (_mm_movemask_epi8(bad) != 0) {
+                        break; // the scalar loop below finds the exact position
+                    }
+                    data += 16;
+                }
+#elif defined(OSMIUM_STRING_SCAN_NEON)
+                while (end - data >= 16) {
+                    const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+                    uint8x16_t bad =            vceqq_u8(block, vdupq_n_u8('&'));
+                    bad = vorrq_u8(bad, vceqq_u8(block, vdupq_n_u8('"')));
+                    bad = vorrq_u8(bad, vceqq_u8(block, vdupq_n_u8('\'')));
+                    bad = vorrq_u8(bad, vceqq_u8(block, vdupq_n_u8('<')));
+                    bad = vorrq_u8(bad, vceqq_u8(block, vdupq_n_u8('>')));
+                    bad = vorrq_u8(bad, vceqq_u8(block, vdupq_n_u8('\n')));
+                    bad = vorrq_u8(bad, vceqq_u8(block, vdupq_n_u8('\r')));
+                    bad = vorrq_u8(bad, vceqq_u8(block, vdupq_n_u8('\t')));
+                    if (vmaxvq_u8(bad) != 0) {
+                        break; // the scalar loop below finds the exact position
+                    }
+                    data += 16;
+                }
+#endif
+                while (data != end && !needs_xml_escape(*data)) {
+                    ++data;
+                }
+                return data;
+            }
+
+            /**
+             * Find the first character in [data, end) that can not be
+             * written to OPL output as it is. Scans 16 bytes at a time where
+             * SSE2 or NEON is available; the clean run before the returned
+             * position can be copied to the output as it is.
+             */
+            inline const char* find_opl_escape(const char* data, const char* const end) noexcept {
+#if defined(OSMIUM_STRING_SCAN_SSE2)
+                while (end - data >= 16) {
+                    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                    // The signed comparisons also send all bytes >= 0x80
+                    // to the slow path where the code point is decoded.
+                    const __m128i good = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(0x20)),
+                                                       _mm_cmplt_epi8(block, _mm_set1_epi8(0x7f)));
+                    __m128i special =                  _mm_cmpeq_epi8(block, _mm_set1_epi8('%'));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(block, _mm_set1_epi8(',')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(block, _mm_set1_epi8('=')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(block, _mm_set1_epi8('@')));
+                    if (_mm_movemask_epi8(_mm_andnot_si128(special, good)) != 0xffff) {
+                        break; // the scalar loop below finds the exact position
+                    }
+                    data += 16;
+                }
+#elif defined(OSMIUM_STRING_SCAN_NEON)
+                while (end - data >= 16) {
+                    const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+                    const uint8x16_t good = vandq_u8(vcgtq_u8(block, vdupq_n_u8(0x20)),
+                                                     vcltq_u8(block, vdupq_n_u8(0x7f)));
+                    uint8x16_t special =             vceqq_u8(block, vdupq_n_u8('%'));
+                    special = vorrq_u8(special, vceqq_u8(block, vdupq_n_u8(',')));
+                    special = vorrq_u8(special, vceqq_u8(block, vdupq_n_u8('=')));
+                    special = vorrq_u8(special, vceqq_u8(block, vdupq_n_u8('@')));
+                    if (vminvq_u8(vbicq_u8(good, special)) != 0xff) {
+                        break; // the scalar loop below finds the exact position
+                    }
+                    data += 16;
+                }
+#endif
+                while (data != end && is_opl_plain(*data)) {
+                    ++data;
+                }
+                return data;
+            }
+
             inline void append_utf8_encoded_string(std::string& out, const char* data) {
                 static const char* lookup_hex = "0123456789abcdef";
                 assert(data);
                 const char* end_ptr = data + std::strlen(data);
 
                 while (data != end_ptr) {
+                    // Bulk-copy printable ASCII characters that are not
+                    // special in the OPL format. The characters that stop
+                    // the scan are the same ones the code point check below
+                    // would escape, plus everything >= 0x80.
+                    const char* const run_end = find_opl_escape(data, end_ptr);
+                    out.append(data, run_end);
+                    data = run_end;
+                    if (data == end_ptr) {
+                        break;
+                    }
+
                     const char* prev = data;
                     const uint32_t c = next_utf8_codepoint(&data, end_ptr);
 
@@ -238,7 +361,14 @@ namespace osmium {
 
             inline void append_xml_encoded_string(std::string& out, const char* data) {
                 assert(data);
-                for (; *data != '\0'; ++data) {
+                const char* const end_ptr = data + std::strlen(data);
+                while (data != end_ptr) {
+                    const char* const run_end = find_xml_escape(data, end_ptr);
+                    out.append(data, run_end);
+                    data = run_end;
+                    if (data == end_ptr) {
+                        break;
+                    }
                     switch (*data) {
                         case '&':  out += "&amp;";  break;
                         case '\"': out += "&quot;"; break;
@@ -248,8 +378,9 @@ namespace osmium {
                         case '\n': out += "&#xA;";  break;
                         case '\r': out += "&#xD;";  break;
                         case '\t': out += "&#x9;";  break;
-                        default:   out += *data;    break;
+                        default:                    break;
                     }
+                    ++data;
                 }
             }
 
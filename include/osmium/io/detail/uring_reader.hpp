@@ -0,0 +1,392 @@
+#ifndef OSMIUM_IO_DETAIL_URING_READER_HPP
+#define OSMIUM_IO_DETAIL_URING_READER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#if defined(__linux__) && defined(__has_include)
+# if __has_include(<linux/io_uring.h>)
+#  include <linux/io_uring.h>
+#  include <sys/syscall.h>
+#  if defined(SYS_io_uring_setup) && defined(SYS_io_uring_enter) && defined(SYS_io_uring_register)
+#   define OSMIUM_WITH_IO_URING
+#  endif
+# endif
+#endif
+
+#ifdef OSMIUM_WITH_IO_URING
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Reads a file sequentially using the Linux io_uring interface
+             * with several reads in flight at any time, so the kernel (or
+             * the storage below it) can overlap them. All reads go into
+             * buffers registered with the kernel once at setup time.
+             *
+             * Construction never throws: If io_uring is not available (old
+             * kernel, seccomp filter, resource limits) or the file
+             * descriptor is not a regular file, is_open() returns false
+             * and the caller is expected to fall back to normal blocking
+             * reads.
+             */
+            class UringReader {
+
+                enum : unsigned {
+                    queue_depth = 4
+                };
+
+                std::unique_ptr<char[]> m_buffers{};
+
+                // Submission and completion ring mappings.
+                void* m_sq_ring = MAP_FAILED;
+                void* m_cq_ring = MAP_FAILED;
+                void* m_sqes_map = MAP_FAILED;
+                std::size_t m_sq_ring_size = 0;
+                std::size_t m_cq_ring_size = 0;
+                std::size_t m_sqes_size = 0;
+
+                unsigned* m_sq_tail = nullptr;
+                unsigned* m_sq_mask = nullptr;
+                unsigned* m_sq_array = nullptr;
+                unsigned* m_cq_head = nullptr;
+                unsigned* m_cq_tail = nullptr;
+                unsigned* m_cq_mask = nullptr;
+                struct io_uring_sqe* m_sqes = nullptr;
+                struct io_uring_cqe* m_cqes = nullptr;
+
+                // Read results by buffer slot. Results can complete out of
+                // order, but are handed out strictly in submission order.
+                int m_results[queue_depth] = {0, 0, 0, 0};
+                bool m_completed[queue_depth] = {false, false, false, false};
+
+                std::uint64_t m_next_submit = 0;
+                std::uint64_t m_next_expected = 0;
+                std::uint64_t m_file_offset = 0;
+                unsigned m_in_flight = 0;
+
+                std::size_t m_buffer_size;
+                int m_ring_fd = -1;
+                int m_fd;
+                bool m_eof = false;
+
+                static int sys_setup(unsigned entries, struct io_uring_params* p) noexcept {
+                    return static_cast<int>(::syscall(SYS_io_uring_setup, entries, p));
+                }
+
+                static int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) noexcept {
+                    return static_cast<int>(::syscall(SYS_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+                }
+
+                static int sys_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) noexcept {
+                    return static_cast<int>(::syscall(SYS_io_uring_register, fd, opcode, arg, nr_args));
+                }
+
+                char* buffer(const unsigned slot) noexcept {
+                    return m_buffers.get() + slot * m_buffer_size;
+                }
+
+                void unmap_rings() noexcept {
+                    if (m_sqes_map != MAP_FAILED) {
+                        ::munmap(m_sqes_map, m_sqes_size);
+                        m_sqes_map = MAP_FAILED;
+                    }
+                    if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring) {
+                        ::munmap(m_cq_ring, m_cq_ring_size);
+                    }
+                    m_cq_ring = MAP_FAILED;
+                    if (m_sq_ring != MAP_FAILED) {
+                        ::munmap(m_sq_ring, m_sq_ring_size);
+                        m_sq_ring = MAP_FAILED;
+                    }
+                }
+
+                bool setup() noexcept {
+                    struct io_uring_params params;
+                    std::memset(&params, 0, sizeof(params));
+
+                    m_ring_fd = sys_setup(queue_depth, &params);
+                    if (m_ring_fd < 0) {
+                        m_ring_fd = -1;
+                        return false;
+                    }
+
+                    m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+                    bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+                    single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+                    if (single_mmap && m_cq_ring_size > m_sq_ring_size) {
+                        m_sq_ring_size = m_cq_ring_size;
+                    }
+
+                    m_sq_ring = ::mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+                    if (m_sq_ring == MAP_FAILED) {
+                        return false;
+                    }
+
+                    if (single_mmap) {
+                        m_cq_ring = m_sq_ring;
+                    } else {
+                        m_cq_ring = ::mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+                        if (m_cq_ring == MAP_FAILED) {
+                            return false;
+                        }
+                    }
+
+                    m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+                    m_sqes_map = ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+                    if (m_sqes_map == MAP_FAILED) {
+                        return false;
+                    }
+                    m_sqes = static_cast<struct io_uring_sqe*>(m_sqes_map);
+
+                    char* sq = static_cast<char*>(m_sq_ring);
+                    char* cq = static_cast<char*>(m_cq_ring);
+                    m_sq_tail  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                    m_sq_mask  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                    m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                    m_cq_head  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                    m_cq_tail  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                    m_cq_mask  = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                    m_cqes     = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+                    m_buffers.reset(new (std::nothrow) char[queue_depth * m_buffer_size]);
+                    if (!m_buffers) {
+                        return false;
+                    }
+
+                    struct iovec iov[queue_depth];
+                    for (unsigned i = 0; i < queue_depth; ++i) {
+                        iov[i].iov_base = buffer(i);
+                        iov[i].iov_len = m_buffer_size;
+                    }
+                    return sys_register(m_ring_fd, IORING_REGISTER_BUFFERS, iov, queue_depth) == 0;
+                }
+
+                // Submit reads until the queue is full or we are past the
+                // point where we have seen a short read.
+                void fill_queue() {
+                    unsigned submitted = 0;
+                    while (m_in_flight < queue_depth && !m_eof) {
+                        const unsigned tail = *m_sq_tail;
+                        const unsigned index = tail & *m_sq_mask;
+                        const unsigned slot = static_cast<unsigned>(m_next_submit % queue_depth);
+
+                        struct io_uring_sqe* sqe = &m_sqes[index];
+                        std::memset(sqe, 0, sizeof(*sqe));
+                        sqe->opcode = IORING_OP_READ_FIXED;
+                        sqe->fd = m_fd;
+                        sqe->addr = reinterpret_cast<std::uint64_t>(buffer(slot));
+                        sqe->len = static_cast<std::uint32_t>(m_buffer_size);
+                        sqe->off = m_file_offset;
+                        sqe->buf_index = static_cast<std::uint16_t>(slot);
+                        sqe->user_data = m_next_submit;
+                        m_sq_array[index] = index;
+                        __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+                        m_file_offset += m_buffer_size;
+                        ++m_next_submit;
+                        ++m_in_flight;
+                        ++submitted;
+                    }
+                    if (submitted > 0) {
+                        const int result = sys_enter(m_ring_fd, submitted, 0, 0);
+                        if (result < 0) {
+                            throw std::system_error{errno, std::system_category(), "io_uring submit failed"};
+                        }
+                    }
+                }
+
+                // Move all available completions from the completion ring
+                // into m_results/m_completed.
+                void reap_completions() noexcept {
+                    unsigned head = __atomic_load_n(m_cq_head, __ATOMIC_ACQUIRE);
+                    const unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                    while (head != tail) {
+                        const struct io_uring_cqe* cqe = &m_cqes[head & *m_cq_mask];
+                        const unsigned slot = static_cast<unsigned>(cqe->user_data % queue_depth);
+                        m_results[slot] = cqe->res;
+                        m_completed[slot] = true;
+                        ++head;
+                    }
+                    __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+                }
+
+                void wait_for(const unsigned slot) {
+                    reap_completions();
+                    while (!m_completed[slot]) {
+                        const int result = sys_enter(m_ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+                        if (result < 0 && errno != EINTR) {
+                            throw std::system_error{errno, std::system_category(), "io_uring wait failed"};
+                        }
+                        reap_completions();
+                    }
+                }
+
+                // Wait for all in-flight reads, so the kernel is guaranteed
+                // not to write into our buffers any more.
+                void drain() noexcept {
+                    while (m_in_flight > 0) {
+                        const unsigned slot = static_cast<unsigned>(m_next_expected % queue_depth);
+                        reap_completions();
+                        if (!m_completed[slot]) {
+                            if (sys_enter(m_ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                                break;
+                            }
+                            continue;
+                        }
+                        m_completed[slot] = false;
+                        ++m_next_expected;
+                        --m_in_flight;
+                    }
+                }
+
+            public:
+
+                /**
+                 * Create a UringReader reading from the specified file
+                 * descriptor in chunks of buffer_size bytes. Check
+                 * is_open() before use.
+                 *
+                 * The file position of the file descriptor is not used or
+                 * changed, reads always start at offset 0.
+                 */
+                explicit UringReader(const int fd, const std::size_t buffer_size) noexcept :
+                    m_buffer_size(buffer_size),
+                    m_fd(fd) {
+                    struct stat st; // NOLINT(cppcoreguidelines-pro-type-member-init, hicpp-member-init)
+                    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+                        return;
+                    }
+                    if (!setup()) {
+                        unmap_rings();
+                        if (m_ring_fd >= 0) {
+                            ::close(m_ring_fd);
+                            m_ring_fd = -1;
+                        }
+                    }
+                }
+
+                UringReader(const UringReader&) = delete;
+                UringReader& operator=(const UringReader&) = delete;
+
+                UringReader(UringReader&&) = delete;
+                UringReader& operator=(UringReader&&) = delete;
+
+                ~UringReader() noexcept {
+                    if (m_ring_fd >= 0) {
+                        drain();
+                        unmap_rings();
+                        ::close(m_ring_fd);
+                    }
+                }
+
+                /// Is the ring set up and usable?
+                bool is_open() const noexcept {
+                    return m_ring_fd >= 0;
+                }
+
+                /**
+                 * Get the next chunk of the file. Returns an empty string
+                 * at the end of the file.
+                 *
+                 * @throws std::system_error if there was an error.
+                 */
+                std::string read() {
+                    if (m_eof && m_in_flight == 0) {
+                        return {};
+                    }
+
+                    fill_queue();
+
+                    const unsigned slot = static_cast<unsigned>(m_next_expected % queue_depth);
+                    wait_for(slot);
+
+                    const int result = m_results[slot];
+                    m_completed[slot] = false;
+                    ++m_next_expected;
+                    --m_in_flight;
+
+                    if (result < 0) {
+                        throw std::system_error{-result, std::system_category(), "Read failed"};
+                    }
+
+                    if (static_cast<std::size_t>(result) < m_buffer_size) {
+                        // Short read means end of file. Reads already in
+                        // flight beyond it will return empty and are
+                        // discarded here.
+                        m_eof = true;
+                        drain();
+                    }
+
+                    std::string data{buffer(slot), static_cast<std::size_t>(result)};
+                    if (!m_eof) {
+                        fill_queue();
+                    }
+                    return data;
+                }
+
+            }; // class UringReader
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_WITH_IO_URING
+
+#endif // OSMIUM_IO_DETAIL_URING_READER_HPP
@@ -0,0 +1,219 @@
+#ifndef OSMIUM_IO_DETAIL_VARINT_DECODER_HPP
+#define OSMIUM_IO_DETAIL_VARINT_DECODER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <protozero/types.hpp>
+#include <protozero/varint.hpp>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# define OSMIUM_VARINT_DECODER_X86
+# include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+# define OSMIUM_VARINT_DECODER_NEON
+# include <arm_neon.h>
+#endif
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /*
+             * Bulk decoding of packed, zigzag-encoded, delta-encoded
+             * varints as used for the id/lat/lon arrays in PBF DenseNodes
+             * and for way node refs.
+             *
+             * The decoder exploits the fact that in delta-encoded OSM data
+             * almost all varints are only one byte long: It scans ahead for
+             * the run of single-byte varints (bytes with the continuation
+             * bit not set) using SIMD where available and then decodes that
+             * whole run in a tight loop without any per-byte branching. The
+             * occasional longer varint in between is handled by the normal
+             * protozero decoder.
+             */
+
+            /// Get the position of the least significant set bit.
+            inline unsigned int varint_count_trailing_zeros(std::uint64_t value) noexcept {
+                assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(__builtin_ctzll(value));
+#else
+                unsigned int count = 0;
+                while ((value & 1U) == 0) {
+                    value >>= 1U;
+                    ++count;
+                }
+                return count;
+#endif
+            }
+
+            /**
+             * Count the number of consecutive single-byte varints at the
+             * start of [data, end). Because data points at a varint
+             * boundary, every byte with the continuation bit clear that we
+             * see before the first byte with the continuation bit set is a
+             * complete varint. Portable SWAR implementation, eight bytes
+             * at a time.
+             */
+            inline std::size_t count_plain_varint_run_generic(const char* data, const char* end) noexcept {
+                static constexpr std::uint64_t high_bits = 0x8080808080808080ULL;
+
+                const char* p = data;
+                while (end - p >= 8) {
+                    std::uint64_t chunk = 0;
+                    std::memcpy(&chunk, p, 8);
+                    const std::uint64_t mask = chunk & high_bits;
+                    if (mask != 0) {
+                        return static_cast<std::size_t>(p - data) +
+                               static_cast<std::size_t>(varint_count_trailing_zeros(mask) / 8U);
+                    }
+                    p += 8;
+                }
+                while (p != end && (static_cast<unsigned char>(*p) & 0x80U) == 0) {
+                    ++p;
+                }
+                return static_cast<std::size_t>(p - data);
+            }
+
+#ifdef OSMIUM_VARINT_DECODER_X86
+
+            __attribute__((target("sse2")))
+            inline std::size_t count_plain_varint_run_sse2(const char* data, const char* end) noexcept {
+                const char* p = data;
+                while (end - p >= 16) {
+                    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                    const int mask = _mm_movemask_epi8(chunk);
+                    if (mask != 0) {
+                        return static_cast<std::size_t>(p - data) +
+                               static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+                    }
+                    p += 16;
+                }
+                return static_cast<std::size_t>(p - data) + count_plain_varint_run_generic(p, end);
+            }
+
+            __attribute__((target("avx2")))
+            inline std::size_t count_plain_varint_run_avx2(const char* data, const char* end) noexcept {
+                const char* p = data;
+                while (end - p >= 32) {
+                    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                    const int mask = _mm256_movemask_epi8(chunk);
+                    if (mask != 0) {
+                        return static_cast<std::size_t>(p - data) +
+                               static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+                    }
+                    p += 32;
+                }
+                return static_cast<std::size_t>(p - data) + count_plain_varint_run_generic(p, end);
+            }
+
+            inline std::size_t count_plain_varint_run(const char* data, const char* end) noexcept {
+                using impl_type = std::size_t (*)(const char*, const char*);
+                // Runtime CPU dispatch, decided once on first use.
+                static const impl_type impl = __builtin_cpu_supports("avx2")
+                                                  ? &count_plain_varint_run_avx2
+                                                  : &count_plain_varint_run_sse2;
+                return impl(data, end);
+            }
+
+#elif defined(OSMIUM_VARINT_DECODER_NEON)
+
+            inline std::size_t count_plain_varint_run(const char* data, const char* end) noexcept {
+                const char* p = data;
+                while (end - p >= 16) {
+                    const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p));
+                    // Narrow each 16-bit lane to 4 bits so the 16 continuation
+                    // bits end up in one 64-bit scalar.
+                    const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(vshrq_n_u8(chunk, 7)), 4);
+                    const std::uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+                    if (mask != 0) {
+                        return static_cast<std::size_t>(p - data) +
+                               static_cast<std::size_t>(__builtin_ctzll(mask) / 4);
+                    }
+                    p += 16;
+                }
+                return static_cast<std::size_t>(p - data) + count_plain_varint_run_generic(p, end);
+            }
+
+#else
+
+            inline std::size_t count_plain_varint_run(const char* data, const char* end) noexcept {
+                return count_plain_varint_run_generic(data, end);
+            }
+
+#endif
+
+            /**
+             * Decode a whole packed field of zigzag-encoded delta values,
+             * appending the (delta-decoded) values to @p values.
+             *
+             * @throws protozero::end_of_buffer_exception if the data ends
+             *         in the middle of a varint.
+             */
+            inline void decode_packed_sint64_deltas(const protozero::data_view& data, std::vector<std::int64_t>& values) {
+                const char* p = data.data();
+                const char* const end = p + data.size();
+
+                std::int64_t value = 0;
+                while (p != end) {
+                    const std::size_t run = count_plain_varint_run(p, end);
+                    for (std::size_t i = 0; i < run; ++i) {
+                        const auto b = static_cast<std::uint8_t>(p[i]);
+                        value += static_cast<std::int64_t>(b >> 1U) ^ -static_cast<std::int64_t>(b & 1U);
+                        values.push_back(value);
+                    }
+                    p += run;
+                    if (p != end) {
+                        value += protozero::decode_zigzag64(protozero::decode_varint(&p, end));
+                        values.push_back(value);
+                    }
+                }
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#undef OSMIUM_VARINT_DECODER_X86
+#undef OSMIUM_VARINT_DECODER_NEON
+
+#endif // OSMIUM_IO_DETAIL_VARINT_DECODER_HPP
@@ -0,0 +1,139 @@
+#ifndef OSMIUM_IO_DETAIL_VARINT_ENCODER_HPP
+#define OSMIUM_IO_DETAIL_VARINT_ENCODER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <protozero/pbf_builder.hpp>
+#include <protozero/varint.hpp>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /*
+             * Bulk encoding of packed, zigzag-encoded varints as used for
+             * the delta-encoded arrays in PBF DenseNodes.
+             *
+             * The generic protozero packed writer makes two passes over
+             * the values, computing each varint length again while
+             * writing, and grows the output as it goes. Here we exploit
+             * that deltas over id-sorted input are small: one pass
+             * computes the exact byte width of every value in the block,
+             * the output is sized once to the exact total, and a second
+             * pass stores the bytes directly, with a branch-free store
+             * for the dominant single-byte case.
+             */
+
+            /// Get the number of significant bits in @p value.
+            inline unsigned int varint_significant_bits(std::uint64_t value) noexcept {
+                assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(64 - __builtin_clzll(value));
+#else
+                unsigned int bits = 0;
+                while (value != 0) {
+                    value >>= 1U;
+                    ++bits;
+                }
+                return bits;
+#endif
+            }
+
+            /// The number of bytes the varint encoding of @p value needs.
+            inline std::size_t varint_length(const std::uint64_t value) noexcept {
+                const unsigned int bits = varint_significant_bits(value | 1U);
+                return (bits + 6U) / 7U;
+            }
+
+            inline std::uint64_t zigzag(const std::int32_t value) noexcept {
+                return protozero::encode_zigzag32(value);
+            }
+
+            inline std::uint64_t zigzag(const std::int64_t value) noexcept {
+                return protozero::encode_zigzag64(value);
+            }
+
+            /**
+             * Encode all values as a concatenation of zigzag-encoded
+             * varints, the payload of a packed sint32/sint64 field.
+             */
+            template <typename T>
+            std::string encode_packed_svarint(const std::vector<T>& values) {
+                std::size_t length = 0;
+                for (const T value : values) {
+                    length += varint_length(zigzag(value));
+                }
+
+                std::string data(length, '\0');
+                char* out = &data[0];
+                for (const T value : values) {
+                    std::uint64_t v = zigzag(value);
+                    while (v >= 0x80U) {
+                        *out++ = static_cast<char>(v | 0x80U);
+                        v >>= 7U;
+                    }
+                    *out++ = static_cast<char>(v);
+                }
+
+                return data;
+            }
+
+            /**
+             * Add a packed sint32/sint64 field with the given values to
+             * the PBF message being built. Same bytes as the protozero
+             * add_packed_sint32/64 functions (a packed field is encoded
+             * exactly like a bytes field), but encoded in bulk.
+             */
+            template <typename TEnum, typename T>
+            void add_packed_svarint(protozero::pbf_builder<TEnum>& pbf, const TEnum tag, const std::vector<T>& values) {
+                if (values.empty()) {
+                    return;
+                }
+                pbf.add_bytes(tag, encode_packed_svarint(values));
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_VARINT_ENCODER_HPP
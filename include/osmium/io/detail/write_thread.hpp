@@ -35,7 +35,10 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/detail/string_pool.hpp>
+#include <osmium/io/stats.hpp>
 #include <osmium/thread/util.hpp>
+#include <osmium/util/probes.hpp>
 
 #include <exception>
 #include <future>
@@ -56,21 +59,54 @@ namespace osmium {
              */
             class WriteThread {
 
+                /// Collect small chunks up to this size before writing.
+                enum : std::size_t {
+                    max_batch_size = 1024UL * 1024UL
+                };
+
                 queue_wrapper<std::string> m_queue;
                 std::unique_ptr<osmium::io::Compressor> m_compressor;
                 std::promise<std::size_t> m_promise;
                 std::atomic_bool* m_notification;
+                IOStatsCollector* m_stats;
+
+                /**
+                 * Small chunks are collected here and written together,
+                 * so that many small blocks (as the PBF writer produces
+                 * them) don't turn into one write syscall each.
+                 */
+                std::string m_batch{};
+
+                void write(const std::string& data) {
+                    OSMIUM_PROBE1(write, data.size());
+                    if (m_stats) {
+                        const auto start = IOStatsCollector::clock::now();
+                        m_compressor->write(data);
+                        m_stats->add_io(IOStatsCollector::elapsed_ns(start), data.size());
+                    } else {
+                        m_compressor->write(data);
+                    }
+                }
+
+                void flush_batch() {
+                    if (!m_batch.empty()) {
+                        write(m_batch);
+                        m_batch.clear();
+                    }
+                }
 
             public:
 
                 WriteThread(future_string_queue_type& input_queue,
                             std::unique_ptr<osmium::io::Compressor>&& compressor,
                             std::promise<std::size_t>&& promise,
-                            std::atomic_bool* notification) :
+                            std::atomic_bool* notification,
+                            IOStatsCollector* stats = nullptr) :
                     m_queue(input_queue),
                     m_compressor(std::move(compressor)),
                     m_promise(std::move(promise)),
-                    m_notification(notification) {
+                    m_notification(notification),
+                    m_stats(stats) {
                 }
 
                 WriteThread(const WriteThread&) = delete;
@@ -86,12 +122,32 @@ namespace osmium {
 
                     try {
                         while (true) {
-                            const std::string data{m_queue.pop()};
+                            if (!m_batch.empty() && m_queue.empty()) {
+                                // No more data imminent, don't sit on
+                                // what we have while blocking on the
+                                // queue.
+                                flush_batch();
+                            }
+                            std::string data{m_queue.pop()};
                             if (at_end_of_data(data)) {
                                 break;
                             }
-                            m_compressor->write(data);
+                            if (data.size() >= max_batch_size) {
+                                // Copying a large chunk into the batch
+                                // would gain nothing, write it directly.
+                                flush_batch();
+                                write(data);
+                            } else {
+                                m_batch += data;
+                                if (m_batch.size() >= max_batch_size) {
+                                    flush_batch();
+                                }
+                            }
+                            // Hand the string back for reuse as a
+                            // serialization buffer.
+                            StringPool::instance().put(std::move(data));
                         }
+                        flush_batch();
                         m_compressor->close();
                         m_promise.set_value(m_compressor->file_size());
                     } catch (...) {
@@ -54,18 +54,24 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/types_from_string.hpp>
 #include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
+#include <osmium/util/config.hpp>
 
 #include <expat.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
+#include <deque>
 #include <exception>
 #include <future>
 #include <limits>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -125,6 +131,175 @@ namespace osmium {
 
         namespace detail {
 
+            /**
+             * Splits a stream of OSM XML data into chunks that can be
+             * parsed independently of each other. Chunk boundaries are
+             * always directly before the start tag of a node, way,
+             * relation, or changeset element. The scanner knows about XML
+             * comments and CDATA sections, so a start tag appearing inside
+             * them is never used as a boundary. (Inside attribute values
+             * and character data the '<' has to be escaped, those need no
+             * special handling.)
+             */
+            class XMLChunkSplitter {
+
+            public:
+
+                enum : std::size_t {
+                    no_cut = static_cast<std::size_t>(-1)
+                };
+
+            private:
+
+                // When scanning data that is not the end of the input, the
+                // last few bytes are left unscanned, because they could be
+                // the start of a construct ("<![CDATA[", "<changeset ")
+                // continuing in the next piece of data.
+                enum : std::size_t {
+                    scan_margin = 16
+                };
+
+                std::string m_data{};
+                std::vector<std::size_t> m_boundaries{};
+                std::size_t m_scan_pos = 0;
+
+                enum class state {
+                    normal,
+                    comment,
+                    cdata
+                } m_state = state::normal;
+
+                static bool is_name_end(const char c) noexcept {
+                    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '/' || c == '>';
+                }
+
+                // Does pos point to the '<' of a node, way, relation, or
+                // changeset start tag?
+                bool is_boundary(const std::size_t pos) const noexcept {
+                    static const char* const names[] = {"node", "way", "relation", "changeset"};
+                    for (const char* name : names) {
+                        const std::size_t len = std::strlen(name);
+                        if (m_data.compare(pos + 1, len, name) == 0 &&
+                            pos + 1 + len < m_data.size() &&
+                            is_name_end(m_data[pos + 1 + len])) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+            public:
+
+                void append(const std::string& data) {
+                    m_data += data;
+                }
+
+                /**
+                 * Scan data appended since the last call for chunk
+                 * boundaries. Set done to true when no more data will be
+                 * appended.
+                 */
+                void scan(const bool done) {
+                    const std::size_t size = m_data.size();
+                    std::size_t pos = m_scan_pos;
+
+                    while (true) {
+                        if (m_state == state::comment) {
+                            const auto end = m_data.find("-->", pos);
+                            if (end == std::string::npos) {
+                                m_scan_pos = size >= 2 ? size - 2 : 0;
+                                return;
+                            }
+                            pos = end + 3;
+                            m_state = state::normal;
+                            continue;
+                        }
+                        if (m_state == state::cdata) {
+                            const auto end = m_data.find("]]>", pos);
+                            if (end == std::string::npos) {
+                                m_scan_pos = size >= 2 ? size - 2 : 0;
+                                return;
+                            }
+                            pos = end + 3;
+                            m_state = state::normal;
+                            continue;
+                        }
+                        const auto bracket = m_data.find('<', pos);
+                        if (bracket == std::string::npos) {
+                            m_scan_pos = size;
+                            return;
+                        }
+                        if (!done && bracket + scan_margin > size) {
+                            m_scan_pos = bracket;
+                            return;
+                        }
+                        if (m_data.compare(bracket + 1, 3, "!--") == 0) {
+                            m_state = state::comment;
+                            pos = bracket + 4;
+                            continue;
+                        }
+                        if (m_data.compare(bracket + 1, 8, "![CDATA[") == 0) {
+                            m_state = state::cdata;
+                            pos = bracket + 9;
+                            continue;
+                        }
+                        if (is_boundary(bracket)) {
+                            m_boundaries.push_back(bracket);
+                        }
+                        pos = bracket + 1;
+                    }
+                }
+
+                bool has_boundary() const noexcept {
+                    return !m_boundaries.empty();
+                }
+
+                std::size_t first_boundary() const noexcept {
+                    assert(has_boundary());
+                    return m_boundaries.front();
+                }
+
+                /**
+                 * Position of the first boundary at least min_size bytes
+                 * into the data, or no_cut if there is none.
+                 */
+                std::size_t cut_point(const std::size_t min_size) const noexcept {
+                    const auto it = std::lower_bound(m_boundaries.begin(), m_boundaries.end(), min_size);
+                    return it == m_boundaries.end() ? static_cast<std::size_t>(no_cut) : *it;
+                }
+
+                bool empty() const noexcept {
+                    return m_data.empty();
+                }
+
+                /**
+                 * Remove and return the data before the specified position,
+                 * which must be a boundary (or the scan position).
+                 */
+                std::string extract(const std::size_t pos) {
+                    std::string chunk{m_data, 0, pos};
+                    m_data.erase(0, pos);
+                    assert(m_scan_pos >= pos);
+                    m_scan_pos -= pos;
+
+                    const auto it = std::lower_bound(m_boundaries.begin(), m_boundaries.end(), pos);
+                    m_boundaries.erase(m_boundaries.begin(), it);
+                    for (auto& boundary : m_boundaries) {
+                        boundary -= pos;
+                    }
+
+                    return chunk;
+                }
+
+                /// Remove and return all remaining data.
+                std::string take_all() {
+                    m_boundaries.clear();
+                    m_scan_pos = 0;
+                    return std::move(m_data);
+                }
+
+            }; // class XMLChunkSplitter
+
             class XMLParser final : public ParserWithBuffer {
 
                 enum class context {
@@ -239,10 +414,21 @@ namespace osmium {
                         }
                         XML_SetUserData(m_parser, callback_object);
                         XML_SetElementHandler(m_parser, start_element_wrapper, end_element_wrapper);
-                        XML_SetCharacterDataHandler(m_parser, character_data_wrapper);
                         XML_SetEntityDeclHandler(m_parser, entity_declaration_handler);
                     }
 
+                    /**
+                     * Enable or disable the character data callback. It is
+                     * only needed inside changeset discussion <text>
+                     * elements, everywhere else character data is ignored
+                     * and with the handler unset Expat doesn't have to
+                     * call back into us for the whitespace between
+                     * elements at all.
+                     */
+                    void enable_character_data_handler(const bool enable) noexcept {
+                        XML_SetCharacterDataHandler(m_parser, enable ? character_data_wrapper : nullptr);
+                    }
+
                     ExpatXMLParser(const ExpatXMLParser&) = delete;
                     ExpatXMLParser& operator=(const ExpatXMLParser&) = delete;
 
@@ -267,6 +453,11 @@ namespace osmium {
 
                 ExpatXMLParser* m_expat_xml_parser{nullptr};
 
+                // Set to false for the parser instances used for parsing
+                // single chunks on the thread pool, they must not try to
+                // split their input again.
+                bool m_enable_parallel = true;
+
                 template <typename T>
                 static void check_attributes(const XML_Char** attrs, T&& check) {
                     while (*attrs) {
@@ -284,15 +475,50 @@ namespace osmium {
                     osmium::Location location;
                     const char* user = "";
 
+                    // Dispatch on the first character of the attribute name
+                    // and only compare the full name inside the matching
+                    // case, instead of running the whole strcmp() chain for
+                    // every attribute.
                     check_attributes(attrs, [&location, &user, &object](const XML_Char* name, const XML_Char* value) {
-                        if (!std::strcmp(name, "lon")) {
-                            location.set_lon(value);
-                        } else if (!std::strcmp(name, "lat")) {
-                            location.set_lat(value);
-                        } else if (!std::strcmp(name, "user")) {
-                            user = value;
-                        } else {
-                            object.set_attribute(name, value);
+                        switch (name[0]) {
+                            case 'c':
+                                if (!std::strcmp(name, "changeset")) {
+                                    object.set_changeset(value);
+                                }
+                                break;
+                            case 'i':
+                                if (!std::strcmp(name, "id")) {
+                                    object.set_id(value);
+                                }
+                                break;
+                            case 'l':
+                                if (!std::strcmp(name, "lon")) {
+                                    location.set_lon(value);
+                                } else if (!std::strcmp(name, "lat")) {
+                                    location.set_lat(value);
+                                }
+                                break;
+                            case 't':
+                                if (!std::strcmp(name, "timestamp")) {
+                                    object.set_timestamp(value);
+                                }
+                                break;
+                            case 'u':
+                                if (!std::strcmp(name, "user")) {
+                                    user = value;
+                                } else if (!std::strcmp(name, "uid")) {
+                                    object.set_uid(value);
+                                }
+                                break;
+                            case 'v':
+                                if (!std::strcmp(name, "version")) {
+                                    object.set_version(value);
+                                } else if (!std::strcmp(name, "visible")) {
+                                    object.set_visible(value);
+                                }
+                                break;
+                            default: // ignore unknown attributes
+                                break;
                         }
                     });
 
@@ -306,19 +532,48 @@ namespace osmium {
                 static void init_changeset(osmium::builder::ChangesetBuilder& builder, const XML_Char** attrs) {
                     osmium::Box box;
 
+                    // First-character dispatch, see init_object().
                     check_attributes(attrs, [&builder, &box](const XML_Char* name, const XML_Char* value) {
-                        if (!std::strcmp(name, "min_lon")) {
-                            box.bottom_left().set_lon(value);
-                        } else if (!std::strcmp(name, "min_lat")) {
-                            box.bottom_left().set_lat(value);
-                        } else if (!std::strcmp(name, "max_lon")) {
-                            box.top_right().set_lon(value);
-                        } else if (!std::strcmp(name, "max_lat")) {
-                            box.top_right().set_lat(value);
-                        } else if (!std::strcmp(name, "user")) {
-                            builder.set_user(value);
-                        } else {
-                            builder.set_attribute(name, value);
+                        switch (name[0]) {
+                            case 'c':
+                                if (!std::strcmp(name, "created_at")) {
+                                    builder.set_created_at(osmium::Timestamp{value});
+                                } else if (!std::strcmp(name, "closed_at")) {
+                                    builder.set_closed_at(osmium::Timestamp{value});
+                                } else if (!std::strcmp(name, "comments_count")) {
+                                    builder.set_num_comments(value);
+                                }
+                                break;
+                            case 'i':
+                                if (!std::strcmp(name, "id")) {
+                                    builder.set_id(value);
+                                }
+                                break;
+                            case 'm':
+                                if (!std::strcmp(name, "min_lon")) {
+                                    box.bottom_left().set_lon(value);
+                                } else if (!std::strcmp(name, "min_lat")) {
+                                    box.bottom_left().set_lat(value);
+                                } else if (!std::strcmp(name, "max_lon")) {
+                                    box.top_right().set_lon(value);
+                                } else if (!std::strcmp(name, "max_lat")) {
+                                    box.top_right().set_lat(value);
+                                }
+                                break;
+                            case 'n':
+                                if (!std::strcmp(name, "num_changes")) {
+                                    builder.set_num_changes(value);
+                                }
+                                break;
+                            case 'u':
+                                if (!std::strcmp(name, "user")) {
+                                    builder.set_user(value);
+                                } else if (!std::strcmp(name, "uid")) {
+                                    builder.set_uid(value);
+                                }
+                                break;
+                            default: // ignore unknown attributes
+                                break;
                         }
                     });
 
@@ -512,13 +767,23 @@ namespace osmium {
                                     }
 
                                     NodeRef nr;
+                                    // First-character dispatch, see init_object().
                                     check_attributes(attrs, [&nr](const XML_Char* name, const XML_Char* value) {
-                                        if (!std::strcmp(name, "ref")) {
-                                            nr.set_ref(osmium::string_to_object_id(value));
-                                        } else if (!std::strcmp(name, "lon")) {
-                                            nr.location().set_lon(value);
-                                        } else if (!std::strcmp(name, "lat")) {
-                                            nr.location().set_lat(value);
+                                        switch (name[0]) {
+                                            case 'r':
+                                                if (!std::strcmp(name, "ref")) {
+                                                    nr.set_ref(osmium::string_to_object_id(value));
+                                                }
+                                                break;
+                                            case 'l':
+                                                if (!std::strcmp(name, "lon")) {
+                                                    nr.location().set_lon(value);
+                                                } else if (!std::strcmp(name, "lat")) {
+                                                    nr.location().set_lat(value);
+                                                }
+                                                break;
+                                            default:
+                                                break;
                                         }
                                     });
                                     m_wnl_builder->add_node_ref(nr);
@@ -549,14 +814,24 @@ namespace osmium {
                                     object_id_type ref = 0;
                                     bool ref_is_set = false;
                                     const char* role = "";
+                                    // First-character dispatch, see init_object().
                                     check_attributes(attrs, [&type, &ref, &ref_is_set, &role](const XML_Char* name, const XML_Char* value) {
-                                        if (!std::strcmp(name, "type")) {
-                                            type = char_to_item_type(value[0]);
-                                        } else if (!std::strcmp(name, "ref")) {
-                                            ref = osmium::string_to_object_id(value);
-                                            ref_is_set = true;
-                                        } else if (!std::strcmp(name, "role")) {
-                                            role = static_cast<const char*>(value);
+                                        switch (name[0]) {
+                                            case 't':
+                                                if (!std::strcmp(name, "type")) {
+                                                    type = char_to_item_type(value[0]);
+                                                }
+                                                break;
+                                            case 'r':
+                                                if (!std::strcmp(name, "ref")) {
+                                                    ref = osmium::string_to_object_id(value);
+                                                    ref_is_set = true;
+                                                } else if (!std::strcmp(name, "role")) {
+                                                    role = static_cast<const char*>(value);
+                                                }
+                                                break;
+                                            default:
+                                                break;
                                         }
                                     });
                                     if (type != item_type::node && type != item_type::way && type != item_type::relation) {
@@ -588,7 +863,8 @@ namespace osmium {
                         case context::changeset:
                             if (!std::strcmp(element, "discussion")) {
                                 m_context_stack.push_back(context::discussion);
-                                if (read_types() & osmium::osm_entity_bits::changeset) {
+                                if ((read_types() & osmium::osm_entity_bits::changeset) &&
+                                    read_discussions() == osmium::io::read_discussions::yes) {
                                     m_tl_builder.reset();
                                     if (!m_changeset_discussion_builder) {
                                         m_changeset_discussion_builder.reset(new osmium::builder::ChangesetDiscussionBuilder{*m_changeset_builder});
@@ -607,7 +883,7 @@ namespace osmium {
                         case context::discussion:
                             if (!std::strcmp(element, "comment")) {
                                 m_context_stack.push_back(context::comment);
-                                if (read_types() & osmium::osm_entity_bits::changeset) {
+                                if (m_changeset_discussion_builder) {
                                     osmium::Timestamp date;
                                     osmium::user_id_type uid = 0;
                                     const char* user = "";
@@ -629,6 +905,10 @@ namespace osmium {
                         case context::comment:
                             if (!std::strcmp(element, "text")) {
                                 m_context_stack.push_back(context::text);
+                                if (m_changeset_discussion_builder) {
+                                    assert(m_expat_xml_parser);
+                                    m_expat_xml_parser->enable_character_data_handler(true);
+                                }
                             } else {
                                 throw xml_error{std::string{"Unknown element in <comment>: "} + element};
                             }
@@ -721,7 +1001,9 @@ namespace osmium {
                             break;
                         case context::text:
                             assert(!std::strcmp(element, "text"));
-                            if (read_types() & osmium::osm_entity_bits::changeset) {
+                            if (m_changeset_discussion_builder) {
+                                assert(m_expat_xml_parser);
+                                m_expat_xml_parser->enable_character_data_handler(false);
                                 m_changeset_discussion_builder->add_comment_text(m_comment_text);
                                 m_comment_text.clear();
                             }
@@ -739,7 +1021,7 @@ namespace osmium {
                 }
 
                 void characters(const XML_Char* text, int len) {
-                    if ((read_types() & osmium::osm_entity_bits::changeset) &&
+                    if (m_changeset_discussion_builder &&
                         !m_context_stack.empty() &&
                         m_context_stack.back() == context::text) {
                         m_comment_text.append(text, len);
@@ -766,6 +1048,21 @@ namespace osmium {
                     ExpatXMLParser parser{this};
                     m_expat_xml_parser = &parser;
 
+                    if (m_enable_parallel &&
+                        get_pool().num_threads() > 1 &&
+                        osmium::config::use_parallel_xml_parsing()) {
+                        run_parallel(parser);
+                    } else {
+                        run_sequential(parser);
+                    }
+
+                    mark_header_as_done();
+                    flush_final_buffer();
+                }
+
+            private:
+
+                void run_sequential(ExpatXMLParser& parser) {
                     while (!input_done()) {
                         const std::string data{get_input()};
                         parser(data, input_done());
@@ -773,9 +1070,159 @@ namespace osmium {
                             break;
                         }
                     }
+                }
+
+                /**
+                 * Parse a single chunk of XML data cut out of the input by
+                 * the XMLChunkSplitter. The chunk is wrapped in a minimal
+                 * osm element and parsed by a nested XMLParser with its own
+                 * queues, the resulting buffers are returned in order.
+                 *
+                 * Runs on a thread of the thread pool.
+                 */
+                static std::vector<osmium::memory::Buffer> parse_chunk(osmium::thread::Pool& pool,
+                                                                       std::string&& chunk,
+                                                                       const bool is_last,
+                                                                       const osmium::osm_entity_bits::type read_which_entities,
+                                                                       const osmium::io::read_meta read_metadata,
+                                                                       const osmium::io::read_discussions read_discussions,
+                                                                       const osmium::io::buffers_type buffers_kind) {
+                    std::string doc{"<?xml version='1.0' encoding='UTF-8'?><osm version=\"0.6\">"};
+                    doc += chunk;
+                    if (!is_last) {
+                        // The last chunk contains the real closing tag.
+                        doc += "</osm>";
+                    }
+
+                    future_string_queue_type input_queue{2, "xml_chunk_in"};
+                    future_buffer_queue_type output_queue{0, "xml_chunk_out"};
+                    std::promise<osmium::io::Header> header_promise;
+
+                    parser_arguments args{pool, -1, input_queue, output_queue,
+                                          header_promise, nullptr,
+                                          read_which_entities, read_metadata,
+                                          osmium::io::read_tags::yes,
+                                          read_discussions,
+                                          osmium::io::way_envelopes::no,
+                                          osmium::io::clean_way_nodes::no,
+                                          nullptr,
+                                          osmium::io::skip_damaged_blobs::no,
+                                          nullptr,
+                                          osmium::Box{},
+                                          buffers_kind, 0, false,
+                                          osmium::io::mapped_input::no, nullptr, nullptr};
+
+                    XMLParser parser{args};
+                    parser.m_enable_parallel = false;
+
+                    add_to_queue(input_queue, std::move(doc));
+                    add_end_of_data_to_queue(input_queue);
+                    parser.parse();
+
+                    std::vector<osmium::memory::Buffer> buffers;
+                    queue_wrapper<osmium::memory::Buffer> queue{output_queue};
+                    while (!queue.has_reached_end_of_data()) {
+                        osmium::memory::Buffer buffer{queue.pop()};
+                        if (buffer) {
+                            buffers.push_back(std::move(buffer));
+                        }
+                    }
+
+                    return buffers;
+                }
+
+                using chunk_result_queue = std::deque<std::future<std::vector<osmium::memory::Buffer>>>;
+
+                void submit_chunk(chunk_result_queue& results, std::string&& chunk, const bool is_last) {
+                    auto& pool = get_pool();
+                    const auto chunk_ptr = std::make_shared<std::string>(std::move(chunk));
+                    const auto read_which_entities = read_types();
+                    const auto read_meta = read_metadata();
+                    const auto read_disc = read_discussions();
+                    const auto kind = buffers_kind();
+                    results.push_back(pool.submit([&pool, chunk_ptr, is_last, read_which_entities, read_meta, read_disc, kind]() {
+                        return parse_chunk(pool, std::move(*chunk_ptr), is_last, read_which_entities, read_meta, read_disc, kind);
+                    }));
+                }
+
+                void deliver_chunk_result(chunk_result_queue& results) {
+                    auto buffers = results.front().get();
+                    results.pop_front();
+                    for (auto& buffer : buffers) {
+                        send_to_output_queue(std::move(buffer));
+                    }
+                }
+
+                /**
+                 * Split the input at object boundaries and parse the chunks
+                 * in parallel on the thread pool, sending the buffers
+                 * downstream in input order.
+                 *
+                 * The data before the first boundary (XML declaration and
+                 * the opening osm element) is parsed here, so the header
+                 * ends up in this parser. Files that turn out not to have
+                 * a plain osm root element (osmChange files, where change
+                 * sections make splitting unsafe) fall back to sequential
+                 * parsing.
+                 */
+                void run_parallel(ExpatXMLParser& parser) {
+                    enum : std::size_t {
+                        min_chunk_size = 1024UL * 1024UL
+                    };
+
+                    XMLChunkSplitter splitter;
+
+                    while (true) {
+                        splitter.scan(input_done());
+                        if (splitter.has_boundary()) {
+                            break;
+                        }
+                        if (input_done()) {
+                            // No objects in the input at all.
+                            parser(splitter.take_all(), true);
+                            return;
+                        }
+                        splitter.append(get_input());
+                    }
+
+                    parser(splitter.extract(splitter.first_boundary()), false);
+
+                    if (m_context_stack.size() != 1 || m_context_stack.back() != context::osm) {
+                        parser(splitter.take_all(), input_done());
+                        run_sequential(parser);
+                        return;
+                    }
 
                     mark_header_as_done();
-                    flush_final_buffer();
+                    if (read_types() == osmium::osm_entity_bits::nothing) {
+                        return;
+                    }
+
+                    chunk_result_queue results;
+                    const auto max_outstanding = static_cast<std::size_t>(get_pool().num_threads()) * 2;
+
+                    while (true) {
+                        splitter.scan(input_done());
+                        for (auto pos = splitter.cut_point(min_chunk_size);
+                             pos != XMLChunkSplitter::no_cut;
+                             pos = splitter.cut_point(min_chunk_size)) {
+                            submit_chunk(results, splitter.extract(pos), false);
+                            while (results.size() >= max_outstanding) {
+                                deliver_chunk_result(results);
+                            }
+                        }
+                        if (input_done()) {
+                            break;
+                        }
+                        splitter.append(get_input());
+                    }
+
+                    if (!splitter.empty()) {
+                        submit_chunk(results, splitter.take_all(), true);
+                    }
+                    while (!results.empty()) {
+                        deliver_chunk_result(results);
+                    }
                 }
 
             }; // class XMLParser
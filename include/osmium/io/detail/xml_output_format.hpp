@@ -152,7 +152,8 @@ namespace osmium {
 
                     if (m_options.add_metadata.timestamp() && object.timestamp()) {
                         *m_out += " timestamp=\"";
-                        *m_out += object.timestamp().to_iso_all();
+                        char buffer[osmium::Timestamp::max_length];
+                        m_out->append(buffer, object.timestamp().to_iso_all(buffer));
                         *m_out += "\"";
                     }
 
@@ -198,7 +199,8 @@ namespace osmium {
                         *m_out += " user=\"";
                         append_xml_encoded_string(*m_out, comment.user());
                         *m_out += "\" date=\"";
-                        *m_out += comment.date().to_iso_all();
+                        char buffer[osmium::Timestamp::max_length];
+                        m_out->append(buffer, comment.date().to_iso_all(buffer));
                         *m_out += "\">\n";
                         *m_out += "    <text>";
                         append_xml_encoded_string(*m_out, comment.text());
@@ -245,13 +247,13 @@ namespace osmium {
 
             public:
 
-                XMLOutputBlock(osmium::memory::Buffer&& buffer, const xml_output_options& options) :
-                    OutputBlock(std::move(buffer)),
+                XMLOutputBlock(osmium::memory::Buffer&& buffer, const xml_output_options& options, osmium::memory::BufferPool* buffer_pool = nullptr, std::shared_ptr<const output_filter_type> filter = {}) :
+                    OutputBlock(std::move(buffer), buffer_pool, std::move(filter)),
                     m_options(options) {
                 }
 
                 std::string operator()() {
-                    osmium::apply(m_input_buffer->cbegin(), m_input_buffer->cend(), *this);
+                    apply_input(*this);
 
                     if (m_options.use_change_ops) {
                         open_close_op_tag();
@@ -372,13 +374,15 @@ namespace osmium {
 
                     if (changeset.created_at()) {
                         *m_out += " created_at=\"";
-                        *m_out += changeset.created_at().to_iso();
+                        char buffer[osmium::Timestamp::max_length];
+                        m_out->append(buffer, changeset.created_at().to_iso(buffer));
                         *m_out += "\"";
                     }
 
                     if (changeset.closed_at()) {
                         *m_out += " closed_at=\"";
-                        *m_out += changeset.closed_at().to_iso();
+                        char buffer[osmium::Timestamp::max_length];
+                        m_out->append(buffer, changeset.closed_at().to_iso(buffer));
                         *m_out += "\" open=\"false\"";
                     } else {
                         *m_out += " open=\"true\"";
@@ -428,10 +432,11 @@ namespace osmium {
 
                 XMLOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
                     OutputFormat(pool, output_queue) {
-                    m_options.add_metadata      = osmium::metadata_options{file.get("add_metadata")};
+                    const auto generic_options = resolve_generic_output_options(file);
+                    m_options.add_metadata      = generic_options.add_metadata;
+                    m_options.locations_on_ways = generic_options.locations_on_ways;
                     m_options.use_change_ops    = file.is_true("xml_change_format");
                     m_options.add_visible_flag  = (file.has_multiple_object_versions() || file.is_true("force_visible_flag")) && !m_options.use_change_ops;
-                    m_options.locations_on_ways = file.is_true("locations_on_ways");
                 }
 
                 void write_header(const osmium::io::Header& header) final {
@@ -464,7 +469,7 @@ namespace osmium {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    m_output_queue.push(m_pool.submit(XMLOutputBlock{std::move(buffer), m_options}));
+                    m_output_queue.push(m_pool.submit(XMLOutputBlock{std::move(buffer), m_options, m_buffer_pool, m_filter}));
                 }
 
                 void write_end() final {
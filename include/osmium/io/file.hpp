@@ -191,6 +191,9 @@ namespace osmium {
                 } else if (suffixes.back() == "bz2") {
                     m_file_compression = file_compression::bzip2;
                     suffixes.pop_back();
+                } else if (suffixes.back() == "zst") {
+                    m_file_compression = file_compression::zstd;
+                    suffixes.pop_back();
                 }
 
                 if (suffixes.empty()) {
@@ -228,6 +231,13 @@ namespace osmium {
                 } else if (suffixes.back() == "ids") {
                     m_file_format = file_format::ids;
                     suffixes.pop_back();
+                } else if (suffixes.back() == "shm") {
+                    m_file_format = file_format::shm;
+                    suffixes.pop_back();
+                } else if (suffixes.back() == "blob") {
+                    // alias for the raw buffer dump format
+                    m_file_format = file_format::shm;
+                    suffixes.pop_back();
                 }
 
                 if (suffixes.empty()) {
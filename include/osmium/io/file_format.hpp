@@ -33,7 +33,12 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/osm/box.hpp>
+
+#include <cstddef>
+#include <functional>
 #include <iosfwd>
+#include <utility>
 
 namespace osmium {
 
@@ -49,7 +54,8 @@ namespace osmium {
             debug     = 6,
             blackhole = 7,
             ids       = 8,
-            last      = 8 // must have the same value as the last real value
+            shm       = 9,
+            last      = 9 // must have the same value as the last real value
         };
 
         enum class read_meta {
@@ -57,11 +63,233 @@ namespace osmium {
             yes = 1
         };
 
+        enum class read_tags {
+            no  = 0,
+            yes = 1
+        };
+
+        /**
+         * Tell the Reader to store the envelope of every way in the way
+         * itself while it is decoded (see osmium::WayEnvelope). This
+         * only works for PBF files that have node locations on the
+         * ways (the "locations_on_ways" writer option); for all other
+         * input the option is ignored. Way::envelope() uses the stored
+         * envelope automatically, so later passes don't have to look
+         * at all the node locations again.
+         */
+        enum class way_envelopes {
+            no  = 0,
+            yes = 1
+        };
+
+        /**
+         * Tell the Reader to drop consecutive duplicate nodes from way
+         * node lists while they are decoded: node refs with the same id
+         * as the one before them, or with the same (valid) location, are
+         * skipped. Bad imports produce such zero-length segments, which
+         * otherwise make the geometry factories throw or waste cycles.
+         * Only implemented for the PBF format; for all other input the
+         * option is ignored. The number of nodes dropped is reported
+         * in Reader::stats().
+         */
+        enum class clean_way_nodes {
+            no  = 0,
+            yes = 1
+        };
+
+        /**
+         * Tell the Reader to skip over damaged data blobs instead of
+         * throwing: a blob that fails to decompress or decode is counted
+         * and dropped, a broken or truncated blob header ends the file
+         * early as if it were the end of the data. Use this in always-on
+         * services where one bad blob must not abort a long run; the
+         * number of blobs skipped is reported in Reader::stats(), so
+         * damage doesn't go unnoticed. Only implemented for the PBF
+         * format; for all other input the option is ignored.
+         */
+        enum class skip_damaged_blobs {
+            no  = 0,
+            yes = 1
+        };
+
+        /**
+         * Tell the Reader to skip the discussions (comments) on changesets.
+         * Changesets will have empty discussions then. Only the XML format
+         * has discussions.
+         */
+        enum class read_discussions {
+            no  = 0,
+            yes = 1
+        };
+
         enum class buffers_type {
             any    = 0,
             single = 1
         };
 
+        enum class mapped_input {
+            no  = 0,
+            yes = 1
+        };
+
+        /**
+         * Tell the Reader to adapt the depth of the queue with the decoded
+         * data to the observed behaviour of the consumer: if read() often
+         * has to wait, the queue is grown so the decoder can run further
+         * ahead, if the queue is full and read() never waits, it is shrunk
+         * to put backpressure on the decoder earlier and save memory.
+         */
+        enum class adaptive_queues {
+            no  = 0,
+            yes = 1
+        };
+
+        /**
+         * Tell the Reader not to start any threads of its own. The whole
+         * file is then read and decoded inline in the thread that first
+         * calls header() or read(), later read() calls only hand out the
+         * already decoded buffers. This removes the per-file thread
+         * startup cost, which dominates when many small files are opened,
+         * but it needs memory for the complete decoded file, so only use
+         * it for small files. Decoding work for PBF files is still handed
+         * to the (long-lived, shared) thread pool.
+         */
+        enum class synchronous {
+            no  = 0,
+            yes = 1
+        };
+
+        /**
+         * Maximum number of blobs of raw input data in flight between the
+         * read thread and the decoder. Overrides the environment variable
+         * OSMIUM_MAX_INPUT_QUEUE_SIZE.
+         */
+        struct input_queue_size {
+
+            std::size_t size;
+
+            explicit input_queue_size(std::size_t value) noexcept :
+                size(value) {
+            }
+
+        };
+
+        /**
+         * Maximum number of buffers with decoded OSM data in flight between
+         * the decoder and the thread calling Reader::read(). Overrides the
+         * environment variable OSMIUM_MAX_OSMDATA_QUEUE_SIZE.
+         */
+        struct osmdata_queue_size {
+
+            std::size_t size;
+
+            explicit osmdata_queue_size(std::size_t value) noexcept :
+                size(value) {
+            }
+
+        };
+
+        /**
+         * Tell the Reader to merge the decoded buffers into buffers of
+         * at least this many bytes before read() hands them out. Every
+         * decode task produces one buffer (for PBF roughly one primitive
+         * block), which makes for many small buffers. When the work per
+         * object is small, the per-buffer overhead of the handler calls
+         * dominates; with larger buffers it amortizes. The merging
+         * copies the data, so don't use this when the time is spent on
+         * the objects anyway. With buffers_type::single the merged
+         * buffers still contain only one entity type each.
+         */
+        struct coalesce_buffers {
+
+            std::size_t size;
+
+            explicit coalesce_buffers(std::size_t value) noexcept :
+                size(value) {
+            }
+
+        };
+
+        /**
+         * Tell the Reader to start decoding data at the given file offset
+         * instead of at the beginning of the file. The offset must point
+         * to the start of a blob, usually it comes from a PBFBlobIndex.
+         * Only the PBF format supports this.
+         */
+        struct start_offset {
+
+            std::size_t offset;
+
+            explicit start_offset(std::size_t value) noexcept :
+                offset(value) {
+            }
+
+        };
+
+        /**
+         * Metadata about a PBF data blob handed to the blob_filter
+         * callback before the blob is decompressed and decoded.
+         */
+        struct blob_info {
+
+            /// Sequence number of this data blob (0-based, counted from
+            /// the position where decoding started).
+            std::size_t index;
+
+            /**
+             * Offset in the PBF file where the blob starts. This is the
+             * same offset the PBFBlobIndex stores, so it can be used to
+             * look up the entity types, id range, and bounding box of the
+             * blob in such an index.
+             */
+            std::size_t offset;
+
+            /// Size of the (compressed) blob data in the file.
+            std::size_t datasize;
+
+        };
+
+        /**
+         * Tell the Reader to call the given function for every PBF data
+         * blob before it is decompressed and decoded. If the function
+         * returns false, the blob is skipped entirely, saving the
+         * decompression and decoding work. Use the offset in the blob_info
+         * together with a PBFBlobIndex to skip blobs that can't contain
+         * anything of interest, for instance all pure-node blobs in a
+         * ways-only job. The callback is called on the PBF parser thread.
+         * Only the PBF format supports this.
+         */
+        struct blob_filter {
+
+            std::function<bool(const blob_info&)> filter;
+
+            explicit blob_filter(std::function<bool(const blob_info&)> function) :
+                filter(std::move(function)) {
+            }
+
+        };
+
+        /**
+         * Tell the Reader to drop all nodes whose location is outside
+         * the given box while they are decoded, before they are even
+         * built into a buffer. Nodes without a valid location (for
+         * instance deleted nodes in history files) are kept. Ways and
+         * relations are not filtered, their node references can point
+         * to dropped nodes. Only the PBF format supports this. To also
+         * skip whole blobs that can't contain anything inside the box,
+         * combine this with the blob_filter that
+         * PBFBlobIndex::box_filter() makes from an index of the file.
+         */
+        struct filter_box {
+
+            osmium::Box box;
+
+            explicit filter_box(const osmium::Box& value) noexcept :
+                box(value) {
+            }
+
+        };
+
         inline const char* as_string(const file_format format) noexcept {
             switch (format) {
                 case file_format::xml:
@@ -80,6 +308,8 @@ namespace osmium {
                     return "BLACKHOLE";
                 case file_format::ids:
                     return "IDS";
+                case file_format::shm:
+                    return "SHM";
                 default: // file_format::unknown
                     break;
             }
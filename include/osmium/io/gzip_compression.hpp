@@ -47,14 +47,20 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/error.hpp>
 #include <osmium/io/file_compression.hpp>
 #include <osmium/io/writer_options.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/config.hpp>
 
 #include <zlib.h>
 
 #include <cassert>
 #include <cerrno>
+#include <chrono>
 #include <cstddef>
+#include <future>
 #include <limits>
+#include <queue>
 #include <string>
+#include <utility>
 
 #ifndef _MSC_VER
 # include <unistd.h>
@@ -181,6 +187,156 @@ namespace osmium {
 
         }; // class GzipCompressor
 
+        namespace detail {
+
+            /**
+             * Task run on the thread pool deflating one chunk of data into
+             * a complete gzip member.
+             */
+            class GzipMemberCompressTask {
+
+                std::string m_input;
+
+            public:
+
+                explicit GzipMemberCompressTask(std::string&& input) :
+                    m_input(std::move(input)) {
+                }
+
+                std::string operator()() {
+                    z_stream strm{};
+                    // 15 + 16 selects a gzip wrapper instead of a zlib one
+                    int result = ::deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+                    if (result != Z_OK) {
+                        throw gzip_error{"gzip error: compression init failed", result};
+                    }
+
+                    std::string output;
+                    output.resize(::deflateBound(&strm, static_cast<uLong>(m_input.size())) + 32);
+                    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(m_input.data())); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+                    strm.avail_in = static_cast<uInt>(m_input.size());
+                    strm.next_out = reinterpret_cast<Bytef*>(&output[0]);
+                    strm.avail_out = static_cast<uInt>(output.size());
+
+                    result = ::deflate(&strm, Z_FINISH);
+                    ::deflateEnd(&strm);
+                    if (result != Z_STREAM_END) {
+                        throw gzip_error{"gzip error: compression failed", result};
+                    }
+
+                    output.resize(output.size() - strm.avail_out);
+                    return output;
+                }
+
+            }; // class GzipMemberCompressTask
+
+        } // namespace detail
+
+        /**
+         * Compressor writing gzip files as a series of independently
+         * compressed gzip members, like pigz does. Every chunk handed to
+         * write() is deflated as a parallel task on the thread pool and
+         * the write thread only copies finished members to the file in
+         * order, so compression scales with the number of cores.
+         * Concatenated gzip members are valid gzip, every decompressor
+         * reads them like a single-member file.
+         *
+         * The compression factory selects this instead of the default
+         * GzipCompressor when the environment variable
+         * OSMIUM_USE_PARALLEL_GZIP_COMPRESSION is set. The compressed
+         * bytes differ from the single-member output of GzipCompressor,
+         * the decompressed contents are the same.
+         */
+        class ParallelGzipCompressor final : public Compressor {
+
+            enum : std::size_t {
+                // bounds the number of deflate tasks in flight and with it
+                // the memory needed for their inputs and results
+                max_tasks_in_flight = 16
+            };
+
+            osmium::thread::Pool& m_pool;
+            std::queue<std::future<std::string>> m_members{};
+            std::size_t m_file_size = 0;
+            int m_fd;
+
+            /// Write the oldest member to the file, waiting for it if necessary.
+            void pop_and_write() {
+                std::future<std::string> member{std::move(m_members.front())};
+                m_members.pop();
+                const std::string data{member.get()};
+                osmium::io::detail::reliable_write(m_fd, data.data(), data.size());
+            }
+
+            void write_finished_members() {
+                while (!m_members.empty() &&
+                       m_members.front().wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+                    pop_and_write();
+                }
+            }
+
+        public:
+
+            explicit ParallelGzipCompressor(const int fd, const fsync sync, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                Compressor(sync),
+                m_pool(pool),
+                m_fd(fd) {
+            }
+
+            ParallelGzipCompressor(const ParallelGzipCompressor&) = delete;
+            ParallelGzipCompressor& operator=(const ParallelGzipCompressor&) = delete;
+
+            ParallelGzipCompressor(ParallelGzipCompressor&&) = delete;
+            ParallelGzipCompressor& operator=(ParallelGzipCompressor&&) = delete;
+
+            ~ParallelGzipCompressor() noexcept override {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            void write(const std::string& data) override {
+                assert(data.size() < std::numeric_limits<unsigned int>::max());
+                if (!data.empty()) {
+                    m_members.push(m_pool.submit(detail::GzipMemberCompressTask{std::string{data}}));
+                }
+                write_finished_members();
+                while (m_members.size() >= max_tasks_in_flight) {
+                    pop_and_write();
+                }
+            }
+
+            void close() override {
+                if (m_fd >= 0) {
+                    while (!m_members.empty()) {
+                        pop_and_write();
+                    }
+
+                    const int fd = m_fd;
+                    m_fd = -1;
+
+                    // Do not sync or close stdout
+                    if (fd == 1) {
+                        return;
+                    }
+
+                    m_file_size = osmium::file_size(fd);
+
+                    if (do_fsync()) {
+                        osmium::io::detail::reliable_fsync(fd);
+                    }
+                    osmium::io::detail::reliable_close(fd);
+                }
+            }
+
+            std::size_t file_size() const override {
+                return m_file_size;
+            }
+
+        }; // class ParallelGzipCompressor
+
         class GzipDecompressor final : public Decompressor {
 
             gzFile m_gzfile = nullptr;
@@ -338,7 +494,12 @@ namespace osmium {
             // we want the register_compression() function to run, setting
             // the variable is only a side-effect, it will never be used
             const bool registered_gzip_compression = osmium::io::CompressionFactory::instance().register_compression(osmium::io::file_compression::gzip,
-                [](const int fd, const fsync sync) { return new osmium::io::GzipCompressor{fd, sync}; },
+                [](const int fd, const fsync sync) -> osmium::io::Compressor* {
+                    if (osmium::config::use_parallel_gzip_compression()) {
+                        return new osmium::io::ParallelGzipCompressor{fd, sync};
+                    }
+                    return new osmium::io::GzipCompressor{fd, sync};
+                },
                 [](const int fd) { return new osmium::io::GzipDecompressor{fd}; },
                 [](const char* buffer, const std::size_t size) { return new osmium::io::GzipBufferDecompressor{buffer, size}; }
             );
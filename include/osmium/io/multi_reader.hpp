@@ -0,0 +1,278 @@
+#ifndef OSMIUM_IO_MULTI_READER_HPP
+#define OSMIUM_IO_MULTI_READER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/util.hpp>
+#include <osmium/util/config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Reads several OSM files in parallel. One osmium::io::Reader is
+         * opened for every file, so all files are read and decoded
+         * concurrently, sharing a single thread pool. Buffers are handed
+         * out in the order they become ready, tagged with the index of
+         * the file they came from.
+         *
+         * This is useful when the data is sharded over many files, for
+         * instance non-overlapping regional extracts, and you want to
+         * process all of them in one process:
+         *
+         * @code
+         * osmium::io::MultiReader reader{files};
+         * while (auto item = reader.read()) {
+         *     // item.source is an index into the files vector
+         *     process(item.buffer, item.source);
+         * }
+         * reader.close();
+         * @endcode
+         *
+         * Note that no ordering between buffers from different files is
+         * guaranteed, so this is only useful if your processing doesn't
+         * depend on seeing the objects in order.
+         *
+         * All additional arguments of the constructor are passed on to
+         * the constructors of all the Readers, so you can use the usual
+         * Reader options like entity bits or osmium::io::read_meta here.
+         */
+        class MultiReader {
+
+        public:
+
+            /**
+             * A buffer tagged with the index of the file it was read
+             * from. Evaluates to false when the buffer is invalid which
+             * means all files have been read completely.
+             */
+            struct buffer_with_source {
+
+                osmium::memory::Buffer buffer{};
+
+                std::size_t source = 0;
+
+                explicit operator bool() const noexcept {
+                    return static_cast<bool>(buffer);
+                }
+
+            }; // struct buffer_with_source
+
+        private:
+
+            struct queue_item {
+
+                osmium::memory::Buffer buffer{};
+
+                std::size_t source = 0;
+
+                std::exception_ptr exception{};
+
+            }; // struct queue_item
+
+            std::vector<std::unique_ptr<Reader>> m_readers{};
+
+            osmium::thread::Queue<queue_item> m_queue;
+
+            std::vector<std::thread> m_threads{};
+
+            /// Number of readers that have not delivered their end-of-file marker yet.
+            std::size_t m_active;
+
+            std::atomic<bool> m_stop{false};
+
+            /**
+             * Runs in a thread per reader. Forwards all buffers from the
+             * reader into the shared queue, followed by an invalid buffer
+             * as end-of-file marker. An exception from the reader is
+             * caught and attached to the end-of-file marker so it can be
+             * rethrown in the user thread.
+             */
+            void pump(const std::size_t source) {
+                osmium::thread::set_thread_name("_osmium_multi_in");
+
+                queue_item item;
+                item.source = source;
+
+                try {
+                    while (!m_stop) {
+                        osmium::memory::Buffer buffer = m_readers[source]->read();
+                        if (!buffer) {
+                            break;
+                        }
+                        item.buffer = std::move(buffer);
+                        m_queue.push(std::move(item));
+                        item = queue_item{};
+                        item.source = source;
+                    }
+                } catch (...) {
+                    item.exception = std::current_exception();
+                }
+
+                item.buffer = osmium::memory::Buffer{};
+                m_queue.push(std::move(item));
+            }
+
+        public:
+
+            /**
+             * Create MultiReader reading all the specified files. Any
+             * additional arguments are passed on to the constructor of
+             * every osmium::io::Reader.
+             *
+             * @param files The files to read.
+             * @param args All further arguments are forwarded to the
+             *             Reader constructors.
+             * @throws Whatever the Reader constructor throws.
+             */
+            template <typename... TArgs>
+            explicit MultiReader(const std::vector<osmium::io::File>& files, TArgs&&... args) :
+                m_queue(osmium::config::get_max_queue_size("MULTIREADER", files.size() * 2), "multireader_results"),
+                m_active(files.size()) {
+                m_readers.reserve(files.size());
+                for (const auto& file : files) {
+                    m_readers.emplace_back(new Reader{file, args...});
+                }
+
+                m_threads.reserve(m_readers.size());
+                for (std::size_t i = 0; i < m_readers.size(); ++i) {
+                    m_threads.emplace_back(&MultiReader::pump, this, i);
+                }
+            }
+
+            MultiReader(const MultiReader&) = delete;
+            MultiReader& operator=(const MultiReader&) = delete;
+
+            MultiReader(MultiReader&&) = delete;
+            MultiReader& operator=(MultiReader&&) = delete;
+
+            ~MultiReader() noexcept {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /// The number of files this reader reads from.
+            std::size_t num_sources() const noexcept {
+                return m_readers.size();
+            }
+
+            /**
+             * Get the next buffer from any of the files together with the
+             * index of the file it came from. Blocks if no buffer is
+             * ready yet.
+             *
+             * @returns Tagged buffer. An invalid buffer signals
+             *          end-of-file on all files.
+             * @throws Whatever the Reader read() call throws. Call
+             *         close() after an exception before destroying the
+             *         MultiReader.
+             */
+            buffer_with_source read() {
+                buffer_with_source result;
+
+                while (m_active > 0) {
+                    queue_item item;
+                    m_queue.wait_and_pop(item);
+                    if (item.buffer) {
+                        result.buffer = std::move(item.buffer);
+                        result.source = item.source;
+                        return result;
+                    }
+                    --m_active;
+                    if (item.exception) {
+                        std::rethrow_exception(item.exception);
+                    }
+                }
+
+                return result;
+            }
+
+            /**
+             * Close down all the readers. Undelivered buffers are thrown
+             * away.
+             *
+             * Does not throw even if one of the readers saw an error, so
+             * it is safe to call this after read() threw an exception.
+             */
+            void close() {
+                m_stop = true;
+
+                // Drain the queue so pump threads blocked on a full
+                // queue can deliver their end-of-file marker.
+                while (m_active > 0) {
+                    queue_item item;
+                    m_queue.wait_and_pop(item);
+                    if (!item.buffer) {
+                        --m_active;
+                    }
+                }
+
+                for (auto& thread : m_threads) {
+                    if (thread.joinable()) {
+                        thread.join();
+                    }
+                }
+                m_threads.clear();
+
+                for (const auto& reader : m_readers) {
+                    try {
+                        reader->close();
+                    } catch (...) {
+                        // Ignore, the readers are being shut down anyway.
+                    }
+                }
+            }
+
+        }; // class MultiReader
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_MULTI_READER_HPP
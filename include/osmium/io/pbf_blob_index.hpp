@@ -0,0 +1,592 @@
+#ifndef OSMIUM_IO_PBF_BLOB_INDEX_HPP
+#define OSMIUM_IO_PBF_BLOB_INDEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file if you want to build, store, and query indexes over
+ * the blobs in a PBF file for random access.
+ */
+
+#include <osmium/io/detail/pbf.hpp>
+#include <osmium/io/detail/pbf_decoder.hpp>
+#include <osmium/io/detail/protobuf_tags.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+
+#include <protozero/pbf_message.hpp>
+#include <protozero/types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * An index over the data blobs in a PBF file. For every OSMData
+         * blob it stores the file offset where the blob starts, the types
+         * of entities in the blob, the range of ids, and the bounding box
+         * of all node locations.
+         *
+         * The index is built in one pass over the PBF file. It can be
+         * stored in a sidecar file next to the PBF file and loaded again
+         * later. Use the offsets from index queries with the
+         * osmium::io::start_offset option on the Reader to jump directly
+         * to the first interesting blob instead of scanning the whole
+         * file.
+         */
+        class PBFBlobIndex {
+
+        public:
+
+            struct Entry {
+
+                /// Offset in the PBF file where the blob starts.
+                std::size_t offset = 0;
+
+                /// Smallest object id in the blob.
+                osmium::object_id_type first_id = std::numeric_limits<osmium::object_id_type>::max();
+
+                /// Largest object id in the blob.
+                osmium::object_id_type last_id = std::numeric_limits<osmium::object_id_type>::min();
+
+                /// Bounding box of all node locations in the blob.
+                osmium::Box box{};
+
+                /// Types of entities in the blob.
+                osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nothing;
+
+                /// Number of nodes in the blob.
+                uint64_t num_nodes = 0;
+
+                /// Number of ways in the blob.
+                uint64_t num_ways = 0;
+
+                /// Number of relations in the blob.
+                uint64_t num_relations = 0;
+
+            }; // struct Entry
+
+            /// Number of entities of each type in a PBF file.
+            struct EntityCounts {
+
+                uint64_t nodes = 0;
+                uint64_t ways = 0;
+                uint64_t relations = 0;
+
+                uint64_t total() const noexcept {
+                    return nodes + ways + relations;
+                }
+
+            }; // struct EntityCounts
+
+        private:
+
+            std::vector<Entry> m_entries{};
+
+            enum {
+                format_version = 2
+            };
+
+            static const char* magic() noexcept {
+                return "osmium-pbf-blob-index";
+            }
+
+            static uint32_t get_size_in_network_byte_order(const char* d) noexcept {
+                return (static_cast<uint32_t>(d[3])) |
+                       (static_cast<uint32_t>(d[2]) <<  8U) |
+                       (static_cast<uint32_t>(d[1]) << 16U) |
+                       (static_cast<uint32_t>(d[0]) << 24U);
+            }
+
+            // Decode a BlobHeader returning its type ("OSMHeader" or
+            // "OSMData") and the size of the following blob.
+            static std::size_t decode_blob_header(const protozero::data_view& data, std::string& type) {
+                protozero::pbf_message<detail::FileFormat::BlobHeader> pbf_blob_header{data};
+                std::size_t blob_size = 0;
+
+                while (pbf_blob_header.next()) {
+                    switch (pbf_blob_header.tag_and_type()) {
+                        case protozero::tag_and_type(detail::FileFormat::BlobHeader::required_string_type, protozero::pbf_wire_type::length_delimited):
+                            type = pbf_blob_header.get_string();
+                            break;
+                        case protozero::tag_and_type(detail::FileFormat::BlobHeader::required_int32_datasize, protozero::pbf_wire_type::varint):
+                            blob_size = static_cast<std::size_t>(pbf_blob_header.get_int32());
+                            break;
+                        default:
+                            pbf_blob_header.skip();
+                    }
+                }
+
+                if (blob_size == 0 || blob_size > detail::max_uncompressed_blob_size) {
+                    throw osmium::pbf_error{"invalid blob size"};
+                }
+
+                return blob_size;
+            }
+
+            static void add_buffer_to_entry(Entry& entry, const osmium::memory::Buffer& buffer) {
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    entry.entities |= osmium::osm_entity_bits::from_item_type(object.type());
+                    if (object.id() < entry.first_id) {
+                        entry.first_id = object.id();
+                    }
+                    if (object.id() > entry.last_id) {
+                        entry.last_id = object.id();
+                    }
+                    switch (object.type()) {
+                        case osmium::item_type::node: {
+                                ++entry.num_nodes;
+                                const auto location = static_cast<const osmium::Node&>(object).location();
+                                if (location.valid()) {
+                                    entry.box.extend(location);
+                                }
+                            }
+                            break;
+                        case osmium::item_type::way:
+                            ++entry.num_ways;
+                            break;
+                        case osmium::item_type::relation:
+                            ++entry.num_relations;
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            }
+
+            static Entry build_entry(std::size_t offset, std::string&& blob_data) {
+                Entry entry;
+                entry.offset = offset;
+
+                detail::PBFDataBlobDecoder decoder{std::move(blob_data),
+                                                   osmium::osm_entity_bits::nwr,
+                                                   osmium::io::read_meta::no,
+                                                   osmium::io::read_tags::no};
+                osmium::memory::Buffer buffer = decoder();
+
+                // the decoder overflows into nested buffers when a blob
+                // doesn't fit into a single one
+                while (buffer.has_nested_buffers()) {
+                    const std::unique_ptr<osmium::memory::Buffer> nested{buffer.get_last_nested()};
+                    add_buffer_to_entry(entry, *nested);
+                }
+                add_buffer_to_entry(entry, buffer);
+
+                return entry;
+            }
+
+        public:
+
+            PBFBlobIndex() = default;
+
+            /**
+             * Build an index for the specified PBF file by scanning over
+             * all its blobs once.
+             *
+             * @param filename Name of the PBF file.
+             * @throws osmium::pbf_error If the file is not a valid PBF file.
+             * @throws std::system_error If the file could not be opened.
+             */
+            static PBFBlobIndex build(const std::string& filename) {
+                PBFBlobIndex index;
+
+                const int fd = osmium::io::detail::open_for_reading(filename);
+                const std::size_t file_size = osmium::file_size(fd);
+
+                std::size_t offset = 0;
+                while (offset < file_size) {
+                    std::array<char, sizeof(uint32_t)> size_buffer{};
+                    if (!osmium::io::detail::read_exactly(fd, size_buffer.data(), static_cast<unsigned int>(size_buffer.size()))) {
+                        break; // EOF
+                    }
+                    const uint32_t header_size = get_size_in_network_byte_order(size_buffer.data());
+                    if (header_size > static_cast<uint32_t>(detail::max_blob_header_size)) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw osmium::pbf_error{"invalid BlobHeader size (> max_blob_header_size)"};
+                    }
+
+                    std::string header_data(header_size, '\0');
+                    if (!osmium::io::detail::read_exactly(fd, &*header_data.begin(), header_size)) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw osmium::pbf_error{"unexpected EOF"};
+                    }
+
+                    std::string blob_type;
+                    std::size_t blob_size = 0;
+                    try {
+                        blob_size = decode_blob_header(protozero::data_view{header_data.data(), header_data.size()}, blob_type);
+                    } catch (...) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw;
+                    }
+
+                    std::string blob_data(blob_size, '\0');
+                    if (!osmium::io::detail::read_exactly(fd, &*blob_data.begin(), static_cast<unsigned int>(blob_size))) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw osmium::pbf_error{"unexpected EOF"};
+                    }
+
+                    if (blob_type == "OSMData") {
+                        try {
+                            index.m_entries.push_back(build_entry(offset, std::move(blob_data)));
+                        } catch (...) {
+                            osmium::io::detail::reliable_close(fd);
+                            throw;
+                        }
+                    }
+
+                    offset += sizeof(uint32_t) + header_size + blob_size;
+                }
+
+                osmium::io::detail::reliable_close(fd);
+                return index;
+            }
+
+            /**
+             * Load an index from a sidecar file written with save().
+             *
+             * @param filename Name of the index file.
+             * @throws osmium::io_error If the file is not a valid index file.
+             */
+            static PBFBlobIndex load(const std::string& filename) {
+                std::ifstream input{filename};
+                if (!input.is_open()) {
+                    throw osmium::io_error{std::string{"could not open blob index file '"} + filename + "'"};
+                }
+
+                std::string file_magic;
+                int version = 0;
+                std::size_t count = 0;
+                input >> file_magic >> version >> count;
+                if (!input || file_magic != magic() || version != format_version) {
+                    throw osmium::io_error{std::string{"not a blob index file: '"} + filename + "'"};
+                }
+
+                PBFBlobIndex index;
+                index.m_entries.reserve(count);
+                for (std::size_t n = 0; n < count; ++n) {
+                    Entry entry;
+                    unsigned int entities = 0;
+                    int32_t min_x = 0;
+                    int32_t min_y = 0;
+                    int32_t max_x = 0;
+                    int32_t max_y = 0;
+                    input >> entry.offset >> entities >> entry.first_id >> entry.last_id
+                          >> entry.num_nodes >> entry.num_ways >> entry.num_relations
+                          >> min_x >> min_y >> max_x >> max_y;
+                    if (!input) {
+                        throw osmium::io_error{std::string{"error reading blob index file: '"} + filename + "'"};
+                    }
+                    entry.entities = static_cast<osmium::osm_entity_bits::type>(entities);
+                    if (min_x <= max_x && min_y <= max_y) {
+                        entry.box.extend(osmium::Location{min_x, min_y});
+                        entry.box.extend(osmium::Location{max_x, max_y});
+                    }
+                    index.m_entries.push_back(entry);
+                }
+
+                return index;
+            }
+
+            /**
+             * Save the index to a sidecar file from which it can be loaded
+             * again with load().
+             *
+             * @param filename Name of the index file.
+             * @throws osmium::io_error If the file could not be written.
+             */
+            void save(const std::string& filename) const {
+                std::ofstream output{filename};
+                if (!output.is_open()) {
+                    throw osmium::io_error{std::string{"could not open blob index file '"} + filename + "'"};
+                }
+
+                output << magic() << ' ' << format_version << ' ' << m_entries.size() << '\n';
+                for (const auto& entry : m_entries) {
+                    int32_t min_x = 0;
+                    int32_t min_y = 0;
+                    int32_t max_x = -1;
+                    int32_t max_y = -1;
+                    if (entry.box.valid()) {
+                        min_x = entry.box.bottom_left().x();
+                        min_y = entry.box.bottom_left().y();
+                        max_x = entry.box.top_right().x();
+                        max_y = entry.box.top_right().y();
+                    }
+                    output << entry.offset << ' '
+                           << static_cast<unsigned int>(entry.entities) << ' '
+                           << entry.first_id << ' '
+                           << entry.last_id << ' '
+                           << entry.num_nodes << ' '
+                           << entry.num_ways << ' '
+                           << entry.num_relations << ' '
+                           << min_x << ' ' << min_y << ' ' << max_x << ' ' << max_y << '\n';
+                }
+
+                if (!output) {
+                    throw osmium::io_error{std::string{"error writing blob index file: '"} + filename + "'"};
+                }
+            }
+
+            using const_iterator = std::vector<Entry>::const_iterator;
+
+            const_iterator begin() const noexcept {
+                return m_entries.cbegin();
+            }
+
+            const_iterator end() const noexcept {
+                return m_entries.cend();
+            }
+
+            const Entry& operator[](std::size_t n) const noexcept {
+                return m_entries[n];
+            }
+
+            std::size_t size() const noexcept {
+                return m_entries.size();
+            }
+
+            bool empty() const noexcept {
+                return m_entries.empty();
+            }
+
+            /**
+             * Number of entities of each type in the whole file, summed
+             * up over all blobs. Exact, because the index was built by
+             * decoding every blob. Use this to size indexes and other
+             * data structures before reading the file for real.
+             */
+            EntityCounts counts() const noexcept {
+                EntityCounts result;
+                for (const auto& entry : m_entries) {
+                    result.nodes += entry.num_nodes;
+                    result.ways += entry.num_ways;
+                    result.relations += entry.num_relations;
+                }
+                return result;
+            }
+
+            /**
+             * Make a blob filter (for the osmium::io::blob_filter Reader
+             * option) that skips all node-only blobs whose bounding box
+             * doesn't overlap the given box. Use this together with the
+             * osmium::io::filter_box option: the filter skips the
+             * decompression and decoding of whole blobs, the option
+             * drops the remaining out-of-box nodes one by one. Blobs
+             * containing ways or relations and blobs without a valid
+             * bounding box are never skipped.
+             *
+             * The returned function refers to this index, which must
+             * stay alive as long as the filter is in use.
+             *
+             * @param box The box. Must be valid.
+             */
+            std::function<bool(const osmium::io::blob_info&)> box_filter(const osmium::Box& box) const {
+                assert(box.valid());
+                return [this, box](const osmium::io::blob_info& info) {
+                    // the entries are sorted by offset
+                    const auto it = std::lower_bound(m_entries.cbegin(), m_entries.cend(), info.offset,
+                                                     [](const Entry& entry, std::size_t offset) {
+                                                         return entry.offset < offset;
+                                                     });
+                    if (it == m_entries.cend() || it->offset != info.offset) {
+                        return true; // blob not in the index, don't skip it
+                    }
+                    if (it->entities != osmium::osm_entity_bits::node || !it->box.valid()) {
+                        return true;
+                    }
+                    return it->box.bottom_left().x() <= box.top_right().x() &&
+                           it->box.top_right().x() >= box.bottom_left().x() &&
+                           it->box.bottom_left().y() <= box.top_right().y() &&
+                           it->box.top_right().y() >= box.bottom_left().y();
+                };
+            }
+
+            /**
+             * Result of a skeleton scan over a PBF file, see scan().
+             */
+            struct ScanResult {
+
+                /// Size of the PBF file in bytes.
+                std::size_t file_size = 0;
+
+                /// Number of OSMData blobs in the file.
+                std::size_t data_blobs = 0;
+
+                /// Compressed payload bytes of all OSMData blobs.
+                std::size_t data_bytes = 0;
+
+                /**
+                 * Rough estimate of the number of entities in the file.
+                 * Nearly all PBF writers (including this library) put
+                 * 8000 entities into each primitive block, so the blob
+                 * count gives an upper bound that is tight for all blobs
+                 * except the last one of each entity type.
+                 */
+                uint64_t estimated_entities() const noexcept {
+                    return static_cast<uint64_t>(data_blobs) * 8000;
+                }
+
+            }; // struct ScanResult
+
+            /**
+             * Skeleton scan over the specified PBF file: reads only the
+             * blob headers and seeks over the compressed blob payloads
+             * without decoding them, so it touches a few bytes per
+             * megabyte of input. Use this for a cheap entity count
+             * estimate when no index (which has exact counts) has been
+             * built for the file.
+             *
+             * @param filename Name of the PBF file.
+             * @throws osmium::pbf_error If the file is not a valid PBF file.
+             * @throws std::system_error If the file could not be opened.
+             */
+            static ScanResult scan(const std::string& filename) {
+                ScanResult result;
+
+                const int fd = osmium::io::detail::open_for_reading(filename);
+                result.file_size = osmium::file_size(fd);
+
+                std::size_t offset = 0;
+                while (offset < result.file_size) {
+                    std::array<char, sizeof(uint32_t)> size_buffer{};
+                    if (!osmium::io::detail::read_exactly(fd, size_buffer.data(), static_cast<unsigned int>(size_buffer.size()))) {
+                        break; // EOF
+                    }
+                    const uint32_t header_size = get_size_in_network_byte_order(size_buffer.data());
+                    if (header_size > static_cast<uint32_t>(detail::max_blob_header_size)) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw osmium::pbf_error{"invalid BlobHeader size (> max_blob_header_size)"};
+                    }
+
+                    std::string header_data(header_size, '\0');
+                    if (!osmium::io::detail::read_exactly(fd, &*header_data.begin(), header_size)) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw osmium::pbf_error{"unexpected EOF"};
+                    }
+
+                    std::string blob_type;
+                    std::size_t blob_size = 0;
+                    try {
+                        blob_size = decode_blob_header(protozero::data_view{header_data.data(), header_data.size()}, blob_type);
+                    } catch (...) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw;
+                    }
+
+                    if (blob_type == "OSMData") {
+                        ++result.data_blobs;
+                        result.data_bytes += blob_size;
+                    }
+
+                    offset += sizeof(uint32_t) + header_size + blob_size;
+                    osmium::util::file_seek(fd, offset);
+                }
+
+                osmium::io::detail::reliable_close(fd);
+                return result;
+            }
+
+            /**
+             * Find the first blob that can contain the object with the
+             * specified type and id.
+             *
+             * @returns Pointer to the entry or nullptr if there is none.
+             *          The pointer is invalidated when the index is
+             *          destroyed.
+             */
+            const Entry* find_id(const osmium::item_type type, const osmium::object_id_type id) const noexcept {
+                for (const auto& entry : m_entries) {
+                    if ((entry.entities & osmium::osm_entity_bits::from_item_type(type)) &&
+                        id >= entry.first_id && id <= entry.last_id) {
+                        return &entry;
+                    }
+                }
+                return nullptr;
+            }
+
+            /**
+             * Find all blobs with node locations inside the specified
+             * bounding box. Blobs without any nodes are not reported,
+             * the ways and relations referencing the nodes are usually
+             * in the blobs following the last node blob.
+             *
+             * @returns Entries for all blobs whose bounding box overlaps
+             *          the specified box, in file order.
+             */
+            std::vector<const Entry*> find_in_box(const osmium::Box& box) const {
+                std::vector<const Entry*> result;
+                for (const auto& entry : m_entries) {
+                    if (entry.box.valid() &&
+                        entry.box.bottom_left().x() <= box.top_right().x() &&
+                        entry.box.top_right().x() >= box.bottom_left().x() &&
+                        entry.box.bottom_left().y() <= box.top_right().y() &&
+                        entry.box.top_right().y() >= box.bottom_left().y()) {
+                        result.push_back(&entry);
+                    }
+                }
+                return result;
+            }
+
+        }; // class PBFBlobIndex
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_PBF_BLOB_INDEX_HPP
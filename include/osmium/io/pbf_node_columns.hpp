@@ -0,0 +1,321 @@
+#ifndef OSMIUM_IO_PBF_NODE_COLUMNS_HPP
+#define OSMIUM_IO_PBF_NODE_COLUMNS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file if you want to read node ids and locations from a
+ * PBF file into flat arrays without creating osmium::Node objects.
+ */
+
+#include <osmium/io/detail/pbf.hpp>
+#include <osmium/io/detail/pbf_decoder.hpp>
+#include <osmium/io/detail/protobuf_tags.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/detail/varint_decoder.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+
+#include <protozero/pbf_message.hpp>
+#include <protozero/types.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Node ids and locations from one PBF data blob in columnar
+         * (structure-of-arrays) form. The entries at the same index in
+         * the two vectors belong to the same node.
+         */
+        struct NodeColumns {
+
+            std::vector<osmium::object_id_type> ids{};
+            std::vector<osmium::Location> locations{};
+
+            std::size_t size() const noexcept {
+                return ids.size();
+            }
+
+            bool empty() const noexcept {
+                return ids.empty();
+            }
+
+        }; // struct NodeColumns
+
+        namespace detail {
+
+            /**
+             * Decodes only the node ids and locations from an uncompressed
+             * PrimitiveBlock into a NodeColumns chunk. The DenseNodes
+             * format already stores ids, latitudes, and longitudes as
+             * separate packed columns, so this just delta-decodes them
+             * into the output vectors. Tags, metadata, ways, and relations
+             * are skipped without decoding.
+             */
+            class PBFNodeColumnsDecoder {
+
+                data_view m_data;
+
+                int64_t m_lon_offset = 0;
+                int64_t m_lat_offset = 0;
+                int32_t m_granularity = 100;
+
+                int32_t convert_pbf_lon(const int64_t c) const noexcept {
+                    return static_cast<int32_t>((c * m_granularity + m_lon_offset) / resolution_convert);
+                }
+
+                int32_t convert_pbf_lat(const int64_t c) const noexcept {
+                    return static_cast<int32_t>((c * m_granularity + m_lat_offset) / resolution_convert);
+                }
+
+                void decode_metadata() {
+                    protozero::pbf_message<OSMFormat::PrimitiveBlock> pbf_primitive_block{m_data};
+                    while (pbf_primitive_block.next()) {
+                        switch (pbf_primitive_block.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::PrimitiveBlock::optional_int32_granularity, protozero::pbf_wire_type::varint):
+                                m_granularity = pbf_primitive_block.get_int32();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::PrimitiveBlock::optional_int64_lat_offset, protozero::pbf_wire_type::varint):
+                                m_lat_offset = pbf_primitive_block.get_int64();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::PrimitiveBlock::optional_int64_lon_offset, protozero::pbf_wire_type::varint):
+                                m_lon_offset = pbf_primitive_block.get_int64();
+                                break;
+                            default:
+                                pbf_primitive_block.skip();
+                        }
+                    }
+                }
+
+                void decode_dense_nodes(const data_view& data, NodeColumns& columns) const {
+                    std::vector<int64_t> ids;
+                    std::vector<int64_t> lats;
+                    std::vector<int64_t> lons;
+
+                    protozero::pbf_message<OSMFormat::DenseNodes> pbf_dense_nodes{data};
+                    while (pbf_dense_nodes.next()) {
+                        switch (pbf_dense_nodes.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), ids);
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), lats);
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited):
+                                decode_packed_sint64_deltas(pbf_dense_nodes.get_view(), lons);
+                                break;
+                            default:
+                                pbf_dense_nodes.skip();
+                        }
+                    }
+
+                    if (lons.size() < ids.size() ||
+                        lats.size() < ids.size()) {
+                        // this is against the spec, must have same number of elements
+                        throw osmium::pbf_error{"PBF format error"};
+                    }
+
+                    columns.ids.reserve(columns.ids.size() + ids.size());
+                    columns.locations.reserve(columns.locations.size() + ids.size());
+                    for (std::size_t n = 0; n < ids.size(); ++n) {
+                        columns.ids.push_back(ids[n]);
+                        columns.locations.emplace_back(convert_pbf_lon(lons[n]),
+                                                       convert_pbf_lat(lats[n]));
+                    }
+                }
+
+                void decode_node(const data_view& data, NodeColumns& columns) const {
+                    int64_t id = 0;
+                    int64_t lat = 0;
+                    int64_t lon = 0;
+
+                    protozero::pbf_message<OSMFormat::Node> pbf_node{data};
+                    while (pbf_node.next()) {
+                        switch (pbf_node.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::Node::required_sint64_id, protozero::pbf_wire_type::varint):
+                                id = pbf_node.get_sint64();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::required_sint64_lat, protozero::pbf_wire_type::varint):
+                                lat = pbf_node.get_sint64();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::required_sint64_lon, protozero::pbf_wire_type::varint):
+                                lon = pbf_node.get_sint64();
+                                break;
+                            default:
+                                pbf_node.skip();
+                        }
+                    }
+
+                    columns.ids.push_back(id);
+                    columns.locations.emplace_back(convert_pbf_lon(lon),
+                                                   convert_pbf_lat(lat));
+                }
+
+            public:
+
+                explicit PBFNodeColumnsDecoder(const data_view& data) :
+                    m_data(data) {
+                }
+
+                void decode(NodeColumns& columns) {
+                    decode_metadata();
+
+                    protozero::pbf_message<OSMFormat::PrimitiveBlock> pbf_primitive_block{m_data};
+                    while (pbf_primitive_block.next(OSMFormat::PrimitiveBlock::repeated_PrimitiveGroup_primitivegroup, protozero::pbf_wire_type::length_delimited)) {
+                        protozero::pbf_message<OSMFormat::PrimitiveGroup> pbf_primitive_group = pbf_primitive_block.get_message();
+                        while (pbf_primitive_group.next()) {
+                            switch (pbf_primitive_group.tag_and_type()) {
+                                case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes, protozero::pbf_wire_type::length_delimited):
+                                    decode_node(pbf_primitive_group.get_view(), columns);
+                                    break;
+                                case protozero::tag_and_type(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, protozero::pbf_wire_type::length_delimited):
+                                    decode_dense_nodes(pbf_primitive_group.get_view(), columns);
+                                    break;
+                                default:
+                                    pbf_primitive_group.skip();
+                            }
+                        }
+                    }
+                }
+
+            }; // class PBFNodeColumnsDecoder
+
+        } // namespace detail
+
+        /**
+         * Read the node ids and locations from a PBF file, calling the
+         * specified function once for every data blob containing nodes
+         * with a NodeColumns chunk holding flat id and location arrays
+         * in file order.
+         *
+         * This is a fast path next to the Reader/osmium::apply pipeline
+         * for applications that only want the node coordinates as plain
+         * arrays: no osmium::Node objects are built and tags, metadata,
+         * ways, and relations are skipped without decoding.
+         *
+         * @code
+         * osmium::io::read_node_columns("input.osm.pbf", [](osmium::io::NodeColumns&& columns) {
+         *     process(columns.ids, columns.locations);
+         * });
+         * @endcode
+         *
+         * @param filename Name of the PBF file.
+         * @param func Callable taking a NodeColumns by rvalue reference.
+         * @throws osmium::pbf_error If the file is not a valid PBF file.
+         * @throws std::system_error If the file could not be opened.
+         */
+        template <typename TFunc>
+        void read_node_columns(const std::string& filename, TFunc&& func) {
+            const int fd = osmium::io::detail::open_for_reading(filename);
+
+            try {
+                while (true) {
+                    std::array<char, sizeof(uint32_t)> size_buffer{};
+                    if (!osmium::io::detail::read_exactly(fd, size_buffer.data(), static_cast<unsigned int>(size_buffer.size()))) {
+                        break; // EOF
+                    }
+                    const uint32_t header_size = (static_cast<uint32_t>(size_buffer[3])) |
+                                                 (static_cast<uint32_t>(size_buffer[2]) <<  8U) |
+                                                 (static_cast<uint32_t>(size_buffer[1]) << 16U) |
+                                                 (static_cast<uint32_t>(size_buffer[0]) << 24U);
+                    if (header_size > static_cast<uint32_t>(detail::max_blob_header_size)) {
+                        throw osmium::pbf_error{"invalid BlobHeader size (> max_blob_header_size)"};
+                    }
+
+                    std::string header_data(header_size, '\0');
+                    if (!osmium::io::detail::read_exactly(fd, &*header_data.begin(), header_size)) {
+                        throw osmium::pbf_error{"unexpected EOF"};
+                    }
+
+                    protozero::pbf_message<detail::FileFormat::BlobHeader> pbf_blob_header{protozero::data_view{header_data.data(), header_data.size()}};
+                    std::string blob_type;
+                    std::size_t blob_size = 0;
+                    while (pbf_blob_header.next()) {
+                        switch (pbf_blob_header.tag_and_type()) {
+                            case protozero::tag_and_type(detail::FileFormat::BlobHeader::required_string_type, protozero::pbf_wire_type::length_delimited):
+                                blob_type = pbf_blob_header.get_string();
+                                break;
+                            case protozero::tag_and_type(detail::FileFormat::BlobHeader::required_int32_datasize, protozero::pbf_wire_type::varint):
+                                blob_size = static_cast<std::size_t>(pbf_blob_header.get_int32());
+                                break;
+                            default:
+                                pbf_blob_header.skip();
+                        }
+                    }
+                    if (blob_size == 0 || blob_size > detail::max_uncompressed_blob_size) {
+                        throw osmium::pbf_error{"invalid blob size"};
+                    }
+
+                    std::string blob_data(blob_size, '\0');
+                    if (!osmium::io::detail::read_exactly(fd, &*blob_data.begin(), static_cast<unsigned int>(blob_size))) {
+                        throw osmium::pbf_error{"unexpected EOF"};
+                    }
+
+                    if (blob_type != "OSMData") {
+                        continue;
+                    }
+
+                    std::string output;
+                    detail::PBFNodeColumnsDecoder decoder{detail::decode_blob(protozero::data_view{blob_data.data(), blob_data.size()}, output)};
+
+                    NodeColumns columns;
+                    decoder.decode(columns);
+                    if (!columns.empty()) {
+                        func(std::move(columns));
+                    }
+                }
+            } catch (...) {
+                osmium::io::detail::reliable_close(fd);
+                throw;
+            }
+
+            osmium::io::detail::reliable_close(fd);
+        }
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_PBF_NODE_COLUMNS_HPP
@@ -0,0 +1,306 @@
+#ifndef OSMIUM_IO_PBF_REFERENCED_IDS_HPP
+#define OSMIUM_IO_PBF_REFERENCED_IDS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file if you want to collect the ids referenced by the
+ * ways and relations in a PBF file into id sets without decoding the
+ * objects themselves.
+ */
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/index/nwr_array.hpp>
+#include <osmium/io/detail/pbf.hpp>
+#include <osmium/io/detail/pbf_decoder.hpp>
+#include <osmium/io/detail/protobuf_tags.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/detail/varint_decoder.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <protozero/pbf_message.hpp>
+#include <protozero/types.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /// The ids referenced from the ways and relations in one blob.
+            struct referenced_ids_chunk {
+
+                std::vector<osmium::unsigned_object_id_type> node_ids{};
+                std::vector<osmium::unsigned_object_id_type> way_ids{};
+                std::vector<osmium::unsigned_object_id_type> relation_ids{};
+
+            }; // struct referenced_ids_chunk
+
+            /**
+             * Extracts only the referenced ids from one PBF data blob:
+             * node refs from ways and member ids from relations. Tags,
+             * metadata, the string table, and the node groups are skipped
+             * without decoding, so this is much cheaper than a full
+             * object decode.
+             */
+            class PBFReferencedIdsBlobDecoder {
+
+                std::shared_ptr<std::string> m_input_buffer;
+
+                static void decode_way(const data_view& data, referenced_ids_chunk& chunk) {
+                    std::vector<int64_t> refs;
+
+                    protozero::pbf_message<OSMFormat::Way> pbf_way{data};
+                    while (pbf_way.next(OSMFormat::Way::packed_sint64_refs, protozero::pbf_wire_type::length_delimited)) {
+                        decode_packed_sint64_deltas(pbf_way.get_view(), refs);
+                    }
+
+                    for (const auto ref : refs) {
+                        chunk.node_ids.push_back(static_cast<osmium::unsigned_object_id_type>(ref));
+                    }
+                }
+
+                static void decode_relation(const data_view& data, referenced_ids_chunk& chunk) {
+                    std::vector<int64_t> memids;
+                    varint_range types;
+
+                    protozero::pbf_message<OSMFormat::Relation> pbf_relation{data};
+                    while (pbf_relation.next()) {
+                        switch (pbf_relation.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::Relation::packed_sint64_memids, protozero::pbf_wire_type::length_delimited):
+                                decode_packed_sint64_deltas(pbf_relation.get_view(), memids);
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Relation::packed_MemberType_types, protozero::pbf_wire_type::length_delimited):
+                                types = varint_range{pbf_relation.get_view()};
+                                break;
+                            default:
+                                pbf_relation.skip();
+                        }
+                    }
+
+                    for (const auto memid : memids) {
+                        if (types.empty()) {
+                            throw osmium::pbf_error{"PBF format error"}; // this is against the spec, memids/types must have the same number of elements
+                        }
+                        const auto id = static_cast<osmium::unsigned_object_id_type>(memid);
+                        switch (types.next_int32()) {
+                            case 0:
+                                chunk.node_ids.push_back(id);
+                                break;
+                            case 1:
+                                chunk.way_ids.push_back(id);
+                                break;
+                            case 2:
+                                chunk.relation_ids.push_back(id);
+                                break;
+                            default:
+                                throw osmium::pbf_error{"unknown relation member type"};
+                        }
+                    }
+                }
+
+            public:
+
+                explicit PBFReferencedIdsBlobDecoder(std::string&& input_buffer) :
+                    m_input_buffer(std::make_shared<std::string>(std::move(input_buffer))) {
+                }
+
+                referenced_ids_chunk operator()() {
+                    referenced_ids_chunk chunk;
+
+                    std::string output;
+                    const data_view block = decode_blob(data_view{m_input_buffer->data(), m_input_buffer->size()}, output);
+
+                    protozero::pbf_message<OSMFormat::PrimitiveBlock> pbf_primitive_block{block};
+                    while (pbf_primitive_block.next(OSMFormat::PrimitiveBlock::repeated_PrimitiveGroup_primitivegroup, protozero::pbf_wire_type::length_delimited)) {
+                        protozero::pbf_message<OSMFormat::PrimitiveGroup> pbf_primitive_group = pbf_primitive_block.get_message();
+                        while (pbf_primitive_group.next()) {
+                            switch (pbf_primitive_group.tag_and_type()) {
+                                case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Way_ways, protozero::pbf_wire_type::length_delimited):
+                                    decode_way(pbf_primitive_group.get_view(), chunk);
+                                    break;
+                                case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Relation_relations, protozero::pbf_wire_type::length_delimited):
+                                    decode_relation(pbf_primitive_group.get_view(), chunk);
+                                    break;
+                                default:
+                                    pbf_primitive_group.skip();
+                            }
+                        }
+                    }
+
+                    return chunk;
+                }
+
+            }; // class PBFReferencedIdsBlobDecoder
+
+        } // namespace detail
+
+        /// Sets of the ids referenced from the ways and relations in a PBF file.
+        using referenced_ids_type = osmium::nwr_array<osmium::index::IdSetDense<osmium::unsigned_object_id_type>>;
+
+        /**
+         * Collect the ids referenced by the ways and relations in a PBF
+         * file: the node ids from way node lists and the member ids from
+         * relations, sorted into one id set per member type.
+         *
+         * This is the usual first pass when creating an extract ("which
+         * objects does the output need"), done at a fraction of the cost
+         * of a full read: blobs are decompressed and the ref/member
+         * columns decoded on the worker threads of the default thread
+         * pool, everything else in the file is skipped without decoding.
+         *
+         * @param filename Name of the PBF file.
+         * @returns An nwr_array of IdSetDense, indexed by the type of the
+         *          referenced object.
+         * @throws osmium::pbf_error If the file is not a valid PBF file.
+         * @throws std::system_error If the file could not be opened.
+         */
+        inline referenced_ids_type read_referenced_ids(const std::string& filename) {
+            referenced_ids_type sets;
+
+            // Enough tasks in flight to keep all pool threads busy
+            // without holding too many decoded id chunks in memory.
+            const std::size_t max_pending_tasks = 2U * static_cast<std::size_t>(osmium::thread::Pool::default_instance().num_threads()) + 2U;
+
+            std::queue<std::future<detail::referenced_ids_chunk>> pending;
+
+            const auto merge_chunk = [&sets](detail::referenced_ids_chunk&& chunk) {
+                for (const auto id : chunk.node_ids) {
+                    sets(osmium::item_type::node).set(id);
+                }
+                for (const auto id : chunk.way_ids) {
+                    sets(osmium::item_type::way).set(id);
+                }
+                for (const auto id : chunk.relation_ids) {
+                    sets(osmium::item_type::relation).set(id);
+                }
+            };
+
+            const int fd = osmium::io::detail::open_for_reading(filename);
+
+            try {
+                while (true) {
+                    std::array<char, sizeof(uint32_t)> size_buffer{};
+                    if (!osmium::io::detail::read_exactly(fd, size_buffer.data(), static_cast<unsigned int>(size_buffer.size()))) {
+                        break; // EOF
+                    }
+                    const uint32_t header_size = (static_cast<uint32_t>(size_buffer[3])) |
+                                                 (static_cast<uint32_t>(size_buffer[2]) <<  8U) |
+                                                 (static_cast<uint32_t>(size_buffer[1]) << 16U) |
+                                                 (static_cast<uint32_t>(size_buffer[0]) << 24U);
+                    if (header_size > static_cast<uint32_t>(detail::max_blob_header_size)) {
+                        throw osmium::pbf_error{"invalid BlobHeader size (> max_blob_header_size)"};
+                    }
+
+                    std::string header_data(header_size, '\0');
+                    if (!osmium::io::detail::read_exactly(fd, &*header_data.begin(), header_size)) {
+                        throw osmium::pbf_error{"unexpected EOF"};
+                    }
+
+                    protozero::pbf_message<detail::FileFormat::BlobHeader> pbf_blob_header{protozero::data_view{header_data.data(), header_data.size()}};
+                    std::string blob_type;
+                    std::size_t blob_size = 0;
+                    while (pbf_blob_header.next()) {
+                        switch (pbf_blob_header.tag_and_type()) {
+                            case protozero::tag_and_type(detail::FileFormat::BlobHeader::required_string_type, protozero::pbf_wire_type::length_delimited):
+                                blob_type = pbf_blob_header.get_string();
+                                break;
+                            case protozero::tag_and_type(detail::FileFormat::BlobHeader::required_int32_datasize, protozero::pbf_wire_type::varint):
+                                blob_size = static_cast<std::size_t>(pbf_blob_header.get_int32());
+                                break;
+                            default:
+                                pbf_blob_header.skip();
+                        }
+                    }
+                    if (blob_size == 0 || blob_size > detail::max_uncompressed_blob_size) {
+                        throw osmium::pbf_error{"invalid blob size"};
+                    }
+
+                    std::string blob_data(blob_size, '\0');
+                    if (!osmium::io::detail::read_exactly(fd, &*blob_data.begin(), static_cast<unsigned int>(blob_size))) {
+                        throw osmium::pbf_error{"unexpected EOF"};
+                    }
+
+                    if (blob_type != "OSMData") {
+                        continue;
+                    }
+
+                    pending.push(osmium::thread::Pool::default_instance().submit(detail::PBFReferencedIdsBlobDecoder{std::move(blob_data)}));
+
+                    while (pending.size() >= max_pending_tasks) {
+                        merge_chunk(pending.front().get());
+                        pending.pop();
+                    }
+                }
+
+                while (!pending.empty()) {
+                    merge_chunk(pending.front().get());
+                    pending.pop();
+                }
+            } catch (...) {
+                // wait for all decode tasks, they reference data we own
+                while (!pending.empty()) {
+                    try {
+                        pending.front().get();
+                    } catch (...) {
+                    }
+                    pending.pop();
+                }
+                osmium::io::detail::reliable_close(fd);
+                throw;
+            }
+
+            osmium::io::detail::reliable_close(fd);
+            return sets;
+        }
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_PBF_REFERENCED_IDS_HPP
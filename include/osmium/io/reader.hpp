@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/nwr_array.hpp>
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
@@ -41,17 +42,26 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/stats.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
 #include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
 #include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <fcntl.h>
+#include <functional>
 #include <future>
 #include <memory>
+#include <queue>
 #include <string>
 #include <system_error>
 #include <thread>
@@ -119,6 +129,10 @@ namespace osmium {
 
             std::unique_ptr<osmium::io::Decompressor> m_decompressor;
 
+            // Must be declared before m_read_thread_manager, because the
+            // read thread starts using it immediately.
+            detail::IOStatsCollector m_stats_collector{};
+
             osmium::io::detail::ReadThreadManager m_read_thread_manager;
 
             detail::future_buffer_queue_type m_osmdata_queue;
@@ -131,7 +145,54 @@ namespace osmium {
 
             osmium::osm_entity_bits::type m_read_which_entities = osmium::osm_entity_bits::all;
             osmium::io::read_meta m_read_metadata = osmium::io::read_meta::yes;
+            osmium::io::read_tags m_read_tags = osmium::io::read_tags::yes;
+            osmium::io::read_discussions m_read_discussions = osmium::io::read_discussions::yes;
+            osmium::io::way_envelopes m_way_envelopes = osmium::io::way_envelopes::no;
+            osmium::io::clean_way_nodes m_clean_way_nodes = osmium::io::clean_way_nodes::no;
+            std::atomic<std::uint64_t> m_duplicate_way_nodes{0};
+            osmium::io::skip_damaged_blobs m_skip_damaged_blobs = osmium::io::skip_damaged_blobs::no;
+            std::atomic<std::uint64_t> m_damaged_blobs{0};
+            osmium::Box m_filter_box{};
             osmium::io::buffers_type m_buffers_kind = osmium::io::buffers_type::any;
+            std::size_t m_start_offset = 0;
+            osmium::io::mapped_input m_use_mapped_input = osmium::io::mapped_input::no;
+            osmium::memory::BufferPool* m_buffer_pool = nullptr;
+            osmium::io::adaptive_queues m_adaptive_queues = osmium::io::adaptive_queues::no;
+            osmium::io::synchronous m_synchronous = osmium::io::synchronous::no;
+            std::function<bool(const osmium::io::blob_info&)> m_blob_filter{};
+
+            // The header promise is kept here until the parser runs: in
+            // synchronous mode until the pipeline is run inline, otherwise
+            // until the parser thread is started on first use.
+            std::promise<osmium::io::Header> m_header_promise{};
+            bool m_synchronous_done = false;
+            bool m_threads_started = false;
+
+            // Buffers read from the pipeline but not yet handed out by
+            // read(item_type), one queue per entity type. Only used in
+            // demuxed reading, see read(osmium::item_type).
+            osmium::nwr_array<std::queue<osmium::memory::Buffer>> m_demux_buffers{};
+
+            // State for buffer coalescing (see the coalesce_buffers
+            // option): target size, a buffer read past a type boundary
+            // that will start the next result, and whether end-of-file
+            // was seen while a coalesced buffer was still returned, so
+            // the next read() must return the invalid buffer.
+            std::size_t m_coalesce_size = 0;
+            osmium::memory::Buffer m_coalesce_stash{};
+            bool m_eof_pending = false;
+
+            // State for the adaptive osmdata queue sizing, only used by the
+            // thread calling read().
+            std::size_t m_adaptive_pops = 0;
+            std::uint64_t m_adaptive_wait_ns = 0;
+            detail::IOStatsCollector::clock::time_point m_adaptive_last{};
+
+            enum : std::size_t {
+                adaptive_check_interval = 32,
+                adaptive_min_queue_size = 2,
+                adaptive_max_queue_size = 256
+            };
 
             void set_option(osmium::thread::Pool& pool) noexcept {
                 m_pool = &pool;
@@ -150,10 +211,194 @@ namespace osmium {
                 }
             }
 
+            void set_option(osmium::io::read_tags value) noexcept {
+                m_read_tags = value;
+            }
+
+            void set_option(osmium::io::read_discussions value) noexcept {
+                m_read_discussions = value;
+            }
+
+            void set_option(osmium::io::way_envelopes value) noexcept {
+                m_way_envelopes = value;
+            }
+
+            void set_option(osmium::io::clean_way_nodes value) noexcept {
+                m_clean_way_nodes = value;
+            }
+
+            void set_option(osmium::io::skip_damaged_blobs value) noexcept {
+                m_skip_damaged_blobs = value;
+            }
+
+            void set_option(const osmium::io::filter_box& value) noexcept {
+                m_filter_box = value.box;
+            }
+
             void set_option(osmium::io::buffers_type value) noexcept {
                 m_buffers_kind = value;
             }
 
+            void set_option(osmium::io::start_offset value) noexcept {
+                m_start_offset = value.offset;
+            }
+
+            void set_option(osmium::io::mapped_input value) noexcept {
+                m_use_mapped_input = value;
+            }
+
+            void set_option(osmium::io::blob_filter value) {
+                m_blob_filter = std::move(value.filter);
+            }
+
+            void set_option(osmium::memory::BufferPool& pool) noexcept {
+                m_buffer_pool = &pool;
+            }
+
+            void set_option(osmium::io::input_queue_size value) {
+                m_input_queue.set_max_size(value.size);
+            }
+
+            void set_option(osmium::io::osmdata_queue_size value) {
+                m_osmdata_queue.set_max_size(value.size);
+            }
+
+            void set_option(osmium::io::adaptive_queues value) noexcept {
+                m_adaptive_queues = value;
+            }
+
+            void set_option(osmium::io::synchronous value) noexcept {
+                m_synchronous = value;
+            }
+
+            void set_option(osmium::io::coalesce_buffers value) noexcept {
+                m_coalesce_size = value.size;
+            }
+
+            osmium::thread::Pool& pool() {
+                if (!m_pool) {
+                    m_pool = &thread::Pool::default_instance();
+                }
+                return *m_pool;
+            }
+
+            // Thread resources are set up lazily: constructing a Reader
+            // only opens the file, the read and parser threads (and the
+            // default thread pool) are started by the first call to
+            // header() or read(). Programs that open a file, look at it,
+            // and close it again never pay for the pipeline startup.
+            void start_threads() {
+                if (m_threads_started || m_synchronous == osmium::io::synchronous::yes) {
+                    return;
+                }
+                m_threads_started = true;
+
+                m_read_thread_manager.start();
+
+                const int fd_for_parser = m_decompressor->is_real() ? -1 : m_fd;
+                m_thread = osmium::thread::thread_handler{parser_thread, std::ref(pool()), fd_for_parser, std::ref(m_creator),
+                                                          std::ref(m_input_queue), std::ref(m_osmdata_queue),
+                                                          std::move(m_header_promise), &m_offset, m_read_which_entities,
+                                                          m_read_metadata, m_read_tags, m_read_discussions, m_way_envelopes,
+                                                          m_clean_way_nodes, &m_duplicate_way_nodes,
+                                                          m_skip_damaged_blobs, &m_damaged_blobs,
+                                                          m_filter_box, m_buffers_kind, m_start_offset,
+                                                          m_decompressor->want_buffered_pages_removed(),
+                                                          m_use_mapped_input, m_buffer_pool, m_blob_filter};
+            }
+
+            // Called every adaptive_check_interval pops from read(). If
+            // read() spent a large part of the last interval waiting, the
+            // consumer is being starved, so let the decoder run further
+            // ahead. If read() hardly waited at all while the queue stayed
+            // full, the consumer is the bottleneck, so shrink the queue to
+            // apply backpressure earlier and keep fewer buffers in memory.
+            void adjust_osmdata_queue_size() {
+                const auto now = detail::IOStatsCollector::clock::now();
+                const auto elapsed = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_adaptive_last).count());
+                const auto max = m_osmdata_queue.max_size();
+
+                if (elapsed > 0 && max > 0) {
+                    if (m_adaptive_wait_ns * 5 > elapsed) { // waiting > 20% of the time
+                        m_osmdata_queue.set_max_size(std::min<std::size_t>(max * 2, adaptive_max_queue_size));
+                    } else if (m_adaptive_wait_ns * 50 < elapsed && // waiting < 2% of the time
+                               m_osmdata_queue.size() + 1 >= max) {
+                        m_osmdata_queue.set_max_size(std::max<std::size_t>(max / 2, adaptive_min_queue_size));
+                    }
+                }
+
+                m_adaptive_last = now;
+                m_adaptive_wait_ns = 0;
+                m_adaptive_pops = 0;
+            }
+
+            // Get the next buffer from the pipeline. This is the read()
+            // logic without the buffer coalescing, see read() for the
+            // semantics.
+            osmium::memory::Buffer read_next() {
+                osmium::memory::Buffer buffer;
+
+                // If there are buffers on the stack, return those first.
+                if (m_back_buffers) {
+                    if (m_back_buffers.has_nested_buffers()) {
+                        buffer = std::move(*m_back_buffers.get_last_nested());
+                    } else {
+                        buffer = std::move(m_back_buffers);
+                        m_back_buffers = osmium::memory::Buffer{};
+                    }
+                    m_stats_collector.add_buffer(buffer.committed());
+                    return buffer;
+                }
+
+                if (m_status != status::okay) {
+                    throw io_error{"Can not read from reader when in status 'closed', 'eof', or 'error'"};
+                }
+
+                if (m_read_which_entities == osmium::osm_entity_bits::nothing) {
+                    m_status = status::eof;
+                    return buffer;
+                }
+
+                try {
+                    run_synchronous();
+                    start_threads();
+
+                    // m_input_format.read() can return an invalid buffer to signal EOF,
+                    // or a valid buffer with or without data. A valid buffer
+                    // without data is not an error, it just means we have to
+                    // keep getting the next buffer until there is one with data.
+                    while (true) {
+                        const auto start = detail::IOStatsCollector::clock::now();
+                        buffer = m_osmdata_queue_wrapper.pop();
+                        const auto wait_ns = detail::IOStatsCollector::elapsed_ns(start);
+                        m_stats_collector.add_wait(wait_ns);
+                        if (m_adaptive_queues == osmium::io::adaptive_queues::yes) {
+                            m_adaptive_wait_ns += wait_ns;
+                            if (++m_adaptive_pops >= adaptive_check_interval) {
+                                adjust_osmdata_queue_size();
+                            }
+                        }
+                        if (detail::at_end_of_data(buffer)) {
+                            m_status = status::eof;
+                            m_read_thread_manager.close();
+                            return buffer;
+                        }
+                        if (buffer.has_nested_buffers()) {
+                            m_back_buffers = std::move(buffer);
+                            buffer = std::move(*m_back_buffers.get_last_nested());
+                        }
+                        if (buffer.committed() > 0) {
+                            m_stats_collector.add_buffer(buffer.committed());
+                            return buffer;
+                        }
+                    }
+                } catch (...) {
+                    close();
+                    m_status = status::error;
+                    throw;
+                }
+            }
+
             // This function will run in a separate thread.
             static void parser_thread(osmium::thread::Pool& pool,
                                       int fd,
@@ -164,8 +409,20 @@ namespace osmium {
                                       std::atomic<std::size_t>* offset_ptr,
                                       osmium::osm_entity_bits::type read_which_entities,
                                       osmium::io::read_meta read_metadata,
+                                      osmium::io::read_tags read_tags,
+                                      osmium::io::read_discussions read_discussions,
+                                      osmium::io::way_envelopes way_envelopes,
+                                      osmium::io::clean_way_nodes clean_way_nodes,
+                                      std::atomic<std::uint64_t>* duplicate_nodes_ptr,
+                                      osmium::io::skip_damaged_blobs skip_damaged_blobs,
+                                      std::atomic<std::uint64_t>* damaged_blobs_ptr,
+                                      const osmium::Box& filter_box,
                                       osmium::io::buffers_type buffers_kind,
-                                      bool want_buffered_pages_removed) {
+                                      std::size_t start_offset,
+                                      bool want_buffered_pages_removed,
+                                      osmium::io::mapped_input use_mapped_input,
+                                      osmium::memory::BufferPool* buffer_pool,
+                                      std::function<bool(const osmium::io::blob_info&)> blob_filter) {
                 std::promise<osmium::io::Header> promise{std::move(header_promise)};
                 osmium::io::detail::parser_arguments args = {
                     pool,
@@ -176,11 +433,49 @@ namespace osmium {
                     offset_ptr,
                     read_which_entities,
                     read_metadata,
+                    read_tags,
+                    read_discussions,
+                    way_envelopes,
+                    clean_way_nodes,
+                    duplicate_nodes_ptr,
+                    skip_damaged_blobs,
+                    damaged_blobs_ptr,
+                    filter_box,
                     buffers_kind,
-                    want_buffered_pages_removed};
+                    start_offset,
+                    want_buffered_pages_removed,
+                    use_mapped_input,
+                    buffer_pool,
+                    std::move(blob_filter)};
                 creator(args)->parse();
             }
 
+            // In synchronous mode no threads were started. The first call
+            // to header() or read() ends up here and runs the whole
+            // pipeline inline: first read and decompress the complete
+            // file into the input queue, then decode it into the osmdata
+            // queue. Both queues are unbounded in this mode, so nothing
+            // blocks.
+            void run_synchronous() {
+                if (m_synchronous != osmium::io::synchronous::yes || m_synchronous_done) {
+                    return;
+                }
+                m_synchronous_done = true;
+
+                m_read_thread_manager.run_inline();
+
+                const int fd_for_parser = m_decompressor->is_real() ? -1 : m_fd;
+                parser_thread(pool(), fd_for_parser, m_creator,
+                              m_input_queue, m_osmdata_queue,
+                              std::move(m_header_promise), &m_offset, m_read_which_entities,
+                              m_read_metadata, m_read_tags, m_read_discussions, m_way_envelopes,
+                              m_clean_way_nodes, &m_duplicate_way_nodes,
+                              m_skip_damaged_blobs, &m_damaged_blobs,
+                              m_filter_box, m_buffers_kind, m_start_offset,
+                              m_decompressor->want_buffered_pages_removed(),
+                              m_use_mapped_input, m_buffer_pool, m_blob_filter);
+            }
+
 #ifndef _WIN32
             /**
              * Fork and execute the given command in the child.
@@ -297,6 +592,52 @@ namespace osmium {
              *      because you will loose the information whether an object
              *      is visible!
              *
+             * * osmium::io::read_tags: Read tags or not. The default is
+             *      osmium::io::read_tags::yes which means that tags are
+             *      read normally. If you set this to
+             *      osmium::io::read_tags::no, objects will have empty tag
+             *      lists, which can speed up the read considerably if you
+             *      are only interested in ids, locations, and topology.
+             *      Currently only the PBF format uses this setting.
+             *
+             * * osmium::io::read_discussions: Read the discussions
+             *      (comments) on changesets or not. The default is
+             *      osmium::io::read_discussions::yes. If you set this to
+             *      osmium::io::read_discussions::no, changesets will have
+             *      empty discussions, which can speed up reading changeset
+             *      dumps considerably if you are only interested in the
+             *      changeset metadata. Only the XML format has discussions.
+             *
+             * * osmium::io::way_envelopes: Store the envelope of every
+             *      way in the way itself while it is decoded. The default
+             *      is osmium::io::way_envelopes::no. With
+             *      osmium::io::way_envelopes::yes, Way::envelope() becomes
+             *      a constant-time lookup instead of a pass over all the
+             *      node locations. Only works for PBF files written with
+             *      the "locations_on_ways" option; ignored for all other
+             *      input.
+             *
+             * * osmium::io::clean_way_nodes: Drop consecutive duplicate
+             *      nodes from way node lists while they are decoded. The
+             *      default is osmium::io::clean_way_nodes::no. The number
+             *      of nodes dropped is reported in stats(). Only
+             *      implemented for the PBF format; ignored for all other
+             *      input.
+             *
+             * * osmium::io::skip_damaged_blobs: Skip over damaged data
+             *      blobs instead of throwing; a broken or truncated blob
+             *      header ends the file early. The default is
+             *      osmium::io::skip_damaged_blobs::no. The number of
+             *      blobs skipped is reported in stats(). Only implemented
+             *      for the PBF format; ignored for all other input.
+             *
+             * * osmium::io::filter_box: Drop all nodes whose location is
+             *      outside the given box while they are decoded. Nodes
+             *      without a valid location are kept, ways and relations
+             *      are not filtered. Only the PBF format supports this.
+             *      Combine with a blob_filter made by
+             *      PBFBlobIndex::box_filter() to also skip whole blobs.
+             *
              * * osmium::io::buffers_type: Fill entities into buffers until
              *      the buffers are full (osmium::io::buffers_type::any) or
              *      only fill entities of the same type into a buffer
@@ -305,6 +646,72 @@ namespace osmium {
              *      use in "single" mode if the input file is not sorted by
              *      type, otherwise this will be rather inefficient.
              *
+             * * osmium::io::coalesce_buffers: Merge decoded buffers into
+             *      buffers of at least this many bytes before read()
+             *      hands them out. Each decode task produces one buffer
+             *      (for PBF roughly one primitive block), so handlers
+             *      doing very little work per object are dominated by
+             *      the per-buffer overhead; larger buffers amortize it.
+             *      The merging copies the data. Combined with
+             *      buffers_type::single the merged buffers still contain
+             *      only one entity type each.
+             *
+             * * osmium::io::start_offset: Start decoding data at the given
+             *      file offset instead of at the beginning of the file. The
+             *      offset must point to the start of a blob, usually it
+             *      comes from a PBFBlobIndex. The file header is still read
+             *      from the beginning of the file. Only the PBF format
+             *      supports this.
+             *
+             * * osmium::io::blob_filter: Callback called for every PBF
+             *      data blob before it is decompressed and decoded. If it
+             *      returns false, the blob is skipped entirely. Use the
+             *      blob offset together with a PBFBlobIndex to skip blobs
+             *      that can't contain anything of interest. Only the PBF
+             *      format supports this.
+             *
+             * * osmium::io::mapped_input: Set this to
+             *      osmium::io::mapped_input::yes to memory-map the input
+             *      file instead of reading it through a read thread. Blob
+             *      data is then handed to the decoder without copying.
+             *      Currently only PBF files read from a real file (not
+             *      stdin, pipes, or URLs) use this; everything else falls
+             *      back to the normal read path.
+             *
+             * * osmium::memory::BufferPool&: Buffer pool the reader should
+             *      draw its buffers from. Release the buffers back to the
+             *      pool when you are done with them and steady-state
+             *      reading will not do any large allocations at all.
+             *      Currently used by the PBF parser only.
+             *
+             * * osmium::io::input_queue_size: Maximum number of blobs of
+             *      raw input data in flight between the read thread and the
+             *      decoder. Overrides the environment variable
+             *      OSMIUM_MAX_INPUT_QUEUE_SIZE.
+             *
+             * * osmium::io::osmdata_queue_size: Maximum number of buffers
+             *      with decoded OSM data in flight between the decoder and
+             *      the thread calling read(). Overrides the environment
+             *      variable OSMIUM_MAX_OSMDATA_QUEUE_SIZE.
+             *
+             * * osmium::io::adaptive_queues: Set this to
+             *      osmium::io::adaptive_queues::yes to let the Reader adapt
+             *      the depth of the decoded-data queue to the observed
+             *      behaviour of the consumer: if read() often has to wait,
+             *      the queue is grown so the decoder can run further ahead,
+             *      if the queue stays full and read() never waits, it is
+             *      shrunk to apply backpressure earlier and save memory.
+             *
+             * * osmium::io::synchronous: Set this to
+             *      osmium::io::synchronous::yes and the Reader will not
+             *      start any threads of its own. The whole file is read
+             *      and decoded inline in the thread that first calls
+             *      header() or read(), later read() calls only hand out
+             *      the already decoded buffers. This removes the per-file
+             *      thread startup cost, which dominates when many small
+             *      files are opened, but it needs memory for the complete
+             *      decoded file, so only use it for small files.
+             *
              * * osmium::thread::Pool&: Reference to a thread pool that should
              *      be used for reading instead of the default pool. Usually
              *      it is okay to use the statically initialized shared
@@ -323,30 +730,34 @@ namespace osmium {
                 m_fd(m_file.buffer() ? -1 : open_input_file_or_url(m_file.filename(), &m_childpid)),
                 m_file_size(m_fd > 2 ? osmium::file_size(m_fd) : 0),
                 m_decompressor(make_decompressor(m_file, m_fd, &m_offset)),
-                m_read_thread_manager(*m_decompressor, m_input_queue),
+                m_read_thread_manager(*m_decompressor, m_input_queue, &m_stats_collector, false),
                 m_osmdata_queue(detail::get_osmdata_queue_size(), "parser_results"),
                 m_osmdata_queue_wrapper(m_osmdata_queue) {
 
                 (void)std::initializer_list<int>{(set_option(args), 0)...};
 
-                if (!m_pool) {
-                    m_pool = &thread::Pool::default_instance();
+                if (m_adaptive_queues == osmium::io::adaptive_queues::yes) {
+                    m_adaptive_last = detail::IOStatsCollector::clock::now();
                 }
 
                 std::promise<osmium::io::Header> header_promise;
                 m_header_future = header_promise.get_future();
+                m_header_promise = std::move(header_promise);
 
                 const auto cpc = osmium::config::clean_page_cache_after_read();
                 if (cpc >= 0) {
                     m_decompressor->set_want_buffered_pages_removed(true);
                 }
 
-                const int fd_for_parser = m_decompressor->is_real() ? -1 : m_fd;
-                m_thread = osmium::thread::thread_handler{parser_thread, std::ref(*m_pool), fd_for_parser, std::ref(m_creator),
-                                                          std::ref(m_input_queue), std::ref(m_osmdata_queue),
-                                                          std::move(header_promise), &m_offset, m_read_which_entities,
-                                                          m_read_metadata, m_buffers_kind,
-                                                          m_decompressor->want_buffered_pages_removed()};
+                if (m_synchronous == osmium::io::synchronous::yes) {
+                    // No threads are started. The queues have to be able
+                    // to hold the complete file, because nothing drains
+                    // them while the pipeline runs inline.
+                    m_input_queue.set_max_size(0);
+                    m_osmdata_queue.set_max_size(0);
+                }
+
+                // No threads are started here, see start_threads().
             }
 
             template <typename... TArgs>
@@ -384,6 +795,17 @@ namespace osmium {
             void close() {
                 m_status = status::closed;
 
+                if (!m_threads_started && !m_synchronous_done) {
+                    // The pipeline never ran, so nothing has closed the
+                    // decompressor (and with it the input file) yet.
+                    m_synchronous_done = true;
+                    try {
+                        m_decompressor->close();
+                    } catch (...) {
+                        // Ignore any exceptions.
+                    }
+                }
+
                 m_read_thread_manager.stop();
 
                 m_osmdata_queue_wrapper.shutdown();
@@ -422,6 +844,8 @@ namespace osmium {
 
                 try {
                     if (m_header_future.valid()) {
+                        run_synchronous();
+                        start_threads();
                         m_header = m_header_future.get();
                     }
                 } catch (...) {
@@ -438,57 +862,149 @@ namespace osmium {
              * end-of-file. After end-of-file all read() calls will throw an
              * osmium::io_error.
              *
+             * If the Reader was constructed with the coalesce_buffers
+             * option, decoded buffers are merged until the target size
+             * is reached before they are handed out.
+             *
              * @returns Buffer.
              * @throws Some form of osmium::io_error if there is an error.
              */
             osmium::memory::Buffer read() {
+                if (m_coalesce_size == 0) {
+                    return read_next();
+                }
+
+                if (m_eof_pending) {
+                    m_eof_pending = false;
+                    return osmium::memory::Buffer{};
+                }
+
                 osmium::memory::Buffer buffer;
+                if (m_coalesce_stash) {
+                    buffer = std::move(m_coalesce_stash);
+                    m_coalesce_stash = osmium::memory::Buffer{};
+                } else {
+                    buffer = read_next();
+                }
 
-                // If there are buffers on the stack, return those first.
-                if (m_back_buffers) {
-                    if (m_back_buffers.has_nested_buffers()) {
-                        buffer = std::move(*m_back_buffers.get_last_nested());
-                    } else {
-                        buffer = std::move(m_back_buffers);
-                        m_back_buffers = osmium::memory::Buffer{};
-                    }
+                if (!buffer || buffer.committed() >= m_coalesce_size) {
                     return buffer;
                 }
 
-                if (m_status != status::okay) {
-                    throw io_error{"Can not read from reader when in status 'closed', 'eof', or 'error'"};
+                osmium::memory::Buffer result{m_coalesce_size, osmium::memory::Buffer::auto_grow::yes};
+                result.add_buffer(buffer);
+                result.commit();
+
+                while (result.committed() < m_coalesce_size) {
+                    osmium::memory::Buffer next = read_next();
+                    if (!next) {
+                        // The end-of-file buffer still has to be handed
+                        // out, by the next call to read().
+                        m_eof_pending = true;
+                        break;
+                    }
+                    if (m_buffers_kind == osmium::io::buffers_type::single &&
+                        next.cbegin()->type() != result.cbegin()->type()) {
+                        m_coalesce_stash = std::move(next);
+                        break;
+                    }
+                    result.add_buffer(next);
+                    result.commit();
                 }
 
-                if (m_read_which_entities == osmium::osm_entity_bits::nothing) {
-                    m_status = status::eof;
-                    return buffer;
+                return result;
+            }
+
+            /**
+             * Result of a try_read() call. Contains either the buffer
+             * read (which is invalid at end-of-file, like with read())
+             * or the message of the error that occurred.
+             */
+            struct read_result {
+
+                osmium::memory::Buffer buffer{};
+                std::string error{};
+
+                /// True if there was no error.
+                explicit operator bool() const noexcept {
+                    return error.empty();
                 }
 
+            }; // struct read_result
+
+            /**
+             * Like read(), but errors are reported in the returned
+             * read_result instead of being thrown, so the calling code
+             * can handle bad input without exception machinery. After an
+             * error the Reader is in the error state, like after a
+             * throwing read(). To skip over damaged parts of PBF files
+             * and keep reading, use the skip_damaged_blobs option
+             * instead, a failed read can not be resumed.
+             */
+            read_result try_read() {
+                read_result result;
                 try {
-                    // m_input_format.read() can return an invalid buffer to signal EOF,
-                    // or a valid buffer with or without data. A valid buffer
-                    // without data is not an error, it just means we have to
-                    // keep getting the next buffer until there is one with data.
-                    while (true) {
-                        buffer = m_osmdata_queue_wrapper.pop();
-                        if (detail::at_end_of_data(buffer)) {
-                            m_status = status::eof;
-                            m_read_thread_manager.close();
-                            return buffer;
-                        }
-                        if (buffer.has_nested_buffers()) {
-                            m_back_buffers = std::move(buffer);
-                            buffer = std::move(*m_back_buffers.get_last_nested());
-                        }
-                        if (buffer.committed() > 0) {
-                            return buffer;
-                        }
+                    result.buffer = read();
+                } catch (const std::exception& e) {
+                    result.error = e.what();
+                    if (result.error.empty()) {
+                        result.error = "unknown error";
                     }
-                } catch (...) {
-                    close();
-                    m_status = status::error;
-                    throw;
                 }
+                return result;
+            }
+
+            /**
+             * Reads the next buffer containing only objects of the given
+             * type from the input (demuxed reading). Buffers of other
+             * types read from the pipeline in the meantime are held back
+             * and handed out by later calls asking for their type, so
+             * every buffer is returned exactly once. An invalid buffer
+             * signals that there are no more objects of this type.
+             *
+             * The Reader must have been constructed with the
+             * osmium::io::buffers_type::single option, otherwise buffers
+             * are not type-homogeneous and this will throw.
+             *
+             * Note that reading a type that comes late in the file (OSM
+             * files are usually ordered nodes, ways, relations) buffers
+             * all data of the earlier types in memory until it is asked
+             * for.
+             *
+             * @param type The entity type wanted. Must be node, way, or
+             *        relation.
+             * @returns Buffer containing only objects of the given type.
+             * @throws Some form of osmium::io_error if there is an error.
+             */
+            osmium::memory::Buffer read(const osmium::item_type type) {
+                assert(type == osmium::item_type::node ||
+                       type == osmium::item_type::way ||
+                       type == osmium::item_type::relation);
+
+                if (m_buffers_kind != osmium::io::buffers_type::single) {
+                    throw io_error{"Demuxed reading needs a Reader with the buffers_type::single option"};
+                }
+
+                auto& queue = m_demux_buffers(type);
+                if (!queue.empty()) {
+                    osmium::memory::Buffer buffer{std::move(queue.front())};
+                    queue.pop();
+                    return buffer;
+                }
+
+                while (!eof()) {
+                    osmium::memory::Buffer buffer = read();
+                    if (!buffer) {
+                        break;
+                    }
+                    const auto buffer_type = buffer.cbegin()->type();
+                    if (buffer_type == type) {
+                        return buffer;
+                    }
+                    m_demux_buffers(buffer_type).push(std::move(buffer));
+                }
+
+                return osmium::memory::Buffer{};
             }
 
             /**
@@ -525,6 +1041,19 @@ namespace osmium {
                 return m_offset;
             }
 
+            /**
+             * Get a snapshot of the I/O statistics collected so far. The
+             * "io" counters cover the read thread (reading and decompressing
+             * the input), the wait time is the time spent blocked in read().
+             * Can be called at any time, also after close().
+             */
+            IOStats stats() const noexcept {
+                IOStats stats = m_stats_collector.get();
+                stats.duplicate_way_nodes = m_duplicate_way_nodes.load(std::memory_order_relaxed);
+                stats.damaged_blobs = m_damaged_blobs.load(std::memory_order_relaxed);
+                return stats;
+            }
+
         }; // class Reader
 
         /**
@@ -548,6 +1077,22 @@ namespace osmium {
             return buffer;
         }
 
+        /**
+         * Read only the header from the given file. This is much cheaper
+         * than constructing a full Reader when all you want is the header:
+         * the file is parsed synchronously in the calling thread without
+         * starting any threads or touching the thread pool, and for PBF
+         * files parsing stops after the OSMHeader blob.
+         */
+        inline osmium::io::Header peek_header(const osmium::io::File& file) {
+            Reader reader{file, osmium::osm_entity_bits::nothing, osmium::io::synchronous::yes};
+            return reader.header();
+        }
+
+        inline osmium::io::Header peek_header(const std::string& filename) {
+            return peek_header(osmium::io::File{filename});
+        }
+
     } // namespace io
 
 } // namespace osmium
@@ -36,20 +36,41 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/input_iterator.hpp>
 #include <osmium/io/reader.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
 #include <osmium/util/progress_bar.hpp>
 
+#include <array>
+#include <chrono>
+#include <cstdint>
+
 namespace osmium {
 
     namespace io {
 
         /**
          * Wraps an osmium::io::Reader and an osmium::ProgressBar into
-         * one handy package.
+         * one handy package. Besides the progress bar it keeps track of
+         * how many entities of each type have been decoded, so callers
+         * can report per-type throughput.
          */
         class ReaderWithProgressBar : public Reader {
 
             ProgressBar m_progress_bar;
 
+            // Number of decoded entities, indexed by item type.
+            std::array<std::uint64_t, 8> m_counts = {{0}};
+
+            std::chrono::steady_clock::time_point m_start_time{std::chrono::steady_clock::now()};
+
+            void count_entities(const osmium::memory::Buffer& buffer) noexcept {
+                for (const auto& item : buffer) {
+                    const auto index = static_cast<std::size_t>(item.type());
+                    if (index < m_counts.size()) {
+                        ++m_counts[index]; // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+                    }
+                }
+            }
+
         public:
 
             /**
@@ -72,6 +93,7 @@ namespace osmium {
             osmium::memory::Buffer read() {
                 auto buffer = Reader::read();
                 if (buffer) {
+                    count_entities(buffer);
                     m_progress_bar.update(offset());
                 } else {
                     m_progress_bar.done();
@@ -84,6 +106,24 @@ namespace osmium {
                 return m_progress_bar;
             }
 
+            /// Number of entities of the given type decoded so far.
+            std::uint64_t count(osmium::item_type type) const noexcept {
+                const auto index = static_cast<std::size_t>(type);
+                return index < m_counts.size() ? m_counts[index] : 0; // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            }
+
+            /**
+             * Average number of entities of the given type decoded per
+             * second since this reader was created.
+             */
+            double entities_per_second(osmium::item_type type) const noexcept {
+                const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - m_start_time};
+                if (elapsed.count() <= 0.0) {
+                    return 0.0;
+                }
+                return static_cast<double>(count(type)) / elapsed.count();
+            }
+
         }; // class ReaderWithProgressBar
 
         inline InputIterator<ReaderWithProgressBar> begin(ReaderWithProgressBar& reader) {
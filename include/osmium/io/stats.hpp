@@ -0,0 +1,149 @@
+#ifndef OSMIUM_IO_STATS_HPP
+#define OSMIUM_IO_STATS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Lightweight I/O statistics of a Reader or Writer. Get a snapshot
+         * with Reader::stats() or Writer::stats() at any time, also while
+         * reading or writing is still going on.
+         *
+         * For a Reader the "io" counters cover the work of the read thread
+         * (reading and decompressing the input), for a Writer the work of
+         * the write thread (compressing and writing the output). The wait
+         * time tells you how long the calling thread was blocked inside
+         * read() waiting for data or inside the write functions handing
+         * data over. Together they show whether a job is bound by the I/O
+         * side or by the processing in between: a large io time with small
+         * wait time means the application is the bottleneck, a large wait
+         * time means the I/O side is.
+         */
+        struct IOStats {
+
+            /// Time the I/O thread spent doing its work in nanoseconds.
+            std::uint64_t io_nanoseconds = 0;
+
+            /// Uncompressed bytes that went through the I/O thread.
+            std::uint64_t io_bytes = 0;
+
+            /// Number of data blocks that went through the I/O thread.
+            std::uint64_t io_blocks = 0;
+
+            /// Time the calling thread was blocked in read()/write() in nanoseconds.
+            std::uint64_t wait_nanoseconds = 0;
+
+            /// Number of buffers handed over by read()/write().
+            std::uint64_t buffers = 0;
+
+            /// Total committed bytes in those buffers.
+            std::uint64_t buffer_bytes = 0;
+
+            /// Number of consecutive duplicate way nodes removed by the
+            /// decoder (see the clean_way_nodes option). Readers only,
+            /// always 0 for a Writer.
+            std::uint64_t duplicate_way_nodes = 0;
+
+            /// Number of damaged data blobs skipped by the decoder (see
+            /// the skip_damaged_blobs option). Readers only, always 0
+            /// for a Writer.
+            std::uint64_t damaged_blobs = 0;
+
+        }; // struct IOStats
+
+        namespace detail {
+
+            /**
+             * Collects the counters for an IOStats snapshot. Counters are
+             * atomic, because they are updated from the I/O thread and the
+             * thread calling read()/write() and can be read at any time.
+             */
+            class IOStatsCollector {
+
+                std::atomic<std::uint64_t> m_io_nanoseconds{0};
+                std::atomic<std::uint64_t> m_io_bytes{0};
+                std::atomic<std::uint64_t> m_io_blocks{0};
+                std::atomic<std::uint64_t> m_wait_nanoseconds{0};
+                std::atomic<std::uint64_t> m_buffers{0};
+                std::atomic<std::uint64_t> m_buffer_bytes{0};
+
+            public:
+
+                using clock = std::chrono::steady_clock;
+
+                static std::uint64_t elapsed_ns(const clock::time_point start) noexcept {
+                    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+                }
+
+                void add_io(const std::uint64_t nanoseconds, const std::uint64_t bytes) noexcept {
+                    m_io_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+                    m_io_bytes.fetch_add(bytes, std::memory_order_relaxed);
+                    m_io_blocks.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                void add_wait(const std::uint64_t nanoseconds) noexcept {
+                    m_wait_nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+                }
+
+                void add_buffer(const std::uint64_t bytes) noexcept {
+                    m_buffers.fetch_add(1, std::memory_order_relaxed);
+                    m_buffer_bytes.fetch_add(bytes, std::memory_order_relaxed);
+                }
+
+                IOStats get() const noexcept {
+                    IOStats stats;
+                    stats.io_nanoseconds   = m_io_nanoseconds.load(std::memory_order_relaxed);
+                    stats.io_bytes         = m_io_bytes.load(std::memory_order_relaxed);
+                    stats.io_blocks        = m_io_blocks.load(std::memory_order_relaxed);
+                    stats.wait_nanoseconds = m_wait_nanoseconds.load(std::memory_order_relaxed);
+                    stats.buffers          = m_buffers.load(std::memory_order_relaxed);
+                    stats.buffer_bytes     = m_buffer_bytes.load(std::memory_order_relaxed);
+                    return stats;
+                }
+
+            }; // class IOStatsCollector
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_STATS_HPP
@@ -0,0 +1,186 @@
+#ifndef OSMIUM_IO_TRIPLE_WRITER_HPP
+#define OSMIUM_IO_TRIPLE_WRITER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/nwr_array.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Writes nodes, ways, and relations to three separate files in a
+         * single pass. Splitting a file by entity type with one Writer
+         * per type and osmium::osm_entity_bits filters needs one read
+         * pass per type; this class demultiplexes each incoming buffer
+         * by item type instead, so one read of the input fills all three
+         * outputs.
+         *
+         * @code
+         * osmium::io::Reader reader{infile};
+         * osmium::io::TripleWriter writer{"nodes.osm.pbf", "ways.osm.pbf",
+         *                                 "relations.osm.pbf",
+         *                                 osmium::io::overwrite::allow};
+         * while (osmium::memory::Buffer buffer = reader.read()) {
+         *     writer(std::move(buffer));
+         * }
+         * writer.close();
+         * reader.close();
+         * @endcode
+         *
+         * The objects are routed through the per-type internal buffers
+         * of the underlying Writers, so every output sees evenly sized
+         * buffers no matter how the types are mixed in the input.
+         * Anything in the input that is not a node, way, or relation
+         * (such as changesets) is ignored.
+         */
+        class TripleWriter {
+
+            osmium::nwr_array<std::unique_ptr<Writer>> m_writers{};
+
+        public:
+
+            /**
+             * Create a TripleWriter. Any additional arguments are passed
+             * on to the constructors of all three underlying Writers, so
+             * the usual Writer options like osmium::io::overwrite::allow
+             * or an osmium::io::Header can be used here.
+             *
+             * @param nodes_file File all the nodes are written to.
+             * @param ways_file File all the ways are written to.
+             * @param relations_file File all the relations are written to.
+             * @param args All further arguments are forwarded to the
+             *             Writer constructors.
+             * @throws Whatever the Writer constructor throws.
+             */
+            template <typename... TArgs>
+            TripleWriter(const osmium::io::File& nodes_file,
+                         const osmium::io::File& ways_file,
+                         const osmium::io::File& relations_file,
+                         TArgs&&... args) {
+                m_writers.nodes().reset(new Writer{nodes_file, args...});
+                m_writers.ways().reset(new Writer{ways_file, args...});
+                m_writers.relations().reset(new Writer{relations_file, args...});
+            }
+
+            template <typename... TArgs>
+            TripleWriter(const std::string& nodes_filename,
+                         const std::string& ways_filename,
+                         const std::string& relations_filename,
+                         TArgs&&... args) :
+                TripleWriter(osmium::io::File{nodes_filename},
+                             osmium::io::File{ways_filename},
+                             osmium::io::File{relations_filename},
+                             std::forward<TArgs>(args)...) {
+            }
+
+            /**
+             * Access the underlying Writer for the given entity type, for
+             * instance to look at its I/O statistics.
+             */
+            Writer& writer(const osmium::item_type type) noexcept {
+                return *m_writers(type);
+            }
+
+            /**
+             * Write an OSM object to the output file for its type.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void operator()(const osmium::OSMObject& object) {
+                (*m_writers(object.type()))(static_cast<const osmium::memory::Item&>(object));
+            }
+
+            /**
+             * Write the contents of a buffer out to the three output
+             * files, each object going to the file for its type. The
+             * buffer is moved into this function and will be in an
+             * undefined moved-from state afterwards.
+             *
+             * @param buffer Buffer that is being written out.
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void operator()(osmium::memory::Buffer&& buffer) {
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    (*this)(object);
+                }
+                buffer = osmium::memory::Buffer{};
+            }
+
+            /**
+             * Flush the internal buffers of all three Writers.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void flush() {
+                for (const auto& writer : m_writers) {
+                    writer->flush();
+                }
+            }
+
+            /**
+             * Flush internal buffers and close all three output files. As
+             * with Writer, call this explicitly instead of relying on the
+             * destructors, because this call might throw an exception
+             * which the destructors will ignore.
+             *
+             * @returns Total number of bytes written to the three files
+             *          (or 0 if it can not be determined).
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            std::size_t close() {
+                std::size_t sum = 0;
+                for (const auto& writer : m_writers) {
+                    sum += writer->close();
+                }
+                return sum;
+            }
+
+        }; // class TripleWriter
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_TRIPLE_WRITER_HPP
@@ -41,8 +41,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/stats.hpp>
 #include <osmium/io/writer_options.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
 #include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
@@ -117,6 +119,10 @@ namespace osmium {
 
             std::future<std::size_t> m_write_future{};
 
+            // Must be declared before m_thread, because the write thread
+            // uses it until it is joined.
+            detail::IOStatsCollector m_stats_collector{};
+
             osmium::thread::thread_handler m_thread{};
 
             // Checking the m_write_future is much more expensive then checking
@@ -133,15 +139,21 @@ namespace osmium {
             // Has the header already bin written to the file?
             bool m_header_written = false;
 
+            // Should incoming buffers be re-chunked through the internal
+            // buffer instead of being passed on as they are?
+            rechunk m_rechunk = rechunk::no;
+
             // This function will run in a separate thread.
             static void write_thread(detail::future_string_queue_type& output_queue,
                                      std::unique_ptr<osmium::io::Compressor>&& compressor,
                                      std::promise<std::size_t>&& write_promise,
-                                     std::atomic_bool* notification) {
+                                     std::atomic_bool* notification,
+                                     detail::IOStatsCollector* stats) {
                 detail::WriteThread write_thread{output_queue,
                                                  std::move(compressor),
                                                  std::move(write_promise),
-                                                 notification};
+                                                 notification,
+                                                 stats};
                 write_thread();
             }
 
@@ -160,7 +172,10 @@ namespace osmium {
                     write_header();
                 }
                 if (buffer && buffer.committed() > 0) {
+                    m_stats_collector.add_buffer(buffer.committed());
+                    const auto start = detail::IOStatsCollector::clock::now();
                     m_output->write_buffer(std::move(buffer));
+                    m_stats_collector.add_wait(detail::IOStatsCollector::elapsed_ns(start));
                 }
             }
 
@@ -177,7 +192,31 @@ namespace osmium {
                     using std::swap;
                     swap(m_buffer, buffer);
 
+                    m_stats_collector.add_buffer(buffer.committed());
+                    const auto start = detail::IOStatsCollector::clock::now();
                     m_output->write_buffer(std::move(buffer));
+                    m_stats_collector.add_wait(detail::IOStatsCollector::elapsed_ns(start));
+                }
+            }
+
+            void add_item(const osmium::memory::Item& item) {
+                if (!m_buffer) {
+                    m_buffer = osmium::memory::Buffer{m_buffer_size,
+                                                      osmium::memory::Buffer::auto_grow::no};
+                }
+                try {
+                    m_buffer.push_back(item);
+                } catch (const osmium::buffer_is_full&) {
+                    do_flush();
+                    m_buffer.push_back(item);
+                }
+            }
+
+            void do_rechunk(const osmium::memory::Buffer& buffer) {
+                if (buffer && buffer.committed() > 0) {
+                    for (const auto& item : buffer) {
+                        add_item(item);
+                    }
                 }
             }
 
@@ -201,13 +240,22 @@ namespace osmium {
                 osmium::io::Header header;
                 overwrite allow_overwrite = overwrite::no;
                 fsync sync = fsync::no;
+                rechunk rechunk_buffers = rechunk::no;
+                std::size_t output_queue_size = 0;
+                std::size_t preallocate = 0;
                 osmium::thread::Pool* pool = nullptr;
+                osmium::memory::BufferPool* buffer_pool = nullptr;
+                std::function<bool(const osmium::OSMEntity&)> filter{};
             };
 
             static void set_option(options_type& options, osmium::thread::Pool& pool) {
                 options.pool = &pool;
             }
 
+            static void set_option(options_type& options, osmium::memory::BufferPool& buffer_pool) {
+                options.buffer_pool = &buffer_pool;
+            }
+
             static void set_option(options_type& options, const osmium::io::Header& header) {
                 options.header = header;
             }
@@ -220,6 +268,22 @@ namespace osmium {
                 options.sync = value;
             }
 
+            static void set_option(options_type& options, rechunk value) {
+                options.rechunk_buffers = value;
+            }
+
+            static void set_option(options_type& options, output_queue_size value) {
+                options.output_queue_size = value.size;
+            }
+
+            static void set_option(options_type& options, preallocated_size value) {
+                options.preallocate = value.size;
+            }
+
+            static void set_option(options_type& options, output_filter value) {
+                options.filter = std::move(value.filter);
+            }
+
             void do_close() {
                 if (m_status == status::okay) {
                     ensure_cleanup([&]() {
@@ -253,6 +317,31 @@ namespace osmium {
              *       before closing it? Can be osmium::io::fsync::yes or
              *       osmium::io::fsync::no (default).
              *
+             * * osmium::io::rechunk: Should incoming buffers be re-chunked
+             *       into blocks of the internal buffer size (settable with
+             *       set_buffer_size()) before they are encoded? Useful when
+             *       the buffers handed to the writer are small or unevenly
+             *       sized. Can be osmium::io::rechunk::yes or
+             *       osmium::io::rechunk::no (default).
+             *
+             * * osmium::io::output_queue_size: Maximum number of encoded
+             *       data blocks in flight between the encoder and the write
+             *       thread. Overrides the environment variable
+             *       OSMIUM_MAX_OUTPUT_QUEUE_SIZE.
+             *
+             * * osmium::io::preallocated_size: Expected size of the output
+             *       file in bytes, passed to the filesystem as a
+             *       preallocation hint when the file is opened. Avoids
+             *       fragmentation when writing large files. The hint does
+             *       not have to be exact; best effort, ignored where
+             *       preallocation is not supported.
+             *
+             * * osmium::io::output_filter: Only write entities for which
+             *       the given predicate returns true. The predicate is
+             *       evaluated during serialization, possibly concurrently
+             *       from several encoding threads, and must be safe to
+             *       call from several threads at the same time.
+             *
              * * osmium::thread::Pool&: Reference to a thread pool that should
              *      be used for writing instead of the default pool. Usually
              *      it is okay to use the statically initialized shared
@@ -260,6 +349,13 @@ namespace osmium {
              *      For instance when your program will fork, using the
              *      statically initialized pool will not work.
              *
+             * * osmium::memory::BufferPool&: Buffer pool that buffers handed
+             *      to the writer are released into after the encoder has
+             *      consumed them. Acquire the buffers you fill from the same
+             *      pool and their memory is recycled instead of being
+             *      allocated and freed for every buffer. The pool must stay
+             *      alive at least until close() has returned.
+             *
              * @throws osmium::io_error If there was an error.
              * @throws std::system_error If the file could not be opened.
              */
@@ -276,17 +372,33 @@ namespace osmium {
                 }
 
                 m_header = options.header;
+                m_rechunk = options.rechunk_buffers;
+
+                if (options.output_queue_size > 0) {
+                    m_output_queue.set_max_size(options.output_queue_size);
+                }
 
                 m_output = osmium::io::detail::OutputFormatFactory::instance().create_output(*options.pool, m_file, m_output_queue);
+                if (options.buffer_pool) {
+                    m_output->set_buffer_pool(options.buffer_pool);
+                }
+                if (options.filter) {
+                    m_output->set_filter(std::move(options.filter));
+                }
+
+                const int fd = osmium::io::detail::open_for_writing(m_file.filename(), options.allow_overwrite);
+                if (options.preallocate > 0) {
+                    osmium::io::detail::preallocate_file_space(fd, options.preallocate);
+                }
 
                 std::unique_ptr<osmium::io::Compressor> compressor =
                     CompressionFactory::instance().create_compressor(file.compression(),
-                                                                     osmium::io::detail::open_for_writing(m_file.filename(), options.allow_overwrite),
+                                                                     fd,
                                                                      options.sync);
 
                 std::promise<std::size_t> write_promise;
                 m_write_future = write_promise.get_future();
-                m_thread = osmium::thread::thread_handler{write_thread, std::ref(m_output_queue), std::move(compressor), std::move(write_promise), &m_notification};
+                m_thread = osmium::thread::thread_handler{write_thread, std::ref(m_output_queue), std::move(compressor), std::move(write_promise), &m_notification, &m_stats_collector};
             }
 
             template <typename... TArgs>
@@ -356,13 +468,28 @@ namespace osmium {
              * moved into this function and will be in an undefined moved-from
              * state afterwards.
              *
+             * The buffer memory is never copied on the way to the encoder:
+             * it is moved into the encoding task and referenced there until
+             * the encoder has consumed it. If the writer was constructed
+             * with an osmium::memory::BufferPool&, the buffer is released
+             * into that pool afterwards, otherwise it is destroyed.
+             *
+             * If the writer was constructed with osmium::io::rechunk::yes,
+             * the items are copied into the internal buffer instead and only
+             * written out whenever it is full, so the size of the incoming
+             * buffers does not determine the size of the encoded blocks.
+             *
              * @param buffer Buffer that is being written out.
              * @throws Some form of osmium::io_error when there is a problem.
              */
             void operator()(osmium::memory::Buffer&& buffer) {
                 ensure_cleanup([&]() {
-                    do_flush();
-                    do_write(std::move(buffer));
+                    if (m_rechunk == rechunk::yes) {
+                        do_rechunk(buffer);
+                    } else {
+                        do_flush();
+                        do_write(std::move(buffer));
+                    }
                 });
             }
 
@@ -375,16 +502,7 @@ namespace osmium {
              */
             void operator()(const osmium::memory::Item& item) {
                 ensure_cleanup([&]() {
-                    if (!m_buffer) {
-                        m_buffer = osmium::memory::Buffer{m_buffer_size,
-                                                          osmium::memory::Buffer::auto_grow::no};
-                    }
-                    try {
-                        m_buffer.push_back(item);
-                    } catch (const osmium::buffer_is_full&) {
-                        do_flush();
-                        m_buffer.push_back(item);
-                    }
+                    add_item(item);
                 });
             }
 
@@ -409,6 +527,17 @@ namespace osmium {
                 return 0;
             }
 
+            /**
+             * Get a snapshot of the I/O statistics collected so far. The
+             * "io" counters cover the write thread (compressing and writing
+             * the output), the wait time is the time spent handing buffers
+             * over to the output pipeline. Can be called at any time, also
+             * after close().
+             */
+            IOStats stats() const noexcept {
+                return m_stats_collector.get();
+            }
+
         }; // class Writer
 
     } // namespace io
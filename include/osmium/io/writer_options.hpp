@@ -33,6 +33,12 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/fwd.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
 namespace osmium {
 
     namespace io {
@@ -53,6 +59,70 @@ namespace osmium {
             yes = true
         };
 
+        /**
+         * Should the writer re-chunk incoming buffers into blocks of its
+         * internal buffer size before encoding them? This copies the data
+         * once, but small or unevenly sized buffers then no longer lead to
+         * small encoding work units and, for formats with per-block
+         * compression, badly compressing blocks.
+         */
+        enum class rechunk : bool {
+            no  = false,
+            yes = true
+        };
+
+        /**
+         * Maximum number of encoded data blocks in flight between the
+         * encoder and the write thread. Overrides the environment variable
+         * OSMIUM_MAX_OUTPUT_QUEUE_SIZE.
+         */
+        struct output_queue_size {
+
+            std::size_t size;
+
+            explicit output_queue_size(std::size_t value) noexcept :
+                size(value) {
+            }
+
+        };
+
+        /**
+         * Expected size of the output file in bytes. The writer passes
+         * this to the filesystem as a preallocation hint when it opens
+         * the file, so the filesystem can reserve contiguous space up
+         * front instead of growing the file in small, badly fragmented
+         * extents. The hint does not have to be exact, the size of the
+         * input file is usually a good guess. Best effort: ignored on
+         * filesystems and platforms without preallocation support.
+         */
+        struct preallocated_size {
+
+            std::size_t size;
+
+            explicit preallocated_size(std::size_t value) noexcept :
+                size(value) {
+            }
+
+        };
+
+        /**
+         * Only write entities for which the given predicate returns true.
+         * The predicate is evaluated while the entities are serialized, so
+         * writing a filtered subset needs no intermediate copy of the
+         * surviving entities into new buffers. The predicate is called
+         * concurrently from the encoding threads and must be safe to call
+         * from several threads at the same time.
+         */
+        struct output_filter {
+
+            std::function<bool(const osmium::OSMEntity&)> filter;
+
+            explicit output_filter(std::function<bool(const osmium::OSMEntity&)> predicate) :
+                filter(std::move(predicate)) {
+            }
+
+        };
+
     } // namespace io
 
 } // namespace osmium
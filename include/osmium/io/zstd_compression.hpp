@@ -0,0 +1,367 @@
+#ifndef OSMIUM_IO_ZSTD_COMPRESSION_HPP
+#define OSMIUM_IO_ZSTD_COMPRESSION_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file if you want to read or write Zstandard-compressed OSM
+ * files. The decompressor transparently handles files consisting of
+ * multiple concatenated zstd frames (as produced, for instance, by
+ * `zstd --rsyncable` or by concatenating compressed files).
+ *
+ * @attention If you include this file, you'll need to link with `libzstd`.
+ */
+
+#include <osmium/io/compression.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file_compression.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/util/file.hpp>
+
+#include <zstd.h>
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when there are problems compressing or
+     * decompressing zstd files.
+     */
+    struct zstd_error : public io_error {
+
+        std::size_t zstd_error_code = 0;
+
+        explicit zstd_error(const std::string& what) :
+            io_error(what) {
+        }
+
+        zstd_error(const std::string& what, const std::size_t error_code) :
+            io_error(what),
+            zstd_error_code(error_code) {
+        }
+
+    }; // struct zstd_error
+
+    namespace io {
+
+        namespace detail {
+
+            [[noreturn]] inline void throw_zstd_error(const char* msg, const std::size_t result) {
+                std::string error{"zstd error: "};
+                error += msg;
+                error += ": ";
+                error += ::ZSTD_getErrorName(result);
+                throw osmium::zstd_error{error, result};
+            }
+
+        } // namespace detail
+
+        class ZstdCompressor final : public Compressor {
+
+            std::size_t m_file_size = 0;
+            int m_fd;
+            ZSTD_CStream* m_cstream;
+            std::string m_output;
+
+            void compress_and_write(ZSTD_inBuffer* in, const ZSTD_EndDirective directive) {
+                std::size_t remaining = 0;
+                do {
+                    ZSTD_outBuffer out{&*m_output.begin(), m_output.size(), 0};
+                    remaining = ::ZSTD_compressStream2(m_cstream, &out, in, directive);
+                    if (ZSTD_isError(remaining)) {
+                        detail::throw_zstd_error("compress failed", remaining);
+                    }
+                    if (out.pos > 0) {
+                        osmium::io::detail::reliable_write(m_fd, m_output.data(), out.pos);
+                    }
+                } while (directive == ZSTD_e_end ? remaining != 0 : in->pos < in->size);
+            }
+
+        public:
+
+            explicit ZstdCompressor(const int fd, const fsync sync) :
+                Compressor(sync),
+                m_fd(fd),
+                m_cstream(::ZSTD_createCStream()),
+                m_output(::ZSTD_CStreamOutSize(), '\0') {
+                if (!m_cstream) {
+                    throw zstd_error{"zstd error: write initialization failed"};
+                }
+            }
+
+            ZstdCompressor(const ZstdCompressor&) = delete;
+            ZstdCompressor& operator=(const ZstdCompressor&) = delete;
+
+            ZstdCompressor(ZstdCompressor&&) = delete;
+            ZstdCompressor& operator=(ZstdCompressor&&) = delete;
+
+            ~ZstdCompressor() noexcept override {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            void write(const std::string& data) override {
+                assert(m_cstream);
+                if (!data.empty()) {
+                    ZSTD_inBuffer in{data.data(), data.size(), 0};
+                    compress_and_write(&in, ZSTD_e_continue);
+                }
+            }
+
+            void close() override {
+                if (m_cstream) {
+                    ZSTD_inBuffer in{nullptr, 0, 0};
+                    compress_and_write(&in, ZSTD_e_end);
+                    ::ZSTD_freeCStream(m_cstream);
+                    m_cstream = nullptr;
+
+                    // Do not sync or close stdout
+                    if (m_fd == 1) {
+                        return;
+                    }
+
+                    m_file_size = osmium::file_size(m_fd);
+
+                    if (do_fsync()) {
+                        osmium::io::detail::reliable_fsync(m_fd);
+                    }
+                    osmium::io::detail::reliable_close(m_fd);
+                }
+            }
+
+            std::size_t file_size() const override {
+                return m_file_size;
+            }
+
+        }; // class ZstdCompressor
+
+        class ZstdDecompressor final : public Decompressor {
+
+            int m_fd;
+            ZSTD_DStream* m_dstream;
+            std::string m_input;
+            ZSTD_inBuffer m_in{nullptr, 0, 0};
+            std::size_t m_raw_offset = 0;
+            bool m_in_frame = false;
+            bool m_stream_end = false;
+
+        public:
+
+            explicit ZstdDecompressor(const int fd) :
+                m_fd(fd),
+                m_dstream(::ZSTD_createDStream()),
+                m_input(osmium::io::Decompressor::input_buffer_size, '\0') {
+                if (!m_dstream) {
+                    try {
+                        osmium::io::detail::reliable_close(fd);
+                    } catch (...) {
+                    }
+                    throw zstd_error{"zstd error: read initialization failed"};
+                }
+            }
+
+            ZstdDecompressor(const ZstdDecompressor&) = delete;
+            ZstdDecompressor& operator=(const ZstdDecompressor&) = delete;
+
+            ZstdDecompressor(ZstdDecompressor&&) = delete;
+            ZstdDecompressor& operator=(ZstdDecompressor&&) = delete;
+
+            ~ZstdDecompressor() noexcept override {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            std::string read() override {
+                assert(m_dstream);
+                if (m_raw_offset > 0 && want_buffered_pages_removed()) {
+                    osmium::io::detail::remove_buffered_pages(m_fd, m_raw_offset);
+                }
+
+                std::string buffer;
+
+                while (!m_stream_end) {
+                    if (m_in.pos == m_in.size) {
+                        const auto nread = osmium::io::detail::reliable_read(m_fd, &*m_input.begin(), static_cast<unsigned int>(m_input.size()));
+                        if (nread == 0) {
+                            if (m_in_frame) {
+                                throw zstd_error{"zstd error: unexpected end of file"};
+                            }
+                            m_stream_end = true;
+                            break;
+                        }
+                        m_raw_offset += static_cast<std::size_t>(nread);
+                        m_in = ZSTD_inBuffer{m_input.data(), static_cast<std::size_t>(nread), 0};
+                    }
+
+                    buffer.resize(osmium::io::Decompressor::input_buffer_size);
+                    ZSTD_outBuffer out{&*buffer.begin(), buffer.size(), 0};
+                    const std::size_t result = ::ZSTD_decompressStream(m_dstream, &out, &m_in);
+                    if (ZSTD_isError(result)) {
+                        detail::throw_zstd_error("read failed", result);
+                    }
+                    // A return value of 0 means a frame is complete. Any
+                    // remaining input starts the next frame on the next
+                    // iteration.
+                    m_in_frame = (result != 0);
+                    buffer.resize(out.pos);
+                    if (out.pos > 0) {
+                        break;
+                    }
+                }
+
+                set_offset(m_raw_offset);
+
+                return buffer;
+            }
+
+            void close() override {
+                if (m_dstream) {
+                    if (want_buffered_pages_removed()) {
+                        osmium::io::detail::remove_buffered_pages(m_fd);
+                    }
+                    ::ZSTD_freeDStream(m_dstream);
+                    m_dstream = nullptr;
+                    osmium::io::detail::reliable_close(m_fd);
+                }
+            }
+
+        }; // class ZstdDecompressor
+
+        class ZstdBufferDecompressor final : public Decompressor {
+
+            const char* m_buffer;
+            std::size_t m_buffer_size;
+            ZSTD_DStream* m_dstream;
+            ZSTD_inBuffer m_in;
+            bool m_in_frame = false;
+
+        public:
+
+            ZstdBufferDecompressor(const char* buffer, const std::size_t size) :
+                m_buffer(buffer),
+                m_buffer_size(size),
+                m_dstream(::ZSTD_createDStream()),
+                m_in(ZSTD_inBuffer{buffer, size, 0}) {
+                if (!m_dstream) {
+                    throw zstd_error{"zstd error: decompression init failed"};
+                }
+            }
+
+            ZstdBufferDecompressor(const ZstdBufferDecompressor&) = delete;
+            ZstdBufferDecompressor& operator=(const ZstdBufferDecompressor&) = delete;
+
+            ZstdBufferDecompressor(ZstdBufferDecompressor&&) = delete;
+            ZstdBufferDecompressor& operator=(ZstdBufferDecompressor&&) = delete;
+
+            ~ZstdBufferDecompressor() noexcept override {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            std::string read() override {
+                std::string output;
+
+                if (m_buffer) {
+                    const std::size_t buffer_size = 10240;
+                    output.resize(buffer_size);
+                    ZSTD_outBuffer out{&*output.begin(), buffer_size, 0};
+                    const std::size_t result = ::ZSTD_decompressStream(m_dstream, &out, &m_in);
+
+                    if (ZSTD_isError(result)) {
+                        m_buffer = nullptr;
+                        m_buffer_size = 0;
+                        detail::throw_zstd_error("decompress failed", result);
+                    }
+
+                    if (m_in.pos == m_in.size && out.pos == 0) {
+                        m_buffer = nullptr;
+                        m_buffer_size = 0;
+                        if (m_in_frame) {
+                            throw zstd_error{"zstd error: unexpected end of data"};
+                        }
+                    } else {
+                        m_in_frame = (result != 0);
+                    }
+
+                    output.resize(out.pos);
+                }
+
+                return output;
+            }
+
+            void close() override {
+                if (m_dstream) {
+                    ::ZSTD_freeDStream(m_dstream);
+                    m_dstream = nullptr;
+                }
+            }
+
+        }; // class ZstdBufferDecompressor
+
+        namespace detail {
+
+            // we want the register_compression() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_zstd_compression = osmium::io::CompressionFactory::instance().register_compression(osmium::io::file_compression::zstd,
+                [](const int fd, const fsync sync) { return new osmium::io::ZstdCompressor{fd, sync}; },
+                [](const int fd) { return new osmium::io::ZstdDecompressor{fd}; },
+                [](const char* buffer, const std::size_t size) { return new osmium::io::ZstdBufferDecompressor{buffer, size}; }
+            );
+
+            // dummy function to silence the unused variable warning from above
+            inline bool get_registered_zstd_compression() noexcept {
+                return registered_zstd_compression;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_ZSTD_COMPRESSION_HPP
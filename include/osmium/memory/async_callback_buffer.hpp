@@ -0,0 +1,277 @@
+#ifndef OSMIUM_MEMORY_ASYNC_CALLBACK_BUFFER_HPP
+#define OSMIUM_MEMORY_ASYNC_CALLBACK_BUFFER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/util.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <utility>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * Like osmium::memory::CallbackBuffer, but the callback runs in its
+         * own thread, so building the next buffer can go on while the last
+         * one is still being processed. Flushed buffers are handed over
+         * through a small bounded queue: when the callback can not keep up,
+         * flushing blocks, which gives you backpressure instead of unbounded
+         * memory growth.
+         *
+         * In addition to the size-based flushing in possibly_flush() you can
+         * set a maximum latency. If the oldest data in the buffer is older
+         * than that, possibly_flush() will flush the buffer even if it is
+         * not full yet. Note that the check happens inside possibly_flush(),
+         * so the latency bound only holds while data keeps arriving.
+         *
+         * If the callback throws, the exception is caught in the callback
+         * thread and rethrown from the next call to flush(), possibly_flush()
+         * or close().
+         *
+         * Call close() when you are done. The destructor will also flush and
+         * join the thread, but it swallows any exception from the callback,
+         * so calling close() explicitly is better.
+         *
+         * Example:
+         * @code
+         *     AsyncCallbackBuffer cb{[&](osmium::memory::Buffer&& buffer) {
+         *         ...handle buffer...
+         *     }};
+         *     osmium::builder::add_node(cb.buffer(), _id(9), ...);
+         *     cb.possibly_flush();
+         *     osmium::builder::add_way(cb.buffer(), _id(27), ...);
+         *     cb.possibly_flush();
+         *     cb.close();
+         * @endcode
+         */
+        class AsyncCallbackBuffer {
+
+        public:
+
+            /// The type for the callback function
+            using callback_func_type = std::function<void(osmium::memory::Buffer&&)>;
+
+        private:
+
+            enum {
+                default_initial_buffer_size = 1024UL * 1024UL
+            };
+
+            enum {
+                default_max_buffer_size = 800UL * 1024UL
+            };
+
+            // One buffer being processed by the callback, one waiting. This
+            // is what makes it double buffering.
+            enum : std::size_t {
+                queue_size = 2
+            };
+
+            osmium::memory::Buffer m_buffer;
+            std::size_t m_initial_buffer_size;
+            std::size_t m_max_buffer_size;
+            std::chrono::milliseconds m_max_latency;
+            std::chrono::steady_clock::time_point m_last_flush;
+            callback_func_type m_callback;
+
+            osmium::thread::Queue<osmium::memory::Buffer> m_queue;
+
+            std::exception_ptr m_exception{};
+            std::atomic<bool> m_has_exception{false};
+
+            std::thread m_thread;
+
+            void run_in_thread() {
+                osmium::thread::set_thread_name("_osmium_cbbuf");
+
+                while (true) {
+                    osmium::memory::Buffer buffer;
+                    m_queue.wait_and_pop(buffer);
+                    if (!buffer) {
+                        break;
+                    }
+                    if (m_has_exception) {
+                        // Drain the queue after an error, the exception
+                        // will be rethrown in the main thread.
+                        continue;
+                    }
+                    try {
+                        m_callback(std::move(buffer));
+                    } catch (...) {
+                        m_exception = std::current_exception();
+                        m_has_exception = true;
+                    }
+                }
+            }
+
+            void check_for_exception() {
+                if (m_has_exception) {
+                    std::rethrow_exception(m_exception);
+                }
+            }
+
+            /**
+             * Return the internal buffer and create a new empty internal one.
+             */
+            osmium::memory::Buffer take_buffer() {
+                osmium::memory::Buffer new_buffer{m_initial_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                using std::swap;
+                swap(new_buffer, m_buffer);
+                return new_buffer;
+            }
+
+        public:
+
+            /**
+             * Construct an AsyncCallbackBuffer. This starts the callback
+             * thread, so unlike with CallbackBuffer the callback function
+             * has to be set here and can not be changed later.
+             *
+             * @param callback The callback function. Must be of type
+             *                 @code void(osmium::memory::Buffer&&) @endcode
+             * @param initial_buffer_size The initial size of newly created
+             *                            internal buffers.
+             * @param max_buffer_size If the buffer grows beyond this size,
+             *                        possibly_flush() will flush it.
+             * @param max_latency If the oldest data in the buffer is older
+             *                    than this, possibly_flush() will flush the
+             *                    buffer even if it is not full. Set to zero
+             *                    (the default) to disable.
+             */
+            explicit AsyncCallbackBuffer(callback_func_type callback,
+                                         std::size_t initial_buffer_size = default_initial_buffer_size,
+                                         std::size_t max_buffer_size = default_max_buffer_size,
+                                         std::chrono::milliseconds max_latency = std::chrono::milliseconds::zero()) :
+                m_buffer(initial_buffer_size, osmium::memory::Buffer::auto_grow::yes),
+                m_initial_buffer_size(initial_buffer_size),
+                m_max_buffer_size(max_buffer_size),
+                m_max_latency(max_latency),
+                m_last_flush(std::chrono::steady_clock::now()),
+                m_callback(std::move(callback)),
+                m_queue(queue_size, "async_callback_buffer"),
+                m_thread(&AsyncCallbackBuffer::run_in_thread, this) {
+            }
+
+            AsyncCallbackBuffer(const AsyncCallbackBuffer&) = delete;
+            AsyncCallbackBuffer& operator=(const AsyncCallbackBuffer&) = delete;
+
+            AsyncCallbackBuffer(AsyncCallbackBuffer&&) = delete;
+            AsyncCallbackBuffer& operator=(AsyncCallbackBuffer&&) = delete;
+
+            ~AsyncCallbackBuffer() noexcept {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /**
+             * Access the internal buffer. This is used to fill the buffer,
+             * the AsyncCallbackBuffer still owns the buffer. Only call this
+             * from the thread that is filling the buffer.
+             */
+            osmium::memory::Buffer& buffer() noexcept {
+                return m_buffer;
+            }
+
+            /**
+             * Flush the internal buffer regardless of how full it is. The
+             * buffer is handed to the callback thread and a new empty
+             * internal one is created. Blocks if the callback thread is
+             * still busy with two earlier buffers.
+             *
+             * This will do nothing if the buffer is empty.
+             *
+             * @throws Whatever the callback threw on an earlier buffer.
+             */
+            void flush() {
+                check_for_exception();
+                if (m_buffer.committed() > 0) {
+                    m_queue.push(take_buffer());
+                }
+                m_last_flush = std::chrono::steady_clock::now();
+            }
+
+            /**
+             * Flush the internal buffer if it contains more than the
+             * max_buffer_size set in the constructor or, if a max_latency
+             * was set, if the oldest data in the buffer is older than that.
+             *
+             * @throws Whatever the callback threw on an earlier buffer.
+             */
+            void possibly_flush() {
+                check_for_exception();
+                if (m_buffer.committed() > m_max_buffer_size) {
+                    flush();
+                } else if (m_max_latency > std::chrono::milliseconds::zero() &&
+                           m_buffer.committed() > 0 &&
+                           std::chrono::steady_clock::now() - m_last_flush >= m_max_latency) {
+                    flush();
+                }
+            }
+
+            /**
+             * Flush the remaining data and wait for the callback thread to
+             * finish with all buffers. Call this when you are done. After
+             * close() the AsyncCallbackBuffer can not be used any more.
+             *
+             * @throws Whatever the callback threw on any buffer.
+             */
+            void close() {
+                if (m_thread.joinable()) {
+                    if (!m_has_exception && m_buffer.committed() > 0) {
+                        m_queue.push(take_buffer());
+                    }
+                    m_queue.push(osmium::memory::Buffer{});
+                    m_thread.join();
+                }
+                check_for_exception();
+            }
+
+        }; // class AsyncCallbackBuffer
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_ASYNC_CALLBACK_BUFFER_HPP
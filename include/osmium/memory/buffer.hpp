@@ -37,10 +37,12 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/memory/item_iterator.hpp>
 #include <osmium/osm/entity.hpp>
 #include <osmium/util/compatibility.hpp>
+#include <osmium/util/memory_mapping.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <functional>
 #include <iterator>
@@ -101,18 +103,88 @@ namespace osmium {
                 internal = 2
             }; // enum class auto_grow
 
+            /**
+             * Annotations saying where the data in a buffer came from and
+             * when it was decoded. The PBF parser fills them in, so a
+             * buffer can be correlated back to its source blob at any
+             * later pipeline stage, for instance when it reaches the
+             * Writer. A default-constructed provenance (everything zero)
+             * means the buffer was not annotated.
+             */
+            struct provenance {
+
+                /// Offset in the source file of the blob this buffer was
+                /// decoded from. Same convention as the offsets in the
+                /// PBFBlobIndex.
+                std::size_t source_offset = 0;
+
+                /// Sequence number of the source blob (0-based, counted
+                /// from the position where decoding started).
+                std::size_t sequence = 0;
+
+                /// Time decoding of this buffer finished, in nanoseconds
+                /// on the std::chrono::steady_clock. Never 0 for an
+                /// annotated buffer.
+                std::uint64_t decoded_at_ns = 0;
+
+                /// True if the annotations were set.
+                explicit operator bool() const noexcept {
+                    return decoded_at_ns != 0;
+                }
+
+            }; // struct provenance
+
+            /// Type of function used to allocate buffer memory.
+            using allocate_function_type = unsigned char* (*)(std::size_t);
+
+            /// Type of function used to free buffer memory again.
+            using deallocate_function_type = void (*)(unsigned char*);
+
+            /**
+             * Deleter for internally managed buffer memory. Calls the
+             * deallocate function the memory was allocated with, or
+             * delete[] if the buffer uses the default allocation through
+             * global new.
+             */
+            struct memory_deleter {
+
+                deallocate_function_type deallocate = nullptr;
+
+                memory_deleter() noexcept = default;
+
+                explicit memory_deleter(deallocate_function_type func) noexcept :
+                    deallocate(func) {
+                }
+
+                void operator()(unsigned char* ptr) const noexcept {
+                    if (deallocate) {
+                        deallocate(ptr);
+                    } else {
+                        delete[] ptr;
+                    }
+                }
+
+            }; // struct memory_deleter
+
+            using memory_ptr = std::unique_ptr<unsigned char[], memory_deleter>;
+
         private:
 
             std::unique_ptr<Buffer> m_next_buffer;
-            std::unique_ptr<unsigned char[]> m_memory{};
+            memory_ptr m_memory{};
+            std::unique_ptr<osmium::util::MemoryMapping> m_mapping{};
+            allocate_function_type m_allocate = nullptr;
             unsigned char* m_data = nullptr;
             std::size_t m_capacity = 0;
+            std::size_t m_reserved_capacity = 0;
             std::size_t m_written = 0;
             std::size_t m_committed = 0;
+            std::size_t m_removed_bytes = 0;
 #ifndef NDEBUG
             uint8_t m_builder_count = 0;
 #endif
             auto_grow m_auto_grow{auto_grow::no};
+            provenance m_provenance{};
 
             static std::size_t calculate_capacity(std::size_t capacity) noexcept {
                 enum {
@@ -126,6 +198,17 @@ namespace osmium {
                 return padded_length(capacity);
             }
 
+            /**
+             * Get new buffer memory of the given size, either from the
+             * configured allocate function or from global new.
+             */
+            memory_ptr allocate_memory(const std::size_t size) const {
+                if (m_allocate) {
+                    return memory_ptr{m_allocate(size), m_memory.get_deleter()};
+                }
+                return memory_ptr{new unsigned char[size]};
+            }
+
             void grow_internal() {
                 assert(m_data && "This must be a valid buffer");
                 if (!m_memory) {
@@ -133,13 +216,18 @@ namespace osmium {
                 }
 
                 std::unique_ptr<Buffer> old{new Buffer{std::move(m_memory), m_capacity, m_committed}};
-                m_memory = std::unique_ptr<unsigned char[]>{new unsigned char[m_capacity]};
+                m_memory = allocate_memory(m_capacity);
                 m_data = m_memory.get();
 
                 m_written -= m_committed;
                 std::copy_n(old->data() + m_committed, m_written, m_data);
                 m_committed = 0;
 
+                // The removed bytes belong to the committed data which is
+                // now in the nested buffer.
+                old->m_removed_bytes = m_removed_bytes;
+                m_removed_bytes = 0;
+
                 old->m_next_buffer = std::move(m_next_buffer);
                 m_next_buffer = std::move(old);
             }
@@ -218,6 +306,21 @@ namespace osmium {
              *         than capacity.
              */
             explicit Buffer(std::unique_ptr<unsigned char[]> data, std::size_t capacity, std::size_t committed) :
+                Buffer(memory_ptr{data.release()}, capacity, committed) {
+            }
+
+            /**
+             * Constructs a valid internally memory-managed buffer with the
+             * given capacity that already contains 'committed' bytes of
+             * data. Same as the constructor taking a plain unique_ptr, but
+             * the memory_ptr carries the deallocate function the memory
+             * was allocated with.
+             *
+             * @throws std::invalid_argument if the capacity or committed isn't
+             *         a multiple of the alignment or if committed is larger
+             *         than capacity.
+             */
+            explicit Buffer(memory_ptr data, std::size_t capacity, std::size_t committed) :
                 m_memory(std::move(data)),
                 m_data(m_memory.get()),
                 m_capacity(capacity),
@@ -253,6 +356,59 @@ namespace osmium {
                 m_auto_grow(auto_grow) {
             }
 
+            /**
+             * Constructs a valid internally memory-managed buffer like the
+             * (capacity, auto_grow) constructor, but gets its memory from
+             * the given allocate function instead of global new and frees
+             * it with the given deallocate function. Memory needed for
+             * growing the buffer comes from the same functions. Use this
+             * to plug in a custom allocator, for instance the per-thread
+             * slab allocator from <osmium/memory/slab_allocator.hpp>, when
+             * many threads create and fill buffers concurrently.
+             *
+             * @param allocate Function returning memory of the requested size.
+             * @param deallocate Matching function freeing that memory again.
+             * @param capacity The (initial) size of the memory for this buffer.
+             *        Actual capacity might be larger due to alignment.
+             * @param auto_grow Should this buffer automatically grow when it
+             *        becomes too small?
+             */
+            explicit Buffer(allocate_function_type allocate, deallocate_function_type deallocate, std::size_t capacity, auto_grow auto_grow = auto_grow::yes) :
+                m_memory(allocate(calculate_capacity(capacity)), memory_deleter{deallocate}),
+                m_allocate(allocate),
+                m_data(m_memory.get()),
+                m_capacity(calculate_capacity(capacity)),
+                m_auto_grow(auto_grow) {
+            }
+
+            /**
+             * Constructs a valid internally memory-managed buffer backed by
+             * an anonymous memory mapping with the given amount of reserved
+             * address space. The buffer starts out with 'capacity' usable
+             * bytes and grows within the reserved range when it runs out of
+             * space. Growing never moves or copies any data, it just allows
+             * more of the reserved range to be used; the operating system
+             * only backs the pages with real memory once they are written
+             * to. Use this for large buffers that grow a lot, such as the
+             * buffers used for assembling areas.
+             *
+             * If more than reserved_capacity bytes are needed, the
+             * buffer_is_full exception is thrown.
+             *
+             * @param capacity The initial usable capacity of the buffer.
+             * @param reserved_capacity Size of the reserved address range
+             *        and maximum size the buffer can grow to. Must not be
+             *        smaller than capacity.
+             * @throws std::system_error if the memory mapping fails.
+             */
+            explicit Buffer(std::size_t capacity, std::size_t reserved_capacity) :
+                m_mapping(new osmium::util::MemoryMapping{calculate_capacity(reserved_capacity), osmium::util::MemoryMapping::mapping_mode::write_private}),
+                m_data(m_mapping->get_addr<unsigned char>()),
+                m_capacity(std::min(calculate_capacity(capacity), calculate_capacity(reserved_capacity))),
+                m_reserved_capacity(calculate_capacity(reserved_capacity)),
+                m_auto_grow(auto_grow::yes) {
+            }
+
             // buffers can not be copied
             Buffer(const Buffer&) = delete;
             Buffer& operator=(const Buffer&) = delete;
@@ -261,18 +417,27 @@ namespace osmium {
             Buffer(Buffer&& other) noexcept :
                 m_next_buffer(std::move(other.m_next_buffer)),
                 m_memory(std::move(other.m_memory)),
+                m_mapping(std::move(other.m_mapping)),
+                m_allocate(other.m_allocate),
                 m_data(other.m_data),
                 m_capacity(other.m_capacity),
                 m_written(other.m_written),
                 m_committed(other.m_committed),
+                m_removed_bytes(other.m_removed_bytes),
 #ifndef NDEBUG
                 m_builder_count(other.m_builder_count),
 #endif
-                m_auto_grow(other.m_auto_grow) {
+                m_auto_grow(other.m_auto_grow),
+                m_provenance(other.m_provenance) {
+                m_reserved_capacity = other.m_reserved_capacity;
+                other.m_provenance = provenance{};
+                other.m_allocate = nullptr;
                 other.m_data = nullptr;
                 other.m_capacity = 0;
+                other.m_reserved_capacity = 0;
                 other.m_written = 0;
                 other.m_committed = 0;
+                other.m_removed_bytes = 0;
 #ifndef NDEBUG
                 other.m_builder_count = 0;
 #endif
@@ -281,18 +446,27 @@ namespace osmium {
             Buffer& operator=(Buffer&& other) noexcept {
                 m_next_buffer = std::move(other.m_next_buffer);
                 m_memory = std::move(other.m_memory);
+                m_mapping = std::move(other.m_mapping);
+                m_allocate = other.m_allocate;
                 m_data = other.m_data;
                 m_capacity = other.m_capacity;
+                m_reserved_capacity = other.m_reserved_capacity;
                 m_written = other.m_written;
                 m_committed = other.m_committed;
+                m_removed_bytes = other.m_removed_bytes;
 #ifndef NDEBUG
                 m_builder_count = other.m_builder_count;
 #endif
                 m_auto_grow = other.m_auto_grow;
+                m_provenance = other.m_provenance;
+                other.m_provenance = provenance{};
+                other.m_allocate = nullptr;
                 other.m_data = nullptr;
                 other.m_capacity = 0;
+                other.m_reserved_capacity = 0;
                 other.m_written = 0;
                 other.m_committed = 0;
+                other.m_removed_bytes = 0;
 #ifndef NDEBUG
                 other.m_builder_count = 0;
 #endif
@@ -334,6 +508,29 @@ namespace osmium {
                 return m_capacity;
             }
 
+            /**
+             * Returns the size of the reserved address range of a buffer
+             * created with the (capacity, reserved_capacity) constructor,
+             * which is also the maximum size the buffer can grow to.
+             * Returns 0 for all other buffers.
+             */
+            std::size_t reserved_capacity() const noexcept {
+                return m_reserved_capacity;
+            }
+
+            /**
+             * Advise the kernel how the memory of this buffer will be
+             * used, for instance osmium::util::memory_advice::willneed
+             * before handing the buffer to a thread on another NUMA node.
+             * Only has an effect for buffers backed by a memory mapping on
+             * systems with madvise(), everywhere else it does nothing.
+             */
+            void advise(const osmium::util::memory_advice advice) const noexcept {
+                if (m_mapping) {
+                    m_mapping->advise(advice);
+                }
+            }
+
             /**
              * Returns the number of bytes already filled in this buffer.
              * Always returns 0 on invalid buffers.
@@ -351,6 +548,72 @@ namespace osmium {
                 return m_written;
             }
 
+            /**
+             * Returns the number of committed bytes used by items marked
+             * as removed through mark_removed() or counted by
+             * update_removed_bytes(). Use this to decide whether calling
+             * purge_removed() is worth it.
+             * Always returns 0 on invalid buffers.
+             */
+            std::size_t removed_bytes() const noexcept {
+                return m_removed_bytes;
+            }
+
+            /**
+             * Returns the number of committed bytes used by items not
+             * marked as removed. This is the amount of data that will be
+             * left after a call to purge_removed().
+             * Always returns 0 on invalid buffers.
+             */
+            std::size_t live_bytes() const noexcept {
+                return m_committed - m_removed_bytes;
+            }
+
+            /**
+             * Mark an item in this buffer as removed and keep track of the
+             * bytes it uses, so removed_bytes() and live_bytes() stay
+             * accurate. Does nothing if the item is already marked as
+             * removed.
+             *
+             * If you set the removed flag on items directly instead, call
+             * update_removed_bytes() before relying on the counters.
+             *
+             * @pre The buffer must be valid and the item must be in the
+             *      committed part of this buffer.
+             */
+            void mark_removed(osmium::memory::Item& item) noexcept {
+                assert(m_data && "This must be a valid buffer");
+                assert(reinterpret_cast<unsigned char*>(&item) >= m_data &&
+                       reinterpret_cast<unsigned char*>(&item) < m_data + m_committed &&
+                       "Item must be in the committed part of this buffer");
+                if (!item.removed()) {
+                    item.set_removed(true);
+                    m_removed_bytes += item.padded_size();
+                }
+            }
+
+            /**
+             * Recalculate the removed-bytes counter by iterating over all
+             * items in the buffer. Call this after items have been marked
+             * as removed directly, for instance by a handler called
+             * through osmium::apply(), to make removed_bytes() and
+             * live_bytes() accurate again.
+             *
+             * Takes time proportional to the number of items in the
+             * buffer.
+             *
+             * @pre The buffer must be valid.
+             */
+            void update_removed_bytes() noexcept {
+                assert(m_data && "This must be a valid buffer");
+                m_removed_bytes = 0;
+                for (const auto& item : *this) {
+                    if (item.removed()) {
+                        m_removed_bytes += item.padded_size();
+                    }
+                }
+            }
+
             /**
              * This tests if the current state of the buffer is aligned
              * properly. Can be used for asserts.
@@ -379,12 +642,24 @@ namespace osmium {
              */
             void grow(std::size_t size) {
                 assert(m_data && "This must be a valid buffer");
+                if (m_mapping) {
+                    // Growing within the reserved address range never
+                    // moves or copies anything.
+                    size = calculate_capacity(size);
+                    if (size > m_reserved_capacity) {
+                        throw osmium::buffer_is_full{};
+                    }
+                    if (m_capacity < size) {
+                        m_capacity = size;
+                    }
+                    return;
+                }
                 if (!m_memory) {
                     throw std::logic_error{"Can't grow Buffer if it doesn't use internal memory management."};
                 }
                 size = calculate_capacity(size);
                 if (m_capacity < size) {
-                    std::unique_ptr<unsigned char[]> memory{new unsigned char[size]};
+                    memory_ptr memory{allocate_memory(size)};
                     std::copy_n(m_memory.get(), m_capacity, memory.get());
                     using std::swap;
                     swap(m_memory, memory);
@@ -418,6 +693,25 @@ namespace osmium {
                 return std::move(buffer->m_next_buffer);
             }
 
+            /**
+             * Append the specified buffer (together with any buffers nested
+             * inside it) at the end of the nested buffer chain. Nested
+             * buffers are handed out most deeply nested first, so the
+             * appended buffer must contain data that comes *before* the
+             * data in this buffer. This allows several buffers created one
+             * after the other to travel through a queue as a single unit.
+             *
+             * @param buffer The buffer to append. Must be valid.
+             */
+            void add_nested_buffer(Buffer&& buffer) {
+                assert(buffer);
+                Buffer* last = this;
+                while (last->m_next_buffer) {
+                    last = last->m_next_buffer.get();
+                }
+                last->m_next_buffer.reset(new Buffer{std::move(buffer)});
+            }
+
             /**
              * Mark currently written bytes in the buffer as committed.
              *
@@ -466,6 +760,7 @@ namespace osmium {
                 const std::size_t num_used_bytes = m_committed;
                 m_written = 0;
                 m_committed = 0;
+                m_removed_bytes = 0;
                 return num_used_bytes;
             }
 
@@ -516,7 +811,7 @@ namespace osmium {
                 assert(m_data && "This must be a valid buffer");
                 // if there's still not enough space, then try growing the buffer.
                 if (m_written + size > m_capacity) {
-                    if (!m_memory || m_auto_grow == auto_grow::no) {
+                    if ((!m_memory && !m_mapping) || m_auto_grow == auto_grow::no) {
                         throw osmium::buffer_is_full{};
                     }
                     if (m_auto_grow == auto_grow::internal && m_committed != 0) {
@@ -528,6 +823,12 @@ namespace osmium {
                         while (m_written + size > new_capacity) {
                             new_capacity *= 2;
                         }
+                        if (m_mapping && new_capacity > m_reserved_capacity) {
+                            if (m_written + size > m_reserved_capacity) {
+                                throw osmium::buffer_is_full{};
+                            }
+                            new_capacity = m_reserved_capacity;
+                        }
                         grow(new_capacity);
                     }
                 }
@@ -536,6 +837,26 @@ namespace osmium {
                 return reserved_space;
             }
 
+            /**
+             * Make sure at least the given number of bytes can be added to
+             * the buffer without it having to grow in between. Unlike
+             * reserve_space() this does not add anything to the buffer, it
+             * only grows the capacity if needed. Call this before building
+             * an object whose total size is known in advance, then all the
+             * appends while building are guaranteed not to grow the buffer.
+             *
+             * @pre The buffer must be valid.
+             *
+             * @param size Number of bytes to make room for.
+             *
+             * @throws osmium::buffer_is_full if the buffer is full and
+             *         isn't auto-growing.
+             */
+            void reserve(const std::size_t size) {
+                reserve_space(size);
+                m_written -= size;
+            }
+
             /**
              * Add an item to the buffer. The size of the item is stored inside
              * the item, so we know how much memory to copy.
@@ -775,16 +1096,41 @@ namespace osmium {
                 return m_data != nullptr;
             }
 
+            /**
+             * Get the provenance annotations of this buffer. They are
+             * default-constructed (and convert to false) unless somebody,
+             * usually the PBF parser, called set_provenance().
+             */
+            const provenance& get_provenance() const noexcept {
+                return m_provenance;
+            }
+
+            /**
+             * Set the provenance annotations of this buffer. Buffers
+             * nested inside it at this point got their data from the same
+             * source, so they get the same annotations.
+             */
+            void set_provenance(const provenance& value) noexcept {
+                for (Buffer* buffer = this; buffer != nullptr; buffer = buffer->m_next_buffer.get()) {
+                    buffer->m_provenance = value;
+                }
+            }
+
             void swap(Buffer& other) {
                 using std::swap;
 
                 swap(m_next_buffer, other.m_next_buffer);
                 swap(m_memory, other.m_memory);
+                swap(m_mapping, other.m_mapping);
+                swap(m_allocate, other.m_allocate);
                 swap(m_data, other.m_data);
                 swap(m_capacity, other.m_capacity);
+                swap(m_reserved_capacity, other.m_reserved_capacity);
                 swap(m_written, other.m_written);
                 swap(m_committed, other.m_committed);
+                swap(m_removed_bytes, other.m_removed_bytes);
                 swap(m_auto_grow, other.m_auto_grow);
+                swap(m_provenance, other.m_provenance);
             }
 
             /**
@@ -834,6 +1180,7 @@ namespace osmium {
                 assert(it_write.data() >= data());
                 m_written = static_cast<std::size_t>(it_write.data() - data());
                 m_committed = m_written;
+                m_removed_bytes = 0;
             }
 
             /**
@@ -870,6 +1217,7 @@ namespace osmium {
                 assert(it_write.data() >= data());
                 m_written = static_cast<std::size_t>(it_write.data() - data());
                 m_committed = m_written;
+                m_removed_bytes = 0;
             }
 
         }; // class Buffer
@@ -878,6 +1226,80 @@ namespace osmium {
             lhs.swap(rhs);
         }
 
+        /**
+         * Scope guard for speculatively building an object in a buffer.
+         *
+         * Construct the guard, then build the object with a builder as
+         * usual. After the builder is destroyed, the object can be
+         * inspected in place with get() and then either kept with
+         * commit() or discarded. If commit() is not called, the
+         * destructor rolls the buffer back, so discarding is the default
+         * and costs nothing however large the object is.
+         *
+         * @code
+         * osmium::memory::CommitGuard guard{buffer};
+         * {
+         *     osmium::builder::WayBuilder builder{buffer};
+         *     // fill in the way...
+         * }
+         * if (want(guard.get<osmium::Way>())) {
+         *     guard.commit();
+         * }
+         * @endcode
+         */
+        class CommitGuard {
+
+            Buffer* m_buffer;
+            bool m_committed = false;
+
+        public:
+
+            explicit CommitGuard(Buffer& buffer) noexcept :
+                m_buffer(&buffer) {
+            }
+
+            CommitGuard(const CommitGuard&) = delete;
+            CommitGuard& operator=(const CommitGuard&) = delete;
+
+            CommitGuard(CommitGuard&&) = delete;
+            CommitGuard& operator=(CommitGuard&&) = delete;
+
+            ~CommitGuard() noexcept {
+                if (!m_committed) {
+                    m_buffer->rollback();
+                }
+            }
+
+            /**
+             * Get the object built since this guard was constructed for
+             * inspection. It is complete but not yet committed, so it is
+             * not visible through the buffer iterators.
+             *
+             * @pre The builder used to build the object must have been
+             *      destroyed.
+             * @pre commit() has not been called yet.
+             */
+            template <typename T>
+            T& get() const {
+                assert(!m_committed);
+                assert(m_buffer->builder_count() == 0 && "Make sure there are no Builder objects still in scope");
+                return m_buffer->get<T>(m_buffer->committed());
+            }
+
+            /**
+             * Keep the object: commit the buffer. Without this call the
+             * destructor discards the object.
+             *
+             * @returns Offset of the committed object in the buffer.
+             */
+            std::size_t commit() {
+                assert(!m_committed);
+                m_committed = true;
+                return m_buffer->commit();
+            }
+
+        }; // class CommitGuard
+
         /**
          * Compare two buffers for equality.
          *
@@ -0,0 +1,156 @@
+#ifndef OSMIUM_MEMORY_BUFFER_POOL_HPP
+#define OSMIUM_MEMORY_BUFFER_POOL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * Thread-safe pool of osmium::memory::Buffer objects.
+         *
+         * Decoding an OSM file allocates one multi-megabyte Buffer per
+         * decoded block which is thrown away once the application is done
+         * with it. When reading large files this adds up to millions of
+         * large allocations. With a BufferPool the application returns
+         * each Buffer to the pool once it is done with it and the reader
+         * re-uses the memory for the next block:
+         *
+         * @code
+         * osmium::memory::BufferPool pool;
+         * osmium::io::Reader reader{"input.osm.pbf", pool};
+         * while (osmium::memory::Buffer buffer = reader.read()) {
+         *     osmium::apply(buffer, handler);
+         *     pool.release(std::move(buffer));
+         * }
+         * @endcode
+         *
+         * Releasing buffers is optional. Buffers that are never released
+         * are simply freed as usual and the pool falls back to allocating
+         * fresh ones.
+         *
+         * All buffers handed out by the pool use
+         * osmium::memory::Buffer::auto_grow::internal, the growth policy
+         * the file readers need.
+         */
+        class BufferPool {
+
+            enum {
+                default_buffer_size = 64UL * 1024UL
+            };
+
+            enum {
+                default_max_pooled_buffers = 64
+            };
+
+            std::vector<osmium::memory::Buffer> m_buffers{};
+            mutable std::mutex m_mutex{};
+            std::size_t m_buffer_size;
+            std::size_t m_max_pooled_buffers;
+
+        public:
+
+            /**
+             * Create a buffer pool.
+             *
+             * @param buffer_size Capacity of the buffers handed out by
+             *        acquire() (when they don't come from a release()d
+             *        buffer of different size).
+             * @param max_pooled_buffers Maximum number of unused buffers
+             *        kept around. Further released buffers are freed.
+             */
+            explicit BufferPool(std::size_t buffer_size = default_buffer_size,
+                                std::size_t max_pooled_buffers = default_max_pooled_buffers) :
+                m_buffer_size(buffer_size),
+                m_max_pooled_buffers(max_pooled_buffers) {
+            }
+
+            /**
+             * Get a buffer from the pool. Allocates a new buffer if the
+             * pool is empty.
+             */
+            osmium::memory::Buffer acquire() {
+                {
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    if (!m_buffers.empty()) {
+                        osmium::memory::Buffer buffer{std::move(m_buffers.back())};
+                        m_buffers.pop_back();
+                        return buffer;
+                    }
+                }
+                return osmium::memory::Buffer{m_buffer_size, osmium::memory::Buffer::auto_grow::internal};
+            }
+
+            /**
+             * Return a buffer to the pool. The buffer is cleared and will
+             * be handed out by a later acquire() call. Invalid buffers,
+             * buffers with nested buffers, and buffers beyond the pool
+             * capacity are simply freed.
+             */
+            void release(osmium::memory::Buffer&& buffer) {
+                if (!buffer || buffer.has_nested_buffers()) {
+                    return;
+                }
+                buffer.clear();
+
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                if (m_buffers.size() < m_max_pooled_buffers) {
+                    m_buffers.push_back(std::move(buffer));
+                }
+            }
+
+            /// The number of unused buffers currently held by the pool.
+            std::size_t size() const {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                return m_buffers.size();
+            }
+
+            std::size_t buffer_size() const noexcept {
+                return m_buffer_size;
+            }
+
+        }; // class BufferPool
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_BUFFER_POOL_HPP
@@ -138,6 +138,11 @@ namespace osmium {
                 return *this;
             }
 
+            Item& set_size(const item_size_type size) noexcept {
+                m_size = size;
+                return *this;
+            }
+
         public:
 
             Item(const Item&) = delete;
@@ -53,6 +53,19 @@ namespace osmium {
                 return T::is_compatible_to(t);
             }
 
+            // Hint to the CPU to load the item header at the specified
+            // address into the cache. Iterating over a buffer walks a
+            // chain of dependent loads (each item header contains the
+            // offset of the next one), so requesting the next header one
+            // step ahead hides some of the memory latency.
+            inline void prefetch_item_header(const void* addr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch(addr, 0, 3);
+#else
+                (void)addr;
+#endif
+            }
+
         } // namespace detail
 
         template <typename TMember>
@@ -104,6 +117,9 @@ namespace osmium {
                 assert(m_data != m_end);
                 m_data = reinterpret_cast<TMember*>(m_data)->next();
                 advance_to_next_item_of_right_type();
+                if (m_data != m_end) {
+                    detail::prefetch_item_header(reinterpret_cast<const TMember*>(m_data)->next());
+                }
                 return *static_cast<ItemIterator<TMember>*>(this);
             }
 
@@ -116,6 +132,9 @@ namespace osmium {
                 assert(m_data);
                 assert(m_data != m_end);
                 m_data = reinterpret_cast<TMember*>(m_data)->next();
+                if (m_data != m_end) {
+                    detail::prefetch_item_header(reinterpret_cast<const TMember*>(m_data)->next());
+                }
                 return *static_cast<ItemIterator<TMember>*>(this);
             }
 
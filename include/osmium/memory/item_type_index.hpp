@@ -0,0 +1,250 @@
+#ifndef OSMIUM_MEMORY_ITEM_TYPE_INDEX_HPP
+#define OSMIUM_MEMORY_ITEM_TYPE_INDEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/entity.hpp>
+#include <osmium/osm/item_type.hpp>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * An index into a Buffer partitioning the items by their type.
+         *
+         * Iterating over, say, only the ways in a mixed buffer with
+         * Buffer::select() has to look at the header of every item in
+         * the buffer to skip the items of other types. That is fine for
+         * a single pass, but when the same buffer is iterated many times,
+         * the skip-scan is paid every time. An ItemTypeIndex scans the
+         * buffer once, stores the offsets of all items partitioned by
+         * type, and then hands out iterators that jump directly from item
+         * to item of one type:
+         *
+         * @code
+         * const osmium::memory::ItemTypeIndex index{buffer};
+         * for (const osmium::Way& way : index.select<osmium::Way>()) {
+         *     ...
+         * }
+         * @endcode
+         *
+         * The index stores byte offsets into the buffer, so it stays
+         * valid when the buffer is moved, but not when items are added
+         * to or removed from the buffer. Build the index after the
+         * buffer is complete.
+         */
+        class ItemTypeIndex {
+
+            enum : std::size_t {
+                num_slots = 5
+            };
+
+            /**
+             * Map an item type to its slot in the offsets array. Types
+             * that can not appear as top-level items in a buffer of OSM
+             * data get the pseudo-slot num_slots and are not indexed.
+             */
+            static constexpr std::size_t slot(const osmium::item_type type) noexcept {
+                return type == osmium::item_type::node      ? 0 :
+                       type == osmium::item_type::way       ? 1 :
+                       type == osmium::item_type::relation  ? 2 :
+                       type == osmium::item_type::area      ? 3 :
+                       type == osmium::item_type::changeset ? 4 :
+                       std::size_t(num_slots);
+            }
+
+            const unsigned char* m_data;
+
+            std::array<std::vector<std::size_t>, num_slots> m_offsets;
+
+        public:
+
+            /**
+             * Iterator over all items of one type in the indexed buffer,
+             * in buffer order.
+             */
+            template <typename T>
+            class iterator {
+
+                static_assert(std::is_base_of<osmium::memory::Item, T>::value, "Template parameter must derive from osmium::memory::Item");
+
+                const unsigned char* m_data;
+                std::vector<std::size_t>::const_iterator m_it;
+
+            public:
+
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = const T;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = value_type*;
+                using reference         = value_type&;
+
+                iterator(const unsigned char* data, std::vector<std::size_t>::const_iterator it) noexcept :
+                    m_data(data),
+                    m_it(it) {
+                }
+
+                iterator& operator++() noexcept {
+                    ++m_it;
+                    return *this;
+                }
+
+                iterator operator++(int) noexcept {
+                    iterator tmp{*this};
+                    ++m_it;
+                    return tmp;
+                }
+
+                bool operator==(const iterator& rhs) const noexcept {
+                    return m_it == rhs.m_it;
+                }
+
+                bool operator!=(const iterator& rhs) const noexcept {
+                    return !(*this == rhs);
+                }
+
+                const T& operator*() const noexcept {
+                    return *reinterpret_cast<const T*>(m_data + *m_it);
+                }
+
+                const T* operator->() const noexcept {
+                    return reinterpret_cast<const T*>(m_data + *m_it);
+                }
+
+            }; // class iterator
+
+            /**
+             * The range of all items of one type in the indexed buffer.
+             */
+            template <typename T>
+            class range {
+
+                const unsigned char* m_data;
+                const std::vector<std::size_t>* m_offsets;
+
+            public:
+
+                range(const unsigned char* data, const std::vector<std::size_t>* offsets) noexcept :
+                    m_data(data),
+                    m_offsets(offsets) {
+                }
+
+                iterator<T> begin() const noexcept {
+                    return iterator<T>{m_data, m_offsets->cbegin()};
+                }
+
+                iterator<T> end() const noexcept {
+                    return iterator<T>{m_data, m_offsets->cend()};
+                }
+
+                iterator<T> cbegin() const noexcept {
+                    return begin();
+                }
+
+                iterator<T> cend() const noexcept {
+                    return end();
+                }
+
+                /**
+                 * Return the number of items in this range.
+                 *
+                 * Complexity: Constant.
+                 */
+                std::size_t size() const noexcept {
+                    return m_offsets->size();
+                }
+
+                /// Is this range empty?
+                bool empty() const noexcept {
+                    return m_offsets->empty();
+                }
+
+            }; // class range
+
+            /**
+             * Build the index for the specified buffer. Scans all items
+             * in the buffer once.
+             *
+             * The buffer must stay alive (and must not be changed) while
+             * the index is used.
+             */
+            explicit ItemTypeIndex(const Buffer& buffer) :
+                m_data(buffer.data()) {
+                for (auto it = buffer.cbegin(); it != buffer.cend(); ++it) {
+                    const std::size_t s = slot(it->type());
+                    if (s < num_slots) {
+                        m_offsets[s].push_back(static_cast<std::size_t>(it.data() - m_data));
+                    }
+                }
+            }
+
+            /**
+             * Get the range of all items of the specified type, in buffer
+             * order. The template parameter must be one of the concrete
+             * item classes that can appear as top-level items in a buffer:
+             * osmium::Node, osmium::Way, osmium::Relation, osmium::Area,
+             * or osmium::Changeset.
+             */
+            template <typename T>
+            range<T> select() const noexcept {
+                static_assert(slot(T::itemtype) < num_slots, "Template parameter must be one of the indexed item classes");
+                return range<T>{m_data, &m_offsets[slot(T::itemtype)]};
+            }
+
+            /**
+             * The number of items of the specified type in the buffer.
+             *
+             * Complexity: Constant.
+             */
+            std::size_t count(const osmium::item_type type) const noexcept {
+                const std::size_t s = slot(type);
+                return s < num_slots ? m_offsets[s].size() : 0;
+            }
+
+        }; // class ItemTypeIndex
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_ITEM_TYPE_INDEX_HPP
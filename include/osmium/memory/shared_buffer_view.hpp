@@ -0,0 +1,188 @@
+#ifndef OSMIUM_MEMORY_SHARED_BUFFER_VIEW_HPP
+#define OSMIUM_MEMORY_SHARED_BUFFER_VIEW_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item_iterator.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * An immutable, reference-counted view on the committed data of a
+         * Buffer. Buffers themselves are move-only, so handing one decoded
+         * buffer to several consumers means copying it. A SharedBufferView
+         * takes ownership of a buffer once and can then be copied cheaply,
+         * all copies sharing the same data block:
+         *
+         * @code
+         * osmium::memory::SharedBufferView view{reader.read()};
+         * for (auto& consumer : consumers) {
+         *     consumer.push(view); // no copy of the buffer data
+         * }
+         * @endcode
+         *
+         * The view gives only const access to the items in the buffer, so
+         * any number of threads can iterate over it concurrently. The
+         * underlying buffer is freed when the last view on it goes away.
+         */
+        class SharedBufferView {
+
+            std::shared_ptr<const Buffer> m_buffer{};
+
+        public:
+
+            template <typename T>
+            using t_const_iterator = osmium::memory::ItemIterator<const T>;
+
+            using const_iterator = t_const_iterator<osmium::OSMEntity>;
+
+            /// Create an invalid view not referencing any buffer.
+            SharedBufferView() noexcept = default;
+
+            /**
+             * Create a view taking ownership of the given buffer. The
+             * buffer must not be changed any more, usually it comes
+             * straight out of a Reader or osmium::apply.
+             */
+            explicit SharedBufferView(Buffer&& buffer) :
+                m_buffer(std::make_shared<const Buffer>(std::move(buffer))) {
+            }
+
+            /**
+             * Is this view valid, ie. does it reference a valid buffer?
+             */
+            explicit operator bool() const noexcept {
+                return m_buffer && *m_buffer;
+            }
+
+            /**
+             * Get a reference to the underlying buffer.
+             *
+             * @pre The view must reference a buffer.
+             */
+            const Buffer& buffer() const noexcept {
+                assert(m_buffer);
+                return *m_buffer;
+            }
+
+            /**
+             * The number of views (including this one) sharing the
+             * underlying buffer. Returns 0 if this view doesn't reference
+             * a buffer.
+             */
+            std::size_t use_count() const noexcept {
+                return static_cast<std::size_t>(m_buffer.use_count());
+            }
+
+            /// See Buffer::committed().
+            std::size_t committed() const noexcept {
+                return m_buffer ? m_buffer->committed() : 0;
+            }
+
+            /// See Buffer::get().
+            template <typename T>
+            const T& get(const std::size_t offset) const {
+                assert(m_buffer);
+                return m_buffer->get<const T>(offset);
+            }
+
+            /**
+             * Get iterator for iterating over all items of type T in the
+             * buffer.
+             */
+            template <typename T>
+            t_const_iterator<T> cbegin() const {
+                assert(m_buffer);
+                return m_buffer->cbegin<T>();
+            }
+
+            const_iterator cbegin() const {
+                return cbegin<osmium::OSMEntity>();
+            }
+
+            /**
+             * Get iterator for end of the items of type T in the buffer.
+             */
+            template <typename T>
+            t_const_iterator<T> cend() const {
+                assert(m_buffer);
+                return m_buffer->cend<T>();
+            }
+
+            const_iterator cend() const {
+                return cend<osmium::OSMEntity>();
+            }
+
+            template <typename T>
+            t_const_iterator<T> begin() const {
+                return cbegin<T>();
+            }
+
+            const_iterator begin() const {
+                return cbegin();
+            }
+
+            template <typename T>
+            t_const_iterator<T> end() const {
+                return cend<T>();
+            }
+
+            const_iterator end() const {
+                return cend();
+            }
+
+            /**
+             * In a range-based for loop, iterate over all items of the
+             * given type in the buffer.
+             */
+            template <typename T>
+            ItemIteratorRange<const T> select() const {
+                assert(m_buffer);
+                return m_buffer->select<T>();
+            }
+
+        }; // class SharedBufferView
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_SHARED_BUFFER_VIEW_HPP
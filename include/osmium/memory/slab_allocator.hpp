@@ -0,0 +1,203 @@
+#ifndef OSMIUM_MEMORY_SLAB_ALLOCATOR_HPP
+#define OSMIUM_MEMORY_SLAB_ALLOCATOR_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * A simple per-thread slab allocator. Every thread carves its
+ * allocations out of a private slab of memory, so allocating never
+ * takes a lock and never contends with other threads the way global
+ * malloc can when many threads allocate at a high rate. Freeing only
+ * touches an atomic reference count and may happen on any thread.
+ *
+ * The allocate/deallocate functions match the function pointer types of
+ * the allocator customization point on osmium::memory::Buffer:
+ *
+ * @code
+ * osmium::memory::Buffer buffer{osmium::memory::slab_allocate,
+ *                               osmium::memory::slab_deallocate,
+ *                               1024};
+ * @endcode
+ *
+ * Memory of a slab is only returned to the system once all allocations
+ * from it have been freed and its thread has moved on to another slab
+ * (or exited). This trades some memory for speed and is meant for
+ * allocations with a limited lifetime, like the buffers travelling
+ * through the osmium::io read and write pipelines.
+ */
+
+#include <osmium/util/memory.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+namespace osmium {
+
+    namespace memory {
+
+        namespace detail {
+
+            /**
+             * A slab of memory that one thread carves its allocations out
+             * of. Reference counted: the owning thread holds one
+             * reference, every live allocation holds another one. The
+             * last reference frees the slab, which can happen on any
+             * thread.
+             */
+            struct slab {
+
+                enum : std::size_t {
+                    // how much room a fresh slab has for allocations
+                    default_payload_size = 1024UL * 1024UL,
+
+                    // every allocation is preceded by a pointer back to
+                    // its slab, padded so allocations stay as aligned as
+                    // they would be coming from global new
+                    allocation_header_size = 16,
+
+                    // payload starts at this offset into the slab memory
+                    payload_offset = (sizeof(std::atomic<std::size_t>) + sizeof(std::size_t) + allocation_header_size - 1) / allocation_header_size * allocation_header_size
+                };
+
+                std::atomic<std::size_t> refcount;
+                std::size_t payload_size;
+
+                static slab* create(const std::size_t payload_size) {
+                    auto* memory = new unsigned char[payload_offset + payload_size];
+                    auto* new_slab = new (memory) slab;
+                    new_slab->refcount.store(1, std::memory_order_relaxed);
+                    new_slab->payload_size = payload_size;
+                    osmium::MemoryAccounting::add(osmium::MemoryAccounting::subsystem::buffers, payload_offset + payload_size);
+                    return new_slab;
+                }
+
+                static void release(slab* the_slab) noexcept {
+                    if (the_slab->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        osmium::MemoryAccounting::sub(osmium::MemoryAccounting::subsystem::buffers, slab::payload_offset + the_slab->payload_size);
+                        delete[] reinterpret_cast<unsigned char*>(the_slab);
+                    }
+                }
+
+                unsigned char* payload() noexcept {
+                    return reinterpret_cast<unsigned char*>(this) + payload_offset;
+                }
+
+            }; // struct slab
+
+            /**
+             * The slab a thread is currently allocating from. Accessed
+             * through instance() which hands out a thread_local object,
+             * so no synchronization is needed for allocating.
+             */
+            class slab_thread_state {
+
+                slab* m_current = nullptr;
+                std::size_t m_offset = 0;
+
+            public:
+
+                slab_thread_state() noexcept = default;
+
+                slab_thread_state(const slab_thread_state&) = delete;
+                slab_thread_state& operator=(const slab_thread_state&) = delete;
+
+                slab_thread_state(slab_thread_state&&) = delete;
+                slab_thread_state& operator=(slab_thread_state&&) = delete;
+
+                ~slab_thread_state() noexcept {
+                    if (m_current) {
+                        slab::release(m_current);
+                    }
+                }
+
+                unsigned char* allocate(const std::size_t size) {
+                    const std::size_t needed = slab::allocation_header_size +
+                                               (size + slab::allocation_header_size - 1) / slab::allocation_header_size * slab::allocation_header_size;
+
+                    if (!m_current || needed > m_current->payload_size - m_offset) {
+                        if (m_current) {
+                            slab::release(m_current);
+                        }
+                        m_current = slab::create(needed > slab::default_payload_size ? needed : static_cast<std::size_t>(slab::default_payload_size));
+                        m_offset = 0;
+                    }
+
+                    unsigned char* header = m_current->payload() + m_offset;
+                    m_offset += needed;
+
+                    m_current->refcount.fetch_add(1, std::memory_order_relaxed);
+                    slab* the_slab = m_current;
+                    std::memcpy(header, &the_slab, sizeof(slab*));
+
+                    return header + slab::allocation_header_size;
+                }
+
+                static slab_thread_state& instance() {
+                    thread_local slab_thread_state state;
+                    return state;
+                }
+
+            }; // class slab_thread_state
+
+        } // namespace detail
+
+        /**
+         * Allocate size bytes from the slab of the calling thread. Never
+         * contends with allocations on other threads. The memory must be
+         * freed with slab_deallocate().
+         */
+        inline unsigned char* slab_allocate(const std::size_t size) {
+            return detail::slab_thread_state::instance().allocate(size);
+        }
+
+        /**
+         * Free memory obtained from slab_allocate(). Can be called from
+         * any thread, not just the one the memory was allocated on.
+         */
+        inline void slab_deallocate(unsigned char* ptr) noexcept {
+            assert(ptr);
+            detail::slab* the_slab = nullptr;
+            std::memcpy(&the_slab, ptr - detail::slab::allocation_header_size, sizeof(detail::slab*));
+            detail::slab::release(the_slab);
+        }
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_SLAB_ALLOCATOR_HPP
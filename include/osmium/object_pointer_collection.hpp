@@ -35,8 +35,11 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/handler.hpp>
 #include <osmium/osm/object.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/sort.hpp>
 
 #include <algorithm>
+#include <cstddef>
 #include <utility>
 #include <vector>
 
@@ -117,6 +120,22 @@ namespace osmium {
             std::stable_sort(m_objects.begin(), m_objects.end(), std::forward<TCompare>(compare));
         }
 
+        /**
+         * Sort objects according to the specified order functor using
+         * multiple threads from the given thread pool. This is a parallel
+         * merge sort: the pointer vector is split into one chunk per
+         * thread, the chunks are sorted in parallel and then merged in
+         * parallel rounds. Like the single-threaded sort() it is stable.
+         *
+         * For small collections this falls back to the single-threaded
+         * sort.
+         */
+        template <typename TCompare>
+        void sort(TCompare&& compare, osmium::thread::Pool& pool) {
+            osmium::thread::parallel_sort(m_objects.begin(), m_objects.end(),
+                                          std::forward<TCompare>(compare), pool);
+        }
+
         /**
          * Make objects unique according to the specified equality functor.
          *
@@ -44,6 +44,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/node_ref_list.hpp> // IWYU pragma: export
 #include <osmium/osm/object.hpp> // IWYU pragma: export
 #include <osmium/osm/relation.hpp> // IWYU pragma: export
+#include <osmium/osm/slim_node.hpp> // IWYU pragma: export
 #include <osmium/osm/timestamp.hpp> // IWYU pragma: export
 #include <osmium/osm/types.hpp> // IWYU pragma: export
 #include <osmium/osm/way.hpp> // IWYU pragma: export
@@ -187,7 +187,9 @@ namespace osmium {
                     case osmium::item_type::relation:
                     case osmium::item_type::area:
                     case osmium::item_type::changeset:
+                    case osmium::item_type::slim_node:
                     case osmium::item_type::way_node_list:
+                    case osmium::item_type::way_envelope:
                     case osmium::item_type::relation_member_list:
                     case osmium::item_type::relation_member_list_with_full_members:
                     case osmium::item_type::changeset_discussion:
@@ -0,0 +1,243 @@
+#ifndef OSMIUM_OSM_COMPRESSED_NODE_REF_LIST_HPP
+#define OSMIUM_OSM_COMPRESSED_NODE_REF_LIST_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node_ref.hpp>
+#include <osmium/osm/node_ref_list.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/delta.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * A compact copy of a NodeRefList. The first node ref and location are
+     * stored absolute, all following ones as zig-zag encoded varint deltas
+     * to their predecessor. Because node refs in a way are usually close
+     * together and so are the locations of neighboring nodes, this is much
+     * smaller than the 16 bytes per NodeRef of the flat representation,
+     * typically by a factor of two to three for ways with locations set.
+     *
+     * Use this when keeping the node refs and locations of many ways around
+     * for a long time, for instance in a rendering cache. It is not a
+     * drop-in replacement for the NodeRefList in the buffer: Access is
+     * sequential through the iterator, operator[] has to decode the list
+     * from the beginning.
+     */
+    class CompressedNodeRefList {
+
+        std::vector<unsigned char> m_data{};
+        std::size_t m_size = 0;
+
+        static uint64_t zigzag_encode(const int64_t value) noexcept {
+            return (static_cast<uint64_t>(value) << 1U) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        static int64_t zigzag_decode(const uint64_t value) noexcept {
+            return static_cast<int64_t>(value >> 1U) ^ -static_cast<int64_t>(value & 1U);
+        }
+
+        void append_varint(uint64_t value) {
+            while (value >= 0x80U) {
+                m_data.push_back(static_cast<unsigned char>(value) | 0x80U);
+                value >>= 7U;
+            }
+            m_data.push_back(static_cast<unsigned char>(value));
+        }
+
+        static uint64_t read_varint(const unsigned char*& data) noexcept {
+            uint64_t value = 0;
+            unsigned int shift = 0;
+            while (*data & 0x80U) {
+                value |= static_cast<uint64_t>(*data++ & 0x7fU) << shift;
+                shift += 7;
+            }
+            value |= static_cast<uint64_t>(*data++) << shift;
+            return value;
+        }
+
+    public:
+
+        class const_iterator {
+
+            const unsigned char* m_data = nullptr;
+            std::size_t m_remaining = 0;
+            osmium::DeltaDecode<osmium::object_id_type> m_ref{};
+            osmium::DeltaDecode<int32_t, int64_t> m_x{};
+            osmium::DeltaDecode<int32_t, int64_t> m_y{};
+            osmium::NodeRef m_current{};
+
+            void decode_next() {
+                const auto ref = m_ref.update(zigzag_decode(read_varint(m_data)));
+                const auto x = m_x.update(zigzag_decode(read_varint(m_data)));
+                const auto y = m_y.update(zigzag_decode(read_varint(m_data)));
+                m_current = osmium::NodeRef{ref, osmium::Location{x, y}};
+            }
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = osmium::NodeRef;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const osmium::NodeRef*;
+            using reference         = const osmium::NodeRef&;
+
+            const_iterator() = default;
+
+            const_iterator(const unsigned char* data, std::size_t count) :
+                m_data(data),
+                m_remaining(count) {
+                if (m_remaining > 0) {
+                    decode_next();
+                }
+            }
+
+            const osmium::NodeRef& operator*() const noexcept {
+                assert(m_remaining > 0);
+                return m_current;
+            }
+
+            const osmium::NodeRef* operator->() const noexcept {
+                assert(m_remaining > 0);
+                return &m_current;
+            }
+
+            const_iterator& operator++() {
+                assert(m_remaining > 0);
+                --m_remaining;
+                if (m_remaining > 0) {
+                    decode_next();
+                }
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator tmp{*this};
+                operator++();
+                return tmp;
+            }
+
+            bool operator==(const const_iterator& rhs) const noexcept {
+                return m_remaining == rhs.m_remaining;
+            }
+
+            bool operator!=(const const_iterator& rhs) const noexcept {
+                return !(*this == rhs);
+            }
+
+        }; // class const_iterator
+
+        using value_type = osmium::NodeRef;
+        using iterator = const_iterator;
+
+        CompressedNodeRefList() = default;
+
+        explicit CompressedNodeRefList(const osmium::NodeRefList& node_refs) {
+            assign(node_refs);
+        }
+
+        /// Replace the contents with a compressed copy of the given list.
+        void assign(const osmium::NodeRefList& node_refs) {
+            m_data.clear();
+            m_size = node_refs.size();
+            m_data.reserve(m_size * 5); // rough guess, vector grows if needed
+
+            osmium::DeltaEncode<osmium::object_id_type> ref;
+            osmium::DeltaEncode<int32_t, int64_t> x;
+            osmium::DeltaEncode<int32_t, int64_t> y;
+            for (const auto& node_ref : node_refs) {
+                append_varint(zigzag_encode(ref.update(node_ref.ref())));
+                append_varint(zigzag_encode(x.update(node_ref.location().x())));
+                append_varint(zigzag_encode(y.update(node_ref.location().y())));
+            }
+        }
+
+        void clear() {
+            m_data.clear();
+            m_data.shrink_to_fit();
+            m_size = 0;
+        }
+
+        bool empty() const noexcept {
+            return m_size == 0;
+        }
+
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        /// Memory used by the compressed data in bytes.
+        std::size_t used_memory() const noexcept {
+            return sizeof(CompressedNodeRefList) + m_data.capacity();
+        }
+
+        const_iterator begin() const noexcept {
+            return {m_data.data(), m_size};
+        }
+
+        const_iterator end() const noexcept {
+            return {};
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+        /**
+         * Get the node ref at the given position. This decodes the list
+         * from the beginning, so it is O(n). Prefer iterating when you
+         * need more than one entry.
+         */
+        osmium::NodeRef operator[](std::size_t n) const noexcept {
+            assert(n < m_size);
+            auto it = begin();
+            std::advance(it, n);
+            return *it;
+        }
+
+    }; // class CompressedNodeRefList
+
+} // namespace osmium
+
+#endif // OSMIUM_OSM_COMPRESSED_NODE_REF_LIST_HPP
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/memory/buffer.hpp>
 #include <osmium/osm/area.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/changeset.hpp>
@@ -261,6 +262,36 @@ namespace osmium {
 
     }; // class CRC
 
+    /**
+     * Update the given CRC from all OSM entities in the buffer in one
+     * pass, in the order they are stored in the buffer. The result is
+     * the same as calling update() for each entity in turn.
+     */
+    template <typename TCRC>
+    void crc_buffer(CRC<TCRC>& crc, const osmium::memory::Buffer& buffer) noexcept {
+        for (auto it = buffer.cbegin(); it != buffer.cend(); ++it) {
+            switch (it->type()) {
+                case osmium::item_type::node:
+                    crc.update(static_cast<const osmium::Node&>(*it));
+                    break;
+                case osmium::item_type::way:
+                    crc.update(static_cast<const osmium::Way&>(*it));
+                    break;
+                case osmium::item_type::relation:
+                    crc.update(static_cast<const osmium::Relation&>(*it));
+                    break;
+                case osmium::item_type::area:
+                    crc.update(static_cast<const osmium::Area&>(*it));
+                    break;
+                case osmium::item_type::changeset:
+                    crc.update(static_cast<const osmium::Changeset&>(*it));
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
 } // namespace osmium
 
 #endif // OSMIUM_OSM_CRC_HPP
@@ -0,0 +1,181 @@
+#ifndef OSMIUM_OSM_CRC_CACHE_HPP
+#define OSMIUM_OSM_CRC_CACHE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/crc.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace osmium {
+
+    /**
+     * Memoizing wrapper around the CRC framework. Checksums of OSM
+     * objects are cached keyed by the object identity (type, id,
+     * version, and timestamp), so asking for the checksum of the same
+     * unchanged object again does not walk its fields and tag list a
+     * second time. Useful when the same objects are checksummed over
+     * and over, for instance in deduplication jobs.
+     *
+     * The cache can not see changes made to an object, so if you mutate
+     * an object without giving it a new version or timestamp, you have
+     * to call invalidate() for it.
+     *
+     * @tparam TCRC A CRC type, see osmium::CRC.
+     */
+    template <typename TCRC>
+    class CRCCache {
+
+    public:
+
+        using checksum_type = decltype(std::declval<TCRC&>().checksum());
+
+    private:
+
+        struct cache_key {
+
+            osmium::object_id_type id;
+            uint32_t timestamp;
+            osmium::object_version_type version;
+            osmium::item_type type;
+
+            bool operator==(const cache_key& other) const noexcept {
+                return id == other.id &&
+                       timestamp == other.timestamp &&
+                       version == other.version &&
+                       type == other.type;
+            }
+
+        }; // struct cache_key
+
+        struct cache_key_hash {
+
+            std::size_t operator()(const cache_key& key) const noexcept {
+                const auto h1 = std::hash<uint64_t>{}(static_cast<uint64_t>(key.id));
+                const auto h2 = std::hash<uint64_t>{}((static_cast<uint64_t>(key.timestamp) << 32U) ^
+                                                      (static_cast<uint64_t>(key.version) << 8U) ^
+                                                       static_cast<uint64_t>(key.type));
+                return h1 ^ (h2 + 0x9e3779b9UL + (h1 << 6U) + (h1 >> 2U));
+            }
+
+        }; // struct cache_key_hash
+
+        std::unordered_map<cache_key, checksum_type, cache_key_hash> m_cache{};
+
+        std::size_t m_hits = 0;
+
+        static cache_key make_key(const osmium::OSMObject& object) noexcept {
+            return cache_key{object.id(),
+                             static_cast<uint32_t>(object.timestamp()),
+                             object.version(),
+                             object.type()};
+        }
+
+        static checksum_type compute(const osmium::OSMObject& object) noexcept {
+            CRC<TCRC> crc;
+            switch (object.type()) {
+                case osmium::item_type::node:
+                    crc.update(static_cast<const osmium::Node&>(object));
+                    break;
+                case osmium::item_type::way:
+                    crc.update(static_cast<const osmium::Way&>(object));
+                    break;
+                case osmium::item_type::relation:
+                    crc.update(static_cast<const osmium::Relation&>(object));
+                    break;
+                case osmium::item_type::area:
+                    crc.update(static_cast<const osmium::Area&>(object));
+                    break;
+                default:
+                    break;
+            }
+            return crc().checksum();
+        }
+
+    public:
+
+        /**
+         * Get the checksum of the object, from the cache if it was
+         * computed before, computing and caching it otherwise. The
+         * checksum is the same as updating a fresh osmium::CRC<TCRC>
+         * from the object.
+         */
+        checksum_type operator()(const osmium::OSMObject& object) {
+            const auto key = make_key(object);
+            const auto it = m_cache.find(key);
+            if (it != m_cache.end()) {
+                ++m_hits;
+                return it->second;
+            }
+            const auto sum = compute(object);
+            m_cache.emplace(key, sum);
+            return sum;
+        }
+
+        /// Remove the cached checksum for this object if there is one.
+        void invalidate(const osmium::OSMObject& object) {
+            m_cache.erase(make_key(object));
+        }
+
+        /// Remove all cached checksums.
+        void clear() {
+            m_cache.clear();
+            m_hits = 0;
+        }
+
+        /// The number of checksums in the cache.
+        std::size_t size() const noexcept {
+            return m_cache.size();
+        }
+
+        /// The number of times a checksum was answered from the cache.
+        std::size_t hits() const noexcept {
+            return m_hits;
+        }
+
+    }; // class CRCCache
+
+} // namespace osmium
+
+#endif // OSMIUM_OSM_CRC_CACHE_HPP
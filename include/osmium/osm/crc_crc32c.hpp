@@ -0,0 +1,188 @@
+#ifndef OSMIUM_OSM_CRC_CRC32C_HPP
+#define OSMIUM_OSM_CRC_CRC32C_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# define OSMIUM_CRC32C_X86
+# include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+# define OSMIUM_CRC32C_ARM
+# include <arm_acle.h>
+#endif
+
+namespace osmium {
+
+    namespace detail {
+
+        /// Lookup table for the software CRC-32C fallback, built on first use.
+        inline const std::array<std::uint32_t, 256>& crc32c_table() noexcept {
+            static const std::array<std::uint32_t, 256> table = []() {
+                std::array<std::uint32_t, 256> t{{}};
+                for (std::uint32_t n = 0; n < 256; ++n) {
+                    std::uint32_t value = n;
+                    for (int i = 0; i < 8; ++i) {
+                        value = (value >> 1U) ^ ((value & 1U) ? 0x82f63b78UL : 0);
+                    }
+                    t[n] = value;
+                }
+                return t;
+            }();
+            return table;
+        }
+
+        inline std::uint32_t crc32c_update_sw(std::uint32_t crc, const unsigned char* data, std::size_t size) noexcept {
+            const auto& table = crc32c_table();
+            while (size-- > 0) {
+                crc = table[(crc ^ *data++) & 0xffU] ^ (crc >> 8U);
+            }
+            return crc;
+        }
+
+#if defined(OSMIUM_CRC32C_X86)
+
+        __attribute__((target("sse4.2")))
+        inline std::uint32_t crc32c_update_hw(std::uint32_t crc, const unsigned char* data, std::size_t size) noexcept {
+            while (size >= 8) {
+                std::uint64_t chunk = 0;
+                std::memcpy(&chunk, data, 8);
+                crc = static_cast<std::uint32_t>(_mm_crc32_u64(crc, chunk));
+                data += 8;
+                size -= 8;
+            }
+            if (size >= 4) {
+                std::uint32_t chunk = 0;
+                std::memcpy(&chunk, data, 4);
+                crc = _mm_crc32_u32(crc, chunk);
+                data += 4;
+                size -= 4;
+            }
+            while (size-- > 0) {
+                crc = _mm_crc32_u8(crc, *data++);
+            }
+            return crc;
+        }
+
+        inline std::uint32_t crc32c_update(std::uint32_t crc, const unsigned char* data, std::size_t size) noexcept {
+            using impl_type = std::uint32_t (*)(std::uint32_t, const unsigned char*, std::size_t);
+            // Runtime CPU dispatch, decided once on first use.
+            static const impl_type impl = __builtin_cpu_supports("sse4.2")
+                                              ? &crc32c_update_hw
+                                              : &crc32c_update_sw;
+            return impl(crc, data, size);
+        }
+
+#elif defined(OSMIUM_CRC32C_ARM)
+
+        inline std::uint32_t crc32c_update(std::uint32_t crc, const unsigned char* data, std::size_t size) noexcept {
+            while (size >= 8) {
+                std::uint64_t chunk = 0;
+                std::memcpy(&chunk, data, 8);
+                crc = __crc32cd(crc, chunk);
+                data += 8;
+                size -= 8;
+            }
+            if (size >= 4) {
+                std::uint32_t chunk = 0;
+                std::memcpy(&chunk, data, 4);
+                crc = __crc32cw(crc, chunk);
+                data += 4;
+                size -= 4;
+            }
+            while (size-- > 0) {
+                crc = __crc32cb(crc, *data++);
+            }
+            return crc;
+        }
+
+#else
+
+        inline std::uint32_t crc32c_update(std::uint32_t crc, const unsigned char* data, std::size_t size) noexcept {
+            return crc32c_update_sw(crc, data, size);
+        }
+
+#endif
+
+    } // namespace detail
+
+    /**
+     * This class is used together with the CRC class to implement a CRC32C
+     * (Castagnoli) checksum using the CRC instructions available on most
+     * x86-64 (SSE4.2) and ARMv8 CPUs. Where these instructions are not
+     * available a software implementation is used.
+     *
+     * Note that CRC32C uses a different polynomial than the CRC32 from
+     * zlib, so the checksums are not comparable to the ones computed with
+     * osmium::CRC_zlib. They are just as good for comparing OSM objects
+     * with each other though, and much faster to compute.
+     *
+     * Usage:
+     *
+     * @code
+     * osmium::CRC<osmium::CRC_crc32c> crc32c;
+     * const osmium::Node& node = ...;
+     * crc32c.update(node);
+     * std::cout << crc32c.checksum() << '\n';
+     * @endcode
+     */
+    class CRC_crc32c {
+
+        std::uint32_t m_state = 0xffffffffUL;
+
+    public:
+
+        void process_byte(const unsigned char byte) noexcept {
+            m_state = detail::crc32c_update(m_state, &byte, 1U);
+        }
+
+        void process_bytes(const void* buffer, std::size_t byte_count) noexcept {
+            m_state = detail::crc32c_update(m_state, reinterpret_cast<const unsigned char*>(buffer), byte_count);
+        }
+
+        unsigned long checksum() const noexcept { // NOLINT(google-runtime-int)
+            return ~m_state & 0xffffffffUL;
+        }
+
+    }; // class CRC_crc32c
+
+} // namespace osmium
+
+#undef OSMIUM_CRC32C_X86
+#undef OSMIUM_CRC32C_ARM
+
+#endif // OSMIUM_OSM_CRC_CRC32C_HPP
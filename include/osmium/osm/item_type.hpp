@@ -50,9 +50,11 @@ namespace osmium {
         relation                               = 0x03,
         area                                   = 0x04,
         changeset                              = 0x05,
+        slim_node                              = 0x06,
         tag_list                               = 0x11,
         way_node_list                          = 0x12,
         relation_member_list                   = 0x13,
+        way_envelope                           = 0x14,
         relation_member_list_with_full_members = 0x23,
         outer_ring                             = 0x40,
         inner_ring                             = 0x41,
@@ -99,12 +101,16 @@ namespace osmium {
                 return item_type::area;
             case 'c':
                 return item_type::changeset;
+            case 's':
+                return item_type::slim_node;
             case 'T':
                 return item_type::tag_list;
             case 'N':
                 return item_type::way_node_list;
             case 'M':
                 return item_type::relation_member_list;
+            case 'E':
+                return item_type::way_envelope;
             case 'F':
                 return item_type::relation_member_list_with_full_members;
             case 'O':
@@ -131,12 +137,16 @@ namespace osmium {
                 return 'a';
             case item_type::changeset:
                 return 'c';
+            case item_type::slim_node:
+                return 's';
             case item_type::tag_list:
                 return 'T';
             case item_type::way_node_list:
                 return 'N';
             case item_type::relation_member_list:
                 return 'M';
+            case item_type::way_envelope:
+                return 'E';
             case item_type::relation_member_list_with_full_members:
                 return 'F';
             case item_type::outer_ring:
@@ -163,12 +173,16 @@ namespace osmium {
                 return "area";
             case item_type::changeset:
                 return "changeset";
+            case item_type::slim_node:
+                return "slim_node";
             case item_type::tag_list:
                 return "tag_list";
             case item_type::way_node_list:
                 return "way_node_list";
             case item_type::relation_member_list:
                 return "relation_member_list";
+            case item_type::way_envelope:
+                return "way_envelope";
             case item_type::relation_member_list_with_full_members:
                 return "relation_member_list_with_full_members";
             case item_type::outer_ring:
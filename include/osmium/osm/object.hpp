@@ -325,6 +325,11 @@ namespace osmium {
             std::memset(data() + sizeof_object(), 0, user_size());
         }
 
+        /// Get the list of tags for this object.
+        TagList& tags() {
+            return osmium::detail::subitem_of_type<TagList>(begin(), end());
+        }
+
         /// Get the list of tags for this object.
         const TagList& tags() const {
             return osmium::detail::subitem_of_type<const TagList>(cbegin(), cend());
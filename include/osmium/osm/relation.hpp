@@ -57,11 +57,30 @@ namespace osmium {
 
         friend class osmium::builder::RelationMemberListBuilder;
 
+        enum : uint16_t {
+            flag_full_member    = 0x01U,
+
+            /**
+             * There is no role string behind this member, m_role_offset
+             * points backwards to the role string of an earlier member
+             * in the same member list. Used by the role-interning option
+             * of the RelationMemberListBuilder.
+             */
+            flag_role_reference = 0x02U
+        };
+
         object_id_type   m_ref;
         item_type        m_type;
         uint16_t         m_flags;
         string_size_type m_role_size = 0;
 
+        /**
+         * For interned roles: backwards byte offset from the start of
+         * this member to the role string. Lives in what was padding at
+         * the end of the struct, so the size doesn't change.
+         */
+        uint16_t         m_role_offset = 0;
+
         unsigned char* endpos() {
             return data() + osmium::memory::padded_length(sizeof(RelationMember) + m_role_size);
         }
@@ -91,6 +110,12 @@ namespace osmium {
             m_role_size = size;
         }
 
+        void set_role_reference(const uint16_t offset) noexcept {
+            m_flags |= flag_role_reference;
+            m_role_offset = offset;
+            m_role_size = 0;
+        }
+
     public:
 
         static constexpr item_type collection_type = item_type::relation_member_list;
@@ -127,10 +152,13 @@ namespace osmium {
         }
 
         bool full_member() const noexcept {
-            return m_flags == 1;
+            return (m_flags & flag_full_member) != 0;
         }
 
         const char* role() const noexcept {
+            if ((m_flags & flag_role_reference) != 0) {
+                return reinterpret_cast<const char*>(data() - m_role_offset);
+            }
             return reinterpret_cast<const char*>(data() + sizeof(RelationMember));
         }
 
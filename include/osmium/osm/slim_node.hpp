@@ -0,0 +1,122 @@
+#ifndef OSMIUM_OSM_SLIM_NODE_HPP
+#define OSMIUM_OSM_SLIM_NODE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+namespace osmium {
+
+    namespace builder {
+        class SlimNodeBuilder;
+    } // namespace builder
+
+    /**
+     * A slimmed-down node item containing only the id and the location,
+     * but none of the metadata (version, timestamp, uid, changeset, user)
+     * and no tags. Use this instead of osmium::Node when a pipeline only
+     * carries id and location between stages, buffers will be several
+     * times smaller.
+     *
+     * A SlimNode lives in an osmium::memory::Buffer like any other item.
+     * Create it with osmium::builder::SlimNodeBuilder or the
+     * osmium::builder::add_slim_node() convenience function. Handlers get
+     * it through their slim_node() callback.
+     *
+     * Note that none of the file input/output formats know about this
+     * type, it is only meant for in-memory buffers.
+     */
+    class SlimNode : public osmium::memory::Item {
+
+        friend class osmium::builder::SlimNodeBuilder;
+
+        osmium::object_id_type m_id = 0;
+        osmium::Location m_location;
+
+        SlimNode() :
+            Item(sizeof(SlimNode), osmium::item_type::slim_node) {
+        }
+
+    public:
+
+        static constexpr osmium::item_type itemtype = osmium::item_type::slim_node;
+
+        constexpr static bool is_compatible_to(osmium::item_type t) noexcept {
+            return t == itemtype;
+        }
+
+        /// Get ID of this node.
+        osmium::object_id_type id() const noexcept {
+            return m_id;
+        }
+
+        /// Get absolute value of the ID of this node.
+        osmium::unsigned_object_id_type positive_id() const noexcept {
+            return static_cast<osmium::unsigned_object_id_type>(m_id < 0 ? -m_id : m_id);
+        }
+
+        /**
+         * Set ID of this node.
+         *
+         * @returns Reference to node to make calls chainable.
+         */
+        SlimNode& set_id(osmium::object_id_type id) noexcept {
+            m_id = id;
+            return *this;
+        }
+
+        /// Get location of this node.
+        osmium::Location location() const noexcept {
+            return m_location;
+        }
+
+        /**
+         * Set location of this node.
+         *
+         * @returns Reference to node to make calls chainable.
+         */
+        SlimNode& set_location(const osmium::Location& location) noexcept {
+            m_location = location;
+            return *this;
+        }
+
+    }; // class SlimNode
+
+    static_assert(sizeof(SlimNode) % osmium::memory::align_bytes == 0, "Class osmium::SlimNode has wrong size to be aligned properly!");
+
+} // namespace osmium
+
+#endif // OSMIUM_OSM_SLIM_NODE_HPP
@@ -39,6 +39,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
 #include <iosfwd>
 #include <iterator>
@@ -47,6 +48,8 @@ namespace osmium {
 
     class Tag : public osmium::memory::detail::ItemHelper {
 
+        friend class TagList;
+
         template <typename TMember>
         friend class osmium::memory::CollectionIterator;
 
@@ -87,6 +90,16 @@ namespace osmium {
             return reinterpret_cast<const char*>(data());
         }
 
+        /**
+         * Get the length of the tag key in bytes (not counting the final
+         * NUL byte).
+         *
+         * Complexity: Linear on the number of characters in the key.
+         */
+        std::size_t key_length() const noexcept {
+            return std::strlen(key());
+        }
+
         /**
          * Get a pointer to the C string containing the tag value.
          *
@@ -96,6 +109,39 @@ namespace osmium {
             return reinterpret_cast<const char*>(after_null(data()));
         }
 
+        /**
+         * Get the length of the tag value in bytes (not counting the final
+         * NUL byte).
+         *
+         * Complexity: Linear on the number of characters in the key and
+         * value.
+         */
+        std::size_t value_length() const noexcept {
+            return std::strlen(value());
+        }
+
+        /**
+         * Change the tag value in place. Because the tags in a tag list
+         * are stored back to back, this is only possible if the new value
+         * has exactly the same length as the old one. Use
+         * TagList::set_value() if the new value might be shorter.
+         *
+         * @param new_value The new value (0-terminated string).
+         * @returns True if the value was changed, false if the lengths
+         *          differ and nothing was done.
+         *
+         * Complexity: Linear on the number of characters in the key and
+         * value.
+         */
+        bool set_value(const char* new_value) noexcept {
+            const std::size_t len = std::strlen(new_value);
+            if (len != value_length()) {
+                return false;
+            }
+            std::memcpy(after_null(data()), new_value, len);
+            return true;
+        }
+
     }; // class Tag
 
     inline bool operator==(const Tag& lhs, const Tag& rhs) noexcept {
@@ -150,6 +196,47 @@ namespace osmium {
             return get_value_by_key(key);
         }
 
+        /**
+         * Get the values for several tag keys in a single walk over the
+         * tag list. Use this instead of calling get_value_by_key() once
+         * per key when several keys are needed from the same object.
+         *
+         * For every key found, the entry in @p values with the same index
+         * is set to the tag value. Entries for keys not found are left
+         * alone, so all entries must be set to nullptr (or some default)
+         * before the call. If a key appears several times in the tag
+         * list, the first occurrence wins. The walk stops as soon as all
+         * keys have been found.
+         *
+         * @param keys Array of @p num_keys 0-terminated key strings.
+         * @param values Array of @p num_keys value pointers, all set to
+         *               nullptr by the caller.
+         * @param num_keys Number of entries in @p keys and @p values.
+         * @returns The number of keys found.
+         *
+         * @pre @code keys != nullptr && values != nullptr @endcode
+         */
+        std::size_t get_values_by_keys(const char* const* keys, const char** values, const std::size_t num_keys) const noexcept {
+            assert(keys);
+            assert(values);
+
+            std::size_t found = 0;
+            for (const Tag& tag : *this) {
+                for (std::size_t n = 0; n < num_keys; ++n) {
+                    if (values[n] == nullptr && !std::strcmp(tag.key(), keys[n])) {
+                        values[n] = tag.value();
+                        ++found;
+                        break;
+                    }
+                }
+                if (found == num_keys) {
+                    break;
+                }
+            }
+
+            return found;
+        }
+
         /**
          * Returns true if the tag with the given key is in the tag list.
          *
@@ -173,6 +260,63 @@ namespace osmium {
             return result != cend() && !std::strcmp(result->value(), value);
         }
 
+        /**
+         * Change the value of the tag with the given key in place,
+         * without rebuilding the object in a new buffer.
+         *
+         * A value of the same length is simply copied over the old one.
+         * A shorter value moves the remaining tags up and shrinks the
+         * tag list, but only when the size of the list in the buffer
+         * (which includes padding) does not change, because the items
+         * following the list can not be moved. So this can fail even
+         * for a shorter value. A longer value never fits.
+         *
+         * @param key Tag key (0-terminated string).
+         * @param new_value The new value (0-terminated string).
+         * @returns True if the value was changed. False if the key was
+         *          not found or the new value does not fit, in which
+         *          case the tag list is unchanged and the object has
+         *          to be rebuilt (or the edit journaled, see
+         *          osmium::tags::TagPatchTable).
+         *
+         * @pre @code key != nullptr && new_value != nullptr @endcode
+         */
+        bool set_value(const char* key, const char* new_value) noexcept {
+            assert(key);
+            assert(new_value);
+            const auto it = std::find_if(begin(), end(), [key](const Tag& tag) {
+                return !std::strcmp(tag.key(), key);
+            });
+            if (it == end()) {
+                return false;
+            }
+
+            Tag& tag = *it;
+            const std::size_t old_len = tag.value_length();
+            const std::size_t new_len = std::strlen(new_value);
+
+            unsigned char* value_pos = Tag::after_null(tag.data());
+            if (new_len == old_len) {
+                std::memcpy(value_pos, new_value, new_len);
+                return true;
+            }
+            if (new_len > old_len) {
+                return false;
+            }
+
+            const auto delta = static_cast<osmium::memory::item_size_type>(old_len - new_len);
+            if (osmium::memory::padded_length(byte_size() - delta) != padded_size()) {
+                return false;
+            }
+
+            std::memcpy(value_pos, new_value, new_len + 1);
+            unsigned char* tail = value_pos + old_len + 1;
+            std::memmove(value_pos + new_len + 1, tail, static_cast<std::size_t>(data() + byte_size() - tail));
+            set_size(byte_size() - delta);
+
+            return true;
+        }
+
     }; // class TagList
 
     static_assert(sizeof(TagList) % osmium::memory::align_bytes == 0, "Class osmium::TagList has wrong size to be aligned properly!");
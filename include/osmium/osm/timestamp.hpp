@@ -33,11 +33,13 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/endian.hpp>
 #include <osmium/util/minmax.hpp> // IWYU pragma: keep
 
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <ctime>
 #include <iosfwd>
 #include <limits>
@@ -79,6 +81,95 @@ namespace osmium {
             out += static_cast<char>('0' + value);
         }
 
+        inline char* add_2digits_to_buffer(const int value, char* out) noexcept {
+            assert(value >= 0 && value <= 99);
+            *out++ = static_cast<char>('0' + value / 10);
+            *out++ = static_cast<char>('0' + value % 10);
+            return out;
+        }
+
+        inline char* add_4digits_to_buffer(int value, char* out) noexcept {
+            assert(value >= 0 && value <= 9999);
+            out = add_2digits_to_buffer(value / 100, out);
+            return add_2digits_to_buffer(value % 100, out);
+        }
+
+        /**
+         * The number of days between 1970-01-01 and the specified date in
+         * the proleptic Gregorian calendar. Branchless except for the
+         * month comparisons. (This is the days_from_civil algorithm from
+         * Howard Hinnant's date library.)
+         */
+        inline int64_t days_from_civil(int64_t year, const int month, const int day) noexcept {
+            year -= month <= 2;
+            const int64_t era = (year >= 0 ? year : year - 399) / 400;
+            const int64_t yoe = year - era * 400;
+            const int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+            const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + doe - 719468;
+        }
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+        /**
+         * Check that all eight bytes in the word are ASCII digits using
+         * SWAR arithmetic, without any branches.
+         */
+        inline bool all_bytes_are_digits(const uint64_t word) noexcept {
+            const uint64_t values = word ^ 0x3030303030303030ULL;
+            return (((values + 0x7676767676767676ULL) | values) &
+                    0x8080808080808080ULL) == 0;
+        }
+
+        /**
+         * Check that the 16 bytes at str have the form "dddd-dd-ddTdd:dd"
+         * (the first 16 characters of an ISO timestamp) without branching
+         * on every character.
+         */
+        inline bool check_iso_timestamp_layout(const char* str) noexcept {
+            uint64_t word0 = 0;
+            uint64_t word1 = 0;
+            std::memcpy(&word0, str, sizeof(word0));
+            std::memcpy(&word1, str + 8, sizeof(word1));
+
+            // check the separator characters exactly...
+            const uint64_t sep_mask0 = (0xFFULL << 32U) | (0xFFULL << 56U);
+            const uint64_t sep_expected0 = (static_cast<uint64_t>('-') << 32U) |
+                                           (static_cast<uint64_t>('-') << 56U);
+            const uint64_t sep_mask1 = (0xFFULL << 16U) | (0xFFULL << 40U);
+            const uint64_t sep_expected1 = (static_cast<uint64_t>('T') << 16U) |
+                                           (static_cast<uint64_t>(':') << 40U);
+
+            // ...and replace them with a digit so the whole words can go
+            // through the all-digits check
+            const uint64_t zeros = static_cast<uint64_t>('0') * 0x0101010101010101ULL;
+            const bool digits_ok = all_bytes_are_digits((word0 & ~sep_mask0) | (zeros & sep_mask0)) &&
+                                   all_bytes_are_digits((word1 & ~sep_mask1) | (zeros & sep_mask1));
+
+            return digits_ok &&
+                   (word0 & sep_mask0) == sep_expected0 &&
+                   (word1 & sep_mask1) == sep_expected1;
+        }
+#else
+        inline bool check_iso_timestamp_layout(const char* str) noexcept {
+            return str[ 0] >= '0' && str[ 0] <= '9' &&
+                   str[ 1] >= '0' && str[ 1] <= '9' &&
+                   str[ 2] >= '0' && str[ 2] <= '9' &&
+                   str[ 3] >= '0' && str[ 3] <= '9' &&
+                   str[ 4] == '-' &&
+                   str[ 5] >= '0' && str[ 5] <= '9' &&
+                   str[ 6] >= '0' && str[ 6] <= '9' &&
+                   str[ 7] == '-' &&
+                   str[ 8] >= '0' && str[ 8] <= '9' &&
+                   str[ 9] >= '0' && str[ 9] <= '9' &&
+                   str[10] == 'T' &&
+                   str[11] >= '0' && str[11] <= '9' &&
+                   str[12] >= '0' && str[12] <= '9' &&
+                   str[13] == ':' &&
+                   str[14] >= '0' && str[14] <= '9' &&
+                   str[15] >= '0' && str[15] <= '9';
+        }
+#endif
+
         inline bool fractional_seconds(const char** s) noexcept {
             const char* str = *s;
 
@@ -108,51 +199,38 @@ namespace osmium {
                 31, 31, 30, 31, 30, 31
             }};
 
-            if (str[ 0] >= '0' && str[ 0] <= '9' &&
-                str[ 1] >= '0' && str[ 1] <= '9' &&
-                str[ 2] >= '0' && str[ 2] <= '9' &&
-                str[ 3] >= '0' && str[ 3] <= '9' &&
-                str[ 4] == '-' &&
-                str[ 5] >= '0' && str[ 5] <= '9' &&
-                str[ 6] >= '0' && str[ 6] <= '9' &&
-                str[ 7] == '-' &&
-                str[ 8] >= '0' && str[ 8] <= '9' &&
-                str[ 9] >= '0' && str[ 9] <= '9' &&
-                str[10] == 'T' &&
-                str[11] >= '0' && str[11] <= '9' &&
-                str[12] >= '0' && str[12] <= '9' &&
-                str[13] == ':' &&
-                str[14] >= '0' && str[14] <= '9' &&
-                str[15] >= '0' && str[15] <= '9' &&
+            // A timestamp is at least 20 characters long, checking this
+            // first makes sure the layout check can read whole words
+            // without looking beyond the end of the string. (The C
+            // standard guarantees memchr() doesn't read further than the
+            // match.)
+            if (std::memchr(str, '\0', 20) == nullptr &&
+                check_iso_timestamp_layout(str) &&
                 str[16] == ':' &&
                 str[17] >= '0' && str[17] <= '9' &&
                 str[18] >= '0' && str[18] <= '9' &&
                 (str[19] == 'Z' || fractional_seconds(s))) {
                 ++(*s);
-                std::tm tm; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-                tm.tm_year = (str[ 0] - '0') * 1000 +
-                             (str[ 1] - '0') *  100 +
-                             (str[ 2] - '0') *   10 +
-                             (str[ 3] - '0')        - 1900;
-                tm.tm_mon  = (str[ 5] - '0') * 10 + (str[ 6] - '0') - 1;
-                tm.tm_mday = (str[ 8] - '0') * 10 + (str[ 9] - '0');
-                tm.tm_hour = (str[11] - '0') * 10 + (str[12] - '0');
-                tm.tm_min  = (str[14] - '0') * 10 + (str[15] - '0');
-                tm.tm_sec  = (str[17] - '0') * 10 + (str[18] - '0');
-                tm.tm_wday = 0;
-                tm.tm_yday = 0;
-                tm.tm_isdst = 0;
-                if (tm.tm_year >= 0 &&
-                    tm.tm_mon  >= 0 && tm.tm_mon  <= 11 &&
-                    tm.tm_mday >= 1 && tm.tm_mday <= mon_lengths[tm.tm_mon] &&
-                    tm.tm_hour >= 0 && tm.tm_hour <= 23 &&
-                    tm.tm_min  >= 0 && tm.tm_min  <= 59 &&
-                    tm.tm_sec  >= 0 && tm.tm_sec  <= 60) {
-#ifndef _WIN32
-                    return timegm(&tm);
-#else
-                    return _mkgmtime(&tm);
-#endif
+                const int year = (str[ 0] - '0') * 1000 +
+                                 (str[ 1] - '0') *  100 +
+                                 (str[ 2] - '0') *   10 +
+                                 (str[ 3] - '0');
+                const int mon  = (str[ 5] - '0') * 10 + (str[ 6] - '0');
+                const int mday = (str[ 8] - '0') * 10 + (str[ 9] - '0');
+                const int hour = (str[11] - '0') * 10 + (str[12] - '0');
+                const int min  = (str[14] - '0') * 10 + (str[15] - '0');
+                const int sec  = (str[17] - '0') * 10 + (str[18] - '0');
+                if (year >= 1900 &&
+                    mon  >= 1 && mon  <= 12 &&
+                    mday >= 1 && mday <= mon_lengths[mon - 1] &&
+                    hour >= 0 && hour <= 23 &&
+                    min  >= 0 && min  <= 59 &&
+                    sec  >= 0 && sec  <= 60) {
+                    // calculating this directly is faster than calling
+                    // timegm() and, unlike the mktime() family, can not
+                    // be disturbed by locale or timezone settings
+                    return static_cast<std::time_t>(days_from_civil(year, mon, mday) * 86400LL +
+                                                    hour * 3600 + min * 60 + sec);
                 }
             }
             throw std::invalid_argument{std::string{"can not parse timestamp: '"} + str + "'"};
@@ -177,35 +255,17 @@ namespace osmium {
         uint32_t m_timestamp = 0;
 
         void to_iso_str(std::string& s) const {
-            std::tm tm; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-            const std::time_t sse = seconds_since_epoch();
-#ifndef NDEBUG
-            auto result =
-#endif
-#ifndef _WIN32
-            gmtime_r(&sse, &tm);
-            assert(result != nullptr);
-#else
-            gmtime_s(&tm, &sse);
-            assert(result == 0);
-#endif
-
-            detail::add_4digit_int_to_string(tm.tm_year + 1900, s);
-            s += '-';
-            detail::add_2digit_int_to_string(tm.tm_mon + 1, s);
-            s += '-';
-            detail::add_2digit_int_to_string(tm.tm_mday, s);
-            s += 'T';
-            detail::add_2digit_int_to_string(tm.tm_hour, s);
-            s += ':';
-            detail::add_2digit_int_to_string(tm.tm_min, s);
-            s += ':';
-            detail::add_2digit_int_to_string(tm.tm_sec, s);
-            s += 'Z';
+            char buffer[20];
+            s.append(buffer, to_iso_all(buffer));
         }
 
     public:
 
+        /// The number of characters to_iso() and to_iso_all() write at most.
+        enum {
+            max_length = 20
+        };
+
         /**
          * Default construct an invalid Timestamp.
          */
@@ -283,6 +343,67 @@ namespace osmium {
             m_timestamp -= time_difference;
         }
 
+        /**
+         * Write the timestamp in ISO date/time ("yyyy-mm-ddThh:mm:ssZ")
+         * format into the specified buffer. The buffer must have room for
+         * at least max_length characters. No null byte is written, use
+         * the returned pointer to find the end of the output. Unlike
+         * to_iso_all() this writes nothing for an invalid timestamp.
+         *
+         * @param buffer Buffer to write into.
+         * @returns Pointer to the character after the output.
+         */
+        char* to_iso(char* buffer) const noexcept {
+            if (m_timestamp == 0) {
+                return buffer;
+            }
+            return to_iso_all(buffer);
+        }
+
+        /**
+         * Write the timestamp in ISO date/time ("yyyy-mm-ddThh:mm:ssZ")
+         * format into the specified buffer. The buffer must have room for
+         * at least max_length characters. No null byte is written, use
+         * the returned pointer to find the end of the output. An invalid
+         * timestamp is written out as "1970-01-01T00:00:00Z".
+         *
+         * This doesn't allocate any memory and doesn't call into the
+         * gmtime() family of functions, the date is calculated directly
+         * (with the civil_from_days algorithm from Howard Hinnant's date
+         * library).
+         *
+         * @param buffer Buffer to write into.
+         * @returns Pointer to the character after the output.
+         */
+        char* to_iso_all(char* buffer) const noexcept {
+            const uint32_t days = m_timestamp / 86400U;
+            const uint32_t secs_of_day = m_timestamp % 86400U;
+
+            const uint32_t z = days + 719468U;
+            const uint32_t era = z / 146097U;
+            const uint32_t doe = z - era * 146097U;
+            const uint32_t yoe = (doe - doe / 1460U + doe / 36524U - doe / 146096U) / 365U;
+            const uint32_t doy = doe - (365U * yoe + yoe / 4U - yoe / 100U);
+            const uint32_t mp = (5U * doy + 2U) / 153U;
+            const uint32_t day = doy - (153U * mp + 2U) / 5U + 1U;
+            const uint32_t month = mp < 10U ? mp + 3U : mp - 9U;
+            const uint32_t year = yoe + era * 400U + (month <= 2U ? 1U : 0U);
+
+            char* out = detail::add_4digits_to_buffer(static_cast<int>(year), buffer);
+            *out++ = '-';
+            out = detail::add_2digits_to_buffer(static_cast<int>(month), out);
+            *out++ = '-';
+            out = detail::add_2digits_to_buffer(static_cast<int>(day), out);
+            *out++ = 'T';
+            out = detail::add_2digits_to_buffer(static_cast<int>(secs_of_day / 3600U), out);
+            *out++ = ':';
+            out = detail::add_2digits_to_buffer(static_cast<int>(secs_of_day / 60U % 60U), out);
+            *out++ = ':';
+            out = detail::add_2digits_to_buffer(static_cast<int>(secs_of_day % 60U), out);
+            *out++ = 'Z';
+            return out;
+        }
+
         /**
          * Return the timestamp as string in ISO date/time
          * ("yyyy-mm-ddThh:mm:ssZ") format. If the timestamp is invalid, an
@@ -36,10 +36,12 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/util/endian.hpp>
 
 #include <cassert>
-#include <cctype>
-#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 #include <string>
@@ -47,6 +49,119 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    namespace detail {
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+        /**
+         * Parse eight ASCII digits at once using SWAR arithmetic.
+         *
+         * @pre All eight bytes at s must be ASCII digits.
+         */
+        inline uint64_t parse_eight_digits(const char* s) noexcept {
+            uint64_t chunk = 0;
+            std::memcpy(&chunk, s, sizeof(chunk));
+            chunk -= 0x3030303030303030ULL;
+            // combine pairs of digits into bytes, then pairs of bytes
+            // into 32 bit halves, then both halves
+            chunk = chunk * 10 + (chunk >> 8U);
+            const uint64_t mask = 0x000000FF000000FFULL;
+            return ((chunk & mask) * 0x000F424000000064ULL +
+                    ((chunk >> 16U) & mask) * 0x0000271000000001ULL) >> 32U;
+        }
+#endif
+
+        /**
+         * Parse the given number of ASCII digits into an integer, in
+         * batches of eight digits where the architecture allows it.
+         *
+         * @pre All num_digits bytes at s must be ASCII digits and the
+         *      result must fit into an uint64_t.
+         */
+        inline uint64_t parse_digits_unchecked(const char* s, std::size_t num_digits) noexcept {
+            uint64_t value = 0;
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            while (num_digits >= 8) {
+                value = value * 100000000 + parse_eight_digits(s);
+                s += 8;
+                num_digits -= 8;
+            }
+#endif
+            while (num_digits > 0) {
+                value = value * 10 + static_cast<uint64_t>(*s - '0');
+                ++s;
+                --num_digits;
+            }
+            return value;
+        }
+
+        /**
+         * Parse an unsigned decimal integer. On success *data points to
+         * the first character after the digits and the parsed value is
+         * stored in value. Returns false, leaving *data unchanged, if
+         * there is no digit at *data or the value doesn't fit into an
+         * uint64_t.
+         */
+        inline bool string_to_unsigned(const char** data, uint64_t& value) noexcept {
+            const char* s = *data;
+            if (*s < '0' || *s > '9') {
+                return false;
+            }
+            const char* e = s;
+            while (*e >= '0' && *e <= '9') {
+                ++e;
+            }
+            const auto num_digits = static_cast<std::size_t>(e - s);
+            if (num_digits <= 19) {
+                // the common case: 19 digits or less can not overflow
+                // an uint64_t, so the digits can be parsed in batches
+                // without any checks
+                value = parse_digits_unchecked(s, num_digits);
+            } else {
+                uint64_t v = 0;
+                for (const char* p = s; p != e; ++p) {
+                    const auto digit = static_cast<uint64_t>(*p - '0');
+                    if (v > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+                        return false;
+                    }
+                    v = v * 10 + digit;
+                }
+                value = v;
+            }
+            *data = e;
+            return true;
+        }
+
+        /**
+         * Parse a signed decimal integer with an optional '+' or '-'
+         * sign. Same end-pointer contract as string_to_unsigned().
+         */
+        inline bool string_to_signed(const char** data, int64_t& value) noexcept {
+            const char* s = *data;
+            const bool negative = (*s == '-');
+            if (negative || *s == '+') {
+                ++s;
+            }
+            uint64_t magnitude = 0;
+            if (!string_to_unsigned(&s, magnitude)) {
+                return false;
+            }
+            if (negative) {
+                if (magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1) {
+                    return false;
+                }
+                value = magnitude == 0 ? 0 : -static_cast<int64_t>(magnitude - 1) - 1;
+            } else {
+                if (magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                    return false;
+                }
+                value = static_cast<int64_t>(magnitude);
+            }
+            *data = s;
+            return true;
+        }
+
+    } // namespace detail
+
     /**
      * Convert string with object id to object_id_type.
      *
@@ -58,14 +173,10 @@ namespace osmium {
      */
     inline object_id_type string_to_object_id(const char* input) {
         assert(input);
-        if (*input != '\0' && !std::isspace(*input)) {
-            char* end = nullptr;
-            const auto id = std::strtoll(input, &end, 10);
-            if (id != std::numeric_limits<long long>::min() && // NOLINT(google-runtime-int)
-                id != std::numeric_limits<long long>::max() && // NOLINT(google-runtime-int)
-                *end == '\0') {
-                return id;
-            }
+        const char* s = input;
+        int64_t id = 0;
+        if (detail::string_to_signed(&s, id) && *s == '\0') {
+            return id;
         }
         throw std::range_error{std::string{"illegal id: '"} + input + "'"};
     }
@@ -93,7 +204,7 @@ namespace osmium {
         assert(input);
         assert(types != osmium::osm_entity_bits::nothing);
         if (*input != '\0') {
-            if (std::isdigit(*input)) {
+            if (*input >= '0' && *input <= '9') {
                 return std::make_pair(default_type, string_to_object_id(input));
             }
             const osmium::item_type t = osmium::char_to_item_type(*input);
@@ -110,12 +221,14 @@ namespace osmium {
             if (input[0] == '-' && input[1] == '1' && input[2] == '\0') {
                 return 0;
             }
-            if (*input != '\0' && *input != '-' && !std::isspace(*input)) {
-                char* end = nullptr;
-                const auto value = std::strtoul(input, &end, 10);
-                if (value < std::numeric_limits<uint32_t>::max() && *end == '\0') {
-                    return static_cast<uint32_t>(value);
-                }
+            const char* s = input;
+            if (*s == '+') {
+                ++s;
+            }
+            uint64_t value = 0;
+            if (string_to_unsigned(&s, value) && *s == '\0' &&
+                value < std::numeric_limits<uint32_t>::max()) {
+                return static_cast<uint32_t>(value);
             }
             throw std::range_error{std::string{"illegal "} + name + ": '" + input + "'"};
         }
@@ -70,6 +70,44 @@ namespace osmium {
 
     static_assert(sizeof(WayNodeList) % osmium::memory::align_bytes == 0, "Class osmium::WayNodeList has wrong size to be aligned properly!");
 
+    /**
+     * Envelope of a way stored in the buffer together with the way
+     * itself. This is an optional subitem. It is usually created while
+     * the way is decoded from a file with node locations on the ways,
+     * when the node locations are in the cache anyway, so that later
+     * users of the envelope don't have to look at all the node
+     * locations again. Way::envelope() will use it automatically when
+     * it is there.
+     */
+    class WayEnvelope : public osmium::memory::Item {
+
+        osmium::Box m_box{};
+
+    public:
+
+        static constexpr osmium::item_type itemtype = osmium::item_type::way_envelope;
+
+        constexpr static bool is_compatible_to(osmium::item_type t) noexcept {
+            return t == itemtype;
+        }
+
+        WayEnvelope() noexcept :
+            osmium::memory::Item(sizeof(WayEnvelope), itemtype) {
+        }
+
+        /// The envelope. Invalid if it was computed from a way without locations.
+        const osmium::Box& box() const noexcept {
+            return m_box;
+        }
+
+        void set_box(const osmium::Box& box) noexcept {
+            m_box = box;
+        }
+
+    }; // class WayEnvelope
+
+    static_assert(sizeof(WayEnvelope) % osmium::memory::align_bytes == 0, "Class osmium::WayEnvelope has wrong size to be aligned properly!");
+
     class Way : public OSMObject {
 
         template <typename TDerived, typename T>
@@ -145,12 +183,21 @@ namespace osmium {
         }
 
         /**
-         * Calculate the envelope of this way. If the locations of the nodes
+         * Calculate the envelope of this way. If the way carries a
+         * stored envelope (see osmium::WayEnvelope and the
+         * osmium::io::way_envelopes Reader option), that one is
+         * returned without looking at the node locations. Otherwise
+         * the envelope is computed from the node locations; if those
          * are not set, the resulting box will be invalid.
          *
-         * Complexity: Linear in the number of nodes.
+         * Complexity: Constant with a stored envelope, linear in the
+         * number of nodes without one.
          */
         osmium::Box envelope() const noexcept {
+            const auto& stored = osmium::detail::subitem_of_type<const WayEnvelope>(cbegin(), cend());
+            if (stored.box().valid()) {
+                return stored.box();
+            }
             return nodes().envelope();
         }
 
@@ -0,0 +1,153 @@
+#ifndef OSMIUM_PAIR_DIFF_HPP
+#define OSMIUM_PAIR_DIFF_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/input_iterator.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/object_comparisons.hpp>
+
+#include <cstring>
+
+namespace osmium {
+
+    /**
+     * Base class for handlers used with apply_pair_diff(). Derive your
+     * handler from this class and overwrite the functions for the cases
+     * you are interested in. Dispatch is static like for the
+     * osmium::handler::Handler class.
+     */
+    class PairDiffHandler {
+
+    public:
+
+        /// Called for an object that is only in the left input.
+        void left_only(const osmium::OSMObject& /*object*/) const noexcept {
+        }
+
+        /// Called for an object that is only in the right input.
+        void right_only(const osmium::OSMObject& /*object*/) const noexcept {
+        }
+
+        /// Called for an object that is the same in both inputs.
+        void unchanged(const osmium::OSMObject& /*left*/, const osmium::OSMObject& /*right*/) const noexcept {
+        }
+
+        /// Called for an object that differs between the inputs.
+        void changed(const osmium::OSMObject& /*left*/, const osmium::OSMObject& /*right*/) const noexcept {
+        }
+
+    }; // class PairDiffHandler
+
+    namespace detail {
+
+        /**
+         * Check whether two objects have the same canonical encoding in
+         * their buffers. Objects built from the same data always compare
+         * equal here, so this works as a cheap equality check that does
+         * not have to look at any decoded fields.
+         */
+        inline bool same_object_encoding(const osmium::OSMObject& lhs, const osmium::OSMObject& rhs) noexcept {
+            return lhs.byte_size() == rhs.byte_size() &&
+                   std::memcmp(&lhs, &rhs, lhs.byte_size()) == 0;
+        }
+
+    } // namespace detail
+
+    /**
+     * Align two sorted ranges of OSM objects and call the handler once
+     * for every object that is in either range. Objects are matched up
+     * by type and ID, both ranges must be sorted accordingly (the
+     * default order of OSM files). Only the current object of each range
+     * is held in memory, so two full planet files can be compared in
+     * constant space.
+     *
+     * Whether a matched pair is reported as unchanged or changed is
+     * decided by comparing the encoded buffer bytes of the two objects,
+     * no fields are inspected for pairs that compare equal.
+     *
+     * @tparam TIteratorLeft  Input iterator over osmium::OSMObjects.
+     * @tparam TIteratorRight Input iterator over osmium::OSMObjects.
+     * @tparam THandler Handler with the interface of PairDiffHandler.
+     */
+    template <typename TIteratorLeft, typename TIteratorRight, typename THandler>
+    inline void apply_pair_diff(TIteratorLeft lit, TIteratorLeft lend, TIteratorRight rit, TIteratorRight rend, THandler& handler) {
+        const osmium::object_order_type_id_version order;
+
+        while (lit != lend && rit != rend) {
+            const osmium::OSMObject& left = *lit;
+            const osmium::OSMObject& right = *rit;
+            if (left.type() == right.type() && left.id() == right.id()) {
+                if (detail::same_object_encoding(left, right)) {
+                    handler.unchanged(left, right);
+                } else {
+                    handler.changed(left, right);
+                }
+                ++lit;
+                ++rit;
+            } else if (order(left, right)) {
+                handler.left_only(left);
+                ++lit;
+            } else {
+                handler.right_only(right);
+                ++rit;
+            }
+        }
+
+        for (; lit != lend; ++lit) {
+            handler.left_only(*lit);
+        }
+
+        for (; rit != rend; ++rit) {
+            handler.right_only(*rit);
+        }
+    }
+
+    /**
+     * Align the objects read from two sources, usually osmium::io::Reader
+     * instances over two versions of the same extract, and call the
+     * handler once for every object that is in either source. See the
+     * iterator version of apply_pair_diff() for the details.
+     */
+    template <typename TSourceLeft, typename TSourceRight, typename THandler>
+    inline void apply_pair_diff(TSourceLeft& left_source, TSourceRight& right_source, THandler& handler) {
+        apply_pair_diff(osmium::io::InputIterator<TSourceLeft, osmium::OSMObject>{left_source},
+                        osmium::io::InputIterator<TSourceLeft, osmium::OSMObject>{},
+                        osmium::io::InputIterator<TSourceRight, osmium::OSMObject>{right_source},
+                        osmium::io::InputIterator<TSourceRight, osmium::OSMObject>{},
+                        handler);
+    }
+
+} // namespace osmium
+
+#endif // OSMIUM_PAIR_DIFF_HPP
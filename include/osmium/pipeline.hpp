@@ -0,0 +1,360 @@
+#ifndef OSMIUM_PIPELINE_HPP
+#define OSMIUM_PIPELINE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/util.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Compose a source, any number of transform stages, and a sink into
+     * an explicitly scheduled pipeline. This makes the architecture the
+     * I/O classes use internally (stages connected by bounded queues of
+     * futures, parallel work submitted to a thread pool, results
+     * consumed in order) available for user code, where the usual
+     * Reader -> apply() -> Writer combination runs all the work in the
+     * middle on a single thread.
+     *
+     * The source is a function returning buffers, an invalid buffer
+     * ends the data. Every transform stage takes a buffer and returns
+     * a buffer; a stage declared with parallelism > 1 has that many
+     * buffers in flight on the thread pool at the same time, but the
+     * next stage still sees the results in the original order. The
+     * bounded queues between the stages provide backpressure: a fast
+     * source can not run arbitrarily far ahead of a slow sink.
+     *
+     * @code
+     * osmium::io::Reader reader{infile};
+     * osmium::io::Writer writer{outfile};
+     *
+     * osmium::Pipeline pipeline;
+     * pipeline.source([&]() { return reader.read(); })
+     *         .transform(expensive_per_buffer_work, 4)
+     *         .sink([&](osmium::memory::Buffer&& buffer) {
+     *             writer(std::move(buffer));
+     *         });
+     * pipeline.run();
+     * @endcode
+     *
+     * If the source, a transform, or the sink throws, all stages are
+     * shut down and run() rethrows the first exception. A pipeline can
+     * only run once.
+     *
+     * For the simple case of a chain of handlers each running on its
+     * own thread see osmium::apply_pipelined() in apply_pipeline.hpp.
+     */
+    class Pipeline {
+
+    public:
+
+        using source_type    = std::function<osmium::memory::Buffer()>;
+        using transform_type = std::function<osmium::memory::Buffer(osmium::memory::Buffer&&)>;
+        using sink_type      = std::function<void(osmium::memory::Buffer&&)>;
+
+    private:
+
+        using queue_type = osmium::thread::Queue<std::future<osmium::memory::Buffer>>;
+
+        enum : std::size_t {
+            default_queue_depth = 8
+        };
+
+        struct stage_type {
+            transform_type func;
+            std::size_t parallelism;
+        };
+
+        osmium::thread::Pool* m_pool;
+        source_type m_source{};
+        std::vector<stage_type> m_stages{};
+        sink_type m_sink{};
+
+        // One queue between each pair of neighbouring stages, created
+        // in run().
+        std::vector<std::unique_ptr<queue_type>> m_queues{};
+
+        std::mutex m_mutex;
+        std::condition_variable m_tasks_done_cond;
+        std::exception_ptr m_error{};
+        std::size_t m_tasks_in_flight = 0;
+        bool m_has_run = false;
+
+        /**
+         * Remember the first error and shut down all queues. The
+         * shutdown wakes up and unblocks every stage, so the whole
+         * pipeline winds down without anybody getting stuck on a full
+         * or empty queue.
+         */
+        void store_error(std::exception_ptr error) {
+            {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                if (!m_error) {
+                    m_error = std::move(error);
+                }
+            }
+            for (const auto& queue : m_queues) {
+                queue->shutdown();
+            }
+        }
+
+        static void push_buffer(queue_type& queue, osmium::memory::Buffer&& buffer) {
+            std::promise<osmium::memory::Buffer> promise;
+            queue.push(promise.get_future());
+            promise.set_value(std::move(buffer));
+        }
+
+        void run_source() {
+            osmium::thread::set_thread_name("_osmium_pl_src");
+            queue_type& out = *m_queues.front();
+            try {
+                while (out.in_use()) {
+                    osmium::memory::Buffer buffer = m_source();
+                    const bool at_end = !buffer;
+                    push_buffer(out, std::move(buffer));
+                    if (at_end) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                store_error(std::current_exception());
+            }
+        }
+
+        void task_done() {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            if (--m_tasks_in_flight == 0) {
+                m_tasks_done_cond.notify_all();
+            }
+        }
+
+        // The tasks submitted to the pool have to be copyable, so the
+        // buffer travels in a shared_ptr. The task tells the pipeline
+        // when it is done even if the transform throws, so run() can
+        // wait for all tasks before it returns (on the error path the
+        // futures are thrown away, but the tasks still reference the
+        // pipeline and must not outlive it).
+        struct transform_task {
+
+            Pipeline* pipeline;
+            const transform_type* func;
+            std::shared_ptr<osmium::memory::Buffer> buffer;
+
+            osmium::memory::Buffer operator()() {
+                struct done_guard {
+                    Pipeline* pipeline;
+                    ~done_guard() {
+                        pipeline->task_done();
+                    }
+                } guard{pipeline};
+                return (*func)(std::move(*buffer));
+            }
+
+        }; // struct transform_task
+
+        void run_stage(const std::size_t index) {
+            osmium::thread::set_thread_name("_osmium_pl_trn");
+            queue_type& in = *m_queues[index];
+            queue_type& out = *m_queues[index + 1];
+            try {
+                while (true) {
+                    std::future<osmium::memory::Buffer> future;
+                    in.wait_and_pop(future);
+                    if (!future.valid()) { // queue was shut down
+                        return;
+                    }
+                    osmium::memory::Buffer buffer = future.get();
+                    if (!buffer) {
+                        push_buffer(out, std::move(buffer)); // forward end marker
+                        return;
+                    }
+                    {
+                        const std::lock_guard<std::mutex> lock{m_mutex};
+                        ++m_tasks_in_flight;
+                    }
+                    // Results are pushed in input order, so even with
+                    // several buffers in flight the next stage consumes
+                    // them in order.
+                    out.push(m_pool->submit(transform_task{this, &m_stages[index].func,
+                                                           std::make_shared<osmium::memory::Buffer>(std::move(buffer))}));
+                }
+            } catch (...) {
+                store_error(std::current_exception());
+            }
+        }
+
+        void run_sink() {
+            queue_type& in = *m_queues.back();
+            try {
+                while (true) {
+                    std::future<osmium::memory::Buffer> future;
+                    in.wait_and_pop(future);
+                    if (!future.valid()) { // queue was shut down
+                        return;
+                    }
+                    osmium::memory::Buffer buffer = future.get();
+                    if (!buffer) {
+                        return;
+                    }
+                    m_sink(std::move(buffer));
+                }
+            } catch (...) {
+                store_error(std::current_exception());
+            }
+        }
+
+    public:
+
+        explicit Pipeline(osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+            m_pool(&pool) {
+        }
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        Pipeline(Pipeline&&) = delete;
+        Pipeline& operator=(Pipeline&&) = delete;
+
+        ~Pipeline() noexcept = default;
+
+        /**
+         * Set the source of the pipeline, a function returning the next
+         * buffer on every call. An invalid buffer ends the data. Use
+         * `[&]() { return reader.read(); }` to read from an
+         * osmium::io::Reader.
+         */
+        Pipeline& source(source_type func) {
+            m_source = std::move(func);
+            return *this;
+        }
+
+        /**
+         * Append a transform stage. The function gets each buffer and
+         * returns the (same or a new) buffer handed to the next stage.
+         * With parallelism > 1 that many buffers are worked on
+         * concurrently on the thread pool; the function must then be
+         * safe to call from several threads at the same time. Order is
+         * preserved either way.
+         */
+        Pipeline& transform(transform_type func, std::size_t parallelism = 1) {
+            if (parallelism < 1) {
+                parallelism = 1;
+            }
+            m_stages.push_back(stage_type{std::move(func), parallelism});
+            return *this;
+        }
+
+        /**
+         * Set the sink of the pipeline, a function called with every
+         * buffer coming out of the last transform stage. Use
+         * `[&](osmium::memory::Buffer&& buffer) { writer(std::move(buffer)); }`
+         * to write to an osmium::io::Writer.
+         */
+        Pipeline& sink(sink_type func) {
+            m_sink = std::move(func);
+            return *this;
+        }
+
+        /**
+         * Run the pipeline to completion. The source and every
+         * transform stage run on a thread of their own, the sink runs
+         * in the calling thread. Returns when all data has passed
+         * through the pipeline (or an error ended it early).
+         *
+         * @throws std::logic_error if no source or no sink is set or
+         *         the pipeline has already run.
+         * @throws whatever the source, transforms, or sink threw; the
+         *         first exception wins.
+         */
+        void run() {
+            if (!m_source || !m_sink) {
+                throw std::logic_error{"osmium::Pipeline needs a source and a sink before calling run()"};
+            }
+            if (m_has_run) {
+                throw std::logic_error{"osmium::Pipeline can only run once"};
+            }
+            m_has_run = true;
+
+            m_queues.reserve(m_stages.size() + 1);
+            m_queues.emplace_back(new queue_type{default_queue_depth, "pipeline_source"});
+            for (const auto& stage : m_stages) {
+                // The queue depth is the declared parallelism: it
+                // bounds how many results of this stage can be in
+                // flight, which is what provides the backpressure.
+                m_queues.emplace_back(new queue_type{stage.parallelism, "pipeline_stage"});
+            }
+
+            std::vector<std::thread> threads;
+            threads.reserve(m_stages.size() + 1);
+            threads.emplace_back(&Pipeline::run_source, this);
+            for (std::size_t i = 0; i < m_stages.size(); ++i) {
+                threads.emplace_back(&Pipeline::run_stage, this, i);
+            }
+
+            run_sink();
+
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_tasks_done_cond.wait(lock, [this]() {
+                return m_tasks_in_flight == 0;
+            });
+
+            if (m_error) {
+                std::rethrow_exception(m_error);
+            }
+        }
+
+    }; // class Pipeline
+
+} // namespace osmium
+
+#endif // OSMIUM_PIPELINE_HPP
@@ -135,43 +135,96 @@ namespace osmium {
                 }
             };
 
+            // Maximum number of elements tracked after prepare_for_lookup()
+            // that are kept in the small sorted "delta" region at the end of
+            // the element vector before it is merged into the sorted base.
+            enum : std::size_t {
+                max_delta_size = 1024
+            };
+
             std::vector<element> m_elements{};
 
+            // The first m_sorted_size elements form the sorted base, the
+            // rest is the delta region holding elements tracked after
+            // prepare_for_lookup(). The delta region is kept sorted, too,
+            // so lookups can binary search both regions.
+            std::size_t m_sorted_size = 0;
+
         protected:
 
             osmium::ItemStash& m_stash;
             osmium::relations::RelationsDatabase& m_relations_db;
 
-#ifndef NDEBUG
-            // This is used only in debug builds to make sure the
-            // prepare_for_lookup() function is called at the right place.
+            // Are we still in the initialization phase, ie before the call
+            // to prepare_for_lookup()?
             bool m_init_phase = true;
-#endif
 
             using iterator = std::vector<element>::iterator;
             using const_iterator = std::vector<element>::const_iterator;
 
-            iterator_range<iterator> find(osmium::object_id_type id) {
-                return make_range(std::equal_range(m_elements.begin(), m_elements.end(), element{id}, compare_member_id{}));
+            /**
+             * Result of a find() call: One range of matching elements in
+             * the sorted base and one in the delta region. The delta range
+             * is empty unless track() was called after prepare_for_lookup().
+             */
+            template <typename TIterator>
+            struct match_ranges_type {
+
+                iterator_range<TIterator> base;
+                iterator_range<TIterator> delta;
+
+                bool empty() const noexcept {
+                    return base.empty() && delta.empty();
+                }
+
+            }; // struct match_ranges_type
+
+            using match_ranges = match_ranges_type<iterator>;
+            using const_match_ranges = match_ranges_type<const_iterator>;
+
+            match_ranges find(osmium::object_id_type id) {
+                const auto delta_begin = m_elements.begin() + static_cast<std::vector<element>::difference_type>(m_sorted_size);
+                return match_ranges{
+                    make_range(std::equal_range(m_elements.begin(), delta_begin, element{id}, compare_member_id{})),
+                    make_range(std::equal_range(delta_begin, m_elements.end(), element{id}, compare_member_id{}))};
             }
 
-            iterator_range<const_iterator> find(osmium::object_id_type id) const {
-                return make_range(std::equal_range(m_elements.cbegin(), m_elements.cend(), element{id}, compare_member_id{}));
+            const_match_ranges find(osmium::object_id_type id) const {
+                const auto delta_begin = m_elements.cbegin() + static_cast<std::vector<element>::difference_type>(m_sorted_size);
+                return const_match_ranges{
+                    make_range(std::equal_range(m_elements.cbegin(), delta_begin, element{id}, compare_member_id{})),
+                    make_range(std::equal_range(delta_begin, m_elements.cend(), element{id}, compare_member_id{}))};
             }
 
-            static typename std::iterator_traits<iterator>::difference_type count_not_removed(const iterator_range<iterator>& range) noexcept {
-                return std::count_if(range.begin(), range.end(), [](const element& elem) {
+            static typename std::iterator_traits<iterator>::difference_type count_not_removed(const match_ranges& ranges) noexcept {
+                const auto pred = [](const element& elem) {
                     return !elem.is_removed();
-                });
+                };
+                return std::count_if(ranges.base.begin(), ranges.base.end(), pred) +
+                       std::count_if(ranges.delta.begin(), ranges.delta.end(), pred);
             }
 
-            void add_object(const osmium::OSMObject& object, iterator_range<iterator>& range) {
+            void add_object(const osmium::OSMObject& object, match_ranges& ranges) {
                 const auto handle = m_stash.add_item(object);
-                for (auto& elem : range) {
+                for (auto& elem : ranges.base) {
+                    elem.object_handle = handle;
+                }
+                for (auto& elem : ranges.delta) {
                     elem.object_handle = handle;
                 }
             }
 
+            /**
+             * Merge the delta region into the sorted base. Both regions are
+             * already sorted, so this is linear and doesn't need the full
+             * O(n log n) re-sort.
+             */
+            void consolidate() {
+                const auto delta_begin = m_elements.begin() + static_cast<std::vector<element>::difference_type>(m_sorted_size);
+                std::inplace_merge(m_elements.begin(), delta_begin, m_elements.end());
+                m_sorted_size = m_elements.size();
+            }
+
             MembersDatabaseCommon(osmium::ItemStash& stash, osmium::relations::RelationsDatabase& relations_db) :
                 m_stash(stash),
                 m_relations_db(relations_db) {
@@ -239,14 +292,29 @@ namespace osmium {
              * the specified id and that it is a member of the given relation
              * (as specified through the relation handle).
              *
+             * After prepare_for_lookup() was called, tracking is still
+             * possible: New elements go into a small sorted delta region
+             * that lookups search in addition to the sorted base and that
+             * is merged into the base when it grows too large. This way
+             * inserts and lookups can be interleaved without re-sorting
+             * the whole database every time.
+             *
              * @param rel_handle Relation this object is a member of.
              * @param member_id Id of an object of type TObject.
              * @param member_num This is the nth member in the relation.
              */
             void track(RelationHandle& rel_handle, osmium::object_id_type member_id, std::size_t member_num) {
-                assert(m_init_phase && "Can not call MembersDatabase::track() after MembersDatabase::prepare_for_lookup().");
                 assert(rel_handle.relation_database() == &m_relations_db);
-                m_elements.emplace_back(rel_handle.pos(), member_id, member_num);
+                if (m_init_phase) {
+                    m_elements.emplace_back(rel_handle.pos(), member_id, member_num);
+                } else {
+                    const element elem{rel_handle.pos(), member_id, member_num};
+                    const auto delta_begin = m_elements.begin() + static_cast<std::vector<element>::difference_type>(m_sorted_size);
+                    m_elements.insert(std::upper_bound(delta_begin, m_elements.end(), elem), elem);
+                    if (m_elements.size() - m_sorted_size > static_cast<std::size_t>(max_delta_size)) {
+                        consolidate();
+                    }
+                }
                 rel_handle.increment_members();
             }
 
@@ -259,9 +327,8 @@ namespace osmium {
             void prepare_for_lookup() {
                 assert(m_init_phase && "Can not call MembersDatabase::prepare_for_lookup() twice.");
                 std::sort(m_elements.begin(), m_elements.end());
-#ifndef NDEBUG
+                m_sorted_size = m_elements.size();
                 m_init_phase = false;
-#endif
             }
 
             /**
@@ -272,22 +339,32 @@ namespace osmium {
              */
             void remove(osmium::object_id_type member_id, osmium::object_id_type relation_id) {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling remove().");
-                const auto range = find(member_id);
+                auto ranges = find(member_id);
 
-                if (range.empty()) {
+                if (ranges.empty()) {
                     return;
                 }
 
                 // If this is the last time this object was needed, remove it
-                // from the stash.
-                if (count_not_removed(range) == 1) {
-                    m_stash.remove_item(range.begin()->object_handle);
+                // from the stash. Elements tracked after the object arrived
+                // have an invalid handle, so look for a valid one.
+                if (count_not_removed(ranges) == 1) {
+                    const auto it = !ranges.base.empty() ? ranges.base.begin() : ranges.delta.begin();
+                    if (it->object_handle.valid()) {
+                        m_stash.remove_item(it->object_handle);
+                    }
                 }
 
-                for (auto& elem : range) {
+                for (auto& elem : ranges.base) {
+                    if (!elem.is_removed() && relation_id == m_relations_db[elem.relation_pos]->id()) {
+                        elem.remove();
+                        return;
+                    }
+                }
+                for (auto& elem : ranges.delta) {
                     if (!elem.is_removed() && relation_id == m_relations_db[elem.relation_pos]->id()) {
                         elem.remove();
-                        break;
+                        return;
                     }
                 }
             }
@@ -304,11 +381,12 @@ namespace osmium {
              */
             const osmium::OSMObject* get_object(osmium::object_id_type id) const {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling get_object().");
-                const auto range = find(id);
-                if (range.empty()) {
+                const auto ranges = find(id);
+                if (ranges.empty()) {
                     return nullptr;
                 }
-                const auto handle = range.begin()->object_handle;
+                const auto it = !ranges.base.empty() ? ranges.base.begin() : ranges.delta.begin();
+                const auto handle = it->object_handle;
                 if (handle.valid()) {
                     return &m_stash.get<osmium::OSMObject>(handle);
                 }
@@ -364,27 +442,29 @@ namespace osmium {
             template <typename TFunc>
             bool add(const TObject& object, TFunc&& func) {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling add().");
-                auto range = find(object.id());
+                auto ranges = find(object.id());
 
-                if (range.empty()) {
+                if (ranges.empty()) {
                     // No relation needs this object.
                     return false;
                 }
 
                 // At least one relation needs this object. Store it and
                 // "tell" all relations.
-                add_object(object, range);
+                add_object(object, ranges);
 
-                for (auto& elem : range) {
-                    assert(!elem.is_removed());
-                    assert(elem.member_id == object.id());
+                for (auto* range : {&ranges.base, &ranges.delta}) {
+                    for (auto& elem : *range) {
+                        assert(!elem.is_removed());
+                        assert(elem.member_id == object.id());
 
-                    auto rel_handle = m_relations_db[elem.relation_pos];
-                    assert(elem.member_num < rel_handle->members().size());
-                    rel_handle.decrement_members();
+                        auto rel_handle = m_relations_db[elem.relation_pos];
+                        assert(elem.member_num < rel_handle->members().size());
+                        rel_handle.decrement_members();
 
-                    if (rel_handle.has_all_members()) {
-                        func(rel_handle);
+                        if (rel_handle.has_all_members()) {
+                            func(rel_handle);
+                        }
                     }
                 }
 
@@ -35,6 +35,8 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/handler.hpp>
 #include <osmium/handler/check_order.hpp>
+#include <osmium/index/id_set.hpp>
+#include <osmium/index/nwr_array.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/memory/callback_buffer.hpp>
 #include <osmium/osm/item_type.hpp>
@@ -88,6 +90,16 @@ namespace osmium {
             /// Output buffer.
             osmium::memory::CallbackBuffer m_output{};
 
+            /// Should stash memory be freed aggressively?
+            bool m_bounded_memory_mode = false;
+
+            // Only shrink the stash when at least this many removed items
+            // have accumulated, so the cost of the shrink is amortized over
+            // many completed relations.
+            enum : std::size_t {
+                min_removed_items_for_shrink = 10UL * 1000UL
+            };
+
         public:
 
             RelationsManagerBase() :
@@ -255,6 +267,37 @@ namespace osmium {
                 };
             }
 
+            /**
+             * Enable or disable bounded-memory mode. In this mode the
+             * manager aggressively frees the space of completed relations
+             * and their members during the second pass, so peak memory use
+             * is bounded by the relations still missing members instead of
+             * growing with everything ever stashed. This costs some extra
+             * time for compacting and reallocating the stash. It is off by
+             * default. Call this before the second pass.
+             */
+            void set_bounded_memory_mode(bool mode = true) noexcept {
+                m_bounded_memory_mode = mode;
+            }
+
+            /// Is bounded-memory mode enabled?
+            bool bounded_memory_mode() const noexcept {
+                return m_bounded_memory_mode;
+            }
+
+            /**
+             * Compact and shrink the stash if enough removed items have
+             * accumulated in it. Called by the RelationsManager class after
+             * completed relations have been handled when bounded-memory mode
+             * is enabled, but you can also call this yourself.
+             */
+            void possibly_shrink_stash() {
+                if (m_stash.count_removed() >= static_cast<std::size_t>(min_removed_items_for_shrink) &&
+                    m_stash.count_removed() >= m_stash.size()) {
+                    m_stash.shrink_to_fit();
+                }
+            }
+
             /// Access the output buffer.
             osmium::memory::Buffer& buffer() noexcept {
                 return m_output.buffer();
@@ -310,6 +353,22 @@ namespace osmium {
 
             SecondPassHandler<RelationsManager> m_handler_pass2;
 
+            /**
+             * The ids of all tracked members, filled in the first pass.
+             * Consulted in the second pass before any database lookup so
+             * the vast majority of objects, which complete nothing, skip
+             * the relations machinery entirely. Ids are never removed, so
+             * this is a superset of the ids currently tracked; a stale
+             * hit only costs the database lookup it would have done
+             * anyway. Negative ids share the id space of the positive
+             * ones here, which can only lead to more hits, not fewer.
+             */
+            osmium::nwr_array<osmium::index::IdSetDense<osmium::unsigned_object_id_type>> m_member_ids;
+
+            bool is_tracked_member(const osmium::OSMObject& object) const noexcept {
+                return m_member_ids(object.type()).get(object.positive_id());
+            }
+
             static bool wanted_type(osmium::item_type type) noexcept {
                 return (TNodes     && type == osmium::item_type::node) ||
                        (TWays      && type == osmium::item_type::way) ||
@@ -457,6 +516,10 @@ namespace osmium {
                 }
 
                 rel_handle.remove();
+
+                if (bounded_memory_mode()) {
+                    possibly_shrink_stash();
+                }
             }
 
         public:
@@ -494,6 +557,7 @@ namespace osmium {
                         if (wanted_type(member.type()) &&
                             derived().new_member(relation, member, n)) {
                             member_database(member.type()).track(rel_handle, member.ref(), n);
+                            m_member_ids(member.type()).set(member.positive_ref());
                         } else {
                             member.set_ref(0); // set member id to zero to indicate we are not interested
                         }
@@ -506,9 +570,10 @@ namespace osmium {
                 if (TNodes) {
                     m_check_order_handler.node(node);
                     derived().before_node(node);
-                    const bool added = member_nodes_database().add(node, [this](RelationHandle& rel_handle) {
-                        handle_complete_relation(rel_handle);
-                    });
+                    const bool added = is_tracked_member(node) &&
+                                       member_nodes_database().add(node, [this](RelationHandle& rel_handle) {
+                                           handle_complete_relation(rel_handle);
+                                       });
                     if (!added) {
                         derived().node_not_in_any_relation(node);
                     }
@@ -521,9 +586,10 @@ namespace osmium {
                 if (TWays) {
                     m_check_order_handler.way(way);
                     derived().before_way(way);
-                    const bool added = member_ways_database().add(way, [this](RelationHandle& rel_handle) {
-                        handle_complete_relation(rel_handle);
-                    });
+                    const bool added = is_tracked_member(way) &&
+                                       member_ways_database().add(way, [this](RelationHandle& rel_handle) {
+                                           handle_complete_relation(rel_handle);
+                                       });
                     if (!added) {
                         derived().way_not_in_any_relation(way);
                     }
@@ -536,9 +602,10 @@ namespace osmium {
                 if (TRelations) {
                     m_check_order_handler.relation(relation);
                     derived().before_relation(relation);
-                    const bool added = member_relations_database().add(relation, [this](RelationHandle& rel_handle) {
-                        handle_complete_relation(rel_handle);
-                    });
+                    const bool added = is_tracked_member(relation) &&
+                                       member_relations_database().add(relation, [this](RelationHandle& rel_handle) {
+                                           handle_complete_relation(rel_handle);
+                                       });
                     if (!added) {
                         derived().relation_not_in_any_relation(relation);
                     }
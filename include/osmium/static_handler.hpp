@@ -0,0 +1,226 @@
+#ifndef OSMIUM_STATIC_HANDLER_HPP
+#define OSMIUM_STATIC_HANDLER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/visitor.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace osmium {
+
+    namespace handler {
+
+        namespace detail {
+
+            template <typename THandler, typename... THandlers>
+            struct static_handler_index;
+
+            template <typename THandler, typename... TRest>
+            struct static_handler_index<THandler, THandler, TRest...> :
+                std::integral_constant<std::size_t, 0> {
+            };
+
+            template <typename THandler, typename TOther, typename... TRest>
+            struct static_handler_index<THandler, TOther, TRest...> :
+                std::integral_constant<std::size_t, 1 + static_handler_index<THandler, TRest...>::value> {
+            };
+
+            struct static_handler_destroy_visitor {
+
+                template <typename THandler>
+                void operator()(THandler& handler) const noexcept {
+                    handler.~THandler();
+                }
+
+            }; // struct static_handler_destroy_visitor
+
+            template <typename TSource>
+            struct static_handler_apply_visitor {
+
+                TSource* m_source;
+
+                template <typename THandler>
+                void operator()(THandler& handler) const {
+                    osmium::apply(*m_source, handler);
+                }
+
+            }; // struct static_handler_apply_visitor
+
+        } // namespace detail
+
+        /**
+         * A static-dispatch alternative to the DynamicHandler: The closed
+         * set of possible handlers is fixed at compile time, one of them
+         * is selected at run time with set(). Unlike the DynamicHandler,
+         * which costs a virtual call per object per callback, the
+         * selection here is resolved once per visit() or apply() call,
+         * outside the per-object loop, so the handler callbacks can be
+         * inlined.
+         *
+         * @code
+         * osmium::handler::StaticHandler<HandlerA, HandlerB> handler;
+         * handler.set<HandlerB>(args...);
+         * handler.apply(buffer);
+         * @endcode
+         *
+         * This is not itself a handler (it has no per-object callbacks),
+         * because forwarding each object separately would reintroduce the
+         * per-object dispatch this class is meant to avoid.
+         */
+        template <typename... THandlers>
+        class StaticHandler {
+
+            static_assert(sizeof...(THandlers) > 0, "StaticHandler needs at least one handler type");
+
+            enum : std::size_t {
+                invalid_index = sizeof...(THandlers)
+            };
+
+            typename std::aligned_union<0, THandlers...>::type m_storage;
+            std::size_t m_index = invalid_index;
+
+            template <typename TVisitor, typename THandler>
+            void visit_impl(TVisitor&& visitor, std::size_t index) {
+                assert(m_index == index);
+                visitor(*reinterpret_cast<THandler*>(&m_storage));
+            }
+
+            template <typename TVisitor, typename THandler, typename TNext, typename... TRest>
+            void visit_impl(TVisitor&& visitor, std::size_t index) {
+                if (m_index == index) {
+                    visitor(*reinterpret_cast<THandler*>(&m_storage));
+                    return;
+                }
+                visit_impl<TVisitor, TNext, TRest...>(std::forward<TVisitor>(visitor), index + 1);
+            }
+
+        public:
+
+            StaticHandler() noexcept = default;
+
+            StaticHandler(const StaticHandler&) = delete;
+            StaticHandler& operator=(const StaticHandler&) = delete;
+
+            StaticHandler(StaticHandler&&) = delete;
+            StaticHandler& operator=(StaticHandler&&) = delete;
+
+            ~StaticHandler() noexcept {
+                reset();
+            }
+
+            /// Is one of the handlers currently selected?
+            bool has_handler() const noexcept {
+                return m_index != invalid_index;
+            }
+
+            /**
+             * The index of the currently selected handler in the list of
+             * handler types, sizeof...(THandlers) if none is selected.
+             */
+            std::size_t index() const noexcept {
+                return m_index;
+            }
+
+            /**
+             * Select the handler of the given type, constructing it from
+             * the given arguments. Destroys the previously selected
+             * handler if there was one.
+             *
+             * @returns a reference to the newly constructed handler.
+             */
+            template <typename THandler, typename... TArgs>
+            THandler& set(TArgs&&... args) {
+                reset();
+                new (&m_storage) THandler{std::forward<TArgs>(args)...};
+                m_index = detail::static_handler_index<THandler, THandlers...>::value;
+                return get<THandler>();
+            }
+
+            /**
+             * Get a reference to the currently selected handler.
+             *
+             * @pre The handler of this type must be the selected one.
+             */
+            template <typename THandler>
+            THandler& get() noexcept {
+                assert((m_index == detail::static_handler_index<THandler, THandlers...>::value));
+                return *reinterpret_cast<THandler*>(&m_storage);
+            }
+
+            /// Destroy the currently selected handler if there is one.
+            void reset() noexcept {
+                if (has_handler()) {
+                    visit(detail::static_handler_destroy_visitor{});
+                    m_index = invalid_index;
+                }
+            }
+
+            /**
+             * Call the visitor with the currently selected handler as a
+             * concrete type. The visitor must have a (template) call
+             * operator accepting any of the handler types.
+             *
+             * @pre @code has_handler() @endcode
+             */
+            template <typename TVisitor>
+            void visit(TVisitor&& visitor) {
+                assert(has_handler());
+                visit_impl<TVisitor, THandlers...>(std::forward<TVisitor>(visitor), 0);
+            }
+
+            /**
+             * Apply all objects from the given source (a buffer, reader,
+             * ...) to the currently selected handler. The selection is
+             * resolved once, before the per-object loop, so there is no
+             * virtual dispatch per object. Does nothing if no handler is
+             * selected.
+             */
+            template <typename TSource>
+            void apply(TSource& source) {
+                if (has_handler()) {
+                    visit(detail::static_handler_apply_visitor<TSource>{&source});
+                }
+            }
+
+        }; // class StaticHandler
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_STATIC_HANDLER_HPP
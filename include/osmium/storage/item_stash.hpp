@@ -35,11 +35,14 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/memory/buffer.hpp>
 #include <osmium/memory/item.hpp>
+#include <osmium/util/memory.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <limits>
 #include <ostream>
+#include <utility>
 #include <vector>
 
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
@@ -123,10 +126,40 @@ namespace osmium {
             removed_item_offset = std::numeric_limits<std::size_t>::max()
         };
 
+        // This bit is set in an index entry if the item is still in the
+        // old generation buffer waiting to be moved by the incremental
+        // compaction. Real offsets are always much smaller.
+        enum : std::size_t {
+            old_generation_flag = std::size_t{1} << (std::numeric_limits<std::size_t>::digits - 1)
+        };
+
+        // The number of items processed in the old generation buffer for
+        // each item added while an incremental compaction is in progress.
+        // Must be larger than one so the compaction is guaranteed to finish.
+        enum : std::size_t {
+            compaction_items_per_add = 64
+        };
+
         osmium::memory::Buffer m_buffer;
+
+        // While an incremental compaction is in progress, this holds the
+        // old generation the items are moved out of. Invalid otherwise.
+        osmium::memory::Buffer m_old_buffer{};
+
         std::vector<std::size_t> m_index;
         std::size_t m_count_items = 0;
         std::size_t m_count_removed = 0;
+
+        // Offset into the old generation buffer of the next item the
+        // incremental compaction will look at.
+        std::size_t m_compaction_pos = 0;
+
+        // Position in the index of the next old generation entry to be
+        // patched. Entries from before the start of the compaction are
+        // ordered by offset, so this only ever moves forward.
+        std::size_t m_compaction_index_pos = 0;
+
+        osmium::MemoryAccounting::tracker m_memory_tracker{osmium::MemoryAccounting::subsystem::stashes};
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
         int64_t m_gc_time = 0;
 #endif
@@ -134,20 +167,34 @@ namespace osmium {
         class cleanup_helper {
 
             std::vector<std::size_t>& m_index;
+
+            // All live index entries as (offset, index position) pairs
+            // sorted by offset. Needed because after an incremental
+            // compaction the index is not ordered by offset any more.
+            std::vector<std::pair<std::size_t, std::size_t>> m_live{};
+
             std::size_t m_pos = 0;
 
         public:
 
             explicit cleanup_helper(std::vector<std::size_t>& index) :
                 m_index(index) {
+                m_live.reserve(index.size());
+                for (std::size_t pos = 0; pos < index.size(); ++pos) {
+                    if (index[pos] != removed_item_offset) {
+                        assert((index[pos] & old_generation_flag) == 0);
+                        m_live.emplace_back(index[pos], pos);
+                    }
+                }
+                std::sort(m_live.begin(), m_live.end());
             }
 
             void moving_in_buffer(std::size_t old_offset, std::size_t new_offset) {
-                while (m_index[m_pos] != old_offset) {
+                while (m_live[m_pos].first != old_offset) {
                     ++m_pos;
-                    assert(m_pos < m_index.size());
+                    assert(m_pos < m_live.size());
                 }
-                m_index[m_pos] = new_offset;
+                m_index[m_live[m_pos].second] = new_offset;
                 ++m_pos;
             }
 
@@ -158,7 +205,8 @@ namespace osmium {
             assert(handle.value <= m_index.size());
             auto& offset = m_index[handle.value - 1];
             assert(offset != removed_item_offset);
-            assert(offset < m_buffer.committed());
+            assert((offset & old_generation_flag) ? (offset & ~old_generation_flag) < m_old_buffer.committed()
+                                                  : offset < m_buffer.committed());
             return offset;
         }
 
@@ -167,10 +215,18 @@ namespace osmium {
             assert(handle.value <= m_index.size());
             const auto& offset = m_index[handle.value - 1];
             assert(offset != removed_item_offset);
-            assert(offset < m_buffer.committed());
+            assert((offset & old_generation_flag) ? (offset & ~old_generation_flag) < m_old_buffer.committed()
+                                                  : offset < m_buffer.committed());
             return offset;
         }
 
+        osmium::memory::Item& get_item_at_offset(std::size_t offset) const noexcept {
+            if (offset & old_generation_flag) {
+                return m_old_buffer.get<osmium::memory::Item>(offset & ~old_generation_flag);
+            }
+            return m_buffer.get<osmium::memory::Item>(offset);
+        }
+
         // This function decides whether it makes sense to garbage collect the
         // database. The values here are the result of some experimentation
         // with real data. We need to balance the memory use with the time
@@ -208,6 +264,7 @@ namespace osmium {
         std::size_t used_memory() const noexcept {
             return sizeof(ItemStash) +
                    m_buffer.capacity() +
+                   (m_old_buffer ? m_old_buffer.capacity() : 0) +
                    m_index.capacity() * sizeof(std::size_t);
         }
 
@@ -237,9 +294,13 @@ namespace osmium {
          */
         void clear() {
             m_buffer.clear();
+            m_old_buffer = osmium::memory::Buffer{};
             m_index.clear();
             m_count_items = 0;
             m_count_removed = 0;
+            m_compaction_pos = 0;
+            m_compaction_index_pos = 0;
+            m_memory_tracker.update(used_memory());
         }
 
         /**
@@ -249,14 +310,18 @@ namespace osmium {
          * Complexity: Amortized constant.
          */
         handle_type add_item(const osmium::memory::Item& item) {
-            if (should_gc()) {
-                garbage_collect();
+            if (compacting()) {
+                compact_step(compaction_items_per_add);
+            } else if (should_gc()) {
+                start_compaction();
+                compact_step(compaction_items_per_add);
             }
             ++m_count_items;
             const auto offset = m_buffer.committed();
             m_buffer.add_item(item);
             m_buffer.commit();
             m_index.push_back(offset);
+            m_memory_tracker.update(used_memory());
             return handle_type{m_index.size()};
         }
 
@@ -272,7 +337,7 @@ namespace osmium {
          *      item.
          */
         osmium::memory::Item& get_item(handle_type handle) const {
-            return m_buffer.get<osmium::memory::Item>(get_item_offset(handle));
+            return get_item_at_offset(get_item_offset(handle));
         }
 
         /**
@@ -295,11 +360,100 @@ namespace osmium {
             return static_cast<T&>(get_item(handle));
         }
 
+        /**
+         * Is an incremental compaction in progress? While it is, some items
+         * still live in the old generation buffer waiting to be moved by
+         * compact_step().
+         */
+        bool compacting() const noexcept {
+            return static_cast<bool>(m_old_buffer);
+        }
+
+        /**
+         * Start an incremental compaction. The current buffer becomes the
+         * old generation and new items go into a fresh buffer. Calls to
+         * compact_step() then move the remaining live items over, a bounded
+         * number at a time, patching their handles in place. Does nothing
+         * if a compaction is already in progress.
+         *
+         * Usually you do not need to call this, because add_item() will
+         * start a compaction for you as necessary and move a few items on
+         * every call until it is done.
+         *
+         * Complexity: Linear in the number of handles ever created.
+         */
+        void start_compaction() {
+            if (compacting()) {
+                return;
+            }
+
+            for (auto& offset : m_index) {
+                if (offset != removed_item_offset) {
+                    offset |= old_generation_flag;
+                }
+            }
+
+            m_old_buffer = std::move(m_buffer);
+            m_buffer = osmium::memory::Buffer{initial_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+            m_compaction_pos = 0;
+            m_compaction_index_pos = 0;
+        }
+
+        /**
+         * Do one step of an incremental compaction, looking at no more than
+         * @code max_items @endcode items in the old generation buffer. Live
+         * items are moved into the current buffer, removed items are finally
+         * given up. When the old generation is empty, its memory is released.
+         * Does nothing if no compaction is in progress.
+         *
+         * This will invalidate any pointers and references into the stash,
+         * but handles are still valid.
+         *
+         * @returns The number of items looked at, 0 if there is nothing
+         *          (more) to do.
+         */
+        std::size_t compact_step(std::size_t max_items) {
+            if (!compacting()) {
+                return 0;
+            }
+
+            std::size_t items = 0;
+            while (m_compaction_pos < m_old_buffer.committed() && items < max_items) {
+                const auto& item = m_old_buffer.get<osmium::memory::Item>(m_compaction_pos);
+                if (item.removed()) {
+                    assert(m_count_removed > 0);
+                    --m_count_removed;
+                } else {
+                    const std::size_t tagged_offset = m_compaction_pos | old_generation_flag;
+                    while (m_index[m_compaction_index_pos] != tagged_offset) {
+                        ++m_compaction_index_pos;
+                        assert(m_compaction_index_pos < m_index.size());
+                    }
+                    const auto new_offset = m_buffer.committed();
+                    m_buffer.add_item(item);
+                    m_buffer.commit();
+                    m_index[m_compaction_index_pos] = new_offset;
+                    ++m_compaction_index_pos;
+                }
+                m_compaction_pos += item.padded_size();
+                ++items;
+            }
+
+            if (m_compaction_pos >= m_old_buffer.committed()) {
+                m_old_buffer = osmium::memory::Buffer{};
+                m_compaction_pos = 0;
+                m_compaction_index_pos = 0;
+            }
+
+            return items;
+        }
+
         /**
          * Garbage collect the memory used by the ItemStash. This will free up
-         * memory for adding new items. No memory is actually returned to the
+         * memory for adding new items. Finishes any incremental compaction
+         * that is in progress. No memory is actually returned to the
          * OS. Usually you do not need to call this, because add_item() will
-         * call it for you as necessary.
+         * compact the stash for you as necessary.
          *
          * Complexity: Linear in size() + count_removed().
          */
@@ -310,9 +464,12 @@ namespace osmium {
             std::chrono::time_point<clock> start = clock::now();
 #endif
 
+            compact_step(std::numeric_limits<std::size_t>::max());
+
             m_count_removed = 0;
             cleanup_helper helper{m_index};
             m_buffer.purge_removed(&helper);
+            m_memory_tracker.update(used_memory());
 
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
             std::chrono::time_point<clock> stop = clock::now();
@@ -323,6 +480,32 @@ namespace osmium {
 #endif
         }
 
+        /**
+         * Garbage collect the memory used by the ItemStash and, if a large
+         * part of the internal buffer is unused after that, move the data
+         * into a smaller buffer, actually returning memory to the OS. This
+         * is more expensive than garbage_collect(), call it only when memory
+         * use matters more than speed. This will invalidate any pointers and
+         * references into the stash, but handles are still valid.
+         *
+         * Complexity: Linear in size() + count_removed().
+         */
+        void shrink_to_fit() {
+            garbage_collect();
+
+            const std::size_t needed = m_buffer.committed() < static_cast<std::size_t>(initial_buffer_size)
+                                           ? static_cast<std::size_t>(initial_buffer_size)
+                                           : m_buffer.committed();
+
+            if (m_buffer.capacity() / 2 > needed) {
+                osmium::memory::Buffer new_buffer{needed, osmium::memory::Buffer::auto_grow::yes};
+                new_buffer.add_buffer(m_buffer);
+                new_buffer.commit();
+                m_buffer = std::move(new_buffer);
+                m_memory_tracker.update(used_memory());
+            }
+        }
+
         /**
          * Remove an item from the stash. The item will be marked as removed
          * and the handle will be invalidated. No memory will actually be
@@ -337,7 +520,7 @@ namespace osmium {
          */
         void remove_item(handle_type handle) {
             auto& offset = get_item_offset_ref(handle);
-            auto& item = m_buffer.get<osmium::memory::Item>(offset);
+            auto& item = get_item_at_offset(offset);
             assert(!item.removed() && "can not call remove_item() on already removed item");
             item.set_removed(true);
             offset = removed_item_offset;
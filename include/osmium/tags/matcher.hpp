@@ -37,6 +37,8 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/util/string_matcher.hpp>
 
 #include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <type_traits>
 #include <utility>
 
@@ -66,6 +68,21 @@ namespace osmium {
             return m_has_value_matcher;
         }
 
+        /// The StringMatcher used for matching the key.
+        const osmium::StringMatcher& key_matcher() const noexcept {
+            return m_key_matcher;
+        }
+
+        /// The StringMatcher used for matching the value.
+        const osmium::StringMatcher& value_matcher() const noexcept {
+            return m_value_matcher;
+        }
+
+        /// Is the result of the value matcher inverted?
+        bool inverted() const noexcept {
+            return !m_result;
+        }
+
         /**
          * Create a TagMatcher matching the key against the specified
          * StringMatcher.
@@ -113,7 +130,18 @@ namespace osmium {
          * @returns true if the tag matches.
          */
         bool operator()(const osmium::Tag& tag) const noexcept {
-            return operator()(tag.key(), tag.value());
+            const char* key = tag.key();
+            const std::size_t key_len = std::strlen(key);
+            if (!m_key_matcher(key, key_len)) {
+                return false;
+            }
+            if (!m_has_value_matcher) {
+                return true;
+            }
+            // The value starts right after the NUL byte terminating the
+            // key, so with the key length known there is no need to scan
+            // the key again as Tag::value() would.
+            return m_value_matcher(key + key_len + 1) == m_result;
         }
 
         /**
@@ -0,0 +1,226 @@
+#ifndef OSMIUM_TAGS_TAG_PATCH_TABLE_HPP
+#define OSMIUM_TAGS_TAG_PATCH_TABLE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/builder/builder.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * A journal of tag value edits that can not be done in place.
+     *
+     * TagList::set_value() changes a tag value directly in the buffer,
+     * but that only works when the new value fits into the space of the
+     * old one. The TagPatchTable collects the edits that do not fit and
+     * applies them when the object is next written to a buffer anyway:
+     *
+     * @code
+     * osmium::TagPatchTable patches;
+     * ...
+     * patches.set_value(object, "highway", "unclassified"); // in place or journaled
+     * ...
+     * for (const auto& object : input_buffer.select<osmium::OSMObject>()) {
+     *     patches.write(object, output_buffer); // patches applied here
+     * }
+     * @endcode
+     *
+     * This way a pass that changes only a few tags does not have to
+     * rebuild every object into a new buffer at the time of the edit.
+     */
+    class TagPatchTable {
+
+        using patch_list = std::vector<std::pair<std::string, std::string>>;
+
+        std::map<std::pair<osmium::item_type, osmium::object_id_type>, patch_list> m_patches;
+
+        static void add_tags_with_patches(osmium::builder::Builder& parent, const osmium::TagList& tags, const patch_list& patches) {
+            osmium::builder::TagListBuilder builder{parent};
+            std::vector<bool> used(patches.size(), false);
+            for (const auto& tag : tags) {
+                std::size_t i = 0;
+                while (i < patches.size() && std::strcmp(patches[i].first.c_str(), tag.key()) != 0) {
+                    ++i;
+                }
+                if (i < patches.size()) {
+                    builder.add_tag(patches[i].first, patches[i].second);
+                    used[i] = true;
+                } else {
+                    builder.add_tag(tag);
+                }
+            }
+            for (std::size_t i = 0; i < patches.size(); ++i) {
+                if (!used[i]) {
+                    builder.add_tag(patches[i].first, patches[i].second);
+                }
+            }
+        }
+
+        template <typename TBuilder>
+        static void copy_object(TBuilder& builder, const osmium::OSMObject& object, const patch_list& patches) {
+            builder.set_id(object.id())
+                   .set_version(object.version())
+                   .set_visible(object.visible())
+                   .set_changeset(object.changeset())
+                   .set_timestamp(object.timestamp())
+                   .set_uid(object.uid())
+                   .set_user(object.user());
+            for (auto it = object.cbegin(); it != object.cend(); ++it) {
+                if (it->type() == osmium::item_type::tag_list) {
+                    add_tags_with_patches(builder, static_cast<const osmium::TagList&>(*it), patches);
+                } else {
+                    builder.add_item(*it);
+                }
+            }
+        }
+
+    public:
+
+        TagPatchTable() = default;
+
+        /**
+         * Journal a tag value edit for the object with the given type
+         * and id. The tag will get the new value when the object is
+         * written through write(). If the object has no tag with that
+         * key, the tag will be added. A patch for the same key replaces
+         * the earlier patch.
+         *
+         * @pre @code key != nullptr && value != nullptr @endcode
+         */
+        void add_patch(const osmium::item_type type, const osmium::object_id_type id, const char* key, const char* value) {
+            assert(key);
+            assert(value);
+            auto& patches = m_patches[std::make_pair(type, id)];
+            for (auto& patch : patches) {
+                if (patch.first == key) {
+                    patch.second = value;
+                    return;
+                }
+            }
+            patches.emplace_back(key, value);
+        }
+
+        /**
+         * Change the value of the tag with the given key on the given
+         * object. The edit is done in place in the buffer if the new
+         * value fits (see TagList::set_value()), otherwise it is
+         * journaled and applied when the object is written through
+         * write().
+         *
+         * @pre @code key != nullptr && value != nullptr @endcode
+         */
+        void set_value(osmium::OSMObject& object, const char* key, const char* value) {
+            if (!object.tags().set_value(key, value)) {
+                add_patch(object.type(), object.id(), key, value);
+            }
+        }
+
+        /// Is the journal empty?
+        bool empty() const noexcept {
+            return m_patches.empty();
+        }
+
+        /// The number of objects with journaled edits.
+        std::size_t size() const noexcept {
+            return m_patches.size();
+        }
+
+        /// Forget all journaled edits.
+        void clear() {
+            m_patches.clear();
+        }
+
+        /// Are there journaled edits for this object?
+        bool has_patches(const osmium::OSMObject& object) const noexcept {
+            return m_patches.find(std::make_pair(object.type(), object.id())) != m_patches.end();
+        }
+
+        /**
+         * Write the object into the buffer and commit it. Journaled
+         * edits for the object are applied on the way; an object
+         * without journaled edits is copied verbatim.
+         *
+         * The buffer must not be the buffer the object lives in,
+         * because the object can not be read while the buffer grows.
+         */
+        void write(const osmium::OSMObject& object, osmium::memory::Buffer& buffer) const {
+            const auto it = m_patches.find(std::make_pair(object.type(), object.id()));
+            if (it == m_patches.end()) {
+                buffer.add_item(object);
+                buffer.commit();
+                return;
+            }
+
+            switch (object.type()) {
+                case osmium::item_type::node: {
+                        osmium::builder::NodeBuilder builder{buffer};
+                        builder.set_location(static_cast<const osmium::Node&>(object).location());
+                        copy_object(builder, object, it->second);
+                    }
+                    break;
+                case osmium::item_type::way: {
+                        osmium::builder::WayBuilder builder{buffer};
+                        copy_object(builder, object, it->second);
+                    }
+                    break;
+                case osmium::item_type::relation: {
+                        osmium::builder::RelationBuilder builder{buffer};
+                        copy_object(builder, object, it->second);
+                    }
+                    break;
+                default:
+                    assert(false && "The TagPatchTable only works with nodes, ways, and relations.");
+            }
+            buffer.commit();
+        }
+
+    }; // class TagPatchTable
+
+} // namespace osmium
+
+#endif // OSMIUM_TAGS_TAG_PATCH_TABLE_HPP
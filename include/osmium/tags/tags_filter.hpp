@@ -36,6 +36,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/tag.hpp>
 #include <osmium/tags/matcher.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -65,9 +69,148 @@ namespace osmium {
     template <typename TResult>
     class TagsFilterBase {
 
+        // Rules with an exact-match (equal) key matcher and either no
+        // value matcher or a non-inverted exact-match value matcher are
+        // additionally stored in a hash index, so the common case of many
+        // "key" or "key=value" rules doesn't need a linear scan over all
+        // rules for every tag. Only the rules that can not be indexed end
+        // up in m_scan_rules.
+        struct indexed_rule {
+            std::string key;
+            std::string value;
+            std::size_t rule_index;
+            bool has_value;
+        };
+
+        enum : std::size_t {
+            no_rule = static_cast<std::size_t>(-1)
+        };
+
         std::vector<std::pair<TResult, TagMatcher>> m_rules;
+        std::vector<indexed_rule> m_indexed_rules{};
+
+        // Open-addressing hash table with linear probing. Contains the
+        // index into m_indexed_rules plus one, 0 marks an empty slot.
+        std::vector<std::size_t> m_table{};
+
+        // Indexes into m_rules (in ascending order) of all rules that are
+        // not in the hash index and must be checked one by one.
+        std::vector<std::size_t> m_scan_rules{};
+
         TResult m_default_result;
 
+        static std::uint64_t hash_string(std::uint64_t hash, const char* str) noexcept {
+            // FNV-1a
+            while (*str) {
+                hash ^= static_cast<unsigned char>(*str++);
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        static std::uint64_t hash_string(std::uint64_t hash, const char* str, std::size_t len) noexcept {
+            // FNV-1a
+            for (std::size_t i = 0; i < len; ++i) {
+                hash ^= static_cast<unsigned char>(str[i]);
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        static std::uint64_t hash_rule(const char* key, const char* value) noexcept {
+            std::uint64_t hash = hash_string(14695981039346656037ULL, key);
+            if (value) {
+                hash ^= 0xffU; // separator, can not appear in UTF-8 strings
+                hash *= 1099511628211ULL;
+                hash = hash_string(hash, value);
+            }
+            return hash;
+        }
+
+        void insert(std::size_t index) {
+            const auto& rule = m_indexed_rules[index];
+            auto pos = hash_rule(rule.key.c_str(), rule.has_value ? rule.value.c_str() : nullptr) & (m_table.size() - 1);
+            while (m_table[pos] != 0) {
+                pos = (pos + 1) & (m_table.size() - 1);
+            }
+            m_table[pos] = index + 1;
+        }
+
+        void rebuild_table() {
+            std::size_t capacity = 8;
+            // Keep the load factor below one half.
+            while (capacity < m_indexed_rules.size() * 2) {
+                capacity *= 2;
+            }
+            m_table.assign(capacity, 0);
+            for (std::size_t i = 0; i < m_indexed_rules.size(); ++i) {
+                insert(i);
+            }
+        }
+
+        /**
+         * Look up the rule matching the specified key (and value, if value
+         * is not nullptr) in the hash index.
+         *
+         * @returns Index into m_rules of the first matching indexed rule
+         *          or no_rule.
+         */
+        std::size_t lookup(const char* key, const char* value) const noexcept {
+            if (m_indexed_rules.empty()) {
+                return no_rule;
+            }
+            return lookup_with_hash(hash_rule(key, value), key, std::strlen(key), value);
+        }
+
+        std::size_t lookup_with_hash(std::uint64_t hash, const char* key, std::size_t key_len, const char* value) const noexcept {
+            auto pos = static_cast<std::size_t>(hash) & (m_table.size() - 1);
+            while (m_table[pos] != 0) {
+                const auto& rule = m_indexed_rules[m_table[pos] - 1];
+                if (rule.key.size() == key_len &&
+                    !std::memcmp(rule.key.data(), key, key_len) &&
+                    rule.has_value == (value != nullptr) &&
+                    (!value || rule.value == value)) {
+                    return rule.rule_index;
+                }
+                pos = (pos + 1) & (m_table.size() - 1);
+            }
+            return no_rule;
+        }
+
+        /**
+         * Add the rule that was just appended to m_rules to the hash index
+         * if possible, to the scan list otherwise.
+         */
+        void index_rule() {
+            const std::size_t rule_index = m_rules.size() - 1;
+            const auto& matcher = m_rules.back().second;
+            const char* key = matcher.key_matcher().equal_string();
+            const char* value = nullptr;
+
+            bool indexable = (key != nullptr);
+            if (indexable && matcher.has_value_matcher()) {
+                value = matcher.value_matcher().equal_string();
+                indexable = (value != nullptr) && !matcher.inverted();
+            }
+
+            if (!indexable) {
+                m_scan_rules.push_back(rule_index);
+                return;
+            }
+
+            // Only the first rule for a key (and value) can ever match.
+            if (lookup(key, value) != no_rule) {
+                return;
+            }
+
+            m_indexed_rules.push_back(indexed_rule{key, value ? value : "", rule_index, value != nullptr});
+            if (m_indexed_rules.size() * 2 >= m_table.size()) {
+                rebuild_table();
+            } else {
+                insert(m_indexed_rules.size() - 1);
+            }
+        }
+
     public:
 
         using iterator = osmium::memory::CollectionFilterIterator<TagsFilterBase, const osmium::Tag>;
@@ -99,6 +242,7 @@ namespace osmium {
          */
         TagsFilterBase& add_rule(const TResult result, const TagMatcher& matcher) {
             m_rules.emplace_back(result, matcher);
+            index_rule();
             return *this;
         }
 
@@ -113,6 +257,7 @@ namespace osmium {
         template <typename... TArgs>
         TagsFilterBase& add_rule(const TResult result, TArgs&&... args) {
             m_rules.emplace_back(result, osmium::TagMatcher{std::forward<TArgs>(args)...});
+            index_rule();
             return *this;
         }
 
@@ -124,11 +269,46 @@ namespace osmium {
          *          matched, the default result.
          */
         TResult operator()(const osmium::Tag& tag) const noexcept {
-            for (const auto& rule : m_rules) {
-                if (rule.second(tag)) {
-                    return rule.first;
+            // The first rule that matches wins, so find the lowest-index
+            // matching rule from the hash index first, then scan only the
+            // rules that could not be indexed and come before it.
+            std::size_t best = no_rule;
+
+            if (!m_indexed_rules.empty()) {
+                // Scan the key only once: its length gives us the value
+                // pointer for free and the key hash is the common prefix
+                // of both rule hashes.
+                const char* key = tag.key();
+                const std::size_t key_len = std::strlen(key);
+                const char* value = key + key_len + 1;
+
+                const std::uint64_t key_hash = hash_string(14695981039346656037ULL, key, key_len);
+                std::uint64_t full_hash = key_hash;
+                full_hash ^= 0xffU; // separator, can not appear in UTF-8 strings
+                full_hash *= 1099511628211ULL;
+                full_hash = hash_string(full_hash, value);
+
+                best = lookup_with_hash(full_hash, key, key_len, value);
+
+                const std::size_t key_only = lookup_with_hash(key_hash, key, key_len, nullptr);
+                if (key_only < best) {
+                    best = key_only;
                 }
             }
+
+            for (const std::size_t i : m_scan_rules) {
+                if (i >= best) {
+                    break;
+                }
+                if (m_rules[i].second(tag)) {
+                    best = i;
+                    break;
+                }
+            }
+
+            if (best != no_rule) {
+                return m_rules[best].first;
+            }
             return m_default_result;
         }
 
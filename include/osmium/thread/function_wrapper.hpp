@@ -33,7 +33,9 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
-#include <memory>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 namespace osmium {
@@ -44,9 +46,19 @@ namespace osmium {
          * This function wrapper can collect move-only functions unlike
          * std::function which needs copyable functions.
          * Taken from the book "C++ Concurrency in Action".
+         *
+         * Small functors (and the thread pools only ever submit small
+         * ones, typically a few captured pointers) are stored inline in
+         * the wrapper itself, so submitting a task to a pool does not
+         * allocate. Only functors too large for the inline storage or
+         * with a throwing move constructor go to the heap.
          */
         class function_wrapper {
 
+            enum : std::size_t {
+                inline_size = 64
+            };
+
             struct impl_base {
 
                 impl_base() noexcept = default;
@@ -63,9 +75,12 @@ namespace osmium {
                     return true;
                 }
 
-            }; // struct impl_base
+                /// Move this impl into the given inline storage.
+                virtual impl_base* move_to(void* address) noexcept {
+                    return new (address) impl_base{};
+                }
 
-            std::unique_ptr<impl_base> impl;
+            }; // struct impl_base
 
             template <typename F>
             struct impl_type : impl_base {
@@ -81,8 +96,62 @@ namespace osmium {
                     return false;
                 }
 
+                impl_base* move_to(void* address) noexcept override {
+                    return new (address) impl_type{std::move(m_functor)};
+                }
+
             }; // struct impl_type
 
+            using storage_type = typename std::aligned_storage<inline_size, alignof(std::max_align_t)>::type;
+
+            /// Points into m_storage for inline impls, to the heap otherwise.
+            impl_base* m_impl = nullptr;
+
+            storage_type m_storage;
+
+            template <typename F>
+            using fits_inline = std::integral_constant<bool,
+                sizeof(impl_type<F>) <= inline_size &&
+                alignof(impl_type<F>) <= alignof(storage_type) &&
+                std::is_nothrow_move_constructible<F>::value>;
+
+            bool is_inline() const noexcept {
+                return static_cast<const void*>(m_impl) == static_cast<const void*>(&m_storage);
+            }
+
+            template <typename F>
+            void create(F&& functor, std::true_type /*inline*/) noexcept {
+                m_impl = new (&m_storage) impl_type<F>(std::forward<F>(functor));
+            }
+
+            template <typename F>
+            void create(F&& functor, std::false_type /*inline*/) {
+                m_impl = new impl_type<F>(std::forward<F>(functor));
+            }
+
+            void destroy() noexcept {
+                if (m_impl) {
+                    if (is_inline()) {
+                        m_impl->~impl_base();
+                    } else {
+                        delete m_impl;
+                    }
+                    m_impl = nullptr;
+                }
+            }
+
+            void move_from(function_wrapper&& other) noexcept {
+                if (other.m_impl == nullptr) {
+                    m_impl = nullptr;
+                } else if (other.is_inline()) {
+                    m_impl = other.m_impl->move_to(&m_storage);
+                    other.destroy();
+                } else {
+                    m_impl = other.m_impl;
+                    other.m_impl = nullptr;
+                }
+            }
+
         public:
 
             // Constructor must not be "explicit" for wrapper
@@ -90,19 +159,19 @@ namespace osmium {
             template <typename TFunction, typename X = typename std::enable_if<
                 !std::is_same<TFunction, function_wrapper>::value, void>::type>
             // cppcheck-suppress noExplicitConstructor
-            function_wrapper(TFunction&& f) : // NOLINT(google-explicit-constructor, hicpp-explicit-conversions)
-                impl(new impl_type<TFunction>(std::forward<TFunction>(f))) {
+            function_wrapper(TFunction&& f) { // NOLINT(google-explicit-constructor, hicpp-explicit-conversions)
+                create(std::forward<TFunction>(f), fits_inline<TFunction>{});
             }
 
             // The integer parameter is only used to signal that we want
             // the special function wrapper that makes the worker thread
             // shut down.
-            explicit function_wrapper(int /*dummy*/) :
-                impl(new impl_base()) {
+            explicit function_wrapper(int /*dummy*/) noexcept {
+                m_impl = new (&m_storage) impl_base{};
             }
 
             bool operator()() {
-                return impl->call();
+                return m_impl->call();
             }
 
             function_wrapper() = default;
@@ -110,19 +179,24 @@ namespace osmium {
             function_wrapper(const function_wrapper&) = delete;
             function_wrapper& operator=(const function_wrapper&) = delete;
 
-            function_wrapper(function_wrapper&& other) noexcept :
-                impl(std::move(other.impl)) {
+            function_wrapper(function_wrapper&& other) noexcept {
+                move_from(std::move(other));
             }
 
             function_wrapper& operator=(function_wrapper&& other) noexcept {
-                impl = std::move(other.impl);
+                if (this != &other) {
+                    destroy();
+                    move_from(std::move(other));
+                }
                 return *this;
             }
 
-            ~function_wrapper() = default;
+            ~function_wrapper() {
+                destroy();
+            }
 
             explicit operator bool() const {
-                return static_cast<bool>(impl);
+                return m_impl != nullptr;
             }
 
         }; // class function_wrapper
@@ -0,0 +1,212 @@
+#ifndef OSMIUM_THREAD_LOCKFREE_QUEUE_HPP
+#define OSMIUM_THREAD_LOCKFREE_QUEUE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace osmium {
+
+    namespace thread {
+
+        /**
+         * A bounded thread-safe multi-producer/multi-consumer queue that
+         * uses no locks on push and pop (the classic Vyukov ring-buffer
+         * design using per-cell sequence numbers). It has the same
+         * interface as osmium::thread::Queue and can be used as a drop-in
+         * replacement for it where the futex contention of the mutex-based
+         * queue becomes a bottleneck, for instance in the I/O blob
+         * pipelines with many decode threads.
+         *
+         * In contrast to osmium::thread::Queue the maximum size can not be
+         * 0 (unlimited): the queue needs a bounded ring. A full queue
+         * blocks producers and an empty queue blocks consumers, both by
+         * yielding, not by sleeping on a futex.
+         */
+        template <typename T>
+        class LockfreeQueue {
+
+            struct Cell {
+                std::atomic<std::size_t> sequence;
+                T value{};
+            };
+
+            enum : std::size_t {
+                default_max_size = 1024U
+            };
+
+            std::unique_ptr<Cell[]> m_cells;
+            std::size_t m_mask;
+
+            /// Name of this queue (for debugging only).
+            const std::string m_name;
+
+            // Enqueue and dequeue positions are separated by padding so
+            // producers and consumers don't share a cache line.
+            std::atomic<std::size_t> m_enqueue_pos{0};
+            char m_padding[64] = {};
+            std::atomic<std::size_t> m_dequeue_pos{0};
+
+            std::atomic<bool> m_in_use{true};
+
+            static std::size_t round_up_to_power_of_two(std::size_t value) noexcept {
+                std::size_t result = 2;
+                while (result < value) {
+                    result *= 2;
+                }
+                return result;
+            }
+
+            bool try_push(T&& value) {
+                std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                while (true) {
+                    Cell& cell = m_cells[pos & m_mask];
+                    const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                    if (diff == 0) {
+                        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            cell.value = std::move(value);
+                            cell.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        return false; // queue is full
+                    } else {
+                        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+        public:
+
+            /**
+             * Construct a multithreaded queue.
+             *
+             * @param max_size Maximum number of elements in the queue,
+             *                 rounded up to the next power of two. Set to 0
+             *                 to get the default size.
+             * @param name Optional name for this queue. (Used for debugging.)
+             */
+            explicit LockfreeQueue(std::size_t max_size = 0, std::string name = "") :
+                m_cells(new Cell[round_up_to_power_of_two(max_size == 0 ? default_max_size : max_size)]),
+                m_mask(round_up_to_power_of_two(max_size == 0 ? default_max_size : max_size) - 1),
+                m_name(std::move(name)) {
+                for (std::size_t i = 0; i <= m_mask; ++i) {
+                    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            LockfreeQueue(const LockfreeQueue&) = delete;
+            LockfreeQueue& operator=(const LockfreeQueue&) = delete;
+
+            LockfreeQueue(LockfreeQueue&&) = delete;
+            LockfreeQueue& operator=(LockfreeQueue&&) = delete;
+
+            ~LockfreeQueue() = default;
+
+            /**
+             * Push an element onto the queue. This call will block (by
+             * yielding) if the queue is full.
+             */
+            void push(T value) {
+                while (m_in_use) {
+                    if (try_push(std::move(value))) {
+                        return;
+                    }
+                    std::this_thread::yield();
+                }
+            }
+
+            void wait_and_pop(T& value) {
+                while (!try_pop(value)) {
+                    if (!m_in_use) {
+                        return;
+                    }
+                    std::this_thread::yield();
+                }
+            }
+
+            bool try_pop(T& value) {
+                std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                while (true) {
+                    Cell& cell = m_cells[pos & m_mask];
+                    const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+                    if (diff == 0) {
+                        if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            value = std::move(cell.value);
+                            cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        return false; // queue is empty
+                    } else {
+                        pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            bool empty() const {
+                return m_dequeue_pos.load(std::memory_order_acquire) ==
+                       m_enqueue_pos.load(std::memory_order_acquire);
+            }
+
+            std::size_t size() const {
+                const auto dequeue_pos = m_dequeue_pos.load(std::memory_order_acquire);
+                const auto enqueue_pos = m_enqueue_pos.load(std::memory_order_acquire);
+                return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+            }
+
+            bool in_use() const noexcept {
+                return m_in_use;
+            }
+
+            void shutdown() {
+                m_in_use = false;
+                T value;
+                while (try_pop(value)) {
+                }
+            }
+
+        }; // class LockfreeQueue
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_LOCKFREE_QUEUE_HPP
@@ -40,6 +40,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <cstddef>
 #include <future>
+#include <stdexcept>
 #include <thread>
 #include <type_traits>
 #include <utility>
@@ -84,6 +85,51 @@ namespace osmium {
 
         } // namespace detail
 
+        /**
+         * Policy describing how a thread pool should be set up. Use this
+         * to partition the cores of a machine between several pools or
+         * co-located services: restricting a pool to the CPUs of one NUMA
+         * node keeps the worker threads close to the memory they work on.
+         *
+         * Can be given to the Pool constructor for per-Reader/Writer
+         * pools or, before its first use, to Pool::set_default_policy()
+         * for the default pool.
+         */
+        struct PoolPolicy {
+
+            /**
+             * CPUs the worker threads are restricted to. If this is empty
+             * the threads can run on any CPU. Only works on Linux, on
+             * other systems it is ignored.
+             */
+            std::vector<int> cpus{};
+
+            /**
+             * Number of worker threads. Interpreted the same way as the
+             * num_threads argument of the Pool constructor.
+             */
+            int num_threads = 0;
+
+            /**
+             * Maximum size of the work queue. If this is 0, the queue
+             * size is read from the environment variable
+             * OSMIUM_MAX_WORK_QUEUE_SIZE.
+             */
+            std::size_t max_queue_size = 0;
+
+        }; // struct PoolPolicy
+
+        /**
+         * Priority of a task submitted to a thread pool. Use high
+         * priority for latency-sensitive work that shares a pool with
+         * bulk jobs, for instance change file processing running next to
+         * re-compression tasks.
+         */
+        enum class priority {
+            normal, ///< Task runs after all tasks already in the queue.
+            high    ///< Task runs before all queued normal-priority tasks.
+        }; // enum class priority
+
         /**
          *  Thread pool.
          */
@@ -120,12 +166,16 @@ namespace osmium {
             }; // class thread_joiner
 
             osmium::thread::Queue<function_wrapper> m_work_queue;
+            std::vector<int> m_cpus;
             std::vector<std::thread> m_threads{};
             thread_joiner m_joiner;
             int m_num_threads;
 
             void worker_thread() {
                 osmium::thread::set_thread_name("_osmium_worker");
+                if (!m_cpus.empty()) {
+                    osmium::thread::set_thread_affinity(m_cpus);
+                }
                 while (true) {
                     function_wrapper task;
                     m_work_queue.wait_and_pop(task);
@@ -137,6 +187,32 @@ namespace osmium {
                 }
             }
 
+            Pool(const int num_threads, const std::size_t max_queue_size, std::vector<int> cpus) :
+                m_work_queue(max_queue_size > 0 ? max_queue_size : detail::get_work_queue_size(), "work"),
+                m_cpus(std::move(cpus)),
+                m_joiner(m_threads),
+                m_num_threads(detail::get_pool_size(num_threads, osmium::config::get_pool_threads(), std::thread::hardware_concurrency())) {
+
+                try {
+                    for (int i = 0; i < m_num_threads; ++i) {
+                        m_threads.emplace_back(&Pool::worker_thread, this);
+                    }
+                } catch (...) {
+                    shutdown_all_workers();
+                    throw;
+                }
+            }
+
+            static PoolPolicy& default_policy_instance() {
+                static PoolPolicy policy{};
+                return policy;
+            }
+
+            static bool& default_instance_created() {
+                static bool created = false;
+                return created;
+            }
+
         public:
 
             enum {
@@ -163,28 +239,43 @@ namespace osmium {
              * the environment variable OSMIUM_MAX_WORK_QUEUE_SIZE.
              */
             explicit Pool(int num_threads = default_num_threads, std::size_t max_queue_size = default_queue_size) :
-                m_work_queue(max_queue_size > 0 ? max_queue_size : detail::get_work_queue_size(), "work"),
-                m_joiner(m_threads),
-                m_num_threads(detail::get_pool_size(num_threads, osmium::config::get_pool_threads(), std::thread::hardware_concurrency())) {
+                Pool(num_threads, max_queue_size, {}) {
+            }
 
-                try {
-                    for (int i = 0; i < m_num_threads; ++i) {
-                        m_threads.emplace_back(&Pool::worker_thread, this);
-                    }
-                } catch (...) {
-                    shutdown_all_workers();
-                    throw;
+            /**
+             * Create thread pool according to the given policy. The worker
+             * threads are restricted to the CPUs in the policy, if any.
+             */
+            explicit Pool(const PoolPolicy& policy) :
+                Pool(policy.num_threads, policy.max_queue_size, policy.cpus) {
+            }
+
+            /**
+             * Set the policy used for creating the default pool. Must be
+             * called before default_instance() is used for the first time
+             * and is not thread-safe, so call it early in your program
+             * before any threads are started.
+             *
+             * @throws std::logic_error If the default pool has already
+             *         been created.
+             */
+            static void set_default_policy(const PoolPolicy& policy) {
+                if (default_instance_created()) {
+                    throw std::logic_error{"Call osmium::thread::Pool::set_default_policy() before the default pool is first used"};
                 }
+                default_policy_instance() = policy;
             }
 
             /**
              * Return a statically created "default pool". This is initialized
-             * the first time you use it.
+             * the first time you use it, using the policy set with
+             * set_default_policy(), if any.
              *
              * Do not use this if your program will fork.
              */
             static Pool& default_instance() {
-                static Pool pool{};
+                default_instance_created() = true;
+                static Pool pool{default_policy_instance()};
                 return pool;
             }
 
@@ -228,11 +319,22 @@ namespace osmium {
             using submit_func_result_type = typename std::result_of<TFunction()>::type;
 #endif
 
+            /**
+             * Submit a task to the pool. Tasks of the same priority are
+             * run in submission order; tasks with priority::high jump
+             * ahead of all queued normal-priority tasks, so
+             * latency-critical work is not stuck behind bulk work filling
+             * the queue.
+             */
             template <typename TFunction>
-            std::future<submit_func_result_type<TFunction>> submit(TFunction&& func) {
+            std::future<submit_func_result_type<TFunction>> submit(TFunction&& func, priority prio = priority::normal) {
                 std::packaged_task<submit_func_result_type<TFunction>()> task{std::forward<TFunction>(func)};
                 std::future<submit_func_result_type<TFunction>> future_result{task.get_future()};
-                m_work_queue.push(std::move(task));
+                if (prio == priority::high) {
+                    m_work_queue.push_priority(std::move(task));
+                } else {
+                    m_work_queue.push(std::move(task));
+                }
 
                 return future_result;
             }
@@ -33,14 +33,19 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/memory.hpp>
+
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <mutex>
-#include <queue>
 #include <string>
 #include <utility> // IWYU pragma: keep
+#include <vector>
 
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
 # include <iostream>
@@ -50,22 +55,260 @@ namespace osmium {
 
     namespace thread {
 
+        /// Number of buckets in the queue wait-time histograms.
+        constexpr const std::size_t queue_wait_histogram_buckets = 24;
+
+        class QueueMetrics;
+
+        /**
+         * Registry of all live queues. Every Queue registers itself here
+         * on construction and removes itself on destruction, so the
+         * queues of a running pipeline can be enumerated by name and
+         * their metrics dumped, for instance periodically from a
+         * monitoring thread, without any cooperation from the code that
+         * created them.
+         *
+         * @code
+         * for (const auto& queue : osmium::thread::QueueRegistry::instance().snapshots()) {
+         *     std::cerr << queue.name << ": " << queue.size << " of "
+         *               << queue.largest_size << " max\n";
+         * }
+         * @endcode
+         */
+        class QueueRegistry {
+
+        public:
+
+            /// Metrics of one queue at one point in time.
+            struct snapshot_type {
+                std::string name{};
+                std::size_t size = 0;
+                std::size_t largest_size = 0;
+                std::uint64_t push_wait_ns = 0;
+                std::uint64_t pop_wait_ns = 0;
+                std::array<std::uint64_t, queue_wait_histogram_buckets> push_wait_histogram{};
+                std::array<std::uint64_t, queue_wait_histogram_buckets> pop_wait_histogram{};
+            };
+
+        private:
+
+            mutable std::mutex m_mutex;
+            std::vector<const QueueMetrics*> m_queues{};
+
+            QueueRegistry() = default;
+
+        public:
+
+            static QueueRegistry& instance() {
+                static QueueRegistry registry{};
+                return registry;
+            }
+
+            QueueRegistry(const QueueRegistry&) = delete;
+            QueueRegistry& operator=(const QueueRegistry&) = delete;
+
+            QueueRegistry(QueueRegistry&&) = delete;
+            QueueRegistry& operator=(QueueRegistry&&) = delete;
+
+            ~QueueRegistry() noexcept = default;
+
+            void add(const QueueMetrics* queue) {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                m_queues.push_back(queue);
+            }
+
+            void remove(const QueueMetrics* queue) {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                for (auto it = m_queues.begin(); it != m_queues.end(); ++it) {
+                    if (*it == queue) {
+                        m_queues.erase(it);
+                        return;
+                    }
+                }
+            }
+
+            /// Get metrics snapshots of all live queues.
+            std::vector<snapshot_type> snapshots() const; // defined below
+
+        }; // class QueueRegistry
+
+        /**
+         * Metrics collected by every Queue: the depth high-watermark and
+         * total wait times and wait-time histograms for the producer
+         * (queue full) and consumer (queue empty) side. All counters are
+         * atomics updated with relaxed ordering, so collecting them adds
+         * nothing to the queue locking and reading them at any time is
+         * safe. Queues are enumerable through the QueueRegistry.
+         */
+        class QueueMetrics {
+
+        public:
+
+            using histogram_type = std::array<std::uint64_t, queue_wait_histogram_buckets>;
+
+        private:
+
+            /// Name of this queue (for debugging and monitoring only).
+            const std::string m_name;
+
+            std::atomic<std::size_t> m_current_size{0};
+
+            /// The largest size the queue has been so far.
+            std::atomic<std::size_t> m_largest_size{0};
+
+            /// Time producers spent blocked because the queue was full.
+            std::atomic<std::uint64_t> m_push_wait_ns{0};
+
+            /// Time consumers spent blocked because the queue was empty.
+            std::atomic<std::uint64_t> m_pop_wait_ns{0};
+
+            std::array<std::atomic<std::uint64_t>, queue_wait_histogram_buckets> m_push_wait_histogram{};
+            std::array<std::atomic<std::uint64_t>, queue_wait_histogram_buckets> m_pop_wait_histogram{};
+
+            /**
+             * Histogram bucket for a wait time: bucket 0 is under one
+             * microsecond, every further bucket doubles, the last bucket
+             * collects everything from about 4 seconds up.
+             */
+            static std::size_t wait_bucket(std::uint64_t wait_ns) noexcept {
+                std::uint64_t us = wait_ns / 1000;
+                std::size_t bucket = 0;
+                while (us != 0 && bucket < queue_wait_histogram_buckets - 1) {
+                    us >>= 1;
+                    ++bucket;
+                }
+                return bucket;
+            }
+
+            static histogram_type load_histogram(const std::array<std::atomic<std::uint64_t>, queue_wait_histogram_buckets>& histogram) noexcept {
+                histogram_type result{};
+                for (std::size_t i = 0; i < queue_wait_histogram_buckets; ++i) {
+                    result[i] = histogram[i].load(std::memory_order_relaxed);
+                }
+                return result;
+            }
+
+        protected:
+
+            explicit QueueMetrics(std::string name) :
+                m_name(std::move(name)) {
+                QueueRegistry::instance().add(this);
+            }
+
+            ~QueueMetrics() noexcept {
+                QueueRegistry::instance().remove(this);
+            }
+
+            void metrics_note_size(const std::size_t size) noexcept {
+                m_current_size.store(size, std::memory_order_relaxed);
+                std::size_t largest = m_largest_size.load(std::memory_order_relaxed);
+                while (size > largest &&
+                       !m_largest_size.compare_exchange_weak(largest, size, std::memory_order_relaxed)) {
+                }
+            }
+
+            void metrics_add_push_wait(const std::uint64_t wait_ns) noexcept {
+                m_push_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+                m_push_wait_histogram[wait_bucket(wait_ns)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void metrics_add_pop_wait(const std::uint64_t wait_ns) noexcept {
+                m_pop_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+                m_pop_wait_histogram[wait_bucket(wait_ns)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+        public:
+
+            QueueMetrics(const QueueMetrics&) = delete;
+            QueueMetrics& operator=(const QueueMetrics&) = delete;
+
+            QueueMetrics(QueueMetrics&&) = delete;
+            QueueMetrics& operator=(QueueMetrics&&) = delete;
+
+            const std::string& name() const noexcept {
+                return m_name;
+            }
+
+            /// The largest size the queue has had so far.
+            std::size_t largest_size() const noexcept {
+                return m_largest_size.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * Total time producers spent blocked in push() because the
+             * queue was full, in nanoseconds.
+             */
+            std::uint64_t push_wait_nanoseconds() const noexcept {
+                return m_push_wait_ns.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * Total time consumers spent blocked in wait_and_pop() because
+             * the queue was empty, in nanoseconds.
+             */
+            std::uint64_t pop_wait_nanoseconds() const noexcept {
+                return m_pop_wait_ns.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * Histogram of individual producer wait times. Bucket 0 is
+             * under one microsecond, every further bucket doubles.
+             */
+            histogram_type push_wait_histogram() const noexcept {
+                return load_histogram(m_push_wait_histogram);
+            }
+
+            /**
+             * Histogram of individual consumer wait times. Bucket 0 is
+             * under one microsecond, every further bucket doubles.
+             */
+            histogram_type pop_wait_histogram() const noexcept {
+                return load_histogram(m_pop_wait_histogram);
+            }
+
+            /// Get a snapshot of all metrics of this queue.
+            QueueRegistry::snapshot_type snapshot() const {
+                QueueRegistry::snapshot_type result;
+                result.name = m_name;
+                result.size = m_current_size.load(std::memory_order_relaxed);
+                result.largest_size = largest_size();
+                result.push_wait_ns = push_wait_nanoseconds();
+                result.pop_wait_ns = pop_wait_nanoseconds();
+                result.push_wait_histogram = push_wait_histogram();
+                result.pop_wait_histogram = pop_wait_histogram();
+                return result;
+            }
+
+        }; // class QueueMetrics
+
+        inline std::vector<QueueRegistry::snapshot_type> QueueRegistry::snapshots() const {
+            std::vector<snapshot_type> result;
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            result.reserve(m_queues.size());
+            for (const auto* queue : m_queues) {
+                result.push_back(queue->snapshot());
+            }
+            return result;
+        }
+
         /**
          *  A thread-safe queue.
          */
         template <typename T>
-        class Queue {
+        class Queue : public QueueMetrics {
 
             /// Maximum size of this queue. If the queue is full pushing to
-            /// the queue will block.
-            const std::size_t m_max_size;
-
-            /// Name of this queue (for debugging only).
-            const std::string m_name;
+            /// the queue will block. Can be changed while the queue is in
+            /// use with set_max_size().
+            std::atomic<std::size_t> m_max_size;
 
             mutable std::mutex m_mutex;
 
-            std::queue<T> m_queue;
+            std::deque<T> m_queue;
+
+            /// Number of elements pushed with push_priority() still at the
+            /// head of the queue. Only updated while m_mutex is held.
+            std::size_t m_prio_count = 0;
 
             /// Used to signal consumers when data is available in the queue.
             std::condition_variable m_data_available;
@@ -75,10 +318,40 @@ namespace osmium {
 
             std::atomic<bool> m_in_use{true};
 
+            /// Accounts for the queue elements themselves, not for any
+            /// memory owned by them (the contents of queued buffers are
+            /// accounted for by their own subsystem). Only updated while
+            /// m_mutex is held.
+            osmium::MemoryAccounting::tracker m_memory_tracker{osmium::MemoryAccounting::subsystem::queues};
+
+            void update_memory_tracker() noexcept {
+                m_memory_tracker.update(m_queue.size() * sizeof(T));
+                metrics_note_size(m_queue.size());
+            }
+
+            static std::uint64_t elapsed_ns(const std::chrono::steady_clock::time_point start) noexcept {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            }
+
+            /// Wait until the queue has room for one more element.
+            void wait_for_space() {
+                constexpr const std::chrono::milliseconds max_wait{10};
+                if (m_max_size && size() >= m_max_size) {
+                    const auto start = std::chrono::steady_clock::now();
+                    while (size() >= m_max_size) {
+                        std::unique_lock<std::mutex> lock{m_mutex};
+                        m_space_available.wait_for(lock, max_wait, [this] {
+                            return m_queue.size() < m_max_size;
+                        });
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
-            /// The largest size the queue has been so far.
-            std::size_t m_largest_size;
+                        ++m_full_counter;
+#endif
+                    }
+                    metrics_add_push_wait(elapsed_ns(start));
+                }
+            }
 
+#ifdef OSMIUM_DEBUG_QUEUE_SIZE
             /// The number of times push() was called on the queue.
             std::atomic<int> m_push_counter;
 
@@ -107,12 +380,11 @@ namespace osmium {
              * @param name Optional name for this queue. (Used for debugging.)
              */
             explicit Queue(std::size_t max_size = 0, std::string name = "") :
+                QueueMetrics(std::move(name)),
                 m_max_size(max_size),
-                m_name(std::move(name)),
                 m_queue()
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 ,
-                m_largest_size(0),
                 m_push_counter(0),
                 m_full_counter(0),
                 m_pop_counter(0),
@@ -129,9 +401,9 @@ namespace osmium {
 
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
             ~Queue() {
-                std::cerr << "queue '" << m_name
+                std::cerr << "queue '" << name()
                           << "' with max_size=" << m_max_size
-                          << " had largest size " << m_largest_size
+                          << " had largest size " << largest_size()
                           << " and was full " << m_full_counter
                           << " times in " << m_push_counter
                           << " push() calls and was empty " << m_empty_counter
@@ -150,28 +422,36 @@ namespace osmium {
                 if (!m_in_use) {
                     return;
                 }
-                constexpr const std::chrono::milliseconds max_wait{10};
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 ++m_push_counter;
 #endif
-                if (m_max_size) {
-                    while (size() >= m_max_size) {
-                        std::unique_lock<std::mutex> lock{m_mutex};
-                        m_space_available.wait_for(lock, max_wait, [this] {
-                            return m_queue.size() < m_max_size;
-                        });
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                        ++m_full_counter;
-#endif
-                    }
-                }
+                wait_for_space();
                 const std::lock_guard<std::mutex> lock{m_mutex};
-                m_queue.push(std::move(value));
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                if (m_largest_size < m_queue.size()) {
-                    m_largest_size = m_queue.size();
+                m_queue.push_back(std::move(value));
+                update_memory_tracker();
+                m_data_available.notify_one();
+            }
+
+            /**
+             * Push an element onto the queue ahead of all elements pushed
+             * with push(), but behind any elements pushed with this
+             * function that are still in the queue, so priority elements
+             * are popped in FIFO order among themselves. If the queue has
+             * a max size, this call will block if the queue is full, just
+             * like push().
+             */
+            void push_priority(T value) {
+                if (!m_in_use) {
+                    return;
                 }
+#ifdef OSMIUM_DEBUG_QUEUE_SIZE
+                ++m_push_counter;
 #endif
+                wait_for_space();
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                m_queue.insert(m_queue.begin() + static_cast<std::ptrdiff_t>(m_prio_count), std::move(value));
+                ++m_prio_count;
+                update_memory_tracker();
                 m_data_available.notify_one();
             }
 
@@ -185,12 +465,20 @@ namespace osmium {
                     ++m_empty_counter;
                 }
 #endif
-                m_data_available.wait(lock, [this] {
-                    return !m_in_use || !m_queue.empty();
-                });
+                if (m_in_use && m_queue.empty()) {
+                    const auto start = std::chrono::steady_clock::now();
+                    m_data_available.wait(lock, [this] {
+                        return !m_in_use || !m_queue.empty();
+                    });
+                    metrics_add_pop_wait(elapsed_ns(start));
+                }
                 if (!m_queue.empty()) {
                     value = std::move(m_queue.front());
-                    m_queue.pop();
+                    m_queue.pop_front();
+                    if (m_prio_count > 0) {
+                        --m_prio_count;
+                    }
+                    update_memory_tracker();
                     lock.unlock();
                     if (m_max_size) {
                         m_space_available.notify_one();
@@ -211,7 +499,11 @@ namespace osmium {
                         return false;
                     }
                     value = std::move(m_queue.front());
-                    m_queue.pop();
+                    m_queue.pop_front();
+                    if (m_prio_count > 0) {
+                        --m_prio_count;
+                    }
+                    update_memory_tracker();
                 }
                 if (m_max_size) {
                     m_space_available.notify_one();
@@ -229,6 +521,21 @@ namespace osmium {
                 return m_queue.size();
             }
 
+            std::size_t max_size() const noexcept {
+                return m_max_size;
+            }
+
+            /**
+             * Change the maximum size of the queue. Can be called while the
+             * queue is in use. Setting it to 0 makes the size unlimited.
+             * Shrinking the queue does not remove elements, it just blocks
+             * producers until consumers have caught up.
+             */
+            void set_max_size(const std::size_t max_size) {
+                m_max_size = max_size;
+                m_space_available.notify_all();
+            }
+
             bool in_use() const noexcept {
                 return m_in_use;
             }
@@ -236,9 +543,9 @@ namespace osmium {
             void shutdown() {
                 m_in_use = false;
                 const std::lock_guard<std::mutex> lock{m_mutex};
-                while (!m_queue.empty()) {
-                    m_queue.pop();
-                }
+                m_queue.clear();
+                m_prio_count = 0;
+                update_memory_tracker();
                 m_data_available.notify_all();
             }
 
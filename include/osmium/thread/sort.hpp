@@ -0,0 +1,124 @@
+#ifndef OSMIUM_THREAD_SORT_HPP
+#define OSMIUM_THREAD_SORT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace thread {
+
+        /**
+         * Sort the given range using multiple threads from the given
+         * thread pool. This is a parallel merge sort: the range is split
+         * into one chunk per thread, the chunks are sorted in parallel
+         * and then merged in parallel rounds. Like std::stable_sort the
+         * order of equal elements is preserved.
+         *
+         * For small ranges this falls back to a single-threaded sort.
+         */
+        template <typename TRandomIt, typename TCompare>
+        void parallel_sort(TRandomIt begin, TRandomIt end, TCompare&& compare, Pool& pool) {
+            // Smaller chunks are not worth the thread overhead.
+            constexpr const std::size_t min_chunk_size = 64UL * 1024UL;
+
+            const auto size = static_cast<std::size_t>(std::distance(begin, end));
+            const std::size_t num_chunks = std::min<std::size_t>(static_cast<std::size_t>(pool.num_threads()),
+                                                                 size / min_chunk_size);
+            if (num_chunks < 2) {
+                std::stable_sort(begin, end, std::forward<TCompare>(compare));
+                return;
+            }
+
+            // Split into roughly equal-sized chunks and sort each chunk
+            // on the pool.
+            std::vector<std::size_t> bounds;
+            bounds.reserve(num_chunks + 1);
+            for (std::size_t i = 0; i <= num_chunks; ++i) {
+                bounds.push_back(size * i / num_chunks);
+            }
+
+            std::vector<std::future<void>> futures;
+            futures.reserve(num_chunks);
+            for (std::size_t i = 0; i < num_chunks; ++i) {
+                futures.push_back(pool.submit([begin, &bounds, i, &compare]() {
+                    std::stable_sort(begin + static_cast<std::ptrdiff_t>(bounds[i]),
+                                     begin + static_cast<std::ptrdiff_t>(bounds[i + 1]),
+                                     compare);
+                }));
+            }
+            for (auto& future : futures) {
+                future.get();
+            }
+
+            // Merge pairs of neighbouring chunks until only one is left.
+            // The merges in each round are independent of each other and
+            // run in parallel on the pool.
+            while (bounds.size() > 2) {
+                futures.clear();
+                std::vector<std::size_t> merged_bounds;
+                merged_bounds.reserve(bounds.size() / 2 + 1);
+                merged_bounds.push_back(bounds.front());
+                for (std::size_t i = 0; i + 2 < bounds.size(); i += 2) {
+                    futures.push_back(pool.submit([begin, &bounds, i, &compare]() {
+                        std::inplace_merge(begin + static_cast<std::ptrdiff_t>(bounds[i]),
+                                           begin + static_cast<std::ptrdiff_t>(bounds[i + 1]),
+                                           begin + static_cast<std::ptrdiff_t>(bounds[i + 2]),
+                                           compare);
+                    }));
+                    merged_bounds.push_back(bounds[i + 2]);
+                }
+                if (merged_bounds.back() != bounds.back()) {
+                    // Odd number of chunks, the last one carries over.
+                    merged_bounds.push_back(bounds.back());
+                }
+                for (auto& future : futures) {
+                    future.get();
+                }
+                bounds = std::move(merged_bounds);
+            }
+        }
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_SORT_HPP
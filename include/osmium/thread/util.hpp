@@ -37,8 +37,11 @@ DEALINGS IN THE SOFTWARE.
 #include <future>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #if defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
 # include <sys/prctl.h>
 #elif defined(__FreeBSD__)
 # include <pthread.h>
@@ -88,6 +91,31 @@ namespace osmium {
         }
 #endif
 
+        /**
+         * Restrict the current thread to the given set of CPUs. Returns
+         * true if the affinity was set. This currently only works on
+         * Linux, on other systems it does nothing and returns false.
+         */
+#if defined(__linux__)
+        inline bool set_thread_affinity(const std::vector<int>& cpus) noexcept {
+            if (cpus.empty()) {
+                return false;
+            }
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            for (const int cpu : cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &cpuset); // NOLINT(hicpp-signed-bitwise)
+                }
+            }
+            return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+        }
+#else
+        inline bool set_thread_affinity(const std::vector<int>& /*cpus*/) noexcept {
+            return false;
+        }
+#endif
+
         class thread_handler {
 
             std::thread m_thread;
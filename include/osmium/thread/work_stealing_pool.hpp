@@ -0,0 +1,347 @@
+#ifndef OSMIUM_THREAD_WORK_STEALING_POOL_HPP
+#define OSMIUM_THREAD_WORK_STEALING_POOL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/thread/function_wrapper.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/util.hpp>
+#include <osmium/util/config.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace thread {
+
+        namespace detail {
+
+            /**
+             * Bounded lock-free multi-producer/multi-consumer task ring
+             * (the classic Vyukov design using per-cell sequence numbers).
+             * Both try_push() and try_pop() never block, they fail when the
+             * ring is full or empty, respectively.
+             */
+            class TaskRing {
+
+                struct Cell {
+                    std::atomic<std::size_t> sequence;
+                    function_wrapper task{};
+                };
+
+                std::unique_ptr<Cell[]> m_cells;
+                std::size_t m_mask;
+
+                // Enqueue and dequeue positions are separated by padding so
+                // producers and consumers don't share a cache line.
+                std::atomic<std::size_t> m_enqueue_pos{0};
+                char m_padding[64] = {};
+                std::atomic<std::size_t> m_dequeue_pos{0};
+
+                static std::size_t round_up_to_power_of_two(std::size_t value) noexcept {
+                    std::size_t result = 2;
+                    while (result < value) {
+                        result *= 2;
+                    }
+                    return result;
+                }
+
+            public:
+
+                explicit TaskRing(std::size_t capacity) :
+                    m_cells(new Cell[round_up_to_power_of_two(capacity)]),
+                    m_mask(round_up_to_power_of_two(capacity) - 1) {
+                    for (std::size_t i = 0; i <= m_mask; ++i) {
+                        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                    }
+                }
+
+                TaskRing(const TaskRing&) = delete;
+                TaskRing& operator=(const TaskRing&) = delete;
+
+                TaskRing(TaskRing&&) = delete;
+                TaskRing& operator=(TaskRing&&) = delete;
+
+                ~TaskRing() noexcept = default;
+
+                bool try_push(function_wrapper&& task) {
+                    std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                    while (true) {
+                        Cell& cell = m_cells[pos & m_mask];
+                        const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                        const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                        if (diff == 0) {
+                            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                                cell.task = std::move(task);
+                                cell.sequence.store(pos + 1, std::memory_order_release);
+                                return true;
+                            }
+                        } else if (diff < 0) {
+                            return false; // ring is full
+                        } else {
+                            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                bool try_pop(function_wrapper& task) {
+                    std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                    while (true) {
+                        Cell& cell = m_cells[pos & m_mask];
+                        const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                        const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+                        if (diff == 0) {
+                            if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                                task = std::move(cell.task);
+                                cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                                return true;
+                            }
+                        } else if (diff < 0) {
+                            return false; // ring is empty
+                        } else {
+                            pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+
+                bool empty() const noexcept {
+                    return m_dequeue_pos.load(std::memory_order_acquire) ==
+                           m_enqueue_pos.load(std::memory_order_acquire);
+                }
+
+                std::size_t size() const noexcept {
+                    const auto dequeue_pos = m_dequeue_pos.load(std::memory_order_acquire);
+                    const auto enqueue_pos = m_enqueue_pos.load(std::memory_order_acquire);
+                    return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+                }
+
+            }; // class TaskRing
+
+        } // namespace detail
+
+        /**
+         * Work-stealing thread pool. In contrast to osmium::thread::Pool
+         * which funnels all tasks through one central mutex-protected
+         * queue, each worker here has its own lock-free task ring.
+         * Submitted tasks are distributed round-robin over the rings and
+         * an idle worker that finds its own ring empty steals work from
+         * the other rings without taking any locks. This scales much
+         * better on machines with many cores.
+         *
+         * The submit() interface is the same as on osmium::thread::Pool,
+         * so the two can be used interchangeably.
+         */
+        class WorkStealingPool {
+
+            std::vector<std::unique_ptr<detail::TaskRing>> m_queues{};
+            std::vector<std::thread> m_threads{};
+
+            // Sleeping workers wait here until new work is submitted.
+            std::mutex m_wakeup_mutex{};
+            std::condition_variable m_wakeup_cond{};
+
+            std::atomic<std::size_t> m_next_queue{0};
+            std::atomic<bool> m_shutdown{false};
+
+            int m_num_threads;
+
+            bool try_get_task(const std::size_t worker_id, function_wrapper& task) {
+                if (m_queues[worker_id]->try_pop(task)) {
+                    return true;
+                }
+                // Steal from the other workers, starting with our neighbor
+                // so not everybody hammers the same ring.
+                for (std::size_t i = 1; i < m_queues.size(); ++i) {
+                    if (m_queues[(worker_id + i) % m_queues.size()]->try_pop(task)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void worker_thread(const std::size_t worker_id) {
+                osmium::thread::set_thread_name("_osmium_worker");
+                while (true) {
+                    function_wrapper task;
+                    if (try_get_task(worker_id, task)) {
+                        task();
+                        continue;
+                    }
+                    if (m_shutdown.load(std::memory_order_acquire)) {
+                        // Don't exit while there might still be work
+                        // somewhere in the rings.
+                        if (try_get_task(worker_id, task)) {
+                            task();
+                            continue;
+                        }
+                        return;
+                    }
+                    std::unique_lock<std::mutex> lock{m_wakeup_mutex};
+                    m_wakeup_cond.wait_for(lock, std::chrono::milliseconds(10));
+                }
+            }
+
+            void push(function_wrapper&& task) {
+                const std::size_t start = m_next_queue.fetch_add(1, std::memory_order_relaxed);
+                while (true) {
+                    for (std::size_t i = 0; i < m_queues.size(); ++i) {
+                        if (m_queues[(start + i) % m_queues.size()]->try_push(std::move(task))) {
+                            m_wakeup_cond.notify_one();
+                            return;
+                        }
+                    }
+                    // All rings are full. Back off and let the workers
+                    // catch up, this is the same backpressure behaviour
+                    // the bounded central queue gives us.
+                    std::this_thread::yield();
+                }
+            }
+
+        public:
+
+            enum {
+                default_num_threads = 0
+            };
+
+            enum {
+                default_queue_size = 0U
+            };
+
+            /**
+             * Create work-stealing thread pool with the given number of
+             * threads. The num_threads and max_queue_size parameters are
+             * interpreted exactly like the ones on osmium::thread::Pool,
+             * except that max_queue_size is the task capacity per worker.
+             */
+            explicit WorkStealingPool(int num_threads = default_num_threads, std::size_t max_queue_size = default_queue_size) :
+                m_num_threads(detail::get_pool_size(num_threads, osmium::config::get_pool_threads(), std::thread::hardware_concurrency())) {
+
+                const std::size_t queue_size = max_queue_size > 0 ? max_queue_size : detail::get_work_queue_size();
+
+                for (int i = 0; i < m_num_threads; ++i) {
+                    m_queues.emplace_back(new detail::TaskRing{queue_size});
+                }
+
+                try {
+                    for (int i = 0; i < m_num_threads; ++i) {
+                        m_threads.emplace_back(&WorkStealingPool::worker_thread, this, static_cast<std::size_t>(i));
+                    }
+                } catch (...) {
+                    shutdown_all_workers();
+                    for (auto& thread : m_threads) {
+                        if (thread.joinable()) {
+                            thread.join();
+                        }
+                    }
+                    throw;
+                }
+            }
+
+            /**
+             * Return a statically created "default pool". This is initialized
+             * the first time you use it.
+             *
+             * Do not use this if your program will fork.
+             */
+            static WorkStealingPool& default_instance() {
+                static WorkStealingPool pool{};
+                return pool;
+            }
+
+            void shutdown_all_workers() {
+                m_shutdown.store(true, std::memory_order_release);
+                m_wakeup_cond.notify_all();
+            }
+
+            WorkStealingPool(const WorkStealingPool&) = delete;
+            WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+            WorkStealingPool(WorkStealingPool&&) = delete;
+            WorkStealingPool& operator=(WorkStealingPool&&) = delete;
+
+            ~WorkStealingPool() {
+                shutdown_all_workers();
+                for (auto& thread : m_threads) {
+                    if (thread.joinable()) {
+                        thread.join();
+                    }
+                }
+            }
+
+            int num_threads() const noexcept {
+                return m_num_threads;
+            }
+
+            std::size_t queue_size() const {
+                std::size_t sum = 0;
+                for (const auto& queue : m_queues) {
+                    sum += queue->size();
+                }
+                return sum;
+            }
+
+            bool queue_empty() const {
+                for (const auto& queue : m_queues) {
+                    if (!queue->empty()) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            template <typename TFunction>
+            std::future<Pool::submit_func_result_type<TFunction>> submit(TFunction&& func) {
+                std::packaged_task<Pool::submit_func_result_type<TFunction>()> task{std::forward<TFunction>(func)};
+                std::future<Pool::submit_func_result_type<TFunction>> future_result{task.get_future()};
+                push(std::move(task));
+
+                return future_result;
+            }
+
+        }; // class WorkStealingPool
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_WORK_STEALING_POOL_HPP
@@ -0,0 +1,133 @@
+#ifndef OSMIUM_TRANSFORM_HPP
+#define OSMIUM_TRANSFORM_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/pipeline.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstddef>
+#include <utility>
+
+namespace osmium {
+
+    /**
+     * Apply a per-object transform function to all OSM objects in a
+     * buffer, collecting the results in a fresh buffer. The function is
+     * called with each object and the output buffer; it decides what to
+     * write there, usually with the builders or buffer.add_item(), and
+     * must commit what it adds. Objects it writes nothing for are
+     * dropped. Anything in the input that is not an OSM object (such as
+     * changesets) is dropped, too.
+     */
+    template <typename TFunc>
+    osmium::memory::Buffer transform_buffer(osmium::memory::Buffer&& buffer, TFunc&& func) {
+        // same initial capacity as the input so it grows at most rarely,
+        // but never zero, an empty buffer must stay distinguishable from
+        // an invalid one
+        osmium::memory::Buffer out{buffer.committed() > 0 ? buffer.committed() : 64UL,
+                                   osmium::memory::Buffer::auto_grow::yes};
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            func(object, out);
+        }
+        return out;
+    }
+
+    /**
+     * Read buffers from a source, apply a per-object transform function
+     * on several threads, and hand the resulting buffers to a sink in
+     * the original order. Use this for pure per-object transforms (tag
+     * rewriting, coordinate shifts) that are too expensive for the
+     * single thread the usual Reader -> apply() -> Writer combination
+     * gives them, but whose output order must match the input order.
+     *
+     * @code
+     * osmium::io::Reader reader{infile};
+     * osmium::io::Writer writer{outfile};
+     * osmium::transform_parallel(reader, writer,
+     *     [](const osmium::OSMObject& object, osmium::memory::Buffer& out) {
+     *         // copy the object, modified or not, or drop it
+     *         out.add_item(object);
+     *         out.commit();
+     *     });
+     * writer.close();
+     * reader.close();
+     * @endcode
+     *
+     * This is the ordered-futures pattern the parallel file format
+     * encoders use internally: each buffer becomes one task on the
+     * thread pool, the results are re-sequenced by input index, so the
+     * sink never sees anything out of order. The function is called
+     * concurrently and must be safe to call from several threads at
+     * the same time.
+     *
+     * For transforms working on whole buffers or with several stages
+     * use osmium::Pipeline directly.
+     *
+     * @param source Anything with a read() function returning buffers,
+     *               usually an osmium::io::Reader.
+     * @param sink Anything callable with a buffer rvalue, usually an
+     *             osmium::io::Writer.
+     * @param func The transform function, called with every OSM object
+     *             and the output buffer.
+     * @param parallelism Number of buffers transformed concurrently.
+     *                    Defaults to the number of threads in the pool.
+     * @param pool The thread pool to run the transforms on.
+     * @throws Whatever the source, the function, or the sink throws.
+     */
+    template <typename TSource, typename TSink, typename TFunc>
+    void transform_parallel(TSource& source, TSink& sink, TFunc func,
+                            std::size_t parallelism = 0,
+                            osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+        if (parallelism == 0) {
+            parallelism = static_cast<std::size_t>(pool.num_threads());
+        }
+
+        osmium::Pipeline pipeline{pool};
+        pipeline.source([&source]() {
+                    return source.read();
+                })
+                .transform([&func](osmium::memory::Buffer&& buffer) {
+                    return osmium::transform_buffer(std::move(buffer), func);
+                }, parallelism)
+                .sink([&sink](osmium::memory::Buffer&& buffer) {
+                    sink(std::move(buffer));
+                });
+        pipeline.run();
+    }
+
+} // namespace osmium
+
+#endif // OSMIUM_TRANSFORM_HPP
@@ -103,6 +103,66 @@ namespace osmium {
             return value;
         }
 
+        inline bool use_parallel_xml_parsing() noexcept {
+            const char* env = osmium::detail::getenv_wrapper("OSMIUM_USE_PARALLEL_XML_PARSING");
+            if (env) {
+                if (!strcasecmp(env, "off") ||
+                    !strcasecmp(env, "false") ||
+                    !strcasecmp(env, "no") ||
+                    !strcasecmp(env, "0")) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        inline bool use_parallel_o5m_parsing() noexcept {
+            const char* env = osmium::detail::getenv_wrapper("OSMIUM_USE_PARALLEL_O5M_PARSING");
+            if (env) {
+                if (!strcasecmp(env, "off") ||
+                    !strcasecmp(env, "false") ||
+                    !strcasecmp(env, "no") ||
+                    !strcasecmp(env, "0")) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        inline bool use_parallel_gzip_compression() noexcept {
+            const char* env = osmium::detail::getenv_wrapper("OSMIUM_USE_PARALLEL_GZIP_COMPRESSION");
+            if (env) {
+                if (!strcasecmp(env, "on") ||
+                    !strcasecmp(env, "true") ||
+                    !strcasecmp(env, "yes") ||
+                    !strcasecmp(env, "1")) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline bool use_io_uring() noexcept {
+            const char* env = osmium::detail::getenv_wrapper("OSMIUM_USE_IO_URING");
+            if (env) {
+                if (!strcasecmp(env, "off") ||
+                    !strcasecmp(env, "false") ||
+                    !strcasecmp(env, "no") ||
+                    !strcasecmp(env, "0")) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        inline std::size_t get_flex_mem_limit() noexcept {
+            const char* env = osmium::detail::getenv_wrapper("OSMIUM_FLEX_MEM_LIMIT");
+            if (env) {
+                return osmium::detail::str_to_int<std::size_t>(env);
+            }
+            return 0;
+        }
+
         inline int8_t clean_page_cache_after_read() noexcept {
             const char* env = osmium::detail::getenv_wrapper("OSMIUM_CLEAN_PAGE_CACHE_AFTER_READ");
             if (env) {
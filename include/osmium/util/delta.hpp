@@ -34,12 +34,189 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 #include <utility>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+# define OSMIUM_DELTA_X86
+# include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+# define OSMIUM_DELTA_NEON
+# include <arm_neon.h>
+#endif
+
 namespace osmium {
 
+    namespace detail {
+
+        /*
+         * Array-based delta decoding is a prefix sum over the deltas.
+         * The generic version below works for any integer types, for
+         * the common 64-bit case there are SIMD versions that compute
+         * the prefix sum of several elements per step instead of
+         * carrying a serial dependency through every element.
+         */
+
+        template <typename TValue, typename TDelta>
+        inline TValue delta_decode_n_generic(const TDelta* deltas, TValue* out, std::size_t n, TValue value) noexcept {
+            for (std::size_t i = 0; i < n; ++i) {
+                value = static_cast<TValue>(static_cast<TDelta>(value) + deltas[i]);
+                out[i] = value;
+            }
+            return value;
+        }
+
+        template <typename TValue, typename TDelta>
+        inline TValue delta_decode_n_zigzag_generic(const typename std::make_unsigned<TDelta>::type* deltas, TValue* out, std::size_t n, TValue value) noexcept {
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto u = deltas[i];
+                const TDelta delta = static_cast<TDelta>(u >> 1U) ^ -static_cast<TDelta>(u & 1U);
+                value = static_cast<TValue>(static_cast<TDelta>(value) + delta);
+                out[i] = value;
+            }
+            return value;
+        }
+
+#ifdef OSMIUM_DELTA_X86
+
+        __attribute__((target("sse2")))
+        inline std::int64_t delta_decode_n_sse2(const std::int64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + i));
+                // Prefix sum of the two lanes: [d0, d0 + d1].
+                v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi64(v, _mm_set1_epi64x(value));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+                value = out[i + 1];
+            }
+            return delta_decode_n_generic(deltas + i, out + i, n - i, value);
+        }
+
+        __attribute__((target("avx2")))
+        inline std::int64_t delta_decode_n_avx2(const std::int64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(deltas + i));
+                // Prefix sum within the two 128-bit halves:
+                // [d0, d0+d1, d2, d2+d3].
+                v = _mm256_add_epi64(v, _mm256_slli_si256(v, 8));
+                // Add the sum of the lower half to the upper half.
+                const __m256i low_sum = _mm256_permute4x64_epi64(v, 0x55);
+                v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_setzero_si256(), low_sum, 0xF0));
+                v = _mm256_add_epi64(v, _mm256_set1_epi64x(value));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+                value = out[i + 3];
+            }
+            return delta_decode_n_generic(deltas + i, out + i, n - i, value);
+        }
+
+        inline std::int64_t delta_decode_n(const std::int64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            using impl_type = std::int64_t (*)(const std::int64_t*, std::int64_t*, std::size_t, std::int64_t);
+            // Runtime CPU dispatch, decided once on first use.
+            static const impl_type impl = __builtin_cpu_supports("avx2")
+                                              ? &delta_decode_n_avx2
+                                              : &delta_decode_n_sse2;
+            return impl(deltas, out, n, value);
+        }
+
+        __attribute__((target("sse2")))
+        inline std::int64_t delta_decode_n_zigzag_sse2(const std::uint64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + i));
+                // Zigzag decode: (u >> 1) ^ -(u & 1).
+                const __m128i sign = _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(u, _mm_set1_epi64x(1)));
+                __m128i v = _mm_xor_si128(_mm_srli_epi64(u, 1), sign);
+                v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi64(v, _mm_set1_epi64x(value));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+                value = out[i + 1];
+            }
+            return delta_decode_n_zigzag_generic<std::int64_t, std::int64_t>(deltas + i, out + i, n - i, value);
+        }
+
+        __attribute__((target("avx2")))
+        inline std::int64_t delta_decode_n_zigzag_avx2(const std::uint64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(deltas + i));
+                const __m256i sign = _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_and_si256(u, _mm256_set1_epi64x(1)));
+                __m256i v = _mm256_xor_si256(_mm256_srli_epi64(u, 1), sign);
+                v = _mm256_add_epi64(v, _mm256_slli_si256(v, 8));
+                const __m256i low_sum = _mm256_permute4x64_epi64(v, 0x55);
+                v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_setzero_si256(), low_sum, 0xF0));
+                v = _mm256_add_epi64(v, _mm256_set1_epi64x(value));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+                value = out[i + 3];
+            }
+            return delta_decode_n_zigzag_generic<std::int64_t, std::int64_t>(deltas + i, out + i, n - i, value);
+        }
+
+        inline std::int64_t delta_decode_n_zigzag(const std::uint64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            using impl_type = std::int64_t (*)(const std::uint64_t*, std::int64_t*, std::size_t, std::int64_t);
+            static const impl_type impl = __builtin_cpu_supports("avx2")
+                                              ? &delta_decode_n_zigzag_avx2
+                                              : &delta_decode_n_zigzag_sse2;
+            return impl(deltas, out, n, value);
+        }
+
+#elif defined(OSMIUM_DELTA_NEON)
+
+        inline std::int64_t delta_decode_n(const std::int64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                int64x2_t v = vld1q_s64(deltas + i);
+                // Prefix sum of the two lanes: [d0, d0 + d1].
+                v = vaddq_s64(v, vcombine_s64(vcreate_s64(0), vget_low_s64(v)));
+                v = vaddq_s64(v, vdupq_n_s64(value));
+                vst1q_s64(out + i, v);
+                value = out[i + 1];
+            }
+            return delta_decode_n_generic(deltas + i, out + i, n - i, value);
+        }
+
+        inline std::int64_t delta_decode_n_zigzag(const std::uint64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const uint64x2_t u = vld1q_u64(deltas + i);
+                // Zigzag decode: (u >> 1) ^ -(u & 1).
+                const int64x2_t sign = vsubq_s64(vdupq_n_s64(0), vreinterpretq_s64_u64(vandq_u64(u, vdupq_n_u64(1))));
+                int64x2_t v = veorq_s64(vreinterpretq_s64_u64(vshrq_n_u64(u, 1)), sign);
+                v = vaddq_s64(v, vcombine_s64(vcreate_s64(0), vget_low_s64(v)));
+                v = vaddq_s64(v, vdupq_n_s64(value));
+                vst1q_s64(out + i, v);
+                value = out[i + 1];
+            }
+            return delta_decode_n_zigzag_generic<std::int64_t, std::int64_t>(deltas + i, out + i, n - i, value);
+        }
+
+#else
+
+        inline std::int64_t delta_decode_n(const std::int64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            return delta_decode_n_generic(deltas, out, n, value);
+        }
+
+        inline std::int64_t delta_decode_n_zigzag(const std::uint64_t* deltas, std::int64_t* out, std::size_t n, std::int64_t value) noexcept {
+            return delta_decode_n_zigzag_generic<std::int64_t, std::int64_t>(deltas, out, n, value);
+        }
+
+#endif
+
+        template <typename TValue, typename TDelta>
+        inline TValue delta_decode_n(const TDelta* deltas, TValue* out, std::size_t n, TValue value) noexcept {
+            return delta_decode_n_generic(deltas, out, n, value);
+        }
+
+        template <typename TValue, typename TUnsignedDelta>
+        inline TValue delta_decode_n_zigzag(const TUnsignedDelta* deltas, TValue* out, std::size_t n, TValue value) noexcept {
+            return delta_decode_n_zigzag_generic<TValue, typename std::make_signed<TUnsignedDelta>::type>(deltas, out, n, value);
+        }
+
+    } // namespace detail
+
     inline namespace util {
 
         /**
@@ -131,6 +308,33 @@ namespace osmium {
                 return m_value;
             }
 
+            /**
+             * Decode a whole array of deltas at once. This is equivalent
+             * to calling update() for each element, but uses a SIMD
+             * prefix sum on platforms that have one, so decoders can
+             * convert complete packed fields without a serial dependency
+             * through every element.
+             *
+             * @param deltas The delta values.
+             * @param out Gets the decoded values, must have room for n
+             *        elements. May be the same array as @p deltas.
+             * @param n Number of elements.
+             * @returns The last decoded value.
+             */
+            TValue decode_n(const TDelta* deltas, TValue* out, std::size_t n) noexcept {
+                m_value = detail::delta_decode_n(deltas, out, n, m_value);
+                return m_value;
+            }
+
+            /**
+             * Like decode_n(), but for deltas that are also zigzag
+             * encoded as in the packed sint fields of the PBF format.
+             */
+            TValue decode_n_zigzag(const typename std::make_unsigned<TDelta>::type* deltas, TValue* out, std::size_t n) noexcept {
+                m_value = detail::delta_decode_n_zigzag(deltas, out, n, m_value);
+                return m_value;
+            }
+
         }; // class DeltaDecode
 
     } // namespace util
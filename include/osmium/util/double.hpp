@@ -35,12 +35,67 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <iterator>
 #include <string>
 
 namespace osmium {
 
+    namespace detail {
+
+        /**
+         * Write a value in 1/10^7th units as decimal number to iterator,
+         * removing superfluous '0' characters at the end. The decimal dot
+         * will also be removed if necessary.
+         */
+        template <typename T>
+        inline T fixed7_to_string(T iterator, int64_t value) {
+            if (value < 0) {
+                *iterator++ = '-';
+                value = -value;
+            }
+
+            // write fraction digits into temporary buffer, least
+            // significant digit first
+            char temp[7];
+            int64_t frac = value % 10000000;
+            for (char& c : temp) {
+                c = static_cast<char>(frac % 10) + '0'; // NOLINT(bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions)
+                frac /= 10;
+            }
+
+            // trailing zeros in the output are leading entries here
+            int first = 0;
+            while (first < 7 && temp[first] == '0') {
+                ++first;
+            }
+
+            // write digits before decimal point
+            char itemp[12];
+            char* t = itemp;
+            int64_t ipart = value / 10000000;
+            do {
+                *t++ = static_cast<char>(ipart % 10) + '0'; // NOLINT(bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions)
+                ipart /= 10;
+            } while (ipart != 0);
+            while (t != itemp) {
+                *iterator++ = *--t;
+            }
+
+            if (first < 7) {
+                *iterator++ = '.';
+                for (int i = 6; i >= first; --i) {
+                    *iterator++ = temp[i];
+                }
+            }
+
+            return iterator;
+        }
+
+    } // namespace detail
+
     inline namespace util {
 
         /**
@@ -56,6 +111,25 @@ namespace osmium {
         inline T double2string(T iterator, double value, int precision) {
             assert(precision <= 17);
 
+            // Fast path for coordinates: Doubles that round-trip exactly
+            // through the 1/10^7th fixed-point format used by
+            // osmium::Location (which is where almost all values
+            // formatted with precision 7 come from) can be converted
+            // with integer arithmetic only, which is much faster than
+            // the snprintf() call below. Together with the magnitude
+            // limit of 2^28 (scaled values stay well below 2^53, so the
+            // multiplication and division are exact enough for the
+            // round-trip check to be decisive) this guarantees the
+            // output is identical in both paths. The limit still covers
+            // lon/lat as well as Web Mercator coordinates.
+            if (precision == 7 && value > -268435456.0 && value < 268435456.0 &&
+                (value != 0.0 || !std::signbit(value))) {
+                const auto fixed = static_cast<int64_t>(std::round(value * 10000000.0));
+                if (static_cast<double>(fixed) / 10000000.0 == value) {
+                    return detail::fixed7_to_string(iterator, fixed);
+                }
+            }
+
             enum {
                 max_double_length = 20 // should fit decimal representation of any double
             };
@@ -33,6 +33,9 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdlib>
 #include <fstream>
 #include <string>
@@ -41,6 +44,121 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    /**
+     * Voluntary memory accounting. Subsystems that hold large amounts of
+     * memory (buffers, indexes, item stashes, queues) report their usage
+     * here, so it can be attributed when a process grows unexpectedly.
+     * This is much finer grained than the process-wide numbers from the
+     * MemoryUsage class, but only covers subsystems that report.
+     *
+     * All counters are process-wide relaxed atomics, reporting an update
+     * is a single atomic add. The numbers are approximations: reads see
+     * no consistent snapshot and subsystems report with different
+     * granularity.
+     */
+    class MemoryAccounting {
+
+    public:
+
+        enum class subsystem : std::size_t {
+            buffers = 0, ///< osmium::memory::Buffer contents
+            indexes = 1, ///< the indexes from osmium::index
+            stashes = 2, ///< osmium::ItemStash
+            queues  = 3  ///< osmium::thread::Queue elements (not the memory owned by them)
+        }; // enum class subsystem
+
+        enum : std::size_t {
+            num_subsystems = 4
+        };
+
+    private:
+
+        static std::atomic<std::size_t>& counter(const subsystem sub) noexcept {
+            static std::array<std::atomic<std::size_t>, num_subsystems> counters{};
+            return counters[static_cast<std::size_t>(sub)]; // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+        }
+
+    public:
+
+        /// Report that the subsystem uses bytes more memory than before.
+        static void add(const subsystem sub, const std::size_t bytes) noexcept {
+            counter(sub).fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        /// Report that the subsystem uses bytes less memory than before.
+        static void sub(const subsystem sub, const std::size_t bytes) noexcept {
+            counter(sub).fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        /// Memory currently reported for the subsystem, in bytes.
+        static std::size_t current(const subsystem sub) noexcept {
+            return counter(sub).load(std::memory_order_relaxed);
+        }
+
+        /// Memory currently reported over all subsystems, in bytes.
+        static std::size_t current_total() noexcept {
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < num_subsystems; ++i) {
+                total += current(static_cast<subsystem>(i));
+            }
+            return total;
+        }
+
+        /**
+         * Helper that keeps the counter of one subsystem in sync with
+         * the usage of one object. The object calls update() with its
+         * current usage whenever it changed, only the difference to the
+         * last reported value is applied to the counter. The destructor
+         * takes the last reported value off the counter again.
+         */
+        class tracker {
+
+            std::size_t m_reported = 0;
+            subsystem m_subsystem;
+
+        public:
+
+            explicit tracker(const subsystem sub) noexcept :
+                m_subsystem(sub) {
+            }
+
+            tracker(const tracker&) = delete;
+            tracker& operator=(const tracker&) = delete;
+
+            tracker(tracker&& other) noexcept :
+                m_reported(other.m_reported),
+                m_subsystem(other.m_subsystem) {
+                other.m_reported = 0;
+            }
+
+            tracker& operator=(tracker&& other) noexcept {
+                if (this != &other) {
+                    update(0);
+                    m_reported = other.m_reported;
+                    m_subsystem = other.m_subsystem;
+                    other.m_reported = 0;
+                }
+                return *this;
+            }
+
+            ~tracker() noexcept {
+                update(0);
+            }
+
+            /// Report the current memory usage of the tracked object.
+            void update(const std::size_t bytes) noexcept {
+                if (bytes >= m_reported) {
+                    MemoryAccounting::add(m_subsystem, bytes - m_reported);
+                } else {
+                    MemoryAccounting::sub(m_subsystem, m_reported - bytes);
+                }
+                m_reported = bytes;
+            }
+
+        }; // class tracker
+
+    }; // class MemoryAccounting
+
     class MemoryUsage {
 
         int64_t m_current = 0;
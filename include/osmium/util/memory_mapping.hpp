@@ -35,9 +35,11 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/util/file.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstddef>
+#include <cstring>
 #include <stdexcept>
 #include <system_error>
 
@@ -55,6 +57,62 @@ namespace osmium {
 
     inline namespace util {
 
+        /**
+         * What kind of huge page support is wanted for an anonymous
+         * memory mapping? Huge pages reduce the TLB pressure for very
+         * large mappings such as dense node location indexes. This is
+         * only supported on Linux, on other systems the setting is
+         * ignored.
+         */
+        enum class huge_pages {
+
+            /// Use normal pages.
+            none        = 0,
+
+            /**
+             * Advise the kernel (with madvise(MADV_HUGEPAGE)) to back
+             * the mapping with transparent huge pages.
+             */
+            transparent = 1,
+
+            /**
+             * Allocate the mapping from the HugeTLB pool (with
+             * MAP_HUGETLB). If the pool doesn't have enough free pages,
+             * fall back to a normal mapping with transparent huge page
+             * advice.
+             */
+            hugetlb     = 2
+
+        }; // enum class huge_pages
+
+        /**
+         * Hints for the kernel about how the memory of a mapping will be
+         * used, see MemoryMapping::advise(). These map to the madvise()
+         * advice values; on systems without madvise() they are ignored.
+         */
+        enum class memory_advice {
+
+            /// No special treatment (MADV_NORMAL).
+            normal     = 0,
+
+            /// Expect random access, read-ahead may be useless (MADV_RANDOM).
+            random     = 1,
+
+            /// Expect sequential access, read ahead aggressively (MADV_SEQUENTIAL).
+            sequential = 2,
+
+            /// Expect access in the near future (MADV_WILLNEED).
+            willneed   = 3,
+
+            /**
+             * Do not expect access in the near future (MADV_DONTNEED).
+             * Careful: for anonymous mappings this discards the contents
+             * of the pages!
+             */
+            dontneed   = 4
+
+        }; // enum class memory_advice
+
         /**
          * Class for wrapping memory mapping system calls.
          *
@@ -116,6 +174,9 @@ namespace osmium {
             /// Mapping mode
             mapping_mode m_mapping_mode;
 
+            /// Huge page setting (only used for anonymous mappings)
+            huge_pages m_huge_pages = huge_pages::none;
+
 #ifdef _WIN32
             HANDLE m_handle;
 #endif
@@ -137,6 +198,8 @@ namespace osmium {
 
             flag_type get_flags() const noexcept;
 
+            void advise_huge_pages() const noexcept;
+
             static std::size_t check_size(std::size_t size) {
                 if (size == 0) {
                     return osmium::get_pagesize();
@@ -200,9 +263,10 @@ namespace osmium {
              * @param mode Mapping mode: readonly, or writable (shared or private)
              * @param fd Open file descriptor of a file we want to map
              * @param offset Offset into the file where the mapping should start
+             * @param hp Huge page setting (only used for anonymous mappings)
              * @throws std::system_error if the mapping fails
              */
-            MemoryMapping(std::size_t size, mapping_mode mode, int fd = -1, off_t offset = 0);
+            MemoryMapping(std::size_t size, mapping_mode mode, int fd = -1, off_t offset = 0, huge_pages hp = huge_pages::none);
 
             /// You can not copy construct a MemoryMapping.
             MemoryMapping(const MemoryMapping&) = delete;
@@ -254,6 +318,42 @@ namespace osmium {
              */
             void resize(std::size_t new_size);
 
+            /**
+             * Advise the kernel how the memory of this mapping will be
+             * used. This wraps the madvise() system call; on systems
+             * without it this does nothing. Errors are ignored, this is
+             * only a hint.
+             */
+            void advise(memory_advice advice) const noexcept;
+
+            /**
+             * Advise the kernel how the given byte range of this mapping
+             * will be used. Use this, for instance, with
+             * memory_advice::willneed for a range you are about to
+             * access, or with memory_advice::dontneed for a range behind
+             * a streaming read to release the page cache early.
+             *
+             * The range is rounded to page boundaries and clamped to the
+             * size of the mapping.
+             */
+            void advise(memory_advice advice, std::size_t offset, std::size_t length) const noexcept;
+
+            /**
+             * Fault the given byte range of this mapping into memory.
+             * Tells the kernel to read the range ahead and then touches
+             * every page so all page faults happen here and not spread
+             * out over later accesses. Call this after opening a
+             * file-backed index to warm it up in one sequential pass.
+             *
+             * The range is clamped to the size of the mapping.
+             */
+            void prefault(std::size_t offset, std::size_t length) const noexcept;
+
+            /// Fault the complete mapping into memory.
+            void prefault() const noexcept {
+                prefault(0, m_size);
+            }
+
             /**
              * In a boolean context a MemoryMapping is true when it is a valid
              * existing mapping.
@@ -313,8 +413,8 @@ namespace osmium {
 
         public:
 
-            explicit AnonymousMemoryMapping(std::size_t size) :
-                MemoryMapping(size, mapping_mode::write_private) {
+            explicit AnonymousMemoryMapping(std::size_t size, huge_pages hp = huge_pages::none) :
+                MemoryMapping(size, mapping_mode::write_private, -1, 0, hp) {
             }
 
 #ifndef __linux__
@@ -347,10 +447,11 @@ namespace osmium {
              * Create anonymous typed memory mapping of given size.
              *
              * @param size Number of objects of type T to be mapped
+             * @param hp Huge page setting
              * @throws std::system_error if the mapping fails
              */
-            explicit TypedMemoryMapping(std::size_t size) :
-                m_mapping(sizeof(T) * size, MemoryMapping::mapping_mode::write_private) {
+            explicit TypedMemoryMapping(std::size_t size, huge_pages hp = huge_pages::none) :
+                m_mapping(sizeof(T) * size, MemoryMapping::mapping_mode::write_private, -1, 0, hp) {
             }
 
             /**
@@ -448,6 +549,42 @@ namespace osmium {
                 return m_mapping.writable();
             }
 
+            /**
+             * Advise the kernel how the memory of this mapping will be
+             * used. See MemoryMapping::advise().
+             */
+            void advise(memory_advice advice) const noexcept {
+                m_mapping.advise(advice);
+            }
+
+            /**
+             * Advise the kernel how the given range of objects of this
+             * mapping will be used. See MemoryMapping::advise().
+             *
+             * @param advice The advice.
+             * @param offset Offset of the range in objects of type T.
+             * @param count Length of the range in objects of type T.
+             */
+            void advise(memory_advice advice, std::size_t offset, std::size_t count) const noexcept {
+                m_mapping.advise(advice, sizeof(T) * offset, sizeof(T) * count);
+            }
+
+            /**
+             * Fault the given range of objects of this mapping into
+             * memory. See MemoryMapping::prefault().
+             *
+             * @param offset Offset of the range in objects of type T.
+             * @param count Length of the range in objects of type T.
+             */
+            void prefault(std::size_t offset, std::size_t count) const noexcept {
+                m_mapping.prefault(sizeof(T) * offset, sizeof(T) * count);
+            }
+
+            /// Fault the complete mapping into memory.
+            void prefault() const noexcept {
+                m_mapping.prefault();
+            }
+
             /**
              * Get the address of the beginning of the mapping.
              *
@@ -559,6 +696,11 @@ inline int osmium::util::MemoryMapping::get_protection() const noexcept {
 
 inline int osmium::util::MemoryMapping::get_flags() const noexcept {
     if (m_fd == -1) {
+#ifdef MAP_HUGETLB
+        if (m_huge_pages == huge_pages::hugetlb) {
+            return MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB; // NOLINT(hicpp-signed-bitwise)
+        }
+#endif
         return MAP_PRIVATE | MAP_ANONYMOUS; // NOLINT(hicpp-signed-bitwise)
     }
     if (m_mapping_mode == mapping_mode::write_shared) {
@@ -567,16 +709,33 @@ inline int osmium::util::MemoryMapping::get_flags() const noexcept {
     return MAP_PRIVATE;
 }
 
-inline osmium::util::MemoryMapping::MemoryMapping(std::size_t size, mapping_mode mode, int fd, off_t offset) :
+inline void osmium::util::MemoryMapping::advise_huge_pages() const noexcept {
+#ifdef MADV_HUGEPAGE
+    if (m_huge_pages == huge_pages::transparent && is_valid()) {
+        // This is only advice to the kernel, so we ignore any errors.
+        ::madvise(m_addr, m_size, MADV_HUGEPAGE);
+    }
+#endif
+}
+
+inline osmium::util::MemoryMapping::MemoryMapping(std::size_t size, mapping_mode mode, int fd, off_t offset, huge_pages hp) :
     m_size(check_size(size)),
     m_offset(offset),
     m_fd(resize_fd(fd)),
     m_mapping_mode(mode),
+    m_huge_pages(fd == -1 ? hp : huge_pages::none),
     m_addr(::mmap(nullptr, m_size, get_protection(), get_flags(), m_fd, m_offset)) {
     assert(!(fd == -1 && mode == mapping_mode::readonly));
+    if (!is_valid() && m_huge_pages == huge_pages::hugetlb) {
+        // The HugeTLB pool can be empty or not configured at all. Fall
+        // back to a normal mapping with transparent huge page advice.
+        m_huge_pages = huge_pages::transparent;
+        m_addr = ::mmap(nullptr, m_size, get_protection(), get_flags(), m_fd, m_offset);
+    }
     if (!is_valid()) {
         throw std::system_error{errno, std::system_category(), "mmap failed"};
     }
+    advise_huge_pages();
 }
 
 inline osmium::util::MemoryMapping::MemoryMapping(MemoryMapping&& other) noexcept :
@@ -584,6 +743,7 @@ inline osmium::util::MemoryMapping::MemoryMapping(MemoryMapping&& other) noexcep
     m_offset(other.m_offset),
     m_fd(other.m_fd),
     m_mapping_mode(other.m_mapping_mode),
+    m_huge_pages(other.m_huge_pages),
     m_addr(other.m_addr) {
     other.make_invalid();
 }
@@ -599,6 +759,7 @@ inline osmium::util::MemoryMapping& osmium::util::MemoryMapping::operator=(osmiu
     m_offset       = other.m_offset;
     m_fd           = other.m_fd;
     m_mapping_mode = other.m_mapping_mode;
+    m_huge_pages   = other.m_huge_pages;
     m_addr         = other.m_addr;
     other.make_invalid();
     return *this;
@@ -617,11 +778,26 @@ inline void osmium::util::MemoryMapping::resize(std::size_t new_size) {
     assert(new_size > 0 && "can not resize to zero size");
     if (m_fd == -1) { // anonymous mapping
 #ifdef __linux__
+        void* const old_addr = m_addr;
+        const std::size_t old_size = m_size;
         m_addr = ::mremap(m_addr, m_size, new_size, MREMAP_MAYMOVE);
+        if (!is_valid() && m_huge_pages == huge_pages::hugetlb) {
+            // The HugeTLB pool might not have enough free pages to grow
+            // the mapping. Fall back to a normal mapping with transparent
+            // huge page advice and copy the data over.
+            m_addr = ::mmap(nullptr, new_size, get_protection(), MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); // NOLINT(hicpp-signed-bitwise)
+            if (is_valid()) {
+                m_huge_pages = huge_pages::transparent;
+                std::memcpy(m_addr, old_addr, std::min(old_size, new_size));
+                ::munmap(old_addr, old_size);
+            }
+        }
         if (!is_valid()) {
+            m_addr = old_addr;
             throw std::system_error{errno, std::system_category(), "mremap failed"};
         }
         m_size = new_size;
+        advise_huge_pages();
 #else
         assert(false && "can't resize anonymous mappings on non-linux systems");
 #endif
@@ -636,6 +812,44 @@ inline void osmium::util::MemoryMapping::resize(std::size_t new_size) {
     }
 }
 
+inline void osmium::util::MemoryMapping::advise(const memory_advice advice) const noexcept {
+    advise(advice, 0, m_size);
+}
+
+inline void osmium::util::MemoryMapping::advise(const memory_advice advice, std::size_t offset, std::size_t length) const noexcept {
+    if (!is_valid() || offset >= m_size) {
+        return;
+    }
+
+    // madvise() needs a page-aligned address, so round the offset down
+    // to a page boundary and extend the length accordingly.
+    const std::size_t pagesize = osmium::get_pagesize();
+    const std::size_t begin = offset - offset % pagesize;
+    length += offset - begin;
+    if (length > m_size - begin) {
+        length = m_size - begin;
+    }
+
+    int flag = MADV_NORMAL;
+    switch (advice) {
+        case memory_advice::random:
+            flag = MADV_RANDOM;
+            break;
+        case memory_advice::sequential:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case memory_advice::willneed:
+            flag = MADV_WILLNEED;
+            break;
+        case memory_advice::dontneed:
+            flag = MADV_DONTNEED;
+            break;
+        default:
+            break;
+    }
+    ::madvise(get_addr<char>() + begin, length, flag);
+}
+
 #else
 
 // =========== Windows implementation =============
@@ -729,7 +943,7 @@ inline int last_error() noexcept {
     return static_cast<int>(GetLastError());
 }
 
-inline osmium::util::MemoryMapping::MemoryMapping(std::size_t size, MemoryMapping::mapping_mode mode, int fd, off_t offset) :
+inline osmium::util::MemoryMapping::MemoryMapping(std::size_t size, MemoryMapping::mapping_mode mode, int fd, off_t offset, huge_pages /*hp*/) :
     m_size(check_size(size)),
     m_offset(offset),
     m_fd(resize_fd(fd)),
@@ -809,6 +1023,35 @@ inline void osmium::util::MemoryMapping::resize(std::size_t new_size) {
     }
 }
 
+inline void osmium::util::MemoryMapping::advise(const memory_advice /*advice*/) const noexcept {
+    // There is no madvise() on Windows, so do nothing.
+}
+
+inline void osmium::util::MemoryMapping::advise(const memory_advice /*advice*/, std::size_t /*offset*/, std::size_t /*length*/) const noexcept {
+    // There is no madvise() on Windows, so do nothing.
+}
+
 #endif
 
+inline void osmium::util::MemoryMapping::prefault(std::size_t offset, std::size_t length) const noexcept {
+    if (!is_valid() || offset >= m_size) {
+        return;
+    }
+    if (length > m_size - offset) {
+        length = m_size - offset;
+    }
+
+    // Tell the kernel to start reading the range ahead...
+    advise(memory_advice::willneed, offset, length);
+
+    // ...and touch one byte in every page so the page faults happen
+    // now, while the kernel is streaming the pages in, and not spread
+    // out over later accesses.
+    const std::size_t pagesize = osmium::get_pagesize();
+    const volatile char* addr = get_addr<char>() + offset;
+    for (std::size_t i = 0; i < length; i += pagesize) {
+        (void)addr[i];
+    }
+}
+
 #endif // OSMIUM_UTIL_MEMORY_MAPPING_HPP
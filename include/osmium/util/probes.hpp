@@ -0,0 +1,67 @@
+#ifndef OSMIUM_UTIL_PROBES_HPP
+#define OSMIUM_UTIL_PROBES_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Optional USDT (user-level statically defined tracing) probe points.
+ *
+ * Define OSMIUM_WITH_USDT to compile probe points into the I/O pipeline
+ * under the provider name "libosmium". Tools like perf, bpftrace, or
+ * SystemTap can then attach to the pipeline stages (blob read, decode,
+ * apply, serialize, write) without any changes to the library or the
+ * application. Needs <sys/sdt.h> from the SystemTap development package.
+ *
+ * Without OSMIUM_WITH_USDT (the default) all probe macros expand to
+ * nothing.
+ */
+
+#ifdef OSMIUM_WITH_USDT
+
+# include <sys/sdt.h>
+
+# define OSMIUM_PROBE(name) DTRACE_PROBE(libosmium, name)
+# define OSMIUM_PROBE1(name, arg1) DTRACE_PROBE1(libosmium, name, arg1)
+# define OSMIUM_PROBE2(name, arg1, arg2) DTRACE_PROBE2(libosmium, name, arg1, arg2)
+
+#else
+
+# define OSMIUM_PROBE(name) static_cast<void>(0)
+# define OSMIUM_PROBE1(name, arg1) static_cast<void>(0)
+# define OSMIUM_PROBE2(name, arg1, arg2) static_cast<void>(0)
+
+#endif
+
+#endif // OSMIUM_UTIL_PROBES_HPP
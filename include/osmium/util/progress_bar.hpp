@@ -34,8 +34,10 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <iostream>
+#include <string>
 
 namespace osmium {
 
@@ -77,15 +79,66 @@ namespace osmium {
         // will always be different from any legal setting.
         std::size_t m_prev_percent = 100 + 1;
 
+        // The total size (done plus current) at which the percentage can
+        // have changed again. Allows update() to return after a single
+        // comparison in the common case, so it is cheap enough to call
+        // for every buffer without any throttling in the caller.
+        std::size_t m_next_display_size = 0;
+
+        // Set when the progress bar is created, used for the ETA.
+        std::chrono::steady_clock::time_point m_start_time{std::chrono::steady_clock::now()};
+
         // Is the progress bar enabled at all?
         bool m_enable;
 
+        // Show an estimate of the remaining time after the percentage?
+        bool m_show_eta = false;
+
         // Used to make sure we do cleanup in the destructor if it was not
         // already done.
         bool m_do_cleanup = true;
 
+        // Write the estimated remaining time in a fixed-width field so
+        // a shrinking estimate does not leave stray characters behind.
+        void display_eta(const std::size_t size) {
+            std::string eta;
+
+            if (size > 0 && size < m_max_size) {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+                                         std::chrono::steady_clock::now() - m_start_time).count();
+                const auto remaining = static_cast<std::size_t>(elapsed) * (m_max_size - size) / size;
+
+                const std::size_t hours = remaining / 3600;
+                const std::size_t minutes = (remaining / 60) % 60;
+                const std::size_t seconds = remaining % 60;
+
+                eta = "ETA ";
+                if (hours > 99) {
+                    eta += ">99h";
+                } else {
+                    if (hours > 0) {
+                        eta += std::to_string(hours);
+                        eta += minutes < 10 ? ":0" : ":";
+                    }
+                    eta += std::to_string(minutes);
+                    eta += seconds < 10 ? ":0" : ":";
+                    eta += std::to_string(seconds);
+                }
+            }
+
+            eta.resize(12, ' ');
+            std::cerr << eta;
+        }
+
         void display() {
-            const std::size_t percent = 100 * (m_done_size + m_current_size) / m_max_size;
+            const std::size_t size = m_done_size + m_current_size;
+            const std::size_t percent = 100 * size / m_max_size;
+
+            // The next percentage change is at least this far away. The
+            // threshold can be slightly too small because of the rounding,
+            // the percentage check below catches that case.
+            m_next_display_size = (m_max_size / 100) * (percent + 1);
+
             if (m_prev_percent == percent) {
                 return;
             }
@@ -105,7 +158,11 @@ namespace osmium {
             if (percent < 100) {
                 std::cerr << ' ';
             }
-            std::cerr << percent << "% \r";
+            std::cerr << percent << "% ";
+            if (m_show_eta) {
+                display_eta(size);
+            }
+            std::cerr << '\r';
         }
 
     public:
@@ -139,10 +196,20 @@ namespace osmium {
             }
         }
 
+        /**
+         * Show an estimate of the remaining time after the percentage.
+         * Disabled by default. The estimate is based on the time since
+         * the progress bar was created.
+         */
+        void show_eta(bool show) noexcept {
+            m_show_eta = show;
+        }
+
         /**
          * Call this function to update the progress bar. Actual update will
          * only happen if the percentage changed from the last time this
-         * function was called.
+         * function was called. Until then calls return after a single
+         * comparison, so this is cheap enough to call for every buffer.
          *
          * @param current_size Current size. Used together with the max_size
          *                     from constructor to calculate the percentage.
@@ -154,6 +221,10 @@ namespace osmium {
 
             m_current_size = current_size;
 
+            if (m_done_size + current_size < m_next_display_size) {
+                return;
+            }
+
             display();
         }
 
@@ -193,8 +264,13 @@ namespace osmium {
          */
         void remove() {
             if (m_enable) {
-                std::cerr << spc() << "         \r";
+                std::cerr << spc() << "         ";
+                if (m_show_eta) {
+                    std::cerr << spc(12);
+                }
+                std::cerr << '\r';
                 m_prev_percent = 100 + 1;
+                m_next_display_size = 0;
             }
         }
 
@@ -34,6 +34,8 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <iosfwd>
 #include <regex>
@@ -102,6 +104,10 @@ namespace osmium {
                 return false;
             }
 
+            static bool match(const char* /*test_string*/, std::size_t /*len*/) noexcept {
+                return false;
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "always_false";
@@ -120,6 +126,10 @@ namespace osmium {
                 return true;
             }
 
+            static bool match(const char* /*test_string*/, std::size_t /*len*/) noexcept {
+                return true;
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "always_true";
@@ -148,6 +158,16 @@ namespace osmium {
                 return !std::strcmp(m_str.c_str(), test_string);
             }
 
+            bool match(const char* test_string, std::size_t len) const noexcept {
+                return m_str.size() == len &&
+                       !std::memcmp(m_str.data(), test_string, len);
+            }
+
+            /// The string this matcher matches.
+            const char* str() const noexcept {
+                return m_str.c_str();
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "equal[" << m_str << ']';
@@ -176,6 +196,11 @@ namespace osmium {
                 return m_str.compare(0, std::string::npos, test_string, 0, m_str.size()) == 0;
             }
 
+            bool match(const char* test_string, std::size_t len) const noexcept {
+                return m_str.size() <= len &&
+                       !std::memcmp(m_str.data(), test_string, m_str.size());
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "prefix[" << m_str << ']';
@@ -204,6 +229,11 @@ namespace osmium {
                 return std::strstr(test_string, m_str.c_str()) != nullptr;
             }
 
+            bool match(const char* test_string, std::size_t len) const noexcept {
+                return std::search(test_string, test_string + len,
+                                   m_str.cbegin(), m_str.cend()) != test_string + len;
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "substring[" << m_str << ']';
@@ -229,6 +259,10 @@ namespace osmium {
                 return std::regex_search(test_string, m_regex);
             }
 
+            bool match(const char* test_string, std::size_t len) const noexcept {
+                return std::regex_search(test_string, test_string + len, m_regex);
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "regex";
@@ -269,6 +303,14 @@ namespace osmium {
                 });
             }
 
+            bool match(const char* test_string, std::size_t len) const noexcept {
+                return std::any_of(m_strings.cbegin(), m_strings.cend(),
+                                   [test_string, len](const std::string& s){
+                    return s.size() == len &&
+                           !std::memcmp(s.data(), test_string, len);
+                });
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "list[";
@@ -280,6 +322,126 @@ namespace osmium {
 
         }; // class list
 
+        /**
+         * Matches if the test string is equal to any of the stored strings.
+         * Like the list matcher, but the strings are stored in a hash
+         * table built at construction time, so a match takes time
+         * proportional to the length of the test string only, independent
+         * of the number of stored strings. Use this instead of the list
+         * matcher when there are many strings to match against.
+         */
+        class set : public matcher {
+
+            std::vector<std::string> m_strings;
+
+            // Open-addressing hash table with linear probing. Contains
+            // the index into m_strings plus one for each string, 0 marks
+            // an empty slot.
+            std::vector<std::size_t> m_table;
+
+            static std::size_t hash(const char* str) noexcept {
+                // FNV-1a
+                std::uint64_t h = 14695981039346656037ULL;
+                while (*str) {
+                    h ^= static_cast<unsigned char>(*str++);
+                    h *= 1099511628211ULL;
+                }
+                return static_cast<std::size_t>(h);
+            }
+
+            static std::size_t hash(const char* str, std::size_t len) noexcept {
+                // FNV-1a
+                std::uint64_t h = 14695981039346656037ULL;
+                for (std::size_t i = 0; i < len; ++i) {
+                    h ^= static_cast<unsigned char>(str[i]);
+                    h *= 1099511628211ULL;
+                }
+                return static_cast<std::size_t>(h);
+            }
+
+            void insert(std::size_t index) {
+                auto pos = hash(m_strings[index].c_str()) & (m_table.size() - 1);
+                while (m_table[pos] != 0) {
+                    pos = (pos + 1) & (m_table.size() - 1);
+                }
+                m_table[pos] = index + 1;
+            }
+
+            void rebuild() {
+                std::size_t capacity = 8;
+                // Keep the load factor below one half.
+                while (capacity < m_strings.size() * 2) {
+                    capacity *= 2;
+                }
+                m_table.assign(capacity, 0);
+                for (std::size_t i = 0; i < m_strings.size(); ++i) {
+                    insert(i);
+                }
+            }
+
+        public:
+
+            explicit set() = default;
+
+            explicit set(std::vector<std::string> strings) :
+                m_strings(std::move(strings)) {
+                rebuild();
+            }
+
+            set& add_string(const char* str) {
+                m_strings.emplace_back(str);
+                if (m_strings.size() * 2 >= m_table.size()) {
+                    rebuild();
+                } else {
+                    insert(m_strings.size() - 1);
+                }
+                return *this;
+            }
+
+            set& add_string(const std::string& str) {
+                return add_string(str.c_str());
+            }
+
+            bool match(const char* test_string) const noexcept {
+                if (m_strings.empty()) {
+                    return false;
+                }
+                auto pos = hash(test_string) & (m_table.size() - 1);
+                while (m_table[pos] != 0) {
+                    if (m_strings[m_table[pos] - 1] == test_string) {
+                        return true;
+                    }
+                    pos = (pos + 1) & (m_table.size() - 1);
+                }
+                return false;
+            }
+
+            bool match(const char* test_string, std::size_t len) const noexcept {
+                if (m_strings.empty()) {
+                    return false;
+                }
+                auto pos = hash(test_string, len) & (m_table.size() - 1);
+                while (m_table[pos] != 0) {
+                    const std::string& s = m_strings[m_table[pos] - 1];
+                    if (s.size() == len && !std::memcmp(s.data(), test_string, len)) {
+                        return true;
+                    }
+                    pos = (pos + 1) & (m_table.size() - 1);
+                }
+                return false;
+            }
+
+            template <typename TChar, typename TTraits>
+            void print(std::basic_ostream<TChar, TTraits>& out) const {
+                out << "set[";
+                for (const auto& s : m_strings) {
+                    out << '[' << s << ']';
+                }
+                out << ']';
+            }
+
+        }; // class set
+
     private:
 
         using matcher_type =
@@ -296,7 +458,8 @@ namespace osmium {
 #ifdef OSMIUM_WITH_REGEX
                  regex,
 #endif
-                 list>;
+                 list,
+                 set>;
 
         matcher_type m_matcher;
 
@@ -321,6 +484,29 @@ namespace osmium {
 
         }; // class match_visitor
 
+        class match_length_visitor
+#ifndef OSMIUM_USE_STD_VARIANT
+        : public boost::static_visitor<bool>
+#endif
+        {
+
+            const char* m_str;
+            std::size_t m_len;
+
+        public:
+
+            match_length_visitor(const char* str, std::size_t len) noexcept :
+                m_str(str),
+                m_len(len) {
+            }
+
+            template <typename TMatcher>
+            bool operator()(const TMatcher& t) const noexcept {
+                return t.match(m_str, m_len);
+            }
+
+        }; // class match_length_visitor
+
         template <typename TChar, typename TTraits>
         class print_visitor
 #ifndef OSMIUM_USE_STD_VARIANT
@@ -436,11 +622,39 @@ namespace osmium {
 #endif
         }
 
+        /**
+         * Match the specified string of the specified length. The string
+         * does not have to be NUL-terminated. Use this overload when the
+         * length is known already, it saves the matchers from scanning
+         * the string for the terminating NUL again.
+         */
+        bool operator()(const char* str, std::size_t len) const noexcept {
+#ifdef OSMIUM_USE_STD_VARIANT
+            return std::visit(match_length_visitor{str, len}, m_matcher);
+#else
+            return boost::apply_visitor(match_length_visitor{str, len}, m_matcher);
+#endif
+        }
+
         /**
          * Match the specified string.
          */
         bool operator()(const std::string& str) const noexcept {
-            return operator()(str.c_str());
+            return operator()(str.data(), str.size());
+        }
+
+        /**
+         * If this is an equal matcher, return the string it matches,
+         * otherwise return nullptr. Can be used to special-case exact
+         * string matches, for instance by indexing them in a hash table.
+         */
+        const char* equal_string() const noexcept {
+#ifdef OSMIUM_USE_STD_VARIANT
+            const auto* m = std::get_if<equal>(&m_matcher);
+#else
+            const auto* m = boost::get<equal>(&m_matcher);
+#endif
+            return m ? m->str() : nullptr;
         }
 
         template <typename TChar, typename TTraits>
@@ -0,0 +1,202 @@
+#ifndef OSMIUM_UTIL_STRING_POOL_HPP
+#define OSMIUM_UTIL_STRING_POOL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace osmium {
+
+    inline namespace util {
+
+        /**
+         * Hash-consed, append-only pool of unique strings. Interning a
+         * string returns a small integer id; the same string always gets
+         * the same id, so tag keys and values that appear millions of
+         * times in OSM data ("highway", "name", "building", ...) are
+         * stored only once. Use the ids in long-lived derived data
+         * structures instead of copies of the text.
+         *
+         * Strings are stored in chunks and are never moved or freed, so
+         * the pointers returned by get() stay valid for the lifetime of
+         * the pool. All member functions are thread-safe, access is
+         * serialized with an internal mutex.
+         *
+         * Use the global() pool for data shared across a whole process
+         * or create separate instances for independent datasets.
+         */
+        class StringPool {
+
+        public:
+
+            using id_type = std::uint32_t;
+
+        private:
+
+            enum : std::size_t {
+                default_chunk_size = 64UL * 1024UL
+            };
+
+            struct str_equal {
+                bool operator()(const char* lhs, const char* rhs) const noexcept {
+                    return lhs == rhs || std::strcmp(lhs, rhs) == 0;
+                }
+            };
+
+            struct djb2_hash {
+                std::size_t operator()(const char* str) const noexcept {
+                    std::size_t hash = 5381;
+                    int c = 0;
+
+                    while ((c = static_cast<signed char>(*str++))) { // NOLINT(bugprone-signed-char-misuse,cert-str34-c)
+                        hash = ((hash << 5U) + hash) + c; /* hash * 33 + c */
+                    }
+
+                    return hash;
+                }
+            };
+
+            mutable std::mutex m_mutex{};
+
+            std::size_t m_chunk_size;
+
+            // Stable storage for the string data. Like the StringStore
+            // used by the output formats: memory is allocated in chunks
+            // and only ever released when the pool is destroyed.
+            std::list<std::string> m_chunks{};
+
+            // The string with the id n is at index n.
+            std::vector<const char*> m_strings{};
+
+            std::unordered_map<const char*, id_type, djb2_hash, str_equal> m_ids{};
+
+            const char* store(const char* string, const std::size_t len) {
+                assert(len + 1 <= m_chunk_size);
+
+                if (m_chunks.empty() || m_chunks.back().size() + len + 1 > m_chunks.back().capacity()) {
+                    m_chunks.emplace_back();
+                    m_chunks.back().reserve(m_chunk_size);
+                }
+
+                auto& chunk = m_chunks.back();
+                const std::size_t offset = chunk.size();
+                chunk.append(string, len);
+                chunk.append(1, '\0');
+                return chunk.data() + offset;
+            }
+
+        public:
+
+            explicit StringPool(std::size_t chunk_size = default_chunk_size) :
+                m_chunk_size(chunk_size) {
+            }
+
+            StringPool(const StringPool&) = delete;
+            StringPool& operator=(const StringPool&) = delete;
+
+            StringPool(StringPool&&) = delete;
+            StringPool& operator=(StringPool&&) = delete;
+
+            ~StringPool() noexcept = default;
+
+            /**
+             * The process-wide string pool.
+             */
+            static StringPool& global() {
+                static StringPool pool;
+                return pool;
+            }
+
+            /**
+             * Add a null terminated string to the pool if it isn't in it
+             * already and return its id. Ids are dense and start at 0, so
+             * they can be used as vector indexes.
+             *
+             * @pre The string must be shorter than the chunk size.
+             */
+            id_type intern(const char* string) {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+
+                const auto it = m_ids.find(string);
+                if (it != m_ids.end()) {
+                    return it->second;
+                }
+
+                const char* stored = store(string, std::strlen(string));
+                const auto id = static_cast<id_type>(m_strings.size());
+                m_strings.push_back(stored);
+                m_ids.emplace(stored, id);
+                return id;
+            }
+
+            id_type intern(const std::string& string) {
+                return intern(string.c_str());
+            }
+
+            /**
+             * Get the string with the specified id.
+             *
+             * @pre The id must have been returned by intern() on this pool.
+             */
+            const char* get(const id_type id) const {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                assert(id < m_strings.size());
+                return m_strings[id];
+            }
+
+            /// The number of unique strings in the pool.
+            std::size_t size() const {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                return m_strings.size();
+            }
+
+            bool empty() const {
+                const std::lock_guard<std::mutex> lock{m_mutex};
+                return m_strings.empty();
+            }
+
+        }; // class StringPool
+
+    } // namespace util
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_STRING_POOL_HPP
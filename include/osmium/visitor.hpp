@@ -40,6 +40,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm.hpp>
 #include <osmium/osm/entity.hpp>
 #include <osmium/osm/item_type.hpp>
+#include <osmium/util/probes.hpp>
 
 #include <type_traits>
 #include <utility>
@@ -51,154 +52,170 @@ namespace osmium {
         template <typename T, typename U>
         using ConstIfConst = typename std::conditional<std::is_const<T>::value, typename std::add_const<U>::type, U>::type;
 
-        template <typename THandler, typename TItem>
-        inline void apply_item_impl(TItem& item, THandler&& handler) {
+        // The following helpers dispatch an item whose type is already
+        // known to one handler. Together with the pack expansion in the
+        // apply_item_impl() functions below this means the item type is
+        // inspected only once per item, no matter how many handlers there
+        // are, and all handler callbacks are invoked from a single place
+        // where the compiler can inline them.
+
+        template <typename TItem, typename THandler>
+        inline void apply_node(TItem& item, THandler&& handler) {
+            handler.osm_object(static_cast<ConstIfConst<TItem, osmium::OSMObject>&>(item));
+            handler.node(static_cast<ConstIfConst<TItem, osmium::Node>&>(item));
+        }
+
+        template <typename TItem, typename THandler>
+        inline void apply_way(TItem& item, THandler&& handler) {
+            handler.osm_object(static_cast<ConstIfConst<TItem, osmium::OSMObject>&>(item));
+            handler.way(static_cast<ConstIfConst<TItem, osmium::Way>&>(item));
+        }
+
+        template <typename TItem, typename THandler>
+        inline void apply_relation(TItem& item, THandler&& handler) {
+            handler.osm_object(static_cast<ConstIfConst<TItem, osmium::OSMObject>&>(item));
+            handler.relation(static_cast<ConstIfConst<TItem, osmium::Relation>&>(item));
+        }
+
+        template <typename TItem, typename THandler>
+        inline void apply_area(TItem& item, THandler&& handler) {
+            handler.osm_object(static_cast<ConstIfConst<TItem, osmium::OSMObject>&>(item));
+            handler.area(static_cast<ConstIfConst<TItem, osmium::Area>&>(item));
+        }
+
+        template <typename TItem, typename... THandlers>
+        inline void apply_item_impl(TItem& item, THandlers&&... handlers) {
             switch (item.type()) {
                 case osmium::item_type::undefined:
                     break;
                 case osmium::item_type::node:
-                    handler.osm_object(static_cast<ConstIfConst<TItem, osmium::OSMObject>&>(item));
-                    handler.node(static_cast<ConstIfConst<TItem, osmium::Node>&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_node(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::way:
-                    handler.osm_object(static_cast<ConstIfConst<TItem, osmium::OSMObject>&>(item));
-                    handler.way(static_cast<ConstIfConst<TItem, osmium::Way>&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_way(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::relation:
-                    handler.osm_object(static_cast<ConstIfConst<TItem, osmium::OSMObject>&>(item));
-                    handler.relation(static_cast<ConstIfConst<TItem, osmium::Relation>&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_relation(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::area:
-                    handler.osm_object(static_cast<ConstIfConst<TItem, osmium::OSMObject>&>(item));
-                    handler.area(static_cast<ConstIfConst<TItem, osmium::Area>&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_area(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::changeset:
-                    handler.changeset(static_cast<ConstIfConst<TItem, osmium::Changeset>&>(item));
+                    (void)std::initializer_list<int>{
+                        (handlers.changeset(static_cast<ConstIfConst<TItem, osmium::Changeset>&>(item)), 0)...};
+                    break;
+                case osmium::item_type::slim_node:
+                    (void)std::initializer_list<int>{
+                        (handlers.slim_node(static_cast<ConstIfConst<TItem, osmium::SlimNode>&>(item)), 0)...};
                     break;
                 case osmium::item_type::tag_list:
-                    handler.tag_list(static_cast<ConstIfConst<TItem, osmium::TagList>&>(item));
+                    (void)std::initializer_list<int>{
+                        (handlers.tag_list(static_cast<ConstIfConst<TItem, osmium::TagList>&>(item)), 0)...};
                     break;
                 case osmium::item_type::way_node_list:
-                    handler.way_node_list(static_cast<ConstIfConst<TItem, osmium::WayNodeList>&>(item));
+                    (void)std::initializer_list<int>{
+                        (handlers.way_node_list(static_cast<ConstIfConst<TItem, osmium::WayNodeList>&>(item)), 0)...};
+                    break;
+                case osmium::item_type::way_envelope:
+                    (void)std::initializer_list<int>{
+                        (handlers.way_envelope(static_cast<ConstIfConst<TItem, osmium::WayEnvelope>&>(item)), 0)...};
                     break;
                 case osmium::item_type::relation_member_list:
                 case osmium::item_type::relation_member_list_with_full_members:
-                    handler.relation_member_list(static_cast<ConstIfConst<TItem, osmium::RelationMemberList>&>(item));
+                    (void)std::initializer_list<int>{
+                        (handlers.relation_member_list(static_cast<ConstIfConst<TItem, osmium::RelationMemberList>&>(item)), 0)...};
                     break;
                 case osmium::item_type::outer_ring:
-                    handler.outer_ring(static_cast<ConstIfConst<TItem, osmium::OuterRing>&>(item));
+                    (void)std::initializer_list<int>{
+                        (handlers.outer_ring(static_cast<ConstIfConst<TItem, osmium::OuterRing>&>(item)), 0)...};
                     break;
                 case osmium::item_type::inner_ring:
-                    handler.inner_ring(static_cast<ConstIfConst<TItem, osmium::InnerRing>&>(item));
+                    (void)std::initializer_list<int>{
+                        (handlers.inner_ring(static_cast<ConstIfConst<TItem, osmium::InnerRing>&>(item)), 0)...};
                     break;
                 case osmium::item_type::changeset_discussion:
-                    handler.changeset_discussion(static_cast<ConstIfConst<TItem, osmium::ChangesetDiscussion>&>(item));
+                    (void)std::initializer_list<int>{
+                        (handlers.changeset_discussion(static_cast<ConstIfConst<TItem, osmium::ChangesetDiscussion>&>(item)), 0)...};
                     break;
             }
         }
 
-        template <typename THandler>
-        inline void apply_item_impl(const osmium::OSMEntity& item, THandler&& handler) {
+        template <typename TItem, typename... THandlers>
+        inline void apply_entity_impl(TItem& item, THandlers&&... handlers) {
             switch (item.type()) {
                 case osmium::item_type::node:
-                    handler.osm_object(static_cast<const osmium::OSMObject&>(item));
-                    handler.node(static_cast<const osmium::Node&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_node(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::way:
-                    handler.osm_object(static_cast<const osmium::OSMObject&>(item));
-                    handler.way(static_cast<const osmium::Way&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_way(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::relation:
-                    handler.osm_object(static_cast<const osmium::OSMObject&>(item));
-                    handler.relation(static_cast<const osmium::Relation&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_relation(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::area:
-                    handler.osm_object(static_cast<const osmium::OSMObject&>(item));
-                    handler.area(static_cast<const osmium::Area&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_area(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::changeset:
-                    handler.changeset(static_cast<const osmium::Changeset&>(item));
+                    (void)std::initializer_list<int>{
+                        (handlers.changeset(static_cast<ConstIfConst<TItem, osmium::Changeset>&>(item)), 0)...};
                     break;
                 default:
                     throw osmium::unknown_type{};
             }
         }
 
-        template <typename THandler>
-        inline void apply_item_impl(osmium::OSMEntity& item, THandler&& handler) {
-            switch (item.type()) {
-                case osmium::item_type::node:
-                    handler.osm_object(static_cast<osmium::OSMObject&>(item));
-                    handler.node(static_cast<osmium::Node&>(item));
-                    break;
-                case osmium::item_type::way:
-                    handler.osm_object(static_cast<osmium::OSMObject&>(item));
-                    handler.way(static_cast<osmium::Way&>(item));
-                    break;
-                case osmium::item_type::relation:
-                    handler.osm_object(static_cast<osmium::OSMObject&>(item));
-                    handler.relation(static_cast<osmium::Relation&>(item));
-                    break;
-                case osmium::item_type::area:
-                    handler.osm_object(static_cast<osmium::OSMObject&>(item));
-                    handler.area(static_cast<osmium::Area&>(item));
-                    break;
-                case osmium::item_type::changeset:
-                    handler.changeset(static_cast<osmium::Changeset&>(item));
-                    break;
-                default:
-                    throw osmium::unknown_type{};
-            }
+        template <typename... THandlers>
+        inline void apply_item_impl(const osmium::OSMEntity& item, THandlers&&... handlers) {
+            apply_entity_impl(item, std::forward<THandlers>(handlers)...);
         }
 
-        template <typename THandler>
-        inline void apply_item_impl(const osmium::OSMObject& item, THandler&& handler) {
-            switch (item.type()) {
-                case osmium::item_type::node:
-                    handler.osm_object(item);
-                    handler.node(static_cast<const osmium::Node&>(item));
-                    break;
-                case osmium::item_type::way:
-                    handler.osm_object(item);
-                    handler.way(static_cast<const osmium::Way&>(item));
-                    break;
-                case osmium::item_type::relation:
-                    handler.osm_object(item);
-                    handler.relation(static_cast<const osmium::Relation&>(item));
-                    break;
-                case osmium::item_type::area:
-                    handler.osm_object(item);
-                    handler.area(static_cast<const osmium::Area&>(item));
-                    break;
-                default:
-                    throw osmium::unknown_type{};
-            }
+        template <typename... THandlers>
+        inline void apply_item_impl(osmium::OSMEntity& item, THandlers&&... handlers) {
+            apply_entity_impl(item, std::forward<THandlers>(handlers)...);
         }
 
-        template <typename THandler>
-        inline void apply_item_impl(osmium::OSMObject& item, THandler&& handler) {
+        template <typename TItem, typename... THandlers>
+        inline void apply_object_impl(TItem& item, THandlers&&... handlers) {
             switch (item.type()) {
                 case osmium::item_type::node:
-                    handler.osm_object(item);
-                    handler.node(static_cast<osmium::Node&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_node(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::way:
-                    handler.osm_object(item);
-                    handler.way(static_cast<osmium::Way&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_way(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::relation:
-                    handler.osm_object(item);
-                    handler.relation(static_cast<osmium::Relation&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_relation(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 case osmium::item_type::area:
-                    handler.osm_object(item);
-                    handler.area(static_cast<osmium::Area&>(item));
+                    (void)std::initializer_list<int>{
+                        (apply_area(item, std::forward<THandlers>(handlers)), 0)...};
                     break;
                 default:
                     throw osmium::unknown_type{};
             }
         }
 
+        template <typename... THandlers>
+        inline void apply_item_impl(const osmium::OSMObject& item, THandlers&&... handlers) {
+            apply_object_impl(item, std::forward<THandlers>(handlers)...);
+        }
+
+        template <typename... THandlers>
+        inline void apply_item_impl(osmium::OSMObject& item, THandlers&&... handlers) {
+            apply_object_impl(item, std::forward<THandlers>(handlers)...);
+        }
+
         template <typename TFunc>
         struct wrapper_handler : TFunc {
 
@@ -261,12 +278,24 @@ namespace osmium {
                 operator()(changeset);
             }
 
+            void slim_node(const osmium::SlimNode& slim_node) const {
+                operator()(slim_node);
+            }
+
+            // cppcheck-suppress constParameter
+            void slim_node(osmium::SlimNode& slim_node) const {
+                operator()(slim_node);
+            }
+
             void tag_list(const osmium::TagList& /*tag_list*/) const noexcept {
             }
 
             void way_node_list(const osmium::WayNodeList& /*way_node_list*/) const noexcept {
             }
 
+            void way_envelope(const osmium::WayEnvelope& /*way_envelope*/) const noexcept {
+            }
+
             void relation_member_list(const osmium::RelationMemberList& /*relation_member_list*/) const noexcept {
             }
 
@@ -304,8 +333,7 @@ namespace osmium {
 
     template <typename TItem, typename... THandlers>
     inline void apply_item(TItem& item, THandlers&&... handlers) {
-        (void)std::initializer_list<int>{
-            (detail::apply_item_impl(item, std::forward<THandlers>(handlers)), 0)...};
+        detail::apply_item_impl(item, std::forward<THandlers>(handlers)...);
     }
 
     template <typename... THandlers>
@@ -336,7 +364,9 @@ namespace osmium {
 
     template <typename... THandlers>
     inline void apply(const osmium::memory::Buffer& buffer, THandlers&&... handlers) {
+        OSMIUM_PROBE1(apply_start, buffer.committed());
         apply(buffer.cbegin(), buffer.cend(), std::forward<THandlers>(handlers)...);
+        OSMIUM_PROBE(apply_end);
     }
 
 } // namespace osmium
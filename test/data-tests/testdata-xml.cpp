@@ -102,7 +102,12 @@ static header_buffer_type parse_xml(std::string input) {
         &offset,
         osmium::osm_entity_bits::all,
         osmium::io::read_meta::yes,
+        osmium::io::read_tags::yes,
+        osmium::io::read_discussions::yes,
+        osmium::io::way_envelopes::no,
+        osmium::Box{},
         osmium::io::buffers_type::any,
+        0,
         false
     };
     osmium::io::detail::XMLParser parser{args};
@@ -1,6 +1,7 @@
 #include "catch.hpp"
 
 #include <osmium/area/assembler.hpp>
+#include <osmium/area/multipolygon_manager.hpp>
 #include <osmium/builder/attr.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/area.hpp>
@@ -43,6 +44,57 @@ TEST_CASE("Build area from way") {
     REQUIRE(s.invalid_locations == 0);
 }
 
+TEST_CASE("Reuse assembler for several areas") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto wpos1 = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({
+            {1, {1.0, 1.0}},
+            {2, {1.0, 2.0}},
+            {3, {2.0, 2.0}},
+            {4, {2.0, 1.0}},
+            {1, {1.0, 1.0}}
+        })
+    );
+
+    const auto wpos2 = osmium::builder::add_way(buffer,
+        _id(2),
+        _nodes({
+            {5, {3.0, 3.0}},
+            {6, {3.0, 4.0}},
+            {7, {4.0, 4.0}},
+            {5, {3.0, 3.0}}
+        })
+    );
+
+    const osmium::area::AssemblerConfig config;
+    osmium::area::Assembler assembler{config};
+
+    osmium::memory::Buffer area_buffer{10240};
+    REQUIRE(assembler(buffer.get<osmium::Way>(wpos1), area_buffer));
+
+    assembler.clear();
+    REQUIRE(assembler(buffer.get<osmium::Way>(wpos2), area_buffer));
+
+    const auto& area1 = area_buffer.get<osmium::Area>(0);
+    REQUIRE(area1.from_way());
+    REQUIRE(area1.id() == 2);
+    REQUIRE(area1.outer_rings().begin()->size() == 5);
+
+    const auto& area2 = area_buffer.get<osmium::Area>(area_buffer.get_iterator<osmium::Area>(0)->padded_size());
+    REQUIRE(area2.from_way());
+    REQUIRE(area2.id() == 4);
+    REQUIRE(area2.outer_rings().begin()->size() == 4);
+
+    // clear() also resets the statistics, so only the second
+    // area shows up here.
+    const auto& s = assembler.stats();
+    REQUIRE(s.area_simple_case == 1);
+    REQUIRE(s.from_ways == 1);
+    REQUIRE(s.nodes == 3);
+}
+
 TEST_CASE("Build area from way with duplicate nodes") {
     osmium::memory::Buffer buffer{10240};
 
@@ -141,3 +193,52 @@ TEST_CASE("Build area from way with ignored invalid location") {
     REQUIRE(s.invalid_locations == 1);
 }
 
+TEST_CASE("MultipolygonManager with compact area ids") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto wpos1 = osmium::builder::add_way(buffer,
+        _id(7),
+        _tag("landuse", "forest"),
+        _nodes({
+            {1, {1.0, 1.0}},
+            {2, {1.0, 2.0}},
+            {3, {2.0, 2.0}},
+            {4, {2.0, 1.0}},
+            {1, {1.0, 1.0}}
+        })
+    );
+
+    const auto wpos2 = osmium::builder::add_way(buffer,
+        _id(8),
+        _tag("landuse", "forest"),
+        _nodes({
+            {5, {3.0, 3.0}},
+            {6, {3.0, 4.0}},
+            {7, {4.0, 4.0}},
+            {5, {3.0, 3.0}}
+        })
+    );
+
+    const osmium::area::AssemblerConfig config;
+    osmium::area::MultipolygonManager<osmium::area::Assembler> manager{config};
+    manager.use_compact_ids();
+
+    manager.after_way(buffer.get<osmium::Way>(wpos1));
+    manager.after_way(buffer.get<osmium::Way>(wpos2));
+    manager.flush_output();
+
+    const osmium::memory::Buffer out = manager.read();
+    const auto areas = out.select<osmium::Area>();
+    REQUIRE(areas.size() == 2);
+
+    auto it = areas.cbegin();
+    REQUIRE(it->id() == 1);
+    ++it;
+    REQUIRE(it->id() == 2);
+
+    // the original area ids are available on the side
+    REQUIRE(manager.original_area_id(1) == 14);
+    REQUIRE(manager.original_area_id(2) == 16);
+    REQUIRE(manager.original_area_id(0) == 0);
+    REQUIRE(manager.original_area_id(3) == 0);
+}
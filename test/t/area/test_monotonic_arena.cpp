@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include <osmium/area/detail/monotonic_arena.hpp>
+
+#include <cstdint>
+#include <list>
+#include <vector>
+
+using osmium::area::detail::ArenaAllocator;
+using osmium::area::detail::MonotonicArena;
+
+TEST_CASE("Arena hands out aligned memory") {
+    MonotonicArena arena;
+
+    void* p1 = arena.allocate(1, 1);
+    void* p2 = arena.allocate(8, 8);
+    void* p3 = arena.allocate(4, 4);
+
+    REQUIRE(p1 != nullptr);
+    REQUIRE(p2 != nullptr);
+    REQUIRE(p3 != nullptr);
+    REQUIRE(p1 != p2);
+    REQUIRE(p2 != p3);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p2) % 8 == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p3) % 4 == 0);
+    REQUIRE(arena.num_chunks() == 1);
+}
+
+TEST_CASE("Arena adds chunks as needed") {
+    MonotonicArena arena;
+
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(arena.allocate(1000, 8) != nullptr);
+    }
+    REQUIRE(arena.num_chunks() > 1);
+
+    // Allocations larger than the chunk size get their own chunk.
+    const auto chunks_before = arena.num_chunks();
+    REQUIRE(arena.allocate(1024UL * 1024UL, 8) != nullptr);
+    REQUIRE(arena.num_chunks() == chunks_before + 1);
+
+    arena.clear();
+    REQUIRE(arena.num_chunks() == 0);
+}
+
+TEST_CASE("Arena reset keeps the first chunk for reuse") {
+    MonotonicArena arena;
+
+    arena.reset(); // reset on empty arena is a no-op
+    REQUIRE(arena.num_chunks() == 0);
+
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(arena.allocate(1000, 8) != nullptr);
+    }
+    REQUIRE(arena.num_chunks() > 1);
+
+    arena.reset();
+    REQUIRE(arena.num_chunks() == 1);
+
+    // After the reset the kept chunk is handed out again.
+    REQUIRE(arena.allocate(1000, 8) != nullptr);
+    REQUIRE(arena.num_chunks() == 1);
+}
+
+TEST_CASE("Arena allocator works with standard containers") {
+    MonotonicArena arena;
+
+    std::vector<int, ArenaAllocator<int>> v{ArenaAllocator<int>{&arena}};
+    for (int i = 0; i < 1000; ++i) {
+        v.push_back(i);
+    }
+    REQUIRE(v.size() == 1000);
+    REQUIRE(v[999] == 999);
+
+    std::list<int, ArenaAllocator<int>> l{ArenaAllocator<int>{&arena}};
+    for (int i = 0; i < 1000; ++i) {
+        l.push_back(i);
+    }
+    REQUIRE(l.size() == 1000);
+    REQUIRE(l.back() == 999);
+
+    REQUIRE(arena.num_chunks() > 0);
+}
+
+TEST_CASE("Arena allocator without arena falls back to the heap") {
+    std::vector<int, ArenaAllocator<int>> v;
+    for (int i = 0; i < 1000; ++i) {
+        v.push_back(i);
+    }
+    REQUIRE(v.size() == 1000);
+
+    REQUIRE(ArenaAllocator<int>{} == ArenaAllocator<long>{});
+
+    MonotonicArena arena;
+    REQUIRE(ArenaAllocator<int>{&arena} == ArenaAllocator<long>{&arena});
+    REQUIRE(ArenaAllocator<int>{&arena} != ArenaAllocator<int>{});
+}
@@ -0,0 +1,117 @@
+#include "catch.hpp"
+
+#include <osmium/area/problem_reporter_buffered.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+/**
+ * Problem reporter that records every report as a string together
+ * with the object context it was made in.
+ */
+class RecordingProblemReporter : public osmium::area::ProblemReporter {
+
+    std::string context() const {
+        return std::string{osmium::item_type_to_char(m_object_type)} + std::to_string(m_object_id) + "/" + std::to_string(m_nodes) + ": ";
+    }
+
+public:
+
+    std::vector<std::string> records{};
+
+    void report_duplicate_node(osmium::object_id_type node_id1, osmium::object_id_type node_id2, osmium::Location /*location*/) override {
+        records.push_back(context() + "duplicate_node " + std::to_string(node_id1) + " " + std::to_string(node_id2));
+    }
+
+    void report_intersection(osmium::object_id_type way1_id, osmium::Location /*way1_seg_start*/, osmium::Location /*way1_seg_end*/,
+                             osmium::object_id_type way2_id, osmium::Location /*way2_seg_start*/, osmium::Location /*way2_seg_end*/, osmium::Location intersection) override {
+        records.push_back(context() + "intersection " + std::to_string(way1_id) + " " + std::to_string(way2_id) + " at " + std::to_string(intersection.lon()));
+    }
+
+    void report_ring_not_closed(const osmium::NodeRef& nr, const osmium::Way* way) override {
+        records.push_back(context() + "ring_not_closed " + std::to_string(nr.ref()) + " way " + (way ? std::to_string(way->id()) : "none"));
+    }
+
+    void report_way(const osmium::Way& way) override {
+        records.push_back(context() + "way " + std::to_string(way.id()) + " " + std::to_string(way.nodes().size()));
+    }
+
+}; // class RecordingProblemReporter
+
+/// Problem reporter that fails on every report.
+class ThrowingProblemReporter : public osmium::area::ProblemReporter {
+
+    void report_way(const osmium::Way& /*way*/) override {
+        throw std::runtime_error{"no thanks"};
+    }
+
+}; // class ThrowingProblemReporter
+
+} // anonymous namespace
+
+TEST_CASE("Buffered problem reporter forwards reports in order") {
+    osmium::memory::Buffer buffer{10240};
+    const auto wpos = osmium::builder::add_way(buffer,
+        _id(17),
+        _nodes({1, 2, 3})
+    );
+    const osmium::Way& way = buffer.get<osmium::Way>(wpos);
+
+    RecordingProblemReporter recorder;
+
+    {
+        // A small batch size, so that several batches are used.
+        osmium::area::ProblemReporterBuffered reporter{recorder, 2};
+
+        reporter.set_object(osmium::item_type::relation, 123);
+        reporter.set_nodes(7);
+        reporter.report_duplicate_node(10, 11, osmium::Location{1.0, 2.0});
+        reporter.report_intersection(20, osmium::Location{}, osmium::Location{},
+                                     21, osmium::Location{}, osmium::Location{}, osmium::Location{1.5, 1.5});
+
+        // The object context must be captured per report, not per batch.
+        reporter.set_object(osmium::item_type::way, 456);
+        reporter.set_nodes(4);
+        reporter.report_ring_not_closed(osmium::NodeRef{30, osmium::Location{3.0, 3.0}}, nullptr);
+        reporter.report_ring_not_closed(osmium::NodeRef{31, osmium::Location{4.0, 4.0}}, &way);
+        reporter.report_way(way);
+
+        reporter.flush();
+        REQUIRE(recorder.records.size() == 5);
+
+        // The reporter can be used again after a flush.
+        reporter.report_way(way);
+    }
+
+    const std::vector<std::string> expected = {
+        "r123/7: duplicate_node 10 11",
+        "r123/7: intersection 20 21 at 1.500000",
+        "w456/4: ring_not_closed 30 way none",
+        "w456/4: ring_not_closed 31 way 17",
+        "w456/4: way 17 3",
+        "w456/4: way 17 3"
+    };
+    REQUIRE(recorder.records == expected);
+}
+
+TEST_CASE("Buffered problem reporter rethrows downstream exceptions on flush") {
+    osmium::memory::Buffer buffer{10240};
+    const auto wpos = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({1, 2})
+    );
+
+    ThrowingProblemReporter thrower;
+    osmium::area::ProblemReporterBuffered reporter{thrower};
+
+    reporter.report_way(buffer.get<osmium::Way>(wpos));
+    REQUIRE_THROWS_AS(reporter.flush(), std::runtime_error);
+}
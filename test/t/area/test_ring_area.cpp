@@ -0,0 +1,100 @@
+#include "catch.hpp"
+
+#include <osmium/area/ring_area.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+const osmium::Way& make_way(osmium::memory::Buffer& buffer, const std::vector<osmium::NodeRef>& nodes) {
+    const auto pos = osmium::builder::add_way(buffer, _id(1), _nodes(nodes));
+    return buffer.get<osmium::Way>(pos);
+}
+
+} // anonymous namespace
+
+TEST_CASE("Signed area of counterclockwise unit square") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    const auto& way = make_way(buffer, {
+        {1, osmium::Location{0.0, 0.0}},
+        {2, osmium::Location{1.0, 0.0}},
+        {3, osmium::Location{1.0, 1.0}},
+        {4, osmium::Location{0.0, 1.0}},
+        {1, osmium::Location{0.0, 0.0}}
+    });
+
+    // twice the area in raw coordinate units (10^7 per degree)
+    REQUIRE(osmium::area::signed_area_sum(way.nodes()) == 2LL * 10000000LL * 10000000LL);
+    REQUIRE(osmium::area::signed_area(way.nodes()) == Approx(1.0));
+    REQUIRE_FALSE(osmium::area::is_clockwise(way.nodes()));
+}
+
+TEST_CASE("Signed area of clockwise unit square") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    const auto& way = make_way(buffer, {
+        {1, osmium::Location{0.0, 0.0}},
+        {4, osmium::Location{0.0, 1.0}},
+        {3, osmium::Location{1.0, 1.0}},
+        {2, osmium::Location{1.0, 0.0}},
+        {1, osmium::Location{0.0, 0.0}}
+    });
+
+    REQUIRE(osmium::area::signed_area_sum(way.nodes()) == -2LL * 10000000LL * 10000000LL);
+    REQUIRE(osmium::area::signed_area(way.nodes()) == Approx(-1.0));
+    REQUIRE(osmium::area::is_clockwise(way.nodes()));
+}
+
+TEST_CASE("Ring without repeated end node is implicitly closed") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    const auto& way = make_way(buffer, {
+        {1, osmium::Location{0.0, 0.0}},
+        {2, osmium::Location{1.0, 0.0}},
+        {3, osmium::Location{1.0, 1.0}},
+        {4, osmium::Location{0.0, 1.0}}
+    });
+
+    REQUIRE(osmium::area::signed_area_sum(way.nodes()) == 2LL * 10000000LL * 10000000LL);
+}
+
+TEST_CASE("Degenerate rings have no area") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    const auto& way = make_way(buffer, {
+        {1, osmium::Location{0.0, 0.0}},
+        {2, osmium::Location{1.0, 0.0}}
+    });
+
+    REQUIRE(osmium::area::signed_area_sum(way.nodes()) == 0);
+    REQUIRE(osmium::area::is_clockwise(way.nodes()));
+}
+
+TEST_CASE("Signed area of large ring matches scalar shoelace formula") {
+    // Build a sawtooth ring with more nodes than the internal batch
+    // size so the result is summed over several batches.
+    std::vector<osmium::NodeRef> nodes;
+    osmium::object_id_type id = 1;
+    for (int i = 0; i < 300; ++i) {
+        nodes.emplace_back(id++, osmium::Location{i * 0.001, (i % 2) * 0.0001});
+    }
+    for (int i = 299; i >= 0; --i) {
+        nodes.emplace_back(id++, osmium::Location{i * 0.001, 1.0 + (i % 3) * 0.0001});
+    }
+    nodes.push_back(nodes.front());
+
+    osmium::memory::Buffer buffer{1024UL * 64UL};
+    const auto& way = make_way(buffer, nodes);
+
+    int64_t expected = 0;
+    for (std::size_t i = 0; i + 1 < nodes.size(); ++i) {
+        expected += static_cast<int64_t>(nodes[i].x()) * nodes[i + 1].y() -
+                    static_cast<int64_t>(nodes[i].y()) * nodes[i + 1].x();
+    }
+
+    REQUIRE(osmium::area::signed_area_sum(way.nodes()) == expected);
+    REQUIRE_FALSE(osmium::area::is_clockwise(way.nodes()));
+}
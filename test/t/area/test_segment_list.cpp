@@ -0,0 +1,229 @@
+#include "catch.hpp"
+
+#include <osmium/area/detail/segment_list.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+/// Build a closed way from the given nodes and extract its segments.
+const osmium::Way& make_way(osmium::memory::Buffer& buffer, const std::vector<osmium::NodeRef>& nodes) {
+    const auto wpos = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes(nodes)
+    );
+    return buffer.get<osmium::Way>(wpos);
+}
+
+/// Create the nodes of a closed ring with the given number of segments.
+std::vector<osmium::NodeRef> make_ring_nodes(const std::size_t num_segments) {
+    std::vector<osmium::NodeRef> nodes;
+    nodes.reserve(num_segments + 1);
+    for (std::size_t n = 0; n < num_segments; ++n) {
+        const double angle = 2 * 3.14159265358979323846 * static_cast<double>(n) / static_cast<double>(num_segments);
+        nodes.emplace_back(static_cast<osmium::object_id_type>(n + 1),
+                           osmium::Location{std::cos(angle), std::sin(angle)});
+    }
+    nodes.push_back(nodes.front());
+    return nodes;
+}
+
+uint32_t count_intersections(const std::vector<osmium::NodeRef>& nodes) {
+    osmium::memory::Buffer buffer{1024UL * 256UL};
+    const osmium::Way& way = make_way(buffer, nodes);
+
+    osmium::area::detail::SegmentList segment_list{false};
+    uint64_t duplicate_nodes = 0;
+    segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    REQUIRE(duplicate_nodes == 0);
+    segment_list.sort();
+
+    return segment_list.find_intersections(nullptr);
+}
+
+} // anonymous namespace
+
+TEST_CASE("Extract segments from way with duplicate node") {
+    osmium::memory::Buffer buffer{1024UL * 64UL};
+
+    // The repeated location disables the bulk fast path, the duplicate
+    // must be counted and only one segment comes out of it.
+    const osmium::Way& way = make_way(buffer, {
+        {1, {0.0, 0.0}},
+        {2, {1.0, 0.0}},
+        {3, {1.0, 0.0}},
+        {4, {1.0, 1.0}}
+    });
+
+    osmium::area::detail::SegmentList segment_list{false};
+    uint64_t duplicate_nodes = 0;
+    REQUIRE(segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way) == 0);
+
+    REQUIRE(segment_list.size() == 2);
+    REQUIRE(duplicate_nodes == 1);
+}
+
+TEST_CASE("Extract segments from way with invalid location") {
+    osmium::memory::Buffer buffer{1024UL * 64UL};
+
+    const osmium::Way& way = make_way(buffer, {
+        {1, {0.0, 0.0}},
+        {2, osmium::Location{}},
+        {3, {1.0, 1.0}}
+    });
+
+    osmium::area::detail::SegmentList segment_list{false};
+    uint64_t duplicate_nodes = 0;
+    REQUIRE(segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way) == 1);
+
+    // the node without location is skipped, its neighbors are connected
+    REQUIRE(segment_list.size() == 1);
+    REQUIRE(duplicate_nodes == 0);
+}
+
+TEST_CASE("Erase duplicate segments in small list") {
+    osmium::memory::Buffer buffer{1024UL * 64UL};
+
+    // A way with a "spike": the segments 2-3 and 3-2 are duplicates.
+    const osmium::Way& way = make_way(buffer, {
+        {1, {0.0, 0.0}},
+        {2, {1.0, 0.0}},
+        {3, {1.0, 1.0}},
+        {2, {1.0, 0.0}},
+        {4, {2.0, 0.0}},
+        {1, {0.0, 0.0}}
+    });
+
+    osmium::area::detail::SegmentList segment_list{false};
+    uint64_t duplicate_nodes = 0;
+    segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    REQUIRE(segment_list.size() == 5);
+
+    segment_list.sort();
+    uint64_t duplicate_segments = 0;
+    uint64_t overlapping_segments = 0;
+    segment_list.erase_duplicate_segments(nullptr, duplicate_segments, overlapping_segments);
+
+    REQUIRE(segment_list.size() == 3);
+    REQUIRE(duplicate_segments == 1);
+    REQUIRE(overlapping_segments == 0);
+}
+
+TEST_CASE("Erase overlapping segments in small list") {
+    osmium::memory::Buffer buffer{1024UL * 64UL};
+
+    // Three identical segments between the nodes 1 and 2.
+    const osmium::Way& way = make_way(buffer, {
+        {1, {0.0, 0.0}},
+        {2, {1.0, 0.0}},
+        {1, {0.0, 0.0}},
+        {2, {1.0, 0.0}}
+    });
+
+    osmium::area::detail::SegmentList segment_list{false};
+    uint64_t duplicate_nodes = 0;
+    segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    REQUIRE(segment_list.size() == 3);
+
+    segment_list.sort();
+    uint64_t duplicate_segments = 0;
+    uint64_t overlapping_segments = 0;
+    segment_list.erase_duplicate_segments(nullptr, duplicate_segments, overlapping_segments);
+
+    // Duplicates are removed in pairs, one of the three segments is left.
+    REQUIRE(segment_list.size() == 1);
+    REQUIRE(duplicate_segments == 1);
+    REQUIRE(overlapping_segments == 1);
+}
+
+TEST_CASE("Erase duplicate segments in large list") {
+    // More than 1024 segments, so the sorted scan is used instead of
+    // the hash table.
+    auto nodes = make_ring_nodes(1100);
+    nodes.insert(nodes.begin() + 51, {osmium::NodeRef{9001, osmium::Location{5.0, 5.0}}, nodes[50]});
+
+    osmium::memory::Buffer buffer{1024UL * 256UL};
+    const osmium::Way& way = make_way(buffer, nodes);
+
+    osmium::area::detail::SegmentList segment_list{false};
+    uint64_t duplicate_nodes = 0;
+    segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    REQUIRE(segment_list.size() == 1102);
+
+    segment_list.sort();
+    uint64_t duplicate_segments = 0;
+    uint64_t overlapping_segments = 0;
+    segment_list.erase_duplicate_segments(nullptr, duplicate_segments, overlapping_segments);
+
+    REQUIRE(segment_list.size() == 1100);
+    REQUIRE(duplicate_segments == 1);
+    REQUIRE(overlapping_segments == 0);
+    REQUIRE(segment_list.find_intersections(nullptr) == 0);
+}
+
+TEST_CASE("Small ring without intersections") {
+    REQUIRE(count_intersections(make_ring_nodes(10)) == 0);
+}
+
+TEST_CASE("Small ring with self-intersection") {
+    auto nodes = make_ring_nodes(10);
+    std::swap(nodes[4], nodes[5]);
+    REQUIRE(count_intersections(nodes) == 1);
+}
+
+TEST_CASE("Large ring without intersections") {
+    // More than 100 segments, so the spatial grid index is used.
+    REQUIRE(count_intersections(make_ring_nodes(200)) == 0);
+}
+
+TEST_CASE("Large ring with self-intersections") {
+    auto nodes = make_ring_nodes(200);
+
+    // Each swap of two neighboring points in a convex ring creates
+    // exactly one self-intersection.
+    std::swap(nodes[10], nodes[11]);
+    std::swap(nodes[100], nodes[101]);
+    std::swap(nodes[190], nodes[191]);
+
+    REQUIRE(count_intersections(nodes) == 3);
+}
+
+TEST_CASE("Large ring with crossing chord segments") {
+    auto nodes = make_ring_nodes(150);
+
+    // Move two points to far outside the opposite side of the ring,
+    // turning their four adjacent edges into long chords crossing
+    // many ring segments.
+    nodes[0] = osmium::NodeRef{201, osmium::Location{-3.0, 0.5}};
+    nodes.back() = nodes.front();
+    nodes[75] = osmium::NodeRef{202, osmium::Location{3.0, -0.5}};
+
+    osmium::memory::Buffer buffer{1024UL * 256UL};
+    const osmium::Way& way = make_way(buffer, nodes);
+
+    osmium::area::detail::SegmentList segment_list{false};
+    uint64_t duplicate_nodes = 0;
+    segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    segment_list.sort();
+
+    // Compare the result of the spatial grid index against a brute
+    // force check of all segment pairs.
+    uint32_t expected = 0;
+    for (std::size_t i = 0; i + 1 < segment_list.size(); ++i) {
+        for (std::size_t j = i + 1; j < segment_list.size(); ++j) {
+            if (osmium::area::detail::calculate_intersection(segment_list[i], segment_list[j])) {
+                ++expected;
+            }
+        }
+    }
+
+    REQUIRE(expected > 0);
+    REQUIRE(segment_list.find_intersections(nullptr) == expected);
+}
@@ -0,0 +1,55 @@
+// This TU builds everything in trusted mode, the other builder tests
+// cover the normal zeroing mode.
+#define OSMIUM_TRUSTED_BUILDERS
+
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/changeset.hpp>
+#include <osmium/osm/node.hpp>
+
+#include <string>
+
+TEST_CASE("Trusted builders produce readable objects") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1), _version(2), _user("short"),
+                              _tag("highway", "primary"), _tag("name", "High Street"));
+    osmium::builder::add_node(buffer, _id(2),
+                              _user("a user name longer than the preallocated area"));
+    osmium::builder::add_node(buffer, _id(3)); // empty user name
+
+    auto it = buffer.select<osmium::Node>().begin();
+    REQUIRE(it->id() == 1);
+    REQUIRE(std::string{it->user()} == "short");
+    REQUIRE(std::string{it->tags()["highway"]} == "primary");
+    REQUIRE(std::string{it->tags()["name"]} == "High Street");
+
+    ++it;
+    REQUIRE(it->id() == 2);
+    REQUIRE(std::string{it->user()} == "a user name longer than the preallocated area");
+
+    ++it;
+    REQUIRE(it->id() == 3);
+    REQUIRE(std::string{it->user()}.empty());
+}
+
+TEST_CASE("Trusted changeset builder produces readable changesets") {
+    osmium::memory::Buffer buffer{1024UL * 16UL, osmium::memory::Buffer::auto_grow::yes};
+
+    {
+        osmium::builder::ChangesetBuilder builder{buffer};
+        builder.set_id(42)
+               .set_num_changes(7)
+               .set_user("some user");
+    }
+    buffer.commit();
+
+    const auto& changeset = buffer.get<osmium::Changeset>(0);
+    REQUIRE(changeset.id() == 42);
+    REQUIRE(changeset.num_changes() == 7);
+    REQUIRE(std::string{changeset.user()} == "some user");
+}
@@ -0,0 +1,144 @@
+#include "catch.hpp"
+
+#include "area_helper.hpp"
+#include "wnl_helper.hpp"
+
+#include <osmium/geom/geos_c.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+
+namespace {
+
+    double get_x(GEOSContextHandle_t context, const GEOSGeometry* point) {
+        double x = 0.0;
+        REQUIRE(1 == GEOSGeomGetX_r(context, point, &x));
+        return x;
+    }
+
+    double get_y(GEOSContextHandle_t context, const GEOSGeometry* point) {
+        double y = 0.0;
+        REQUIRE(1 == GEOSGeomGetY_r(context, point, &y));
+        return y;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("GEOS C API geometry factory - create point") {
+    GEOSContextHandle_t context = GEOS_init_r();
+    {
+        osmium::geom::GEOSCFactory<> factory{context};
+
+        const auto point = factory.create_point(osmium::Location{3.2, 4.2});
+        REQUIRE(3.2 == get_x(context, point.get()));
+        REQUIRE(4.2 == get_y(context, point.get()));
+        REQUIRE(4326 == GEOSGetSRID_r(context, point.get()));
+    }
+    GEOS_finish_r(context);
+}
+
+TEST_CASE("GEOS C API geometry factory - create point with own context") {
+    osmium::geom::GEOSCFactory<> factory;
+
+    const auto point = factory.create_point(osmium::Location{3.2, 4.2});
+    REQUIRE(point);
+}
+
+TEST_CASE("GEOS C API geometry factory - create point in web mercator") {
+    GEOSContextHandle_t context = GEOS_init_r();
+    {
+        osmium::geom::GEOSCFactory<osmium::geom::MercatorProjection> factory{context};
+
+        const auto point = factory.create_point(osmium::Location{3.2, 4.2});
+        REQUIRE(Approx(356222.3705384755L) == get_x(context, point.get()));
+        REQUIRE(Approx(467961.143605213L) == get_y(context, point.get()));
+        REQUIRE(3857 == GEOSGetSRID_r(context, point.get()));
+    }
+    GEOS_finish_r(context);
+}
+
+TEST_CASE("GEOS C API geometry factory - can not create from invalid location") {
+    osmium::geom::GEOSCFactory<> factory;
+
+    REQUIRE_THROWS_AS(factory.create_point(osmium::Location{}), osmium::invalid_location);
+}
+
+TEST_CASE("GEOS C API geometry factory - create linestring") {
+    GEOSContextHandle_t context = GEOS_init_r();
+    {
+        osmium::geom::GEOSCFactory<> factory{context};
+
+        osmium::memory::Buffer buffer{10000};
+        const auto& wnl = create_test_wnl_okay(buffer);
+
+        SECTION("from way node list") {
+            const auto linestring = factory.create_linestring(wnl);
+            REQUIRE(3 == GEOSGeomGetNumPoints_r(context, linestring.get()));
+
+            const osmium::geom::geos_c_geometry_type p0{GEOSGeomGetPointN_r(context, linestring.get(), 0),
+                                                        osmium::geom::GEOSCGeometryDeleter{context}};
+            REQUIRE(3.2 == get_x(context, p0.get()));
+            const osmium::geom::geos_c_geometry_type p2{GEOSGeomGetPointN_r(context, linestring.get(), 2),
+                                                        osmium::geom::GEOSCGeometryDeleter{context}};
+            REQUIRE(3.6 == get_x(context, p2.get()));
+        }
+
+        SECTION("without duplicates and backwards") {
+            const auto linestring = factory.create_linestring(wnl, osmium::geom::use_nodes::unique, osmium::geom::direction::backward);
+            REQUIRE(3 == GEOSGeomGetNumPoints_r(context, linestring.get()));
+            const osmium::geom::geos_c_geometry_type p0{GEOSGeomGetPointN_r(context, linestring.get(), 0),
+                                                        osmium::geom::GEOSCGeometryDeleter{context}};
+            REQUIRE(3.6 == get_x(context, p0.get()));
+        }
+
+        SECTION("with duplicates") {
+            const auto linestring = factory.create_linestring(wnl, osmium::geom::use_nodes::all);
+            REQUIRE(4 == GEOSGeomGetNumPoints_r(context, linestring.get()));
+        }
+    }
+    GEOS_finish_r(context);
+}
+
+TEST_CASE("GEOS C API geometry factory - create area with one outer and one inner ring") {
+    GEOSContextHandle_t context = GEOS_init_r();
+    {
+        osmium::geom::GEOSCFactory<> factory{context};
+
+        osmium::memory::Buffer buffer{10000};
+        const osmium::Area& area = create_test_area_1outer_1inner(buffer);
+
+        const auto mp = factory.create_multipolygon(area);
+        REQUIRE(1 == GEOSGetNumGeometries_r(context, mp.get()));
+
+        const GEOSGeometry* p0 = GEOSGetGeometryN_r(context, mp.get(), 0);
+        REQUIRE(p0);
+        REQUIRE(1 == GEOSGetNumInteriorRings_r(context, p0));
+
+        const GEOSGeometry* l0e = GEOSGetExteriorRing_r(context, p0);
+        REQUIRE(5 == GEOSGeomGetNumPoints_r(context, l0e));
+
+        const GEOSGeometry* l0i0 = GEOSGetInteriorRingN_r(context, p0, 0);
+        REQUIRE(5 == GEOSGeomGetNumPoints_r(context, l0i0));
+    }
+    GEOS_finish_r(context);
+}
+
+TEST_CASE("GEOS C API geometry factory - create area with two outer and two inner rings") {
+    GEOSContextHandle_t context = GEOS_init_r();
+    {
+        osmium::geom::GEOSCFactory<> factory{context};
+
+        osmium::memory::Buffer buffer{10000};
+        const osmium::Area& area = create_test_area_2outer_2inner(buffer);
+
+        const auto mp = factory.create_multipolygon(area);
+        REQUIRE(2 == GEOSGetNumGeometries_r(context, mp.get()));
+
+        const GEOSGeometry* p0 = GEOSGetGeometryN_r(context, mp.get(), 0);
+        REQUIRE(p0);
+        REQUIRE(2 == GEOSGetNumInteriorRings_r(context, p0));
+
+        const GEOSGeometry* p1 = GEOSGetGeometryN_r(context, mp.get(), 1);
+        REQUIRE(p1);
+        REQUIRE(0 == GEOSGetNumInteriorRings_r(context, p1));
+    }
+    GEOS_finish_r(context);
+}
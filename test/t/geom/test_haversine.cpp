@@ -0,0 +1,44 @@
+#include "catch.hpp"
+
+#include "wnl_helper.hpp"
+
+#include <osmium/geom/haversine.hpp>
+
+TEST_CASE("Haversine distance between coordinates") {
+    const osmium::geom::Coordinates c1{13.4, 52.5}; // Berlin
+    const osmium::geom::Coordinates c2{2.3, 48.9}; // Paris
+
+    REQUIRE(osmium::geom::haversine::distance(c1, c1) == Approx(0.0));
+    REQUIRE(osmium::geom::haversine::distance(c1, c2) == Approx(880000).epsilon(0.01));
+}
+
+TEST_CASE("Fast haversine distance matches exact distance for short segments") {
+    const osmium::geom::Coordinates c1{13.4000, 52.5000};
+    const osmium::geom::Coordinates c2{13.4100, 52.5050};
+
+    const double exact = osmium::geom::haversine::distance(c1, c2);
+    const double fast = osmium::geom::haversine::distance_fast(c1, c2);
+
+    REQUIRE(fast == Approx(exact).epsilon(0.0001));
+}
+
+TEST_CASE("Fast haversine distance falls back to exact formula for long segments") {
+    const osmium::geom::Coordinates c1{13.4, 52.5}; // Berlin
+    const osmium::geom::Coordinates c2{2.3, 48.9}; // Paris
+
+    const double exact = osmium::geom::haversine::distance(c1, c2);
+    const double fast = osmium::geom::haversine::distance_fast(c1, c2);
+
+    REQUIRE(fast == exact);
+}
+
+TEST_CASE("Haversine distance of way node list") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    const double exact = osmium::geom::haversine::distance(wnl);
+    const double fast = osmium::geom::haversine::distance_fast(wnl);
+
+    REQUIRE(exact > 0.0);
+    REQUIRE(fast == Approx(exact).epsilon(0.0001));
+}
@@ -2,6 +2,10 @@
 
 #include <osmium/geom/mercator_projection.hpp>
 
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
 TEST_CASE("Mercator projection") {
     const osmium::geom::MercatorProjection projection;
     REQUIRE(3857 == projection.epsg());
@@ -32,3 +36,61 @@ TEST_CASE("Mercator bounds") {
     REQUIRE(osmium::geom::detail::y_to_lat(osmium::geom::detail::lon_to_x(180.0)) == Approx(osmium::geom::MERCATOR_MAX_LAT).epsilon(0.0000001));
 }
 
+TEST_CASE("Batch mercator projection matches single projection") {
+    std::vector<osmium::geom::Coordinates> coordinates;
+    for (int n = 0; n < 1000; ++n) {
+        const double lon = -180.0 + n * 0.36;
+        const double lat = -osmium::geom::MERCATOR_MAX_LAT + n * 0.17;
+        coordinates.emplace_back(lon, lat);
+    }
+
+    std::vector<osmium::geom::Coordinates> batch{coordinates};
+    osmium::geom::lonlat_to_mercator(batch.data(), batch.size());
+
+    for (std::size_t n = 0; n < coordinates.size(); ++n) {
+        const auto single = osmium::geom::lonlat_to_mercator(coordinates[n]);
+        REQUIRE(batch[n].x == Approx(single.x).epsilon(0.0000000001));
+        REQUIRE(batch[n].y == Approx(single.y).epsilon(0.0000000001));
+    }
+}
+
+TEST_CASE("Batch mercator projection of empty and small arrays") {
+    osmium::geom::lonlat_to_mercator(nullptr, 0);
+
+    std::vector<osmium::geom::Coordinates> coordinates;
+    coordinates.emplace_back(17.839, -3.249);
+    osmium::geom::lonlat_to_mercator(coordinates.data(), coordinates.size());
+
+    const auto single = osmium::geom::lonlat_to_mercator(osmium::geom::Coordinates{17.839, -3.249});
+    REQUIRE(coordinates[0].x == Approx(single.x));
+    REQUIRE(coordinates[0].y == Approx(single.y));
+}
+
+TEST_CASE("Table-based inverse projection matches the exact formula") {
+    const osmium::geom::MercatorProjection exact;
+    const osmium::geom::MercatorProjection fast{osmium::geom::inverse_table::yes};
+
+    double max_error = 0.0;
+    for (int n = -20037; n <= 20037; ++n) {
+        const osmium::geom::Coordinates c{static_cast<double>(n) * 999.0, static_cast<double>(n) * 1000.0};
+        const osmium::geom::Coordinates re = exact.inverse(c);
+        const osmium::geom::Coordinates rf = fast.inverse(c);
+        REQUIRE(re.x == rf.x); // x uses the same formula in both modes
+        const double error = std::abs(re.y - rf.y);
+        if (error > max_error) {
+            max_error = error;
+        }
+    }
+
+    // documented maximum interpolation error: one nanodegree
+    REQUIRE(max_error < 1e-9);
+}
+
+TEST_CASE("Table-based inverse projection round-trips the forward projection") {
+    const osmium::geom::MercatorProjection fast{osmium::geom::inverse_table::yes};
+
+    const osmium::geom::Coordinates c{17.839, -3.249};
+    const osmium::geom::Coordinates r = fast.inverse(osmium::geom::lonlat_to_mercator(c));
+    REQUIRE(r.x == Approx(c.x).epsilon(0.000001));
+    REQUIRE(r.y == Approx(c.y).epsilon(0.000001));
+}
@@ -4,6 +4,9 @@
 #include <osmium/geom/mercator_projection.hpp>
 #include <osmium/geom/projection.hpp>
 
+#include <cstddef>
+#include <vector>
+
 TEST_CASE("Indentity Projection") {
     const osmium::geom::IdentityProjection projection;
     REQUIRE(4326 == projection.epsg());
@@ -74,6 +77,35 @@ TEST_CASE("Projection 3857") {
     }
 }
 
+TEST_CASE("Batch projection matches single projection") {
+    std::vector<osmium::geom::Coordinates> coordinates;
+    for (int n = -80; n <= 80; ++n) {
+        coordinates.emplace_back(static_cast<double>(n), static_cast<double>(n));
+    }
+
+    const auto check = [&](const osmium::geom::Projection& projection) {
+        std::vector<osmium::geom::Coordinates> batch{coordinates};
+        projection(batch.data(), batch.size());
+        for (std::size_t n = 0; n < coordinates.size(); ++n) {
+            const osmium::geom::Coordinates single = projection(osmium::Location{coordinates[n].x, coordinates[n].y});
+            REQUIRE(batch[n].x == Approx(single.x).epsilon(0.0000001));
+            REQUIRE(batch[n].y == Approx(single.y).epsilon(0.0000001));
+        }
+    };
+
+    SECTION("EPSG 4326") {
+        check(osmium::geom::Projection{4326});
+    }
+
+    SECTION("EPSG 3857") {
+        check(osmium::geom::Projection{3857});
+    }
+
+    SECTION("From proj string") {
+        check(osmium::geom::Projection{"+init=epsg:3857"});
+    }
+}
+
 TEST_CASE("MercatorProjection: Zero coordinates") {
     const osmium::geom::MercatorProjection projection;
     const osmium::Location loc{0.0, 0.0};
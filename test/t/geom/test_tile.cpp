@@ -6,6 +6,7 @@
 
 #include <cmath>
 #include <sstream>
+#include <vector>
 
 TEST_CASE("Helper functions") {
     REQUIRE(osmium::geom::num_tiles_in_zoom(0) == 1);
@@ -156,3 +157,62 @@ TEST_CASE("Invalid tiles") {
     REQUIRE_FALSE(tile.valid());
 }
 
+
+TEST_CASE("Parent, ancestor, and child tiles") {
+    const osmium::geom::Tile t{12, 1365, 2048};
+
+    const auto p = t.parent();
+    REQUIRE(p == osmium::geom::Tile{11, 682, 1024});
+
+    REQUIRE(t.ancestor(12) == t);
+    REQUIRE(t.ancestor(11) == p);
+    REQUIRE(t.ancestor(10) == osmium::geom::Tile{10, 341, 512});
+    REQUIRE(t.ancestor(0) == osmium::geom::Tile{0, 0, 0});
+
+    for (uint32_t n = 0; n < 4; ++n) {
+        const auto c = t.child(n);
+        REQUIRE(c.z == 13);
+        REQUIRE(c.valid());
+        REQUIRE(c.parent() == t);
+    }
+    REQUIRE(t.child(0) == osmium::geom::Tile{13, 2730, 4096});
+    REQUIRE(t.child(3) == osmium::geom::Tile{13, 2731, 4097});
+}
+
+TEST_CASE("Batch tile computation matches single tile computation") {
+    std::istringstream input_data{s};
+
+    std::vector<osmium::Location> locations;
+    std::vector<osmium::geom::Tile> expected;
+
+    while (input_data) {
+        double lon = NAN;
+        double lat = NAN;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t zoom = 0;
+
+        input_data >> lon;
+        input_data >> lat;
+        input_data >> x;
+        input_data >> y;
+        input_data >> zoom;
+
+        if (std::isnan(lon)) {
+            break;
+        }
+
+        // all locations at the same zoom level for the batch call
+        locations.emplace_back(lon, lat);
+        expected.emplace_back(15U, osmium::Location{lon, lat});
+    }
+
+    REQUIRE(locations.size() == 472);
+
+    std::vector<osmium::geom::Tile> tiles(locations.size(), osmium::geom::Tile{0, 0, 0});
+    osmium::geom::locations_to_tiles(15, locations.data(), locations.size(), tiles.data());
+
+    for (std::size_t i = 0; i < locations.size(); ++i) {
+        REQUIRE(tiles[i] == expected[i]);
+    }
+}
@@ -0,0 +1,129 @@
+#include "catch.hpp"
+
+#include <osmium/geom/tile_expiry.hpp>
+
+#include <cstdint>
+
+TEST_CASE("Morton encoding round trip") {
+    const osmium::geom::Tile t{14, 8529, 5974};
+
+    const uint64_t id = osmium::geom::detail::tile_to_morton(t);
+    const osmium::geom::Tile back = osmium::geom::detail::morton_to_tile(14, id);
+
+    REQUIRE(back == t);
+
+    // the parent tile id is the id shifted right by two bits
+    REQUIRE(osmium::geom::detail::morton_to_tile(13, id >> 2U) == t.parent());
+}
+
+TEST_CASE("Empty tile expiry set") {
+    const osmium::geom::TileExpirySet tiles{10, 14};
+
+    REQUIRE(tiles.min_zoom() == 10);
+    REQUIRE(tiles.max_zoom() == 14);
+    REQUIRE(tiles.empty());
+    REQUIRE(tiles.size(10) == 0);
+    REQUIRE(tiles.size(14) == 0);
+    REQUIRE(tiles.tiles(14).empty());
+}
+
+TEST_CASE("Adding a location adds the tile and its parents") {
+    osmium::geom::TileExpirySet tiles{10, 14};
+
+    const osmium::Location location{7.5, 53.3};
+    tiles.add(location);
+
+    REQUIRE_FALSE(tiles.empty());
+
+    osmium::geom::Tile t{14, location};
+    for (uint32_t zoom = 14; zoom >= 10; --zoom) {
+        REQUIRE(tiles.size(zoom) == 1);
+        REQUIRE(tiles.contains(t));
+        t = t.parent();
+    }
+
+    // adding the same location again does not change anything
+    tiles.add(location);
+    REQUIRE(tiles.size(14) == 1);
+    REQUIRE(tiles.size(10) == 1);
+}
+
+TEST_CASE("Tiles are deduplicated") {
+    osmium::geom::TileExpirySet tiles{0, 12};
+
+    // two locations in different z12 tiles but the same z10 tile
+    const osmium::Location a{7.50, 53.30};
+    const osmium::Location b{7.58, 53.30};
+    REQUIRE(osmium::geom::Tile{12, a} != osmium::geom::Tile{12, b});
+    REQUIRE(osmium::geom::Tile{10, a} == osmium::geom::Tile{10, b});
+
+    tiles.add(a);
+    tiles.add(b);
+
+    REQUIRE(tiles.size(12) == 2);
+    REQUIRE(tiles.size(10) == 1);
+    REQUIRE(tiles.size(0) == 1);
+
+    const auto list = tiles.tiles(12);
+    REQUIRE(list.size() == 2);
+    REQUIRE(list[0] != list[1]);
+}
+
+TEST_CASE("Adding a segment adds all tiles the segment passes through") {
+    osmium::geom::TileExpirySet tiles{12, 12};
+
+    const osmium::Location from{7.50, 53.30};
+    const osmium::Location to{7.58, 53.33};
+    tiles.add_segment(from, to);
+
+    // the end point tiles are in the set...
+    REQUIRE(tiles.contains(osmium::geom::Tile{12, from}));
+    REQUIRE(tiles.contains(osmium::geom::Tile{12, to}));
+
+    // ...and the tiles form a connected path: every tile has a
+    // neighbour (sharing at least a corner) in the set
+    const auto list = tiles.tiles(12);
+    REQUIRE(list.size() >= 2);
+    for (const auto& tile : list) {
+        bool has_neighbour = false;
+        for (const auto& other : list) {
+            if (tile != other &&
+                tile.x + 1 >= other.x && other.x + 1 >= tile.x &&
+                tile.y + 1 >= other.y && other.y + 1 >= tile.y) {
+                has_neighbour = true;
+                break;
+            }
+        }
+        REQUIRE(has_neighbour);
+    }
+}
+
+TEST_CASE("Vertical segment") {
+    osmium::geom::TileExpirySet tiles{14, 14};
+
+    const osmium::Location from{7.5, 53.30};
+    const osmium::Location to{7.5, 53.35};
+    tiles.add_segment(from, to);
+
+    const osmium::geom::Tile ft{14, from};
+    const osmium::geom::Tile tt{14, to};
+    REQUIRE(tiles.contains(ft));
+    REQUIRE(tiles.contains(tt));
+
+    // all tiles in the column between the end points are in the set
+    REQUIRE(ft.x == tt.x);
+    const auto from_y = tt.y < ft.y ? tt.y : ft.y;
+    const auto to_y = tt.y < ft.y ? ft.y : tt.y;
+    REQUIRE(tiles.size(14) == to_y - from_y + 1);
+}
+
+TEST_CASE("Clearing the tile expiry set") {
+    osmium::geom::TileExpirySet tiles{10, 14};
+
+    tiles.add(osmium::Location{7.5, 53.3});
+    REQUIRE_FALSE(tiles.empty());
+
+    tiles.clear();
+    REQUIRE(tiles.empty());
+    REQUIRE(tiles.size(14) == 0);
+}
@@ -1,11 +1,13 @@
 #include "catch.hpp"
 
+#include "area_helper.hpp"
 #include "wnl_helper.hpp"
 
 #include <osmium/geom/mercator_projection.hpp>
 #include <osmium/geom/wkb.hpp>
 #include <osmium/util/endian.hpp>
 
+#include <cstddef>
 #include <string>
 
 #if __BYTE_ORDER == __LITTLE_ENDIAN
@@ -146,3 +148,60 @@ TEST_CASE("WKB geometry (byte-order-independent) of empty linestring") {
     REQUIRE_THROWS_AS(factory.create_linestring(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward), osmium::geometry_error);
 }
 
+
+TEST_CASE("WKB geometry of trusted multipolygon matches the callback path") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& area = create_test_area_2outer_2inner(buffer);
+
+    osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex};
+    REQUIRE(factory.create_multipolygon_trusted(area) == factory.create_multipolygon(area));
+
+    osmium::geom::WKBFactory<> ewkb_factory{osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+    REQUIRE(ewkb_factory.create_multipolygon_trusted(area) == ewkb_factory.create_multipolygon(area));
+}
+
+TEST_CASE("WKB geometry of trusted multipolygon with one outer and one inner ring") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& area = create_test_area_1outer_1inner(buffer);
+
+    osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::binary};
+    REQUIRE(factory.create_multipolygon_trusted(area) == factory.create_multipolygon(area));
+}
+
+TEST_CASE("WKB buffer factory appends binary geometries to caller buffer") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+    const osmium::Location loc{3.2, 4.2};
+
+    osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::binary};
+
+    std::string out;
+    osmium::geom::WKBBufferFactory<> buffer_factory{out, osmium::geom::wkb_type::wkb};
+
+    const std::size_t point_size = buffer_factory.create_point(loc);
+    REQUIRE(out.size() == point_size);
+    REQUIRE(out == factory.create_point(loc));
+
+    const std::size_t linestring_size = buffer_factory.create_linestring(wnl);
+    REQUIRE(out.size() == point_size + linestring_size);
+    REQUIRE(out.substr(point_size) == factory.create_linestring(wnl));
+
+    out.clear();
+    const auto& closed_wnl = create_test_wnl_closed(buffer);
+    const std::size_t polygon_size = buffer_factory.create_polygon(closed_wnl);
+    REQUIRE(out.size() == polygon_size);
+    REQUIRE(out == factory.create_polygon(closed_wnl));
+}
+
+TEST_CASE("WKB buffer factory in EWKB mode") {
+    const osmium::Location loc{3.2, 4.2};
+
+    osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::ewkb, osmium::geom::out_type::binary};
+
+    std::string out;
+    osmium::geom::WKBBufferFactory<> buffer_factory{out, osmium::geom::wkb_type::ewkb};
+
+    const std::size_t point_size = buffer_factory.create_point(loc);
+    REQUIRE(point_size == out.size());
+    REQUIRE(out == factory.create_point(loc));
+}
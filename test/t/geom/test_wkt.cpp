@@ -33,6 +33,19 @@ TEST_CASE("WKT geometry for point in ekwt in web mercator") {
     REQUIRE(wkt == "SRID=3857;POINT(356222.37 467961.14)");
 }
 
+TEST_CASE("WKT geometry for trusted linestring in web mercator") {
+    osmium::geom::WKTFactory<osmium::geom::MercatorProjection> factory{2};
+
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    // The trusted fast path uses the batch projection interface, the
+    // result must be the same as with the checked path.
+    const std::string checked{factory.create_linestring(wnl)};
+    const std::string trusted{factory.create_linestring_trusted(wnl)};
+    REQUIRE(trusted == checked);
+}
+
 TEST_CASE("WKT geometry factory") {
     osmium::geom::WKTFactory<> factory;
 
@@ -62,6 +75,30 @@ TEST_CASE("WKT geometry factory") {
         }
     }
 
+    SECTION("trusted linestring") {
+        const auto& wnl = create_test_wnl_okay(buffer);
+
+        SECTION("unique forwards (default)") {
+            const std::string wkt{factory.create_linestring_trusted(wnl)};
+            REQUIRE(wkt == "LINESTRING(3.2 4.2,3.5 4.7,3.6 4.9)");
+        }
+
+        SECTION("unique backwards") {
+            const std::string wkt{factory.create_linestring_trusted(wnl, osmium::geom::use_nodes::unique, osmium::geom::direction::backward)};
+            REQUIRE(wkt == "LINESTRING(3.6 4.9,3.5 4.7,3.2 4.2)");
+        }
+
+        SECTION("all forwards") {
+            const std::string wkt{factory.create_linestring_trusted(wnl, osmium::geom::use_nodes::all)};
+            REQUIRE(wkt == "LINESTRING(3.2 4.2,3.5 4.7,3.5 4.7,3.6 4.9)");
+        }
+
+        SECTION("all backwards") {
+            const std::string wkt{factory.create_linestring_trusted(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward)};
+            REQUIRE(wkt == "LINESTRING(3.6 4.9,3.5 4.7,3.5 4.7,3.2 4.2)");
+        }
+    }
+
     SECTION("polygon") {
         const auto& wnl = create_test_wnl_closed(buffer);
 
@@ -93,6 +130,17 @@ TEST_CASE("WKT geometry factory") {
         REQUIRE_THROWS_AS(factory.create_linestring(wnl, osmium::geom::use_nodes::unique, osmium::geom::direction::backward), osmium::geometry_error);
         REQUIRE_THROWS_AS(factory.create_linestring(wnl, osmium::geom::use_nodes::all), osmium::geometry_error);
         REQUIRE_THROWS_AS(factory.create_linestring(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward), osmium::geometry_error);
+        REQUIRE_THROWS_AS(factory.create_linestring_trusted(wnl), osmium::geometry_error);
+        REQUIRE_THROWS_AS(factory.create_linestring_trusted(wnl, osmium::geom::use_nodes::all), osmium::geometry_error);
+    }
+
+    SECTION("trusted linestring with two same locations") {
+        const auto& wnl = create_test_wnl_same_location(buffer);
+
+        REQUIRE_THROWS_AS(factory.create_linestring_trusted(wnl), osmium::geometry_error);
+
+        const std::string wkt{factory.create_linestring_trusted(wnl, osmium::geom::use_nodes::all)};
+        REQUIRE(wkt == "LINESTRING(3.5 4.7,3.5 4.7)");
     }
 
     SECTION("linestring with two same locations") {
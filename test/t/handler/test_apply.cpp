@@ -2,6 +2,7 @@
 
 #include "utils.hpp"
 
+#include <osmium/builder/attr.hpp>
 #include <osmium/handler.hpp>
 #include <osmium/handler/node_locations_for_ways.hpp>
 #include <osmium/index/map/flex_mem.hpp>
@@ -55,6 +56,30 @@ TEST_CASE("apply with lambdas on reader") {
     REQUIRE(count_a == 0);
 }
 
+TEST_CASE("apply calls all handlers in order for each item") {
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_node(buffer, osmium::builder::attr::_id(1));
+    osmium::builder::add_node(buffer, osmium::builder::attr::_id(2));
+    osmium::builder::add_way(buffer, osmium::builder::attr::_id(3), osmium::builder::attr::_nodes({1, 2}));
+
+    // For every item each handler must be called before the next
+    // handler, even though the item type is only dispatched once.
+    std::string order;
+    osmium::apply(buffer,
+        [&](const osmium::Node& /*node*/) {
+            order += 'a';
+        },
+        [&](const osmium::Node& /*node*/) {
+            order += 'b';
+        },
+        [&](const osmium::Way& /*way*/) {
+            order += 'w';
+        }
+    );
+
+    REQUIRE(order == "ababw");
+}
+
 TEST_CASE("apply with lambda on buffer") {
     const osmium::io::File file{with_data_dir("t/relations/data.osm")};
     osmium::io::Reader reader{file};
@@ -127,3 +152,35 @@ TEST_CASE("apply with handler and lambda") {
     REQUIRE(y == 40000000);
 }
 
+TEST_CASE("node locations handler caches repeatedly referenced nodes") {
+    using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+    using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.1));
+    osmium::builder::add_node(buffer, _id(2), _location(2.0, 2.1));
+    osmium::builder::add_node(buffer, _id(3), _location(3.0, 3.1));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+    osmium::builder::add_way(buffer, _id(11), _nodes({2, 3})); // junction node 2 referenced again
+    osmium::builder::add_way(buffer, _id(12), _nodes({3, 1}));
+
+    index_type index;
+    location_handler_type location_handler{index};
+
+    int ways = 0;
+    osmium::apply(buffer, location_handler, [&](const osmium::Way& way) {
+        ++ways;
+        for (const auto& wn : way.nodes()) {
+            REQUIRE(wn.location().valid());
+            REQUIRE(wn.location() == location_handler.get_node_location(wn.ref()));
+        }
+    });
+    REQUIRE(ways == 3);
+
+    // Repeated lookups are answered from the cache and stay correct.
+    REQUIRE(location_handler.get_node_location(2) == osmium::Location(2.0, 2.1));
+    REQUIRE(location_handler.get_node_location(2) == osmium::Location(2.0, 2.1));
+}
+
@@ -0,0 +1,124 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/apply_pipeline.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include <stdexcept>
+
+namespace {
+
+    struct CountHandler : public osmium::handler::Handler {
+
+        int count_nodes = 0;
+        int count_ways = 0;
+        int count_relations = 0;
+        bool flushed = false;
+
+        void node(const osmium::Node& /*node*/) {
+            ++count_nodes;
+        }
+
+        void way(const osmium::Way& /*way*/) {
+            ++count_ways;
+        }
+
+        void relation(const osmium::Relation& /*relation*/) {
+            ++count_relations;
+        }
+
+        void flush() {
+            flushed = true;
+        }
+
+    }; // struct CountHandler
+
+    struct ThrowHandler : public osmium::handler::Handler {
+
+        void way(const osmium::Way& /*way*/) {
+            throw std::runtime_error{"way handler failed"};
+        }
+
+    }; // struct ThrowHandler
+
+    // Source yielding a fixed number of copies of one buffer.
+    struct TestSource {
+
+        osmium::memory::Buffer& buffer;
+        int remaining;
+
+        osmium::memory::Buffer read() {
+            if (remaining == 0) {
+                return osmium::memory::Buffer{};
+            }
+            --remaining;
+            osmium::memory::Buffer copy{buffer.committed()};
+            copy.add_buffer(buffer);
+            copy.commit();
+            return copy;
+        }
+
+    }; // struct TestSource
+
+} // anonymous namespace
+
+TEST_CASE("apply_pipelined with multiple handler stages on a reader") {
+    const osmium::io::File file{with_data_dir("t/relations/data.osm")};
+    osmium::io::Reader reader{file};
+
+    CountHandler handler1;
+    CountHandler handler2;
+    CountHandler handler3;
+
+    osmium::apply_pipelined(reader, handler1, handler2, handler3);
+
+    for (const auto* handler : {&handler1, &handler2, &handler3}) {
+        REQUIRE(handler->count_nodes == 5);
+        REQUIRE(handler->count_ways == 2);
+        REQUIRE(handler->count_relations == 3);
+        REQUIRE(handler->flushed);
+    }
+}
+
+TEST_CASE("apply_pipelined over many buffers") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_node(buffer, _id(1));
+    osmium::builder::add_way(buffer, _id(2));
+
+    TestSource source{buffer, 100};
+
+    CountHandler handler1;
+    CountHandler handler2;
+
+    osmium::apply_pipelined(source, handler1, handler2);
+
+    REQUIRE(handler1.count_nodes == 100);
+    REQUIRE(handler1.count_ways == 100);
+    REQUIRE(handler2.count_nodes == 100);
+    REQUIRE(handler2.count_ways == 100);
+}
+
+TEST_CASE("apply_pipelined rethrows a handler exception") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_node(buffer, _id(1));
+    osmium::builder::add_way(buffer, _id(2));
+
+    TestSource source{buffer, 100};
+
+    CountHandler counter;
+    ThrowHandler thrower;
+
+    REQUIRE_THROWS_WITH(osmium::apply_pipelined(source, counter, thrower),
+                        "way handler failed");
+
+    // the first stage saw all the data even though the second one failed
+    REQUIRE(counter.count_nodes == 100);
+}
@@ -126,3 +126,44 @@ TEST_CASE("CheckOrder handler: Ways after relations") {
     REQUIRE_THROWS_AS(osmium::apply(buffer, handler), osmium::out_of_order_error);
 }
 
+
+TEST_CASE("CheckOrder handler: buffer() checks a whole buffer at once") {
+    osmium::memory::Buffer buffer{1024};
+
+    REQUIRE(osmium::opl_parse("n1", buffer));
+    REQUIRE(osmium::opl_parse("n2", buffer));
+    REQUIRE(osmium::opl_parse("w1", buffer));
+    REQUIRE(osmium::opl_parse("r1", buffer));
+
+    osmium::handler::CheckOrder handler;
+    handler.buffer(buffer);
+    REQUIRE(handler.max_node_id()     == 2);
+    REQUIRE(handler.max_way_id()      == 1);
+    REQUIRE(handler.max_relation_id() == 1);
+}
+
+TEST_CASE("CheckOrder handler: buffer() finds objects out of order") {
+    osmium::memory::Buffer buffer{1024};
+
+    REQUIRE(osmium::opl_parse("n3", buffer));
+    REQUIRE(osmium::opl_parse("n2", buffer));
+
+    osmium::handler::CheckOrder handler;
+    REQUIRE_THROWS_AS(handler.buffer(buffer), osmium::out_of_order_error);
+}
+
+TEST_CASE("CheckOrder handler: buffer() with sampling checks only some objects") {
+    osmium::memory::Buffer buffer{1024};
+
+    REQUIRE(osmium::opl_parse("n10", buffer));
+    REQUIRE(osmium::opl_parse("n5", buffer)); // out of order, but not sampled
+    REQUIRE(osmium::opl_parse("n20", buffer));
+    REQUIRE(osmium::opl_parse("n2", buffer)); // out of order and sampled
+
+    osmium::handler::CheckOrder sampling_every_third{3};
+    REQUIRE_THROWS_AS(sampling_every_third.buffer(buffer), osmium::out_of_order_error);
+
+    osmium::handler::CheckOrder sampling_every_second{2};
+    sampling_every_second.buffer(buffer); // sees only n10 and n20
+    REQUIRE(sampling_every_second.max_node_id() == 20);
+}
@@ -0,0 +1,52 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/node_locations_update.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/visitor.hpp>
+
+using index_type = osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("Apply change data to node location index") {
+    index_type index;
+    index.set(1, osmium::Location{1.0, 1.0});
+    index.set(2, osmium::Location{2.0, 2.0});
+    index.set(3, osmium::Location{3.0, 3.0});
+
+    // node 2 is moved, node 3 is deleted, node 4 is new
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(2), _version(2), _location(2.5, 2.5));
+    osmium::builder::add_node(buffer, _id(3), _version(2), _deleted());
+    osmium::builder::add_node(buffer, _id(4), _version(1), _location(4.0, 4.0));
+
+    osmium::handler::NodeLocationsUpdate<index_type> updater{index};
+    osmium::apply(buffer, updater);
+
+    REQUIRE(updater.nodes_set() == 2);
+    REQUIRE(updater.nodes_deleted() == 1);
+
+    REQUIRE(index.get(1) == osmium::Location(1.0, 1.0));
+    REQUIRE(index.get(2) == osmium::Location(2.5, 2.5));
+    REQUIRE(index.get_noexcept(3) == osmium::Location{});
+    REQUIRE(index.get(4) == osmium::Location(4.0, 4.0));
+}
+
+TEST_CASE("Apply change data with negative ids to node location index") {
+    index_type index_pos;
+    index_type index_neg;
+
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(-17), _version(1), _location(1.5, 2.5));
+
+    osmium::handler::NodeLocationsUpdate<index_type, index_type> updater{index_pos, index_neg};
+    osmium::apply(buffer, updater);
+
+    REQUIRE(updater.nodes_set() == 1);
+    REQUIRE(index_pos.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(index_neg.get(17) == osmium::Location(1.5, 2.5));
+}
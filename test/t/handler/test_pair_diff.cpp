@@ -0,0 +1,118 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/pair_diff.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+/// Pair-diff handler that records all calls.
+class RecordingPairDiffHandler : public osmium::PairDiffHandler {
+
+    static std::string name(const osmium::OSMObject& object) {
+        return std::string{osmium::item_type_to_char(object.type())} + std::to_string(object.id());
+    }
+
+public:
+
+    std::vector<std::string> calls{};
+
+    void left_only(const osmium::OSMObject& object) {
+        calls.push_back("left " + name(object));
+    }
+
+    void right_only(const osmium::OSMObject& object) {
+        calls.push_back("right " + name(object));
+    }
+
+    void unchanged(const osmium::OSMObject& left, const osmium::OSMObject& right) {
+        REQUIRE(left.id() == right.id());
+        calls.push_back("unchanged " + name(left));
+    }
+
+    void changed(const osmium::OSMObject& left, const osmium::OSMObject& right) {
+        REQUIRE(left.id() == right.id());
+        calls.push_back("changed " + name(left));
+    }
+
+}; // class RecordingPairDiffHandler
+
+template <typename THandler>
+void pair_diff(osmium::memory::Buffer& left, osmium::memory::Buffer& right, THandler& handler) {
+    osmium::apply_pair_diff(left.begin<osmium::OSMObject>(), left.end<osmium::OSMObject>(),
+                            right.begin<osmium::OSMObject>(), right.end<osmium::OSMObject>(),
+                            handler);
+}
+
+} // anonymous namespace
+
+TEST_CASE("Pair diff of two object streams") {
+    osmium::memory::Buffer left{1024UL * 16UL};
+    osmium::builder::add_node(left, _id(1), _version(1));
+    osmium::builder::add_node(left, _id(2), _version(1), _tag("amenity", "post_box"));
+    osmium::builder::add_node(left, _id(3), _version(1));
+    osmium::builder::add_way(left, _id(3), _version(2), _nodes({1, 2, 3}));
+
+    osmium::memory::Buffer right{1024UL * 16UL};
+    osmium::builder::add_node(right, _id(1), _version(1));
+    osmium::builder::add_node(right, _id(2), _version(2), _tag("amenity", "recycling"));
+    osmium::builder::add_node(right, _id(4), _version(1));
+    osmium::builder::add_way(right, _id(3), _version(2), _nodes({1, 2, 3}));
+    osmium::builder::add_relation(right, _id(5), _version(1));
+
+    RecordingPairDiffHandler handler;
+    pair_diff(left, right, handler);
+
+    const std::vector<std::string> expected = {
+        "unchanged n1",
+        "changed n2",
+        "left n3",
+        "right n4",
+        "unchanged w3",
+        "right r5"
+    };
+    REQUIRE(handler.calls == expected);
+}
+
+TEST_CASE("Pair diff detects changes in any field") {
+    osmium::memory::Buffer left{1024UL * 16UL};
+    osmium::builder::add_node(left, _id(1), _version(2), _location(1.0, 2.0));
+    osmium::builder::add_node(left, _id(2), _version(1), _timestamp("2020-01-01T00:00:00Z"));
+
+    // Same versions, but the location of one node and the timestamp of
+    // the other have changed.
+    osmium::memory::Buffer right{1024UL * 16UL};
+    osmium::builder::add_node(right, _id(1), _version(2), _location(1.0, 2.5));
+    osmium::builder::add_node(right, _id(2), _version(1), _timestamp("2020-02-02T00:00:00Z"));
+
+    RecordingPairDiffHandler handler;
+    pair_diff(left, right, handler);
+
+    const std::vector<std::string> expected = {
+        "changed n1",
+        "changed n2"
+    };
+    REQUIRE(handler.calls == expected);
+}
+
+TEST_CASE("Pair diff with one empty input") {
+    osmium::memory::Buffer left{1024UL * 16UL};
+    osmium::memory::Buffer right{1024UL * 16UL};
+    osmium::builder::add_node(right, _id(1), _version(1));
+    osmium::builder::add_node(right, _id(2), _version(1));
+
+    RecordingPairDiffHandler handler;
+
+    pair_diff(left, right, handler);
+    REQUIRE(handler.calls == std::vector<std::string>{"right n1", "right n2"});
+
+    handler.calls.clear();
+    pair_diff(right, left, handler);
+    REQUIRE(handler.calls == std::vector<std::string>{"left n1", "left n2"});
+}
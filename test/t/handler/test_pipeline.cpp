@@ -0,0 +1,131 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/pipeline.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+    osmium::memory::Buffer make_node_buffer(const int id) {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+        osmium::memory::Buffer buffer{1024UL};
+        osmium::builder::add_node(buffer, _id(id));
+        return buffer;
+    }
+
+    // Source yielding buffers with a single node each, ids 1 to count.
+    struct TestSource {
+
+        int count;
+        int next = 1;
+
+        explicit TestSource(int c) : count(c) {
+        }
+
+        osmium::memory::Buffer operator()() {
+            if (next > count) {
+                return osmium::memory::Buffer{};
+            }
+            return make_node_buffer(next++);
+        }
+
+    }; // struct TestSource
+
+} // anonymous namespace
+
+TEST_CASE("Pipeline from a Reader into counting sink") {
+    osmium::io::Reader reader{with_data_dir("t/relations/data.osm")};
+
+    int objects = 0;
+    osmium::Pipeline pipeline;
+    pipeline.source([&]() { return reader.read(); })
+            .transform([](osmium::memory::Buffer&& buffer) {
+                return std::move(buffer);
+            })
+            .sink([&](osmium::memory::Buffer&& buffer) {
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    (void)object;
+                    ++objects;
+                }
+            });
+    pipeline.run();
+
+    REQUIRE(objects == 10);
+}
+
+TEST_CASE("Pipeline with parallel transform keeps buffer order") {
+    int expected_id = 1;
+    osmium::Pipeline pipeline;
+    pipeline.source(TestSource{100})
+            .transform([](osmium::memory::Buffer&& buffer) {
+                // uneven per-buffer work to shake up completion order
+                const auto& node = *buffer.select<osmium::Node>().begin();
+                std::this_thread::sleep_for(std::chrono::microseconds{
+                    (node.id() % 7) * 100});
+                return make_node_buffer(static_cast<int>(node.id() * 2));
+            }, 4)
+            .sink([&](osmium::memory::Buffer&& buffer) {
+                const auto& node = *buffer.select<osmium::Node>().begin();
+                REQUIRE(node.id() == expected_id * 2);
+                ++expected_id;
+            });
+    pipeline.run();
+
+    REQUIRE(expected_id == 101);
+}
+
+TEST_CASE("Pipeline rethrows exception from a transform") {
+    int seen = 0;
+    osmium::Pipeline pipeline;
+    pipeline.source(TestSource{1000})
+            .transform([](osmium::memory::Buffer&& buffer) {
+                const auto& node = *buffer.select<osmium::Node>().begin();
+                if (node.id() == 42) {
+                    throw std::runtime_error{"transform failed"};
+                }
+                return std::move(buffer);
+            }, 2)
+            .sink([&](osmium::memory::Buffer&& /*buffer*/) {
+                ++seen;
+            });
+
+    REQUIRE_THROWS_WITH(pipeline.run(), "transform failed");
+    REQUIRE(seen < 1000);
+}
+
+TEST_CASE("Pipeline rethrows exception from the sink") {
+    osmium::Pipeline pipeline;
+    pipeline.source(TestSource{1000})
+            .sink([](osmium::memory::Buffer&& /*buffer*/) {
+                throw std::runtime_error{"sink failed"};
+            });
+
+    REQUIRE_THROWS_WITH(pipeline.run(), "sink failed");
+}
+
+TEST_CASE("Pipeline without source or sink does not run") {
+    osmium::Pipeline pipeline;
+    REQUIRE_THROWS_AS(pipeline.run(), std::logic_error);
+
+    pipeline.source(TestSource{1});
+    REQUIRE_THROWS_AS(pipeline.run(), std::logic_error);
+}
+
+TEST_CASE("Pipeline runs only once") {
+    osmium::Pipeline pipeline;
+    pipeline.source(TestSource{1})
+            .sink([](osmium::memory::Buffer&& /*buffer*/) {});
+    pipeline.run();
+
+    REQUIRE_THROWS_AS(pipeline.run(), std::logic_error);
+}
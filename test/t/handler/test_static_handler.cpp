@@ -0,0 +1,141 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/static_handler.hpp>
+#include <osmium/visitor.hpp>
+
+namespace {
+
+struct CountHandler : public osmium::handler::Handler {
+
+    int& count;
+
+    explicit CountHandler(int& c) :
+        count(c) {
+    }
+
+    void node(const osmium::Node& /*node*/) noexcept {
+        ++count;
+    }
+
+    void way(const osmium::Way& /*way*/) noexcept {
+        ++count;
+    }
+
+    void relation(const osmium::Relation& /*relation*/) noexcept {
+        ++count;
+    }
+
+    void area(const osmium::Area& /*area*/) noexcept {
+        ++count;
+    }
+
+    void changeset(const osmium::Changeset& /*changeset*/) noexcept {
+        ++count;
+    }
+
+    void flush() noexcept {
+        ++count;
+    }
+
+};
+
+struct DoubleCountHandler : public osmium::handler::Handler {
+
+    int& count;
+
+    explicit DoubleCountHandler(int& c) :
+        count(c) {
+    }
+
+    void node(const osmium::Node& /*node*/) noexcept {
+        count += 2;
+    }
+
+    void way(const osmium::Way& /*way*/) noexcept {
+        count += 2;
+    }
+
+    void relation(const osmium::Relation& /*relation*/) noexcept {
+        count += 2;
+    }
+
+    void area(const osmium::Area& /*area*/) noexcept {
+        count += 2;
+    }
+
+    void changeset(const osmium::Changeset& /*changeset*/) noexcept {
+        count += 2;
+    }
+
+};
+
+osmium::memory::Buffer fill_buffer() {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+
+    osmium::builder::add_node(buffer, _id(1));
+    osmium::builder::add_way(buffer, _id(2));
+    osmium::builder::add_relation(buffer, _id(3));
+    osmium::builder::add_area(buffer, _id(4));
+    osmium::builder::add_changeset(buffer, _cid(5));
+
+    return buffer;
+}
+
+struct ApplyVisitor {
+
+    const osmium::memory::Buffer* buffer;
+
+    template <typename THandler>
+    void operator()(THandler& handler) const {
+        osmium::apply(*buffer, handler);
+    }
+
+};
+
+} // anonymous namespace
+
+TEST_CASE("Static handler") {
+    const auto buffer = fill_buffer();
+
+    osmium::handler::StaticHandler<CountHandler, DoubleCountHandler> handler;
+    REQUIRE_FALSE(handler.has_handler());
+    REQUIRE(handler.index() == 2);
+
+    // Without a selected handler apply() does nothing.
+    handler.apply(buffer);
+
+    int count = 0;
+    handler.set<CountHandler>(count);
+    REQUIRE(handler.has_handler());
+    REQUIRE(handler.index() == 0);
+    handler.apply(buffer);
+    REQUIRE(count == 6);
+
+    count = 0;
+    handler.set<DoubleCountHandler>(count);
+    REQUIRE(handler.index() == 1);
+    handler.apply(buffer);
+    REQUIRE(count == 10);
+
+    handler.reset();
+    REQUIRE_FALSE(handler.has_handler());
+    handler.apply(buffer);
+    REQUIRE(count == 10);
+}
+
+TEST_CASE("Static handler get and visit") {
+    const auto buffer = fill_buffer();
+
+    osmium::handler::StaticHandler<CountHandler, DoubleCountHandler> handler;
+
+    int count = 0;
+    auto& h = handler.set<CountHandler>(count);
+    REQUIRE(&h == &handler.get<CountHandler>());
+
+    // visit() hands the concrete handler to the visitor, so the visitor
+    // can run its own loop without any dispatch per object.
+    handler.visit(ApplyVisitor{&buffer});
+    REQUIRE(count == 6);
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/tag_stats.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace {
+
+    osmium::memory::Buffer make_tagged_buffer() {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+        osmium::memory::Buffer buffer{1024UL * 16UL, osmium::memory::Buffer::auto_grow::yes};
+        osmium::builder::add_node(buffer, _id(1), _tag("highway", "primary"), _tag("name", "High Street"));
+        osmium::builder::add_node(buffer, _id(2), _tag("highway", "primary"));
+        osmium::builder::add_way(buffer, _id(3), _tag("highway", "residential"), _tag("oneway", "yes"));
+
+        return buffer;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("TagStats counts keys and key/value combinations") {
+    const osmium::memory::Buffer buffer = make_tagged_buffer();
+
+    osmium::handler::TagStats stats;
+    osmium::apply(buffer, stats);
+
+    REQUIRE(stats.distinct_keys() == 3);
+    REQUIRE(stats.distinct_tags() == 4);
+
+    REQUIRE(stats.count("highway") == 3);
+    REQUIRE(stats.count("name") == 1);
+    REQUIRE(stats.count("oneway") == 1);
+    REQUIRE(stats.count("unknown") == 0);
+
+    REQUIRE(stats.count("highway", "primary") == 2);
+    REQUIRE(stats.count("highway", "residential") == 1);
+    REQUIRE(stats.count("highway", "secondary") == 0);
+
+    std::uint64_t sum = 0;
+    stats.for_each_key([&sum](const char* /*key*/, const std::uint64_t count) {
+        sum += count;
+    });
+    REQUIRE(sum == 5);
+
+    std::uint64_t highway_values = 0;
+    stats.for_each_tag([&highway_values](const char* key, const char* value, const std::uint64_t /*count*/) {
+        if (std::string{key} == "highway") {
+            REQUIRE((std::string{value} == "primary" || std::string{value} == "residential"));
+            ++highway_values;
+        }
+    });
+    REQUIRE(highway_values == 2);
+}
+
+TEST_CASE("TagStats merges per-thread results") {
+    const osmium::memory::Buffer buffer = make_tagged_buffer();
+
+    osmium::handler::TagStats stats1;
+    osmium::handler::TagStats stats2;
+    osmium::apply(buffer, stats1);
+    osmium::apply(buffer, stats2);
+
+    stats1.merge(stats2);
+
+    REQUIRE(stats1.distinct_keys() == 3);
+    REQUIRE(stats1.count("highway") == 6);
+    REQUIRE(stats1.count("highway", "primary") == 4);
+    REQUIRE(stats2.count("highway") == 3); // the merged-from handler is unchanged
+}
+
+TEST_CASE("TagStats with many distinct tags") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::handler::TagStats stats;
+
+    // enough distinct keys to force the tables to grow several times
+    for (int i = 0; i < 5000; ++i) {
+        osmium::memory::Buffer buffer{1024UL};
+        const std::string key = "key" + std::to_string(i);
+        osmium::builder::add_node(buffer, _id(i + 1), _tag(key.c_str(), "value"));
+        osmium::apply(buffer, stats);
+    }
+
+    REQUIRE(stats.distinct_keys() == 5000);
+    REQUIRE(stats.distinct_tags() == 5000);
+    REQUIRE(stats.count("key0") == 1);
+    REQUIRE(stats.count("key4999", "value") == 1);
+}
@@ -0,0 +1,121 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/transform.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // Source yielding buffers with a single node each, ids 1 to count.
+    struct TestSource {
+
+        int count;
+        int next = 1;
+
+        explicit TestSource(int c) : count(c) {
+        }
+
+        osmium::memory::Buffer read() {
+            using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+            if (next > count) {
+                return osmium::memory::Buffer{};
+            }
+            osmium::memory::Buffer buffer{1024UL};
+            osmium::builder::add_node(buffer, _id(next++));
+            return buffer;
+        }
+
+    }; // struct TestSource
+
+    // Sink collecting the ids of all objects it receives.
+    struct TestSink {
+
+        std::vector<osmium::object_id_type> ids{};
+
+        void operator()(osmium::memory::Buffer&& buffer) {
+            for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                ids.push_back(object.id());
+            }
+        }
+
+    }; // struct TestSink
+
+} // anonymous namespace
+
+TEST_CASE("transform_buffer applies a per-object function") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= 10; ++i) {
+        osmium::builder::add_node(buffer, _id(i));
+    }
+
+    // drop odd ids, shift even ones
+    const auto result = osmium::transform_buffer(std::move(buffer),
+        [](const osmium::OSMObject& object, osmium::memory::Buffer& out) {
+            if (object.id() % 2 == 0) {
+                osmium::builder::add_node(out, _id(object.id() + 100));
+            }
+        });
+
+    std::vector<osmium::object_id_type> ids;
+    for (const auto& object : result.select<osmium::OSMObject>()) {
+        ids.push_back(object.id());
+    }
+    REQUIRE(ids == std::vector<osmium::object_id_type>{102, 104, 106, 108, 110});
+}
+
+TEST_CASE("transform_parallel preserves input order") {
+    TestSource source{500};
+    TestSink sink;
+
+    osmium::transform_parallel(source, sink,
+        [](const osmium::OSMObject& object, osmium::memory::Buffer& out) {
+            using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+            osmium::builder::add_node(out, _id(object.id() * 2));
+        }, 4);
+
+    REQUIRE(sink.ids.size() == 500);
+    for (std::size_t i = 0; i < sink.ids.size(); ++i) {
+        REQUIRE(sink.ids[i] == static_cast<osmium::object_id_type>((i + 1) * 2));
+    }
+}
+
+TEST_CASE("transform_parallel copies unmodified objects") {
+    osmium::io::Reader reader{with_data_dir("t/relations/data.osm")};
+    TestSink sink;
+
+    osmium::transform_parallel(reader, sink,
+        [](const osmium::OSMObject& object, osmium::memory::Buffer& out) {
+            out.add_item(object);
+            out.commit();
+        });
+    reader.close();
+
+    REQUIRE(sink.ids.size() == 10);
+}
+
+TEST_CASE("transform_parallel rethrows an exception from the function") {
+    TestSource source{100};
+    TestSink sink;
+
+    REQUIRE_THROWS_WITH(osmium::transform_parallel(source, sink,
+        [](const osmium::OSMObject& object, osmium::memory::Buffer& out) {
+            if (object.id() == 42) {
+                throw std::runtime_error{"transform failed"};
+            }
+            out.add_item(object);
+            out.commit();
+        }, 2), "transform failed");
+}
@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include <osmium/index/checkpoint.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+
+using dense_mem_array = osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+using sparse_mem_array = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+using checkpoint_index = osmium::index::map::CheckpointIndex<osmium::unsigned_object_id_type, osmium::Location>;
+
+TEST_CASE("Checkpoint with array layout") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    const osmium::Location loc1{1.2, 4.5};
+    const osmium::Location loc2{3.5, -7.2};
+
+    dense_mem_array index;
+    index.set(3, loc1);
+    index.set(12, loc2);
+
+    osmium::index::write_checkpoint(index, fd, osmium::index::checkpoint_layout::array);
+
+    checkpoint_index file_index{fd};
+    REQUIRE(file_index.layout() == osmium::index::checkpoint_layout::array);
+    REQUIRE(file_index.size() == 13);
+
+    REQUIRE(file_index.get(3) == loc1);
+    REQUIRE(file_index.get(12) == loc2);
+    REQUIRE_THROWS_AS(file_index.get(5), osmium::not_found);
+    REQUIRE_THROWS_AS(file_index.get(200), osmium::not_found);
+    REQUIRE(file_index.get_noexcept(200) == osmium::Location{});
+
+    REQUIRE_THROWS(file_index.set(1, loc1));
+}
+
+TEST_CASE("Checkpoint with list layout") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    const osmium::Location loc1{1.2, 4.5};
+    const osmium::Location loc2{3.5, -7.2};
+    const osmium::Location loc3{-12.7, 14.5};
+
+    sparse_mem_array index;
+    index.set(12, loc1);
+    index.set(3, loc2);
+    index.set(700000, loc3);
+    index.sort();
+
+    osmium::index::write_checkpoint(index, fd, osmium::index::checkpoint_layout::list);
+
+    checkpoint_index file_index{fd};
+    REQUIRE(file_index.layout() == osmium::index::checkpoint_layout::list);
+    REQUIRE(file_index.size() == 3);
+
+    REQUIRE(file_index.get(12) == loc1);
+    REQUIRE(file_index.get(3) == loc2);
+    REQUIRE(file_index.get(700000) == loc3);
+    REQUIRE_THROWS_AS(file_index.get(5), osmium::not_found);
+    REQUIRE_THROWS_AS(file_index.get(700001), osmium::not_found);
+}
+
+TEST_CASE("Checkpoint with wrong magic can not be opened") {
+    const int fd = osmium::detail::create_tmp_file();
+    osmium::io::detail::reliable_write(fd, "this is not a checkpoint file...", 32);
+
+    REQUIRE_THROWS_AS(checkpoint_index{fd}, osmium::checkpoint_error);
+}
+
+TEST_CASE("Checkpoint that is too short can not be opened") {
+    const int fd = osmium::detail::create_tmp_file();
+    osmium::io::detail::reliable_write(fd, "OSMIDXCP", 8);
+
+    REQUIRE_THROWS_AS(checkpoint_index{fd}, osmium::checkpoint_error);
+}
+
+TEST_CASE("Checkpoint written with different value type can not be opened") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, std::uint32_t> index;
+    index.set(2, 17);
+    osmium::index::write_checkpoint(index, fd, osmium::index::checkpoint_layout::array);
+
+    REQUIRE_THROWS_AS(checkpoint_index{fd}, osmium::checkpoint_error);
+}
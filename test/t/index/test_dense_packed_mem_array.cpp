@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/dense_packed_mem_array.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <stdexcept>
+
+using packed_map = osmium::index::map::DensePackedMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+TEST_CASE("Packed array stores and retrieves locations") {
+    packed_map map;
+
+    const osmium::Location loc1{1.2, 3.4};
+    const osmium::Location loc2{5.6, 7.8};
+    map.set(17, loc1);
+    map.set(18, loc2);
+
+    REQUIRE(map.get(17) == loc1);
+    REQUIRE(map.get(18) == loc2);
+    REQUIRE(map.get_noexcept(17) == loc1);
+
+    REQUIRE_THROWS_AS(map.get(1000), osmium::not_found);
+    REQUIRE_FALSE(map.get_noexcept(1000).valid());
+
+    map.clear();
+    REQUIRE(map.size() == 0);
+}
+
+TEST_CASE("Packed array covering the whole world is lossless") {
+    packed_map map;
+    REQUIRE(map.entry_bits() == 64);
+
+    const osmium::Location corner1{-180.0, -90.0};
+    const osmium::Location corner2{180.0, 90.0};
+    map.set(1, corner1);
+    map.set(2, corner2);
+    map.set(3, osmium::Location{-0.0000001, 0.0000001});
+
+    REQUIRE(map.get(1) == corner1);
+    REQUIRE(map.get(2) == corner2);
+    REQUIRE(map.get(3) == osmium::Location{-0.0000001, 0.0000001});
+}
+
+TEST_CASE("Packed array with bounding box uses fewer bits per entry") {
+    const osmium::Box box{7.0, 47.0, 11.0, 50.0};
+    packed_map map{box};
+    REQUIRE(map.entry_bits() == 52);
+
+    // entries straddle word boundaries, check a run long enough to
+    // hit all alignments (downwards, so storage is sized only once)
+    for (osmium::unsigned_object_id_type id = 200; id > 0; id -= 2) {
+        map.set(id - 2, osmium::Location{7.0 + (id - 2) * 0.01, 47.0 + (id - 2) * 0.01});
+    }
+    for (osmium::unsigned_object_id_type id = 0; id < 200; ++id) {
+        if (id % 2 == 0) {
+            REQUIRE(map.get(id) == osmium::Location{7.0 + id * 0.01, 47.0 + id * 0.01});
+        } else {
+            REQUIRE_FALSE(map.get_noexcept(id).valid());
+        }
+    }
+
+    REQUIRE(map.used_memory() < 200 * 8);
+}
+
+TEST_CASE("Packed array rejects locations outside its bounding box") {
+    packed_map map{osmium::Box{7.0, 47.0, 11.0, 50.0}};
+
+    REQUIRE_THROWS_AS(map.set(1, osmium::Location{20.0, 48.0}), std::out_of_range);
+    REQUIRE_THROWS_AS(map.set(1, osmium::Location{8.0, 46.0}), std::out_of_range);
+
+    // the empty value can always be stored
+    map.set(1, osmium::Location{});
+    REQUIRE_FALSE(map.get_noexcept(1).valid());
+}
+
+TEST_CASE("Packed array overwrites entries in place") {
+    packed_map map{osmium::Box{7.0, 47.0, 11.0, 50.0}};
+
+    map.set(5, osmium::Location{8.0, 48.0});
+    map.set(6, osmium::Location{9.0, 49.0});
+    map.set(5, osmium::Location{10.0, 47.5});
+
+    REQUIRE(map.get(5) == osmium::Location{10.0, 47.5});
+    REQUIRE(map.get(6) == osmium::Location{9.0, 49.0});
+}
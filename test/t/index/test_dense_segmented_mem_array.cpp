@@ -0,0 +1,69 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/dense_segmented_mem_array.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+using segmented_map = osmium::index::map::DenseSegmentedMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+TEST_CASE("Segmented array stores and retrieves locations") {
+    segmented_map map;
+
+    const osmium::Location loc1{1.2, 3.4};
+    const osmium::Location loc2{5.6, 7.8};
+    map.set(17, loc1);
+    map.set(18, loc2);
+
+    REQUIRE(map.get(17) == loc1);
+    REQUIRE(map.get(18) == loc2);
+    REQUIRE(map.get_noexcept(17) == loc1);
+
+    REQUIRE_THROWS_AS(map.get(1000), osmium::not_found);
+    REQUIRE_FALSE(map.get_noexcept(1000).valid());
+
+    map.clear();
+    REQUIRE(map.size() == 0);
+}
+
+TEST_CASE("Segmented array tolerates huge ids far apart") {
+    segmented_map map;
+
+    const osmium::Location loc1{1.2, 3.4};
+    const osmium::Location loc2{5.6, 7.8};
+    const osmium::Location loc3{9.1, 2.3};
+
+    // an id like the synthetic area ids (2 * relation id + 1) make of
+    // a large relation id
+    const osmium::unsigned_object_id_type huge_id = 2 * 17179869184ULL + 1;
+
+    map.set(3, loc1);
+    map.set(huge_id, loc2);
+    map.set(huge_id - 1, loc3);
+
+    REQUIRE(map.get(3) == loc1);
+    REQUIRE(map.get(huge_id) == loc2);
+    REQUIRE(map.get(huge_id - 1) == loc3);
+    REQUIRE_FALSE(map.get_noexcept(huge_id + 1).valid());
+    REQUIRE_FALSE(map.get_noexcept(huge_id / 2).valid());
+
+    // memory is proportional to the touched segments, not to the
+    // largest id
+    REQUIRE(map.used_memory() < 64UL * 1024UL * 1024UL);
+}
+
+TEST_CASE("Segmented array handles ids within one segment densely") {
+    segmented_map map;
+
+    for (osmium::unsigned_object_id_type id = 100; id < 1100; ++id) {
+        map.set(id, osmium::Location{static_cast<int32_t>(id), static_cast<int32_t>(id)});
+    }
+
+    REQUIRE(map.size() >= 1000);
+    for (osmium::unsigned_object_id_type id = 100; id < 1100; ++id) {
+        REQUIRE(map.get(id).x() == static_cast<int32_t>(id));
+    }
+    REQUIRE_FALSE(map.get_noexcept(1100).valid());
+
+    map.set(105, osmium::Location{1.0, 2.0});
+    REQUIRE(map.get(105) == osmium::Location{1.0, 2.0});
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/external_sort.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    // Output iterator collecting the ids of the objects assigned to it.
+    struct id_collector {
+
+        using iterator_category = std::output_iterator_tag;
+        using value_type = void;
+        using difference_type = void;
+        using pointer = void;
+        using reference = void;
+
+        std::vector<osmium::object_id_type>* ids;
+
+        id_collector& operator*() noexcept {
+            return *this;
+        }
+
+        id_collector& operator++() noexcept {
+            return *this;
+        }
+
+        id_collector operator++(int) noexcept { // NOLINT(cert-dcl21-cpp)
+            return *this;
+        }
+
+        id_collector& operator=(const osmium::OSMObject& object) {
+            ids->push_back(object.id());
+            return *this;
+        }
+
+    }; // struct id_collector
+
+    osmium::memory::Buffer make_node_buffer(const std::vector<osmium::object_id_type>& ids) {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+        osmium::memory::Buffer buffer{1024UL * 16UL, osmium::memory::Buffer::auto_grow::yes};
+        for (const auto id : ids) {
+            osmium::builder::add_node(buffer, _id(id), _tag("some_key", "some_value"));
+        }
+        return buffer;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("ExternalSorter sorts in memory when everything fits") {
+    osmium::ExternalSorter<> sorter;
+    sorter.add(make_node_buffer({5, 3, 9}));
+    sorter.add(make_node_buffer({1, 8, 2}));
+    REQUIRE(sorter.runs() == 0);
+
+    std::vector<osmium::object_id_type> ids;
+    sorter.sort(id_collector{&ids});
+
+    REQUIRE(sorter.runs() == 0);
+    REQUIRE(ids == std::vector<osmium::object_id_type>{1, 2, 3, 5, 8, 9});
+}
+
+TEST_CASE("ExternalSorter merges spilled runs") {
+    // a memory limit of one byte spills every buffer as its own run
+    osmium::ExternalSorter<> sorter{1};
+    sorter.add(make_node_buffer({5, 30, 90, 101}));
+    sorter.add(make_node_buffer({1, 80, 102}));
+    sorter.add(make_node_buffer({2, 40, 50, 60, 70}));
+    REQUIRE(sorter.runs() == 3);
+
+    std::vector<osmium::object_id_type> ids;
+    sorter.sort(id_collector{&ids});
+
+    REQUIRE(ids == std::vector<osmium::object_id_type>{1, 2, 5, 30, 40, 50, 60, 70, 80, 90, 101, 102});
+}
+
+TEST_CASE("ExternalSorter with many objects per run") {
+    osmium::ExternalSorter<> sorter{64UL * 1024UL};
+
+    // descending ids so nothing is accidentally in order already
+    std::vector<osmium::object_id_type> ids;
+    for (osmium::object_id_type id = 2000; id > 0; id -= 2) {
+        ids.push_back(id);
+    }
+    sorter.add(make_node_buffer(ids));
+    for (osmium::object_id_type id = 1999; id > 0; id -= 2) {
+        ids.assign(1, id);
+        sorter.add(make_node_buffer(ids));
+    }
+    REQUIRE(sorter.runs() > 1);
+
+    std::vector<osmium::object_id_type> sorted_ids;
+    sorter.sort(id_collector{&sorted_ids});
+
+    REQUIRE(sorted_ids.size() == 2000);
+    for (std::size_t i = 0; i < sorted_ids.size(); ++i) {
+        REQUIRE(sorted_ids[i] == static_cast<osmium::object_id_type>(i + 1));
+    }
+}
+
+TEST_CASE("ExternalSorter orders versions of the same object") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1), _version(3));
+    osmium::builder::add_node(buffer, _id(1), _version(1));
+    osmium::builder::add_node(buffer, _id(1), _version(2));
+
+    osmium::ExternalSorter<> sorter{1};
+    sorter.add(std::move(buffer));
+
+    std::vector<osmium::object_id_type> ids;
+    std::vector<osmium::object_version_type> versions;
+    struct version_collector : id_collector {
+        std::vector<osmium::object_version_type>* versions;
+        version_collector& operator=(const osmium::OSMObject& object) {
+            ids->push_back(object.id());
+            versions->push_back(object.version());
+            return *this;
+        }
+        version_collector& operator*() noexcept { return *this; }
+        version_collector& operator++() noexcept { return *this; }
+        version_collector operator++(int) noexcept { return *this; } // NOLINT(cert-dcl21-cpp)
+    };
+    version_collector out{};
+    out.ids = &ids;
+    out.versions = &versions;
+    sorter.sort(out);
+
+    REQUIRE(ids == std::vector<osmium::object_id_type>{1, 1, 1});
+    REQUIRE(versions == std::vector<osmium::object_version_type>{1, 2, 3});
+}
@@ -2,6 +2,7 @@
 
 #include <osmium/index/detail/tmpfile.hpp>
 #include <osmium/index/map/dense_file_array.hpp>
+#include <osmium/index/map/dense_file_cache_array.hpp>
 #include <osmium/index/map/sparse_file_array.hpp>
 #include <osmium/index/node_locations_map.hpp>
 #include <osmium/osm/location.hpp>
@@ -89,6 +90,32 @@ TEST_CASE("File based dense index") {
     }
 }
 
+TEST_CASE("File based dense index with prefault and advice") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    const osmium::unsigned_object_id_type id = 17;
+    const osmium::Location loc{1.2, 4.5};
+
+    using index_type = osmium::index::map::DenseFileArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    {
+        index_type index{fd};
+        index.set(id, loc);
+    }
+
+    {
+        const index_type index{fd};
+
+        // warm up the index in one sequential pass, then tell the
+        // kernel we will do random lookups
+        index.prefault();
+        index.advise(osmium::util::memory_advice::random);
+
+        REQUIRE(loc == index.get(id));
+        REQUIRE_THROWS_AS(index.get(1), osmium::not_found);
+    }
+}
+
 TEST_CASE("File based sparse index") {
     const int fd = osmium::detail::create_tmp_file();
 
@@ -158,3 +185,75 @@ TEST_CASE("File based sparse index") {
     }
 }
 
+
+TEST_CASE("File based dense index with block cache") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    using index_type = osmium::index::map::DenseFileCacheArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    // small cache (two blocks of 8k entries each) so evictions happen
+    const std::size_t block_entries = (64UL * 1024UL) / sizeof(osmium::Location);
+    const std::size_t num_ids = 5 * block_entries;
+
+    {
+        index_type index{fd, false, 2};
+
+        REQUIRE(index.size() == 0);
+        REQUIRE_THROWS_AS(index.get(0), osmium::not_found);
+        REQUIRE(index.get_noexcept(0) == osmium::Location{});
+
+        // write in a stride that keeps bouncing between blocks
+        osmium::unsigned_object_id_type max_id = 0;
+        for (osmium::unsigned_object_id_type id = 1; id < num_ids; id += 1000) {
+            index.set(id, osmium::Location{int32_t(id), int32_t(id)});
+            max_id = id;
+        }
+
+        REQUIRE(index.size() == max_id + 1);
+
+        for (osmium::unsigned_object_id_type id = 1; id < num_ids; id += 1000) {
+            REQUIRE(index.get(id) == osmium::Location{int32_t(id), int32_t(id)});
+        }
+
+        // ids in the holes between the blocks read as "not found"
+        REQUIRE_THROWS_AS(index.get(2), osmium::not_found);
+        REQUIRE_THROWS_AS(index.get(block_entries + 2), osmium::not_found);
+        REQUIRE(index.get_noexcept(2) == osmium::Location{});
+
+        index.flush();
+    }
+
+    {
+        // reopening the file sees all data written before
+        const index_type index{fd, false, 2};
+
+        REQUIRE(index.size() >= num_ids - 999);
+
+        for (osmium::unsigned_object_id_type id = 1; id < num_ids; id += 1000) {
+            REQUIRE(index.get(id) == osmium::Location{int32_t(id), int32_t(id)});
+        }
+        REQUIRE_THROWS_AS(index.get(2), osmium::not_found);
+    }
+}
+
+TEST_CASE("File based dense index with block cache and direct I/O") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    using index_type = osmium::index::map::DenseFileCacheArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    // O_DIRECT is best effort, so this works even where it is unsupported
+    index_type index{fd, true, 2};
+
+    const osmium::Location loc1{1.2, 4.5};
+    const osmium::Location loc2{3.5, -7.2};
+
+    index.set(6, loc1);
+    index.set(100000, loc2);
+
+    REQUIRE(index.get(6) == loc1);
+    REQUIRE(index.get(100000) == loc2);
+    REQUIRE_THROWS_AS(index.get(7), osmium::not_found);
+
+    index.flush();
+    REQUIRE(index.get(6) == loc1);
+}
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/index/id_remap.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <iterator>
+
+TEST_CASE("IdRemap assigns sequential ids and compresses runs") {
+    osmium::index::IdRemap map;
+    REQUIRE(map.empty());
+
+    REQUIRE(map.add(100) == 1);
+    REQUIRE(map.add(101) == 2);
+    REQUIRE(map.add(102) == 3);
+    REQUIRE(map.add(500) == 4);
+    REQUIRE(map.add(501) == 5);
+
+    REQUIRE(map.size() == 5);
+    REQUIRE_FALSE(map.empty());
+
+    REQUIRE(map.get(100) == 1);
+    REQUIRE(map.get(102) == 3);
+    REQUIRE(map.get(500) == 4);
+    REQUIRE(map.get(501) == 5);
+
+    REQUIRE(map.get_noexcept(99) == 0);
+    REQUIRE(map.get_noexcept(103) == 0);
+    REQUIRE(map.get_noexcept(502) == 0);
+    REQUIRE_THROWS_AS(map.get(42), osmium::not_found);
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.get_noexcept(100) == 0);
+}
+
+TEST_CASE("IdRemap handles ids added out of order") {
+    osmium::index::IdRemap map;
+
+    REQUIRE(map.add(10) == 1);
+    REQUIRE(map.add(20) == 2);
+    REQUIRE(map.add(15) == 3); // out of order, goes to the side table
+    REQUIRE(map.add(21) == 4);
+
+    REQUIRE(map.get(10) == 1);
+    REQUIRE(map.get(15) == 3);
+    REQUIRE(map.get(20) == 2);
+    REQUIRE(map.get(21) == 4);
+
+    REQUIRE(map.add_or_get(15) == 3);
+    REQUIRE(map.add_or_get(30) == 5);
+    REQUIRE(map.add_or_get(30) == 5);
+}
+
+TEST_CASE("IdRemapper renumbers objects and references in a buffer") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_node(buffer, _id(100));
+    osmium::builder::add_node(buffer, _id(200));
+    osmium::builder::add_node(buffer, _id(300));
+    osmium::builder::add_way(buffer, _id(1000), _nodes({100, 200, 300}));
+    osmium::builder::add_relation(buffer, _id(5000),
+                                  _member(osmium::item_type::way, 1000, "outer"),
+                                  _member(osmium::item_type::node, 200, ""));
+
+    osmium::index::IdRemapper remapper;
+    remapper.remap(buffer);
+
+    auto it = buffer.cbegin<osmium::OSMObject>();
+    REQUIRE(it->id() == 1);
+    ++it;
+    REQUIRE(it->id() == 2);
+    ++it;
+    REQUIRE(it->id() == 3);
+    ++it;
+
+    const auto& way = static_cast<const osmium::Way&>(*it);
+    REQUIRE(way.id() == 1);
+    REQUIRE(way.nodes()[0].ref() == 1);
+    REQUIRE(way.nodes()[1].ref() == 2);
+    REQUIRE(way.nodes()[2].ref() == 3);
+    ++it;
+
+    const auto& relation = static_cast<const osmium::Relation&>(*it);
+    REQUIRE(relation.id() == 1);
+    auto member = relation.members().cbegin();
+    REQUIRE(member->type() == osmium::item_type::way);
+    REQUIRE(member->ref() == 1);
+    ++member;
+    REQUIRE(member->type() == osmium::item_type::node);
+    REQUIRE(member->ref() == 2);
+
+    REQUIRE(remapper.index(osmium::item_type::node).size() == 3);
+    REQUIRE(remapper.index(osmium::item_type::way).size() == 1);
+    REQUIRE(remapper.index(osmium::item_type::relation).size() == 1);
+}
+
+TEST_CASE("IdRemapper assigns ids to references never seen as objects") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_node(buffer, _id(100));
+    // references node 50 which is not in the data
+    osmium::builder::add_way(buffer, _id(1000), _nodes({100, 50}));
+
+    osmium::index::IdRemapper remapper;
+    remapper.remap(buffer);
+
+    const auto& way = static_cast<const osmium::Way&>(*std::next(buffer.cbegin<osmium::OSMObject>()));
+    REQUIRE(way.nodes()[0].ref() == 1);
+    REQUIRE(way.nodes()[1].ref() == 2);
+    REQUIRE(remapper.index(osmium::item_type::node).size() == 2);
+}
@@ -3,6 +3,9 @@
 #include <osmium/index/id_set.hpp>
 #include <osmium/osm/types.hpp>
 
+#include <algorithm>
+#include <vector>
+
 TEST_CASE("Basic functionality of IdSetDense") {
     osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
 
@@ -121,6 +124,75 @@ TEST_CASE("Test with larger Ids") {
     }
 }
 
+TEST_CASE("Iterating over IdSetDense with many random Ids") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
+    std::vector<osmium::unsigned_object_id_type> ids;
+
+    // Pseudo-random Ids spreading over several words and chunks.
+    osmium::unsigned_object_id_type id = 17;
+    for (int i = 0; i < 10000; ++i) {
+        ids.push_back(id);
+        s.set(id);
+        id += 1 + (id * 2654435761UL) % 50000;
+    }
+
+    REQUIRE(s.size() == ids.size());
+    REQUIRE(std::equal(s.begin(), s.end(), ids.cbegin()));
+}
+
+TEST_CASE("IdSetDense for_each_in_range") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
+    s.set(7);
+    s.set(35);
+    s.set(20);
+    s.set(1ULL << 33U);
+    s.set(21);
+    s.set((1ULL << 27U) + 13U);
+
+    std::vector<osmium::unsigned_object_id_type> ids;
+    const auto collect = [&ids](osmium::unsigned_object_id_type id) {
+        ids.push_back(id);
+    };
+
+    s.for_each_in_range(0, 1ULL << 34U, collect);
+    REQUIRE(ids == std::vector<osmium::unsigned_object_id_type>{7, 20, 21, 35, (1ULL << 27U) + 13U, 1ULL << 33U});
+
+    // range ends are inclusive/exclusive
+    ids.clear();
+    s.for_each_in_range(20, 36, collect);
+    REQUIRE(ids == std::vector<osmium::unsigned_object_id_type>{20, 21, 35});
+
+    ids.clear();
+    s.for_each_in_range(21, 35, collect);
+    REQUIRE(ids == std::vector<osmium::unsigned_object_id_type>{21});
+
+    // empty range and range beyond all Ids in the set
+    ids.clear();
+    s.for_each_in_range(22, 22, collect);
+    REQUIRE(ids.empty());
+
+    s.for_each_in_range((1ULL << 33U) + 1U, 1ULL << 40U, collect);
+    REQUIRE(ids.empty());
+}
+
+TEST_CASE("IdSetDense for_each_in_range visits the same Ids as the iterator") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
+
+    osmium::unsigned_object_id_type id = 3;
+    for (int i = 0; i < 1000; ++i) {
+        s.set(id);
+        id += 1 + (id * 31U) % 1000;
+    }
+
+    std::vector<osmium::unsigned_object_id_type> ids;
+    s.for_each_in_range(0, id, [&ids](osmium::unsigned_object_id_type value) {
+        ids.push_back(value);
+    });
+
+    REQUIRE(ids.size() == s.size());
+    REQUIRE(std::equal(s.begin(), s.end(), ids.cbegin()));
+}
+
 TEST_CASE("Large gap") {
     osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
 
@@ -252,3 +324,204 @@ TEST_CASE("Merge two IdSetSmall") {
     REQUIRE(std::equal(s1.cbegin(), s1.cend(), ids.begin()));
 }
 
+TEST_CASE("K-way merge of several IdSetSmall") {
+    using id_set = osmium::index::IdSetSmall<osmium::unsigned_object_id_type>;
+    id_set s1;
+    id_set s2;
+    id_set s3;
+
+    s1.set(23);
+    s1.set(2);
+    s1.set(7);
+
+    s2.set(2);
+    s2.set(32);
+    s2.set(8);
+
+    s3.set(7);
+    s3.set(8);
+    s3.set(55);
+
+    s1.sort_unique();
+    s2.sort_unique();
+    s3.sort_unique();
+
+    const std::vector<const id_set*> sets{&s1, &s2, &s3};
+
+    SECTION("into an output iterator") {
+        std::vector<osmium::unsigned_object_id_type> result;
+        osmium::index::merge_sorted(sets, std::back_inserter(result));
+
+        const auto ids = {2, 7, 8, 23, 32, 55};
+        REQUIRE(result.size() == 6);
+        REQUIRE(std::equal(result.cbegin(), result.cend(), ids.begin()));
+    }
+
+    SECTION("restricted to an Id range") {
+        std::vector<osmium::unsigned_object_id_type> result;
+        osmium::index::merge_sorted(sets, std::back_inserter(result),
+                                    osmium::unsigned_object_id_type{7},
+                                    osmium::unsigned_object_id_type{32});
+
+        const auto ids = {7, 8, 23};
+        REQUIRE(result.size() == 3);
+        REQUIRE(std::equal(result.cbegin(), result.cend(), ids.begin()));
+    }
+
+    SECTION("into an IdSetDense") {
+        osmium::index::IdSetDense<osmium::unsigned_object_id_type> result;
+        osmium::index::merge_sorted(sets, result);
+
+        REQUIRE(result.size() == 6);
+        REQUIRE(result.get(2));
+        REQUIRE(result.get(55));
+        REQUIRE_FALSE(result.get(1));
+        REQUIRE_FALSE(result.get(42));
+    }
+}
+
+TEST_CASE("K-way merge of empty input") {
+    using id_set = osmium::index::IdSetSmall<osmium::unsigned_object_id_type>;
+    const id_set s1;
+    const id_set s2;
+
+    std::vector<osmium::unsigned_object_id_type> result;
+
+    osmium::index::merge_sorted(std::vector<const id_set*>{}, std::back_inserter(result));
+    REQUIRE(result.empty());
+
+    osmium::index::merge_sorted(std::vector<const id_set*>{&s1, &s2}, std::back_inserter(result));
+    REQUIRE(result.empty());
+}
+
+TEST_CASE("Parallel merge of IdSetSmall gives the same result as the sequential merge") {
+    using id_set = osmium::index::IdSetSmall<osmium::unsigned_object_id_type>;
+    std::vector<id_set> sets(8);
+
+    for (std::size_t n = 0; n < sets.size(); ++n) {
+        for (osmium::unsigned_object_id_type id = n; id < 10000; id += 2 * n + 3) {
+            sets[n].set(id);
+        }
+        sets[n].sort_unique();
+    }
+
+    std::vector<const id_set*> set_ptrs;
+    for (const auto& set : sets) {
+        set_ptrs.push_back(&set);
+    }
+
+    std::vector<osmium::unsigned_object_id_type> expected;
+    osmium::index::merge_sorted(set_ptrs, std::back_inserter(expected));
+
+    osmium::thread::Pool pool{4};
+    const auto result = osmium::index::merge_sorted(set_ptrs, pool);
+
+    REQUIRE(result.size() == expected.size());
+    REQUIRE(std::equal(result.cbegin(), result.cend(), expected.cbegin()));
+}
+
+
+TEST_CASE("Basic functionality of ExternalIdSet") {
+    osmium::index::ExternalIdSet<osmium::unsigned_object_id_type> s;
+
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.size() == 0); // NOLINT(readability-container-size-empty)
+
+    s.set(17);
+    REQUIRE_FALSE(s.empty());
+    REQUIRE(s.get(17));
+    REQUIRE_FALSE(s.get(16));
+    REQUIRE_FALSE(s.get(18));
+    REQUIRE(s.size() == 1);
+
+    s.set(17);
+    REQUIRE(s.size() == 1);
+
+    REQUIRE(s.check_and_set(28));
+    REQUIRE_FALSE(s.check_and_set(28));
+    REQUIRE(s.get(28));
+    REQUIRE(s.size() == 2);
+
+    // Ids in different chunks, more chunks than cache slots.
+    for (osmium::unsigned_object_id_type n = 0; n < 20; ++n) {
+        s.set(n * (1ULL << 22U) + 3);
+    }
+    REQUIRE(s.size() == 22);
+    for (osmium::unsigned_object_id_type n = 0; n < 20; ++n) {
+        REQUIRE(s.get(n * (1ULL << 22U) + 3));
+        REQUIRE_FALSE(s.get(n * (1ULL << 22U) + 4));
+    }
+    REQUIRE(s.get(17));
+    REQUIRE(s.get(28));
+
+    s.clear();
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.get(17));
+}
+
+TEST_CASE("ExternalIdSet gives the same answers as IdSetDense") {
+    osmium::index::ExternalIdSet<osmium::unsigned_object_id_type> external{std::size_t{2}};
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> dense;
+
+    for (osmium::unsigned_object_id_type id = 1; id < 100000; id += 37) {
+        external.set(id * 200);
+        dense.set(id * 200);
+    }
+
+    for (osmium::unsigned_object_id_type id = 1; id < 100000; id += 613) {
+        REQUIRE(external.get(id) == dense.get(id));
+        REQUIRE(external.get(id * 200) == dense.get(id * 200));
+    }
+}
+
+TEST_CASE("Basic functionality of IdSetWithFilter") {
+    osmium::index::IdSetWithFilter<osmium::unsigned_object_id_type> s;
+
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE_FALSE(s.get(28));
+
+    s.set(17);
+    REQUIRE_FALSE(s.empty());
+    REQUIRE(s.get(17));
+    REQUIRE_FALSE(s.get(28));
+    REQUIRE(s.id_set().get(17));
+
+    s.set(28);
+    REQUIRE(s.get(17));
+    REQUIRE(s.get(28));
+
+    s.clear();
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE_FALSE(s.get(28));
+}
+
+TEST_CASE("IdSetWithFilter gives the same answers as the wrapped set") {
+    osmium::index::IdSetWithFilter<osmium::unsigned_object_id_type> filtered;
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> plain;
+
+    for (osmium::unsigned_object_id_type id = 1; id < 20000; id += 3) {
+        filtered.set(id);
+        plain.set(id);
+    }
+
+    for (osmium::unsigned_object_id_type id = 1; id < 30000; ++id) {
+        REQUIRE(filtered.get(id) == plain.get(id));
+    }
+}
+
+TEST_CASE("IdSetWithFilter wrapping an IdSetSmall") {
+    osmium::index::IdSetWithFilter<osmium::unsigned_object_id_type,
+                                   osmium::index::IdSetSmall<osmium::unsigned_object_id_type>> s;
+
+    s.set(23);
+    s.set(42);
+
+    REQUIRE(s.get(23));
+    REQUIRE(s.get(42));
+    REQUIRE_FALSE(s.get(7));
+
+    REQUIRE(s.used_memory() > 0);
+}
@@ -74,6 +74,15 @@ void test_func_real(TIndex& index) {
     REQUIRE(index.get_noexcept(5) == osmium::Location{});
     REQUIRE(index.get_noexcept(100) == osmium::Location{});
 
+    const osmium::unsigned_object_id_type batch_ids[] = {0, id2, 5, id1, 100};
+    osmium::Location batch_locations[5];
+    index.get_batch(batch_ids, 5, batch_locations);
+    REQUIRE(batch_locations[0] == osmium::Location{});
+    REQUIRE(batch_locations[1] == loc2);
+    REQUIRE(batch_locations[2] == osmium::Location{});
+    REQUIRE(batch_locations[3] == loc1);
+    REQUIRE(batch_locations[4] == osmium::Location{});
+
     index.clear();
 
     REQUIRE_THROWS_AS(index.get(id1), osmium::not_found);
@@ -234,6 +243,71 @@ TEST_CASE("Map Id to location: FlexMem switch") {
     REQUIRE(index.get_noexcept(2000000000) == osmium::Location{});
 }
 
+TEST_CASE("Map Id to location: FlexMem snapshot stays valid across switch") {
+    using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
+    const osmium::Location loc1{1.1, 1.2};
+    const osmium::Location loc2{2.2, -9.4};
+    const osmium::Location loc3{3.3, 7.5};
+
+    index_type index;
+
+    index.set(17, loc1);
+    index.set(99, loc2);
+
+    const auto snap = index.get_snapshot();
+
+    // the index keeps working normally after taking the snapshot
+    index.set(5, loc3);
+    REQUIRE(index.size() == 3);
+    REQUIRE(index.get_noexcept(5) == loc3);
+    REQUIRE(index.get_noexcept(17) == loc1);
+    REQUIRE(index.get_noexcept(99) == loc2);
+
+    REQUIRE(snap.size() == 2);
+    REQUIRE(snap.get_noexcept(17) == loc1);
+    REQUIRE(snap.get_noexcept(99) == loc2);
+    REQUIRE(snap.get_noexcept(5) == osmium::Location{}); // set after the snapshot
+    REQUIRE_THROWS_AS(snap.get(5), osmium::not_found);
+
+    index.switch_to_dense();
+    REQUIRE(index.is_dense());
+    REQUIRE(index.get_noexcept(5) == loc3);
+    REQUIRE(index.get_noexcept(17) == loc1);
+    REQUIRE(index.get_noexcept(99) == loc2);
+
+    // the snapshot pins the old sparse data across the switch
+    REQUIRE(snap.get_noexcept(17) == loc1);
+    REQUIRE(snap.get_noexcept(99) == loc2);
+    REQUIRE(snap.get_noexcept(5) == osmium::Location{});
+}
+
+TEST_CASE("Map Id to location: FlexMem with memory limit") {
+    using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index{true};
+
+    // Allow only two dense blocks in memory, everything else is spilled
+    // to a temporary file.
+    index.set_memory_limit(2 * (1ULL << 16U) * sizeof(osmium::Location));
+
+    const osmium::unsigned_object_id_type stride = 1ULL << 16U;
+    for (osmium::unsigned_object_id_type id = 0; id < 10 * stride; id += stride / 4) {
+        index.set(id, osmium::Location{static_cast<int32_t>(id % 1000000), 1});
+    }
+
+    REQUIRE(index.spilled_blocks() >= 8);
+
+    for (osmium::unsigned_object_id_type id = 0; id < 10 * stride; id += stride / 4) {
+        REQUIRE(index.get(id) == osmium::Location(static_cast<int32_t>(id % 1000000), 1));
+        REQUIRE(index.get_noexcept(id + 1) == osmium::Location{});
+    }
+
+    index.clear();
+    REQUIRE(index.spilled_blocks() == 0);
+    REQUIRE(index.get_noexcept(0) == osmium::Location{});
+}
+
 TEST_CASE("Map Id to location: Dynamic map choice") {
     using map_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
     const auto& map_factory = osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>::instance();
@@ -257,3 +331,67 @@ TEST_CASE("Map Id to location: Dynamic map choice") {
     }
 }
 
+#ifdef __linux__
+TEST_CASE("Map Id to location: DenseMmapArray with huge pages") {
+    using map_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
+    const auto& map_factory = osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>::instance();
+
+    REQUIRE_THROWS_AS(map_factory.create_map("dense_mmap_array,unknown_option"), osmium::map_factory_error);
+
+    for (const char* config : {"dense_mmap_array,hugepages", "dense_mmap_array,hugetlb"}) {
+        std::unique_ptr<map_type> index = map_factory.create_map(config);
+        index->reserve(1000);
+        test_func_all<map_type>(*index);
+    }
+}
+#endif
+
+
+template <typename TIndex>
+void test_func_batch(TIndex& index) {
+    const osmium::unsigned_object_id_type num_ids = 100;
+
+    for (osmium::unsigned_object_id_type id = 1; id <= num_ids; id += 2) {
+        index.set(id, osmium::Location{int32_t(id), int32_t(id)});
+    }
+
+    index.sort();
+
+    // batch larger than the internal lane/prefetch width
+    std::vector<osmium::unsigned_object_id_type> ids;
+    for (osmium::unsigned_object_id_type id = 0; id <= num_ids; ++id) {
+        ids.push_back(id);
+    }
+
+    std::vector<osmium::Location> locations(ids.size());
+    index.get_batch(ids.data(), ids.size(), locations.data());
+
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] % 2 == 1) {
+            REQUIRE(locations[i] == osmium::Location{int32_t(ids[i]), int32_t(ids[i])});
+        } else {
+            REQUIRE(locations[i] == osmium::Location{});
+        }
+    }
+
+    // empty batch is okay
+    index.get_batch(ids.data(), 0, locations.data());
+}
+
+TEST_CASE("Batch lookup in dense index") {
+    osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    test_func_batch(index);
+}
+
+TEST_CASE("Batch lookup in sparse index") {
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    test_func_batch(index);
+
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> empty_index;
+    const osmium::unsigned_object_id_type ids[] = {1, 2, 3};
+    osmium::Location locations[3];
+    empty_index.get_batch(ids, 3, locations);
+    REQUIRE(locations[0] == osmium::Location{});
+    REQUIRE(locations[1] == osmium::Location{});
+    REQUIRE(locations[2] == osmium::Location{});
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include <osmium/index/multimap/hybrid.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <vector>
+
+using hybrid_map = osmium::index::multimap::Hybrid<osmium::unsigned_object_id_type, std::size_t>;
+
+static std::vector<std::size_t> all_values(hybrid_map& map, osmium::unsigned_object_id_type id) {
+    std::vector<std::size_t> values;
+    auto r = map.get_all(id);
+    for (; r.first != r.second; ++r.first) {
+        values.push_back(r.first->second);
+    }
+    return values;
+}
+
+TEST_CASE("Hybrid multimap: synchronous consolidate") {
+    hybrid_map map;
+
+    map.unsorted_set(3, 30);
+    map.unsorted_set(1, 10);
+    map.sort();
+
+    map.set(1, 11);
+    map.set(2, 20);
+
+    REQUIRE(map.size() == 4);
+    REQUIRE(all_values(map, 1) == std::vector<std::size_t>{10, 11});
+
+    map.consolidate();
+
+    REQUIRE(map.size() == 4);
+    REQUIRE(all_values(map, 1) == std::vector<std::size_t>{10, 11});
+    REQUIRE(all_values(map, 2) == std::vector<std::size_t>{20});
+    REQUIRE(all_values(map, 3) == std::vector<std::size_t>{30});
+}
+
+TEST_CASE("Hybrid multimap: asynchronous consolidate") {
+    osmium::thread::Pool pool{2};
+    hybrid_map map;
+
+    map.unsorted_set(3, 30);
+    map.unsorted_set(1, 10);
+    map.sort();
+
+    map.set(1, 11);
+    map.set(2, 20);
+
+    map.consolidate(pool);
+
+    // While the background task runs, queries see the old main map
+    // merged with the entries being consolidated.
+    REQUIRE(map.size() == 4);
+    REQUIRE(all_values(map, 1) == std::vector<std::size_t>{10, 11});
+    REQUIRE(all_values(map, 2) == std::vector<std::size_t>{20});
+
+    // New entries during the consolidation go to the extra map.
+    map.set(4, 40);
+    REQUIRE(all_values(map, 4) == std::vector<std::size_t>{40});
+
+    map.finish_consolidation();
+
+    REQUIRE(map.size() == 5);
+    REQUIRE(all_values(map, 1) == std::vector<std::size_t>{10, 11});
+    REQUIRE(all_values(map, 2) == std::vector<std::size_t>{20});
+    REQUIRE(all_values(map, 3) == std::vector<std::size_t>{30});
+    REQUIRE(all_values(map, 4) == std::vector<std::size_t>{40});
+}
+
+TEST_CASE("Hybrid multimap: remove while asynchronous consolidate gives the same result as synchronous remove") {
+    osmium::thread::Pool pool{2};
+    hybrid_map sync_map;
+    hybrid_map async_map;
+
+    for (hybrid_map* map : {&sync_map, &async_map}) {
+        map->unsorted_set(1, 10);
+        map->unsorted_set(1, 11);
+        map->sort();
+    }
+
+    sync_map.remove(1, 10);
+    sync_map.consolidate();
+
+    async_map.consolidate(pool);
+    async_map.remove(1, 10);
+    async_map.finish_consolidation();
+    async_map.consolidate();
+
+    REQUIRE(all_values(sync_map, 1) == all_values(async_map, 1));
+}
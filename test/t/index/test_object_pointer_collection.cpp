@@ -82,3 +82,37 @@ TEST_CASE("Create ObjectPointerCollection") {
     REQUIRE(collection.empty());
 }
 
+TEST_CASE("Parallel sort of ObjectPointerCollection") {
+    constexpr const std::size_t num_nodes = 200000;
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+
+    // Pseudo-random ids with duplicates so the stability of the sort
+    // matters.
+    std::size_t id = 12345;
+    for (std::size_t n = 0; n < num_nodes; ++n) {
+        id = (id * 1103515245UL + 12345UL) % 10000UL;
+        osmium::builder::add_node(buffer,
+            _id(static_cast<osmium::object_id_type>(id + 1)),
+            _version(static_cast<osmium::object_version_type>(n + 1))
+        );
+    }
+
+    osmium::ObjectPointerCollection collection;
+    osmium::apply(buffer, collection);
+    REQUIRE(collection.size() == num_nodes);
+
+    osmium::ObjectPointerCollection reference;
+    osmium::apply(buffer, reference);
+    reference.sort(osmium::object_order_type_id_version{});
+
+    osmium::thread::Pool pool;
+    collection.sort(osmium::object_order_type_id_version{}, pool);
+
+    auto it = collection.cbegin();
+    for (auto ref = reference.cbegin(); ref != reference.cend(); ++ref, ++it) {
+        REQUIRE(it->id() == ref->id());
+        REQUIRE(it->version() == ref->version());
+    }
+    REQUIRE(it == collection.cend());
+}
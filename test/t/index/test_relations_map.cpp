@@ -1,8 +1,10 @@
 #include "catch.hpp"
 
 #include <osmium/index/relations_map.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <type_traits>
+#include <vector>
 
 static_assert(!std::is_default_constructible<osmium::index::RelationsMapIndex>::value, "RelationsMapIndex should not be default constructible");
 static_assert(!std::is_copy_constructible<osmium::index::RelationsMapIndex>::value, "RelationsMapIndex should not be copy constructible");
@@ -105,3 +107,126 @@ TEST_CASE("RelationsMapStash both indexes") {
     REQUIRE(count == 2);
 }
 
+TEST_CASE("RelationsMapStash with thread pool gives the same result") {
+    osmium::thread::Pool pool{2};
+
+    osmium::index::RelationsMapStash stash;
+    osmium::index::RelationsMapStash stash_parallel;
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 1000; ++id) {
+        stash.add(id, id + 1);
+        stash.add(id, id + 2);
+        stash_parallel.add(id, id + 1);
+        stash_parallel.add(id, id + 2);
+    }
+
+    const auto index = stash.build_indexes();
+    const auto index_parallel = stash_parallel.build_indexes(pool);
+
+    REQUIRE(index.size() == index_parallel.size());
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 1000; ++id) {
+        std::vector<osmium::unsigned_object_id_type> expected;
+        index.member_to_parent().for_each(id, [&](osmium::unsigned_object_id_type pid) {
+            expected.push_back(pid);
+        });
+
+        std::vector<osmium::unsigned_object_id_type> actual;
+        index_parallel.member_to_parent().for_each(id, [&](osmium::unsigned_object_id_type pid) {
+            actual.push_back(pid);
+        });
+
+        REQUIRE(expected == actual);
+    }
+}
+
+
+TEST_CASE("RelationsMapStash ancestors index resolves nested hierarchies") {
+    osmium::index::RelationsMapStash stash;
+
+    // 1 is member of 2, 2 is member of 3 and 4, 4 is member of 5
+    stash.add(1, 2);
+    stash.add(2, 3);
+    stash.add(2, 4);
+    stash.add(4, 5);
+
+    const auto index = stash.build_member_to_ancestors_index();
+
+    std::vector<osmium::unsigned_object_id_type> ancestors;
+    index.for_each(1, [&](osmium::unsigned_object_id_type id) {
+        ancestors.push_back(id);
+    });
+    REQUIRE(ancestors == std::vector<osmium::unsigned_object_id_type>{2, 3, 4, 5});
+
+    ancestors.clear();
+    index.for_each(4, [&](osmium::unsigned_object_id_type id) {
+        ancestors.push_back(id);
+    });
+    REQUIRE(ancestors == std::vector<osmium::unsigned_object_id_type>{5});
+
+    ancestors.clear();
+    index.for_each(5, [&](osmium::unsigned_object_id_type id) {
+        ancestors.push_back(id);
+    });
+    REQUIRE(ancestors.empty());
+}
+
+TEST_CASE("RelationsMapStash ancestors index handles cycles") {
+    osmium::index::RelationsMapStash stash;
+
+    // 2 and 3 contain each other, 1 is member of 2
+    stash.add(1, 2);
+    stash.add(2, 3);
+    stash.add(3, 2);
+
+    const auto index = stash.build_member_to_ancestors_index();
+
+    std::vector<osmium::unsigned_object_id_type> ancestors;
+    index.for_each(1, [&](osmium::unsigned_object_id_type id) {
+        ancestors.push_back(id);
+    });
+    REQUIRE(ancestors == std::vector<osmium::unsigned_object_id_type>{2, 3});
+
+    // a relation in a cycle is not its own ancestor
+    ancestors.clear();
+    index.for_each(2, [&](osmium::unsigned_object_id_type id) {
+        ancestors.push_back(id);
+    });
+    REQUIRE(ancestors == std::vector<osmium::unsigned_object_id_type>{3});
+}
+
+TEST_CASE("RelationsMapStash ancestors index with thread pool gives the same result") {
+    osmium::thread::Pool pool{2};
+
+    osmium::index::RelationsMapStash stash;
+    osmium::index::RelationsMapStash stash_parallel;
+
+    // long chains of nested relations with some cross links
+    for (osmium::unsigned_object_id_type id = 1; id <= 1000; ++id) {
+        stash.add(id, id + 1);
+        stash_parallel.add(id, id + 1);
+        if (id % 10 == 0) {
+            stash.add(id, id + 13);
+            stash_parallel.add(id, id + 13);
+        }
+    }
+
+    const auto index = stash.build_member_to_ancestors_index();
+    const auto index_parallel = stash_parallel.build_member_to_ancestors_index(pool);
+
+    REQUIRE(index.size() == index_parallel.size());
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 1000; ++id) {
+        std::vector<osmium::unsigned_object_id_type> expected;
+        index.for_each(id, [&](osmium::unsigned_object_id_type aid) {
+            expected.push_back(aid);
+        });
+
+        std::vector<osmium::unsigned_object_id_type> actual;
+        index_parallel.for_each(id, [&](osmium::unsigned_object_id_type aid) {
+            actual.push_back(aid);
+        });
+
+        REQUIRE(expected == actual);
+    }
+}
@@ -0,0 +1,77 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/replicated_mem_array.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <thread>
+#include <vector>
+
+using replicated_map = osmium::index::map::ReplicatedMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+TEST_CASE("Replicated array stores and retrieves locations") {
+    replicated_map map{2};
+    REQUIRE(map.num_replicas() == 2);
+
+    const osmium::Location loc1{1.2, 3.4};
+    const osmium::Location loc2{5.6, 7.8};
+    map.set(17, loc1);
+    map.set(18, loc2);
+
+    REQUIRE(map.get(17) == loc1);
+    REQUIRE(map.get(18) == loc2);
+    REQUIRE(map.get_noexcept(17) == loc1);
+
+    REQUIRE_THROWS_AS(map.get(1000), osmium::not_found);
+    REQUIRE_FALSE(map.get_noexcept(1000).valid());
+
+    map.clear();
+    REQUIRE(map.size() == 0);
+}
+
+TEST_CASE("Replicated array sees writes made after the first reads") {
+    replicated_map map{2};
+
+    const osmium::Location loc1{1.2, 3.4};
+    const osmium::Location loc2{5.6, 7.8};
+    map.set(17, loc1);
+    REQUIRE(map.get(17) == loc1);
+
+    // This write invalidates the replicas created by the read above.
+    map.set(18, loc2);
+    REQUIRE(map.get(17) == loc1);
+    REQUIRE(map.get(18) == loc2);
+}
+
+TEST_CASE("Replicated array can be read from multiple threads") {
+    replicated_map map{4};
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 1000; ++id) {
+        map.set(id, osmium::Location{static_cast<int32_t>(id), static_cast<int32_t>(id)});
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<int> errors(8, 0);
+    threads.reserve(errors.size());
+    for (auto& error_count : errors) {
+        threads.emplace_back([&map, &error_count]() {
+            for (osmium::unsigned_object_id_type id = 1; id <= 1000; ++id) {
+                const auto location = map.get_noexcept(id);
+                if (location.x() != static_cast<int32_t>(id)) {
+                    ++error_count;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto error_count : errors) {
+        REQUIRE(error_count == 0);
+    }
+
+    // At least the replica of the main thread has been built by now.
+    map.get_noexcept(1);
+    REQUIRE(map.used_memory() > map.size() * sizeof(osmium::Location));
+}
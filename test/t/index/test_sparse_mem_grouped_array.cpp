@@ -0,0 +1,64 @@
+#include "catch.hpp"
+
+#include <osmium/index/multimap/sparse_mem_grouped_array.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+using grouped_array = osmium::index::multimap::SparseMemGroupedArray<osmium::unsigned_object_id_type, std::size_t>;
+
+TEST_CASE("Grouped multimap: empty") {
+    grouped_array map;
+    map.sort();
+
+    REQUIRE(map.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(map.group_count() == 0);
+
+    const auto r = map.get_all(17);
+    REQUIRE(r.first == r.second);
+}
+
+TEST_CASE("Grouped multimap: values are grouped by key") {
+    grouped_array map;
+    map.set(17, 23);
+    map.set(3, 42);
+    map.set(17, 24);
+    map.set(99, 1);
+    map.set(17, 22);
+
+    map.sort();
+
+    REQUIRE(map.size() == 5);
+    REQUIRE(map.group_count() == 3);
+
+    const auto r = map.get_all(17);
+    const std::vector<std::size_t> values{r.first, r.second};
+    REQUIRE(values == std::vector<std::size_t>{22, 23, 24});
+
+    const auto single = map.get_all(3);
+    REQUIRE(std::distance(single.first, single.second) == 1);
+    REQUIRE(*single.first == 42);
+
+    const auto missing = map.get_all(5);
+    REQUIRE(missing.first == missing.second);
+}
+
+TEST_CASE("Grouped multimap: set after sort needs another sort") {
+    grouped_array map;
+    map.set(1, 100);
+    map.sort();
+    REQUIRE(map.group_count() == 1);
+
+    map.set(1, 101);
+    map.set(2, 200);
+    map.sort();
+
+    REQUIRE(map.size() == 3);
+    REQUIRE(map.group_count() == 2);
+
+    const auto r = map.get_all(1);
+    const std::vector<std::size_t> values{r.first, r.second};
+    REQUIRE(values == std::vector<std::size_t>{100, 101});
+}
@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/sparse_mem_robin_hood.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+using robin_hood_map = osmium::index::map::SparseMemRobinHood<osmium::unsigned_object_id_type, osmium::Location>;
+
+TEST_CASE("Robin hood map stores and retrieves locations") {
+    robin_hood_map map;
+
+    REQUIRE(map.size() == 0);
+
+    const osmium::Location loc1{1.2, 3.4};
+    const osmium::Location loc2{5.6, 7.8};
+    map.set(12, loc1);
+    map.set(3, loc2);
+    REQUIRE(map.size() == 2);
+
+    REQUIRE(map.get(12) == loc1);
+    REQUIRE(map.get(3) == loc2);
+    REQUIRE(map.get_noexcept(12) == loc1);
+
+    REQUIRE_THROWS_AS(map.get(5), osmium::not_found);
+    REQUIRE_FALSE(map.get_noexcept(5).valid());
+
+    map.clear();
+    REQUIRE(map.size() == 0);
+    REQUIRE(map.used_memory() == 0);
+}
+
+TEST_CASE("Robin hood map overwrites existing values") {
+    robin_hood_map map;
+
+    map.set(17, osmium::Location{1.0, 1.0});
+    map.set(17, osmium::Location{2.0, 2.0});
+
+    REQUIRE(map.size() == 1);
+    REQUIRE(map.get(17) == osmium::Location(2.0, 2.0));
+}
+
+TEST_CASE("Robin hood map grows beyond its initial capacity") {
+    constexpr const osmium::unsigned_object_id_type num_ids = 100000;
+
+    robin_hood_map map;
+
+    // Use widely spaced ids so the map really is sparse.
+    for (osmium::unsigned_object_id_type id = 1; id <= num_ids; ++id) {
+        map.set(id * 1000, osmium::Location{static_cast<int64_t>(id), static_cast<int64_t>(id) + 1});
+    }
+    REQUIRE(map.size() == num_ids);
+
+    for (osmium::unsigned_object_id_type id = 1; id <= num_ids; ++id) {
+        REQUIRE(map.get(id * 1000) == osmium::Location(static_cast<int64_t>(id), static_cast<int64_t>(id) + 1));
+    }
+    REQUIRE_FALSE(map.get_noexcept(999).valid());
+}
+
+TEST_CASE("Robin hood map reserve avoids rehashing") {
+    robin_hood_map map;
+
+    map.reserve(10000);
+    const auto memory = map.used_memory();
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 10000; ++id) {
+        map.set(id, osmium::Location{1.0, 2.0});
+    }
+
+    REQUIRE(map.used_memory() == memory);
+    REQUIRE(map.size() == 10000);
+}
@@ -0,0 +1,62 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/striped_map.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <thread>
+#include <vector>
+
+using dense_map = osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+using striped_map = osmium::index::map::StripedMap<osmium::unsigned_object_id_type, osmium::Location, dense_map>;
+
+TEST_CASE("Striped map rounds stripes up to a power of two") {
+    const striped_map map{10};
+    REQUIRE(map.num_stripes() == 16);
+}
+
+TEST_CASE("Striped map stores and retrieves locations") {
+    striped_map map{4};
+
+    REQUIRE(map.size() == 0);
+
+    const osmium::Location loc1{1.2, 3.4};
+    const osmium::Location loc2{5.6, 7.8};
+    map.set(17, loc1);
+    map.set(18, loc2);
+
+    REQUIRE(map.get(17) == loc1);
+    REQUIRE(map.get(18) == loc2);
+    REQUIRE(map.get_noexcept(17) == loc1);
+
+    REQUIRE_THROWS_AS(map.get(1000), osmium::not_found);
+    REQUIRE_FALSE(map.get_noexcept(1000).valid());
+
+    map.clear();
+    REQUIRE(map.size() == 0);
+}
+
+TEST_CASE("Striped map can be filled from multiple threads") {
+    constexpr const osmium::unsigned_object_id_type num_ids = 10000;
+    constexpr const int num_threads = 4;
+
+    striped_map map;
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&map, t]() {
+            for (osmium::unsigned_object_id_type id = t; id < num_ids; id += num_threads) {
+                map.set(id, osmium::Location{static_cast<int64_t>(id), static_cast<int64_t>(id) + 1});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (osmium::unsigned_object_id_type id = 0; id < num_ids; ++id) {
+        REQUIRE(map.get(id) == osmium::Location(static_cast<int64_t>(id), static_cast<int64_t>(id) + 1));
+    }
+}
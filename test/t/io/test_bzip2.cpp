@@ -5,6 +5,9 @@
 #include <osmium/io/bzip2_compression.hpp>
 #include <osmium/io/detail/read_write.hpp>
 
+#include <cstdint>
+#include <fstream>
+#include <sstream>
 #include <string>
 
 static void read_from_decompressor(int fd) {
@@ -146,3 +149,203 @@ TEST_CASE("Write bzip2-compressed file with implicit close") {
     REQUIRE(osmium::file_size(output_file) > 10);
 }
 
+
+static std::string compress_to_stream(const std::string& data) {
+    const std::string filename{"test-bzip2-stream-part.bz2"};
+    const int fd = osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow);
+    REQUIRE(fd > 0);
+
+    osmium::io::Bzip2Compressor comp{fd, osmium::io::fsync::no};
+    comp.write(data);
+    comp.close();
+
+    std::ifstream file{filename, std::ifstream::binary};
+    REQUIRE(file.is_open());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static std::string write_multi_stream_file(const std::string& part1, const std::string& part2) {
+    const std::string filename{"test-bzip2-multi-stream.bz2"};
+    std::ofstream file{filename, std::ofstream::binary | std::ofstream::trunc};
+    REQUIRE(file.is_open());
+    file << compress_to_stream(part1) << compress_to_stream(part2);
+    file.close();
+    return filename;
+}
+
+TEST_CASE("Multi-stream detection") {
+    const std::string filename = write_multi_stream_file("first stream", "second stream");
+
+    const int fd = osmium::io::detail::open_for_reading(filename);
+    REQUIRE(fd > 0);
+
+    REQUIRE(osmium::io::Bzip2MultiStreamDecompressor::file_is_multi_stream(fd));
+
+    // the file position is restored after the detection
+    REQUIRE(osmium::file_offset(fd) == 0);
+
+    osmium::io::detail::reliable_close(fd);
+}
+
+TEST_CASE("Single-stream bzip2 file is not detected as multi-stream") {
+    const std::string input_file = with_data_dir("t/io/data_bzip2.txt.bz2");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    REQUIRE_FALSE(osmium::io::Bzip2MultiStreamDecompressor::file_is_multi_stream(fd));
+
+    osmium::io::detail::reliable_close(fd);
+}
+
+TEST_CASE("Read multi-stream bzip2 file through the factory") {
+    const int count = count_fds();
+
+    const std::string part1(100000, 'a');
+    const std::string part2(100000, 'b');
+    const std::string filename = write_multi_stream_file(part1, part2);
+
+    const int fd = osmium::io::detail::open_for_reading(filename);
+    REQUIRE(fd > 0);
+
+    // the factory picks the parallel multi-stream decompressor here
+    const auto decomp = osmium::io::CompressionFactory::instance().create_decompressor(osmium::io::file_compression::bzip2, fd);
+
+    std::string all;
+    for (std::string data = decomp->read(); !data.empty(); data = decomp->read()) {
+        all += data;
+    }
+    decomp->close();
+
+    REQUIRE(all == part1 + part2);
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Multi-stream decompressor reads many streams in file order") {
+    const std::string filename{"test-bzip2-many-streams.bz2"};
+    std::string expected;
+    {
+        std::ofstream file{filename, std::ofstream::binary | std::ofstream::trunc};
+        REQUIRE(file.is_open());
+        for (int n = 0; n < 20; ++n) {
+            const std::string data(10000, static_cast<char>('a' + n));
+            expected += data;
+            file << compress_to_stream(data);
+        }
+    }
+
+    const int fd = osmium::io::detail::open_for_reading(filename);
+    REQUIRE(fd > 0);
+
+    osmium::io::Bzip2MultiStreamDecompressor decomp{fd};
+    std::string all;
+    for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+        all += data;
+    }
+    decomp.close();
+
+    REQUIRE(all == expected);
+}
+
+static std::string make_varied_data(const std::size_t size) {
+    std::string data;
+    data.reserve(size);
+    uint32_t state = 12345;
+    while (data.size() < size) {
+        state = state * 1103515245U + 12345U;
+        data += static_cast<char>('a' + (state >> 16U) % 26U);
+    }
+    return data;
+}
+
+static std::string write_single_stream_file(const std::string& filename, const std::string& data) {
+    const int fd = osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow);
+    REQUIRE(fd > 0);
+
+    osmium::io::Bzip2Compressor comp{fd, osmium::io::fsync::no};
+    comp.write(data);
+    comp.close();
+    return filename;
+}
+
+TEST_CASE("Block-parallel decompressor reads a multi-block single-stream file") {
+    const int count = count_fds();
+
+    // large enough for several bzip2 blocks in one stream
+    const std::string expected = make_varied_data(2000000);
+    const std::string filename = write_single_stream_file("test-bzip2-blocks.bz2", expected);
+
+    const int fd = osmium::io::detail::open_for_reading(filename);
+    REQUIRE(fd > 0);
+    REQUIRE(osmium::io::Bzip2BlockDecompressor::file_is_suitable(fd));
+    REQUIRE(osmium::file_offset(fd) == 0);
+
+    osmium::io::Bzip2BlockDecompressor decomp{fd};
+    std::string all;
+    for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+        all += data;
+    }
+    decomp.close();
+
+    REQUIRE(all == expected);
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Factory picks the block-parallel decompressor for single-stream files") {
+    const int count = count_fds();
+
+    const std::string expected = make_varied_data(1500000);
+    const std::string filename = write_single_stream_file("test-bzip2-blocks-factory.bz2", expected);
+
+    const int fd = osmium::io::detail::open_for_reading(filename);
+    REQUIRE(fd > 0);
+
+    const auto decomp = osmium::io::CompressionFactory::instance().create_decompressor(osmium::io::file_compression::bzip2, fd);
+
+    std::string all;
+    for (std::string data = decomp->read(); !data.empty(); data = decomp->read()) {
+        all += data;
+    }
+    decomp->close();
+
+    REQUIRE(all == expected);
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Block-parallel decompressor reports errors in corrupted files") {
+    const int count = count_fds();
+
+    const std::string filename = write_single_stream_file("test-bzip2-blocks-corrupt.bz2", make_varied_data(2000000));
+
+    std::string contents;
+    {
+        std::ifstream file{filename, std::ifstream::binary};
+        REQUIRE(file.is_open());
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        contents = buffer.str();
+    }
+    contents[contents.size() / 2] = static_cast<char>(~contents[contents.size() / 2]);
+    {
+        std::ofstream file{filename, std::ofstream::binary | std::ofstream::trunc};
+        REQUIRE(file.is_open());
+        file << contents;
+    }
+
+    const int fd = osmium::io::detail::open_for_reading(filename);
+    REQUIRE(fd > 0);
+
+    const auto decomp = osmium::io::CompressionFactory::instance().create_decompressor(osmium::io::file_compression::bzip2, fd);
+    const auto read_all = [&]() {
+        for (std::string data = decomp->read(); !data.empty(); data = decomp->read()) {
+        }
+    };
+    REQUIRE_THROWS_AS(read_all(), osmium::bzip2_error);
+    decomp->close();
+
+    REQUIRE(count == count_fds());
+}
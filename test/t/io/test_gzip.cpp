@@ -135,3 +135,52 @@ TEST_CASE("Write gzip-compressed file with implicit close") {
     REQUIRE(osmium::file_size(output_file) > 10);
 }
 
+
+TEST_CASE("Write gzip file with parallel multi-member compressor") {
+    const int count = count_fds();
+
+    const std::string output_file = "test_gzip_parallel_out.txt.gz";
+    const int fd = osmium::io::detail::open_for_writing(output_file, osmium::io::overwrite::allow);
+    REQUIRE(fd > 0);
+
+    std::string expected;
+    {
+        osmium::io::ParallelGzipCompressor comp{fd, osmium::io::fsync::no};
+        for (int n = 0; n < 20; ++n) {
+            const std::string data(10000, static_cast<char>('a' + n));
+            expected += data;
+            comp.write(data);
+        }
+        comp.close();
+        REQUIRE(comp.file_size() > 10);
+    }
+
+    REQUIRE(count == count_fds());
+
+    // concatenated gzip members read back like a single-member file
+    const int in_fd = osmium::io::detail::open_for_reading(output_file);
+    REQUIRE(in_fd > 0);
+
+    osmium::io::GzipDecompressor decomp{in_fd};
+    std::string all;
+    for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+        all += data;
+    }
+    decomp.close();
+
+    REQUIRE(all == expected);
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Parallel gzip compressor with no data writes an empty file") {
+    const std::string output_file = "test_gzip_parallel_empty.txt.gz";
+    const int fd = osmium::io::detail::open_for_writing(output_file, osmium::io::overwrite::allow);
+    REQUIRE(fd > 0);
+
+    osmium::io::ParallelGzipCompressor comp{fd, osmium::io::fsync::no};
+    comp.write("");
+    comp.close();
+
+    REQUIRE(osmium::file_size(output_file) == 0);
+}
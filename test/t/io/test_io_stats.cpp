@@ -0,0 +1,60 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/stats.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/io/xml_output.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include <string>
+#include <utility>
+
+TEST_CASE("IOStats is default initialized to zero") {
+    const osmium::io::IOStats stats{};
+    REQUIRE(stats.io_nanoseconds == 0);
+    REQUIRE(stats.io_bytes == 0);
+    REQUIRE(stats.io_blocks == 0);
+    REQUIRE(stats.wait_nanoseconds == 0);
+    REQUIRE(stats.buffers == 0);
+    REQUIRE(stats.buffer_bytes == 0);
+}
+
+TEST_CASE("Reader collects I/O statistics") {
+    osmium::io::Reader reader{with_data_dir("t/io/data.osm")};
+
+    REQUIRE(reader.stats().buffers == 0);
+
+    std::size_t committed_bytes = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        committed_bytes += buffer.committed();
+    }
+    reader.close();
+
+    const auto stats = reader.stats();
+    REQUIRE(stats.io_blocks > 0);
+    REQUIRE(stats.io_bytes > 0);
+    REQUIRE(stats.buffers > 0);
+    REQUIRE(stats.buffer_bytes == committed_bytes);
+}
+
+TEST_CASE("Writer collects I/O statistics") {
+    osmium::io::Reader reader{with_data_dir("t/io/data.osm")};
+    osmium::memory::Buffer buffer = reader.read();
+    REQUIRE(buffer);
+    const std::size_t committed_bytes = buffer.committed();
+
+    const std::string filename = "test-io-stats-out.osm";
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+
+    REQUIRE(writer.stats().buffers == 0);
+
+    writer(std::move(buffer));
+    writer.close();
+
+    const auto stats = writer.stats();
+    REQUIRE(stats.io_blocks > 0);
+    REQUIRE(stats.io_bytes > 0);
+    REQUIRE(stats.buffers == 1);
+    REQUIRE(stats.buffer_bytes == committed_bytes);
+}
@@ -0,0 +1,47 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/lz4.hpp>
+#include <osmium/io/detail/pbf.hpp>
+
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("Compress and uncompress data using lz4") {
+    const std::string data{"the quick brown fox jumps over the lazy dog, the quick brown fox jumps over the lazy dog"};
+
+    const std::string compressed = osmium::io::detail::lz4_compress(data);
+    REQUIRE_FALSE(compressed.empty());
+    REQUIRE(compressed.size() < data.size());
+
+    std::string output;
+    const auto uncompressed = osmium::io::detail::lz4_uncompress_string(
+        compressed.data(),
+        static_cast<unsigned long>(compressed.size()), // NOLINT(google-runtime-int)
+        static_cast<unsigned long>(data.size()), // NOLINT(google-runtime-int)
+        output
+    );
+
+    REQUIRE(data == std::string(uncompressed.data(), uncompressed.size()));
+}
+
+TEST_CASE("Uncompressing broken lz4 data fails") {
+    const std::string data{"this is not lz4 compressed data"};
+
+    std::string output;
+    REQUIRE_THROWS_AS(osmium::io::detail::lz4_uncompress_string(
+        data.data(),
+        static_cast<unsigned long>(data.size()), // NOLINT(google-runtime-int)
+        1024UL, // NOLINT(google-runtime-int)
+        output
+    ), osmium::io_error);
+}
+
+TEST_CASE("lz4 compression level check") {
+    REQUIRE_NOTHROW(osmium::io::detail::lz4_check_compression_level(osmium::io::detail::lz4_default_compression_level()));
+    REQUIRE_THROWS_AS(osmium::io::detail::lz4_check_compression_level(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(osmium::io::detail::lz4_check_compression_level(100000), std::invalid_argument);
+}
+
+TEST_CASE("The pbf_compression option accepts lz4") {
+    REQUIRE(osmium::io::detail::get_compression_type("lz4") == osmium::io::detail::pbf_compression::lz4);
+}
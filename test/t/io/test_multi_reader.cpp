@@ -0,0 +1,80 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/multi_reader.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/io/pbf_output.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Every file gets its own id range so we can check that the buffers
+// are tagged with the right source.
+std::string write_test_file(const int source) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    const std::string filename{"test-multi-reader-" + std::to_string(source) + ".osm.pbf"};
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= 100; ++i) {
+        osmium::builder::add_node(buffer, _id(source * 1000 + i), _location(1.0, 2.0));
+    }
+
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    return filename;
+}
+
+} // anonymous namespace
+
+TEST_CASE("MultiReader reads all files and tags buffers with their source") {
+    std::vector<osmium::io::File> files;
+    files.reserve(3);
+    for (int source = 0; source < 3; ++source) {
+        files.emplace_back(write_test_file(source));
+    }
+
+    osmium::io::MultiReader reader{files};
+    REQUIRE(reader.num_sources() == 3);
+
+    std::set<osmium::object_id_type> ids;
+    while (auto item = reader.read()) {
+        for (const auto& object : item.buffer.select<osmium::OSMObject>()) {
+            ids.insert(object.id());
+            REQUIRE(object.id() / 1000 == static_cast<osmium::object_id_type>(item.source));
+        }
+    }
+    reader.close();
+
+    REQUIRE(ids.size() == 300);
+    REQUIRE(*ids.begin() == 1);
+    REQUIRE(*ids.rbegin() == 2100);
+}
+
+TEST_CASE("MultiReader can be closed before all data has been read") {
+    std::vector<osmium::io::File> files;
+    files.reserve(2);
+    for (int source = 0; source < 2; ++source) {
+        files.emplace_back(write_test_file(source));
+    }
+
+    osmium::io::MultiReader reader{files};
+
+    const auto item = reader.read();
+    REQUIRE(item);
+    REQUIRE(item.buffer.committed() > 0);
+
+    reader.close();
+    REQUIRE_FALSE(reader.read());
+}
@@ -0,0 +1,74 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/o5m_input.hpp>
+#include <osmium/io/o5m_output.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <string>
+#include <utility>
+
+static osmium::memory::Buffer read_file(const std::string& filename) {
+    osmium::io::Reader reader{filename};
+    osmium::memory::Buffer buffer = reader.read();
+    REQUIRE(buffer);
+    reader.close();
+    return buffer;
+}
+
+TEST_CASE("Writing o5m roundtrips the o5m test data") {
+    const auto buffer = read_file(with_data_dir("t/io/data-n5w1r3.osm.o5m"));
+
+    const auto objects = buffer.select<osmium::OSMObject>();
+    const auto num = objects.size();
+    REQUIRE(num == 9);
+
+    const std::string filename{"test-writer-out.osm.o5m"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    osmium::memory::Buffer copy{buffer.committed()};
+    copy.add_buffer(buffer);
+    copy.commit();
+    writer(std::move(copy));
+    writer.close();
+
+    const auto check_buffer = read_file(filename);
+    const auto check_objects = check_buffer.select<osmium::OSMObject>();
+    REQUIRE(check_objects.size() == num);
+
+    auto it = objects.cbegin();
+    for (const auto& object : check_objects) {
+        REQUIRE(object.type() == it->type());
+        REQUIRE(object.id() == it->id());
+        REQUIRE(object.version() == it->version());
+        REQUIRE(object.timestamp() == it->timestamp());
+        REQUIRE(object.changeset() == it->changeset());
+        REQUIRE(object.uid() == it->uid());
+        REQUIRE(std::string{object.user()} == it->user());
+        REQUIRE(object.tags().size() == it->tags().size());
+        ++it;
+    }
+}
+
+TEST_CASE("Writing o5m without metadata") {
+    const auto buffer = read_file(with_data_dir("t/io/data-n5w1r3.osm.o5m"));
+
+    const std::string filename{"test-writer-out-no-metadata.osm.o5m"};
+    osmium::io::Writer writer{osmium::io::File{filename, "o5m,add_metadata=none"}, osmium::io::overwrite::allow};
+    osmium::memory::Buffer copy{buffer.committed()};
+    copy.add_buffer(buffer);
+    copy.commit();
+    writer(std::move(copy));
+    writer.close();
+
+    const auto check_buffer = read_file(filename);
+    const auto check_objects = check_buffer.select<osmium::OSMObject>();
+    REQUIRE(check_objects.size() == buffer.select<osmium::OSMObject>().size());
+
+    for (const auto& object : check_objects) {
+        REQUIRE(object.version() == 0);
+        REQUIRE(object.changeset() == 0);
+        REQUIRE(std::string{object.user()}.empty());
+    }
+}
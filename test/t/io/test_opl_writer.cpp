@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/opl_output.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::string file_contents(const std::string& filename) {
+    std::ifstream file{filename, std::ifstream::binary};
+    REQUIRE(file.is_open());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+std::string write_opl(osmium::memory::Buffer&& buffer, const std::string& format = "opl") {
+    const std::string filename{"test-opl-writer-out.osm.opl"};
+    osmium::io::Writer writer{osmium::io::File{filename, format}, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+    return file_contents(filename);
+}
+
+} // anonymous namespace
+
+TEST_CASE("Writing OPL") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+
+    SECTION("node with tags and metadata") {
+        osmium::builder::add_node(buffer,
+            _id(17), _version(5), _cid(123), _uid(21), _user("foo"),
+            _timestamp("2015-01-01T10:00:00Z"),
+            _tag("highway", "primary"),
+            _location(-1.025, 2.0000001));
+
+        REQUIRE(write_opl(std::move(buffer)) ==
+                "n17 v5 dV c123 t2015-01-01T10:00:00Z i21 ufoo Thighway=primary x-1.025 y2.0000001\n");
+    }
+
+    SECTION("node without metadata") {
+        osmium::builder::add_node(buffer,
+            _id(17), _version(5), _cid(123), _uid(21), _user("foo"),
+            _timestamp("2015-01-01T10:00:00Z"),
+            _location(1.02, 2.03));
+
+        REQUIRE(write_opl(std::move(buffer), "opl,add_metadata=none") ==
+                "n17 T x1.02 y2.03\n");
+    }
+
+    SECTION("way") {
+        osmium::builder::add_way(buffer,
+            _id(18), _version(5), _cid(123), _uid(21), _user("foo"),
+            _timestamp("2015-01-01T10:00:00Z"),
+            _nodes({1, 2, 3}));
+
+        REQUIRE(write_opl(std::move(buffer)) ==
+                "w18 v5 dV c123 t2015-01-01T10:00:00Z i21 ufoo T Nn1,n2,n3\n");
+    }
+
+    SECTION("way with locations on ways") {
+        osmium::builder::add_way(buffer,
+            _id(18), _version(5), _cid(123), _uid(21), _user("foo"),
+            _timestamp("2015-01-01T10:00:00Z"),
+            _node(osmium::NodeRef{1, osmium::Location{1.02, 2.03}}),
+            _node(osmium::NodeRef{2, osmium::Location{-3.14, -2.7}}));
+
+        REQUIRE(write_opl(std::move(buffer), "opl,locations_on_ways=true") ==
+                "w18 v5 dV c123 t2015-01-01T10:00:00Z i21 ufoo T Nn1x1.02y2.03,n2x-3.14y-2.7\n");
+    }
+
+    SECTION("relation") {
+        osmium::builder::add_relation(buffer,
+            _id(19), _version(5), _cid(123), _uid(21), _user("foo"),
+            _timestamp("2015-01-01T10:00:00Z"),
+            _member(osmium::item_type::way, 2, "outer"),
+            _member(osmium::item_type::node, 3, ""));
+
+        REQUIRE(write_opl(std::move(buffer)) ==
+                "r19 v5 dV c123 t2015-01-01T10:00:00Z i21 ufoo T Mw2@outer,n3@\n");
+    }
+}
@@ -1,6 +1,8 @@
 #include "catch.hpp"
 
+#include <osmium/io/detail/output_format.hpp>
 #include <osmium/io/detail/string_util.hpp>
+#include <osmium/io/file.hpp>
 
 #include <iterator>
 #include <locale>
@@ -93,6 +95,17 @@ TEST_CASE("UTF8 encoding: encode multibyte character") {
     REQUIRE(out == "%30dc%_%1d11e%_%1f6eb%");
 }
 
+TEST_CASE("UTF8 encoding: long strings with escapes on block boundaries") {
+    // more than 16 bytes so the SIMD fast path is exercised
+    std::string out;
+    osmium::io::detail::append_utf8_encoded_string(out, "aaaaaaaaaaaaaaaaaaaaaaaa,bbbbbbbbbbbbbbbbbb");
+    REQUIRE(out == "aaaaaaaaaaaaaaaaaaaaaaaa%2c%bbbbbbbbbbbbbbbbbb");
+
+    out.clear();
+    osmium::io::detail::append_utf8_encoded_string(out, u8cast(u8"ccccccccccccccccボcccccccccccccccc"));
+    REQUIRE(out == "cccccccccccccccc%30dc%cccccccccccccccc");
+}
+
 TEST_CASE("html encoding does not encode normal characters") {
     const char* s = "abc123,.-";
     std::string out;
@@ -107,6 +120,13 @@ TEST_CASE("html encoding encodes special XML characters") {
     REQUIRE(out == "&amp; &quot; &apos; &lt; &gt; &#xA; &#xD; &#x9;");
 }
 
+TEST_CASE("html encoding encodes special characters in long strings") {
+    // more than 16 bytes so the SIMD fast path is exercised
+    std::string out;
+    osmium::io::detail::append_xml_encoded_string(out, "aaaaaaaaaaaaaaaaaaaaaaaa&bbbbbbbbbbbbbbbbbb<");
+    REQUIRE(out == "aaaaaaaaaaaaaaaaaaaaaaaa&amp;bbbbbbbbbbbbbbbbbb&lt;");
+}
+
 TEST_CASE("debug encoding does not encode normal characters") {
     const char* s = "abc123,.-";
     std::string out;
@@ -225,3 +245,26 @@ TEST_CASE("incomplete Unicode codepoint") {
     }
 }
 
+
+TEST_CASE("resolve generic output options in one pass") {
+    osmium::io::File file{"test.osm"};
+    file.set("add_metadata", "version+timestamp");
+    file.set("locations_on_ways", true);
+    file.set("diff", "yes");
+    file.set("color", "true"); // format-specific options are left in the map
+
+    const auto options = osmium::io::detail::resolve_generic_output_options(file);
+    REQUIRE(options.locations_on_ways);
+    REQUIRE(options.format_as_diff);
+    REQUIRE(options.add_metadata.version());
+    REQUIRE(options.add_metadata.timestamp());
+    REQUIRE_FALSE(options.add_metadata.user());
+    REQUIRE(file.is_true("color"));
+}
+
+TEST_CASE("generic output options default to all metadata and no flags") {
+    const auto options = osmium::io::detail::resolve_generic_output_options(osmium::io::File{"test.osm"});
+    REQUIRE(options.add_metadata.all());
+    REQUIRE_FALSE(options.locations_on_ways);
+    REQUIRE_FALSE(options.format_as_diff);
+}
@@ -2,9 +2,23 @@
 
 #include "utils.hpp"
 
+#include <osmium/builder/attr.hpp>
 #include <osmium/io/pbf_input.hpp>
+#include <osmium/io/pbf_output.hpp>
 #include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
 #include <osmium/osm/object.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 TEST_CASE("Get supported PBF compression types") {
     const auto types = osmium::io::supported_pbf_compression_types();
@@ -50,3 +64,322 @@ TEST_CASE("Read PBF file with version=-1 and changeset=-1 and DenseNodes (writte
     REQUIRE(object.version() == 0);
     REQUIRE(object.changeset() == 0);
 }
+
+TEST_CASE("Reading PBF file with read_tags::no skips the tags") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.02, 2.03), _tag("amenity", "restaurant"));
+    osmium::builder::add_way(buffer, _id(2), _nodes({1}), _tag("highway", "primary"));
+
+    const std::string filename{"test-pbf-read-tags.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    const osmium::memory::Buffer check_buffer = osmium::io::read_file(filename, osmium::io::read_tags::no);
+
+    auto it = check_buffer.cbegin<osmium::OSMObject>();
+    REQUIRE(it != check_buffer.cend<osmium::OSMObject>());
+    REQUIRE(it->id() == 1);
+    REQUIRE(static_cast<const osmium::Node&>(*it).location() == osmium::Location{1.02, 2.03});
+    REQUIRE(it->tags().empty());
+    ++it;
+    REQUIRE(it != check_buffer.cend<osmium::OSMObject>());
+    REQUIRE(it->id() == 2);
+    REQUIRE(static_cast<const osmium::Way&>(*it).nodes().size() == 1);
+    REQUIRE(it->tags().empty());
+
+    // the same file read normally does contain the tags
+    const osmium::memory::Buffer tags_buffer = osmium::io::read_file(filename);
+
+    for (const auto& object : tags_buffer.select<osmium::OSMObject>()) {
+        REQUIRE(object.tags().size() == 1);
+    }
+}
+
+TEST_CASE("Reading PBF file with way_envelopes::yes stores way envelopes") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_way(buffer, _id(1),
+                             _node(osmium::NodeRef{1, osmium::Location{1.0, 1.0}}),
+                             _node(osmium::NodeRef{2, osmium::Location{2.0, 3.0}}));
+
+    const std::string filename{"test-pbf-way-envelopes.osm.pbf"};
+    osmium::io::Writer writer{osmium::io::File{filename, "pbf,locations_on_ways=true"},
+                              osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    const auto has_stored_envelope = [](const osmium::Way& way) {
+        for (auto it = way.cbegin(); it != way.cend(); ++it) {
+            if (it->type() == osmium::item_type::way_envelope) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const osmium::memory::Buffer check_buffer = osmium::io::read_file(filename, osmium::io::way_envelopes::yes);
+
+    const auto& way = check_buffer.get<osmium::Way>(0);
+    REQUIRE(has_stored_envelope(way));
+
+    const osmium::Box envelope = way.envelope();
+    REQUIRE(envelope.valid());
+    REQUIRE(envelope.bottom_left() == osmium::Location(1.0, 1.0));
+    REQUIRE(envelope.top_right() == osmium::Location(2.0, 3.0));
+
+    // without the option no envelope is stored
+    const osmium::memory::Buffer plain_buffer = osmium::io::read_file(filename);
+    REQUIRE_FALSE(has_stored_envelope(plain_buffer.get<osmium::Way>(0)));
+}
+
+TEST_CASE("Reading PBF file with clean_way_nodes::yes drops consecutive duplicate way nodes") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_way(buffer, _id(1), _nodes({1, 1, 2, 2, 2, 3}));
+    osmium::builder::add_way(buffer, _id(2), _nodes({4, 5, 4}));
+
+    const std::string filename{"test-pbf-clean-way-nodes.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    osmium::io::Reader reader{filename, osmium::io::clean_way_nodes::yes};
+    const osmium::memory::Buffer check_buffer = reader.read();
+    reader.close();
+
+    const auto& way1 = check_buffer.get<osmium::Way>(0);
+    REQUIRE(way1.nodes().size() == 3);
+    REQUIRE(way1.nodes()[0].ref() == 1);
+    REQUIRE(way1.nodes()[1].ref() == 2);
+    REQUIRE(way1.nodes()[2].ref() == 3);
+
+    // non-consecutive repetitions are kept
+    const auto it = std::next(check_buffer.cbegin<osmium::OSMObject>());
+    REQUIRE(static_cast<const osmium::Way&>(*it).nodes().size() == 3);
+
+    REQUIRE(reader.stats().duplicate_way_nodes == 3);
+
+    // without the option the duplicates are kept
+    const osmium::memory::Buffer plain_buffer = osmium::io::read_file(filename);
+    REQUIRE(plain_buffer.get<osmium::Way>(0).nodes().size() == 6);
+}
+
+namespace {
+
+std::string slurp_file(const std::string& filename) {
+    std::ifstream file{filename, std::ios::binary};
+    REQUIRE(file.is_open());
+    std::stringstream sstr;
+    sstr << file.rdbuf();
+    return sstr.str();
+}
+
+void spew_file(const std::string& filename, const std::string& data) {
+    std::ofstream file{filename, std::ios::binary | std::ios::trunc};
+    REQUIRE(file.is_open());
+    file << data;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Reading PBF file with skip_damaged_blobs::yes skips damaged blobs") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    // more nodes than fit into one primitive block (8000 entities), so
+    // the file gets two data blobs
+    const int num_nodes = 10000;
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= num_nodes; ++i) {
+        osmium::builder::add_node(buffer, _id(i), _location(1.0, 2.0));
+    }
+
+    const std::string filename{"test-pbf-damaged-blob.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    // flip some bytes inside the compressed data of the second blob
+    std::string data = slurp_file(filename);
+    REQUIRE(data.size() > 40);
+    for (std::size_t i = data.size() - 20; i < data.size() - 10; ++i) {
+        data[i] ^= 0x55; // NOLINT(hicpp-signed-bitwise)
+    }
+    spew_file(filename, data);
+
+    // without the option the damage aborts the read
+    REQUIRE_THROWS_AS(osmium::io::read_file(filename), osmium::io_error);
+
+    // with the option the damaged blob is skipped and counted
+    osmium::io::Reader reader{filename, osmium::io::skip_damaged_blobs::yes};
+    int count = 0;
+    while (osmium::memory::Buffer b = reader.read()) {
+        for (const auto& object : b.select<osmium::OSMObject>()) {
+            REQUIRE(object.id() == ++count);
+        }
+    }
+    reader.close();
+    REQUIRE(count == 8000); // the first blob is intact, the second is lost
+    REQUIRE(reader.stats().damaged_blobs == 1);
+}
+
+TEST_CASE("Truncated PBF file ends reading early with skip_damaged_blobs::yes") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    for (int i = 1; i <= 10; ++i) {
+        osmium::builder::add_node(buffer, _id(i));
+    }
+
+    const std::string filename{"test-pbf-truncated.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    std::string data = slurp_file(filename);
+    REQUIRE(data.size() > 10);
+    spew_file(filename, data.substr(0, data.size() - 10));
+
+    REQUIRE_THROWS_AS(osmium::io::read_file(filename), osmium::io_error);
+
+    osmium::io::Reader reader{filename, osmium::io::skip_damaged_blobs::yes};
+    while (reader.read()) {
+    }
+    reader.close();
+    REQUIRE(reader.stats().damaged_blobs == 1);
+}
+
+TEST_CASE("Reading PBF file with many small blobs keeps objects in file order") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    // more nodes than fit into a single primitive block, so the file
+    // gets several small data blobs which the parser batches into
+    // fewer decoder tasks
+    const int num_nodes = 50000;
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= num_nodes; ++i) {
+        osmium::builder::add_node(buffer, _id(i), _location(i * 0.0001, 1.0));
+    }
+    osmium::builder::add_way(buffer, _id(num_nodes + 1), _nodes({1, 2, 3}));
+
+    const std::string filename{"test-pbf-small-blobs.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    osmium::io::Reader reader{filename};
+    osmium::object_id_type expected_id = 1;
+    while (osmium::memory::Buffer b = reader.read()) {
+        for (const auto& object : b.select<osmium::OSMObject>()) {
+            REQUIRE(object.id() == expected_id);
+            ++expected_id;
+        }
+    }
+    reader.close();
+
+    REQUIRE(expected_id == num_nodes + 2); // all nodes and the way were seen
+}
+
+TEST_CASE("Buffers read from a PBF file carry provenance annotations") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    // more nodes than fit into one primitive block (8000 entities), so
+    // the file gets two data blobs
+    const int num_nodes = 10000;
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= num_nodes; ++i) {
+        osmium::builder::add_node(buffer, _id(i));
+    }
+
+    REQUIRE_FALSE(buffer.get_provenance()); // locally built buffers have none
+
+    const std::string filename{"test-pbf-provenance.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    // one blob can come out as several buffers (internal growth while
+    // decoding) which then share the blob's annotations, so sequence and
+    // offset only grow monotonically from buffer to buffer
+    osmium::io::Reader reader{filename};
+    std::size_t num_buffers = 0;
+    std::size_t last_sequence = 0;
+    std::size_t last_offset = 0;
+    bool seen_second_blob = false;
+    while (osmium::memory::Buffer b = reader.read()) {
+        const auto& provenance = b.get_provenance();
+        REQUIRE(provenance);
+        REQUIRE(provenance.decoded_at_ns != 0);
+        if (num_buffers == 0) {
+            REQUIRE(provenance.sequence == 0);
+            REQUIRE(provenance.source_offset > 0); // the header blob comes first
+        } else {
+            REQUIRE(provenance.sequence >= last_sequence);
+            REQUIRE(provenance.source_offset >= last_offset);
+        }
+        if (provenance.sequence == 1) {
+            seen_second_blob = true;
+        }
+        last_sequence = provenance.sequence;
+        last_offset = provenance.source_offset;
+        ++num_buffers;
+    }
+    reader.close();
+
+    REQUIRE(num_buffers >= 2);
+    REQUIRE(seen_second_blob);
+}
+
+TEST_CASE("Reading PBF file with a filter_box drops out-of-box nodes") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.0), _tag("name", "in"));
+    osmium::builder::add_node(buffer, _id(2), _location(50.0, 50.0), _tag("name", "out"));
+    osmium::builder::add_node(buffer, _id(3), _location(2.0, 2.0), _tag("name", "in, too"));
+    osmium::builder::add_way(buffer, _id(4), _nodes({1, 2, 3}));
+
+    const osmium::Box box{0.0, 0.0, 10.0, 10.0};
+
+    const auto check = [&](const std::string& filename, const osmium::io::read_meta read_metadata) {
+        osmium::io::Reader reader{filename, osmium::io::filter_box{box}, read_metadata};
+        std::vector<osmium::object_id_type> ids;
+        while (osmium::memory::Buffer b = reader.read()) {
+            for (const auto& object : b.select<osmium::OSMObject>()) {
+                ids.push_back(object.id());
+                if (object.type() == osmium::item_type::node) {
+                    REQUIRE(std::string{object.tags()["name"]}.substr(0, 2) == "in");
+                }
+            }
+        }
+        reader.close();
+        REQUIRE(ids == std::vector<osmium::object_id_type>{1, 3, 4}); // the way is not filtered
+    };
+
+    SECTION("dense nodes") {
+        const std::string filename{"test-pbf-filter-box-dense.osm.pbf"};
+        osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+        writer(std::move(buffer));
+        writer.close();
+
+        check(filename, osmium::io::read_meta::yes);
+        check(filename, osmium::io::read_meta::no);
+    }
+
+    SECTION("plain nodes") {
+        const std::string filename{"test-pbf-filter-box-plain.osm.pbf"};
+        osmium::io::Writer writer{osmium::io::File{filename, "pbf,pbf_dense_nodes=false"},
+                                  osmium::io::overwrite::allow};
+        writer(std::move(buffer));
+        writer.close();
+
+        check(filename, osmium::io::read_meta::yes);
+    }
+}
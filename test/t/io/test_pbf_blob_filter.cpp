@@ -0,0 +1,131 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/pbf_blob_index.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/io/pbf_output.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// More nodes than fit into a single primitive block so the file gets
+// several data blobs.
+const int num_nodes = 20000;
+
+std::string write_test_file() {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    const std::string filename{"test-pbf-blob-filter.osm.pbf"};
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= num_nodes; ++i) {
+        osmium::builder::add_node(buffer, _id(i), _location(i * 0.001, 1.0));
+    }
+    osmium::builder::add_way(buffer, _id(num_nodes + 1), _nodes({1, 2, 3}));
+
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    return filename;
+}
+
+std::size_t count_objects(osmium::io::Reader& reader) {
+    std::size_t count = 0;
+    while (const auto buffer = reader.read()) {
+        count += buffer.select<osmium::OSMObject>().size();
+    }
+    return count;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Blob filter that accepts everything sees all blobs") {
+    const auto filename = write_test_file();
+
+    std::vector<osmium::io::blob_info> infos;
+    osmium::io::Reader reader{filename, osmium::io::blob_filter{[&](const osmium::io::blob_info& info) {
+        infos.push_back(info);
+        return true;
+    }}};
+    REQUIRE(count_objects(reader) == num_nodes + 1);
+    reader.close();
+
+    REQUIRE(infos.size() >= 3);
+    std::size_t last_offset = 0;
+    for (std::size_t n = 0; n < infos.size(); ++n) {
+        REQUIRE(infos[n].index == n);
+        REQUIRE(infos[n].offset > last_offset);
+        REQUIRE(infos[n].datasize > 0);
+        last_offset = infos[n].offset;
+    }
+}
+
+TEST_CASE("Blob filter that rejects everything yields no data") {
+    const auto filename = write_test_file();
+
+    osmium::io::Reader reader{filename, osmium::io::blob_filter{[](const osmium::io::blob_info& /*info*/) {
+        return false;
+    }}};
+    REQUIRE(count_objects(reader) == 0);
+    reader.close();
+}
+
+TEST_CASE("Blob filter works with mapped input") {
+    const auto filename = write_test_file();
+
+    std::size_t num_blobs = 0;
+    osmium::io::Reader reader{filename, osmium::io::mapped_input::yes,
+                              osmium::io::blob_filter{[&](const osmium::io::blob_info& /*info*/) {
+        ++num_blobs;
+        return num_blobs == 1; // decode only the first blob
+    }}};
+    const auto count = count_objects(reader);
+    reader.close();
+
+    REQUIRE(num_blobs >= 3);
+    REQUIRE(count > 0);
+    REQUIRE(count < num_nodes);
+}
+
+TEST_CASE("Skip pure-node blobs using a blob index") {
+    const auto filename = write_test_file();
+
+    const auto index = osmium::io::PBFBlobIndex::build(filename);
+
+    // Decode only blobs that contain ways, like a ways-only job would.
+    std::size_t num_decoded = 0;
+    osmium::io::Reader reader{filename, osmium::io::blob_filter{[&](const osmium::io::blob_info& info) {
+        if ((index[info.index].entities & osmium::osm_entity_bits::way) == osmium::osm_entity_bits::nothing) {
+            return false;
+        }
+        REQUIRE(index[info.index].offset == info.offset);
+        ++num_decoded;
+        return true;
+    }}};
+
+    std::size_t num_ways = 0;
+    std::size_t num_objects = 0;
+    while (const auto buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            ++num_objects;
+            if (object.type() == osmium::item_type::way) {
+                ++num_ways;
+            }
+        }
+    }
+    reader.close();
+
+    REQUIRE(num_decoded < index.size());
+    REQUIRE(num_ways == 1);
+    // Only the objects from the decoded blobs are seen.
+    REQUIRE(num_objects < num_nodes);
+}
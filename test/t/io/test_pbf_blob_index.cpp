@@ -0,0 +1,197 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/pbf_blob_index.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/io/pbf_output.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/util/file.hpp>
+
+#include <string>
+#include <utility>
+
+namespace {
+
+// More nodes than fit into a single primitive block so the file gets
+// several data blobs.
+const int num_nodes = 20000;
+
+std::string write_test_file() {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    const std::string filename{"test-pbf-blob-index.osm.pbf"};
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= num_nodes; ++i) {
+        osmium::builder::add_node(buffer, _id(i), _location(i * 0.001, 1.0));
+    }
+    osmium::builder::add_way(buffer, _id(num_nodes + 1), _nodes({1, 2, 3}));
+
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    return filename;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Build PBF blob index and query it") {
+    const auto filename = write_test_file();
+
+    const auto index = osmium::io::PBFBlobIndex::build(filename);
+    REQUIRE(index.size() >= 3);
+
+    // blobs are listed in file order with ascending offsets
+    std::size_t last_offset = 0;
+    for (const auto& entry : index) {
+        REQUIRE(entry.offset > last_offset);
+        last_offset = entry.offset;
+    }
+
+    const auto& first = index[0];
+    REQUIRE(first.entities == osmium::osm_entity_bits::node);
+    REQUIRE(first.first_id == 1);
+    REQUIRE(first.box.valid());
+
+    SECTION("find blobs by id") {
+        const auto* entry = index.find_id(osmium::item_type::node, 1);
+        REQUIRE(entry == &index[0]);
+
+        entry = index.find_id(osmium::item_type::node, num_nodes);
+        REQUIRE(entry != nullptr);
+        REQUIRE(entry->entities == osmium::osm_entity_bits::node);
+        REQUIRE(entry->offset > index[0].offset);
+
+        entry = index.find_id(osmium::item_type::way, num_nodes + 1);
+        REQUIRE(entry != nullptr);
+        REQUIRE(entry->entities == osmium::osm_entity_bits::way);
+
+        REQUIRE(index.find_id(osmium::item_type::node, num_nodes + 100) == nullptr);
+        REQUIRE(index.find_id(osmium::item_type::relation, 1) == nullptr);
+    }
+
+    SECTION("find blobs by bounding box") {
+        // all nodes are on the lat=1.0 line with lon from 0.001 to 20.0
+        const osmium::Box everywhere{-180.0, -90.0, 180.0, 90.0};
+        const auto all = index.find_in_box(everywhere);
+        REQUIRE(all.size() == index.size() - 1); // all but the way blob
+
+        const osmium::Box nowhere{100.0, 50.0, 110.0, 60.0};
+        REQUIRE(index.find_in_box(nowhere).empty());
+
+        const osmium::Box start{0.0, 0.0, 0.5, 2.0};
+        const auto some = index.find_in_box(start);
+        REQUIRE(some.size() == 1);
+        REQUIRE(some.front() == &index[0]);
+    }
+
+    SECTION("entity counts") {
+        const auto counts = index.counts();
+        REQUIRE(counts.nodes == num_nodes);
+        REQUIRE(counts.ways == 1);
+        REQUIRE(counts.relations == 0);
+        REQUIRE(counts.total() == num_nodes + 1);
+    }
+
+    SECTION("skeleton scan estimates entity counts") {
+        const auto result = osmium::io::PBFBlobIndex::scan(filename);
+        REQUIRE(result.file_size == osmium::file_size(filename));
+        REQUIRE(result.data_blobs == index.size());
+        REQUIRE(result.data_bytes > 0);
+        REQUIRE(result.data_bytes < result.file_size);
+        REQUIRE(result.estimated_entities() >= index.counts().total());
+    }
+
+    SECTION("save and load roundtrip") {
+        const std::string index_filename{"test-pbf-blob-index.idx"};
+        index.save(index_filename);
+
+        const auto loaded = osmium::io::PBFBlobIndex::load(index_filename);
+        REQUIRE(loaded.size() == index.size());
+        for (std::size_t i = 0; i < index.size(); ++i) {
+            REQUIRE(loaded[i].offset == index[i].offset);
+            REQUIRE(loaded[i].entities == index[i].entities);
+            REQUIRE(loaded[i].first_id == index[i].first_id);
+            REQUIRE(loaded[i].last_id == index[i].last_id);
+            REQUIRE(loaded[i].num_nodes == index[i].num_nodes);
+            REQUIRE(loaded[i].num_ways == index[i].num_ways);
+            REQUIRE(loaded[i].num_relations == index[i].num_relations);
+            REQUIRE(loaded[i].box.valid() == index[i].box.valid());
+            if (index[i].box.valid()) {
+                REQUIRE(loaded[i].box.bottom_left() == index[i].box.bottom_left());
+                REQUIRE(loaded[i].box.top_right() == index[i].box.top_right());
+            }
+        }
+    }
+
+    SECTION("load rejects files in the wrong format") {
+        REQUIRE_THROWS_AS(osmium::io::PBFBlobIndex::load(filename), osmium::io_error);
+    }
+
+    SECTION("box filter skips node blobs outside the box") {
+        // all nodes are on the lat=1.0 line with lon from 0.001 to 20.0
+        const osmium::Box start{0.0, 0.0, 0.5, 2.0};
+        osmium::io::Reader reader{filename,
+                                  osmium::io::blob_filter{index.box_filter(start)},
+                                  osmium::io::filter_box{start}};
+        int nodes = 0;
+        int ways = 0;
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                if (object.type() == osmium::item_type::node) {
+                    ++nodes;
+                    REQUIRE(start.contains(static_cast<const osmium::Node&>(object).location()));
+                } else if (object.type() == osmium::item_type::way) {
+                    ++ways;
+                }
+            }
+        }
+        reader.close();
+
+        REQUIRE(nodes == 500); // nodes 1 to 500 are at lon 0.001 to 0.5
+        REQUIRE(ways == 1); // the way blob is never skipped
+
+        // a box overlapping nothing leaves only the way
+        const osmium::Box nowhere{100.0, 50.0, 110.0, 60.0};
+        osmium::io::Reader empty_reader{filename,
+                                        osmium::io::blob_filter{index.box_filter(nowhere)},
+                                        osmium::io::filter_box{nowhere}};
+        int objects = 0;
+        while (osmium::memory::Buffer buffer = empty_reader.read()) {
+            for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                (void)object;
+                ++objects;
+            }
+        }
+        empty_reader.close();
+        REQUIRE(objects == 1);
+    }
+}
+
+TEST_CASE("Reader with start_offset skips to the given blob") {
+    const auto filename = write_test_file();
+
+    const auto index = osmium::io::PBFBlobIndex::build(filename);
+    const auto* entry = index.find_id(osmium::item_type::way, num_nodes + 1);
+    REQUIRE(entry != nullptr);
+
+    osmium::io::Reader reader{filename, osmium::io::start_offset{entry->offset}};
+    const osmium::memory::Buffer buffer = reader.read();
+    reader.close();
+
+    // the first object after the seek is the way, all node blobs
+    // have been skipped
+    REQUIRE(buffer);
+    const auto& object = *buffer.cbegin<osmium::OSMObject>();
+    REQUIRE(object.type() == osmium::item_type::way);
+    REQUIRE(object.id() == num_nodes + 1);
+}
@@ -0,0 +1,75 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/pbf_node_columns.hpp>
+#include <osmium/io/pbf_output.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const int num_nodes = 20000;
+
+std::string write_test_file(const char* filename, const char* format) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= num_nodes; ++i) {
+        osmium::builder::add_node(buffer, _id(i), _location(i * 0.001, 1.0), _tag("name", "some node"));
+    }
+    osmium::builder::add_way(buffer, _id(num_nodes + 1), _nodes({1, 2, 3}));
+
+    osmium::io::Writer writer{osmium::io::File{filename, format},
+                              osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    return filename;
+}
+
+void check_file(const std::string& filename) {
+    std::vector<osmium::object_id_type> ids;
+    std::vector<osmium::Location> locations;
+
+    osmium::io::read_node_columns(filename, [&](osmium::io::NodeColumns&& columns) {
+        REQUIRE(columns.ids.size() == columns.locations.size());
+        ids.insert(ids.end(), columns.ids.begin(), columns.ids.end());
+        locations.insert(locations.end(), columns.locations.begin(), columns.locations.end());
+    });
+
+    REQUIRE(ids.size() == num_nodes); // the way does not show up
+    for (int i = 1; i <= num_nodes; ++i) {
+        REQUIRE(ids[i - 1] == i);
+        REQUIRE(locations[i - 1] == osmium::Location(i * 0.001, 1.0));
+    }
+}
+
+} // anonymous namespace
+
+TEST_CASE("Read node columns from PBF file with dense nodes") {
+    check_file(write_test_file("test-pbf-node-columns-dense.osm.pbf", "pbf"));
+}
+
+TEST_CASE("Read node columns from PBF file with plain nodes") {
+    check_file(write_test_file("test-pbf-node-columns-plain.osm.pbf", "pbf,pbf_dense_nodes=false"));
+}
+
+TEST_CASE("Read node columns from empty PBF file") {
+    const std::string filename{"test-pbf-node-columns-empty.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer.close();
+
+    int calls = 0;
+    osmium::io::read_node_columns(filename, [&](osmium::io::NodeColumns&&) {
+        ++calls;
+    });
+    REQUIRE(calls == 0);
+}
@@ -0,0 +1,72 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/pbf_output.hpp>
+#include <osmium/io/pbf_referenced_ids.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+
+#include <string>
+#include <utility>
+
+TEST_CASE("Collect referenced ids from PBF file") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 64UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.0));
+    osmium::builder::add_node(buffer, _id(2), _location(2.0, 2.0));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2, 3}), _tag("highway", "primary"));
+    osmium::builder::add_way(buffer, _id(11), _nodes({3, 4}));
+    osmium::builder::add_relation(buffer, _id(20),
+                                  _member(osmium::item_type::node, 5, "stop"),
+                                  _member(osmium::item_type::way, 10, "outer"),
+                                  _member(osmium::item_type::way, 12, "inner"),
+                                  _member(osmium::item_type::relation, 21, ""));
+
+    const std::string filename{"test-pbf-referenced-ids.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    const auto ids = osmium::io::read_referenced_ids(filename);
+
+    // node ids referenced from the ways and the relation
+    REQUIRE(ids(osmium::item_type::node).get(1));
+    REQUIRE(ids(osmium::item_type::node).get(2));
+    REQUIRE(ids(osmium::item_type::node).get(3));
+    REQUIRE(ids(osmium::item_type::node).get(4));
+    REQUIRE(ids(osmium::item_type::node).get(5));
+    REQUIRE(ids(osmium::item_type::node).size() == 5);
+
+    // way and relation ids referenced from the relation
+    REQUIRE(ids(osmium::item_type::way).get(10));
+    REQUIRE(ids(osmium::item_type::way).get(12));
+    REQUIRE(ids(osmium::item_type::way).size() == 2);
+    REQUIRE(ids(osmium::item_type::relation).get(21));
+    REQUIRE(ids(osmium::item_type::relation).size() == 1);
+
+    // the ids of the objects themselves are not in the sets
+    REQUIRE_FALSE(ids(osmium::item_type::way).get(11));
+    REQUIRE_FALSE(ids(osmium::item_type::relation).get(20));
+}
+
+TEST_CASE("Collect referenced ids from PBF file without ways or relations") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.0));
+
+    const std::string filename{"test-pbf-referenced-ids-nodes-only.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    const auto ids = osmium::io::read_referenced_ids(filename);
+
+    REQUIRE(ids(osmium::item_type::node).empty());
+    REQUIRE(ids(osmium::item_type::way).empty());
+    REQUIRE(ids(osmium::item_type::relation).empty());
+}
@@ -6,10 +6,12 @@
 #include <osmium/io/any_compression.hpp>
 #include <osmium/io/any_input.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/visitor.hpp>
 
 #include <iterator>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 struct CountHandler : public osmium::handler::Handler {
@@ -82,6 +84,81 @@ TEST_CASE("Reader can be initialized with user-provided pool") {
     REQUIRE(count == count_fds());
 }
 
+TEST_CASE("Reader can be initialized with queue options") {
+    const int count = count_fds();
+
+    const osmium::io::File file{with_data_dir("t/io/data.osm")};
+    osmium::io::Reader reader{file,
+                              osmium::io::input_queue_size{4},
+                              osmium::io::osmdata_queue_size{4},
+                              osmium::io::adaptive_queues::yes};
+    osmium::handler::Handler handler;
+
+    osmium::apply(reader, handler);
+
+    reader.close();
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Reader in synchronous mode (XML)") {
+    const int count = count_fds();
+
+    const osmium::io::File file{with_data_dir("t/io/data.osm")};
+    osmium::io::Reader reader{file, osmium::io::synchronous::yes};
+
+    const auto header = reader.header();
+    REQUIRE(header.get("generator") == "testdata");
+
+    CountHandler handler;
+    osmium::apply(reader, handler);
+    REQUIRE(handler.count == 1);
+    REQUIRE(reader.eof());
+
+    reader.close();
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Reader in synchronous mode (gzipped XML)") {
+    const int count = count_fds();
+
+    const osmium::io::File file{with_data_dir("t/io/data.osm.gz")};
+    osmium::io::Reader reader{file, osmium::io::synchronous::yes};
+
+    CountHandler handler;
+    osmium::apply(reader, handler);
+    REQUIRE(handler.count == 1);
+    REQUIRE(reader.eof());
+
+    reader.close();
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Reader in synchronous mode on nonexistent file") {
+    REQUIRE_THROWS(osmium::io::Reader{"nonexistent-file.osm", osmium::io::synchronous::yes});
+}
+
+TEST_CASE("Reader can be constructed and closed without reading anything") {
+    const int count = count_fds();
+
+    osmium::io::Reader reader{with_data_dir("t/io/data.osm")};
+    reader.close();
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("peek_header reads only the header") {
+    const int count = count_fds();
+
+    const auto header = osmium::io::peek_header(with_data_dir("t/io/data.osm"));
+    REQUIRE(header.get("generator") == "testdata");
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("peek_header on nonexistent file") {
+    REQUIRE_THROWS(osmium::io::peek_header("nonexistent-file.osm"));
+}
+
 TEST_CASE("Reader should throw after eof") {
     const int count = count_fds();
 
@@ -108,6 +185,32 @@ TEST_CASE("Reader should throw after eof") {
     REQUIRE(count == count_fds());
 }
 
+TEST_CASE("try_read reports errors instead of throwing") {
+    osmium::io::Reader reader{with_data_dir("t/io/data.osm")};
+
+    int count = 0;
+    while (true) {
+        auto result = reader.try_read();
+        REQUIRE(result);
+        REQUIRE(result.error.empty());
+        if (!result.buffer) {
+            break;
+        }
+        count += static_cast<int>(std::distance(result.buffer.cbegin<osmium::OSMObject>(),
+                                                result.buffer.cend<osmium::OSMObject>()));
+    }
+    REQUIRE(count > 0);
+    REQUIRE(reader.eof());
+
+    // reading after eof is an error, but try_read doesn't throw
+    const auto result = reader.try_read();
+    REQUIRE_FALSE(result);
+    REQUIRE_FALSE(result.error.empty());
+    REQUIRE_FALSE(result.buffer);
+
+    reader.close();
+}
+
 TEST_CASE("Reader should not hang when apply() is called twice on reader") {
     const int count = count_fds();
 
@@ -370,6 +473,95 @@ void check_buffer_counts(const std::string& filename, const std::vector<object_c
     }
 }
 
+TEST_CASE("Reader with read_meta::no does not decode o5m metadata") {
+    const osmium::io::File file{with_data_dir("t/io/data-n5w1r3.osm.o5m")};
+    osmium::io::Reader reader{file, osmium::io::read_meta::no};
+
+    const osmium::memory::Buffer buffer = reader.read();
+    reader.close();
+
+    const auto objects = buffer.select<osmium::OSMObject>();
+    REQUIRE(objects.size() == 9);
+
+    for (const auto& object : objects) {
+        REQUIRE(object.version() == 0);
+        REQUIRE(object.changeset() == 0);
+        REQUIRE(object.uid() == 0);
+        REQUIRE(std::string{object.user()}.empty());
+    }
+
+    // tags must still be decoded correctly, because they share the
+    // string reference table with the user names
+    REQUIRE(std::next(objects.cbegin(), 5)->tags().size() == 1);
+}
+
+TEST_CASE("Reader with read_discussions::no skips changeset discussions") {
+    const osmium::io::File file{with_data_dir("t/io/data-changesets.osm")};
+
+    SECTION("default reads discussions") {
+        osmium::io::Reader reader{file};
+        const osmium::memory::Buffer buffer = reader.read();
+        reader.close();
+
+        const auto changesets = buffer.select<osmium::Changeset>();
+        REQUIRE(changesets.size() == 2);
+
+        const auto& changeset = *std::next(changesets.cbegin());
+        REQUIRE(changeset.id() == 402758);
+        REQUIRE(changeset.tags().size() == 1);
+
+        const auto& discussion = changeset.discussion();
+        REQUIRE(std::distance(discussion.cbegin(), discussion.cend()) == 1);
+        REQUIRE(std::string{discussion.cbegin()->text()} == "some comment");
+    }
+
+    SECTION("read_discussions::no gives empty discussions") {
+        osmium::io::Reader reader{file, osmium::io::read_discussions::no};
+        const osmium::memory::Buffer buffer = reader.read();
+        reader.close();
+
+        const auto changesets = buffer.select<osmium::Changeset>();
+        REQUIRE(changesets.size() == 2);
+
+        const auto& changeset = *std::next(changesets.cbegin());
+        REQUIRE(changeset.id() == 402758);
+        REQUIRE(changeset.tags().size() == 1);
+
+        const auto& discussion = changeset.discussion();
+        REQUIRE(std::distance(discussion.cbegin(), discussion.cend()) == 0);
+    }
+}
+
+TEST_CASE("Reading o5m in parallel gives the same result as sequential") {
+    const osmium::io::File file{with_data_dir("t/io/data-n5w1r3.osm.o5m")};
+
+    // A pool with a single thread forces the sequential o5m decoder.
+    osmium::thread::Pool pool{1};
+    osmium::io::Reader seq_reader{file, pool};
+    const osmium::memory::Buffer seq_buffer = seq_reader.read();
+    seq_reader.close();
+
+    osmium::io::Reader reader{file};
+    const osmium::memory::Buffer buffer = reader.read();
+    reader.close();
+
+    const auto seq_objects = seq_buffer.select<osmium::OSMObject>();
+    const auto objects = buffer.select<osmium::OSMObject>();
+    REQUIRE(seq_objects.size() == 9);
+    REQUIRE(objects.size() == 9);
+
+    auto it = seq_objects.cbegin();
+    for (const auto& object : objects) {
+        REQUIRE(object.type() == it->type());
+        REQUIRE(object.id() == it->id());
+        REQUIRE(object.version() == it->version());
+        REQUIRE(object.timestamp() == it->timestamp());
+        REQUIRE(std::string{object.user()} == it->user());
+        REQUIRE(object.tags().size() == it->tags().size());
+        ++it;
+    }
+}
+
 TEST_CASE("Reader with single object type per buffer") {
     check_buffer_counts("t/io/data-n5w1r3", {{5, 1, 3}}, osmium::io::buffers_type::any);
     check_buffer_counts("t/io/data-n5w1r3", {{5, 0, 0}, {0, 1, 0}, {0, 0, 3}}, osmium::io::buffers_type::single);
@@ -378,3 +570,74 @@ TEST_CASE("Reader with single object type per buffer") {
     check_buffer_counts("t/io/data-n5w1r0", {{5, 0, 0}, {0, 1, 0}}, osmium::io::buffers_type::single);
 }
 
+TEST_CASE("Demuxed reading hands out buffers by entity type") {
+    osmium::io::Reader reader{with_data_dir("t/io/data-n5w1r3.osm"), osmium::io::buffers_type::single};
+
+    // Ask for the ways first: the node buffer read in the meantime is
+    // held back and handed out by the later read for nodes.
+    const osmium::memory::Buffer way_buffer = reader.read(osmium::item_type::way);
+    REQUIRE(way_buffer);
+    REQUIRE(way_buffer.select<osmium::Way>().size() == 1);
+
+    const osmium::memory::Buffer node_buffer = reader.read(osmium::item_type::node);
+    REQUIRE(node_buffer);
+    REQUIRE(node_buffer.select<osmium::Node>().size() == 5);
+
+    const osmium::memory::Buffer rel_buffer = reader.read(osmium::item_type::relation);
+    REQUIRE(rel_buffer);
+    REQUIRE(rel_buffer.select<osmium::Relation>().size() == 3);
+
+    REQUIRE_FALSE(reader.read(osmium::item_type::node));
+    REQUIRE_FALSE(reader.read(osmium::item_type::way));
+    REQUIRE_FALSE(reader.read(osmium::item_type::relation));
+    REQUIRE(reader.eof());
+
+    reader.close();
+}
+
+TEST_CASE("Demuxed reading needs the buffers_type::single option") {
+    osmium::io::Reader reader{with_data_dir("t/io/data-n5w1r3.osm")};
+    REQUIRE_THROWS_AS(reader.read(osmium::item_type::node), osmium::io_error);
+    reader.close();
+}
+
+TEST_CASE("Coalesced reading merges buffers up to the target size") {
+    osmium::io::Reader reader{with_data_dir("t/io/data-n5w1r3.osm"),
+                              osmium::io::coalesce_buffers{64UL * 1024UL * 1024UL}};
+
+    std::size_t count = 0;
+    std::size_t buffers = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        ++buffers;
+        count += buffer.select<osmium::OSMObject>().size();
+    }
+
+    REQUIRE(buffers == 1);
+    REQUIRE(count == 9);
+    REQUIRE(reader.eof());
+
+    reader.close();
+}
+
+TEST_CASE("Coalesced reading keeps single-type buffer boundaries") {
+    osmium::io::Reader reader{with_data_dir("t/io/data-n5w1r3.osm"),
+                              osmium::io::buffers_type::single,
+                              osmium::io::coalesce_buffers{64UL * 1024UL * 1024UL}};
+
+    const osmium::memory::Buffer node_buffer = reader.read();
+    REQUIRE(node_buffer);
+    REQUIRE(node_buffer.select<osmium::Node>().size() == 5);
+
+    const osmium::memory::Buffer way_buffer = reader.read();
+    REQUIRE(way_buffer);
+    REQUIRE(way_buffer.select<osmium::Way>().size() == 1);
+
+    const osmium::memory::Buffer rel_buffer = reader.read();
+    REQUIRE(rel_buffer);
+    REQUIRE(rel_buffer.select<osmium::Relation>().size() == 3);
+
+    REQUIRE_FALSE(reader.read());
+
+    reader.close();
+}
+
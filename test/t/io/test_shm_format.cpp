@@ -0,0 +1,160 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/shm_input.hpp>
+#include <osmium/io/shm_output.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+osmium::memory::Buffer make_test_buffer() {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 64UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= 100; ++i) {
+        osmium::builder::add_node(buffer, _id(i), _location(i * 0.001, 1.0),
+                                  _tag("some_key", "some_value"));
+    }
+    osmium::builder::add_way(buffer, _id(101), _nodes({1, 2, 3}));
+
+    return buffer;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Write and read raw buffers in shm format") {
+    const std::string filename{"test-shm-format.osm.shm"};
+
+    {
+        osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+        writer(make_test_buffer());
+        writer.close();
+    }
+
+    osmium::io::Reader reader{filename};
+    int nodes = 0;
+    int ways = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            if (object.type() == osmium::item_type::node) {
+                REQUIRE(object.id() == nodes + 1);
+                REQUIRE(std::string{object.tags()["some_key"]} == "some_value");
+                ++nodes;
+            } else {
+                REQUIRE(object.id() == 101);
+                ++ways;
+            }
+        }
+    }
+    reader.close();
+
+    REQUIRE(nodes == 100);
+    REQUIRE(ways == 1);
+}
+
+TEST_CASE("Read only some entity types from shm format") {
+    const std::string filename{"test-shm-format-bits.osm.shm"};
+
+    {
+        osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+        writer(make_test_buffer());
+        writer.close();
+    }
+
+    osmium::io::Reader reader{filename, osmium::osm_entity_bits::way};
+    int count = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            REQUIRE(object.type() == osmium::item_type::way);
+            ++count;
+        }
+    }
+    reader.close();
+
+    REQUIRE(count == 1);
+}
+
+TEST_CASE("Writing filtered entities to shm format") {
+    const std::string filename{"test-shm-format-filter.osm.shm"};
+
+    {
+        const osmium::io::output_filter filter{[](const osmium::OSMEntity& entity) {
+            return static_cast<const osmium::OSMObject&>(entity).id() % 2 == 0;
+        }};
+        osmium::io::Writer writer{filename, osmium::io::overwrite::allow, filter};
+        writer(make_test_buffer());
+        writer.close();
+    }
+
+    osmium::io::Reader reader{filename};
+    int count = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            REQUIRE(object.id() % 2 == 0);
+            ++count;
+        }
+    }
+    reader.close();
+
+    REQUIRE(count == 50);
+}
+
+TEST_CASE("Reader rejects files not in shm format") {
+    REQUIRE_THROWS_AS(osmium::io::read_file(osmium::io::File{with_data_dir("t/io/data.osm"), "shm"}),
+                      osmium::io_error);
+}
+
+TEST_CASE("The 'blob' format is an alias for the shm format") {
+    const std::string filename{"test-blob-format.osm.blob"};
+
+    {
+        osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+        writer(make_test_buffer());
+        writer.close();
+    }
+
+    osmium::io::Reader reader{filename};
+    int count = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        count += static_cast<int>(buffer.select<osmium::OSMObject>().size());
+    }
+    reader.close();
+
+    REQUIRE(count == 101);
+}
+
+TEST_CASE("Writer rejects unknown shm_compression values") {
+    const osmium::io::File file{"test-shm-format-badopt.osm.shm", "shm,shm_compression=deflate"};
+    REQUIRE_THROWS_AS(osmium::io::Writer(file, osmium::io::overwrite::allow),
+                      std::invalid_argument);
+}
+
+#ifdef OSMIUM_WITH_LZ4
+TEST_CASE("Write and read lz4-compressed records in shm format") {
+    const osmium::io::File file{"test-shm-format-lz4.osm.shm", "shm,shm_compression=lz4"};
+
+    {
+        osmium::io::Writer writer{file, osmium::io::overwrite::allow};
+        writer(make_test_buffer());
+        writer.close();
+    }
+
+    osmium::io::Reader reader{file};
+    int count = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        count += static_cast<int>(buffer.select<osmium::OSMObject>().size());
+    }
+    reader.close();
+
+    REQUIRE(count == 101);
+}
+#endif
@@ -0,0 +1,39 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/string_pool.hpp>
+
+#include <string>
+
+TEST_CASE("String pool reuses the memory of returned strings") {
+    auto& pool = osmium::io::detail::StringPool::instance();
+
+    std::string str;
+    str.reserve(10000);
+    str.append(100, 'x');
+    pool.put(std::move(str));
+
+    // The pool is shared, so other strings might come out first.
+    bool found = false;
+    for (int i = 0; i < 40; ++i) {
+        const std::string reused{pool.get()};
+        if (reused.capacity() >= 10000) {
+            found = true;
+            REQUIRE(reused.empty());
+            break;
+        }
+        if (reused.capacity() == 0) {
+            break; // pool is empty
+        }
+    }
+    REQUIRE(found);
+}
+
+TEST_CASE("String pool always hands out empty strings") {
+    auto& pool = osmium::io::detail::StringPool::instance();
+
+    // Small strings are not worth keeping, must not crash.
+    pool.put(std::string{"abc"});
+
+    const std::string str{pool.get()};
+    REQUIRE(str.empty());
+}
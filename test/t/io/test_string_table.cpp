@@ -109,6 +109,29 @@ TEST_CASE("Add empty string to StringTable") {
     REQUIRE(st.size() == 2);
 }
 
+TEST_CASE("StringTable hash table grows and keeps ids stable") {
+    osmium::io::detail::StringTable st;
+
+    const auto initial_bucket_count = st.get_bucket_count();
+
+    const int n = 1000;
+    for (int i = 0; i < n; ++i) {
+        const auto s = std::to_string(i);
+        REQUIRE(st.add(s.c_str()) == i + 1);
+    }
+
+    REQUIRE(st.get_bucket_count() > initial_bucket_count);
+
+    // Adding the same strings again must return the same ids even
+    // after the hash table has grown.
+    for (int i = 0; i < n; ++i) {
+        const auto s = std::to_string(i);
+        REQUIRE(st.add(s.c_str()) == i + 1);
+    }
+
+    REQUIRE(st.size() == n + 1);
+}
+
 TEST_CASE("Lots of strings in string table so chunk overflows") {
     osmium::io::detail::StringTable st{100};
     REQUIRE(st.size() == 1);
@@ -129,3 +152,61 @@ TEST_CASE("Lots of strings in string table so chunk overflows") {
     REQUIRE(it == st.end());
 }
 
+TEST_CASE("Cleared StringStore keeps its chunks and reuses them") {
+    osmium::io::detail::StringStore ss{100};
+
+    for (int i = 0; i < 100; ++i) {
+        ss.add("the quick brown fox");
+    }
+    const auto chunk_count = ss.get_chunk_count();
+    REQUIRE(chunk_count > 1);
+
+    ss.clear();
+    REQUIRE(ss.begin() == ss.end());
+    REQUIRE(ss.get_chunk_count() == chunk_count);
+
+    const char* s1 = ss.add("foo");
+    const char* s2 = ss.add("bar");
+    REQUIRE(std::string{s1} == "foo");
+    REQUIRE(std::string{s2} == "bar");
+
+    auto it = ss.begin();
+    REQUIRE(std::string{*it++} == "foo");
+    REQUIRE(std::string{*it++} == "bar");
+    REQUIRE(it == ss.end());
+
+    // refilling must not allocate more chunks than the first round
+    ss.clear();
+    for (int i = 0; i < 100; ++i) {
+        ss.add("the quick brown fox");
+    }
+    REQUIRE(ss.get_chunk_count() == chunk_count);
+}
+
+TEST_CASE("Cleared StringTable can be filled again") {
+    osmium::io::detail::StringTable st{100};
+
+    for (int i = 0; i < 100; ++i) {
+        const auto s = std::to_string(i);
+        st.add(s.c_str());
+    }
+    const auto bucket_count = st.get_bucket_count();
+    const auto chunk_count = st.get_chunk_count();
+
+    st.clear();
+    REQUIRE(st.size() == 1);
+    REQUIRE(st.get_bucket_count() == bucket_count);
+    REQUIRE(st.get_chunk_count() == chunk_count);
+
+    REQUIRE(st.add("foo") == 1);
+    REQUIRE(st.add("bar") == 2);
+    REQUIRE(st.add("foo") == 1);
+    REQUIRE(st.size() == 3);
+
+    auto it = st.begin();
+    REQUIRE(std::string{} == *it++);
+    REQUIRE(std::string{*it++} == "foo");
+    REQUIRE(std::string{*it++} == "bar");
+    REQUIRE(it == st.end());
+}
+
@@ -0,0 +1,77 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/triple_writer.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/io/xml_output.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <string>
+#include <utility>
+
+namespace {
+
+osmium::memory::Buffer make_mixed_buffer() {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 64UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= 10; ++i) {
+        osmium::builder::add_node(buffer, _id(i), _location(i * 0.001, 1.0));
+        osmium::builder::add_way(buffer, _id(i), _nodes({1, 2, 3}));
+    }
+    osmium::builder::add_relation(buffer, _id(1), _member(osmium::item_type::way, 1));
+
+    return buffer;
+}
+
+int count_objects_of_type(const std::string& filename, const osmium::item_type type) {
+    osmium::io::Reader reader{filename};
+    int count = 0;
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            REQUIRE(object.type() == type);
+            ++count;
+        }
+    }
+    reader.close();
+    return count;
+}
+
+} // anonymous namespace
+
+TEST_CASE("TripleWriter splits objects by type in one pass") {
+    const std::string nodes_file{"test-triple-nodes.osm"};
+    const std::string ways_file{"test-triple-ways.osm"};
+    const std::string relations_file{"test-triple-relations.osm"};
+
+    osmium::io::TripleWriter writer{nodes_file, ways_file, relations_file,
+                                    osmium::io::overwrite::allow};
+    writer(make_mixed_buffer());
+    const auto written = writer.close();
+    REQUIRE(written > 0);
+
+    REQUIRE(count_objects_of_type(nodes_file, osmium::item_type::node) == 10);
+    REQUIRE(count_objects_of_type(ways_file, osmium::item_type::way) == 10);
+    REQUIRE(count_objects_of_type(relations_file, osmium::item_type::relation) == 1);
+}
+
+TEST_CASE("TripleWriter writing single objects") {
+    const std::string nodes_file{"test-triple-single-nodes.osm"};
+    const std::string ways_file{"test-triple-single-ways.osm"};
+    const std::string relations_file{"test-triple-single-relations.osm"};
+
+    const osmium::memory::Buffer buffer = make_mixed_buffer();
+
+    osmium::io::TripleWriter writer{nodes_file, ways_file, relations_file,
+                                    osmium::io::overwrite::allow};
+    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+        writer(object);
+    }
+    writer.close();
+
+    REQUIRE(count_objects_of_type(nodes_file, osmium::item_type::node) == 10);
+    REQUIRE(count_objects_of_type(ways_file, osmium::item_type::way) == 10);
+    REQUIRE(count_objects_of_type(relations_file, osmium::item_type::relation) == 1);
+}
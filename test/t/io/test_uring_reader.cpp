@@ -0,0 +1,82 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/detail/uring_reader.hpp>
+
+#include <string>
+
+#ifdef OSMIUM_WITH_IO_URING
+
+namespace {
+
+std::string read_all(osmium::io::detail::UringReader& reader) {
+    std::string result;
+    for (std::string data = reader.read(); !data.empty(); data = reader.read()) {
+        result += data;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE("UringReader reads file contents in order") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    std::string content;
+    for (int n = 0; n < 10000; ++n) {
+        content += std::to_string(n);
+        content += ',';
+    }
+    osmium::io::detail::reliable_write(fd, content.data(), content.size());
+
+    {
+        osmium::io::detail::UringReader reader{fd, 4096};
+        if (!reader.is_open()) {
+            // io_uring not available on this machine
+            return;
+        }
+        REQUIRE(read_all(reader) == content);
+    }
+
+    osmium::io::detail::reliable_close(fd);
+}
+
+TEST_CASE("UringReader with file size a multiple of the buffer size") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    const std::string content(2 * 4096, 'x');
+    osmium::io::detail::reliable_write(fd, content.data(), content.size());
+
+    {
+        osmium::io::detail::UringReader reader{fd, 4096};
+        if (!reader.is_open()) {
+            return;
+        }
+        REQUIRE(read_all(reader) == content);
+    }
+
+    osmium::io::detail::reliable_close(fd);
+}
+
+TEST_CASE("UringReader on an empty file") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    {
+        osmium::io::detail::UringReader reader{fd, 4096};
+        if (!reader.is_open()) {
+            return;
+        }
+        REQUIRE(reader.read().empty());
+        REQUIRE(reader.read().empty());
+    }
+
+    osmium::io::detail::reliable_close(fd);
+}
+
+#else
+
+TEST_CASE("io_uring is not available on this platform") {
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/varint_decoder.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+void append_sint64_deltas(std::string& data, const std::vector<int64_t>& values) {
+    int64_t last = 0;
+    for (const auto value : values) {
+        protozero::add_varint_to_buffer(&data, protozero::encode_zigzag64(value - last));
+        last = value;
+    }
+}
+
+std::vector<int64_t> roundtrip(const std::vector<int64_t>& values) {
+    std::string data;
+    append_sint64_deltas(data, values);
+
+    std::vector<int64_t> result;
+    osmium::io::detail::decode_packed_sint64_deltas(protozero::data_view{data.data(), data.size()}, result);
+    return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE("count_plain_varint_run") {
+    const std::string all_plain(100, '\x01');
+    REQUIRE(osmium::io::detail::count_plain_varint_run(all_plain.data(), all_plain.data() + all_plain.size()) == 100);
+
+    std::string mixed = all_plain;
+    mixed[37] = '\x81';
+    REQUIRE(osmium::io::detail::count_plain_varint_run(mixed.data(), mixed.data() + mixed.size()) == 37);
+
+    mixed[0] = '\x81';
+    REQUIRE(osmium::io::detail::count_plain_varint_run(mixed.data(), mixed.data() + mixed.size()) == 0);
+
+    REQUIRE(osmium::io::detail::count_plain_varint_run(mixed.data(), mixed.data()) == 0);
+}
+
+TEST_CASE("decode empty packed field") {
+    REQUIRE(roundtrip({}).empty());
+}
+
+TEST_CASE("decode packed deltas with small values") {
+    const std::vector<int64_t> values{0, 1, -1, 17, 16, 16, -63, 0};
+    REQUIRE(roundtrip(values) == values);
+}
+
+TEST_CASE("decode packed deltas with large jumps between values") {
+    const std::vector<int64_t> values{123456789, 123456790, -5000000000LL, 0, 9000000000000LL};
+    REQUIRE(roundtrip(values) == values);
+}
+
+TEST_CASE("decode packed deltas with long runs of single-byte varints") {
+    std::vector<int64_t> values;
+    int64_t v = 1000;
+    for (int i = 0; i < 1000; ++i) {
+        v += (i % 127) - 63;
+        values.push_back(v);
+        if (i % 100 == 99) {
+            v += 100000; // force a multi-byte varint in between
+            values.push_back(v);
+        }
+    }
+    REQUIRE(roundtrip(values) == values);
+}
+
+TEST_CASE("decode packed deltas throws on truncated varint") {
+    std::string data;
+    protozero::add_varint_to_buffer(&data, protozero::encode_zigzag64(100000));
+    data.resize(data.size() - 1);
+
+    std::vector<int64_t> result;
+    REQUIRE_THROWS(osmium::io::detail::decode_packed_sint64_deltas(protozero::data_view{data.data(), data.size()}, result));
+}
@@ -0,0 +1,67 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/varint_encoder.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string reference_encode(const std::vector<int64_t>& values) {
+    std::string data;
+    for (const auto value : values) {
+        protozero::add_varint_to_buffer(&data, protozero::encode_zigzag64(value));
+    }
+    return data;
+}
+
+} // anonymous namespace
+
+TEST_CASE("varint_length") {
+    REQUIRE(osmium::io::detail::varint_length(0) == 1);
+    REQUIRE(osmium::io::detail::varint_length(1) == 1);
+    REQUIRE(osmium::io::detail::varint_length(127) == 1);
+    REQUIRE(osmium::io::detail::varint_length(128) == 2);
+    REQUIRE(osmium::io::detail::varint_length(16383) == 2);
+    REQUIRE(osmium::io::detail::varint_length(16384) == 3);
+    REQUIRE(osmium::io::detail::varint_length(std::numeric_limits<uint64_t>::max()) == 10);
+}
+
+TEST_CASE("encode empty packed field") {
+    REQUIRE(osmium::io::detail::encode_packed_svarint(std::vector<int64_t>{}).empty());
+}
+
+TEST_CASE("encode packed svarints with small values") {
+    const std::vector<int64_t> values{0, 1, -1, 17, 16, 16, -63, 0};
+    REQUIRE(osmium::io::detail::encode_packed_svarint(values) == reference_encode(values));
+}
+
+TEST_CASE("encode packed svarints with large values") {
+    const std::vector<int64_t> values{123456789, -5000000000LL, 9000000000000LL,
+                                      std::numeric_limits<int64_t>::min(),
+                                      std::numeric_limits<int64_t>::max()};
+    REQUIRE(osmium::io::detail::encode_packed_svarint(values) == reference_encode(values));
+}
+
+TEST_CASE("encode long run of single-byte svarints") {
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < 1000; ++i) {
+        values.push_back((i % 127) - 63);
+    }
+    values.push_back(1LL << 40);
+    REQUIRE(osmium::io::detail::encode_packed_svarint(values) == reference_encode(values));
+}
+
+TEST_CASE("encode packed svarints with 32-bit values") {
+    const std::vector<int32_t> values{0, -1, 1000000, std::numeric_limits<int32_t>::min()};
+
+    std::string expected;
+    for (const auto value : values) {
+        protozero::add_varint_to_buffer(&expected, protozero::encode_zigzag32(value));
+    }
+    REQUIRE(osmium::io::detail::encode_packed_svarint(values) == expected);
+}
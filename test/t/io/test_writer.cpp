@@ -2,16 +2,21 @@
 
 #include "utils.hpp"
 
+#include <osmium/builder/attr.hpp>
 #include <osmium/io/any_compression.hpp>
 #include <osmium/io/output_iterator.hpp>
 #include <osmium/io/xml_input.hpp>
 #include <osmium/io/xml_output.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+#include <osmium/util/file.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <iterator>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 
 static osmium::memory::Buffer get_buffer() {
@@ -87,6 +92,41 @@ TEST_CASE("Writer: Successful writes writing buffer") {
     REQUIRE(buffer_check.select<osmium::OSMObject>().cbegin()->id() == 1);
 }
 
+TEST_CASE("Writer: Buffers are released into buffer pool after writing") {
+    const int count = count_fds();
+
+    const auto data = get_and_check_buffer();
+    const auto num = data.select<osmium::OSMObject>().size();
+
+    osmium::memory::BufferPool pool{1024};
+
+    osmium::memory::Buffer buffer = pool.acquire();
+    for (const auto& item : data) {
+        buffer.add_item(item);
+        buffer.commit();
+    }
+
+    const std::string filename = "test-writer-out-buffer-pool.osm";
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow, pool};
+    writer(std::move(buffer));
+    writer.close();
+
+    // The buffer is released into the pool when the encoding task is
+    // destroyed which can happen slightly after close() returns.
+    for (int i = 0; i < 100 && pool.size() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    REQUIRE(pool.size() == 1);
+
+    REQUIRE(count == count_fds());
+
+    osmium::io::Reader reader_check{filename};
+    const osmium::memory::Buffer buffer_check = reader_check.read();
+    REQUIRE(buffer_check);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().size() == num);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().cbegin()->id() == 1);
+}
+
 TEST_CASE("Writer: Successful writes writing items") {
     const int count = count_fds();
 
@@ -138,6 +178,90 @@ TEST_CASE("Writer: Successful writes using output iterator") {
     REQUIRE(buffer_check.select<osmium::OSMObject>().cbegin()->id() == 1);
 }
 
+TEST_CASE("Writer: Re-chunking small buffers") {
+    const int count = count_fds();
+
+    auto buffer = get_buffer();
+
+    const auto num = std::distance(buffer.select<osmium::OSMObject>().cbegin(), buffer.select<osmium::OSMObject>().cend());
+    REQUIRE(num > 0);
+
+    const std::string filename = "test-writer-out-rechunk.osm";
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow, osmium::io::rechunk::yes};
+
+    // hand every item to the writer in its own little buffer
+    for (const auto& item : buffer) {
+        osmium::memory::Buffer small_buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+        small_buffer.push_back(item);
+        small_buffer.commit();
+        writer(std::move(small_buffer));
+    }
+    writer.close();
+
+    REQUIRE(count == count_fds());
+
+    osmium::io::Reader reader_check{filename};
+    const osmium::memory::Buffer buffer_check = reader_check.read();
+    REQUIRE(buffer_check);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().size() == static_cast<std::size_t>(num));
+    REQUIRE(buffer_check.select<osmium::OSMObject>().cbegin()->id() == 1);
+}
+
+TEST_CASE("Writer: Output filter") {
+    const int count = count_fds();
+
+    osmium::memory::Buffer buffer{1024 * 1024};
+    for (int i = 1; i <= 100; ++i) {
+        osmium::builder::add_node(buffer,
+            osmium::builder::attr::_id(i),
+            osmium::builder::attr::_location(osmium::Location{1.0, 2.0}));
+    }
+
+    const std::string filename = "test-writer-out-filter.osm";
+    const osmium::io::output_filter filter{[](const osmium::OSMEntity& entity) {
+        return static_cast<const osmium::OSMObject&>(entity).id() % 2 == 0;
+    }};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow, filter};
+    writer(std::move(buffer));
+    writer.close();
+
+    REQUIRE(count == count_fds());
+
+    osmium::io::Reader reader_check{filename};
+    const osmium::memory::Buffer buffer_check = reader_check.read();
+    REQUIRE(buffer_check);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().size() == 50);
+    for (const auto& object : buffer_check.select<osmium::OSMObject>()) {
+        REQUIRE(object.id() % 2 == 0);
+    }
+}
+
+TEST_CASE("Writer: Preallocated output file") {
+    const int count = count_fds();
+
+    auto buffer = get_and_check_buffer();
+
+    const auto num = std::distance(buffer.select<osmium::OSMObject>().cbegin(), buffer.select<osmium::OSMObject>().cend());
+
+    const std::string filename = "test-writer-out-preallocate.osm";
+    osmium::io::Writer writer{filename,
+                              osmium::io::overwrite::allow,
+                              osmium::io::preallocated_size{10UL * 1024UL * 1024UL}};
+    writer(std::move(buffer));
+    const auto written = writer.close();
+
+    REQUIRE(count == count_fds());
+
+    // the hint must not inflate the resulting file
+    REQUIRE(osmium::file_size(filename) == written);
+
+    osmium::io::Reader reader_check{filename};
+    const osmium::memory::Buffer buffer_check = reader_check.read();
+    REQUIRE(buffer_check);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().size() == static_cast<std::size_t>(num));
+    REQUIRE(buffer_check.select<osmium::OSMObject>().cbegin()->id() == 1);
+}
+
 TEST_CASE("Writer: Interrupted writer after open") {
     const int count = count_fds();
 
@@ -0,0 +1,65 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/xml_input_format.hpp>
+
+#include <string>
+
+using osmium::io::detail::XMLChunkSplitter;
+
+TEST_CASE("XMLChunkSplitter finds object boundaries") {
+    XMLChunkSplitter splitter;
+
+    const std::string data{"<osm version=\"0.6\">\n"
+                           "  <node id=\"1\" lon=\"1\" lat=\"1\"/>\n"
+                           "  <way id=\"2\"><nd ref=\"1\"/></way>\n"
+                           "  <relation id=\"3\"></relation>\n"
+                           "</osm>\n"};
+    splitter.append(data);
+    splitter.scan(true);
+
+    REQUIRE(splitter.has_boundary());
+    REQUIRE(splitter.first_boundary() == data.find("<node"));
+
+    const std::string prefix = splitter.extract(splitter.first_boundary());
+    REQUIRE(prefix == "<osm version=\"0.6\">\n  ");
+
+    REQUIRE(splitter.has_boundary());
+    REQUIRE(splitter.first_boundary() == 0);
+    REQUIRE(splitter.cut_point(1) == (data.find("<way") - prefix.size()));
+}
+
+TEST_CASE("XMLChunkSplitter ignores tags in comments and CDATA sections") {
+    XMLChunkSplitter splitter;
+
+    splitter.append("<osm><!-- <node id=\"1\"> --><foo><![CDATA[ <way id=\"2\"> ]]></foo>");
+    splitter.scan(true);
+    REQUIRE_FALSE(splitter.has_boundary());
+
+    splitter.append("<node id=\"3\"/></osm>");
+    splitter.scan(true);
+    REQUIRE(splitter.has_boundary());
+}
+
+TEST_CASE("XMLChunkSplitter handles constructs split between reads") {
+    XMLChunkSplitter splitter;
+
+    splitter.append("<osm><!-- <n");
+    splitter.scan(false);
+    splitter.append("ode> --><nod");
+    splitter.scan(false);
+    REQUIRE_FALSE(splitter.has_boundary());
+    splitter.append("e id=\"1\"/></osm>");
+    splitter.scan(true);
+
+    REQUIRE(splitter.has_boundary());
+    REQUIRE(splitter.cut_point(1000) == static_cast<std::size_t>(XMLChunkSplitter::no_cut));
+}
+
+TEST_CASE("XMLChunkSplitter does not match other element names") {
+    XMLChunkSplitter splitter;
+
+    splitter.append("<osm><nodes/><wayne/><relations-x/></osm>");
+    splitter.scan(true);
+
+    REQUIRE_FALSE(splitter.has_boundary());
+}
@@ -0,0 +1,182 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/zstd_compression.hpp>
+
+#include <string>
+
+TEST_CASE("Empty zstd-compressed file") {
+    const int count = count_fds();
+
+    const std::string input_file = with_data_dir("t/io/empty_file");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    osmium::io::ZstdDecompressor decomp{fd};
+    REQUIRE(decomp.read().empty());
+    decomp.close();
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Read zstd-compressed file") {
+    const int count = count_fds();
+
+    const std::string input_file = with_data_dir("t/io/data_zstd.txt.zst");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    size_t size = 0;
+    std::string all;
+    {
+        osmium::io::ZstdDecompressor decomp{fd};
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            size += data.size();
+            all += data;
+        }
+        decomp.close();
+    }
+
+    REQUIRE(size >= 9);
+    all.resize(8);
+    REQUIRE("TESTDATA" == all);
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Read zstd-compressed file without explicit close") {
+    const int count = count_fds();
+
+    const std::string input_file = with_data_dir("t/io/data_zstd.txt.zst");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    size_t size = 0;
+    std::string all;
+    {
+        osmium::io::ZstdDecompressor decomp{fd};
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            size += data.size();
+            all += data;
+        }
+    }
+
+    REQUIRE(size >= 9);
+    all.resize(8);
+    REQUIRE("TESTDATA" == all);
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Read zstd-compressed file with multiple concatenated frames") {
+    const int count = count_fds();
+
+    const std::string input_file = with_data_dir("t/io/data_zstd_multiframe.txt.zst");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    std::string all;
+    {
+        osmium::io::ZstdDecompressor decomp{fd};
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            all += data;
+        }
+        decomp.close();
+    }
+
+    REQUIRE(all == "TESTDATA\nTESTDATA\n");
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Corrupted zstd-compressed file") {
+    const int count = count_fds();
+
+    const std::string input_file = with_data_dir("t/io/corrupt_data_zstd.txt.zst");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    {
+        osmium::io::ZstdDecompressor decomp{fd};
+        REQUIRE_THROWS_AS([&]() {
+            for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            }
+        }(), osmium::zstd_error);
+    }
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Write and read back zstd-compressed file") {
+    const int count = count_fds();
+
+    const std::string output_file = "test_zstd_out.txt.zst";
+    const int fd = osmium::io::detail::open_for_writing(output_file, osmium::io::overwrite::allow);
+    REQUIRE(fd > 0);
+
+    {
+        osmium::io::ZstdCompressor comp{fd, osmium::io::fsync::yes};
+        comp.write("foo");
+        comp.write("bar");
+        comp.close();
+        REQUIRE(comp.file_size() > 0);
+    }
+    REQUIRE(count == count_fds());
+
+    const int in_fd = osmium::io::detail::open_for_reading(output_file);
+    REQUIRE(in_fd > 0);
+
+    std::string all;
+    {
+        osmium::io::ZstdDecompressor decomp{in_fd};
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            all += data;
+        }
+        decomp.close();
+    }
+
+    REQUIRE(all == "foobar");
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Write zstd-compressed file with implicit close") {
+    const int count = count_fds();
+
+    const std::string output_file = "test_zstd_out.txt.zst";
+    const int fd = osmium::io::detail::open_for_writing(output_file, osmium::io::overwrite::allow);
+    REQUIRE(fd > 0);
+
+    {
+        osmium::io::ZstdCompressor comp{fd, osmium::io::fsync::yes};
+        comp.write("foo");
+    }
+    REQUIRE(count == count_fds());
+
+    REQUIRE(osmium::file_size(output_file) > 0);
+}
+
+TEST_CASE("Decompress zstd data from buffer") {
+    const std::string input_file = with_data_dir("t/io/data_zstd.txt.zst");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    std::string compressed(100, '\0');
+    const auto nread = osmium::io::detail::reliable_read(fd, &*compressed.begin(), static_cast<unsigned int>(compressed.size()));
+    REQUIRE(nread > 0);
+    compressed.resize(static_cast<std::string::size_type>(nread));
+    osmium::io::detail::reliable_close(fd);
+
+    std::string all;
+    {
+        osmium::io::ZstdBufferDecompressor decomp{compressed.data(), compressed.size()};
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            all += data;
+        }
+        decomp.close();
+    }
+
+    REQUIRE(all == "TESTDATA\n");
+}
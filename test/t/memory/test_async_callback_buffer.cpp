@@ -0,0 +1,103 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/async_callback_buffer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("Async callback buffer with callback triggering every time") {
+    std::atomic<int> run{0};
+    std::atomic<int> objects{0};
+
+    osmium::memory::AsyncCallbackBuffer cb{[&](osmium::memory::Buffer&& buffer){
+        REQUIRE(buffer.committed() > 0);
+        objects += static_cast<int>(std::distance(buffer.begin(), buffer.end()));
+        ++run;
+    }, 1000, 10};
+
+    osmium::builder::add_node(cb.buffer(), _id(1));
+    cb.possibly_flush();
+    osmium::builder::add_node(cb.buffer(), _id(2));
+    cb.possibly_flush();
+    osmium::builder::add_node(cb.buffer(), _id(3));
+    cb.possibly_flush();
+
+    cb.close();
+
+    REQUIRE(run == 3);
+    REQUIRE(objects == 3);
+}
+
+TEST_CASE("Async callback buffer flushes remaining data on close") {
+    std::atomic<int> objects{0};
+
+    {
+        osmium::memory::AsyncCallbackBuffer cb{[&](osmium::memory::Buffer&& buffer){
+            objects += static_cast<int>(std::distance(buffer.begin(), buffer.end()));
+        }};
+
+        for (int i = 1; i <= 100; ++i) {
+            osmium::builder::add_node(cb.buffer(), _id(i));
+            cb.possibly_flush();
+        }
+        // no explicit close(), the destructor has to flush
+    }
+
+    REQUIRE(objects == 100);
+}
+
+TEST_CASE("Async callback buffer blocks instead of growing without bound") {
+    std::atomic<int> run{0};
+
+    osmium::memory::AsyncCallbackBuffer cb{[&](osmium::memory::Buffer&& /*buffer*/){
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        ++run;
+    }, 1000, 10};
+
+    for (int i = 1; i <= 20; ++i) {
+        osmium::builder::add_node(cb.buffer(), _id(i));
+        cb.possibly_flush();
+    }
+    cb.close();
+
+    REQUIRE(run == 20);
+}
+
+TEST_CASE("Async callback buffer with max latency") {
+    std::atomic<int> run{0};
+
+    // max_buffer_size is too large to ever trigger a size-based flush
+    osmium::memory::AsyncCallbackBuffer cb{[&](osmium::memory::Buffer&& /*buffer*/){
+        ++run;
+    }, 1024UL * 1024UL, 1024UL * 1024UL, std::chrono::milliseconds{10}};
+
+    osmium::builder::add_node(cb.buffer(), _id(1));
+    cb.possibly_flush();
+    REQUIRE(run == 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    cb.possibly_flush();
+    cb.close();
+
+    REQUIRE(run == 1);
+}
+
+TEST_CASE("Async callback buffer rethrows callback exception") {
+    osmium::memory::AsyncCallbackBuffer cb{[&](osmium::memory::Buffer&& /*buffer*/){
+        throw std::runtime_error{"callback failed"};
+    }, 1000, 10};
+
+    osmium::builder::add_node(cb.buffer(), _id(1));
+    cb.flush();
+
+    // give the callback thread time to process the buffer
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+    REQUIRE_THROWS_WITH(cb.close(), "callback failed");
+}
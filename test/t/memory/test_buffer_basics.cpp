@@ -1,9 +1,14 @@
 #include "catch.hpp"
 
+#include <osmium/builder/attr.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
 
 #include <array>
+#include <iterator>
 #include <stdexcept>
+#include <utility>
 
 TEST_CASE("Buffer basics") {
     osmium::memory::Buffer invalid_buffer1;
@@ -38,6 +43,28 @@ TEST_CASE("Buffer basics") {
     REQUIRE(empty_buffer2.clear() == 0);
 }
 
+TEST_CASE("Buffer provenance") {
+    osmium::memory::Buffer buffer{1024};
+    REQUIRE_FALSE(buffer.get_provenance());
+
+    osmium::memory::Buffer::provenance provenance{};
+    provenance.source_offset = 123;
+    provenance.sequence = 7;
+    provenance.decoded_at_ns = 42;
+    buffer.set_provenance(provenance);
+
+    REQUIRE(buffer.get_provenance());
+    REQUIRE(buffer.get_provenance().source_offset == 123);
+    REQUIRE(buffer.get_provenance().sequence == 7);
+    REQUIRE(buffer.get_provenance().decoded_at_ns == 42);
+
+    // moving a buffer takes the provenance along
+    osmium::memory::Buffer other{std::move(buffer)};
+    REQUIRE(other.get_provenance());
+    REQUIRE(other.get_provenance().sequence == 7);
+    REQUIRE_FALSE(buffer.get_provenance()); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+}
+
 TEST_CASE("Buffer with zero size") {
     const osmium::memory::Buffer buffer{0};
     REQUIRE(buffer.capacity() == 64);
@@ -87,6 +114,45 @@ TEST_CASE("Reserve space in a growing buffer") {
     REQUIRE(buffer.written() == 1020);
 }
 
+TEST_CASE("Reserve capacity without adding anything to the buffer") {
+    osmium::memory::Buffer buffer{128, osmium::memory::Buffer::auto_grow::yes};
+
+    buffer.reserve(1000);
+    REQUIRE(buffer.written() == 0);
+    REQUIRE(buffer.capacity() >= 1000);
+
+    const auto capacity = buffer.capacity();
+    REQUIRE(buffer.reserve_space(1000) != nullptr);
+    REQUIRE(buffer.capacity() == capacity);
+}
+
+TEST_CASE("Reserve capacity in a non-growing buffer") {
+    osmium::memory::Buffer buffer{128, osmium::memory::Buffer::auto_grow::no};
+
+    buffer.reserve(100);
+    REQUIRE(buffer.written() == 0);
+    REQUIRE_THROWS_AS(buffer.reserve(1000), osmium::buffer_is_full);
+}
+
+TEST_CASE("Buffer with reserved address space grows without moving") {
+    osmium::memory::Buffer buffer{64, 4096};
+    REQUIRE(buffer.capacity() == 64);
+    REQUIRE(buffer.reserved_capacity() == 4096);
+
+    const auto* const data = buffer.data();
+    REQUIRE(buffer.reserve_space(1000) != nullptr);
+    REQUIRE(buffer.capacity() >= 1000);
+    REQUIRE(buffer.capacity() <= 4096);
+    REQUIRE(buffer.data() == data);
+
+    // Growing up to the reserved capacity works, beyond it doesn't.
+    REQUIRE(buffer.reserve_space(4096 - 1000) != nullptr);
+    REQUIRE(buffer.data() == data);
+    REQUIRE_THROWS_AS(buffer.reserve_space(100), osmium::buffer_is_full);
+
+    buffer.advise(osmium::util::memory_advice::willneed);
+}
+
 TEST_CASE("Create buffer from existing data with good alignment works") {
     std::array<unsigned char, 128> data = {{0}};
 
@@ -129,3 +195,44 @@ TEST_CASE("Create buffer from existing data with bad alignment fails") {
     REQUIRE_THROWS_AS(l4(), std::invalid_argument);
 }
 
+
+TEST_CASE("CommitGuard discards the object by default") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, osmium::builder::attr::_id(1));
+    const auto committed = buffer.committed();
+
+    {
+        osmium::memory::CommitGuard guard{buffer};
+        {
+            osmium::builder::NodeBuilder builder{buffer};
+            builder.set_id(2);
+            builder.set_user("foo");
+        }
+        REQUIRE(guard.get<osmium::Node>().id() == 2);
+    }
+
+    REQUIRE(buffer.committed() == committed);
+    REQUIRE(buffer.written() == committed);
+    REQUIRE(std::distance(buffer.begin(), buffer.end()) == 1);
+}
+
+TEST_CASE("CommitGuard keeps the object after commit") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    const auto committed = buffer.committed();
+
+    std::size_t offset = 0;
+    {
+        osmium::memory::CommitGuard guard{buffer};
+        {
+            osmium::builder::NodeBuilder builder{buffer};
+            builder.set_id(3);
+            builder.set_user("bar");
+        }
+        offset = guard.commit();
+    }
+
+    REQUIRE(offset == committed);
+    REQUIRE(buffer.committed() > committed);
+    REQUIRE(buffer.get<osmium::Node>(offset).id() == 3);
+    REQUIRE(std::distance(buffer.begin(), buffer.end()) == 1);
+}
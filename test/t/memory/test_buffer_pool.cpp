@@ -0,0 +1,55 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+
+#include <utility>
+
+TEST_CASE("Empty buffer pool allocates fresh buffers") {
+    osmium::memory::BufferPool pool{1024};
+    REQUIRE(pool.size() == 0);
+    REQUIRE(pool.buffer_size() == 1024);
+
+    const auto buffer = pool.acquire();
+    REQUIRE(buffer);
+    REQUIRE(buffer.capacity() >= 1024);
+    REQUIRE(buffer.committed() == 0);
+    REQUIRE(pool.size() == 0);
+}
+
+TEST_CASE("Released buffers are recycled") {
+    osmium::memory::BufferPool pool{1024};
+
+    auto buffer = pool.acquire();
+    osmium::builder::add_node(buffer, osmium::builder::attr::_id(17));
+    REQUIRE(buffer.committed() > 0);
+
+    const auto* const data = buffer.data();
+    pool.release(std::move(buffer));
+    REQUIRE(pool.size() == 1);
+
+    const auto recycled = pool.acquire();
+    REQUIRE(pool.size() == 0);
+    REQUIRE(recycled.data() == data);
+    REQUIRE(recycled.committed() == 0);
+}
+
+TEST_CASE("Releasing an invalid buffer does nothing") {
+    osmium::memory::BufferPool pool;
+
+    pool.release(osmium::memory::Buffer{});
+    REQUIRE(pool.size() == 0);
+}
+
+TEST_CASE("Pool does not grow beyond its capacity") {
+    osmium::memory::BufferPool pool{64, 2};
+
+    auto buffer1 = pool.acquire();
+    auto buffer2 = pool.acquire();
+    pool.release(std::move(buffer1));
+    pool.release(std::move(buffer2));
+    REQUIRE(pool.size() == 2);
+
+    pool.release(osmium::memory::Buffer{64, osmium::memory::Buffer::auto_grow::internal});
+    REQUIRE(pool.size() == 2);
+}
@@ -4,6 +4,7 @@
 #include <osmium/osm/node.hpp>
 
 #include <iterator>
+#include <utility>
 
 struct CallbackClass {
 
@@ -206,3 +207,91 @@ TEST_CASE("Purge buffer with three objects, all get deleted") {
     REQUIRE(std::distance(buffer.begin(), buffer.end()) == 0);
 }
 
+
+TEST_CASE("Removed-bytes counters with mark_removed") {
+    constexpr const size_t buffer_size = 10000;
+    osmium::memory::Buffer buffer{buffer_size};
+
+    {
+        osmium::builder::NodeBuilder node_builder{buffer};
+        node_builder.set_user("testuser");
+    }
+    buffer.commit();
+
+    {
+        osmium::builder::NodeBuilder node_builder{buffer};
+        node_builder.set_user("someuser");
+    }
+    buffer.commit();
+
+    REQUIRE(buffer.removed_bytes() == 0);
+    REQUIRE(buffer.live_bytes() == buffer.committed());
+
+    auto& node = *buffer.begin();
+    buffer.mark_removed(node);
+    REQUIRE(node.removed());
+    REQUIRE(buffer.removed_bytes() == node.padded_size());
+    REQUIRE(buffer.live_bytes() == buffer.committed() - node.padded_size());
+
+    // marking the same item again doesn't change the counters
+    buffer.mark_removed(node);
+    REQUIRE(buffer.removed_bytes() == node.padded_size());
+
+    buffer.purge_removed();
+    REQUIRE(buffer.removed_bytes() == 0);
+    REQUIRE(buffer.live_bytes() == buffer.committed());
+    REQUIRE(std::distance(buffer.begin(), buffer.end()) == 1);
+}
+
+TEST_CASE("Removed-bytes counters with update_removed_bytes") {
+    constexpr const size_t buffer_size = 10000;
+    osmium::memory::Buffer buffer{buffer_size};
+
+    {
+        osmium::builder::NodeBuilder node_builder{buffer};
+        node_builder.set_user("testuser");
+        node_builder.set_removed(true);
+    }
+    buffer.commit();
+
+    {
+        osmium::builder::NodeBuilder node_builder{buffer};
+        node_builder.set_user("someuser");
+    }
+    buffer.commit();
+
+    // the removed flag was set directly, so the counter doesn't know
+    // about it yet
+    REQUIRE(buffer.removed_bytes() == 0);
+
+    buffer.update_removed_bytes();
+    REQUIRE(buffer.removed_bytes() == buffer.begin()->padded_size());
+    REQUIRE(buffer.live_bytes() == buffer.committed() - buffer.begin()->padded_size());
+
+    const auto live = buffer.live_bytes();
+    buffer.purge_removed();
+    REQUIRE(buffer.committed() == live);
+    REQUIRE(buffer.removed_bytes() == 0);
+}
+
+TEST_CASE("Removed-bytes counter is reset by clear and moved with the buffer") {
+    constexpr const size_t buffer_size = 10000;
+    osmium::memory::Buffer buffer{buffer_size};
+
+    {
+        osmium::builder::NodeBuilder node_builder{buffer};
+        node_builder.set_user("testuser");
+    }
+    buffer.commit();
+
+    buffer.mark_removed(*buffer.begin());
+    REQUIRE(buffer.removed_bytes() > 0);
+
+    const auto removed = buffer.removed_bytes();
+    osmium::memory::Buffer other{std::move(buffer)};
+    REQUIRE(other.removed_bytes() == removed);
+
+    other.clear();
+    REQUIRE(other.removed_bytes() == 0);
+    REQUIRE(other.live_bytes() == 0);
+}
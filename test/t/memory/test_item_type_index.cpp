@@ -0,0 +1,65 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item_type_index.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <utility>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("Item type index on empty buffer") {
+    osmium::memory::Buffer buffer{1024};
+
+    const osmium::memory::ItemTypeIndex index{buffer};
+    REQUIRE(index.count(osmium::item_type::node) == 0);
+    REQUIRE(index.select<osmium::Node>().empty());
+}
+
+TEST_CASE("Item type index on mixed buffer") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_node(buffer, _id(1));
+    osmium::builder::add_way(buffer, _id(2));
+    osmium::builder::add_node(buffer, _id(3));
+    osmium::builder::add_relation(buffer, _id(4));
+    osmium::builder::add_node(buffer, _id(5));
+
+    const osmium::memory::ItemTypeIndex index{buffer};
+
+    REQUIRE(index.count(osmium::item_type::node) == 3);
+    REQUIRE(index.count(osmium::item_type::way) == 1);
+    REQUIRE(index.count(osmium::item_type::relation) == 1);
+    REQUIRE(index.count(osmium::item_type::changeset) == 0);
+
+    const auto nodes = index.select<osmium::Node>();
+    REQUIRE(nodes.size() == 3);
+    auto it = nodes.begin();
+    REQUIRE(it->id() == 1);
+    ++it;
+    REQUIRE(it->id() == 3);
+    ++it;
+    REQUIRE((*it).id() == 5);
+    ++it;
+    REQUIRE(it == nodes.end());
+
+    const auto ways = index.select<osmium::Way>();
+    REQUIRE(ways.size() == 1);
+    REQUIRE(ways.begin()->id() == 2);
+
+    const auto relations = index.select<osmium::Relation>();
+    REQUIRE(relations.size() == 1);
+    REQUIRE(relations.begin()->id() == 4);
+}
+
+TEST_CASE("Item type index stays valid when the buffer is moved") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_node(buffer, _id(17));
+
+    const osmium::memory::ItemTypeIndex index{buffer};
+
+    const osmium::memory::Buffer moved{std::move(buffer)};
+    REQUIRE(index.select<osmium::Node>().begin()->id() == 17);
+}
@@ -0,0 +1,82 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/shared_buffer_view.hpp>
+#include <osmium/osm/node.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+osmium::memory::Buffer fill_buffer() {
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+
+    osmium::builder::add_node(buffer, _id(1));
+    osmium::builder::add_node(buffer, _id(2));
+    osmium::builder::add_node(buffer, _id(3));
+
+    return buffer;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Invalid shared buffer view") {
+    const osmium::memory::SharedBufferView view;
+    REQUIRE_FALSE(view);
+    REQUIRE(view.use_count() == 0);
+    REQUIRE(view.committed() == 0);
+}
+
+TEST_CASE("Shared buffer view gives access to the buffer data") {
+    auto buffer = fill_buffer();
+    const auto committed = buffer.committed();
+
+    const osmium::memory::SharedBufferView view{std::move(buffer)};
+    REQUIRE(view);
+    REQUIRE(view.use_count() == 1);
+    REQUIRE(view.committed() == committed);
+
+    osmium::object_id_type id = 0;
+    for (const auto& node : view.select<osmium::Node>()) {
+        ++id;
+        REQUIRE(node.id() == id);
+    }
+    REQUIRE(id == 3);
+
+    REQUIRE(view.get<osmium::Node>(0).id() == 1);
+}
+
+TEST_CASE("Copies of a shared buffer view share the data") {
+    const osmium::memory::SharedBufferView view{fill_buffer()};
+
+    const auto copy = view; // NOLINT(performance-unnecessary-copy-initialization)
+    REQUIRE(view.use_count() == 2);
+    REQUIRE(copy.use_count() == 2);
+    REQUIRE(&copy.buffer() == &view.buffer());
+    REQUIRE(copy.cbegin() == view.cbegin());
+}
+
+TEST_CASE("Fan out a shared buffer view to several threads") {
+    const osmium::memory::SharedBufferView view{fill_buffer()};
+
+    std::vector<osmium::object_id_type> sums(4, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(sums.size());
+    for (auto& sum : sums) {
+        threads.emplace_back([&view, &sum]() {
+            for (const auto& node : view.select<osmium::Node>()) {
+                sum += node.id();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto sum : sums) {
+        REQUIRE(sum == 6);
+    }
+}
@@ -0,0 +1,83 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/slab_allocator.hpp>
+#include <osmium/osm/node.hpp>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Slab-allocated memory can be written to and freed") {
+    unsigned char* small = osmium::memory::slab_allocate(100);
+    REQUIRE(small != nullptr);
+    std::memset(small, 'x', 100);
+
+    // comes from the same slab as the first allocation
+    unsigned char* second = osmium::memory::slab_allocate(100);
+    REQUIRE(second != nullptr);
+    std::memset(second, 'y', 100);
+    REQUIRE(small[99] == 'x');
+
+    // larger than a whole slab, gets its own
+    unsigned char* large = osmium::memory::slab_allocate(4UL * 1024UL * 1024UL);
+    REQUIRE(large != nullptr);
+    std::memset(large, 'z', 4UL * 1024UL * 1024UL);
+
+    osmium::memory::slab_deallocate(small);
+    osmium::memory::slab_deallocate(large);
+    osmium::memory::slab_deallocate(second);
+}
+
+TEST_CASE("Buffer with slab allocator works like a normal buffer") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{osmium::memory::slab_allocate,
+                                  osmium::memory::slab_deallocate,
+                                  256,
+                                  osmium::memory::Buffer::auto_grow::yes};
+
+    // make the buffer grow through the allocator
+    for (int64_t id = 1; id <= 100; ++id) {
+        osmium::builder::add_node(buffer, _id(id), _location(1.02, 2.03), _tag("amenity", "restaurant"));
+    }
+
+    int64_t id = 1;
+    for (const auto& node : buffer.select<osmium::Node>()) {
+        REQUIRE(node.id() == id++);
+    }
+    REQUIRE(id == 101);
+}
+
+TEST_CASE("Slab-allocated buffers can be filled and freed on different threads") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    std::vector<osmium::memory::Buffer> buffers{10};
+
+    std::thread filler{[&buffers]() {
+        for (auto& buffer : buffers) {
+            buffer = osmium::memory::Buffer{osmium::memory::slab_allocate,
+                                            osmium::memory::slab_deallocate,
+                                            1024,
+                                            osmium::memory::Buffer::auto_grow::internal};
+            for (int64_t id = 1; id <= 200; ++id) {
+                osmium::builder::add_node(buffer, _id(id), _user("some user name"));
+            }
+        }
+    }};
+    filler.join();
+
+    // the filling thread is gone, freeing happens on this thread
+    for (auto& buffer : buffers) {
+        std::size_t count = 0;
+        for (const auto& node : buffer.select<osmium::Node>()) {
+            REQUIRE(node.id() > 0);
+            ++count;
+        }
+        // auto_grow::internal moved most nodes into nested buffers
+        REQUIRE(count > 0);
+        buffer = osmium::memory::Buffer{};
+    }
+}
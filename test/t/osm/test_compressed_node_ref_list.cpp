@@ -0,0 +1,79 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/compressed_node_ref_list.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <algorithm>
+
+TEST_CASE("Empty compressed node ref list") {
+    const osmium::CompressedNodeRefList compressed;
+
+    REQUIRE(compressed.empty());
+    REQUIRE(compressed.size() == 0);
+    REQUIRE(compressed.begin() == compressed.end());
+}
+
+TEST_CASE("Compressed node ref list") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_way(buffer, _id(1), _nodes({
+        {1000000, {3.141, 1.2}},
+        {1000001, {3.142, 1.2}},
+        {1000007, {3.142, 1.201}},
+        { 999999, {3.141, 1.201}},
+        {1000000, {3.141, 1.2}}
+    }));
+
+    const auto& way = buffer.get<osmium::Way>(0);
+    const osmium::CompressedNodeRefList compressed{way.nodes()};
+
+    REQUIRE_FALSE(compressed.empty());
+    REQUIRE(compressed.size() == way.nodes().size());
+
+    // much smaller than the 16 bytes per NodeRef in the buffer
+    REQUIRE(compressed.used_memory() < sizeof(compressed) + way.nodes().size() * 16);
+
+    REQUIRE(std::equal(compressed.begin(), compressed.end(), way.nodes().begin()));
+
+    for (std::size_t n = 0; n < compressed.size(); ++n) {
+        REQUIRE(compressed[n] == way.nodes()[n]);
+        REQUIRE(compressed[n].location() == way.nodes()[n].location());
+    }
+}
+
+TEST_CASE("Compressed node ref list with negative ids and undefined locations") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_way(buffer, _id(1), _nodes({
+        osmium::NodeRef{-17, osmium::Location{}},
+        osmium::NodeRef{  3, osmium::Location{-180.0, -90.0}},
+        osmium::NodeRef{-42, osmium::Location{ 180.0,  90.0}}
+    }));
+
+    const auto& way = buffer.get<osmium::Way>(0);
+
+    osmium::CompressedNodeRefList compressed;
+    compressed.assign(way.nodes());
+
+    REQUIRE(compressed.size() == 3);
+
+    auto it = compressed.begin();
+    REQUIRE(it->ref() == -17);
+    REQUIRE_FALSE(it->location().valid());
+    ++it;
+    REQUIRE(it->ref() == 3);
+    REQUIRE(it->location() == osmium::Location{-180.0, -90.0});
+    ++it;
+    REQUIRE((*it).ref() == -42);
+    REQUIRE(it->location() == osmium::Location{180.0, 90.0});
+    ++it;
+    REQUIRE(it == compressed.end());
+
+    compressed.clear();
+    REQUIRE(compressed.empty());
+    REQUIRE(compressed.begin() == compressed.end());
+}
@@ -0,0 +1,84 @@
+#include "catch.hpp"
+
+#include "test_crc.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/crc.hpp>
+#include <osmium/osm/crc_cache.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+
+namespace {
+
+void fill_buffer(osmium::memory::Buffer& buffer) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::builder::add_node(buffer,
+        _id(17), _version(5), _timestamp("2015-01-01T10:00:00Z"),
+        _uid(21), _user("foo"),
+        _tag("highway", "primary"),
+        _location(1.02, 2.03));
+    osmium::builder::add_way(buffer,
+        _id(18), _version(5), _timestamp("2015-01-01T10:00:00Z"),
+        _uid(21), _user("foo"),
+        _nodes({1, 2, 3}));
+}
+
+} // anonymous namespace
+
+TEST_CASE("CRC of whole buffer matches per-object updates") {
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+    fill_buffer(buffer);
+
+    osmium::CRC<crc_type> crc_sequential;
+    crc_sequential.update(buffer.get<osmium::Node>(0));
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        crc_sequential.update(way);
+    }
+
+    osmium::CRC<crc_type> crc_bulk;
+    osmium::crc_buffer(crc_bulk, buffer);
+
+    REQUIRE(crc_bulk().checksum() == crc_sequential().checksum());
+}
+
+TEST_CASE("CRC cache returns the same checksum as direct computation") {
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+    fill_buffer(buffer);
+
+    const auto& node = buffer.get<osmium::Node>(0);
+
+    osmium::CRC<crc_type> crc;
+    crc.update(node);
+
+    osmium::CRCCache<crc_type> cache;
+    REQUIRE(cache(node) == crc().checksum());
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.hits() == 0);
+
+    // second time comes from the cache
+    REQUIRE(cache(node) == crc().checksum());
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.hits() == 1);
+}
+
+TEST_CASE("CRC cache keeps separate entries per object and can be invalidated") {
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+    fill_buffer(buffer);
+
+    const auto& node = buffer.get<osmium::Node>(0);
+    const auto it = buffer.select<osmium::Way>().cbegin();
+    const auto& way = *it;
+
+    osmium::CRCCache<crc_type> cache;
+    REQUIRE(cache(node) != cache(way));
+    REQUIRE(cache.size() == 2);
+
+    cache.invalidate(node);
+    REQUIRE(cache.size() == 1);
+
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+    REQUIRE(cache.hits() == 0);
+}
@@ -0,0 +1,58 @@
+#include "catch.hpp"
+
+#include <osmium/osm/crc.hpp>
+#include <osmium/osm/crc_crc32c.hpp>
+
+#include <cstring>
+#include <string>
+
+TEST_CASE("CRC32C of known test vector") {
+    // from RFC 3720 (iSCSI)
+    osmium::CRC_crc32c crc32c;
+    crc32c.process_bytes("123456789", 9);
+    REQUIRE(crc32c.checksum() == 0xe3069283);
+}
+
+TEST_CASE("CRC32C of single bytes matches CRC32C of whole buffer") {
+    const std::string data{"the quick brown fox jumps over the lazy dog"};
+
+    osmium::CRC_crc32c crc_bytes;
+    crc_bytes.process_bytes(data.data(), data.size());
+
+    osmium::CRC_crc32c crc_byte;
+    for (const char c : data) {
+        crc_byte.process_byte(static_cast<unsigned char>(c));
+    }
+
+    REQUIRE(crc_bytes.checksum() == crc_byte.checksum());
+}
+
+TEST_CASE("Hardware CRC32C matches software implementation") {
+    std::string data;
+    for (int i = 0; i < 1000; ++i) {
+        data += static_cast<char>(i * 31 + 7);
+    }
+
+    // Different lengths so all the chunked code paths are used.
+    for (std::size_t size : {0U, 1U, 3U, 4U, 7U, 8U, 9U, 63U, 1000U}) {
+        osmium::CRC_crc32c crc;
+        crc.process_bytes(data.data(), size);
+
+        const auto sw = ~osmium::detail::crc32c_update_sw(0xffffffffUL, reinterpret_cast<const unsigned char*>(data.data()), size) & 0xffffffffUL;
+        REQUIRE(crc.checksum() == sw);
+    }
+}
+
+TEST_CASE("CRC32C of OSM data types") {
+    osmium::CRC<osmium::CRC_crc32c> crc32c;
+
+    crc32c.update_bool(true);
+    crc32c.update_int8('x');
+    crc32c.update_int32(0x01234567UL);
+    crc32c.update_int64(0x0123456789abcdefULL);
+    crc32c.update_string("foobar");
+    crc32c.update(osmium::Timestamp{"2015-07-12T13:10:46Z"});
+    crc32c.update(osmium::Location{3.46, 2.001});
+
+    REQUIRE(crc32c().checksum() != 0);
+}
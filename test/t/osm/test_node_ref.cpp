@@ -122,5 +122,25 @@ TEST_CASE("WayNodeList") {
         REQUIRE(nrl.ends_have_same_location());
     }
 
+    SECTION("Builder with skip_duplicates() drops consecutive duplicates") {
+        {
+            osmium::builder::WayNodeListBuilder builder{buffer};
+            builder.skip_duplicates();
+            builder.add_node_ref(osmium::NodeRef{1, {0.0, 0.0}});
+            builder.add_node_ref(osmium::NodeRef{1, {0.0, 0.0}}); // same id
+            builder.add_node_ref(osmium::NodeRef{2, {0.0, 0.0}}); // same location
+            builder.add_node_ref(osmium::NodeRef{3, {1.0, 1.0}});
+            builder.add_node_ref(osmium::NodeRef{1, {0.0, 0.0}}); // not consecutive, kept
+            REQUIRE(builder.duplicates_skipped() == 2);
+        }
+        buffer.commit();
+
+        const osmium::WayNodeList& nrl = buffer.get<osmium::WayNodeList>(0);
+        REQUIRE(nrl.size() == 3);
+        REQUIRE(nrl[0].ref() == 1);
+        REQUIRE(nrl[1].ref() == 3);
+        REQUIRE(nrl[2].ref() == 1);
+    }
+
 }
 
@@ -65,6 +65,63 @@ TEST_CASE("Build relation") {
     REQUIRE(crc32().checksum() == 0x2c2352e);
 }
 
+TEST_CASE("Build relation member list with interned roles") {
+    osmium::memory::Buffer buffer{10000};
+    osmium::memory::Buffer plain_buffer{10000};
+
+    {
+        osmium::builder::RelationMemberListBuilder builder{buffer};
+        builder.intern_roles();
+        builder.add_member(osmium::item_type::way, 1, "outer");
+        builder.add_member(osmium::item_type::way, 2, "outer");
+        builder.add_member(osmium::item_type::way, 3, "inner");
+        builder.add_member(osmium::item_type::way, 4, "outer");
+        builder.add_member(osmium::item_type::way, 5, "inner");
+        builder.add_member(osmium::item_type::way, 6, "");
+    }
+    buffer.commit();
+
+    {
+        osmium::builder::RelationMemberListBuilder builder{plain_buffer};
+        builder.add_member(osmium::item_type::way, 1, "outer");
+        builder.add_member(osmium::item_type::way, 2, "outer");
+        builder.add_member(osmium::item_type::way, 3, "inner");
+        builder.add_member(osmium::item_type::way, 4, "outer");
+        builder.add_member(osmium::item_type::way, 5, "inner");
+        builder.add_member(osmium::item_type::way, 6, "");
+    }
+    plain_buffer.commit();
+
+    const auto& members = buffer.get<osmium::RelationMemberList>(0);
+    REQUIRE(members.size() == 6);
+
+    const char* roles[] = {"outer", "outer", "inner", "outer", "inner", ""};
+    int n = 0;
+    for (const auto& member : members) {
+        REQUIRE(member.ref() == n + 1);
+        REQUIRE(std::string{roles[n]} == member.role());
+        ++n;
+    }
+    REQUIRE(n == 6);
+
+    // Repeated roles are stored only once.
+    const auto& plain_members = plain_buffer.get<osmium::RelationMemberList>(0);
+    REQUIRE(members.byte_size() < plain_members.byte_size());
+
+    // The references are relative, so they survive copying the member
+    // list into another buffer.
+    osmium::memory::Buffer copy_buffer{10000};
+    copy_buffer.add_item(members);
+    copy_buffer.commit();
+
+    n = 0;
+    for (const auto& member : copy_buffer.get<osmium::RelationMemberList>(0)) {
+        REQUIRE(std::string{roles[n]} == member.role());
+        ++n;
+    }
+    REQUIRE(n == 6);
+}
+
 TEST_CASE("Member role too long") {
     osmium::memory::Buffer buffer{10000};
 
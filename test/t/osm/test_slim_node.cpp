@@ -0,0 +1,80 @@
+#include "catch.hpp"
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/slim_node.hpp>
+#include <osmium/visitor.hpp>
+
+#include <iterator>
+
+TEST_CASE("Slim node is smaller than a full node") {
+    // the savings are much bigger in practice, because a full node also
+    // carries a (padded) user name and a tag list in the buffer
+    REQUIRE(sizeof(osmium::SlimNode) == 24);
+    REQUIRE(sizeof(osmium::SlimNode) < sizeof(osmium::Node));
+}
+
+TEST_CASE("Build slim node") {
+    osmium::memory::Buffer buffer{1024};
+
+    {
+        osmium::builder::SlimNodeBuilder builder{buffer};
+        builder.set_id(17).set_location(osmium::Location{3.5, -2.1});
+    }
+    buffer.commit();
+
+    const auto& node = buffer.get<osmium::SlimNode>(0);
+    REQUIRE(node.id() == 17);
+    REQUIRE(node.positive_id() == 17);
+    REQUIRE(node.location() == osmium::Location{3.5, -2.1});
+}
+
+TEST_CASE("Build slim nodes with convenience function and select them") {
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+
+    for (int i = 1; i <= 10; ++i) {
+        osmium::builder::add_slim_node(buffer, -i, osmium::Location{1.0 * i, 2.0 * i});
+    }
+
+    const auto range = buffer.select<osmium::SlimNode>();
+    REQUIRE(std::distance(range.begin(), range.end()) == 10);
+
+    int i = 1;
+    for (const auto& node : range) {
+        REQUIRE(node.id() == -i);
+        REQUIRE(node.positive_id() == static_cast<osmium::unsigned_object_id_type>(i));
+        REQUIRE(node.location() == osmium::Location(1.0 * i, 2.0 * i));
+        ++i;
+    }
+}
+
+namespace {
+
+    struct SlimNodeHandler : public osmium::handler::Handler {
+
+        int count = 0;
+        osmium::object_id_type last_id = 0;
+
+        void slim_node(const osmium::SlimNode& node) {
+            ++count;
+            last_id = node.id();
+        }
+
+    }; // struct SlimNodeHandler
+
+} // anonymous namespace
+
+TEST_CASE("Apply handler to slim nodes in buffer") {
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+
+    osmium::builder::add_slim_node(buffer, 1, osmium::Location{1.0, 1.0});
+    osmium::builder::add_slim_node(buffer, 2, osmium::Location{2.0, 2.0});
+    osmium::builder::add_slim_node(buffer, 3, osmium::Location{3.0, 3.0});
+
+    SlimNodeHandler handler;
+    osmium::apply(buffer.begin<osmium::memory::Item>(), buffer.end<osmium::memory::Item>(), handler);
+
+    REQUIRE(handler.count == 3);
+    REQUIRE(handler.last_id == 3);
+}
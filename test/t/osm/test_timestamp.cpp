@@ -190,3 +190,27 @@ TEST_CASE("Invalid timestamps") {
     REQUIRE_THROWS_AS(osmium::Timestamp{"2000-03-01T00:00:00.@"}, std::invalid_argument);
 }
 
+
+TEST_CASE("Timestamp can be written into a buffer") {
+    char buffer[osmium::Timestamp::max_length];
+
+    const osmium::Timestamp t{"2016-02-29T23:59:60Z"};
+    REQUIRE(std::string(buffer, t.to_iso(buffer)) == "2016-03-01T00:00:00Z");
+    REQUIRE(std::string(buffer, t.to_iso_all(buffer)) == "2016-03-01T00:00:00Z");
+
+    const osmium::Timestamp invalid{};
+    REQUIRE(invalid.to_iso(buffer) == buffer);
+    REQUIRE(std::string(buffer, invalid.to_iso_all(buffer)) == "1970-01-01T00:00:00Z");
+}
+
+TEST_CASE("Roundtrip for a range of timestamps") {
+    char buffer[osmium::Timestamp::max_length];
+
+    // about every three weeks from 1970 to 2106
+    for (uint64_t sse = 86400; sse < 0xffffffffULL; sse += 1812343) {
+        const osmium::Timestamp t{sse};
+        const std::string iso{buffer, t.to_iso(buffer)};
+        REQUIRE(iso == t.to_iso());
+        REQUIRE(osmium::Timestamp{iso} == t);
+    }
+}
@@ -3,6 +3,8 @@
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/types_from_string.hpp>
 
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 
 TEST_CASE("set ID from string") {
@@ -20,6 +22,19 @@ TEST_CASE("set ID from string") {
     REQUIRE_THROWS_AS(osmium::string_to_object_id("12345678901234567890"), std::range_error);
 }
 
+TEST_CASE("set large ID from string") {
+    // more than eight digits, so these are parsed in SWAR batches
+    REQUIRE(osmium::string_to_object_id("123456789") == 123456789);
+    REQUIRE(osmium::string_to_object_id("-9151314442816847239") == -9151314442816847239LL);
+    REQUIRE(osmium::string_to_object_id("9223372036854775807") == std::numeric_limits<int64_t>::max());
+    REQUIRE(osmium::string_to_object_id("-9223372036854775808") == std::numeric_limits<int64_t>::min());
+
+    REQUIRE_THROWS_AS(osmium::string_to_object_id("9223372036854775808"), std::range_error);
+    REQUIRE_THROWS_AS(osmium::string_to_object_id("-9223372036854775809"), std::range_error);
+    REQUIRE_THROWS_AS(osmium::string_to_object_id("123456789012345678901234567890"), std::range_error);
+    REQUIRE_THROWS_AS(osmium::string_to_object_id("1234567890123456789x"), std::range_error);
+}
+
 TEST_CASE("set type and ID from string") {
     const auto n17 = osmium::string_to_object_id("n17", osmium::osm_entity_bits::nwr);
     REQUIRE(n17.first == osmium::item_type::node);
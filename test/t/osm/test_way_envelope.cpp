@@ -0,0 +1,76 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/way.hpp>
+
+TEST_CASE("Way envelope is computed from the node locations") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    osmium::builder::add_way(buffer, _id(1),
+                             _node(osmium::NodeRef{1, osmium::Location{1.0, 1.0}}),
+                             _node(osmium::NodeRef{2, osmium::Location{2.0, 3.0}}));
+
+    const auto& way = buffer.get<osmium::Way>(0);
+    const osmium::Box envelope = way.envelope();
+    REQUIRE(envelope.valid());
+    REQUIRE(envelope.bottom_left() == osmium::Location(1.0, 1.0));
+    REQUIRE(envelope.top_right() == osmium::Location(2.0, 3.0));
+}
+
+TEST_CASE("Stored way envelope is preferred over the node locations") {
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    {
+        osmium::builder::WayBuilder builder{buffer};
+        builder.set_id(1);
+        {
+            osmium::builder::WayNodeListBuilder wnl_builder{builder};
+            wnl_builder.add_node_ref(1, osmium::Location{1.0, 1.0});
+            wnl_builder.add_node_ref(2, osmium::Location{2.0, 3.0});
+        }
+        // deliberately different from the node locations so the test can
+        // see which one envelope() uses
+        osmium::Box box;
+        box.extend(osmium::Location{0.5, 0.5});
+        box.extend(osmium::Location{4.0, 5.0});
+        osmium::builder::WayEnvelopeBuilder{builder, box};
+    }
+    buffer.commit();
+
+    const auto& way = buffer.get<osmium::Way>(0);
+
+    bool has_stored_envelope = false;
+    for (auto it = way.cbegin(); it != way.cend(); ++it) {
+        if (it->type() == osmium::item_type::way_envelope) {
+            has_stored_envelope = true;
+        }
+    }
+    REQUIRE(has_stored_envelope);
+
+    const osmium::Box envelope = way.envelope();
+    REQUIRE(envelope.bottom_left() == osmium::Location(0.5, 0.5));
+    REQUIRE(envelope.top_right() == osmium::Location(4.0, 5.0));
+}
+
+TEST_CASE("Invalid stored way envelope falls back to the node locations") {
+    osmium::memory::Buffer buffer{1024UL * 16UL};
+    {
+        osmium::builder::WayBuilder builder{buffer};
+        builder.set_id(1);
+        {
+            osmium::builder::WayNodeListBuilder wnl_builder{builder};
+            wnl_builder.add_node_ref(1, osmium::Location{1.0, 1.0});
+        }
+        osmium::builder::WayEnvelopeBuilder{builder, osmium::Box{}};
+    }
+    buffer.commit();
+
+    const auto& way = buffer.get<osmium::Way>(0);
+    const osmium::Box envelope = way.envelope();
+    REQUIRE(envelope.valid());
+    REQUIRE(envelope.bottom_left() == osmium::Location(1.0, 1.0));
+}
@@ -171,6 +171,55 @@ TEST_CASE("Member database with duplicate member in relation") {
     }
 }
 
+TEST_CASE("Track members after prepare_for_lookup") {
+    const auto buffer = fill_buffer();
+
+    osmium::ItemStash stash;
+    osmium::relations::RelationsDatabase rdb{stash};
+    osmium::relations::MembersDatabase<osmium::Way> mdb{stash, rdb};
+
+    const auto relations = buffer.select<osmium::Relation>();
+    auto it = relations.begin();
+
+    // track only the first relation (way 10) before the sort
+    {
+        auto handle = rdb.add(*it);
+        mdb.track(handle, it->members().begin()->ref(), 0);
+    }
+
+    mdb.prepare_for_lookup();
+
+    // now interleave inserts and lookups: track the second relation
+    // (ways 11 and 12) after the sort
+    ++it;
+    {
+        auto handle = rdb.add(*it);
+        int n = 0;
+        for (const auto& member : it->members()) {
+            mdb.track(handle, member.ref(), n);
+            ++n;
+        }
+    }
+
+    REQUIRE(mdb.size() == 3);
+
+    int completed = 0;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        const bool added = mdb.add(way, [&](osmium::relations::RelationHandle& rel_handle) {
+            ++completed;
+            REQUIRE((rel_handle->id() == 20 || rel_handle->id() == 21));
+        });
+        REQUIRE(added == (way.id() <= 12));
+    }
+
+    REQUIRE(completed == 2);
+
+    // members tracked after the sort are found, too
+    const auto* way_ptr = mdb.get(11);
+    REQUIRE(way_ptr);
+    REQUIRE(way_ptr->id() == 11);
+}
+
 TEST_CASE("Remove non-existing object from members database doesn't do anything") {
     const auto buffer = fill_buffer();
 
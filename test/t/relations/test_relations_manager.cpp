@@ -218,6 +218,36 @@ TEST_CASE("Relations manager reading buffer without callback") {
     REQUIRE(manager.count_nodes == 2);
 }
 
+TEST_CASE("Relations manager in bounded-memory mode") {
+    const osmium::io::File file{with_data_dir("t/relations/data.osm")};
+
+    TestRM manager;
+    REQUIRE_FALSE(manager.bounded_memory_mode());
+    manager.set_bounded_memory_mode();
+    REQUIRE(manager.bounded_memory_mode());
+
+    osmium::relations::read_relations(file, manager);
+
+    osmium::io::Reader reader{file};
+    osmium::apply(reader, manager.handler());
+    reader.close();
+
+    // same results as without bounded-memory mode
+    REQUIRE(manager.count_new_rels      ==  3);
+    REQUIRE(manager.count_new_members   ==  5);
+    REQUIRE(manager.count_complete_rels ==  2);
+
+    // incomplete relations and their members are still available
+    int n = 0;
+    manager.for_each_incomplete_relation([&](const osmium::relations::RelationHandle& handle){
+        ++n;
+        REQUIRE(handle->id() == 31);
+    });
+    REQUIRE(n == 1);
+
+    manager.possibly_shrink_stash();
+}
+
 TEST_CASE("Access members via RelationsManager") {
     EmptyRM manager;
 
@@ -159,10 +159,103 @@ TEST_CASE("Fill item stash until it garbage collects") {
     REQUIRE(stash.size() == num_items / 10);
     REQUIRE(stash.count_removed() == num_items / 10 * 9);
 
-    // trigger compaction
+    // trigger incremental compaction
     stash.add_item(node);
 
+    REQUIRE(stash.compacting());
     REQUIRE(stash.size() == num_items / 10 + 1);
+
+    // a full garbage collect finishes the compaction
+    stash.garbage_collect();
+
+    REQUIRE_FALSE(stash.compacting());
+    REQUIRE(stash.size() == num_items / 10 + 1);
+    REQUIRE(stash.count_removed() == 0);
+}
+
+TEST_CASE("Incremental compaction keeps handles valid") {
+    const auto buffer = generate_test_data();
+
+    osmium::ItemStash stash;
+
+    std::vector<osmium::ItemStash::handle_type> handles;
+    const std::size_t num_items = 1000;
+    for (std::size_t i = 0; i < num_items; ++i) {
+        const auto& obj = buffer.get<osmium::OSMObject>(0);
+        auto handle = stash.add_item(obj);
+        handles.push_back(handle);
+    }
+
+    for (std::size_t i = 0; i < num_items; ++i) {
+        if (i % 2 == 0) {
+            stash.remove_item(handles[i]);
+        }
+    }
+
+    stash.start_compaction();
+    REQUIRE(stash.compacting());
+
+    // items are accessible while the compaction is in progress
+    std::size_t steps = 0;
+    do {
+        for (std::size_t i = 1; i < num_items; i += 2) {
+            const auto& obj = stash.get<osmium::OSMObject>(handles[i]);
+            REQUIRE(obj.id() == 1);
+        }
+        ++steps;
+    } while (stash.compact_step(100) > 0);
+
+    REQUIRE_FALSE(stash.compacting());
+    REQUIRE(steps > 1); // it really was incremental
+    REQUIRE(stash.size() == num_items / 2);
     REQUIRE(stash.count_removed() == 0);
+
+    for (std::size_t i = 1; i < num_items; i += 2) {
+        const auto& obj = stash.get<osmium::OSMObject>(handles[i]);
+        REQUIRE(obj.id() == 1);
+    }
+
+    // compact_step() without a compaction in progress does nothing
+    REQUIRE(stash.compact_step(100) == 0);
 }
 
+
+TEST_CASE("Shrink item stash to fit") {
+    const auto buffer = generate_test_data();
+
+    osmium::ItemStash stash;
+
+    const auto& node = buffer.get<osmium::Node>(0);
+
+    std::vector<osmium::ItemStash::handle_type> handles;
+    const std::size_t num_items = 100UL * 1000UL;
+    for (std::size_t i = 0; i < num_items; ++i) {
+        auto handle = stash.add_item(node);
+        handles.push_back(handle);
+    }
+
+    const auto memory_full = stash.used_memory();
+
+    for (std::size_t i = 0; i < num_items; ++i) {
+        if (i % 100 != 0) {
+            stash.remove_item(handles[i]);
+        }
+    }
+
+    stash.shrink_to_fit();
+
+    REQUIRE(stash.size() == num_items / 100);
+    REQUIRE(stash.count_removed() == 0);
+    REQUIRE(stash.used_memory() < memory_full / 2);
+
+    // the remaining items are still accessible through their handles
+    for (std::size_t i = 0; i < num_items; i += 100) {
+        const auto& obj = stash.get<osmium::OSMObject>(handles[i]);
+        REQUIRE(obj.id() == 1);
+    }
+
+    // shrinking an already small stash does nothing
+    const auto memory_small = stash.used_memory();
+    stash.shrink_to_fit();
+    REQUIRE(stash.used_memory() == memory_small);
+}
@@ -187,6 +187,51 @@ TEST_CASE("create tag list") {
     REQUIRE(std::string("Main Street") == tl["name"]);
 }
 
+TEST_CASE("tag key and value lengths") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        _tag("highway", "primary"),
+        _tag("name", ""),
+        _tag("", "x")
+    );
+    const osmium::TagList& tl = buffer.get<osmium::TagList>(pos);
+
+    auto it = tl.begin();
+    REQUIRE(it->key_length() == 7);
+    REQUIRE(it->value_length() == 7);
+    ++it;
+    REQUIRE(it->key_length() == 4);
+    REQUIRE(it->value_length() == 0);
+    ++it;
+    REQUIRE(it->key_length() == 0);
+    REQUIRE(it->value_length() == 1);
+}
+
+TEST_CASE("get values for several keys in one walk") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        _tag("highway", "primary"),
+        _tag("maxspeed", "50"),
+        _tag("name", "Main Street"),
+        _tag("surface", "asphalt")
+    );
+    const osmium::TagList& tl = buffer.get<osmium::TagList>(pos);
+
+    const char* const keys[] = {"name", "oneway", "highway"};
+    const char* values[] = {nullptr, nullptr, nullptr};
+
+    REQUIRE(tl.get_values_by_keys(keys, values, 3) == 2);
+    REQUIRE(std::string("Main Street") == values[0]);
+    REQUIRE(nullptr == values[1]);
+    REQUIRE(std::string("primary") == values[2]);
+
+    const char* no_values[] = {nullptr};
+    REQUIRE(tl.get_values_by_keys(keys + 1, no_values, 1) == 0);
+    REQUIRE(nullptr == no_values[0]);
+}
+
 TEST_CASE("empty keys and values are okay") {
     osmium::memory::Buffer buffer{10240};
 
@@ -222,3 +267,73 @@ TEST_CASE("tag key or value is too long") {
     REQUIRE_THROWS(builder.add_tag(kv, 1, kv, 1500));
 }
 
+TEST_CASE("change tag value in place if it has the same length") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        _tag("highway", "primary"),
+        _tag("name", "Main Street")
+    );
+    osmium::TagList& tl = buffer.get<osmium::TagList>(pos);
+    const auto size = tl.byte_size();
+
+    auto it = tl.begin();
+    REQUIRE(it->set_value("service"));
+    REQUIRE_FALSE(it->set_value("too long for this tag"));
+    REQUIRE_FALSE(it->set_value("short"));
+
+    REQUIRE(tl.set_value("name", "Side Street"));
+    REQUIRE_FALSE(tl.set_value("name", "Longer Street Name"));
+    REQUIRE_FALSE(tl.set_value("unknown", "x"));
+
+    REQUIRE(tl.size() == 2);
+    REQUIRE(tl.byte_size() == size);
+    REQUIRE(std::string{"service"} == tl["highway"]);
+    REQUIRE(std::string{"Side Street"} == tl["name"]);
+}
+
+TEST_CASE("change tag value in place to a shorter value") {
+    osmium::memory::Buffer buffer{10240};
+
+    // The tag list is 48 bytes long, without any padding. A value up
+    // to 7 bytes shorter keeps the padded size the same, so the edit
+    // can be done in place.
+    const auto pos1 = osmium::builder::add_tag_list(buffer,
+        _tag("highway", "primary"),
+        _tag("name", "Main Street 123456")
+    );
+    const auto pos2 = osmium::builder::add_tag_list(buffer,
+        _tag("foo", "bar")
+    );
+
+    osmium::TagList& tl = buffer.get<osmium::TagList>(pos1);
+    REQUIRE(tl.byte_size() == 48);
+
+    REQUIRE(tl.set_value("name", "Main Street"));
+
+    REQUIRE(tl.byte_size() == 41);
+    REQUIRE(tl.size() == 2);
+    REQUIRE(std::string{"primary"} == tl["highway"]);
+    REQUIRE(std::string{"Main Street"} == tl["name"]);
+
+    // the following item in the buffer is still where it was
+    const osmium::TagList& tl2 = buffer.get<osmium::TagList>(pos2);
+    REQUIRE(std::string{"bar"} == tl2["foo"]);
+}
+
+TEST_CASE("change tag value in place fails if the padded size would change") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        _tag("name", "0123456789")
+    );
+    osmium::TagList& tl = buffer.get<osmium::TagList>(pos);
+    REQUIRE(tl.byte_size() == 24);
+
+    // 9 bytes shorter would shrink the padded size from 24 to 16
+    REQUIRE_FALSE(tl.set_value("name", "0"));
+
+    REQUIRE(tl.byte_size() == 24);
+    REQUIRE(std::string{"0123456789"} == tl["name"]);
+}
+
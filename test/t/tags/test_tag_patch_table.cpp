@@ -0,0 +1,125 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/tags/tag_patch_table.hpp>
+
+#include <string>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("Edits that fit are done in place and not journaled") {
+    osmium::memory::Buffer buffer{10240};
+    const auto pos = osmium::builder::add_node(buffer,
+        _id(17),
+        _version(3),
+        _user("foo"),
+        _location(1.2, 3.4),
+        _tag("highway", "primary")
+    );
+    osmium::Node& node = buffer.get<osmium::Node>(pos);
+
+    osmium::TagPatchTable patches;
+    patches.set_value(node, "highway", "service");
+
+    REQUIRE(patches.empty());
+    REQUIRE_FALSE(patches.has_patches(node));
+    REQUIRE(std::string{"service"} == node.tags()["highway"]);
+
+    // writing an object without patches copies it verbatim
+    osmium::memory::Buffer out{10240};
+    patches.write(node, out);
+
+    const osmium::Node& copy = *out.select<osmium::Node>().cbegin();
+    REQUIRE(copy.id() == 17);
+    REQUIRE(copy.version() == 3);
+    REQUIRE(std::string{"foo"} == copy.user());
+    REQUIRE(copy.location() == node.location());
+    REQUIRE(std::string{"service"} == copy.tags()["highway"]);
+}
+
+TEST_CASE("Edits that do not fit are journaled and applied on write") {
+    osmium::memory::Buffer buffer{10240};
+    const auto pos = osmium::builder::add_node(buffer,
+        _id(17),
+        _user("foo"),
+        _tag("highway", "primary"),
+        _tag("name", "Main Street")
+    );
+    osmium::Node& node = buffer.get<osmium::Node>(pos);
+
+    osmium::TagPatchTable patches;
+    patches.set_value(node, "name", "A Much Longer Street Name");
+
+    REQUIRE(patches.size() == 1);
+    REQUIRE(patches.has_patches(node));
+    REQUIRE(std::string{"Main Street"} == node.tags()["name"]);
+
+    osmium::memory::Buffer out{10240};
+    patches.write(node, out);
+
+    const osmium::Node& copy = *out.select<osmium::Node>().cbegin();
+    REQUIRE(copy.id() == 17);
+    REQUIRE(std::string{"foo"} == copy.user());
+    REQUIRE(copy.tags().size() == 2);
+    REQUIRE(std::string{"primary"} == copy.tags()["highway"]);
+    REQUIRE(std::string{"A Much Longer Street Name"} == copy.tags()["name"]);
+
+    patches.clear();
+    REQUIRE(patches.empty());
+}
+
+TEST_CASE("A patch for a missing key adds the tag") {
+    osmium::memory::Buffer buffer{10240};
+    const auto pos = osmium::builder::add_way(buffer,
+        _id(3),
+        _user("foo"),
+        _tag("highway", "primary"),
+        _nodes({1, 2, 3})
+    );
+    const osmium::Way& way = buffer.get<osmium::Way>(pos);
+
+    osmium::TagPatchTable patches;
+    patches.add_patch(osmium::item_type::way, 3, "surface", "asphalt");
+    patches.add_patch(osmium::item_type::way, 3, "surface", "gravel");
+
+    osmium::memory::Buffer out{10240};
+    patches.write(way, out);
+
+    const osmium::Way& copy = *out.select<osmium::Way>().cbegin();
+    REQUIRE(copy.tags().size() == 2);
+    REQUIRE(std::string{"primary"} == copy.tags()["highway"]);
+    REQUIRE(std::string{"gravel"} == copy.tags()["surface"]);
+    REQUIRE(copy.nodes().size() == 3);
+    REQUIRE(copy.nodes()[1].ref() == 2);
+}
+
+TEST_CASE("Applying patches to a relation keeps the members") {
+    osmium::memory::Buffer buffer{10240};
+    const auto pos = osmium::builder::add_relation(buffer,
+        _id(5),
+        _user("foo"),
+        _tag("type", "multipolygon"),
+        _member(osmium::item_type::way, 1, "outer"),
+        _member(osmium::item_type::way, 2, "inner")
+    );
+    const osmium::Relation& relation = buffer.get<osmium::Relation>(pos);
+
+    osmium::TagPatchTable patches;
+    patches.add_patch(osmium::item_type::relation, 5, "type", "boundary_with_long_name");
+
+    osmium::memory::Buffer out{10240};
+    patches.write(relation, out);
+
+    const osmium::Relation& copy = *out.select<osmium::Relation>().cbegin();
+    REQUIRE(std::string{"boundary_with_long_name"} == copy.tags()["type"]);
+    REQUIRE(copy.members().size() == 2);
+    auto it = copy.members().begin();
+    REQUIRE(it->ref() == 1);
+    REQUIRE(std::string{"outer"} == it->role());
+    ++it;
+    REQUIRE(std::string{"inner"} == it->role());
+}
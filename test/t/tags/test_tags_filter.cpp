@@ -55,6 +55,49 @@ TEST_CASE("Tags filter") {
         REQUIRE_FALSE(filter(*std::next(tag_list2.begin())));
     }
 
+    SECTION("First matching rule wins over later exact rules") {
+        osmium::TagsFilter filter;
+        filter.add_rule(false, "highway", "primary");
+        filter.add_rule(true, "highway");
+        REQUIRE_FALSE(filter(*tag_list1.begin()));
+
+        osmium::TagsFilter filter2;
+        filter2.add_rule(true, "highway");
+        filter2.add_rule(false, "highway", "primary");
+        REQUIRE(filter2(*tag_list1.begin()));
+    }
+
+    SECTION("Mix of exact rules and wildcard rules keeps rule order") {
+        osmium::TagsFilter filter;
+        filter.add_rule(false, osmium::StringMatcher::prefix{"high"});
+        filter.add_rule(true, "highway");
+        filter.add_rule(true, osmium::StringMatcher::prefix{"nam"});
+        REQUIRE_FALSE(filter(*tag_list1.begin()));
+        REQUIRE(filter(*std::next(tag_list1.begin())));
+        REQUIRE_FALSE(filter(*std::next(tag_list1.begin(), 2)));
+    }
+
+    SECTION("Rules with inverted value matcher") {
+        osmium::TagsFilter filter;
+        filter.add_rule(true, osmium::TagMatcher{osmium::StringMatcher::equal{"highway"},
+                                                 osmium::StringMatcher::equal{"motorway"},
+                                                 true});
+        REQUIRE(filter(*tag_list1.begin()));
+        REQUIRE_FALSE(filter(*tag_list2.begin()));
+    }
+
+    SECTION("Filter with many exact rules") {
+        osmium::TagsFilter filter;
+        for (int n = 0; n < 100; ++n) {
+            filter.add_rule(true, "key" + std::to_string(n));
+            filter.add_rule(true, "tag" + std::to_string(n), "value" + std::to_string(n));
+        }
+        filter.add_rule(true, "highway", "primary");
+        REQUIRE(filter(*tag_list1.begin()));
+        REQUIRE_FALSE(filter(*tag_list2.begin()));
+        REQUIRE_FALSE(filter(*std::next(tag_list1.begin())));
+    }
+
     SECTION("KeyFilter iterator filters tags") {
         osmium::TagsFilter filter;
         filter.add_rule(true, osmium::StringMatcher::equal{"highway"})
@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include <osmium/thread/function_wrapper.hpp>
+
+#include <array>
+#include <memory>
+#include <utility>
+
+TEST_CASE("Default constructed function_wrapper is empty") {
+    const osmium::thread::function_wrapper wrapper{};
+    REQUIRE_FALSE(wrapper);
+}
+
+TEST_CASE("function_wrapper calls the wrapped function") {
+    int count = 0;
+    osmium::thread::function_wrapper wrapper{[&count]() {
+        ++count;
+    }};
+
+    REQUIRE(wrapper);
+    REQUIRE_FALSE(wrapper());
+    REQUIRE(count == 1);
+}
+
+TEST_CASE("The shutdown function_wrapper returns true") {
+    osmium::thread::function_wrapper wrapper{0};
+    REQUIRE(wrapper);
+    REQUIRE(wrapper());
+}
+
+TEST_CASE("function_wrapper can be moved") {
+    int count = 0;
+    osmium::thread::function_wrapper wrapper{[&count]() {
+        ++count;
+    }};
+
+    osmium::thread::function_wrapper moved{std::move(wrapper)};
+    REQUIRE_FALSE(wrapper); // NOLINT(bugprone-use-after-move, hicpp-invalid-access-moved)
+    REQUIRE(moved);
+    moved();
+    REQUIRE(count == 1);
+
+    osmium::thread::function_wrapper assigned;
+    assigned = std::move(moved);
+    assigned();
+    REQUIRE(count == 2);
+}
+
+namespace {
+
+struct move_only_functor {
+    std::unique_ptr<int> value;
+    int* result;
+
+    void operator()() const {
+        *result = *value;
+    }
+};
+
+} // anonymous namespace
+
+TEST_CASE("function_wrapper handles move-only functors") {
+    int result = 0;
+    osmium::thread::function_wrapper wrapper{move_only_functor{std::unique_ptr<int>{new int{42}}, &result}};
+
+    osmium::thread::function_wrapper moved{std::move(wrapper)};
+    moved();
+    REQUIRE(result == 42);
+}
+
+TEST_CASE("function_wrapper handles functors larger than the inline storage") {
+    std::array<char, 200> big{};
+    big[0] = 'x';
+    big[199] = 'y';
+
+    char first = 0;
+    char last = 0;
+    osmium::thread::function_wrapper wrapper{[big, &first, &last]() {
+        first = big[0];
+        last = big[199];
+    }};
+
+    osmium::thread::function_wrapper moved{std::move(wrapper)};
+    moved();
+    REQUIRE(first == 'x');
+    REQUIRE(last == 'y');
+}
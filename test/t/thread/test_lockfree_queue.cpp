@@ -0,0 +1,110 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/queue_util.hpp>
+#include <osmium/thread/lockfree_queue.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Basic use of lock-free queue") {
+    osmium::thread::LockfreeQueue<int> queue;
+    REQUIRE(queue.empty());
+    queue.push(22);
+    REQUIRE_FALSE(queue.empty());
+    REQUIRE(queue.size() == 1);
+    int value = 0;
+    queue.wait_and_pop(value);
+    REQUIRE(value == 22);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("Lock-free queue can have max elements and can be named") {
+    const osmium::thread::LockfreeQueue<int> queue{100, "Queue of max size 100"};
+}
+
+TEST_CASE("When lock-free queue is shut down, nothing goes in or out") {
+    osmium::thread::LockfreeQueue<std::string> queue;
+    REQUIRE(queue.in_use());
+    REQUIRE(queue.empty());
+    queue.push("foo");
+    queue.push("bar");
+    queue.push("baz");
+    REQUIRE(queue.size() == 3);
+
+    std::string value;
+
+    queue.wait_and_pop(value);
+    REQUIRE(value == "foo");
+    REQUIRE(queue.size() == 2);
+    REQUIRE(queue.in_use());
+    queue.shutdown();
+    REQUIRE_FALSE(queue.in_use());
+    REQUIRE(queue.empty());
+    queue.push("lost");
+    REQUIRE(queue.empty());
+
+    value.clear();
+    queue.try_pop(value);
+    REQUIRE(value.empty());
+    queue.wait_and_pop(value);
+    REQUIRE(value.empty());
+}
+
+TEST_CASE("Lock-free queue works with multiple producers and consumers") {
+    constexpr const int num_threads = 4;
+    constexpr const int per_thread = 10000;
+
+    osmium::thread::LockfreeQueue<int> queue{256};
+    std::atomic<long long> sum{0};
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < num_threads; ++t) {
+        consumers.emplace_back([&]() {
+            while (popped.load() < num_threads * per_thread) {
+                int value = 0;
+                if (queue.try_pop(value)) {
+                    sum += value;
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < num_threads; ++t) {
+        producers.emplace_back([&queue]() {
+            for (int i = 1; i <= per_thread; ++i) {
+                queue.push(i);
+            }
+        });
+    }
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    for (auto& thread : consumers) {
+        thread.join();
+    }
+
+    const long long expected = static_cast<long long>(num_threads) * per_thread * (per_thread + 1) / 2;
+    REQUIRE(sum == expected);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("Lock-free queue works with the queue_util helpers") {
+    osmium::io::detail::lockfree_future_queue_type<std::string> queue;
+
+    osmium::io::detail::add_to_queue(queue, std::string{"some data"});
+    osmium::io::detail::add_end_of_data_to_queue(queue);
+
+    osmium::io::detail::queue_wrapper<std::string, osmium::io::detail::lockfree_future_queue_type<std::string>> wrapper{queue};
+    REQUIRE(wrapper.pop() == "some data");
+    REQUIRE_FALSE(wrapper.has_reached_end_of_data());
+    REQUIRE(wrapper.pop().empty());
+    REQUIRE(wrapper.has_reached_end_of_data());
+}
@@ -2,8 +2,14 @@
 
 #include <osmium/thread/pool.hpp>
 
+#include <atomic>
+#include <future>
 #include <stdexcept>
 
+#ifdef __linux__
+# include <sched.h>
+#endif
+
 struct test_job_with_result {
     int operator()() const {
         return 42;
@@ -104,3 +110,59 @@ TEST_CASE("can throw from job in user provided thread pool") {
     REQUIRE_THROWS_AS(future.get(), std::runtime_error);
 }
 
+TEST_CASE("can create pool from policy") {
+    osmium::thread::PoolPolicy policy;
+    policy.num_threads = 3;
+    policy.max_queue_size = 5;
+
+    osmium::thread::Pool pool{policy};
+    REQUIRE(pool.num_threads() == 3);
+
+    auto future = pool.submit(test_job_with_result{});
+    REQUIRE(future.get() == 42);
+}
+
+#ifdef __linux__
+TEST_CASE("policy restricts pool threads to the given CPUs") {
+    osmium::thread::PoolPolicy policy;
+    policy.num_threads = 2;
+    policy.cpus = {0};
+
+    osmium::thread::Pool pool{policy};
+    auto future = pool.submit([]() {
+        return sched_getcpu();
+    });
+    REQUIRE(future.get() == 0);
+}
+#endif
+
+TEST_CASE("high-priority jobs run before queued normal-priority jobs") {
+    osmium::thread::Pool pool{1};
+
+    // Block the only worker thread so the jobs submitted below stay in
+    // the work queue until the gate is opened.
+    std::promise<void> gate;
+    const std::shared_future<void> open{gate.get_future()};
+    auto blocker = pool.submit([open]() {
+        open.wait();
+    });
+
+    std::atomic<int> order{0};
+    auto normal_future = pool.submit([&order]() {
+        return order.fetch_add(1);
+    });
+    auto high_future = pool.submit([&order]() {
+        return order.fetch_add(1);
+    }, osmium::thread::priority::high);
+
+    gate.set_value();
+    REQUIRE(high_future.get() == 0);
+    REQUIRE(normal_future.get() == 1);
+    blocker.get();
+}
+
+TEST_CASE("setting default pool policy after first use of default pool throws") {
+    osmium::thread::Pool::default_instance();
+    REQUIRE_THROWS_AS(osmium::thread::Pool::set_default_policy(osmium::thread::PoolPolicy{}), std::logic_error);
+}
+
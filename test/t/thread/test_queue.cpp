@@ -2,6 +2,11 @@
 
 #include <osmium/thread/queue.hpp>
 
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <thread>
+
 TEST_CASE("Basic use of thread-safe queue") {
     osmium::thread::Queue<int> queue;
     REQUIRE(queue.empty());
@@ -14,8 +19,129 @@ TEST_CASE("Basic use of thread-safe queue") {
     REQUIRE(queue.empty());
 }
 
+TEST_CASE("Priority elements are popped first and keep their order") {
+    osmium::thread::Queue<int> queue;
+    queue.push(1);
+    queue.push(2);
+    queue.push_priority(10);
+    queue.push_priority(11);
+    queue.push(3);
+
+    int value = 0;
+    queue.wait_and_pop(value);
+    REQUIRE(value == 10);
+    queue.wait_and_pop(value);
+    REQUIRE(value == 11);
+    queue.wait_and_pop(value);
+    REQUIRE(value == 1);
+    queue.wait_and_pop(value);
+    REQUIRE(value == 2);
+    queue.wait_and_pop(value);
+    REQUIRE(value == 3);
+    REQUIRE(queue.empty());
+}
+
 TEST_CASE("Queue can have max elements and can be named") {
     const osmium::thread::Queue<int> queue{100, "Queue of max size 100"};
+    REQUIRE(queue.max_size() == 100);
+}
+
+TEST_CASE("Queue max size can be changed while in use") {
+    osmium::thread::Queue<int> queue{4, "resizable queue"};
+    queue.push(1);
+    queue.push(2);
+    queue.set_max_size(100);
+    REQUIRE(queue.max_size() == 100);
+    REQUIRE(queue.size() == 2);
+
+    // Shrinking below the current size does not remove elements.
+    queue.set_max_size(1);
+    REQUIRE(queue.size() == 2);
+    int value = 0;
+    queue.wait_and_pop(value);
+    REQUIRE(value == 1);
+}
+
+TEST_CASE("Queue counts time spent blocked") {
+    osmium::thread::Queue<int> queue{4, "instrumented queue"};
+    REQUIRE(queue.push_wait_nanoseconds() == 0);
+    REQUIRE(queue.pop_wait_nanoseconds() == 0);
+
+    // Neither pushing into a queue with space nor popping from a
+    // non-empty queue blocks.
+    queue.push(1);
+    int value = 0;
+    queue.wait_and_pop(value);
+    REQUIRE(queue.push_wait_nanoseconds() == 0);
+    REQUIRE(queue.pop_wait_nanoseconds() == 0);
+}
+
+TEST_CASE("Queue tracks its depth high-watermark") {
+    osmium::thread::Queue<int> queue{0, "watermark queue"};
+    REQUIRE(queue.largest_size() == 0);
+
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    REQUIRE(queue.largest_size() == 3);
+
+    int value = 0;
+    queue.wait_and_pop(value);
+    queue.wait_and_pop(value);
+    REQUIRE(queue.size() == 1);
+
+    // the high-watermark does not go down again
+    REQUIRE(queue.largest_size() == 3);
+}
+
+TEST_CASE("Queue wait-time histograms count blocked operations") {
+    osmium::thread::Queue<int> queue{1, "histogram queue"};
+
+    auto histogram = queue.push_wait_histogram();
+    REQUIRE(std::accumulate(histogram.begin(), histogram.end(), std::uint64_t{0}) == 0);
+
+    queue.push(1);
+    std::thread consumer{[&queue]() {
+        int value = 0;
+        queue.wait_and_pop(value); // makes room for the blocked producer
+        queue.wait_and_pop(value);
+    }};
+    queue.push(2); // blocks until the consumer has popped
+
+    consumer.join();
+
+    histogram = queue.push_wait_histogram();
+    REQUIRE(std::accumulate(histogram.begin(), histogram.end(), std::uint64_t{0}) == 1);
+    REQUIRE(queue.push_wait_nanoseconds() > 0);
+}
+
+TEST_CASE("Live queues can be enumerated through the registry") {
+    const auto count_with_name = [](const char* name) {
+        int count = 0;
+        for (const auto& snapshot : osmium::thread::QueueRegistry::instance().snapshots()) {
+            if (snapshot.name == name) {
+                ++count;
+            }
+        }
+        return count;
+    };
+
+    REQUIRE(count_with_name("registered queue") == 0);
+    {
+        osmium::thread::Queue<int> queue{10, "registered queue"};
+        queue.push(1);
+        queue.push(2);
+        REQUIRE(count_with_name("registered queue") == 1);
+
+        for (const auto& snapshot : osmium::thread::QueueRegistry::instance().snapshots()) {
+            if (snapshot.name == "registered queue") {
+                REQUIRE(snapshot.size == 2);
+                REQUIRE(snapshot.largest_size == 2);
+                REQUIRE(snapshot.push_wait_ns == 0);
+            }
+        }
+    }
+    REQUIRE(count_with_name("registered queue") == 0);
 }
 
 TEST_CASE("When queue is shut down, nothing goes in or out") {
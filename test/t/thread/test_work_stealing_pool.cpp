@@ -0,0 +1,54 @@
+#include "catch.hpp"
+
+#include <osmium/thread/work_stealing_pool.hpp>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("work-stealing pool: configured number of threads") {
+    const osmium::thread::WorkStealingPool pool{4};
+    REQUIRE(pool.num_threads() == 4);
+}
+
+TEST_CASE("work-stealing pool: negative number of threads requested") {
+    const osmium::thread::WorkStealingPool pool{-1};
+    REQUIRE(pool.num_threads() > 0);
+}
+
+TEST_CASE("submit job to work-stealing pool") {
+    osmium::thread::WorkStealingPool pool{2};
+    auto future = pool.submit([]() {
+        return 42;
+    });
+    REQUIRE(future.get() == 42);
+}
+
+TEST_CASE("submit throwing job to work-stealing pool") {
+    osmium::thread::WorkStealingPool pool{2};
+    auto future = pool.submit([]() {
+        throw std::runtime_error{"exception in pool thread"};
+    });
+    REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+}
+
+TEST_CASE("submit many jobs to work-stealing pool") {
+    std::atomic<int> counter{0};
+
+    osmium::thread::WorkStealingPool pool{4, 8};
+    std::vector<std::future<void>> results;
+    results.reserve(1000);
+    for (int i = 0; i < 1000; ++i) {
+        results.push_back(pool.submit([&counter]() {
+            ++counter;
+        }));
+    }
+    for (auto& future : results) {
+        future.get();
+    }
+
+    REQUIRE(counter == 1000);
+    REQUIRE(pool.queue_empty());
+    REQUIRE(pool.queue_size() == 0);
+}
@@ -71,6 +71,72 @@ TEST_CASE("delta decode unsigned int") {
     REQUIRE(x.update(-15) == 12);
 }
 
+TEST_CASE("bulk delta decode") {
+    // Long enough to exercise the SIMD loop and its tail handling.
+    std::vector<int64_t> deltas;
+    for (int64_t i = 0; i < 103; ++i) {
+        deltas.push_back(i % 7 - 3);
+    }
+
+    osmium::DeltaDecode<int64_t> serial;
+    std::vector<int64_t> expected;
+    expected.reserve(deltas.size());
+    for (const int64_t d : deltas) {
+        expected.push_back(serial.update(d));
+    }
+
+    osmium::DeltaDecode<int64_t> bulk;
+    std::vector<int64_t> out(deltas.size());
+    REQUIRE(bulk.decode_n(deltas.data(), out.data(), deltas.size()) == expected.back());
+    REQUIRE(out == expected);
+    REQUIRE(bulk.value() == serial.value());
+
+    // In-place decoding is allowed.
+    osmium::DeltaDecode<int64_t> in_place;
+    in_place.decode_n(deltas.data(), deltas.data(), deltas.size());
+    REQUIRE(deltas == expected);
+}
+
+TEST_CASE("bulk delta decode with different value type") {
+    const std::vector<int64_t> deltas = {17, 10, -40, 1};
+
+    osmium::DeltaDecode<int, int64_t> x;
+    std::vector<int> out(deltas.size());
+    REQUIRE(x.decode_n(deltas.data(), out.data(), deltas.size()) == -12);
+    REQUIRE(out == (std::vector<int>{17, 27, -13, -12}));
+}
+
+TEST_CASE("bulk delta decode of zigzag encoded values") {
+    // Zigzag encoding of the deltas 17, 10, -40, 0, -1.
+    const std::vector<uint64_t> deltas = {34, 20, 79, 0, 1};
+
+    osmium::DeltaDecode<int64_t> bulk;
+    std::vector<int64_t> out(deltas.size());
+    REQUIRE(bulk.decode_n_zigzag(deltas.data(), out.data(), deltas.size()) == -14);
+    REQUIRE(out == (std::vector<int64_t>{17, 27, -13, -13, -14}));
+
+    // Continue with more data, the state carries over.
+    const std::vector<uint64_t> more = {2, 2, 2};
+    REQUIRE(bulk.decode_n_zigzag(more.data(), out.data(), more.size()) == -11);
+}
+
+TEST_CASE("bulk delta decode of many zigzag encoded values") {
+    std::vector<uint64_t> encoded;
+    std::vector<int64_t> expected;
+    int64_t value = 0;
+    for (int64_t i = 0; i < 103; ++i) {
+        const int64_t delta = i % 7 - 3;
+        encoded.push_back(static_cast<uint64_t>((delta << 1) ^ (delta >> 63)));
+        value += delta;
+        expected.push_back(value);
+    }
+
+    osmium::DeltaDecode<int64_t> bulk;
+    std::vector<int64_t> out(encoded.size());
+    REQUIRE(bulk.decode_n_zigzag(encoded.data(), out.data(), encoded.size()) == expected.back());
+    REQUIRE(out == expected);
+}
+
 TEST_CASE("delta encode and decode") {
     const std::vector<int> a = { 5, -9, 22, 13, 0, 23 };
 
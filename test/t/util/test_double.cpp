@@ -2,6 +2,8 @@
 
 #include <osmium/util/double.hpp>
 
+#include <cstddef>
+#include <cstdio>
 #include <string>
 
 TEST_CASE("Check double2string function") {
@@ -30,3 +32,61 @@ TEST_CASE("Check double2string function") {
     REQUIRE(s6 == "-0");
 }
 
+TEST_CASE("Check double2string fixed-point fast path") {
+    std::string s1;
+    osmium::double2string(s1, 3.2, 7);
+    REQUIRE(s1 == "3.2");
+
+    std::string s2;
+    osmium::double2string(s2, 214.7483647, 7);
+    REQUIRE(s2 == "214.7483647");
+
+    std::string s3;
+    osmium::double2string(s3, -214.7483648, 7);
+    REQUIRE(s3 == "-214.7483648");
+
+    std::string s4;
+    osmium::double2string(s4, 0.0000001, 7);
+    REQUIRE(s4 == "0.0000001");
+
+    std::string s5;
+    osmium::double2string(s5, 12.005, 7);
+    REQUIRE(s5 == "12.005");
+
+    std::string s6;
+    osmium::double2string(s6, 100.0, 7);
+    REQUIRE(s6 == "100");
+
+    // does not round-trip through the fixed-point format, must still
+    // round the same way snprintf() does
+    std::string s7;
+    osmium::double2string(s7, 3.14159265358979, 7);
+    REQUIRE(s7 == "3.1415927");
+}
+
+TEST_CASE("double2string output is the same in fast and generic path") {
+    const double values[] = {
+        0.0, 1.0, -1.0, 3.2, 4.2, -3.1234567, 0.0000001, -0.0000001,
+        179.9999999, -179.9999999, 214.7483647, -214.7483648,
+        0.00390625, // exactly between two fixed-point values
+        1234.5678901, 0.5, 0.05, 123456.7
+    };
+
+    for (const double value : values) {
+        std::string out;
+        osmium::double2string(out, value, 7);
+
+        char buffer[20];
+        int len = snprintf(buffer, sizeof(buffer), "%.7f", value);
+        REQUIRE(len > 0);
+        while (buffer[len - 1] == '0') {
+            --len;
+        }
+        if (buffer[len - 1] == '.') {
+            --len;
+        }
+
+        REQUIRE(out == std::string(buffer, static_cast<std::size_t>(len)));
+    }
+}
+
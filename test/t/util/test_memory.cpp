@@ -2,8 +2,46 @@
 
 #include <osmium/util/memory.hpp>
 
+#include <utility>
 #include <vector>
 
+TEST_CASE("Memory accounting counters") {
+    using ma = osmium::MemoryAccounting;
+
+    const auto base = ma::current(ma::subsystem::indexes);
+
+    ma::add(ma::subsystem::indexes, 1000);
+    REQUIRE(ma::current(ma::subsystem::indexes) == base + 1000);
+
+    ma::sub(ma::subsystem::indexes, 400);
+    REQUIRE(ma::current(ma::subsystem::indexes) == base + 600);
+    REQUIRE(ma::current_total() >= ma::current(ma::subsystem::indexes));
+
+    ma::sub(ma::subsystem::indexes, 600);
+    REQUIRE(ma::current(ma::subsystem::indexes) == base);
+}
+
+TEST_CASE("Memory accounting tracker") {
+    using ma = osmium::MemoryAccounting;
+
+    const auto base = ma::current(ma::subsystem::stashes);
+
+    {
+        ma::tracker tracker{ma::subsystem::stashes};
+        tracker.update(5000);
+        REQUIRE(ma::current(ma::subsystem::stashes) == base + 5000);
+        tracker.update(2000);
+        REQUIRE(ma::current(ma::subsystem::stashes) == base + 2000);
+
+        // Moving a tracker moves the reported amount with it.
+        ma::tracker other{std::move(tracker)};
+        REQUIRE(ma::current(ma::subsystem::stashes) == base + 2000);
+    }
+
+    // The destructor gives the reported memory back.
+    REQUIRE(ma::current(ma::subsystem::stashes) == base);
+}
+
 TEST_CASE("Check memory usage") {
 #ifdef __linux__
     const osmium::MemoryUsage m1;
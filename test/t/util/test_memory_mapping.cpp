@@ -107,6 +107,32 @@ TEST_CASE("Anonymous mapping: remapping to smaller size should work") {
     const auto* addr2 = mapping.get_addr<int>();
     REQUIRE(*addr2 == 42);
 }
+
+TEST_CASE("Anonymous mapping: transparent huge pages should work") {
+    osmium::MemoryMapping mapping{1000, osmium::MemoryMapping::mapping_mode::write_private, -1, 0, osmium::huge_pages::transparent};
+    REQUIRE(!!mapping);
+
+    auto* addr1 = mapping.get_addr<int>();
+    *addr1 = 42;
+
+    mapping.resize(8000);
+
+    const auto* addr2 = mapping.get_addr<int>();
+    REQUIRE(*addr2 == 42);
+}
+
+TEST_CASE("Anonymous mapping: hugetlb mapping should work or fall back to normal pages") {
+    osmium::MemoryMapping mapping{1000, osmium::MemoryMapping::mapping_mode::write_private, -1, 0, osmium::huge_pages::hugetlb};
+    REQUIRE(!!mapping);
+
+    auto* addr1 = mapping.get_addr<int>();
+    *addr1 = 42;
+
+    mapping.resize(8000);
+
+    const auto* addr2 = mapping.get_addr<int>();
+    REQUIRE(*addr2 == 42);
+}
 #endif
 
 TEST_CASE("File-based mapping: writing to a mapped file should work") {
@@ -145,6 +171,45 @@ TEST_CASE("File-based mapping: writing to a mapped file should work") {
     REQUIRE(0 == unlink(filename));
 }
 
+TEST_CASE("File-based mapping: advise and prefault should work") {
+    char filename[] = "test_mmap_advise_XXXXXX";
+    const int fd = mkstemp(filename);
+    REQUIRE(fd > 0);
+
+    const std::size_t size = osmium::get_pagesize() * 4;
+    osmium::resize_file(fd, size);
+
+    {
+        osmium::MemoryMapping mapping{size, osmium::MemoryMapping::mapping_mode::write_shared, fd};
+        REQUIRE(!!mapping);
+
+        auto* addr = mapping.get_addr<char>();
+        addr[0] = 'x';
+        addr[size - 1] = 'y';
+
+        // These are only hints, so all we can check is that they do
+        // not crash and do not change the mapped data. The ranges do
+        // not have to be page-aligned and may stick out over the end
+        // of the mapping.
+        mapping.advise(osmium::util::memory_advice::sequential);
+        mapping.advise(osmium::util::memory_advice::willneed, 17, 1000);
+        mapping.advise(osmium::util::memory_advice::random);
+        mapping.advise(osmium::util::memory_advice::normal, size - 1, 1000);
+
+        mapping.prefault();
+        mapping.prefault(17, 1000);
+        mapping.prefault(size - 1, 1000);
+
+        REQUIRE(addr[0] == 'x');
+        REQUIRE(addr[size - 1] == 'y');
+
+        mapping.unmap();
+    }
+
+    REQUIRE(0 == close(fd));
+    REQUIRE(0 == unlink(filename));
+}
+
 TEST_CASE("File-based mapping: Reading from a zero-sized mapped file should work") {
     char filename[] = "test_mmap_read_zero_XXXXXX";
     const int fd = mkstemp(filename);
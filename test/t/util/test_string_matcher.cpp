@@ -126,6 +126,71 @@ TEST_CASE("String matcher: list with add") {
     REQUIRE_FALSE(m.match(""));
 }
 
+TEST_CASE("String matcher: set") {
+    const osmium::StringMatcher::set m{{"foo", "bar"}};
+    REQUIRE(m.match("foo"));
+    REQUIRE(m.match("bar"));
+    REQUIRE_FALSE(m.match("foobar"));
+    REQUIRE_FALSE(m.match("baz"));
+    REQUIRE_FALSE(m.match(""));
+}
+
+TEST_CASE("String matcher: set with add") {
+    osmium::StringMatcher::set m;
+    REQUIRE_FALSE(m.match("foo"));
+    REQUIRE_FALSE(m.match("bar"));
+    m.add_string("foo");
+    REQUIRE(m.match("foo"));
+    m.add_string(std::string{"bar"});
+    REQUIRE(m.match("bar"));
+    REQUIRE_FALSE(m.match("foobar"));
+    REQUIRE_FALSE(m.match("baz"));
+    REQUIRE_FALSE(m.match(""));
+}
+
+TEST_CASE("String matcher: set with many strings") {
+    osmium::StringMatcher::set m;
+    for (int n = 0; n < 1000; ++n) {
+        m.add_string("key" + std::to_string(n));
+    }
+    REQUIRE(m.match("key0"));
+    REQUIRE(m.match("key999"));
+    REQUIRE_FALSE(m.match("key1000"));
+    REQUIRE_FALSE(m.match(""));
+}
+
+TEST_CASE("String matcher: matching with known length") {
+    // The test string is not NUL-terminated where the length says it
+    // ends, so a matcher reading beyond the length would get it wrong.
+    const char* str = "foobar";
+
+    const osmium::StringMatcher equal{osmium::StringMatcher::equal{"foo"}};
+    REQUIRE(equal(str, 3));
+    REQUIRE_FALSE(equal(str, 4));
+    REQUIRE_FALSE(equal(str, 6));
+
+    const osmium::StringMatcher prefix{osmium::StringMatcher::prefix{"foo"}};
+    REQUIRE(prefix(str, 3));
+    REQUIRE(prefix(str, 6));
+    REQUIRE_FALSE(prefix(str, 2));
+
+    const osmium::StringMatcher substring{osmium::StringMatcher::substring{"oba"}};
+    REQUIRE(substring(str, 6));
+    REQUIRE_FALSE(substring(str, 4));
+
+    const osmium::StringMatcher list{osmium::StringMatcher::list{{"foo", "bar"}}};
+    REQUIRE(list(str, 3));
+    REQUIRE_FALSE(list(str, 5));
+
+    osmium::StringMatcher::set s;
+    s.add_string("foo");
+    s.add_string("foob");
+    const osmium::StringMatcher set{std::move(s)};
+    REQUIRE(set(str, 3));
+    REQUIRE(set(str, 4));
+    REQUIRE_FALSE(set(str, 5));
+}
+
 TEST_CASE("Default constructed StringMatcher matches nothing") {
     const osmium::StringMatcher m;
     REQUIRE_FALSE(m("foo"));
@@ -180,6 +245,12 @@ TEST_CASE("Construct StringMatcher") {
     REQUIRE(m(std::string{"bar"}));
     REQUIRE(print(m) == "list[[foo][bar]]");
 
+    m = osmium::StringMatcher::set{{"foo", "bar"}};
+    REQUIRE(m("foo"));
+    REQUIRE(m(std::string{"bar"}));
+    REQUIRE_FALSE(m("baz"));
+    REQUIRE(print(m) == "set[[foo][bar]]");
+
     m = osmium::StringMatcher::prefix{"foo"};
     REQUIRE(m("foo"));
     REQUIRE(m("foobar"));
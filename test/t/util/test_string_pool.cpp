@@ -0,0 +1,57 @@
+#include "catch.hpp"
+
+#include <osmium/util/string_pool.hpp>
+
+#include <cstring>
+#include <string>
+
+TEST_CASE("Interning a string returns the same id every time") {
+    osmium::StringPool pool;
+
+    REQUIRE(pool.empty());
+
+    const auto highway = pool.intern("highway");
+    const auto name = pool.intern("name");
+
+    REQUIRE(highway != name);
+    REQUIRE(pool.intern("highway") == highway);
+    REQUIRE(pool.intern(std::string{"name"}) == name);
+    REQUIRE(pool.size() == 2);
+
+    REQUIRE(std::strcmp(pool.get(highway), "highway") == 0);
+    REQUIRE(std::strcmp(pool.get(name), "name") == 0);
+}
+
+TEST_CASE("String pool ids are dense and start at 0") {
+    osmium::StringPool pool;
+
+    REQUIRE(pool.intern("a") == 0);
+    REQUIRE(pool.intern("b") == 1);
+    REQUIRE(pool.intern("a") == 0);
+    REQUIRE(pool.intern("c") == 2);
+}
+
+TEST_CASE("String pool pointers stay valid when the pool grows") {
+    osmium::StringPool pool{64};
+
+    const char* first = pool.get(pool.intern("building"));
+
+    // force the pool to allocate more chunks
+    for (int i = 0; i < 1000; ++i) {
+        pool.intern(std::to_string(i));
+    }
+
+    REQUIRE(first == pool.get(0));
+    REQUIRE(std::strcmp(first, "building") == 0);
+    REQUIRE(pool.size() == 1001);
+
+    for (int i = 0; i < 1000; ++i) {
+        const auto id = pool.intern(std::to_string(i));
+        REQUIRE(pool.get(id) == std::to_string(i));
+    }
+}
+
+TEST_CASE("The global string pool is shared") {
+    const auto id = osmium::StringPool::global().intern("some unique string");
+    REQUIRE(osmium::StringPool::global().intern("some unique string") == id);
+}